@@ -24,6 +24,7 @@
 
 #include "kernel/register.h"
 #include "kernel/celltypes.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -53,12 +54,14 @@ struct Index {
 	struct ModuleInfo {
 		Module *module;
 		int len;
+		int wire_len = 0;
 		dict<Wire *, int> windices;
 		dict<Cell *, int> suboffsets;
 		pool<Cell *> found_blackboxes;
 
 		bool indexing = false;
 		bool indexed = false;
+		bool offsets_assigned = false;
 	};
 
 	dict<Module *, ModuleInfo> modules;
@@ -77,18 +80,24 @@ struct Index {
 	bool inline_whiteboxes = false;
 	bool allow_blackboxes = false;
 
-	int index_module(RTLIL::Module *m)
+	// Indexing is split in three steps so the expensive part scales with
+	// cores: discover_module() walks the hierarchy once to find all modules
+	// (and reports unsupported cells), then setup() builds the per-module
+	// wire indices across the thread pool -- each worker only fills the
+	// dicts local to its own ModuleInfo -- and index_module() assigns the
+	// literal offsets in one cheap serial pass at the end.
+	void discover_module(RTLIL::Module *m)
 	{
 		ModuleInfo &info = modules[m];
 
 		if (info.indexed)
-			return info.len;
+			return;
 
 		if (info.indexing && !info.indexed)
 			log_error("Hierarchy error\n");
 
+		info.indexing = true;
 		info.module = m;
-		int pos = index_wires(info, m);
 
 		for (auto cell : m->cells()) {
 			if (cell->type.in(KNOWN_OPS) || cell->type.in(ID($scopeinfo), ID($specify2), ID($specify3)))
@@ -99,11 +108,10 @@ struct Index {
 			if (submodule && flatten &&
 					!submodule->get_bool_attribute(ID::keep_hierarchy) &&
 					!submodule->get_blackbox_attribute(inline_whiteboxes)) {
-				info.suboffsets[cell] = pos;
-				pos += index_module(submodule);
+				discover_module(submodule);
 			} else {
 				if (allow_blackboxes) {
-					info.found_blackboxes.insert(cell);	
+					info.found_blackboxes.insert(cell);
 				} else {
 					if (!submodule || submodule->get_blackbox_attribute())
 						log_error("Unsupported cell type: %s (%s in %s)\n",
@@ -112,6 +120,33 @@ struct Index {
 			}
 		}
 
+		info.indexed = true;
+	}
+
+	int index_module(RTLIL::Module *m)
+	{
+		ModuleInfo &info = modules.at(m);
+
+		if (info.offsets_assigned)
+			return info.len;
+		info.offsets_assigned = true;
+
+		int pos = info.wire_len;
+
+		for (auto cell : m->cells()) {
+			if (cell->type.in(KNOWN_OPS) || cell->type.in(ID($scopeinfo), ID($specify2), ID($specify3)))
+				continue;
+
+			Module *submodule = m->design->module(cell->type);
+
+			if (submodule && flatten &&
+					!submodule->get_bool_attribute(ID::keep_hierarchy) &&
+					!submodule->get_blackbox_attribute(inline_whiteboxes)) {
+				info.suboffsets[cell] = pos;
+				pos += index_module(submodule);
+			}
+		}
+
 		info.len = pos;
 		return info.len;
 	}
@@ -131,6 +166,14 @@ struct Index {
 		this->top = top;
 
 		modules.reserve(top->design->modules().size());
+		discover_module(top);
+
+		std::vector<ModuleInfo*> worklist;
+		for (auto &it : modules)
+			worklist.push_back(&it.second);
+		ThreadPool::run(ThreadPool::thread_count(design), GetSize(worklist),
+				[&](int i) { worklist[i]->wire_len = index_wires(*worklist[i], worklist[i]->module); });
+
 		int nlits = index_module(top);
 		log_debug("allocating for %d literals\n", nlits);
 		lits.resize(nlits, Writer::EMPTY_LIT);
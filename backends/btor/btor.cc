@@ -48,23 +48,25 @@ struct BtorWorker
 	int next_nid = 1;
 	int initstate_nid = -1;
 
-	// <width> => <sid>
-	dict<int, int> sorts_bv;
+	// <width> => <sid>, densely indexed by width (0 = no sort created yet)
+	vector<int> sorts_bv;
 
 	// (<address-width>, <data-width>) => <sid>
 	dict<pair<int, int>, int> sorts_mem;
 
-	// SigBit => (<nid>, <bitidx>)
-	dict<SigBit, pair<int, int>> bit_nid;
+	// SigBit => (<nid>, <bitidx>), stored as one dense table per wire: the
+	// lookups in get_sig_nid() run once per port bit, so indexing by
+	// (wire, offset) costs one dict probe per wire instead of one per bit
+	dict<Wire*, vector<pair<int, int>>> bit_nid;
 
-	// <nid> => <bvwidth>
-	dict<int, int> nid_width;
+	// <nid> => <bvwidth>, densely indexed (nids count up from one)
+	vector<int> nid_width;
 
 	// SigSpec => <nid>
 	dict<SigSpec, int> sig_nid;
 
-	// bit to driving cell
-	dict<SigBit, Cell*> bit_cell;
+	// bit to driving cell, same dense per-wire layout as bit_nid
+	dict<Wire*, vector<Cell*>> bit_cell;
 
 	// nids for constants
 	dict<Const, int> consts;
@@ -206,12 +208,14 @@ struct BtorWorker
 
 	int get_bv_sid(int width)
 	{
-		if (sorts_bv.count(width) == 0) {
+		if (width >= GetSize(sorts_bv))
+			sorts_bv.resize(width+1);
+		if (sorts_bv[width] == 0) {
 			int nid = next_nid++;
 			btorf("%d sort bitvec %d\n", nid, width);
 			sorts_bv[width] = nid;
 		}
-		return sorts_bv.at(width);
+		return sorts_bv[width];
 	}
 
 	int get_mem_sid(int abits, int dbits)
@@ -227,16 +231,54 @@ struct BtorWorker
 		return sorts_mem.at(key);
 	}
 
+	// returns (-1, -1) if no nid has been assigned to the bit yet
+	pair<int, int> lookup_bit_nid(const SigBit &bit)
+	{
+		if (bit.wire == nullptr)
+			return make_pair(-1, -1);
+		auto it = bit_nid.find(bit.wire);
+		if (it == bit_nid.end())
+			return make_pair(-1, -1);
+		return it->second[bit.offset];
+	}
+
+	void set_bit_nid(const SigBit &bit, const pair<int, int> &value)
+	{
+		if (bit.wire == nullptr)
+			return;
+		auto &table = bit_nid[bit.wire];
+		if (table.empty())
+			table.resize(GetSize(bit.wire), make_pair(-1, -1));
+		table[bit.offset] = value;
+	}
+
+	Cell *lookup_bit_cell(const SigBit &bit)
+	{
+		if (bit.wire == nullptr)
+			return nullptr;
+		auto it = bit_cell.find(bit.wire);
+		if (it == bit_cell.end())
+			return nullptr;
+		return it->second[bit.offset];
+	}
+
+	void set_nid_width(int nid, int width)
+	{
+		if (nid >= GetSize(nid_width))
+			nid_width.resize(nid+1, -1);
+		nid_width[nid] = width;
+	}
+
 	void add_nid_sig(int nid, const SigSpec &sig)
 	{
 		if (verbose)
 			f << indent << stringf("; %d %s\n", nid, log_signal(sig));
 
 		for (int i = 0; i < GetSize(sig); i++)
-			bit_nid[sig[i]] = make_pair(nid, i);
+			set_bit_nid(sig[i], make_pair(nid, i));
 
 		sig_nid[sig] = nid;
-		nid_width[nid] = GetSize(sig);
+		set_nid_width(nid, GetSize(sig));
 	}
 
 	void export_cell(Cell *cell)
@@ -1037,8 +1079,9 @@ struct BtorWorker
 			for (int i = 0; i < GetSize(sig); i++)
 			{
 				SigBit bit = sig[i];
+				pair<int, int> bitinfo = lookup_bit_nid(bit);
 
-				if (bit_nid.count(bit) == 0)
+				if (bitinfo.first < 0)
 				{
 					if (bit.wire == nullptr)
 					{
@@ -1052,7 +1095,7 @@ struct BtorWorker
 							int nid = next_nid++;
 							btorf("%d const %d %s\n", nid, sid, c.as_string().c_str());
 							consts[c] = nid;
-							nid_width[nid] = GetSize(c);
+							set_nid_width(nid, GetSize(c));
 						}
 
 						int nid = consts.at(c);
@@ -1065,12 +1108,13 @@ struct BtorWorker
 					}
 					else
 					{
-						if (bit_cell.count(bit) == 0)
+						Cell *driver = lookup_bit_cell(bit);
+						if (driver == nullptr)
 						{
 							SigSpec s = bit;
 
 							while (i+GetSize(s) < GetSize(sig) && sig[i+GetSize(s)].wire != nullptr &&
-									bit_cell.count(sig[i+GetSize(s)]) == 0)
+									lookup_bit_cell(sig[i+GetSize(s)]) == nullptr)
 								s.append(sig[i+GetSize(s)]);
 
 							log_warning("No driver for signal %s.\n", log_signal(s));
@@ -1079,7 +1123,7 @@ struct BtorWorker
 							int nid = next_nid++;
 							btorf("%d input %d\n", nid, sid);
 							ywmap_input(s);
-							nid_width[nid] = GetSize(s);
+							set_nid_width(nid, GetSize(s));
 							add_nid_sig(nid, s);
 
 							for (int j = 0; j < GetSize(s); j++)
@@ -1090,13 +1134,14 @@ struct BtorWorker
 						}
 						else
 						{
-							export_cell(bit_cell.at(bit));
-							log_assert(bit_nid.count(bit));
+							export_cell(driver);
+							bitinfo = lookup_bit_nid(bit);
+							log_assert(bitinfo.first >= 0);
 						}
 					}
 				}
 
-				nidbits.push_back(bit_nid.at(bit));
+				nidbits.push_back(bitinfo);
 			}
 
 			int width = 0;
@@ -1115,7 +1160,7 @@ struct BtorWorker
 
 				int nid3 = nid2;
 
-				if (lower != 0 || upper+1 != nid_width.at(nid2)) {
+				if (lower != 0 || upper+1 != nid_width[nid2]) {
 					int sid = get_bv_sid(upper-lower+1);
 					nid3 = next_nid++;
 					btorf("%d slice %d %d %d %d\n", nid3, sid, nid2, upper, lower);
@@ -1134,7 +1179,7 @@ struct BtorWorker
 			}
 
 			sig_nid[sig] = nid;
-			nid_width[nid] = width;
+			set_nid_width(nid, width);
 		}
 
 		nid = sig_nid.at(sig);
@@ -1247,8 +1292,14 @@ struct BtorWorker
 			if (!cell->output(conn.first))
 				continue;
 
-			for (auto bit : sigmap(conn.second))
-				bit_cell[bit] = cell;
+			for (auto bit : sigmap(conn.second)) {
+				if (bit.wire == nullptr)
+					continue;
+				auto &table = bit_cell[bit.wire];
+				if (table.empty())
+					table.resize(GetSize(bit.wire), nullptr);
+				table[bit.offset] = cell;
+			}
 		}
 
 		for (auto wire : module->wires())
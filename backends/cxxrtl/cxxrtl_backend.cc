@@ -26,6 +26,7 @@
 #include "kernel/log.h"
 #include "kernel/fmt.h"
 #include "kernel/scopeinfo.h"
+#include "libs/sha1/sha1.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -719,6 +720,13 @@ struct CxxrtlWorker {
 	std::string print_output = "std::cout";
 	std::ostream *impl_f = nullptr;
 	std::ostream *intf_f = nullptr;
+	int num_parts = 0;
+	std::vector<std::ostream*> part_f;
+	// Incremental recompilation support: module to part assignments carried
+	// over from the manifest of a previous run, and the assignments plus
+	// per-module content hashes produced by this run.
+	dict<std::string, int> prev_part_assignment;
+	std::vector<std::tuple<std::string, int, std::string>> part_manifest;
 
 	bool print_wire_types = false;
 	bool print_debug_wire_types = false;
@@ -2858,10 +2866,82 @@ struct CxxrtlWorker {
 		f << "\n";
 		f << "namespace " << design_ns << " {\n";
 		f << "\n";
-		for (auto module : modules) {
-			if (!split_intf)
-				dump_module_intf(module);
-			dump_module_impl(module);
+		if (num_parts > 0)
+		{
+			// Module implementations go into the part files; this translation
+			// unit keeps only the C API glue. The parts are balanced by
+			// emitted code size: heaviest module first, always into the
+			// currently lightest part, keeping the relative module order
+			// within each part.
+			std::string main_text = f.str();
+			f.str("");
+
+			std::vector<std::string> impl_text;
+			for (auto module : modules) {
+				dump_module_impl(module);
+				impl_text.push_back(f.str());
+				f.str("");
+			}
+
+			std::vector<int> order(GetSize(impl_text));
+			for (int i = 0; i < GetSize(order); i++)
+				order[i] = i;
+			std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+				return impl_text[a].size() > impl_text[b].size();
+			});
+
+			std::vector<size_t> part_load(num_parts, 0);
+			std::vector<std::vector<int>> part_modules(num_parts);
+			// Modules listed in the manifest of a previous run keep their
+			// part, so editing one module dirties one part file instead of
+			// reshuffling all of them. Only modules the manifest does not
+			// cover go through load balancing.
+			std::vector<bool> assigned(GetSize(impl_text), false);
+			for (int i = 0; i < GetSize(impl_text); i++) {
+				auto it = prev_part_assignment.find(modules[i]->name.str());
+				if (it == prev_part_assignment.end() || it->second < 0 || it->second >= num_parts)
+					continue;
+				part_modules[it->second].push_back(i);
+				part_load[it->second] += impl_text[i].size();
+				assigned[i] = true;
+			}
+			for (int idx : order) {
+				if (assigned[idx])
+					continue;
+				int lightest = 0;
+				for (int part = 1; part < num_parts; part++)
+					if (part_load[part] < part_load[lightest])
+						lightest = part;
+				part_modules[lightest].push_back(idx);
+				part_load[lightest] += impl_text[idx].size();
+			}
+
+			for (int part = 0; part < num_parts; part++) {
+				std::sort(part_modules[part].begin(), part_modules[part].end());
+				for (int idx : part_modules[part])
+					part_manifest.push_back({modules[idx]->name.str(), part, sha1(impl_text[idx])});
+				f << "#include \"" << basename(intf_filename) << "\"\n";
+				f << "\n";
+				f << "using namespace cxxrtl_yosys;\n";
+				f << "\n";
+				f << "namespace " << design_ns << " {\n";
+				f << "\n";
+				for (int idx : part_modules[part])
+					f << impl_text[idx];
+				f << "} // namespace " << design_ns << "\n";
+				*part_f[part] << f.str();
+				f.str("");
+			}
+
+			f << main_text;
+		}
+		else
+		{
+			for (auto module : modules) {
+				if (!split_intf)
+					dump_module_intf(module);
+				dump_module_impl(module);
+			}
 		}
 		f << "} // namespace " << design_ns << "\n";
 		f << "\n";
@@ -3463,6 +3543,47 @@ struct CxxrtlWorker {
 	}
 };
 
+// Rewrite the file only when its content actually changes, keeping the old
+// modification time otherwise so that build systems skip recompiling
+// translation units whose generated source is identical.
+void write_if_changed(const std::string &filename, const std::string &contents)
+{
+	std::ifstream old_f(filename, std::ifstream::binary);
+	if (old_f) {
+		std::stringstream old_contents;
+		old_contents << old_f.rdbuf();
+		if (old_contents.str() == contents)
+			return;
+	}
+	old_f.close();
+	std::ofstream new_f(filename, std::ofstream::trunc | std::ofstream::binary);
+	if (new_f.fail())
+		log_cmd_error("Can't open file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+	new_f << contents;
+}
+
+void read_manifest(const std::string &filename, dict<std::string, int> &part_assignment)
+{
+	std::ifstream f(filename);
+	if (!f)
+		return;
+	std::string line;
+	if (!std::getline(f, line) || line.compare(0, 16, "CXXRTL manifest ") != 0)
+		return;
+	while (std::getline(f, line)) {
+		std::istringstream tokens(line);
+		std::string kind, hash, name;
+		int part;
+		if (!(tokens >> kind >> part >> hash) || kind != "module")
+			continue;
+		if (!std::getline(tokens, name))
+			continue;
+		if (!name.empty() && name[0] == ' ')
+			name = name.substr(1);
+		part_assignment[name] = part;
+	}
+}
+
 struct CxxrtlBackend : public Backend {
 	static const int DEFAULT_OPT_LEVEL = 6;
 	static const int DEFAULT_DEBUG_LEVEL = 4;
@@ -3640,6 +3761,18 @@ struct CxxrtlBackend : public Backend {
 		log("        place the generated code into namespace <ns-name>. if not specified,\n");
 		log("        \"cxxrtl_design\" is used.\n");
 		log("\n");
+		log("    -parts <n>\n");
+		log("        emit the module implementations into <n> additional translation units\n");
+		log("        named by appending \"_<i>\" to the output filename, balanced by code\n");
+		log("        size, so the generated simulator can be compiled in parallel. the main\n");
+		log("        output file keeps the C API glue. requires -header; designs compiled\n");
+		log("        with this option should not be flattened into a single module.\n");
+		log("        a `.manifest' file records the module to part assignment and a\n");
+		log("        content hash per module; on the next run modules keep their part, and\n");
+		log("        the header and part files are only rewritten when their content\n");
+		log("        changes, so only translation units affected by a design change get\n");
+		log("        recompiled.\n");
+		log("\n");
 		log("    -print-output <stream>\n");
 		log("        $print cells in the generated code direct their output to <stream>.\n");
 		log("        must be one of \"std::cout\", \"std::cerr\". if not specified,\n");
@@ -3779,6 +3912,12 @@ struct CxxrtlBackend : public Backend {
 				worker.split_intf = true;
 				continue;
 			}
+			if (args[argidx] == "-parts" && argidx+1 < args.size()) {
+				worker.num_parts = std::stoi(args[++argidx]);
+				if (worker.num_parts < 1)
+					log_cmd_error("Invalid number of parts %d.\n", worker.num_parts);
+				continue;
+			}
 			if (args[argidx] == "-namespace" && argidx+1 < args.size()) {
 				worker.design_ns = args[++argidx];
 				continue;
@@ -3845,23 +3984,53 @@ struct CxxrtlBackend : public Backend {
 				log_cmd_error("Invalid debug information level %d.\n", debug_level);
 		}
 
-		std::ofstream intf_f;
+		// The header and the part files are buffered and only rewritten when
+		// their content changes, so a design change only invalidates the
+		// translation units it actually affects.
+		std::ostringstream intf_buf;
 		if (worker.split_intf) {
 			if (filename == "<stdout>")
 				log_cmd_error("Option -header must be used with a filename.\n");
 
 			worker.intf_filename = filename.substr(0, filename.rfind('.')) + ".h";
-			intf_f.open(worker.intf_filename, std::ofstream::trunc);
-			if (intf_f.fail())
-				log_cmd_error("Can't open file `%s' for writing: %s\n",
-				              worker.intf_filename.c_str(), strerror(errno));
+			worker.intf_f = &intf_buf;
+		}
 
-			worker.intf_f = &intf_f;
+		std::string manifest_filename;
+		std::vector<std::string> part_filenames;
+		std::vector<std::unique_ptr<std::ostringstream>> part_bufs;
+		if (worker.num_parts > 0) {
+			if (!worker.split_intf)
+				log_cmd_error("Option -parts must be used with -header.\n");
+
+			size_t dot = filename.rfind('.');
+			std::string stem = filename.substr(0, dot);
+			std::string ext = dot == std::string::npos ? "" : filename.substr(dot);
+			manifest_filename = stem + ".manifest";
+			for (int part = 0; part < worker.num_parts; part++) {
+				part_filenames.push_back(stem + stringf("_%d", part) + ext);
+				part_bufs.emplace_back(new std::ostringstream);
+				worker.part_f.push_back(part_bufs.back().get());
+			}
+			read_manifest(manifest_filename, worker.prev_part_assignment);
 		}
+
 		worker.impl_f = f;
 
 		worker.prepare_design(design);
 		worker.dump_design(design);
+
+		if (worker.split_intf)
+			write_if_changed(worker.intf_filename, intf_buf.str());
+		for (int part = 0; part < worker.num_parts; part++)
+			write_if_changed(part_filenames[part], part_bufs[part]->str());
+		if (worker.num_parts > 0) {
+			std::string manifest = "CXXRTL manifest 1\n";
+			for (auto &entry : worker.part_manifest)
+				manifest += stringf("module %d %s %s\n", std::get<1>(entry),
+				                    std::get<2>(entry).c_str(), std::get<0>(entry).c_str());
+			write_if_changed(manifest_filename, manifest);
+		}
 	}
 } CxxrtlBackend;
 
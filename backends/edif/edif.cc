@@ -72,6 +72,7 @@ struct EdifNames
 		}
 
 		used_names.insert(id);
+		name_map[id] = id;
 		return id;
 
 	do_rename:;
@@ -88,6 +89,45 @@ struct EdifNames
 	}
 };
 
+// Chunk-buffered output: tokens are formatted into a large in-memory buffer
+// that is flushed to the stream one megabyte at a time, instead of paying one
+// ostream write per token. Makes a visible difference on multi-GB netlists.
+struct EdifSink
+{
+	static const size_t chunk_size = 1024*1024;
+
+	std::ostream &f;
+	std::string buffer;
+
+	EdifSink(std::ostream &f) : f(f) { buffer.reserve(chunk_size); }
+	~EdifSink() { flush(); }
+
+	void flush()
+	{
+		if (!buffer.empty()) {
+			f.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+
+	void printf(const char *fmt, ...) YS_ATTRIBUTE(format(printf, 2, 3))
+	{
+		va_list ap;
+		va_start(ap, fmt);
+		buffer += vstringf(fmt, ap);
+		va_end(ap);
+		if (buffer.size() >= chunk_size)
+			flush();
+	}
+
+	void puts(const char *str)
+	{
+		buffer += str;
+		if (buffer.size() >= chunk_size)
+			flush();
+	}
+};
+
 struct EdifBackend : public Backend {
 	EdifBackend() : Backend("edif", "write design to EDIF netlist file") { }
 	void help() override
@@ -185,6 +225,9 @@ struct EdifBackend : public Backend {
 		}
 		extra_args(f, filename, args, argidx);
 
+		// f is only a valid stream after extra_args() has opened the output file
+		EdifSink out(*f);
+
 		if (top_module_name.empty())
 			for (auto module : design->modules())
 				if (module->get_bool_attribute(ID::top))
@@ -227,41 +270,41 @@ struct EdifBackend : public Backend {
 		if (top_module_name.empty())
 			log_error("No module found in design!\n");
 
-		*f << stringf("(edif %s\n", EDIF_DEF(top_module_name));
-		*f << stringf("  (edifVersion 2 0 0)\n");
-		*f << stringf("  (edifLevel 0)\n");
-		*f << stringf("  (keywordMap (keywordLevel 0))\n");
-		*f << stringf("  (comment \"Generated by %s\")\n", yosys_version_str);
+		out.printf("(edif %s\n", EDIF_DEF(top_module_name));
+		out.printf("  (edifVersion 2 0 0)\n");
+		out.printf("  (edifLevel 0)\n");
+		out.printf("  (keywordMap (keywordLevel 0))\n");
+		out.printf("  (comment \"Generated by %s\")\n", yosys_version_str);
 
-		*f << stringf("  (external LIB\n");
-		*f << stringf("    (edifLevel 0)\n");
-		*f << stringf("    (technology (numberDefinition))\n");
+		out.printf("  (external LIB\n");
+		out.printf("    (edifLevel 0)\n");
+		out.printf("    (technology (numberDefinition))\n");
 
 		if (!nogndvcc)
 		{
-			*f << stringf("    (cell GND\n");
-			*f << stringf("      (cellType GENERIC)\n");
-			*f << stringf("      (view VIEW_NETLIST\n");
-			*f << stringf("        (viewType NETLIST)\n");
-			*f << stringf("        (interface (port %c (direction OUTPUT)))\n", gndvccy ? 'Y' : 'G');
-			*f << stringf("      )\n");
-			*f << stringf("    )\n");
-
-			*f << stringf("    (cell VCC\n");
-			*f << stringf("      (cellType GENERIC)\n");
-			*f << stringf("      (view VIEW_NETLIST\n");
-			*f << stringf("        (viewType NETLIST)\n");
-			*f << stringf("        (interface (port %c (direction OUTPUT)))\n", gndvccy ? 'Y' : 'P');
-			*f << stringf("      )\n");
-			*f << stringf("    )\n");
+			out.printf("    (cell GND\n");
+			out.printf("      (cellType GENERIC)\n");
+			out.printf("      (view VIEW_NETLIST\n");
+			out.printf("        (viewType NETLIST)\n");
+			out.printf("        (interface (port %c (direction OUTPUT)))\n", gndvccy ? 'Y' : 'G');
+			out.printf("      )\n");
+			out.printf("    )\n");
+
+			out.printf("    (cell VCC\n");
+			out.printf("      (cellType GENERIC)\n");
+			out.printf("      (view VIEW_NETLIST\n");
+			out.printf("        (viewType NETLIST)\n");
+			out.printf("        (interface (port %c (direction OUTPUT)))\n", gndvccy ? 'Y' : 'P');
+			out.printf("      )\n");
+			out.printf("    )\n");
 		}
 
 		for (auto &cell_it : lib_cell_ports) {
-			*f << stringf("    (cell %s\n", EDIF_DEF(cell_it.first));
-			*f << stringf("      (cellType GENERIC)\n");
-			*f << stringf("      (view VIEW_NETLIST\n");
-			*f << stringf("        (viewType NETLIST)\n");
-			*f << stringf("        (interface\n");
+			out.printf("    (cell %s\n", EDIF_DEF(cell_it.first));
+			out.printf("      (cellType GENERIC)\n");
+			out.printf("      (view VIEW_NETLIST\n");
+			out.printf("        (viewType NETLIST)\n");
+			out.printf("        (interface\n");
 			for (auto &port_it : cell_it.second) {
 				const char *dir = "INOUT";
 				if (ct.cell_known(cell_it.first)) {
@@ -283,19 +326,19 @@ struct EdifBackend : public Backend {
 					}
 				}
 				if (width == 1)
-					*f << stringf("          (port %s (direction %s))\n", EDIF_DEF(port_it.first), dir);
+					out.printf("          (port %s (direction %s))\n", EDIF_DEF(port_it.first), dir);
 				else {
 					int b[2];
 					b[upto ? 0 : 1] = start;
 					b[upto ? 1 : 0] = start+width-1;
-					*f << stringf("          (port (array %s %d) (direction %s))\n", EDIF_DEFR(port_it.first, port_rename, b[0], b[1]), width, dir);
+					out.printf("          (port (array %s %d) (direction %s))\n", EDIF_DEFR(port_it.first, port_rename, b[0], b[1]), width, dir);
 				}
 			}
-			*f << stringf("        )\n");
-			*f << stringf("      )\n");
-			*f << stringf("    )\n");
+			out.printf("        )\n");
+			out.printf("      )\n");
+			out.printf("    )\n");
 		}
-		*f << stringf("  )\n");
+		out.printf("  )\n");
 
 		std::vector<RTLIL::Module*> sorted_modules;
 
@@ -327,15 +370,15 @@ struct EdifBackend : public Backend {
 		}
 
 
-		*f << stringf("  (library DESIGN\n");
-		*f << stringf("    (edifLevel 0)\n");
-		*f << stringf("    (technology (numberDefinition))\n");
+		out.printf("  (library DESIGN\n");
+		out.printf("    (edifLevel 0)\n");
+		out.printf("    (technology (numberDefinition))\n");
 
 		auto add_prop = [&](IdString name, Const val) {
 			if ((val.flags & RTLIL::CONST_FLAG_STRING) != 0)
-				*f << stringf("\n            (property %s (string \"%s\"))", EDIF_DEF(name), val.decode_string().c_str());
+				out.printf("\n            (property %s (string \"%s\"))", EDIF_DEF(name), val.decode_string().c_str());
 			else if (val.size() <= 32 && RTLIL::SigSpec(val).is_fully_def())
-				*f << stringf("\n            (property %s (integer %u))", EDIF_DEF(name), val.as_int());
+				out.printf("\n            (property %s (integer %u))", EDIF_DEF(name), val.as_int());
 			else {
 				std::string hex_string = "";
 				for (auto i = 0; i < val.size(); i += 4) {
@@ -347,7 +390,7 @@ struct EdifBackend : public Backend {
 					char digit_str[2] = { "0123456789abcdef"[digit_value], 0 };
 					hex_string = std::string(digit_str) + hex_string;
 				}
-				*f << stringf("\n            (property %s (string \"%d'h%s\"))", EDIF_DEF(name), GetSize(val), hex_string.c_str());
+				out.printf("\n            (property %s (string \"%d'h%s\"))", EDIF_DEF(name), GetSize(val), hex_string.c_str());
 			}
 		};
 		for (auto module : sorted_modules)
@@ -358,11 +401,11 @@ struct EdifBackend : public Backend {
 			SigMap sigmap(module);
 			std::map<RTLIL::SigSpec, std::set<std::pair<std::string, bool>>> net_join_db;
 
-			*f << stringf("    (cell %s\n", EDIF_DEF(module->name));
-			*f << stringf("      (cellType GENERIC)\n");
-			*f << stringf("      (view VIEW_NETLIST\n");
-			*f << stringf("        (viewType NETLIST)\n");
-			*f << stringf("        (interface\n");
+			out.printf("    (cell %s\n", EDIF_DEF(module->name));
+			out.printf("      (cellType GENERIC)\n");
+			out.printf("      (view VIEW_NETLIST\n");
+			out.printf("        (viewType NETLIST)\n");
+			out.printf("        (interface\n");
 
 			for (auto cell : module->cells()) {
 				for (auto &conn : cell->connections())
@@ -437,23 +480,23 @@ struct EdifBackend : public Backend {
 				else if (!wire->port_input)
 					dir = "OUTPUT";
 				if (wire->width == 1) {
-					*f << stringf("          (port %s (direction %s)", EDIF_DEF(wire->name), dir);
+					out.printf("          (port %s (direction %s)", EDIF_DEF(wire->name), dir);
 					if (attr_properties)
 						for (auto &p : wire->attributes)
 							add_prop(p.first, p.second);
-					*f << ")\n";
+					out.puts(")\n");
 					RTLIL::SigSpec sig = sigmap(RTLIL::SigSpec(wire));
 					net_join_db[sig].insert(make_pair(stringf("(portRef %s)", EDIF_REF(wire->name)), wire->port_input));
 				} else {
 					int b[2];
 					b[wire->upto ? 0 : 1] = wire->start_offset;
 					b[wire->upto ? 1 : 0] = wire->start_offset + GetSize(wire) - 1;
-					*f << stringf("          (port (array %s %d) (direction %s)", EDIF_DEFR(wire->name, port_rename, b[0], b[1]), wire->width, dir);
+					out.printf("          (port (array %s %d) (direction %s)", EDIF_DEFR(wire->name, port_rename, b[0], b[1]), wire->width, dir);
 					if (attr_properties)
 						for (auto &p : wire->attributes)
 							add_prop(p.first, p.second);
 
-					*f << ")\n";
+					out.puts(")\n");
 					for (int i = 0; i < wire->width; i++) {
 						RTLIL::SigSpec sig = sigmap(RTLIL::SigSpec(wire, i));
 						net_join_db[sig].insert(make_pair(stringf("(portRef (member %s %d))", EDIF_REF(wire->name), lsbidx ? i : GetSize(wire)-i-1), wire->port_input));
@@ -461,17 +504,17 @@ struct EdifBackend : public Backend {
 				}
 			}
 
-			*f << stringf("        )\n");
-			*f << stringf("        (contents\n");
+			out.printf("        )\n");
+			out.printf("        (contents\n");
 
 			if (!nogndvcc) {
-				*f << stringf("          (instance GND (viewRef VIEW_NETLIST (cellRef GND (libraryRef LIB))))\n");
-				*f << stringf("          (instance VCC (viewRef VIEW_NETLIST (cellRef VCC (libraryRef LIB))))\n");
+				out.printf("          (instance GND (viewRef VIEW_NETLIST (cellRef GND (libraryRef LIB))))\n");
+				out.printf("          (instance VCC (viewRef VIEW_NETLIST (cellRef VCC (libraryRef LIB))))\n");
 			}
 
 			for (auto cell : module->cells()) {
-				*f << stringf("          (instance %s\n", EDIF_DEF(cell->name));
-				*f << stringf("            (viewRef VIEW_NETLIST (cellRef %s%s))", EDIF_REF(cell->type),
+				out.printf("          (instance %s\n", EDIF_DEF(cell->name));
+				out.printf("            (viewRef VIEW_NETLIST (cellRef %s%s))", EDIF_REF(cell->type),
 						lib_cell_ports.count(cell->type) > 0 ? " (libraryRef LIB)" : "");
 				for (auto &p : cell->parameters)
 					add_prop(p.first, p.second);
@@ -479,7 +522,7 @@ struct EdifBackend : public Backend {
 					for (auto &p : cell->attributes)
 						add_prop(p.first, p.second);
 
-				*f << stringf(")\n");
+				out.printf(")\n");
 				for (auto &p : cell->connections()) {
 					RTLIL::SigSpec sig = sigmap(p.second);
 					for (int i = 0; i < GetSize(sig); i++)
@@ -533,22 +576,22 @@ struct EdifBackend : public Backend {
 						if (netname[i] == ' ' || netname[i] == '\\')
 							netname.erase(netname.begin() + i--);
 				}
-				*f << stringf("          (net %s (joined\n", EDIF_DEF(netname));
+				out.printf("          (net %s (joined\n", EDIF_DEF(netname));
 				for (auto &ref : it.second)
-					*f << stringf("              %s\n", ref.first.c_str());
+					out.printf("              %s\n", ref.first.c_str());
 				if (sig.wire == NULL) {
 					if (nogndvcc)
 						log_error("Design contains constant nodes (map with \"hilomap\" first).\n");
 					if (sig == RTLIL::State::S0)
-						*f << stringf("            (portRef %c (instanceRef GND))\n", gndvccy ? 'Y' : 'G');
+						out.printf("            (portRef %c (instanceRef GND))\n", gndvccy ? 'Y' : 'G');
 					if (sig == RTLIL::State::S1)
-						*f << stringf("            (portRef %c (instanceRef VCC))\n", gndvccy ? 'Y' : 'P');
+						out.printf("            (portRef %c (instanceRef VCC))\n", gndvccy ? 'Y' : 'P');
 				}
-				*f << stringf("            )");
+				out.printf("            )");
 				if (attr_properties && sig.wire != NULL)
 					for (auto &p : sig.wire->attributes)
 						add_prop(p.first, p.second);
-				*f << stringf("\n          )\n");
+				out.printf("\n          )\n");
 			}
 
 			for (auto wire : module->wires())
@@ -571,19 +614,19 @@ struct EdifBackend : public Backend {
 
 					if (keepmode)
 					{
-						*f << stringf("          (net %s (joined\n", EDIF_DEF(netname));
+						out.printf("          (net %s (joined\n", EDIF_DEF(netname));
 
 						auto &refs = net_join_db.at(mapped_sig);
 						for (auto &ref : refs)
 							if (ref.second)
-								*f << stringf("              %s\n", ref.first.c_str());
-						*f << stringf("            )");
+								out.printf("              %s\n", ref.first.c_str());
+						out.printf("            )");
 
 						if (attr_properties && raw_sig.wire != NULL)
 							for (auto &p : raw_sig.wire->attributes)
 								add_prop(p.first, p.second);
 
-						*f << stringf("\n          )\n");
+						out.printf("\n          )\n");
 					}
 					else
 					{
@@ -592,17 +635,17 @@ struct EdifBackend : public Backend {
 				}
 			}
 
-			*f << stringf("        )\n");
-			*f << stringf("      )\n");
-			*f << stringf("    )\n");
+			out.printf("        )\n");
+			out.printf("      )\n");
+			out.printf("    )\n");
 		}
-		*f << stringf("  )\n");
+		out.printf("  )\n");
 
-		*f << stringf("  (design %s\n", EDIF_DEF(top_module_name));
-		*f << stringf("    (cellRef %s (libraryRef DESIGN))\n", EDIF_REF(top_module_name));
-		*f << stringf("  )\n");
+		out.printf("  (design %s\n", EDIF_DEF(top_module_name));
+		out.printf("    (cellRef %s (libraryRef DESIGN))\n", EDIF_REF(top_module_name));
+		out.printf("  )\n");
 
-		*f << stringf(")\n");
+		out.printf(")\n");
 	}
 } EdifBackend;
 
@@ -28,9 +28,82 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// Buffered writer in front of the output stream: the JSON text is
+// accumulated in a large buffer and handed to the ostream in big
+// batches, so writing multi-GB netlists is bound by I/O instead of
+// per-fragment ostream overhead. In compact mode a small state machine
+// drops all whitespace outside of JSON strings on the way into the
+// buffer, producing single-pass non-pretty output.
+struct JsonStream
+{
+	std::ostream &os;
+	bool compact;
+	std::string buffer;
+	bool in_string = false, in_escape = false;
+
+	static const size_t buffer_limit = 1024*1024;
+
+	JsonStream(std::ostream &os, bool compact) : os(os), compact(compact)
+	{
+		buffer.reserve(buffer_limit + 4096);
+	}
+
+	~JsonStream()
+	{
+		flush();
+	}
+
+	void flush()
+	{
+		if (!buffer.empty()) {
+			os.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+
+	void put(const char *data, size_t len)
+	{
+		if (!compact) {
+			buffer.append(data, len);
+		} else {
+			for (size_t i = 0; i < len; i++) {
+				char c = data[i];
+				if (in_string) {
+					buffer += c;
+					if (in_escape)
+						in_escape = false;
+					else if (c == '\\')
+						in_escape = true;
+					else if (c == '"')
+						in_string = false;
+				} else if (c == '"') {
+					in_string = true;
+					buffer += c;
+				} else if (c != ' ' && c != '\t' && c != '\n') {
+					buffer += c;
+				}
+			}
+		}
+		if (buffer.size() >= buffer_limit)
+			flush();
+	}
+
+	JsonStream &operator<<(const std::string &str)
+	{
+		put(str.data(), str.size());
+		return *this;
+	}
+
+	JsonStream &operator<<(const char *str)
+	{
+		put(str, strlen(str));
+		return *this;
+	}
+};
+
 struct JsonWriter
 {
-	std::ostream &f;
+	JsonStream f;
 	bool use_selection;
 	bool aig_mode;
 	bool compat_int_mode;
@@ -43,14 +116,25 @@ struct JsonWriter
 	dict<SigBit, string> sigids;
 	pool<Aig> aig_models;
 
-	JsonWriter(std::ostream &f, bool use_selection, bool aig_mode, bool compat_int_mode) :
-			f(f), use_selection(use_selection), aig_mode(aig_mode),
+	JsonWriter(std::ostream &f, bool use_selection, bool aig_mode, bool compat_int_mode, bool compact_mode) :
+			f(f, compact_mode), use_selection(use_selection), aig_mode(aig_mode),
 			compat_int_mode(compat_int_mode) { }
 
-	string get_string(string str)
+	string get_string(const string &str)
 	{
 		string newstr = "\"";
-		for (char c : str) {
+		newstr.reserve(str.size() + 2);
+		size_t pos = 0;
+		while (pos < str.size()) {
+			// copy the longest span without characters needing escapes in one
+			// piece instead of appending char by char
+			size_t end = pos;
+			while (end < str.size() && (unsigned char)str[end] >= 0x20 && str[end] != '\\' && str[end] != '"')
+				end++;
+			newstr.append(str, pos, end - pos);
+			if (end == str.size())
+				break;
+			char c = str[end];
 			if (c == '\\')
 				newstr += "\\\\";
 			else if (c == '"')
@@ -65,10 +149,9 @@ struct JsonWriter
 				newstr += "\\r";
 			else if (c == '\t')
 				newstr += "\\t";
-			else if (c < 0x20)
-				newstr += stringf("\\u%04X", c);
 			else
-				newstr += c;
+				newstr += stringf("\\u%04X", c);
+			pos = end + 1;
 		}
 		return newstr + "\"";
 	}
@@ -356,6 +439,9 @@ struct JsonBackend : public Backend {
 		log("    -selected\n");
 		log("        output only select module\n");
 		log("\n");
+		log("    -compact\n");
+		log("        emit compact (non-pretty) output without indentation, in one pass\n");
+		log("\n");
 		log("\n");
 		log("The general syntax of the JSON output created by this command is as follows:\n");
 		log("\n");
@@ -601,6 +687,7 @@ struct JsonBackend : public Backend {
 		bool aig_mode = false;
 		bool compat_int_mode = false;
 		bool use_selection = false;
+		bool compact_mode = false;
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++)
@@ -617,13 +704,17 @@ struct JsonBackend : public Backend {
 				use_selection = true;
 				continue;
 			}
+			if (args[argidx] == "-compact") {
+				compact_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
 		log_header(design, "Executing JSON backend.\n");
 
-		JsonWriter json_writer(*f, use_selection, aig_mode, compat_int_mode);
+		JsonWriter json_writer(*f, use_selection, aig_mode, compat_int_mode, compact_mode);
 		json_writer.write_design(design);
 	}
 } JsonBackend;
@@ -648,6 +739,9 @@ struct JsonPass : public Pass {
 		log("        emit 32-bit or smaller fully-defined parameter values directly\n");
 		log("        as JSON numbers (for compatibility with old parsers)\n");
 		log("\n");
+		log("    -compact\n");
+		log("        emit compact (non-pretty) output without indentation, in one pass\n");
+		log("\n");
 		log("See 'help write_json' for a description of the JSON format used.\n");
 		log("\n");
 	}
@@ -656,6 +750,7 @@ struct JsonPass : public Pass {
 		std::string filename;
 		bool aig_mode = false;
 		bool compat_int_mode = false;
+		bool compact_mode = false;
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++)
@@ -672,6 +767,10 @@ struct JsonPass : public Pass {
 				compat_int_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-compact") {
+				compact_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -693,7 +792,7 @@ struct JsonPass : public Pass {
 			f = &buf;
 		}
 
-		JsonWriter json_writer(*f, true, aig_mode, compat_int_mode);
+		JsonWriter json_writer(*f, true, aig_mode, compat_int_mode, compact_mode);
 		json_writer.write_design(design);
 
 		if (!empty) {
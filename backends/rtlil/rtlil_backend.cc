@@ -23,6 +23,7 @@
  */
 
 #include "rtlil_backend.h"
+#include "rtlil_binary.h"
 #include "kernel/yosys.h"
 #include <errno.h>
 
@@ -438,10 +439,16 @@ struct RTLILBackend : public Backend {
 		log("    -selected\n");
 		log("        only write selected parts of the design.\n");
 		log("\n");
+		log("    -binary\n");
+		log("        write a binary representation instead of the text format. Binary\n");
+		log("        files load much faster and are auto-detected by 'read_rtlil', but\n");
+		log("        are not guaranteed to be readable by other versions of yosys.\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool selected = false;
+		bool binary = false;
 
 		log_header(design, "Executing RTLIL backend.\n");
 
@@ -452,6 +459,10 @@ struct RTLILBackend : public Backend {
 				selected = true;
 				continue;
 			}
+			if (arg == "-binary") {
+				binary = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
@@ -459,8 +470,12 @@ struct RTLILBackend : public Backend {
 		design->sort();
 
 		log("Output filename: %s\n", filename.c_str());
-		*f << stringf("# Generated by %s\n", yosys_version_str);
-		RTLIL_BACKEND::dump_design(*f, design, selected, true, false);
+		if (binary) {
+			RTLIL_BINARY::dump_design_bin(*f, design, selected);
+		} else {
+			*f << stringf("# Generated by %s\n", yosys_version_str);
+			RTLIL_BACKEND::dump_design(*f, design, selected, true, false);
+		}
 	}
 } RTLILBackend;
 
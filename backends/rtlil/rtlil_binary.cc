@@ -0,0 +1,517 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  Binary RTLIL serialization for fast design checkpoints, see
+ *  rtlil_binary.h for the format rationale.
+ *
+ */
+
+#include "rtlil_binary.h"
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+using namespace RTLIL_BINARY;
+YOSYS_NAMESPACE_BEGIN
+
+const char RTLIL_BINARY::binary_magic[9] = "\xffRTLBIN\x01";
+
+PRIVATE_NAMESPACE_BEGIN
+
+struct BinaryWriter
+{
+	std::ostream &f;
+	dict<RTLIL::IdString, uint32_t> string_table;
+
+	BinaryWriter(std::ostream &f) : f(f) { }
+
+	void put_bytes(const void *data, size_t len) {
+		f.write((const char*)data, len);
+	}
+
+	void put_varint(uint64_t value) {
+		while (value >= 0x80) {
+			f.put(char(0x80 | (value & 0x7f)));
+			value >>= 7;
+		}
+		f.put(char(value));
+	}
+
+	void put_int(int64_t value) {
+		// zig-zag encoding so small negative values stay small
+		put_varint(uint64_t(value << 1) ^ uint64_t(value >> 63));
+	}
+
+	void put_string(const std::string &str) {
+		put_varint(str.size());
+		put_bytes(str.data(), str.size());
+	}
+
+	// IdStrings are interned on first use: a new id is written as the
+	// next table index followed by its string, later uses are just the index.
+	void put_id(const RTLIL::IdString &id) {
+		auto it = string_table.find(id);
+		if (it != string_table.end()) {
+			put_varint(it->second);
+			return;
+		}
+		uint32_t index = GetSize(string_table);
+		string_table[id] = index;
+		put_varint(index);
+		put_string(id.str());
+	}
+
+	void put_const(const RTLIL::Const &data) {
+		put_varint(uint16_t(data.flags));
+		if (data.flags & RTLIL::CONST_FLAG_STRING) {
+			put_string(data.decode_string());
+		} else {
+			put_varint(data.size());
+			std::vector<uint8_t> packed(data.size());
+			for (int i = 0; i < data.size(); i++)
+				packed[i] = uint8_t(data[i]);
+			put_bytes(packed.data(), packed.size());
+		}
+	}
+
+	void put_sigspec(const RTLIL::SigSpec &sig) {
+		put_varint(sig.chunks().size());
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr) {
+				f.put(0);
+				put_const(RTLIL::Const(chunk.data));
+			} else {
+				f.put(1);
+				put_id(chunk.wire->name);
+				put_varint(chunk.offset);
+				put_varint(chunk.width);
+			}
+		}
+	}
+
+	void put_attributes(const RTLIL::AttrObject *obj) {
+		put_varint(obj->attributes.size());
+		for (auto &attr : obj->attributes) {
+			put_id(attr.first);
+			put_const(attr.second);
+		}
+	}
+
+	void put_case(const RTLIL::CaseRule *cs) {
+		put_attributes(cs);
+		put_varint(cs->compare.size());
+		for (auto &sig : cs->compare)
+			put_sigspec(sig);
+		put_varint(cs->actions.size());
+		for (auto &action : cs->actions) {
+			put_sigspec(action.first);
+			put_sigspec(action.second);
+		}
+		put_varint(cs->switches.size());
+		for (auto sw : cs->switches) {
+			put_attributes(sw);
+			put_sigspec(sw->signal);
+			put_varint(sw->cases.size());
+			for (auto c : sw->cases)
+				put_case(c);
+		}
+	}
+
+	void put_process(const RTLIL::Process *proc) {
+		put_id(proc->name);
+		put_attributes(proc);
+		put_case(&proc->root_case);
+		put_varint(proc->syncs.size());
+		for (auto sync : proc->syncs) {
+			put_varint(uint8_t(sync->type));
+			put_sigspec(sync->signal);
+			put_varint(sync->actions.size());
+			for (auto &action : sync->actions) {
+				put_sigspec(action.first);
+				put_sigspec(action.second);
+			}
+			put_varint(sync->mem_write_actions.size());
+			for (auto &memwr : sync->mem_write_actions) {
+				put_attributes(&memwr);
+				put_id(memwr.memid);
+				put_sigspec(memwr.address);
+				put_sigspec(memwr.data);
+				put_sigspec(memwr.enable);
+				put_const(memwr.priority_mask);
+			}
+		}
+	}
+
+	void put_module(RTLIL::Module *module) {
+		put_id(module->name);
+		put_attributes(module);
+
+		put_varint(GetSize(module->avail_parameters));
+		for (auto &param : module->avail_parameters)
+			put_id(param);
+		put_varint(module->parameter_default_values.size());
+		for (auto &param : module->parameter_default_values) {
+			put_id(param.first);
+			put_const(param.second);
+		}
+
+		put_varint(module->wires().size());
+		for (auto wire : module->wires()) {
+			put_id(wire->name);
+			put_attributes(wire);
+			put_int(wire->width);
+			put_int(wire->start_offset);
+			put_int(wire->port_id);
+			uint8_t flags = (wire->port_input ? 1 : 0) | (wire->port_output ? 2 : 0) |
+					(wire->upto ? 4 : 0) | (wire->is_signed ? 8 : 0);
+			f.put(char(flags));
+		}
+
+		put_varint(module->memories.size());
+		for (auto &it : module->memories) {
+			put_id(it.second->name);
+			put_attributes(it.second);
+			put_int(it.second->width);
+			put_int(it.second->start_offset);
+			put_int(it.second->size);
+		}
+
+		put_varint(module->cells().size());
+		for (auto cell : module->cells()) {
+			put_id(cell->name);
+			put_id(cell->type);
+			put_attributes(cell);
+			put_varint(cell->parameters.size());
+			for (auto &param : cell->parameters) {
+				put_id(param.first);
+				put_const(param.second);
+			}
+			put_varint(cell->connections().size());
+			for (auto &conn : cell->connections()) {
+				put_id(conn.first);
+				put_sigspec(conn.second);
+			}
+		}
+
+		put_varint(module->processes.size());
+		for (auto &it : module->processes)
+			put_process(it.second);
+
+		put_varint(module->connections().size());
+		for (auto &conn : module->connections()) {
+			put_sigspec(conn.first);
+			put_sigspec(conn.second);
+		}
+	}
+};
+
+struct BinaryReader
+{
+	std::istream &f;
+	std::vector<RTLIL::IdString> string_table;
+	RTLIL::Module *module = nullptr;
+
+	BinaryReader(std::istream &f) : f(f) { }
+
+	void get_bytes(void *data, size_t len) {
+		f.read((char*)data, len);
+		if (f.gcount() != std::streamsize(len))
+			log_error("Unexpected EOF in binary RTLIL stream.\n");
+	}
+
+	uint8_t get_byte() {
+		int c = f.get();
+		if (c < 0)
+			log_error("Unexpected EOF in binary RTLIL stream.\n");
+		return uint8_t(c);
+	}
+
+	uint64_t get_varint() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			uint8_t byte = get_byte();
+			value |= uint64_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		log_error("Overlong varint in binary RTLIL stream.\n");
+	}
+
+	int64_t get_int() {
+		uint64_t value = get_varint();
+		return int64_t(value >> 1) ^ -int64_t(value & 1);
+	}
+
+	std::string get_string() {
+		size_t len = get_varint();
+		std::string str(len, 0);
+		if (len > 0)
+			get_bytes(&str[0], len);
+		return str;
+	}
+
+	RTLIL::IdString get_id() {
+		size_t index = get_varint();
+		if (index < string_table.size())
+			return string_table[index];
+		if (index != string_table.size())
+			log_error("Invalid IdString table index in binary RTLIL stream.\n");
+		RTLIL::IdString id(get_string());
+		string_table.push_back(id);
+		return id;
+	}
+
+	RTLIL::Const get_const() {
+		uint16_t flags = get_varint();
+		RTLIL::Const data;
+		if (flags & RTLIL::CONST_FLAG_STRING) {
+			data = RTLIL::Const(get_string());
+		} else {
+			size_t len = get_varint();
+			std::vector<uint8_t> packed(len);
+			if (len > 0)
+				get_bytes(packed.data(), len);
+			std::vector<RTLIL::State> bits(len);
+			for (size_t i = 0; i < len; i++)
+				bits[i] = RTLIL::State(packed[i]);
+			data = RTLIL::Const(bits);
+		}
+		data.flags = flags;
+		return data;
+	}
+
+	RTLIL::SigSpec get_sigspec() {
+		size_t num_chunks = get_varint();
+		RTLIL::SigSpec sig;
+		for (size_t i = 0; i < num_chunks; i++) {
+			if (get_byte() == 0) {
+				sig.append(get_const());
+			} else {
+				RTLIL::IdString wire_name = get_id();
+				int offset = get_varint();
+				int width = get_varint();
+				RTLIL::Wire *wire = module->wire(wire_name);
+				if (wire == nullptr)
+					log_error("Binary RTLIL stream references unknown wire %s.\n", log_id(wire_name));
+				sig.append(RTLIL::SigChunk(wire, offset, width));
+			}
+		}
+		return sig;
+	}
+
+	void get_attributes(RTLIL::AttrObject *obj) {
+		size_t count = get_varint();
+		for (size_t i = 0; i < count; i++) {
+			RTLIL::IdString name = get_id();
+			obj->attributes[name] = get_const();
+		}
+	}
+
+	void get_case(RTLIL::CaseRule *cs) {
+		get_attributes(cs);
+		size_t num_compare = get_varint();
+		for (size_t i = 0; i < num_compare; i++)
+			cs->compare.push_back(get_sigspec());
+		size_t num_actions = get_varint();
+		for (size_t i = 0; i < num_actions; i++) {
+			RTLIL::SigSpec lhs = get_sigspec();
+			RTLIL::SigSpec rhs = get_sigspec();
+			cs->actions.push_back(RTLIL::SigSig(lhs, rhs));
+		}
+		size_t num_switches = get_varint();
+		for (size_t i = 0; i < num_switches; i++) {
+			RTLIL::SwitchRule *sw = new RTLIL::SwitchRule;
+			cs->switches.push_back(sw);
+			get_attributes(sw);
+			sw->signal = get_sigspec();
+			size_t num_cases = get_varint();
+			for (size_t j = 0; j < num_cases; j++) {
+				RTLIL::CaseRule *c = new RTLIL::CaseRule;
+				sw->cases.push_back(c);
+				get_case(c);
+			}
+		}
+	}
+
+	void get_process() {
+		RTLIL::Process *proc = module->addProcess(get_id());
+		get_attributes(proc);
+		get_case(&proc->root_case);
+		size_t num_syncs = get_varint();
+		for (size_t i = 0; i < num_syncs; i++) {
+			RTLIL::SyncRule *sync = new RTLIL::SyncRule;
+			proc->syncs.push_back(sync);
+			sync->type = RTLIL::SyncType(get_varint());
+			sync->signal = get_sigspec();
+			size_t num_actions = get_varint();
+			for (size_t j = 0; j < num_actions; j++) {
+				RTLIL::SigSpec lhs = get_sigspec();
+				RTLIL::SigSpec rhs = get_sigspec();
+				sync->actions.push_back(RTLIL::SigSig(lhs, rhs));
+			}
+			size_t num_memwr = get_varint();
+			for (size_t j = 0; j < num_memwr; j++) {
+				RTLIL::MemWriteAction memwr;
+				get_attributes(&memwr);
+				memwr.memid = get_id();
+				memwr.address = get_sigspec();
+				memwr.data = get_sigspec();
+				memwr.enable = get_sigspec();
+				memwr.priority_mask = get_const();
+				sync->mem_write_actions.push_back(memwr);
+			}
+		}
+	}
+
+	void get_module(RTLIL::Design *design, bool flag_nooverwrite, bool flag_overwrite, bool flag_lib) {
+		RTLIL::IdString name = get_id();
+		module = new RTLIL::Module;
+		module->name = name;
+		get_attributes(module);
+
+		bool delete_module = false;
+		RTLIL::Module *existing_mod = design->module(name);
+		if (existing_mod != nullptr) {
+			if (!flag_overwrite && (flag_lib || module->get_bool_attribute(ID::blackbox))) {
+				log("Ignoring blackbox re-definition of module %s.\n", log_id(name));
+				delete_module = true;
+			} else if (!flag_nooverwrite && !flag_overwrite && !existing_mod->get_bool_attribute(ID::blackbox)) {
+				log_error("Binary RTLIL error: redefinition of module %s.\n", log_id(name));
+			} else if (flag_nooverwrite) {
+				log("Ignoring re-definition of module %s.\n", log_id(name));
+				delete_module = true;
+			} else {
+				log("Replacing existing%s module %s.\n",
+						existing_mod->get_bool_attribute(ID::blackbox) ? " blackbox" : "", log_id(name));
+				design->remove(existing_mod);
+			}
+		}
+
+		size_t num_avail_params = get_varint();
+		for (size_t i = 0; i < num_avail_params; i++)
+			module->avail_parameters(get_id());
+		size_t num_default_params = get_varint();
+		for (size_t i = 0; i < num_default_params; i++) {
+			RTLIL::IdString param_name = get_id();
+			module->parameter_default_values[param_name] = get_const();
+		}
+
+		size_t num_wires = get_varint();
+		for (size_t i = 0; i < num_wires; i++) {
+			RTLIL::IdString wire_name = get_id();
+			RTLIL::Wire *wire = module->addWire(wire_name);
+			get_attributes(wire);
+			wire->width = get_int();
+			wire->start_offset = get_int();
+			wire->port_id = get_int();
+			uint8_t wire_flags = get_byte();
+			wire->port_input = (wire_flags & 1) != 0;
+			wire->port_output = (wire_flags & 2) != 0;
+			wire->upto = (wire_flags & 4) != 0;
+			wire->is_signed = (wire_flags & 8) != 0;
+		}
+
+		size_t num_memories = get_varint();
+		for (size_t i = 0; i < num_memories; i++) {
+			RTLIL::Memory *memory = new RTLIL::Memory;
+			memory->name = get_id();
+			get_attributes(memory);
+			memory->width = get_int();
+			memory->start_offset = get_int();
+			memory->size = get_int();
+			module->memories[memory->name] = memory;
+		}
+
+		size_t num_cells = get_varint();
+		for (size_t i = 0; i < num_cells; i++) {
+			RTLIL::IdString cell_name = get_id();
+			RTLIL::IdString cell_type = get_id();
+			RTLIL::Cell *cell = module->addCell(cell_name, cell_type);
+			get_attributes(cell);
+			size_t num_params = get_varint();
+			for (size_t j = 0; j < num_params; j++) {
+				RTLIL::IdString param_name = get_id();
+				cell->parameters[param_name] = get_const();
+			}
+			size_t num_conns = get_varint();
+			for (size_t j = 0; j < num_conns; j++) {
+				RTLIL::IdString port_name = get_id();
+				cell->setPort(port_name, get_sigspec());
+			}
+		}
+
+		size_t num_processes = get_varint();
+		for (size_t i = 0; i < num_processes; i++)
+			get_process();
+
+		size_t num_connections = get_varint();
+		for (size_t i = 0; i < num_connections; i++) {
+			RTLIL::SigSpec lhs = get_sigspec();
+			RTLIL::SigSpec rhs = get_sigspec();
+			module->connect(lhs, rhs);
+		}
+
+		module->fixup_ports();
+
+		if (delete_module) {
+			delete module;
+		} else {
+			design->add(module);
+			if (flag_lib)
+				module->makeblackbox();
+		}
+		module = nullptr;
+	}
+};
+
+PRIVATE_NAMESPACE_END
+
+void RTLIL_BINARY::dump_design_bin(std::ostream &f, RTLIL::Design *design, bool only_selected)
+{
+	BinaryWriter writer(f);
+	writer.put_bytes(binary_magic, 8);
+
+	writer.put_int(autoidx);
+
+	std::vector<RTLIL::Module*> modules;
+	for (auto module : design->modules())
+		if (!only_selected || design->selected(module))
+			modules.push_back(module);
+
+	writer.put_varint(modules.size());
+	for (auto module : modules)
+		writer.put_module(module);
+}
+
+void RTLIL_BINARY::load_design_bin(std::istream &f, RTLIL::Design *design, bool flag_nooverwrite, bool flag_overwrite, bool flag_lib)
+{
+	BinaryReader reader(f);
+
+	char magic[8];
+	reader.get_bytes(magic, 8);
+	if (memcmp(magic, binary_magic, 8) != 0)
+		log_error("Not a binary RTLIL stream (bad magic).\n");
+
+	autoidx = max<int>(autoidx, reader.get_int());
+
+	size_t num_modules = reader.get_varint();
+	for (size_t i = 0; i < num_modules; i++)
+		reader.get_module(design, flag_nooverwrite, flag_overwrite, flag_lib);
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,46 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  A binary serialization of the RTLIL text representation, intended for
+ *  fast design checkpoints. The format stores the IdString table, Const
+ *  payloads and SigChunk vectors as flat length-prefixed arrays so that
+ *  loading is a bulk copy instead of a reparse. The first byte of a binary
+ *  file is 0xFF, which can never start a text RTLIL file, so the frontend
+ *  can auto-detect the format.
+ *
+ */
+
+#ifndef RTLIL_BINARY_H
+#define RTLIL_BINARY_H
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace RTLIL_BINARY {
+	// first byte 0xFF makes binary files trivially distinguishable from text RTLIL
+	extern const char binary_magic[9];
+
+	void dump_design_bin(std::ostream &f, RTLIL::Design *design, bool only_selected);
+	void load_design_bin(std::istream &f, RTLIL::Design *design, bool flag_nooverwrite, bool flag_overwrite, bool flag_lib);
+}
+
+YOSYS_NAMESPACE_END
+
+#endif
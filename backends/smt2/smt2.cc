@@ -1593,6 +1593,82 @@ struct Smt2Worker
 	}
 };
 
+// Our BMC loops re-export the design after touching a single module, so the
+// emitted text of every module is kept across `write_smt2` invocations and
+// reused when a content fingerprint matches. The fingerprint of a module
+// folds in the fingerprints of its submodules (the export runs in topological
+// order), so an edit deep in the hierarchy invalidates all modules above it
+// but nothing else. Each module is buffered and written as one block either
+// way, which also avoids many small stream writes.
+struct Smt2ModuleCacheEntry {
+	Hasher::hash_t fingerprint;
+	std::string options_key;
+	std::string text, mod_id;
+	int stbv_width;
+	dict<IdString, pair<bool, bool>> clk_cache;
+};
+
+static std::map<std::string, Smt2ModuleCacheEntry> smt2_module_cache;
+
+static Hasher::hash_t smt2_module_fingerprint(RTLIL::Module *module, const std::map<std::string, Hasher::hash_t> &submodule_fp)
+{
+	Hasher h;
+
+	h.eat(module->name);
+	for (auto &attr : module->attributes) {
+		h.eat(attr.first);
+		h.eat(attr.second);
+	}
+
+	for (auto wire : module->wires()) {
+		h.eat(wire->name);
+		h.hash32(wire->width);
+		h.hash32(wire->start_offset);
+		h.hash32(wire->port_id);
+		h.hash32((wire->port_input ? 1 : 0) | (wire->port_output ? 2 : 0) | (wire->upto ? 4 : 0));
+		for (auto &attr : wire->attributes) {
+			h.eat(attr.first);
+			h.eat(attr.second);
+		}
+	}
+
+	for (auto cell : module->cells()) {
+		h.eat(cell->name);
+		h.eat(cell->type);
+		for (auto &param : cell->parameters) {
+			h.eat(param.first);
+			h.eat(param.second);
+		}
+		for (auto &attr : cell->attributes) {
+			h.eat(attr.first);
+			h.eat(attr.second);
+		}
+		for (auto &conn : cell->connections()) {
+			h.eat(conn.first);
+			h.eat(conn.second);
+		}
+		auto it = submodule_fp.find(cell->type.str());
+		if (it != submodule_fp.end())
+			h.hash32(it->second);
+	}
+
+	for (auto &it : module->memories) {
+		h.eat(it.first);
+		h.hash32(it.second->width);
+		h.hash32(it.second->size);
+		h.hash32(it.second->start_offset);
+	}
+
+	for (auto &conn : module->connections()) {
+		h.eat(conn.first);
+		h.eat(conn.second);
+	}
+
+	h.hash32(GetSize(module->processes));
+
+	return h.yield();
+}
+
 struct Smt2Backend : public Backend {
 	Smt2Backend() : Backend("smt2", "write design to SMT-LIBv2 file") { }
 	void help() override
@@ -1893,6 +1969,9 @@ struct Smt2Backend : public Backend {
 				log_error("Forall-exists problems are only supported in -stbv or -stdt mode.\n");
 		}
 
+		std::string options_key = stringf("%d%d%d%d%d%d", bvmode, memmode, wiresmode, statebv, statedt, forallmode);
+		std::map<std::string, Hasher::hash_t> module_fp;
+
 		for (auto module : sorted_modules)
 		{
 			if (module->get_blackbox_attribute() && !module->has_attribute(ID::smtlib2_module))
@@ -1901,14 +1980,48 @@ struct Smt2Backend : public Backend {
 			if (module->has_processes_warn())
 				continue;
 
+			Hasher::hash_t fingerprint = smt2_module_fingerprint(module, module_fp);
+			module_fp[module->name.str()] = fingerprint;
+
+			auto cached = smt2_module_cache.find(module->name.str());
+			if (cached != smt2_module_cache.end() && cached->second.fingerprint == fingerprint &&
+					cached->second.options_key == options_key)
+			{
+				log("Reusing cached SMT-LIBv2 representation of module %s.\n", log_id(module));
+
+				*f << cached->second.text;
+				if (statebv)
+					mod_stbv_width[module->name] = cached->second.stbv_width;
+				for (auto &it : cached->second.clk_cache)
+					mod_clk_cache[module->name][it.first] = it.second;
+
+				if (module == topmod)
+					topmod_id = cached->second.mod_id;
+				continue;
+			}
+
 			log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
 
 			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, mod_stbv_width, mod_clk_cache);
 			worker.run();
-			worker.write(*f);
+
+			std::ostringstream buffer;
+			worker.write(buffer);
+			*f << buffer.str();
+
+			Smt2ModuleCacheEntry entry;
+			entry.fingerprint = fingerprint;
+			entry.options_key = options_key;
+			entry.text = buffer.str();
+			entry.mod_id = worker.get_id(module);
+			entry.stbv_width = statebv ? mod_stbv_width.at(module->name) : 0;
+			if (mod_clk_cache.count(module->name))
+				entry.clk_cache = mod_clk_cache.at(module->name);
 
 			if (module == topmod)
-				topmod_id = worker.get_id(module);
+				topmod_id = entry.mod_id;
+
+			smt2_module_cache[module->name.str()] = std::move(entry);
 		}
 
 		if (topmod)
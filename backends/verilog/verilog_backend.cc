@@ -39,6 +39,7 @@ PRIVATE_NAMESPACE_BEGIN
 bool verbose, norename, noattr, attr2comment, noexpr, nodec, nohex, nostr, extmem, defparam, decimal, siminit, systemverilog, simple_lhs, noparallelcase;
 int auto_name_counter, auto_name_offset, auto_name_digits, extmem_counter;
 dict<RTLIL::IdString, int> auto_name_map;
+dict<RTLIL::IdString, std::string> id_cache, id_cache_norename;
 std::set<RTLIL::IdString> reg_wires;
 std::string auto_prefix, extmem_prefix;
 
@@ -47,6 +48,62 @@ dict<RTLIL::SigBit, RTLIL::State> active_initdata;
 SigMap active_sigmap;
 IdString initial_id;
 
+// Batches the many small stringf() pieces emitted by the dump functions into
+// large writes on the underlying stream, so that writing big netlists is
+// bound by the actual output device rather than per-piece stream overhead.
+struct ChunkedStreambuf : public std::streambuf
+{
+	std::streambuf *target;
+	std::vector<char> buf;
+
+	ChunkedStreambuf(std::streambuf *target, size_t size = 1024*1024) : target(target), buf(size)
+	{
+		setp(buf.data(), buf.data() + buf.size());
+	}
+
+	~ChunkedStreambuf() override
+	{
+		flush();
+	}
+
+	void flush()
+	{
+		std::ptrdiff_t n = pptr() - pbase();
+		if (n > 0)
+			target->sputn(pbase(), n);
+		setp(buf.data(), buf.data() + buf.size());
+	}
+
+	int overflow(int c) override
+	{
+		flush();
+		if (c != traits_type::eof()) {
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize xsputn(const char *s, std::streamsize n) override
+	{
+		if (n >= std::streamsize(buf.size())) {
+			flush();
+			return target->sputn(s, n);
+		}
+		if (n > epptr() - pptr())
+			flush();
+		memcpy(pptr(), s, n);
+		pbump(n);
+		return n;
+	}
+
+	int sync() override
+	{
+		flush();
+		return target->pubsync();
+	}
+};
+
 void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 {
 	const char *str = id.c_str();
@@ -72,6 +129,8 @@ void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 void reset_auto_counter(RTLIL::Module *module)
 {
 	auto_name_map.clear();
+	id_cache.clear();
+	id_cache_norename.clear();
 	auto_name_counter = 0;
 	auto_name_offset = 0;
 
@@ -104,11 +163,18 @@ std::string next_auto_id()
 
 std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 {
+	// Netlists refer to the same names over and over again, so the escaping
+	// result is memoized (per module, see reset_auto_counter).
+	auto &cache = may_rename ? id_cache : id_cache_norename;
+	auto cache_it = cache.find(internal_id);
+	if (cache_it != cache.end())
+		return cache_it->second;
+
 	const char *str = internal_id.c_str();
 	bool do_escape = false;
 
 	if (may_rename && auto_name_map.count(internal_id) != 0)
-		return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_map[internal_id]);
+		return cache[internal_id] = stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_map[internal_id]);
 
 	if (*str == '\\')
 		str++;
@@ -158,8 +224,8 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 		do_escape = true;
 
 	if (do_escape)
-		return "\\" + std::string(str) + " ";
-	return std::string(str);
+		return cache[internal_id] = "\\" + std::string(str) + " ";
+	return cache[internal_id] = std::string(str);
 }
 
 bool is_reg_wire(RTLIL::SigSpec sig, std::string &reg_name)
@@ -479,10 +545,16 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 				log_error("Can't open file `%s' for writing: %s\n", extmem_filename.c_str(), strerror(errno));
 			else
 			{
-				Const data = mem.get_init_data();
+				auto init_intervals = mem.get_init_intervals();
+				int init_cursor = 0;
 				for (int i=0; i<mem.size; i++)
 				{
-					RTLIL::Const element = data.extract(i*mem.width, mem.width);
+					int addr = i + mem.start_offset;
+					while (init_cursor < GetSize(init_intervals) && init_intervals[init_cursor].first + GetSize(init_intervals[init_cursor].second) / mem.width <= addr)
+						init_cursor++;
+					RTLIL::Const element(State::Sx, mem.width);
+					if (init_cursor < GetSize(init_intervals) && init_intervals[init_cursor].first <= addr)
+						element = init_intervals[init_cursor].second.extract((addr - init_intervals[init_cursor].first) * mem.width, mem.width);
 					for (int j=0; j<element.size(); j++)
 					{
 						switch (element[element.size()-j-1])
@@ -2491,6 +2563,8 @@ struct VerilogBackend : public Backend {
 		bool selected = false;
 
 		auto_name_map.clear();
+		id_cache.clear();
+		id_cache_norename.clear();
 		reg_wires.clear();
 
 		size_t argidx;
@@ -2589,7 +2663,10 @@ struct VerilogBackend : public Backend {
 
 		design->sort();
 
-		*f << stringf("/* Generated by %s */\n", yosys_version_str);
+		ChunkedStreambuf outbuf(f->rdbuf());
+		std::ostream bf(&outbuf);
+
+		bf << stringf("/* Generated by %s */\n", yosys_version_str);
 		for (auto module : design->modules()) {
 			if (module->get_blackbox_attribute() != blackboxes)
 				continue;
@@ -2599,10 +2676,13 @@ struct VerilogBackend : public Backend {
 				continue;
 			}
 			log("Dumping module `%s'.\n", module->name.c_str());
-			dump_module(*f, "", module);
+			dump_module(bf, "", module);
 		}
+		outbuf.flush();
 
 		auto_name_map.clear();
+		id_cache.clear();
+		id_cache_norename.clear();
 		reg_wires.clear();
 	}
 } VerilogBackend;
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+#
+# Deterministic corpus generator for the benchmark harness. Every design is
+# derived from a pinned seed, so each checkout benchmarks exactly the same
+# input and results are comparable across machines and revisions.
+
+import random
+import os
+
+random.seed(20250826)
+
+
+def const(width):
+    return "%d'h%0*x" % (width, (width + 3) // 4, random.getrandbits(width))
+
+
+def write_datapath(filename, stages=150, width=64):
+    # A deep register pipeline with a deterministic mix of arithmetic and
+    # bitwise stages, exercising synth's coarse and fine-grained phases.
+    with open(filename, "w") as f:
+        f.write("// generated by corpus/generate.py -- do not edit\n")
+        f.write("module datapath(input clk, input [%d:0] a, input [%d:0] b, "
+                "output reg [%d:0] q);\n" % (width-1, width-1, width-1))
+        for i in range(stages):
+            f.write("\treg [%d:0] r%d;\n" % (width-1, i))
+        f.write("\talways @(posedge clk) begin\n")
+        f.write("\t\tr0 <= a ^ b;\n")
+        f.write("\t\tr1 <= a + b;\n")
+        for i in range(2, stages):
+            prev = "r%d" % (i-1)
+            other = "r%d" % random.randrange(i-1)
+            op = random.choice(["add", "sub", "xor", "andor", "shift", "mux"])
+            if op == "add":
+                expr = "%s + %s" % (prev, const(width))
+            elif op == "sub":
+                expr = "%s - %s" % (prev, other)
+            elif op == "xor":
+                expr = "%s ^ %s" % (prev, other)
+            elif op == "andor":
+                expr = "(%s & %s) | %s" % (prev, const(width), other)
+            elif op == "shift":
+                k = random.randrange(1, width)
+                expr = "(%s << %d) ^ (%s >> %d)" % (prev, k, prev, width-k)
+            else:
+                expr = "%s[0] ? %s : %s" % (prev, other, const(width))
+            f.write("\t\tr%d <= %s;\n" % (i, expr))
+        f.write("\t\tq <= r%d;\n" % (stages-1))
+        f.write("\tend\nendmodule\n")
+
+
+def write_control(filename, outputs=8, cases=32, width=32):
+    # Wide behavioral case statements with deliberately repeated
+    # subexpressions, giving proc, opt -full and the sharing passes work.
+    shared = ["a + b", "a ^ b", "a & ~b", "(a << 1) | (b >> 1)"]
+    with open(filename, "w") as f:
+        f.write("// generated by corpus/generate.py -- do not edit\n")
+        ports = ", ".join("output reg [%d:0] y%d" % (width-1, i)
+                          for i in range(outputs))
+        f.write("module control(input [7:0] sel, input [%d:0] a, "
+                "input [%d:0] b, %s);\n" % (width-1, width-1, ports))
+        for i in range(outputs):
+            f.write("\talways @* begin\n")
+            f.write("\t\tcase (sel)\n")
+            for sel in random.sample(range(256), cases):
+                if random.random() < 0.5:
+                    expr = random.choice(shared)
+                else:
+                    expr = "%s %s %s" % (random.choice(["a", "b"]),
+                                         random.choice(["+", "-", "^", "&", "|"]),
+                                         const(width))
+                f.write("\t\t8'h%02x: y%d = %s;\n" % (sel, i, expr))
+            f.write("\t\tdefault: y%d = %s;\n" % (i, random.choice(shared)))
+            f.write("\t\tendcase\n")
+            f.write("\tend\n")
+        f.write("endmodule\n")
+
+
+def write_mem(filename):
+    # Several block memories with sparse initialization, covering the
+    # memory_collect/memory_share/memory_map pipeline.
+    sizes = [256, 512, 1024, 1024]
+    with open(filename, "w") as f:
+        f.write("// generated by corpus/generate.py -- do not edit\n")
+        f.write("module mem_top(input clk, input we, input [9:0] wa, "
+                "input [9:0] ra, input [31:0] wd")
+        for i in range(len(sizes)):
+            f.write(", output reg [31:0] rd%d" % i)
+        f.write(");\n")
+        for i, size in enumerate(sizes):
+            f.write("\treg [31:0] mem%d [0:%d];\n" % (i, size-1))
+        f.write("\tinitial begin\n")
+        for i, size in enumerate(sizes):
+            for addr in sorted(random.sample(range(size), 16)):
+                f.write("\t\tmem%d[%d] = %s;\n" % (i, addr, const(32)))
+        f.write("\tend\n")
+        f.write("\talways @(posedge clk) begin\n")
+        for i, size in enumerate(sizes):
+            bits = size.bit_length() - 1
+            f.write("\t\tif (we) mem%d[wa[%d:0]] <= wd;\n" % (i, bits-1))
+            f.write("\t\trd%d <= mem%d[ra[%d:0]];\n" % (i, i, bits-1))
+        f.write("\tend\nendmodule\n")
+
+
+def write_sat(filename, width=32):
+    # Behavioral adder vs. structural ripple-carry adder, proven equivalent
+    # by miter+sat in the sat flow.
+    with open(filename, "w") as f:
+        f.write("// generated by corpus/generate.py -- do not edit\n")
+        f.write("module gold(input [%d:0] a, input [%d:0] b, input cin, "
+                "output [%d:0] y, output cout);\n" % (width-1, width-1, width-1))
+        f.write("\tassign {cout, y} = a + b + cin;\n")
+        f.write("endmodule\n\n")
+        f.write("module gate(input [%d:0] a, input [%d:0] b, input cin, "
+                "output [%d:0] y, output cout);\n" % (width-1, width-1, width-1))
+        f.write("\twire [%d:0] c;\n" % width)
+        f.write("\tassign c[0] = cin;\n")
+        for i in range(width):
+            f.write("\tassign y[%d] = a[%d] ^ b[%d] ^ c[%d];\n" % (i, i, i, i))
+            f.write("\tassign c[%d] = (a[%d] & b[%d]) | (a[%d] & c[%d]) | "
+                    "(b[%d] & c[%d]);\n" % (i+1, i, i, i, i, i, i))
+        f.write("\tassign cout = c[%d];\n" % width)
+        f.write("endmodule\n")
+
+
+if __name__ == "__main__":
+    os.chdir(os.path.dirname(os.path.abspath(__file__)))
+    write_datapath("datapath.v")
+    write_control("control.v")
+    write_mem("mem.v")
+    write_sat("sat.v")
@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+set -eu
+
+# Benchmark driver. Runs each flow in flows/ over the pinned corpus for a
+# fixed number of iterations and leaves one perfreport JSON file per
+# iteration in results/. See README.md for details.
+
+YOSYS=${YOSYS:-../yosys}
+BENCH_ITER=${BENCH_ITER:-3}
+BENCH_FLOWS=${BENCH_FLOWS:-"synth opt_full memory sat abc9"}
+
+python3 corpus/generate.py
+
+mkdir -p results
+rm -f results/*.json
+
+for flow in $BENCH_FLOWS; do
+	for i in $(seq 1 "$BENCH_ITER"); do
+		echo "Running flow '$flow' (iteration $i of $BENCH_ITER).."
+		if ! "$YOSYS" -q "flows/$flow.ys"; then
+			if [ "$flow" = "abc9" ]; then
+				echo "Flow 'abc9' failed (no ABC binary available?), skipping."
+				rm -f results/abc9.json
+				break
+			fi
+			echo "Flow '$flow' failed."
+			exit 1
+		fi
+		mv "results/$flow.json" "results/$flow.iter$i.json"
+	done
+done
+
+python3 summarize.py results
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+#
+# Aggregate the per-iteration perfreport JSON files written by run-bench.sh
+# into a per-flow summary. The JSON files themselves are the machine-readable
+# record; this only prints a human-readable digest.
+
+import collections
+import glob
+import json
+import os
+import sys
+
+
+def main(results_dir):
+    flows = collections.defaultdict(list)
+    for filename in sorted(glob.glob(os.path.join(results_dir, "*.iter*.json"))):
+        flow = os.path.basename(filename).split(".iter")[0]
+        with open(filename) as f:
+            flows[flow].append(json.load(f)["commands"])
+
+    if not flows:
+        print("No results found in %s." % results_dir)
+        return 1
+
+    print()
+    print("  %-10s %5s %10s %10s %14s" %
+          ("flow", "iters", "wall [s]", "cpu [s]", "peak rss [kB]"))
+    for flow, iterations in sorted(flows.items()):
+        # report the fastest iteration (least interference from the system)
+        walls, cpus, rss = [], [], []
+        for commands in iterations:
+            top = [rec for rec in commands if rec["depth"] == 0]
+            walls.append(sum(rec["wall_s"] for rec in top))
+            cpus.append(sum(rec["cpu_s"] for rec in top))
+            rss.append(sum(rec["peak_rss_delta_kb"] for rec in top))
+        best = walls.index(min(walls))
+        print("  %-10s %5d %10.3f %10.3f %14d" %
+              (flow, len(iterations), walls[best], cpus[best], rss[best]))
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1] if len(sys.argv) > 1 else "results"))
@@ -31,6 +31,8 @@
 #include "libs/sha1/sha1.h"
 #include "ast.h"
 
+#include <unordered_set>
+
 YOSYS_NAMESPACE_BEGIN
 
 using namespace AST;
@@ -199,6 +201,76 @@ bool AstNode::get_bool_attribute(RTLIL::IdString id)
 	return attr->integer != 0;
 }
 
+// arena for AstNode storage: nodes are allocated from large blocks and
+// recycled through a free list, which keeps the millions of short-lived
+// nodes created by parsing and simplify() off the global heap. All blocks
+// are freed together once the last node has been deleted, i.e. typically
+// when the last AstModule of a design is destroyed.
+namespace {
+	struct AstNodeArena
+	{
+		static const int nodes_per_block = 4096;
+
+		std::vector<char*> blocks;
+		void *free_list = nullptr;
+		size_t used_nodes = 0;
+
+		void *alloc()
+		{
+			if (free_list == nullptr) {
+				char *block = (char*)malloc(nodes_per_block * sizeof(AstNode));
+				if (block == nullptr)
+					throw std::bad_alloc();
+				blocks.push_back(block);
+				for (int i = nodes_per_block-1; i >= 0; i--) {
+					void *node = block + i*sizeof(AstNode);
+					*(void**)node = free_list;
+					free_list = node;
+				}
+			}
+			void *node = free_list;
+			free_list = *(void**)node;
+			used_nodes++;
+			return node;
+		}
+
+		void free(void *node)
+		{
+			*(void**)node = free_list;
+			free_list = node;
+			if (--used_nodes == 0) {
+				for (auto block : blocks)
+					::free(block);
+				blocks.clear();
+				free_list = nullptr;
+			}
+		}
+	};
+
+	AstNodeArena astnode_arena;
+}
+
+void *AstNode::operator new(size_t size)
+{
+	log_assert(size == sizeof(AstNode));
+	return astnode_arena.alloc();
+}
+
+// std::unordered_set is node-based, so the interned strings keep stable
+// addresses across rehashes. The table is never pruned: the set of distinct
+// source filenames is tiny compared to the number of nodes referencing them.
+const std::string *AstFilename::intern(const std::string &str)
+{
+	static std::unordered_set<std::string> interned_filenames;
+	return &*interned_filenames.insert(str).first;
+}
+
+void AstNode::operator delete(void *ptr)
+{
+	if (ptr != nullptr)
+		astnode_arena.free(ptr);
+}
+
 // create new node (AstNode constructor)
 // (the optional child arguments make it easier to create AST trees)
 AstNode::AstNode(AstNodeType type, AstNode *child1, AstNode *child2, AstNode *child3, AstNode *child4)
@@ -232,6 +304,9 @@ AstNode::AstNode(AstNodeType type, AstNode *child1, AstNode *child2, AstNode *ch
 	realvalue = 0;
 	id2ast = NULL;
 	basic_prep = false;
+	simplify_stable_gen = 0;
+	simplify_stable_width = 0;
+	simplify_stable_args = 0;
 	lookahead = false;
 	in_lvalue_from_above = false;
 	in_param_from_above = false;
@@ -255,6 +330,8 @@ AstNode *AstNode::clone() const
 {
 	AstNode *that = new AstNode;
 	*that = *this;
+	// the copy lands in a new context, so its fixpoint marker does not apply
+	that->simplify_stable_gen = 0;
 	for (auto &it : that->children)
 		it = it->clone();
 	for (auto &it : that->attributes)
@@ -1304,6 +1381,27 @@ static RTLIL::Module *process_module(RTLIL::Design *design, AstNode *ast, bool d
 		log("--- END OF RTLIL DUMP ---\n");
 	}
 
+	{
+		// generate-heavy designs stamp the same parameter and attribute
+		// values many times over; deduplicate them through a per-module
+		// intern pool so all copies share one payload
+		pool<RTLIL::Const> intern_pool;
+		for (auto &attr : module->attributes)
+			attr.second.intern(intern_pool);
+		for (auto wire : module->wires())
+			for (auto &attr : wire->attributes)
+				attr.second.intern(intern_pool);
+		for (auto &mem : module->memories)
+			for (auto &attr : mem.second->attributes)
+				attr.second.intern(intern_pool);
+		for (auto cell : module->cells()) {
+			for (auto &attr : cell->attributes)
+				attr.second.intern(intern_pool);
+			for (auto &param : cell->parameters)
+				param.second.intern(intern_pool);
+		}
+	}
+
 	design->add(current_module);
 	return current_module;
 }
@@ -172,6 +172,24 @@ namespace AST
 	// convert an node type to a string (e.g. for debug output)
 	std::string type2str(AstNodeType type);
 
+	// Source filenames repeat across practically every AST node. This interns
+	// them in one shared table, so each node stores a pointer to a single
+	// allocation per distinct file instead of its own heap copy, and copying a
+	// node's filename is a pointer copy. Interned strings stay pinned for the
+	// lifetime of the process, like IdStrings.
+	struct AstFilename
+	{
+		const std::string *str_;
+		static const std::string *intern(const std::string &str);
+		AstFilename() : str_(intern(std::string())) {}
+		AstFilename(const std::string &str) : str_(intern(str)) {}
+		AstFilename &operator=(const std::string &str) { str_ = intern(str); return *this; }
+		operator const std::string &() const { return *str_; }
+		const std::string &str() const { return *str_; }
+		const char *c_str() const { return str_->c_str(); }
+		bool empty() const { return str_->empty(); }
+	};
+
 	// The AST is built using instances of this struct
 	struct AstNode
 	{
@@ -217,13 +235,21 @@ namespace AST
 		// this is used by simplify to detect if basic analysis has been performed already on the node
 		bool basic_prep;
 
+		// snapshot of the last simplify() call that left this subtree
+		// unchanged: later sweeps with the same arguments skip the whole
+		// subtree as long as no scope-affecting change happened in between
+		// (see the stable-subtree machinery in simplify.cc)
+		uint32_t simplify_stable_gen;
+		int simplify_stable_width;
+		uint8_t simplify_stable_args;
+
 		// this is used for ID references in RHS expressions that should use the "new" value for non-blocking assignments
 		bool lookahead;
 
 		// this is the original sourcecode location that resulted in this AST node
 		// it is automatically set by the constructor using AST::current_filename and
 		// the AST::get_line_num() callback function.
-		std::string filename;
+		AstFilename filename;
 		AstSrcLocType location;
 
 		// are we embedded in an lvalue, param?
@@ -233,6 +259,13 @@ namespace AST
 		bool in_lvalue_from_above;
 		bool in_param_from_above;
 
+		// AstNode storage is pooled: nodes are carved out of large arena
+		// blocks and recycled through a free list, so elaboration and the
+		// clone()/delete churn in simplify() stay off the global heap.
+		// The arena is released as a whole once the last node is gone.
+		static void *operator new(size_t size);
+		static void operator delete(void *ptr);
+
 		// creating and deleting nodes
 		AstNode(AstNodeType type = AST_NONE, AstNode *child1 = nullptr, AstNode *child2 = nullptr, AstNode *child3 = nullptr, AstNode *child4 = nullptr);
 		AstNode *clone() const;
@@ -62,10 +62,8 @@ static RTLIL::SigSpec uniop2rtlil(AstNode *that, IdString type, int result_width
 
 	cell->parameters[ID::A_SIGNED] = RTLIL::Const(that->children[0]->is_signed);
 	cell->parameters[ID::A_WIDTH] = RTLIL::Const(arg.size());
-	cell->setPort(ID::A, arg);
-
 	cell->parameters[ID::Y_WIDTH] = result_width;
-	cell->setPort(ID::Y, wire);
+	cell->setPorts({{ID::A, arg}, {ID::Y, wire}});
 	return wire;
 }
 
@@ -94,10 +92,8 @@ static void widthExtend(AstNode *that, RTLIL::SigSpec &sig, int width, bool is_s
 
 	cell->parameters[ID::A_SIGNED] = RTLIL::Const(is_signed);
 	cell->parameters[ID::A_WIDTH] = RTLIL::Const(sig.size());
-	cell->setPort(ID::A, sig);
-
 	cell->parameters[ID::Y_WIDTH] = width;
-	cell->setPort(ID::Y, wire);
+	cell->setPorts({{ID::A, sig}, {ID::Y, wire}});
 	sig = wire;
 }
 
@@ -123,12 +119,9 @@ static RTLIL::SigSpec binop2rtlil(AstNode *that, IdString type, int result_width
 
 	cell->parameters[ID::A_WIDTH] = RTLIL::Const(left.size());
 	cell->parameters[ID::B_WIDTH] = RTLIL::Const(right.size());
-
-	cell->setPort(ID::A, left);
-	cell->setPort(ID::B, right);
-
 	cell->parameters[ID::Y_WIDTH] = result_width;
-	cell->setPort(ID::Y, wire);
+
+	cell->setPorts({{ID::A, left}, {ID::B, right}, {ID::Y, wire}});
 	return wire;
 }
 
@@ -155,10 +148,7 @@ static RTLIL::SigSpec mux2rtlil(AstNode *that, const RTLIL::SigSpec &cond, const
 
 	cell->parameters[ID::WIDTH] = RTLIL::Const(left.size());
 
-	cell->setPort(ID::A, right);
-	cell->setPort(ID::B, left);
-	cell->setPort(ID::S, cond);
-	cell->setPort(ID::Y, wire);
+	cell->setPorts({{ID::A, right}, {ID::B, left}, {ID::S, cond}, {ID::Y, wire}});
 
 	return wire;
 }
@@ -723,7 +713,7 @@ struct AST_INTERNAL::ProcessGenerator
 			if (ast->str == "$display" || ast->str == "$displayb" || ast->str == "$displayh" || ast->str == "$displayo" ||
 		  ast->str == "$write"   || ast->str == "$writeb"   || ast->str == "$writeh"   || ast->str == "$writeo") {
 				std::stringstream sstr;
-				sstr << ast->str << "$" << ast->filename << ":" << ast->location.first_line << "$" << (autoidx++);
+				sstr << ast->str << "$" << ast->filename.str() << ":" << ast->location.first_line << "$" << (autoidx++);
 
 				Wire *en = current_module->addWire(sstr.str() + "_EN", 1);
 				set_src_attr(en, ast);
@@ -54,10 +54,60 @@ template<class I> I gcd(I a, I b) {
 	return std::abs(a);
 }
 
+// Generation counter for the stable-subtree markers on AstNode. It is bumped
+// whenever a change can be visible outside the changed subtree: declarations
+// and generate constructs feed current_scope, so identifiers anywhere in the
+// module may depend on them. Purely local expression rewrites only concern
+// the ancestors of the rewritten node, and those are still on the recursion
+// stack and see the change through their own did_something.
+static uint32_t simplify_stable_generation = 1;
+
+static bool simplify_scope_affecting(AstNodeType type)
+{
+	switch (type) {
+	case AST_MODULE:
+	case AST_INTERFACE:
+	case AST_INTERFACEPORT:
+	case AST_PACKAGE:
+	case AST_WIRE:
+	case AST_AUTOWIRE:
+	case AST_MEMORY:
+	case AST_PARAMETER:
+	case AST_LOCALPARAM:
+	case AST_DEFPARAM:
+	case AST_PARASET:
+	case AST_GENVAR:
+	case AST_GENFOR:
+	case AST_GENIF:
+	case AST_GENCASE:
+	case AST_GENBLOCK:
+	case AST_CELL:
+	case AST_FUNCTION:
+	case AST_TASK:
+	case AST_DPI_FUNCTION:
+	case AST_TYPEDEF:
+	case AST_ENUM:
+	case AST_ENUM_ITEM:
+	case AST_STRUCT:
+	case AST_UNION:
+	case AST_STRUCT_ITEM:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline uint8_t simplify_args_key(bool const_fold, int stage, bool sign_hint)
+{
+	return (const_fold ? 1 : 0) | (sign_hint ? 2 : 0) | (stage << 2);
+}
+
 void AstNode::set_in_lvalue_flag(bool flag, bool no_descend)
 {
 	if (flag != in_lvalue_from_above) {
 		in_lvalue_from_above = flag;
+		// the context this node was found stable in has changed
+		simplify_stable_gen = 0;
 		if (!no_descend)
 			fixup_hierarchy_flags();
 	}
@@ -67,6 +117,8 @@ void AstNode::set_in_param_flag(bool flag, bool no_descend)
 {
 	if (flag != in_param_from_above) {
 		in_param_from_above = flag;
+		// the context this node was found stable in has changed
+		simplify_stable_gen = 0;
 		if (!no_descend)
 			fixup_hierarchy_flags();
 	}
@@ -933,6 +985,10 @@ bool AstNode::simplify(bool const_fold, int stage, int width_hint, bool sign_hin
 	{
 		log_assert(type == AST_MODULE || type == AST_INTERFACE);
 
+		// stable-subtree markers carried over from earlier elaborations
+		// (e.g. on cloned parametric modules) are meaningless here
+		simplify_stable_generation++;
+
 		deep_recursion_warning = true;
 		while (simplify(const_fold, 1, width_hint, sign_hint)) { }
 
@@ -1031,11 +1087,28 @@ bool AstNode::simplify(bool const_fold, int stage, int width_hint, bool sign_hin
 				delete node;
 		}
 
+		// mem2reg above rewrites the tree without going through simplify,
+		// so no marker from before it is trustworthy
+		simplify_stable_generation++;
+
 		while (simplify(const_fold, 2, width_hint, sign_hint)) { }
 		recursion_counter--;
 		return false;
 	}
 
+	// skip subtrees that already reached their fixpoint in an earlier sweep
+	// with the same arguments; the marker is cleared whenever the node or
+	// its hierarchy flags change, and the generation check invalidates it
+	// whenever any scope-affecting change happened since it was set
+	if (simplify_stable_gen == simplify_stable_generation &&
+			simplify_stable_args == simplify_args_key(const_fold, stage, sign_hint) &&
+			simplify_stable_width == width_hint) {
+		recursion_counter--;
+		return false;
+	}
+
+	const AstNodeType entry_type = type;
+
 	current_filename = filename;
 
 	// we do not look inside a task or function
@@ -4408,6 +4481,16 @@ apply_newNode:
 	if (!did_something)
 		basic_prep = true;
 
+	if (did_something) {
+		simplify_stable_gen = 0;
+		if (simplify_scope_affecting(entry_type) || simplify_scope_affecting(type))
+			simplify_stable_generation++;
+	} else if (!unevaluated_tern_branch) {
+		simplify_stable_gen = simplify_stable_generation;
+		simplify_stable_width = width_hint;
+		simplify_stable_args = simplify_args_key(const_fold, stage, sign_hint);
+	}
+
 	recursion_counter--;
 	return did_something;
 }
@@ -4445,7 +4528,7 @@ AstNode *AstNode::readmem(bool is_readmemh, std::string mem_filename, AstNode *m
 #else
 		char slash = '/';
 #endif
-		std::string path = filename.substr(0, filename.find_last_of(slash)+1);
+		std::string path = filename.str().substr(0, filename.str().find_last_of(slash)+1);
 		f.open(path + mem_filename.c_str());
 		yosys_input_files.insert(path + mem_filename);
 	} else {
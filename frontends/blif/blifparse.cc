@@ -19,6 +19,13 @@
 
 #include "blifparse.h"
 
+#if !defined(_WIN32) && !defined(__wasm)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 YOSYS_NAMESPACE_BEGIN
 
 const int lut_input_plane_limit = 12;
@@ -57,6 +64,88 @@ static bool read_next_line(char *&buffer, size_t &buffer_size, int &line_count,
 	}
 }
 
+// Delivers the BLIF input one logical line at a time as a mutable
+// NUL-terminated string (the parser tokenizes with strtok). In buffer mode
+// the lines are terminated in place within the privately mapped file, so no
+// per-line copies are made; only continuation lines and the stream fallback
+// go through the assembly buffer.
+struct BlifLineSource
+{
+	std::istream *f = nullptr;
+	char *cursor = nullptr, *end = nullptr;
+	void *map_ptr = nullptr;
+	size_t map_size = 0;
+	char *buffer;
+	size_t buffer_size = 4096;
+	int line_count = 0;
+
+	BlifLineSource(std::istream &f) : f(&f) { buffer = (char*)malloc(buffer_size); }
+	BlifLineSource(char *data, size_t size) : cursor(data), end(data + size) { buffer = (char*)malloc(buffer_size); }
+
+	~BlifLineSource()
+	{
+		free(buffer);
+	#if !defined(_WIN32) && !defined(__wasm)
+		if (map_ptr != nullptr)
+			munmap(map_ptr, map_size);
+	#endif
+	}
+
+	void append_to_buffer(const char *p, size_t len, size_t &joined_len)
+	{
+		while (buffer_size < joined_len + len + 1) {
+			buffer_size *= 2;
+			buffer = (char*)realloc(buffer, buffer_size);
+		}
+		memcpy(buffer + joined_len, p, len);
+		joined_len += len;
+		buffer[joined_len] = 0;
+	}
+
+	bool next_line(char *&line)
+	{
+		if (cursor == nullptr) {
+			if (!read_next_line(buffer, buffer_size, line_count, *f))
+				return false;
+			line = buffer;
+			return true;
+		}
+
+		size_t joined_len = 0;
+		while (cursor != end)
+		{
+			char *p = cursor;
+			char *nl = (char*)memchr(p, '\n', end - p);
+			char *e = nl == nullptr ? end : nl;
+			cursor = nl == nullptr ? end : nl + 1;
+			line_count++;
+
+			while (e > p && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r' || e[-1] == '\n'))
+				e--;
+
+			if (e == p && joined_len == 0)
+				continue;
+
+			if (e > p && e[-1] == '\\') {
+				append_to_buffer(p, e - 1 - p, joined_len);
+				continue;
+			}
+
+			if (joined_len > 0 || e == end) {
+				append_to_buffer(p, e - p, joined_len);
+				line = buffer;
+				return true;
+			}
+
+			*e = 0;
+			line = p;
+			return true;
+		}
+
+		return false;
+	}
+};
+
 static std::pair<RTLIL::IdString, int> wideports_split(std::string name)
 {
 	int pos = -1;
@@ -84,7 +173,7 @@ failed:
 	return std::pair<RTLIL::IdString, int>(RTLIL::IdString(), 0);
 }
 
-void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool run_clean, bool sop_mode, bool wideports)
+static void parse_blif_source(RTLIL::Design *design, BlifLineSource &source, IdString dff_name, bool run_clean, bool sop_mode, bool wideports)
 {
 	RTLIL::Module *module = nullptr;
 	RTLIL::Const *lutptr = NULL;
@@ -94,28 +183,32 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 	std::string err_reason;
 	int blif_maxnum = 0, sopmode = -1;
 
-	auto blif_wire = [&](const std::string &wire_name) -> Wire*
+	// The builder caches intern wire names without constructing a temporary
+	// escaped std::string per token occurrence.
+	IdString::Builder escaped_names(std::string("\\")), raw_names;
+
+	auto blif_wire = [&](const char *wire_name) -> Wire*
 	{
 		if (wire_name[0] == '$')
 		{
-			for (int i = 0; i+1 < GetSize(wire_name); i++)
+			for (int i = 0; wire_name[i] && wire_name[i+1]; i++)
 			{
 				if (wire_name[i] != '$')
 					continue;
 
 				int len = 0;
-				while (i+len+1 < GetSize(wire_name) && '0' <= wire_name[i+len+1] && wire_name[i+len+1] <= '9')
+				while (wire_name[i+len+1] && '0' <= wire_name[i+len+1] && wire_name[i+len+1] <= '9')
 					len++;
 
 				if (len > 0) {
-					string num_str = wire_name.substr(i+1, len);
-					int num = atoi(num_str.c_str()) & 0x0fffffff;
+					int num = atoi(wire_name + i + 1) & 0x0fffffff;
 					blif_maxnum = std::max(blif_maxnum, num);
 				}
 			}
 		}
 
-		IdString wire_id = RTLIL::escape_id(wire_name);
+		IdString wire_id = (wire_name[0] != 0 && wire_name[0] != '\\' && wire_name[0] != '$') ?
+				escaped_names(wire_name) : raw_names(wire_name);
 		Wire *wire = module->wire(wire_id);
 
 		if (wire == nullptr)
@@ -129,24 +222,21 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 
 	dict<RTLIL::IdString, std::pair<int, bool>> wideports_cache;
 
-	size_t buffer_size = 4096;
-	char *buffer = (char*)malloc(buffer_size);
-	int line_count = 0;
+	char *line = nullptr;
 
 	while (1)
 	{
-		if (!read_next_line(buffer, buffer_size, line_count, f)) {
+		if (!source.next_line(line)) {
 			if (module != nullptr)
 				goto error;
-			free(buffer);
 			return;
 		}
 
 	continue_without_read:
-		if (buffer[0] == '#')
+		if (line[0] == '#')
 			continue;
 
-		if (buffer[0] == '.')
+		if (line[0] == '.')
 		{
 			if (lutptr) {
 				for (auto &bit : lutptr->bits())
@@ -161,7 +251,7 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 				sopmode = -1;
 			}
 
-			char *cmd = strtok(buffer, " \t\r\n");
+			char *cmd = strtok(line, " \t\r\n");
 
 			if (!strcmp(cmd, ".model")) {
 				if (module != nullptr)
@@ -175,7 +265,7 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 				obj_attributes = &module->attributes;
 				obj_parameters = nullptr;
 				if (design->module(module->name))
-					log_error("Duplicate definition of module %s in line %d!\n", log_id(module->name), line_count);
+					log_error("Duplicate definition of module %s in line %d!\n", log_id(module->name), source.line_count);
 				design->add(module);
 				continue;
 			}
@@ -482,20 +572,20 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 				{
 					RTLIL::State state = RTLIL::State::Sa;
 					while (1) {
-						if (!read_next_line(buffer, buffer_size, line_count, f))
+						if (!source.next_line(line))
 							goto error;
-						for (int i = 0; buffer[i]; i++) {
-							if (buffer[i] == ' ' || buffer[i] == '\t')
+						for (int i = 0; line[i]; i++) {
+							if (line[i] == ' ' || line[i] == '\t')
 								continue;
-							if (i == 0 && buffer[i] == '.')
+							if (i == 0 && line[i] == '.')
 								goto finished_parsing_constval;
-							if (buffer[i] == '0') {
+							if (line[i] == '0') {
 								if (state == RTLIL::State::S1)
 									goto error;
 								state = RTLIL::State::S0;
 								continue;
 							}
-							if (buffer[i] == '1') {
+							if (line[i] == '1') {
 								if (state == RTLIL::State::S0)
 									goto error;
 								state = RTLIL::State::S1;
@@ -550,7 +640,7 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 		if (lutptr == NULL && sopcell == NULL)
 			goto error;
 
-		char *input = strtok(buffer, " \t\r\n");
+		char *input = strtok(line, " \t\r\n");
 		char *output = strtok(NULL, " \t\r\n");
 
 		if (input == NULL || output == NULL || (strcmp(output, "0") && strcmp(output, "1")))
@@ -616,9 +706,43 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 	return;
 
 error:
-	log_error("Syntax error in line %d!\n", line_count);
+	log_error("Syntax error in line %d!\n", source.line_count);
 error_with_reason:
-	log_error("Syntax error in line %d: %s\n", line_count, err_reason.c_str());
+	log_error("Syntax error in line %d: %s\n", source.line_count, err_reason.c_str());
+}
+
+void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool run_clean, bool sop_mode, bool wideports)
+{
+	BlifLineSource source(f);
+	parse_blif_source(design, source, dff_name, run_clean, sop_mode, wideports);
+}
+
+void parse_blif_file(RTLIL::Design *design, const std::string &filename, IdString dff_name, bool run_clean, bool sop_mode, bool wideports)
+{
+#if !defined(_WIN32) && !defined(__wasm)
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+			// A private mapping lets the parser terminate lines in place:
+			// copy-on-write only dirties the pages that are actually touched.
+			void *map_ptr = mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if (map_ptr != MAP_FAILED) {
+				BlifLineSource source((char*)map_ptr, st.st_size);
+				source.map_ptr = map_ptr;
+				source.map_size = st.st_size;
+				parse_blif_source(design, source, dff_name, run_clean, sop_mode, wideports);
+				return;
+			}
+		} else
+			close(fd);
+	}
+#endif
+	std::ifstream f(filename);
+	if (f.fail())
+		log_error("Can't open BLIF file `%s'.\n", filename.c_str());
+	parse_blif(design, f, dff_name, run_clean, sop_mode, wideports);
 }
 
 struct BlifFrontend : public Frontend {
@@ -27,6 +27,11 @@ YOSYS_NAMESPACE_BEGIN
 extern void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name,
 		bool run_clean = false, bool sop_mode = false, bool wideports = false);
 
+// Like parse_blif(), but reads directly from a file. On platforms with mmap
+// the file is parsed from a private memory mapping without per-line copies.
+extern void parse_blif_file(RTLIL::Design *design, const std::string &filename, IdString dff_name,
+		bool run_clean = false, bool sop_mode = false, bool wideports = false);
+
 YOSYS_NAMESPACE_END
 
 #endif
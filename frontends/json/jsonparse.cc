@@ -242,6 +242,79 @@ struct JsonNode
 	}
 };
 
+int json_skip_to_token(std::istream &f, const char *also_skip = "")
+{
+	while (1)
+	{
+		int ch = f.get();
+
+		if (ch == EOF)
+			log_error("Unexpected EOF in JSON file.\n");
+
+		if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || strchr(also_skip, ch) != nullptr)
+			continue;
+
+		return ch;
+	}
+}
+
+// Skip one JSON value without building a JsonNode tree. This is used to
+// scan past modules that are not imported, so reading one module out of a
+// huge file needs neither time nor memory for the others.
+void json_skip_value(std::istream &f)
+{
+	int ch = json_skip_to_token(f);
+
+	if (ch == '"')
+	{
+		while (1)
+		{
+			ch = f.get();
+
+			if (ch == EOF)
+				log_error("Unexpected EOF in JSON string.\n");
+
+			if (ch == '\\' && f.get() == EOF)
+				log_error("Unexpected EOF in JSON string.\n");
+
+			if (ch == '"')
+				return;
+		}
+	}
+
+	if (ch == '[' || ch == '{')
+	{
+		int close = ch == '[' ? ']' : '}';
+
+		while (1)
+		{
+			ch = json_skip_to_token(f, ",:");
+
+			if (ch == close)
+				return;
+
+			f.unget();
+			json_skip_value(f);
+		}
+	}
+
+	if (strchr("-0123456789", ch) == nullptr)
+		log_error("Unexpected character in JSON file: '%c'\n", ch);
+
+	while (1)
+	{
+		ch = f.get();
+
+		if (ch == EOF)
+			return;
+
+		if (strchr("-+.0123456789eE", ch) == nullptr) {
+			f.unget();
+			return;
+		}
+	}
+}
+
 Const json_parse_attr_param_value(JsonNode *node)
 {
 	Const value;
@@ -625,41 +698,91 @@ struct JsonFrontend : public Frontend {
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    read_json [filename]\n");
+		log("    read_json [options] [filename]\n");
 		log("\n");
 		log("Load modules from a JSON file into the current design See \"help write_json\"\n");
 		log("for a description of the file format.\n");
 		log("\n");
+		log("    -module <name>\n");
+		log("        only load the named module from the file. This option can be used\n");
+		log("        multiple times. Other modules are skipped while scanning the file\n");
+		log("        without building a parse tree for them.\n");
+		log("\n");
+		log("The file is processed one module at a time, so peak memory usage is bounded\n");
+		log("by the largest module rather than the whole file.\n");
+		log("\n");
 	}
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing JSON frontend.\n");
 
+		pool<string> module_names;
+
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
-			// std::string arg = args[argidx];
-			// if (arg == "-sop") {
-			// 	sop_mode = true;
-			// 	continue;
-			// }
+			std::string arg = args[argidx];
+			if (arg == "-module" && argidx+1 < args.size()) {
+				module_names.insert(args[++argidx]);
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
-		JsonNode root(*f);
+		int ch = json_skip_to_token(*f);
 
-		if (root.type != 'D')
+		if (ch != '{')
 			log_error("JSON root node is not a dictionary.\n");
 
-		if (root.data_dict.count("modules") != 0)
+		while (1)
 		{
-			JsonNode *modules = root.data_dict.at("modules");
+			ch = json_skip_to_token(*f, ",");
+
+			if (ch == '}')
+				break;
 
-			if (modules->type != 'D')
+			f->unget();
+			JsonNode key(*f);
+
+			if (key.type != 'S')
+				log_error("Unexpected non-string key in JSON dict.\n");
+
+			if (key.data_string != "modules") {
+				ch = json_skip_to_token(*f, ":");
+				f->unget();
+				json_skip_value(*f);
+				continue;
+			}
+
+			ch = json_skip_to_token(*f, ":");
+
+			if (ch != '{')
 				log_error("JSON modules node is not a dictionary.\n");
 
-			for (auto &it : modules->data_dict)
-				json_import(design, it.first, it.second);
+			while (1)
+			{
+				ch = json_skip_to_token(*f, ",");
+
+				if (ch == '}')
+					break;
+
+				f->unget();
+				JsonNode modname(*f);
+
+				if (modname.type != 'S')
+					log_error("Unexpected non-string key in JSON dict.\n");
+
+				ch = json_skip_to_token(*f, ":");
+				f->unget();
+
+				if (!module_names.empty() && module_names.count(modname.data_string) == 0) {
+					json_skip_value(*f);
+					continue;
+				}
+
+				JsonNode mod_node(*f);
+				json_import(design, modname.data_string, &mod_node);
+			}
 		}
 	}
 } JsonFrontend;
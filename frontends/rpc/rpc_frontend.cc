@@ -29,8 +29,14 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 extern char **environ;
+#else
+#include <direct.h>
+#include <process.h>
 #endif
 
+#include <sys/stat.h>
+#include <fstream>
+
 #include "libs/json11/json11.hpp"
 #include "libs/sha1/sha1.h"
 #include "kernel/yosys.h"
@@ -70,6 +76,21 @@ static std::string get_last_error_str() {
 
 using json11::Json;
 
+static void encode_parameter(const RTLIL::Const &value, std::string &type, std::string &data)
+{
+	if (value.flags & RTLIL::CONST_FLAG_REAL) {
+		type = "real";
+		data = value.decode_string();
+	} else if (value.flags & RTLIL::CONST_FLAG_STRING) {
+		type = "string";
+		data = value.decode_string();
+	} else if ((value.flags & ~RTLIL::CONST_FLAG_SIGNED) == RTLIL::CONST_FLAG_NONE) {
+		type = (value.flags & RTLIL::CONST_FLAG_SIGNED) ? "signed" : "unsigned";
+		data = value.as_string();
+	} else
+		log_cmd_error("Unserializable constant flags 0x%x\n", value.flags);
+}
+
 struct RpcServer {
 	std::string name;
 
@@ -119,17 +140,7 @@ struct RpcServer {
 		Json::object json_parameters;
 		for (auto &param : parameters) {
 			std::string type, value;
-			if (param.second.flags & RTLIL::CONST_FLAG_REAL) {
-				type = "real";
-				value = param.second.decode_string();
-			} else if (param.second.flags & RTLIL::CONST_FLAG_STRING) {
-				type = "string";
-				value = param.second.decode_string();
-			} else if ((param.second.flags & ~RTLIL::CONST_FLAG_SIGNED) == RTLIL::CONST_FLAG_NONE) {
-				type = (param.second.flags & RTLIL::CONST_FLAG_SIGNED) ? "signed" : "unsigned";
-				value = param.second.as_string();
-			} else
-				log_cmd_error("Unserializable constant flags 0x%x\n", param.second.flags);
+			encode_parameter(param.second, type, value);
 			json_parameters[param.first.str()] = Json::object {
 				{ "type", type },
 				{ "value", value },
@@ -156,6 +167,23 @@ struct RpcServer {
 
 struct RpcModule : RTLIL::Module {
 	std::shared_ptr<RpcServer> server;
+	std::string cache_dir;
+
+	std::string cache_file_name(const std::string &stripped_name, const dict<RTLIL::IdString, RTLIL::Const> &parameters) {
+		// The key is built from sorted parameter lines, so it is stable
+		// across runs regardless of the dict iteration order.
+		std::vector<std::string> param_lines;
+		for (auto &param : parameters) {
+			std::string type, data;
+			encode_parameter(param.second, type, data);
+			param_lines.push_back(param.first.str() + " " + type + " " + data + "\n");
+		}
+		std::sort(param_lines.begin(), param_lines.end());
+		std::string key = stripped_name + "\n";
+		for (auto &line : param_lines)
+			key += line;
+		return cache_dir + "/" + sha1(key) + ".rpc";
+	}
 
 	RTLIL::IdString derive(RTLIL::Design *design, const dict<RTLIL::IdString, RTLIL::Const> &parameters, bool /*mayfail*/) override {
 		std::string stripped_name = name.str();
@@ -183,7 +211,38 @@ struct RpcModule : RTLIL::Module {
 			log("Found cached RTLIL representation for module `%s'.\n", derived_name.c_str());
 		} else {
 			std::string command, input;
-			std::tie(command, input) = server->derive_module(stripped_name.substr(1), parameters);
+			std::string cache_file;
+			bool cache_hit = false;
+			if (!cache_dir.empty()) {
+				cache_file = cache_file_name(stripped_name, parameters);
+				std::ifstream cache_stream(cache_file.c_str());
+				if (cache_stream.is_open() && std::getline(cache_stream, command)) {
+					std::stringstream buf;
+					buf << cache_stream.rdbuf();
+					input = buf.str();
+					cache_hit = true;
+					log("Using cached RPC response for module `%s'.\n", stripped_name.c_str());
+				}
+			}
+			if (!cache_hit)
+				std::tie(command, input) = server->derive_module(stripped_name.substr(1), parameters);
+
+			if (!cache_hit && !cache_file.empty()) {
+				// Write to a temporary file first, so concurrent Yosys
+				// processes sharing the cache never see a partial entry.
+#ifdef _WIN32
+				std::string temp_file = cache_file + stringf(".tmp%d", (int)_getpid());
+#else
+				std::string temp_file = cache_file + stringf(".tmp%d", (int)getpid());
+#endif
+				std::ofstream cache_stream(temp_file.c_str(), std::ofstream::trunc);
+				cache_stream << command << '\n' << input;
+				cache_stream.close();
+				if (cache_stream.fail() || std::rename(temp_file.c_str(), cache_file.c_str()) != 0) {
+					std::remove(temp_file.c_str());
+					log_warning("Failed to write RPC cache file `%s'.\n", cache_file.c_str());
+				}
+			}
 
 			std::istringstream input_stream(input);
 			RTLIL::Design *derived_design = new RTLIL::Design;
@@ -232,6 +291,7 @@ struct RpcModule : RTLIL::Module {
 	RTLIL::Module *clone() const override {
 		RpcModule *new_mod = new RpcModule;
 		new_mod->server = server;
+		new_mod->cache_dir = cache_dir;
 		cloneInto(new_mod);
 		return new_mod;
 	}
@@ -350,8 +410,8 @@ struct RpcFrontend : public Pass {
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    connect_rpc -exec <command> [args...]\n");
-		log("    connect_rpc -path <path>\n");
+		log("    connect_rpc [-cache <dir>] -exec <command> [args...]\n");
+		log("    connect_rpc [-cache <dir>] -path <path>\n");
 		log("\n");
 		log("Load modules using an out-of-process frontend.\n");
 		log("\n");
@@ -363,6 +423,12 @@ struct RpcFrontend : public Pass {
 		log("        connect to Unix domain socket at <path>. (Unix)\n");
 		log("        connect to bidirectional byte-type named pipe at <path>. (Windows)\n");
 		log("\n");
+		log("    -cache <dir>\n");
+		log("        store derive responses in <dir> and reuse them across Yosys runs.\n");
+		log("        the cache key is the module name and parameter values only, so the\n");
+		log("        directory must not be shared between different generators, and must\n");
+		log("        be cleared when the generator changes. (must precede -exec.)\n");
+		log("\n");
 		log("A simple JSON-based, newline-delimited protocol is used for communicating with\n");
 		log("the frontend. Yosys requests data from the frontend by sending exactly 1 line\n");
 		log("of JSON. Frontend responds with data or error message by replying with exactly\n");
@@ -396,6 +462,7 @@ struct RpcFrontend : public Pass {
 
 		std::vector<std::string> command;
 		std::string path;
+		std::string cache_dir;
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
 			std::string arg = args[argidx];
@@ -408,10 +475,23 @@ struct RpcFrontend : public Pass {
 				path = args[++argidx];
 				continue;
 			}
+			if (arg == "-cache" && argidx+1 < args.size()) {
+				cache_dir = args[++argidx];
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
+		if (!cache_dir.empty()) {
+			rewrite_filename(cache_dir);
+#ifdef _WIN32
+			_mkdir(cache_dir.c_str());
+#else
+			mkdir(cache_dir.c_str(), 0777);
+#endif
+		}
+
 		if ((!command.empty()) + (!path.empty()) != 1)
 			log_cmd_error("Exactly one of -exec, -unix must be specified.\n");
 
@@ -590,6 +670,7 @@ cleanup_path:
 			RpcModule *module = new RpcModule;
 			module->name = "$abstract\\" + module_name;
 			module->server = server;
+			module->cache_dir = cache_dir;
 			design->add(module);
 		}
 	}
@@ -23,6 +23,7 @@
  */
 
 #include "rtlil_frontend.h"
+#include "backends/rtlil/rtlil_binary.h"
 #include "kernel/register.h"
 #include "kernel/log.h"
 
@@ -92,6 +93,14 @@ struct RTLILFrontend : public Frontend {
 
 		log("Input filename: %s\n", filename.c_str());
 
+		// binary RTLIL files start with a 0xFF byte that can never begin
+		// the text format, so the two can be told apart by peeking
+		if (f->peek() == (RTLIL_BINARY::binary_magic[0] & 0xff)) {
+			RTLIL_BINARY::load_design_bin(*f, design, RTLIL_FRONTEND::flag_nooverwrite,
+					RTLIL_FRONTEND::flag_overwrite, RTLIL_FRONTEND::flag_lib);
+			return;
+		}
+
 		RTLIL_FRONTEND::lexin = f;
 		RTLIL_FRONTEND::current_design = design;
 		rtlil_frontend_yydebug = false;
@@ -44,9 +44,11 @@
 YOSYS_NAMESPACE_BEGIN
 using namespace VERILOG_FRONTEND;
 
-static std::list<std::string> output_code;
-static std::list<std::string> input_buffer;
-static size_t input_buffer_charp;
+// thread_local so that independent files can be preprocessed concurrently
+// (see the prefetching in verilog_frontend.cc)
+static thread_local std::list<std::string> output_code;
+static thread_local std::list<std::string> input_buffer;
+static thread_local size_t input_buffer_charp;
 
 static void return_char(char ch)
 {
@@ -749,7 +751,8 @@ frontend_verilog_preproc(std::istream                 &f,
                          std::string                   filename,
                          const define_map_t           &pre_defines,
                          define_map_t                 &global_defines_cache,
-                         const std::list<std::string> &include_dirs)
+                         const std::list<std::string> &include_dirs,
+                         std::set<std::string>        *input_files)
 {
 	define_map_t defines;
 	defines.merge(pre_defines);
@@ -913,7 +916,7 @@ frontend_verilog_preproc(std::istream                 &f,
 				output_code.push_back("`file_notfound " + fn);
 			} else {
 				input_file(ff, fixed_fn);
-				yosys_input_files.insert(fixed_fn);
+				(input_files ? *input_files : yosys_input_files).insert(fixed_fn);
 			}
 			continue;
 		}
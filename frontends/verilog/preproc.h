@@ -66,12 +66,17 @@ struct define_map_t
 
 struct define_map_t;
 
+// When `input_files' is given, files read via `include are recorded there
+// instead of in the global yosys_input_files set. This is used when the
+// preprocessor runs on a worker thread (verilog_frontend.cc), where the
+// global set must not be touched.
 std::string
 frontend_verilog_preproc(std::istream                 &f,
                          std::string                   filename,
                          const define_map_t           &pre_defines,
                          define_map_t                 &global_defines_cache,
-                         const std::list<std::string> &include_dirs);
+                         const std::list<std::string> &include_dirs,
+                         std::set<std::string>        *input_files = nullptr);
 
 YOSYS_NAMESPACE_END
 
@@ -31,6 +31,8 @@
 #include "kernel/yosys.h"
 #include "libs/sha1/sha1.h"
 #include <stdarg.h>
+#include <fstream>
+#include <future>
 
 YOSYS_NAMESPACE_BEGIN
 using namespace VERILOG_FRONTEND;
@@ -63,6 +65,125 @@ static void add_package_types(dict<std::string, AST::AstNode *> &user_types, std
 	}
 }
 
+// Background preprocessing of the files that follow the current one in a
+// multi-file read_verilog call (-threads). Jobs are keyed by the resolved
+// filename. Each job runs frontend_verilog_preproc() on a worker thread with
+// private copies of the define maps; the results are merged back on the main
+// thread when the file's turn comes, so lexing/parsing and everything that
+// touches the design stays serialized.
+struct VerilogPreprocJob
+{
+	std::future<std::string> text;
+	std::shared_ptr<define_map_t> global_defines;
+	std::shared_ptr<std::set<std::string>> input_files;
+	std::shared_ptr<bool> ok;
+	std::string options_sig;
+};
+
+static std::map<std::string, VerilogPreprocJob> verilog_preproc_jobs;
+
+static void verilog_preproc_jobs_clear()
+{
+	for (auto &it : verilog_preproc_jobs)
+		if (it.second.text.valid())
+			it.second.text.wait();
+	verilog_preproc_jobs.clear();
+}
+
+static void verilog_preproc_jobs_launch(int num_threads, const std::string &options_sig,
+		const define_map_t &defines_map, const define_map_t &global_defines,
+		const std::list<std::string> &include_dirs)
+{
+	for (size_t i = 1; i < Frontend::next_args.size(); i++)
+	{
+		if (GetSize(verilog_preproc_jobs) >= num_threads-1)
+			break;
+
+		std::string arg = Frontend::next_args[i];
+		if (arg == "-setattr" || arg == "-D" || arg == "-I" || arg == "-threads") {
+			i++;
+			continue;
+		}
+		if (arg.empty() || arg[0] == '-' || arg.compare(0, 2, "<<") == 0)
+			continue;
+
+		rewrite_filename(arg);
+		for (auto &filename : glob_filename(arg))
+		{
+			if (GetSize(verilog_preproc_jobs) >= num_threads-1)
+				break;
+			if (verilog_preproc_jobs.count(filename))
+				continue;
+
+			VerilogPreprocJob job;
+			job.global_defines = std::make_shared<define_map_t>();
+			job.global_defines->merge(global_defines);
+			job.input_files = std::make_shared<std::set<std::string>>();
+			job.ok = std::make_shared<bool>(false);
+			job.options_sig = options_sig;
+
+			auto pre_defines = std::make_shared<define_map_t>();
+			pre_defines->merge(defines_map);
+
+			auto global_ptr = job.global_defines;
+			auto files_ptr = job.input_files;
+			auto ok_ptr = job.ok;
+
+			job.text = std::async(std::launch::async, [filename, pre_defines, global_ptr, files_ptr, ok_ptr, include_dirs]() -> std::string {
+				std::ifstream ff(filename.c_str(), std::ifstream::in);
+				if (ff.fail())
+					return std::string();
+				// leave gzip'd sources to the main thread, which knows how
+				// to decompress them
+				if (ff.peek() == 0x1f)
+					return std::string();
+				std::string result = frontend_verilog_preproc(ff, filename, *pre_defines, *global_ptr, include_dirs, files_ptr.get());
+				*ok_ptr = true;
+				return result;
+			});
+
+			verilog_preproc_jobs.emplace(filename, std::move(job));
+		}
+	}
+}
+
+// Session cache of parsed ASTs, so re-reading unchanged sources in a warm
+// process skips the bison parser. An entry is keyed by everything that can
+// change the parse result besides the text itself (frontend options, filename
+// for location info, visible package/global type names) and revalidated
+// against the SHA1 of the preprocessed source, which already accounts for
+// includes and the define state. Elaboration still runs on a clone of the
+// cached AST, since AST::process() mutates and consumes its input.
+struct VerilogAstCacheEntry
+{
+	std::string key;
+	std::string content_sig;
+	std::unique_ptr<AST::AstNode> ast;
+	// `default_nettype directives are handled by the lexer, so their effect
+	// has to be replayed when the parser run is skipped
+	bool default_nettype_wire;
+};
+
+static std::vector<VerilogAstCacheEntry> verilog_ast_cache;
+
+// Feed the preprocessed text to the lexer in place. An istringstream would
+// copy the whole buffer, doubling the frontend's peak memory on large inputs.
+// The stream does not own the text; the caller keeps it alive during parsing
+// and can free it before elaboration.
+struct InplaceStreambuf : std::streambuf
+{
+	InplaceStreambuf(std::string &text) {
+		setg(&text[0], &text[0], &text[0] + text.size());
+	}
+};
+
+// the streambuf is a base class so it is fully constructed before the
+// std::istream base receives its address
+struct InplaceStream : private InplaceStreambuf, public std::istream
+{
+	InplaceStream(std::string &text) : InplaceStreambuf(text), std::istream(this) {}
+};
+
 struct VerilogFrontend : public Frontend {
 	VerilogFrontend() : Frontend("verilog", "read modules from Verilog file") { }
 	void help() override
@@ -165,6 +286,13 @@ struct VerilogFrontend : public Frontend {
 		log("    -nopp\n");
 		log("        do not run the pre-processor\n");
 		log("\n");
+		log("    -threads <N>\n");
+		log("        when multiple files are given, pre-process up to N files in\n");
+		log("        parallel, overlapping the pre-processing of upcoming files with\n");
+		log("        parsing of the current one. Files in one call must then not\n");
+		log("        depend on `define/`undef side effects of their siblings; macros\n");
+		log("        still carry over between separate read_verilog calls.\n");
+		log("\n");
 		log("    -nodpi\n");
 		log("        disable DPI-C support\n");
 		log("\n");
@@ -262,6 +390,7 @@ struct VerilogFrontend : public Frontend {
 		bool flag_noblackbox = false;
 		bool flag_nowb = false;
 		bool flag_nosynthesis = false;
+		int num_threads = 1;
 		define_map_t defines_map;
 
 		std::list<std::string> include_dirs;
@@ -380,6 +509,10 @@ struct VerilogFrontend : public Frontend {
 				flag_nopp = true;
 				continue;
 			}
+			if (arg == "-threads" && argidx+1 < args.size()) {
+				num_threads = max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
 			if (arg == "-nodpi") {
 				flag_nodpi = true;
 				continue;
@@ -468,6 +601,12 @@ struct VerilogFrontend : public Frontend {
 		if (formal_mode || !flag_nosynthesis)
 			defines_map.add(formal_mode ? "FORMAL" : "SYNTHESIS", "1");
 
+		// prefetched preprocessor output is only valid for the same options
+		// and the same state of the global defines
+		std::string options_sig;
+		for (size_t i = 0; i < argidx; i++)
+			options_sig += args[i] + "\n";
+
 		extra_args(f, filename, args, argidx);
 
 		log_header(design, "Executing Verilog-2005 frontend: %s\n", filename.c_str());
@@ -485,10 +624,33 @@ struct VerilogFrontend : public Frontend {
 		std::string code_after_preproc;
 
 		if (!flag_nopp) {
-			code_after_preproc = frontend_verilog_preproc(*f, filename, defines_map, *design->verilog_defines, include_dirs);
+			bool prefetched = false;
+			std::string expected_sig = options_sig + stringf("%p/%d", (void*)design, GetSize(design->verilog_defines->defines));
+			auto it = verilog_preproc_jobs.find(filename);
+			if (it == verilog_preproc_jobs.end()) {
+				// first file of a command: drop anything left behind by an
+				// earlier aborted command
+				verilog_preproc_jobs_clear();
+			} else {
+				std::string text = it->second.text.get();
+				if (*it->second.ok && it->second.options_sig == expected_sig) {
+					code_after_preproc = std::move(text);
+					design->verilog_defines->merge(*it->second.global_defines);
+					for (auto &fn : *it->second.input_files)
+						yosys_input_files.insert(fn);
+					prefetched = true;
+				}
+				verilog_preproc_jobs.erase(it);
+			}
+			if (!prefetched)
+				code_after_preproc = frontend_verilog_preproc(*f, filename, defines_map, *design->verilog_defines, include_dirs);
+			if (num_threads > 1)
+				verilog_preproc_jobs_launch(num_threads,
+						options_sig + stringf("%p/%d", (void*)design, GetSize(design->verilog_defines->defines)),
+						defines_map, *design->verilog_defines, include_dirs);
 			if (flag_ppdump)
 				log("-- Verilog code after preprocessor --\n%s-- END OF DUMP --\n", code_after_preproc.c_str());
-			lexin = new std::istringstream(code_after_preproc);
+			lexin = new InplaceStream(code_after_preproc);
 		}
 
 		// make package typedefs available to parser
@@ -507,10 +669,58 @@ struct VerilogFrontend : public Frontend {
 		// add a new empty type map to allow overriding existing global definitions
 		user_type_stack.push_back(UserTypeMap());
 
-		frontend_verilog_yyset_lineno(1);
-		frontend_verilog_yyrestart(NULL);
-		frontend_verilog_yyparse();
-		frontend_verilog_yylex_destroy();
+		std::string cache_key, content_sig;
+		VerilogAstCacheEntry *cache_entry = nullptr;
+		bool reused_ast = false;
+
+		if (!flag_nopp) {
+			cache_key = options_sig + filename + "\n";
+			for (auto &type : pkg_user_types)
+				cache_key += type.first + "\n";
+			for (auto def : design->verilog_globals)
+				if (def->type == AST::AST_TYPEDEF)
+					cache_key += def->str + "\n";
+			content_sig = stringf("%zu:", code_after_preproc.size()) + sha1(code_after_preproc);
+
+			for (auto &entry : verilog_ast_cache)
+				if (entry.key == cache_key) {
+					cache_entry = &entry;
+					break;
+				}
+			if (cache_entry && cache_entry->content_sig == content_sig) {
+				log("Reusing cached AST for `%s'.\n", filename.c_str());
+				delete current_ast;
+				current_ast = cache_entry->ast->clone();
+				default_nettype_wire = cache_entry->default_nettype_wire;
+				reused_ast = true;
+			}
+		}
+
+		if (!reused_ast) {
+			frontend_verilog_yyset_lineno(1);
+			frontend_verilog_yyrestart(NULL);
+			frontend_verilog_yyparse();
+			frontend_verilog_yylex_destroy();
+
+			if (!flag_nopp) {
+				if (!cache_entry) {
+					verilog_ast_cache.push_back(VerilogAstCacheEntry());
+					cache_entry = &verilog_ast_cache.back();
+					cache_entry->key = cache_key;
+				}
+				cache_entry->content_sig = content_sig;
+				cache_entry->ast.reset(current_ast->clone());
+				cache_entry->default_nettype_wire = default_nettype_wire;
+			}
+		}
+
+		// release the preprocessed text before elaboration, which has its own
+		// memory peak
+		if (!flag_nopp) {
+			delete lexin;
+			lexin = nullptr;
+			std::string().swap(code_after_preproc);
+		}
 
 		for (auto &child : current_ast->children) {
 			if (child->type == AST::AST_MODULE)
@@ -526,9 +736,6 @@ struct VerilogFrontend : public Frontend {
 				flag_nomeminit, flag_nomem2reg, flag_mem2reg, flag_noblackbox, lib_mode, flag_nowb, flag_noopt, flag_icells, flag_pwires, flag_nooverwrite, flag_overwrite, flag_defer, default_nettype_wire);
 
 
-		if (!flag_nopp)
-			delete lexin;
-
 		// only the previous and new global type maps remain
 		log_assert(user_type_stack.size() == 2);
 		user_type_stack.clear();
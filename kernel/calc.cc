@@ -129,6 +129,46 @@ static RTLIL::State logic_xnor(RTLIL::State a, RTLIL::State b)
 	return a == b ? RTLIL::State::S1 : RTLIL::State::S0;
 }
 
+// Packed two-bit-per-state representation used by the word-parallel fast
+// paths of the bitwise operators: bit i of the val plane is set for S1,
+// bit i of the unk plane for any of x/z/a/m, neither for S0. This way 64
+// states are processed per machine word and the loops vectorize.
+
+static void pack_states(const RTLIL::Const &arg, int len, std::vector<uint64_t> &val, std::vector<uint64_t> &unk)
+{
+	int num_words = (len + 63) / 64;
+	val.assign(num_words, 0);
+	unk.assign(num_words, 0);
+	for (int i = 0; i < len && i < GetSize(arg); i++) {
+		RTLIL::State s = arg[i];
+		if (s == RTLIL::State::S1)
+			val[i / 64] |= uint64_t(1) << (i % 64);
+		else if (s != RTLIL::State::S0)
+			unk[i / 64] |= uint64_t(1) << (i % 64);
+	}
+}
+
+static RTLIL::Const unpack_states(const std::vector<uint64_t> &val, const std::vector<uint64_t> &unk, int len)
+{
+	std::vector<RTLIL::State> bits(len);
+	for (int i = 0; i < len; i++) {
+		if ((unk[i / 64] >> (i % 64)) & 1)
+			bits[i] = RTLIL::State::Sx;
+		else if ((val[i / 64] >> (i % 64)) & 1)
+			bits[i] = RTLIL::State::S1;
+		else
+			bits[i] = RTLIL::State::S0;
+	}
+	return RTLIL::Const(bits);
+}
+
+static uint64_t packed_word_mask(int word, int num_words, int len)
+{
+	if (word < num_words-1 || len % 64 == 0)
+		return ~uint64_t(0);
+	return (uint64_t(1) << (len % 64)) - 1;
+}
+
 RTLIL::Const RTLIL::const_not(const RTLIL::Const &arg1, const RTLIL::Const&, bool signed1, bool, int result_len)
 {
 	if (result_len < 0)
@@ -137,6 +177,15 @@ RTLIL::Const RTLIL::const_not(const RTLIL::Const &arg1, const RTLIL::Const&, boo
 	RTLIL::Const arg1_ext = arg1;
 	extend_u0(arg1_ext, result_len, signed1);
 
+	if (result_len >= 64) {
+		std::vector<uint64_t> av, au;
+		pack_states(arg1_ext, result_len, av, au);
+		int num_words = GetSize(av);
+		for (int w = 0; w < num_words; w++)
+			av[w] = ~av[w] & ~au[w] & packed_word_mask(w, num_words, result_len);
+		return unpack_states(av, au, result_len);
+	}
+
 	RTLIL::Const result(RTLIL::State::Sx, result_len);
 	for (auto i = 0; i < result_len; i++) {
 		if (i >= GetSize(arg1_ext))
@@ -150,7 +199,52 @@ RTLIL::Const RTLIL::const_not(const RTLIL::Const &arg1, const RTLIL::Const&, boo
 	return result;
 }
 
-static RTLIL::Const logic_wrapper(RTLIL::State(*logic_func)(RTLIL::State, RTLIL::State),
+enum class BitwiseOp { And, Or, Xor, Xnor };
+
+// word-parallel evaluation on the packed two-plane representation, 64
+// result states per iteration
+static RTLIL::Const logic_packed(BitwiseOp op, const RTLIL::Const &arg1, const RTLIL::Const &arg2, int result_len)
+{
+	std::vector<uint64_t> av, au, bv, bu;
+	pack_states(arg1, result_len, av, au);
+	pack_states(arg2, result_len, bv, bu);
+
+	int num_words = GetSize(av);
+	for (int w = 0; w < num_words; w++) {
+		uint64_t mask = packed_word_mask(w, num_words, result_len);
+		uint64_t rv, ru;
+		switch (op) {
+		case BitwiseOp::And: {
+				uint64_t zero = (~av[w] & ~au[w]) | (~bv[w] & ~bu[w]);
+				rv = av[w] & bv[w];
+				ru = (au[w] | bu[w]) & ~zero;
+				break;
+			}
+		case BitwiseOp::Or: {
+				uint64_t one = av[w] | bv[w];
+				rv = one;
+				ru = (au[w] | bu[w]) & ~one;
+				break;
+			}
+		case BitwiseOp::Xor:
+			ru = au[w] | bu[w];
+			rv = (av[w] ^ bv[w]) & ~ru;
+			break;
+		case BitwiseOp::Xnor:
+			ru = au[w] | bu[w];
+			rv = ~(av[w] ^ bv[w]) & ~ru;
+			break;
+		default:
+			log_abort();
+		}
+		av[w] = rv & mask;
+		au[w] = ru & mask;
+	}
+
+	return unpack_states(av, au, result_len);
+}
+
+static RTLIL::Const logic_wrapper(BitwiseOp op,
 		RTLIL::Const arg1, RTLIL::Const arg2, bool signed1, bool signed2, int result_len = -1)
 {
 	if (result_len < 0)
@@ -159,6 +253,17 @@ static RTLIL::Const logic_wrapper(RTLIL::State(*logic_func)(RTLIL::State, RTLIL:
 	extend_u0(arg1, result_len, signed1);
 	extend_u0(arg2, result_len, signed2);
 
+	if (result_len >= 64)
+		return logic_packed(op, arg1, arg2, result_len);
+
+	RTLIL::State (*logic_func)(RTLIL::State, RTLIL::State) = nullptr;
+	switch (op) {
+	case BitwiseOp::And:  logic_func = logic_and;  break;
+	case BitwiseOp::Or:   logic_func = logic_or;   break;
+	case BitwiseOp::Xor:  logic_func = logic_xor;  break;
+	case BitwiseOp::Xnor: logic_func = logic_xnor; break;
+	}
+
 	RTLIL::Const result(RTLIL::State::Sx, result_len);
 	for (auto i = 0; i < result_len; i++) {
 		RTLIL::State a = i < GetSize(arg1) ? arg1.bits()[i] : RTLIL::State::S0;
@@ -171,22 +276,22 @@ static RTLIL::Const logic_wrapper(RTLIL::State(*logic_func)(RTLIL::State, RTLIL:
 
 RTLIL::Const RTLIL::const_and(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_and, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(BitwiseOp::And, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_or(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_or, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(BitwiseOp::Or, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_xor(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_xor, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(BitwiseOp::Xor, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_xnor(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_xnor, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(BitwiseOp::Xnor, arg1, arg2, signed1, signed2, result_len);
 }
 
 static RTLIL::Const logic_reduce_wrapper(RTLIL::State initial, RTLIL::State(*logic_func)(RTLIL::State, RTLIL::State), const RTLIL::Const &arg1, int result_len)
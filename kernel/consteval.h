@@ -38,11 +38,27 @@ struct ConstEval
 	std::vector<SigMap> stack;
 	RTLIL::State defaultval;
 
+	// Memoized topological cell order per top-level queried cone: the first
+	// query discovers the cone recursively and records the order, later
+	// queries (after clear()) replay it iteratively with all cell inputs
+	// already constant, so re-evaluating the same cone costs O(cone size)
+	// without deep recursion. Like sig2driver this assumes the module is not
+	// modified while the ConstEval object is in use.
+	dict<RTLIL::SigSpec, std::vector<RTLIL::Cell*>> cone_cache;
+	std::vector<RTLIL::Cell*> *cone_record = nullptr;
+	pool<RTLIL::Cell*> cone_record_seen;
+
 	ConstEval(RTLIL::Module *module, RTLIL::State defaultval = RTLIL::State::Sm) : module(module), assign_map(module), defaultval(defaultval)
 	{
-		CellTypes ct;
-		ct.setup_internals();
-		ct.setup_stdcells();
+		// Passes like fsm_extract construct a fresh ConstEval per analyzed
+		// object, and building these type tables dominated the constructor;
+		// share one immutable copy instead of rebuilding it every time.
+		static const CellTypes ct = []() {
+			CellTypes ct;
+			ct.setup_internals();
+			ct.setup_stdcells();
+			return ct;
+		}();
 
 		for (auto &it : module->cells_) {
 			if (!ct.cell_known(it.second->type))
@@ -87,6 +103,16 @@ struct ConstEval
 		stop_signals.add(sig);
 	}
 
+	// Successful exit from eval(cell): append the cell to the cone record if
+	// one is being taken. Cells finish after their input cones, so the record
+	// ends up in topological order.
+	bool eval_done(RTLIL::Cell *cell)
+	{
+		if (cone_record != nullptr && cone_record_seen.insert(cell).second)
+			cone_record->push_back(cell);
+		return true;
+	}
+
 	bool eval(RTLIL::Cell *cell, RTLIL::SigSpec &undef)
 	{
 		if (cell->type == ID($lcu))
@@ -123,7 +149,7 @@ struct ConstEval
 			else
 				set(sig_co, RTLIL::Const(RTLIL::Sx, GetSize(sig_co)));
 
-			return true;
+			return eval_done(cell);
 		}
 
 		RTLIL::SigSpec sig_a, sig_b, sig_s, sig_y;
@@ -360,12 +386,47 @@ struct ConstEval
 			set(sig_y, eval_ret);
 		}
 
-		return true;
+		return eval_done(cell);
 	}
 
 	bool eval(RTLIL::SigSpec &sig, RTLIL::SigSpec &undef, RTLIL::Cell *busy_cell = NULL)
 	{
 		assign_map.apply(sig);
+
+		if (busy_cell == NULL && cone_record == nullptr && !sig.is_fully_const())
+		{
+			auto it = cone_cache.find(sig);
+			if (it != cone_cache.end()) {
+				RTLIL::SigSpec replay_sig = sig;
+				RTLIL::SigSpec replay_undef;
+				bool replay_ok = true;
+				for (auto cell : it->second)
+					if (!eval(cell, replay_undef)) {
+						replay_ok = false;
+						break;
+					}
+				if (replay_ok) {
+					values_map.apply(replay_sig);
+					if (replay_sig.is_fully_const()) {
+						sig = replay_sig;
+						return true;
+					}
+				}
+				// The recorded order doesn't cover this query (e.g. a mux now
+				// selects a different branch, or a stop signal got in the
+				// way). Fall through to the recursive path and extend the
+				// record.
+			}
+
+			cone_record = &cone_cache[sig];
+			cone_record_seen.clear();
+			for (auto cell : *cone_record)
+				cone_record_seen.insert(cell);
+			bool result = eval(sig, undef);
+			cone_record = nullptr;
+			return result;
+		}
+
 		values_map.apply(sig);
 
 		if (sig.is_fully_const())
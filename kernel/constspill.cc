@@ -0,0 +1,103 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/constspill.h"
+#include "kernel/log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32) && !defined(__wasm)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define CONSTSPILL_HAVE_MMAP
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+static FILE *spill_file = nullptr;
+static uint64_t spill_end = 0;
+
+static FILE *get_spill_file()
+{
+	if (spill_file == nullptr) {
+		std::string filename = make_temp_file(get_base_tmpdir() + "/yosys_spill_XXXXXX");
+		spill_file = fopen(filename.c_str(), "wb+");
+		if (spill_file == nullptr)
+			log_error("Can't create spill file `%s': %s\n", filename.c_str(), strerror(errno));
+#ifndef _WIN32
+		// the open handle keeps the file alive; unlinking it right away
+		// makes the OS reclaim the space when the handle goes away, no
+		// matter how the process exits
+		remove(filename.c_str());
+#endif
+	}
+	return spill_file;
+}
+
+ConstSpill::Region ConstSpill::write(const void *data, size_t bytes)
+{
+	Region region;
+	region.offset = spill_end;
+	region.bytes = bytes;
+
+	if (bytes > 0) {
+		FILE *f = get_spill_file();
+		if (fseek(f, 0, SEEK_END) != 0 || fwrite(data, bytes, 1, f) != 1)
+			log_error("Write to spill file failed: %s\n", strerror(errno));
+		fflush(f);
+		spill_end += bytes;
+	}
+
+	return region;
+}
+
+void ConstSpill::read(const Region &region, void *data)
+{
+	if (region.bytes == 0)
+		return;
+
+	FILE *f = get_spill_file();
+
+#ifdef CONSTSPILL_HAVE_MMAP
+	// map only the affected pages: the memcpy faults them in and the unmap
+	// drops them again, so a pass scanning many spilled constants doesn't
+	// re-accumulate the whole file in resident memory
+	static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+	uint64_t map_offset = region.offset - region.offset % page_size;
+	size_t map_bytes = size_t(region.offset - map_offset + region.bytes);
+	void *map = mmap(nullptr, map_bytes, PROT_READ, MAP_SHARED, fileno(f), off_t(map_offset));
+	if (map != MAP_FAILED) {
+		memcpy(data, (const char*)map + (region.offset - map_offset), region.bytes);
+		munmap(map, map_bytes);
+		return;
+	}
+#endif
+
+	if (fseek(f, long(region.offset), SEEK_SET) != 0 || fread(data, region.bytes, 1, f) != 1)
+		log_error("Read from spill file failed: %s\n", strerror(errno));
+}
+
+uint64_t ConstSpill::total_bytes()
+{
+	return spill_end;
+}
+
+YOSYS_NAMESPACE_END
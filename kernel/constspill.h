@@ -0,0 +1,57 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef CONSTSPILL_H
+#define CONSTSPILL_H
+
+#include "kernel/yosys_common.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Process-wide append-only spill file for large constant payloads, used by
+// RTLIL::Const::spill(). The file is created in the temp directory on first
+// use and immediately unlinked (on POSIX), so the space is reclaimed when
+// yosys exits, however it exits. Payloads are faulted back on demand through
+// an mmap of the affected region where available.
+//
+// Not thread-safe: like the IdString table and the constant string intern
+// table, spilling and faulting must happen on the main thread.
+struct ConstSpill
+{
+	// A contiguous payload in the spill file.
+	struct Region {
+		uint64_t offset = 0;
+		uint64_t bytes = 0;
+	};
+
+	// Append a payload to the spill file.
+	static Region write(const void *data, size_t bytes);
+
+	// Copy a previously written payload back into memory. data must have
+	// room for region.bytes bytes.
+	static void read(const Region &region, void *data);
+
+	// Total payload bytes appended so far. The file is append-only: space
+	// for payloads that were faulted back in is not reused.
+	static uint64_t total_bytes();
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
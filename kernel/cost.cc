@@ -17,6 +17,16 @@ unsigned int CellCosts::get(RTLIL::Module *mod)
 	return module_cost;
 }
 
+unsigned int CellCosts::get_selected(RTLIL::Module *mod)
+{
+	unsigned int total_cost = 0;
+	for (auto c : mod->selected_cells()) {
+		unsigned int new_cost = total_cost + get(c);
+		total_cost = new_cost >= total_cost ? new_cost : INT_MAX;
+	}
+	return total_cost;
+}
+
 static unsigned int y_coef(RTLIL::IdString type)
 {
 	if (
@@ -135,6 +145,18 @@ unsigned int port_width_sum(RTLIL::Cell *cell)
 }
 
 unsigned int CellCosts::get(RTLIL::Cell *cell)
+{
+	auto key = std::make_pair(cell->type, cell->parameters);
+	auto it = cell_cost_cache_.find(key);
+	if (it != cell_cost_cache_.end())
+		return it->second;
+
+	unsigned int cost = compute(cell);
+	cell_cost_cache_.emplace(std::move(key), cost);
+	return cost;
+}
+
+unsigned int CellCosts::compute(RTLIL::Cell *cell)
 {
 
 	// simple 1-bit cells
@@ -29,8 +29,14 @@ struct CellCosts
 
 	private:
 	dict<RTLIL::IdString, int> mod_cost_cache_;
+	// The heuristics in get(Cell*) only look at the cell type and parameters,
+	// so designs with many instances of the same cell shape pay for the
+	// heuristic chain only once per (type, parameters) pair.
+	dict<std::pair<RTLIL::IdString, dict<RTLIL::IdString, RTLIL::Const>>, unsigned int> cell_cost_cache_;
 	Design *design_ = nullptr;
 
+	unsigned int compute(RTLIL::Cell *cell);
+
 	public:
 	CellCosts(RTLIL::Design *design) : design_(design) { }
 
@@ -92,6 +98,9 @@ struct CellCosts
 	// Sum up the cell costs of all cells in the module
 	// and all its submodules recursively
 	unsigned int get(RTLIL::Module *mod);
+	// Sum up the cell costs of all selected cells in the module (without
+	// recursing into submodules)
+	unsigned int get_selected(RTLIL::Module *mod);
 };
 
 YOSYS_NAMESPACE_END
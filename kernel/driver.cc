@@ -178,6 +178,244 @@ extern char *yosys_argv0;
 extern char yosys_path[PATH_MAX];
 };
 #endif
+
+#ifndef _WIN32
+
+// Fork-server mode (--daemon): pay for yosys_setup(), the static pass
+// constructors, IdString pre-interning and -m plugin loads once, then serve
+// script runs by forking a worker from the warmed-up process per request.
+// The protocol matches the 'server' command framing: requests are a 32-bit
+// little-endian payload length followed by "<cwd>\0<scriptfile>", responses
+// a 32-bit little-endian payload length followed by one status byte ('0' on
+// success, '1' on error) and the captured log output.
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+
+static bool daemon_read_all(int fd, void *data, size_t len)
+{
+	char *p = (char*)data;
+	while (len > 0) {
+		ssize_t n = read(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n, len -= n;
+	}
+	return true;
+}
+
+static bool daemon_write_all(int fd, const void *data, size_t len)
+{
+	const char *p = (const char*)data;
+	while (len > 0) {
+		ssize_t n = write(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n, len -= n;
+	}
+	return true;
+}
+
+static bool daemon_send_frame(int fd, char status, const std::string &payload)
+{
+	uint32_t len = payload.size() + 1;
+	unsigned char len_bytes[4] = {
+		(unsigned char)(len & 0xff), (unsigned char)((len >> 8) & 0xff),
+		(unsigned char)((len >> 16) & 0xff), (unsigned char)((len >> 24) & 0xff)
+	};
+	return daemon_write_all(fd, len_bytes, 4) && daemon_write_all(fd, &status, 1) &&
+			daemon_write_all(fd, payload.data(), payload.size());
+}
+
+static int daemon_worker_fd = -1;
+static std::ostringstream *daemon_worker_capture = nullptr;
+
+// log_error() in a worker exits the process; this atexit hook makes sure
+// the client still receives the captured output and a failure status
+static void daemon_worker_error_atexit()
+{
+	log_flush();
+	if (daemon_worker_fd >= 0 && daemon_worker_capture != nullptr)
+		daemon_send_frame(daemon_worker_fd, '1', daemon_worker_capture->str());
+	_exit(1);
+}
+
+static void run_daemon(const std::string &socket_path)
+{
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(addr.sun_path))
+		log_error("Socket path `%s' is too long.\n", socket_path.c_str());
+	strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+	int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server_fd < 0)
+		log_error("Can't create socket: %s\n", strerror(errno));
+
+	unlink(socket_path.c_str());
+	if (bind(server_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server_fd, 16) < 0) {
+		close(server_fd);
+		log_error("Can't listen on `%s': %s\n", socket_path.c_str(), strerror(errno));
+	}
+
+	// workers are fire-and-forget; don't accumulate zombies and don't die
+	// on clients that hang up early
+	signal(SIGCHLD, SIG_IGN);
+	signal(SIGPIPE, SIG_IGN);
+
+	log("Daemon: serving script runs on `%s'. Send the script name 'shutdown' to stop.\n", socket_path.c_str());
+	log_flush();
+
+	while (1)
+	{
+		int client_fd = accept(server_fd, nullptr, nullptr);
+		if (client_fd < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		uint32_t len;
+		std::string request;
+		bool ok = daemon_read_all(client_fd, &len, sizeof(len));
+		if (ok) {
+			len = uint32_t(((unsigned char*)&len)[0]) | uint32_t(((unsigned char*)&len)[1]) << 8 |
+					uint32_t(((unsigned char*)&len)[2]) << 16 | uint32_t(((unsigned char*)&len)[3]) << 24;
+			request.resize(len);
+			ok = len == 0 || daemon_read_all(client_fd, &request[0], len);
+		}
+
+		size_t sep = request.find('\0');
+		if (!ok || sep == std::string::npos) {
+			close(client_fd);
+			continue;
+		}
+
+		std::string cwd = request.substr(0, sep);
+		std::string script = request.substr(sep + 1);
+
+		if (script == "shutdown") {
+			daemon_send_frame(client_fd, '0', "Daemon stopped.\n");
+			close(client_fd);
+			break;
+		}
+
+		pid_t pid = fork();
+
+		if (pid < 0) {
+			daemon_send_frame(client_fd, '1', stringf("Can't fork worker: %s\n", strerror(errno)));
+			close(client_fd);
+			continue;
+		}
+
+		if (pid == 0) {
+			// worker: one script on the warmed-up process image, all log
+			// output captured for the client, then exit without running
+			// the parent's cleanup
+			close(server_fd);
+
+			std::ostringstream capture;
+			daemon_worker_fd = client_fd;
+			daemon_worker_capture = &capture;
+			log_error_atexit = daemon_worker_error_atexit;
+			log_files.clear();
+			log_streams.clear();
+			log_streams.push_back(&capture);
+
+			char status = '0';
+			if (!cwd.empty() && chdir(cwd.c_str()) != 0) {
+				capture << stringf("Can't chdir to `%s': %s\n", cwd.c_str(), strerror(errno));
+				status = '1';
+			} else {
+				try {
+					run_frontend(script, "script");
+					yosys_design->check();
+				} catch (...) {
+					status = '1';
+				}
+			}
+
+			log_flush();
+			daemon_send_frame(client_fd, status, capture.str());
+			_exit(status == '0' ? 0 : 1);
+		}
+
+		close(client_fd);
+	}
+
+	close(server_fd);
+	unlink(socket_path.c_str());
+	log("Daemon on `%s' stopped.\n", socket_path.c_str());
+}
+
+static int run_daemon_client(const std::string &socket_path, const std::string &script)
+{
+	if (script.empty()) {
+		fprintf(stderr, "yosys: --daemon-client requires a script file (-s <scriptfile> or a file argument).\n");
+		return 1;
+	}
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "yosys: socket path `%s' is too long.\n", socket_path.c_str());
+		return 1;
+	}
+	strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "yosys: can't connect to daemon on `%s': %s\n", socket_path.c_str(), strerror(errno));
+		return 1;
+	}
+
+	char cwd[PATH_MAX];
+	if (getcwd(cwd, sizeof(cwd)) == nullptr)
+		cwd[0] = 0;
+
+	std::string request = std::string(cwd) + '\0' + script;
+	uint32_t len;
+	char status;
+
+	uint32_t request_len = request.size();
+	unsigned char len_bytes[4] = {
+		(unsigned char)(request_len & 0xff), (unsigned char)((request_len >> 8) & 0xff),
+		(unsigned char)((request_len >> 16) & 0xff), (unsigned char)((request_len >> 24) & 0xff)
+	};
+	if (!daemon_write_all(fd, len_bytes, 4) || !daemon_write_all(fd, request.data(), request.size())) {
+		fprintf(stderr, "yosys: can't send request to daemon: %s\n", strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	if (!daemon_read_all(fd, &len, sizeof(len)) ) {
+		fprintf(stderr, "yosys: no response from daemon.\n");
+		close(fd);
+		return 1;
+	}
+	len = uint32_t(((unsigned char*)&len)[0]) | uint32_t(((unsigned char*)&len)[1]) << 8 |
+			uint32_t(((unsigned char*)&len)[2]) << 16 | uint32_t(((unsigned char*)&len)[3]) << 24;
+	if (len < 1 || !daemon_read_all(fd, &status, 1)) {
+		fprintf(stderr, "yosys: malformed response from daemon.\n");
+		close(fd);
+		return 1;
+	}
+
+	std::string output(len - 1, 0);
+	if (len > 1 && !daemon_read_all(fd, &output[0], len - 1)) {
+		fprintf(stderr, "yosys: truncated response from daemon.\n");
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	fflush(stdout);
+	return status == '0' ? 0 : 1;
+}
+
+#endif /* !_WIN32 */
 #ifdef YOSYS_ENABLE_TCL
 namespace Yosys {
 	extern int yosys_tcl_iterp_init(Tcl_Interp *interp);
@@ -199,6 +437,8 @@ int main(int argc, char **argv)
 	std::string depsfile = "";
 	std::string topmodule = "";
 	std::string perffile = "";
+	std::string daemon_socket = "";
+	std::string daemon_client_socket = "";
 	bool scriptfile_tcl = false;
 	bool scriptfile_python = false;
 	bool print_banner = true;
@@ -243,6 +483,15 @@ int main(int argc, char **argv)
 					"For more complex synthesis jobs it is recommended to use the read_* and write_* " \
 					"commands in a script file instead of specifying input and output files on the " \
 					"command line.")
+#ifndef _WIN32
+		("daemon", "start a fork server on <socket>: initialize once (including -m plugins and any " \
+					"files and commands given), then run one script per connection in a forked " \
+					"worker, amortizing the startup cost (see --daemon-client)",
+			cxxopts::value<std::string>(), "<socket>")
+		("daemon-client", "run the script given with -s (or as file argument) on the daemon listening " \
+					"on <socket>, print its log output and exit with its status",
+			cxxopts::value<std::string>(), "<socket>")
+#endif // !_WIN32
 		("H", "print the command list")
 		("h,help", "print this help message. If given, print help for <command>.",
 			cxxopts::value<std::string>(), "[<command>]")
@@ -433,6 +682,16 @@ int main(int argc, char **argv)
 			log_experimentals_ignored.insert(ignores.begin(), ignores.end());
 		}
 		if (result.count("perffile")) perffile = result["perffile"].as<std::string>();
+#ifndef _WIN32
+		if (result.count("daemon")) {
+			daemon_socket = result["daemon"].as<std::string>();
+			run_shell = false;
+		}
+		if (result.count("daemon-client")) {
+			daemon_client_socket = result["daemon-client"].as<std::string>();
+			print_banner = false;
+		}
+#endif
 		if (result.count("infile")) {
 			frontend_files = result["infile"].as<std::vector<std::string>>();
 		}
@@ -460,6 +719,20 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+#ifndef _WIN32
+	if (!daemon_client_socket.empty()) {
+		// thin client: no yosys_setup(), the daemon does all the work
+		if (scriptfile_tcl || scriptfile_python) {
+			fprintf(stderr, "yosys: --daemon-client only supports yosys script files.\n");
+			exit(1);
+		}
+		std::string script = scriptfile;
+		if (script.empty() && !frontend_files.empty())
+			script = frontend_files.front();
+		exit(run_daemon_client(daemon_client_socket, script));
+	}
+#endif
+
 #if defined(YOSYS_ENABLE_READLINE) || defined(YOSYS_ENABLE_EDITLINE)
 	std::string state_dir;
 	#if defined(_WIN32)
@@ -599,6 +872,13 @@ int main(int argc, char **argv)
 	for (auto it = passes_commands.begin(); it != passes_commands.end(); it++)
 		run_pass(*it);
 
+#ifndef _WIN32
+	if (!daemon_socket.empty()) {
+		// everything up to this point (setup, plugins, files, commands) is
+		// part of the warmed-up image that each worker is forked from
+		run_daemon(daemon_socket);
+	} else
+#endif
 	if (run_tcl_shell) {
 #ifdef YOSYS_ENABLE_TCL
 		yosys_tcl_activate_repl();
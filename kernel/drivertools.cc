@@ -572,8 +572,10 @@ DriverMap::DriveBitId DriverMap::id_from_drive_bit(DriveBit const &bit)
 				if (wire_bit.wire->width == 1) {
 					log_assert(wire_bit.offset == 0);
 					isolated_drive_bits.emplace(offset, bit);
-				} else
-					drive_bits.emplace(offset, DriveBitWire(wire_bit.wire, 0));
+				} else {
+					log_assert(drive_bits.empty() || drive_bits.back().first < DriveBitId(offset));
+					drive_bits.emplace_back(offset, DriveBitWire(wire_bit.wire, 0));
+				}
 				next_offset += wire_bit.wire->width;
 			}
 			return insertion.first->second.id + wire_bit.offset;
@@ -588,8 +590,10 @@ DriverMap::DriveBitId DriverMap::id_from_drive_bit(DriveBit const &bit)
 				if (width == 1 && offset == 0) {
 					log_assert(port_bit.offset == 0);
 					isolated_drive_bits.emplace(offset, bit);
-				} else
-					drive_bits.emplace(offset, DriveBitPort(port_bit.cell, port_bit.port, 0));
+				} else {
+					log_assert(drive_bits.empty() || drive_bits.back().first < DriveBitId(offset));
+					drive_bits.emplace_back(offset, DriveBitPort(port_bit.cell, port_bit.port, 0));
+				}
 				next_offset += width;
 			}
 			return insertion.first->second.id + port_bit.offset;
@@ -606,7 +610,8 @@ DriveBit DriverMap::drive_bit_from_id(DriveBitId id)
 	if (found_isolated != isolated_drive_bits.end())
 		return found_isolated->second;
 
-	auto found = drive_bits.upper_bound(id);
+	auto found = std::upper_bound(drive_bits.begin(), drive_bits.end(), id,
+			[](DriveBitId id, std::pair<DriveBitId, DriveBit> const &entry) { return id < entry.first; });
 	if (found == drive_bits.begin()) {
 		return id < 0 ? DriveBit() : DriveBit((State) id.id);
 	}
@@ -825,8 +830,11 @@ DriveBit DriverMap::operator()(DriveBit const &bit)
 		return result;
 	}
 
-	DriveBitId bit_id = id_from_drive_bit(bit);
+	return resolve_bit_id(id_from_drive_bit(bit));
+}
 
+DriveBit DriverMap::resolve_bit_id(DriveBitId bit_id)
+{
 	DriveBitId bit_repr_id = same_driver.find(bit_id);
 
 	DriveBit bit_repr = drive_bit_from_id(bit_repr_id);
@@ -859,8 +867,23 @@ DriveSpec DriverMap::operator()(DriveSpec spec)
 {
 	DriveSpec result;
 
-	for (int i = 0, width = spec.size(); i != width; ++i)
-		result.append((*this)(spec[i]));
+	// Batch version of the single-bit query: for wire and port chunks the
+	// offset lookup in `id_from_drive_bit` is done once per chunk, with the
+	// remaining bit ids of the chunk being consecutive.
+	for (auto const &chunk : spec.chunks()) {
+		if (chunk.is_wire()) {
+			DriveBitId base = id_from_drive_bit(chunk.wire()[0]);
+			for (int i = 0; i != chunk.size(); ++i)
+				result.append(resolve_bit_id(base.id + i));
+		} else if (chunk.is_port()) {
+			DriveBitId base = id_from_drive_bit(chunk.port()[0]);
+			for (int i = 0; i != chunk.size(); ++i)
+				result.append(resolve_bit_id(base.id + i));
+		} else {
+			for (int i = 0; i != chunk.size(); ++i)
+				result.append((*this)(chunk[i]));
+		}
+	}
 
 	return result;
 }
@@ -1142,10 +1142,11 @@ private:
 	// for that cell port.
 	dict<pair<Cell *, IdString>, DriveBitId> port_offsets;
 
-	// For the inverse map that maps DriveBitIds back to DriveBits we use a
-	// sorted map containing only the first DriveBit for each wire and cell
-	// port.
-	std::map<DriveBitId, DriveBit> drive_bits;
+	// For the inverse map that maps DriveBitIds back to DriveBits we store
+	// only the first DriveBit for each wire and cell port. Offsets are
+	// allocated in strictly increasing order, so appending to a flat vector
+	// keeps it sorted for the binary search in `drive_bit_from_id`.
+	std::vector<std::pair<DriveBitId, DriveBit>> drive_bits;
 
 	// As a memory optimization for gate level net lists we store single-bit
 	// wires and cell ports in a `dict` which requires less memory and fewer
@@ -1252,6 +1253,10 @@ public:
 	DriveSpec operator()(DriveSpec spec);
 
 private:
+	// Query path shared by the single-bit and batch operator()s, starting
+	// from an already computed DriveBitId.
+	DriveBit resolve_bit_id(DriveBitId bit_id);
+
 	bool keep_wire(Wire *wire) {
 		// TODO configurable
 		return wire->has_attribute(ID(keep));
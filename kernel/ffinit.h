@@ -28,12 +28,34 @@ YOSYS_NAMESPACE_BEGIN
 struct FfInitVals
 {
 	const SigMap *sigmap;
-	dict<SigBit, std::pair<State,SigBit>> initbits;
+
+	// Init values are stored as packed per-wire arrays indexed by the offset
+	// of the canonical bit, so whole-register queries and updates touch one
+	// hash lookup per wire instead of one per bit. An entry exists for a bit
+	// iff origin[offset].wire is set; vals[offset] is Sx for absent entries,
+	// which makes per-bit lookups branch-free on the value side.
+	struct WireInits {
+		std::vector<RTLIL::State> vals;
+		std::vector<RTLIL::SigBit> origin;
+	};
+	dict<RTLIL::Wire*, WireInits> initwires;
+	dict<SigBit, std::pair<State,SigBit>> initconsts;
+
+	WireInits &wire_inits(RTLIL::Wire *wire)
+	{
+		auto &entry = initwires[wire];
+		if (entry.vals.empty()) {
+			entry.vals.assign(wire->width, State::Sx);
+			entry.origin.assign(wire->width, RTLIL::SigBit());
+		}
+		return entry;
+	}
 
 	void set(const SigMap *sigmap_, RTLIL::Module *module)
 	{
 		sigmap = sigmap_;
-		initbits.clear();
+		initwires.clear();
+		initconsts.clear();
 		for (auto wire : module->wires())
 		{
 			if (wire->attributes.count(ID::init) == 0)
@@ -50,33 +72,68 @@ struct FfInitVals
 				if (val != State::S0 && val != State::S1 && bit.wire != nullptr)
 					continue;
 
-				if (initbits.count(bit)) {
-					if (initbits.at(bit).first != val)
+				if (bit.wire == nullptr) {
+					auto it = initconsts.find(bit);
+					if (it != initconsts.end()) {
+						if (it->second.first != val)
+							log_error("Conflicting init values for signal %s (%s = %s != %s).\n",
+									log_signal(bit), log_signal(SigBit(wire, i)),
+									log_signal(val), log_signal(it->second.first));
+						continue;
+					}
+					initconsts[bit] = std::make_pair(val,SigBit(wire,i));
+					continue;
+				}
+
+				auto &entry = wire_inits(bit.wire);
+				if (entry.origin[bit.offset].wire != nullptr) {
+					if (entry.vals[bit.offset] != val)
 						log_error("Conflicting init values for signal %s (%s = %s != %s).\n",
 								log_signal(bit), log_signal(SigBit(wire, i)),
-								log_signal(val), log_signal(initbits.at(bit).first));
+								log_signal(val), log_signal(entry.vals[bit.offset]));
 					continue;
 				}
 
-				initbits[bit] = std::make_pair(val,SigBit(wire,i));
+				entry.vals[bit.offset] = val;
+				entry.origin[bit.offset] = SigBit(wire,i);
 			}
 		}
 	}
 
 	RTLIL::State operator()(RTLIL::SigBit bit) const
 	{
-		auto it = initbits.find((*sigmap)(bit));
-		if (it != initbits.end())
-			return it->second.first;
-		else
+		SigBit mbit = (*sigmap)(bit);
+		if (mbit.wire == nullptr) {
+			auto it = initconsts.find(mbit);
+			return it != initconsts.end() ? it->second.first : State::Sx;
+		}
+		auto it = initwires.find(mbit.wire);
+		if (it == initwires.end())
 			return State::Sx;
+		return it->second.vals[mbit.offset];
 	}
 
 	RTLIL::Const operator()(const RTLIL::SigSpec &sig) const
 	{
 		RTLIL::Const res;
-		for (auto bit : sig)
-			res.bits().push_back((*this)(bit));
+		res.bits().reserve(GetSize(sig));
+		SigSpec mapped = (*sigmap)(sig);
+		for (auto &chunk : mapped.chunks()) {
+			if (chunk.wire == nullptr) {
+				for (auto state : chunk.data) {
+					auto it = initconsts.find(state);
+					res.bits().push_back(it != initconsts.end() ? it->second.first : State::Sx);
+				}
+				continue;
+			}
+			auto it = initwires.find(chunk.wire);
+			if (it == initwires.end()) {
+				res.bits().insert(res.bits().end(), chunk.width, State::Sx);
+				continue;
+			}
+			auto &vals = it->second.vals;
+			res.bits().insert(res.bits().end(), vals.begin() + chunk.offset, vals.begin() + chunk.offset + chunk.width);
+		}
 		return res;
 	}
 
@@ -84,13 +141,25 @@ struct FfInitVals
 	{
 		SigBit mbit = (*sigmap)(bit);
 		SigBit abit = bit;
-		auto it = initbits.find(mbit);
-		if (it != initbits.end())
-			abit = it->second.second;
-		else if (val == State::Sx)
-			return;
-		log_assert(abit.wire);
-		initbits[mbit] = std::make_pair(val,abit);
+		if (mbit.wire == nullptr) {
+			auto it = initconsts.find(mbit);
+			if (it != initconsts.end())
+				abit = it->second.second;
+			else if (val == State::Sx)
+				return;
+			log_assert(abit.wire);
+			initconsts[mbit] = std::make_pair(val,abit);
+		} else {
+			auto it = initwires.find(mbit.wire);
+			if (it != initwires.end() && it->second.origin[mbit.offset].wire != nullptr)
+				abit = it->second.origin[mbit.offset];
+			else if (val == State::Sx)
+				return;
+			log_assert(abit.wire);
+			auto &entry = wire_inits(mbit.wire);
+			entry.vals[mbit.offset] = val;
+			entry.origin[mbit.offset] = abit;
+		}
 		auto it2 = abit.wire->attributes.find(ID::init);
 		if (it2 != abit.wire->attributes.end()) {
 			it2->second.bits()[abit.offset] = val;
@@ -123,7 +192,8 @@ struct FfInitVals
 
 	void clear()
 	{
-		initbits.clear();
+		initwires.clear();
+		initconsts.clear();
 	}
 
 	FfInitVals (const SigMap *sigmap, RTLIL::Module *module)
@@ -0,0 +1,86 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/fileprefetch.h"
+
+#include <fstream>
+#include <map>
+#include <thread>
+
+YOSYS_NAMESPACE_BEGIN
+
+struct PrefetchEntry
+{
+	std::thread reader;
+	std::string data;
+	bool ok = false;
+};
+
+// only touched from the main thread; the reader threads write exclusively
+// into their own entry, and joining the reader synchronizes that data
+static std::map<std::string, std::unique_ptr<PrefetchEntry>> prefetch_entries;
+
+void FilePrefetcher::start(const std::string &filename)
+{
+	if (prefetch_entries.count(filename))
+		return;
+
+	auto entry = std::unique_ptr<PrefetchEntry>(new PrefetchEntry);
+	PrefetchEntry *p = entry.get();
+
+	p->reader = std::thread([p, filename]() {
+		std::ifstream f(filename, std::ifstream::binary);
+		if (f.fail())
+			return;
+		std::ostringstream buf;
+		buf << f.rdbuf();
+		if (f.bad())
+			return;
+		p->data = buf.str();
+		p->ok = true;
+	});
+
+	prefetch_entries[filename] = std::move(entry);
+}
+
+bool FilePrefetcher::fetch(const std::string &filename, std::string &data)
+{
+	auto it = prefetch_entries.find(filename);
+	if (it == prefetch_entries.end())
+		return false;
+
+	if (it->second->reader.joinable())
+		it->second->reader.join();
+
+	bool ok = it->second->ok;
+	if (ok)
+		data = std::move(it->second->data);
+	prefetch_entries.erase(it);
+	return ok;
+}
+
+void FilePrefetcher::join_all()
+{
+	for (auto &it : prefetch_entries)
+		if (it.second->reader.joinable())
+			it.second->reader.join();
+	prefetch_entries.clear();
+}
+
+YOSYS_NAMESPACE_END
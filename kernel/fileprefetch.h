@@ -0,0 +1,52 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef FILEPREFETCH_H
+#define FILEPREFETCH_H
+
+#include "kernel/yosys_common.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Background file prefetching for frontends. The `prefetch' command starts
+// one reader thread per file; Frontend::extra_args() later serves the file
+// contents from memory, so techlib I/O overlaps with the synthesis stages
+// that run before the file is needed. The reader threads only move raw
+// bytes and never touch kernel state, so they are safe to run alongside
+// RTLIL work on the main thread. All functions below must be called from
+// the main thread.
+struct FilePrefetcher
+{
+	// Start a background reader for the given (already rewritten) filename.
+	// Starting the same file twice or a file that does not exist is not an
+	// error; the failure surfaces when the file is actually opened.
+	static void start(const std::string &filename);
+
+	// If the file was prefetched, join its reader, move the contents into
+	// `data' and consume the cache entry. Returns false if the file was not
+	// prefetched or could not be read.
+	static bool fetch(const std::string &filename, std::string &data);
+
+	// Join and drop all outstanding readers (called on shutdown).
+	static void join_all();
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
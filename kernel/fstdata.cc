@@ -19,6 +19,8 @@
 
 #include "kernel/fstdata.h"
 
+#include <thread>
+
 USING_YOSYS_NAMESPACE
 
 
@@ -190,17 +192,53 @@ void FstData::extractVarNames()
 }
 
 
-static void reconstruct_clb_varlen_attimes(void *user_data, uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t plen)
+static void bulk_record_clb_varlen_attimes(void *user_data, uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t plen)
 {
 	FstData *ptr = (FstData*)user_data;
-	ptr->reconstruct_callback_attimes(pnt_time, pnt_facidx, pnt_value, plen);
+	ptr->bulk_record_callback(pnt_time, pnt_facidx, pnt_value, plen);
 }
 
-static void reconstruct_clb_attimes(void *user_data, uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value)
+static void bulk_record_clb_attimes(void *user_data, uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value)
 {
 	FstData *ptr = (FstData*)user_data;
 	uint32_t plen = (pnt_value) ?  strlen((const char *)pnt_value) : 0;
-	ptr->reconstruct_callback_attimes(pnt_time, pnt_facidx, pnt_value, plen);
+	ptr->bulk_record_callback(pnt_time, pnt_facidx, pnt_value, plen);
+}
+
+static const size_t DECODE_CHUNK_CHANGES = 64*1024;
+static const size_t DECODE_CHUNK_BYTES = 1024*1024;
+static const size_t DECODE_QUEUE_DEPTH = 8;
+
+void FstData::bulk_record_callback(uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t plen)
+{
+	if (decode_abort) return;
+	if (pnt_time > end_time || !pnt_value) return;
+	bulk_changes.push_back(BulkChange{pnt_time, (uint64_t)bulk_values.size(), pnt_facidx, plen});
+	bulk_values.insert(bulk_values.end(), pnt_value, pnt_value + plen);
+	bulk_values.push_back(0); // reconstruct_callback_attimes expects NUL termination
+
+	if (bulk_changes.size() >= DECODE_CHUNK_CHANGES || bulk_values.size() >= DECODE_CHUNK_BYTES) {
+		std::unique_lock<std::mutex> lock(decode_mutex);
+		decode_cv.wait(lock, [&]{ return decode_queue.size() < DECODE_QUEUE_DEPTH || decode_abort; });
+		if (!decode_abort)
+			decode_queue.push_back(DecodeChunk{std::move(bulk_changes), std::move(bulk_values)});
+		decode_cv.notify_all();
+		bulk_changes.clear();
+		bulk_values.clear();
+	}
+}
+
+void FstData::decode_thread_main()
+{
+	fstReaderIterBlocks2(ctx, bulk_record_clb_attimes, bulk_record_clb_varlen_attimes, this, nullptr);
+
+	std::unique_lock<std::mutex> lock(decode_mutex);
+	if (!bulk_changes.empty() && !decode_abort)
+		decode_queue.push_back(DecodeChunk{std::move(bulk_changes), std::move(bulk_values)});
+	bulk_changes.clear();
+	bulk_values.clear();
+	decode_done = true;
+	decode_cv.notify_all();
 }
 
 void FstData::reconstruct_callback_attimes(uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t /* plen */)
@@ -253,9 +291,62 @@ void FstData::reconstructAllAtTimes(std::vector<fstHandle> &signal, uint64_t sta
 	past_time = start_time;
 	all_samples = clk_signals.empty();
 
-	fstReaderSetUnlimitedTimeRange(ctx);
-	fstReaderSetFacProcessMaskAll(ctx);
-	fstReaderIterBlocks2(ctx, reconstruct_clb_attimes, reconstruct_clb_varlen_attimes, this, nullptr);
+	if (activated_signals.empty()) {
+		fstReaderSetFacProcessMaskAll(ctx);
+	} else {
+		fstReaderClrFacProcessMaskAll(ctx);
+		for (auto id : activated_signals)
+			fstReaderSetFacProcessMask(ctx, id);
+		for (auto id : clk_signals)
+			fstReaderSetFacProcessMask(ctx, id);
+	}
+
+	// decode from the start of the file so that initial values accumulate,
+	// but skip whole blocks past the end of the replayed range
+	fstReaderSetLimitTimeRange(ctx, fstReaderGetStartTime(ctx), end_time);
+
+	// decode the file chunk-wise on a reader thread while the callbacks are
+	// replayed from memory on this thread, overlapping I/O and decompression
+	// with the evaluation work done by the callback; this also keeps the
+	// end-of-data exception thrown by the callback out of the C library
+	bulk_changes.clear();
+	bulk_values.clear();
+	decode_queue.clear();
+	decode_done = false;
+	decode_abort = false;
+	std::thread reader([this]() { decode_thread_main(); });
+
+	try {
+		while (1) {
+			DecodeChunk chunk;
+			{
+				std::unique_lock<std::mutex> lock(decode_mutex);
+				decode_cv.wait(lock, [&]{ return !decode_queue.empty() || decode_done; });
+				if (decode_queue.empty())
+					break;
+				chunk = std::move(decode_queue.front());
+				decode_queue.pop_front();
+				decode_cv.notify_all();
+			}
+			for (auto &change : chunk.changes)
+				reconstruct_callback_attimes(change.time, change.handle, chunk.values.data() + change.offset, change.len);
+		}
+	} catch (...) {
+		// unblock and drain the reader; its callback stops recording as
+		// soon as it sees the abort flag
+		decode_abort = true;
+		{
+			std::unique_lock<std::mutex> lock(decode_mutex);
+			decode_queue.clear();
+			decode_cv.notify_all();
+		}
+		reader.join();
+		decode_queue.clear();
+		throw;
+	}
+	reader.join();
+	decode_queue.clear();
+
 	if (last_time!=end_time) {
 		past_data = last_data;
 		callback(last_time);
@@ -264,6 +355,11 @@ void FstData::reconstructAllAtTimes(std::vector<fstHandle> &signal, uint64_t sta
 	callback(end_time);
 }
 
+void FstData::activateSignals(const std::vector<fstHandle> &signals)
+{
+	activated_signals = signals;
+}
+
 std::string FstData::valueOf(fstHandle signal)
 {
 	if (past_data.find(signal) == past_data.end()) {
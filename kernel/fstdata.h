@@ -23,6 +23,11 @@
 #include "kernel/yosys.h"
 #include "libs/fst/fstapi.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 YOSYS_NAMESPACE_BEGIN
 
 typedef std::function<void(uint64_t)> CallbackFunction;
@@ -50,8 +55,14 @@ class FstData
 	std::vector<FstVar>& getVars() { return vars; };
 
 	void reconstruct_callback_attimes(uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t plen);
+	void bulk_record_callback(uint64_t pnt_time, fstHandle pnt_facidx, const unsigned char *pnt_value, uint32_t plen);
 	void reconstructAllAtTimes(std::vector<fstHandle> &signal, uint64_t start_time, uint64_t end_time, CallbackFunction cb);
 
+	// Limit decoding to the given signal set (plus the clock signals passed to
+	// reconstructAllAtTimes). Without this every signal in the file is
+	// decompressed and buffered, which dominates replay time on large traces.
+	void activateSignals(const std::vector<fstHandle> &signals);
+
 	std::string valueOf(fstHandle signal);
 	fstHandle getHandle(std::string name);
 	dict<int,fstHandle> getMemoryHandles(std::string name);
@@ -75,8 +86,33 @@ private:
 	uint64_t end_time;
 	CallbackFunction callback;
 	std::vector<fstHandle> clk_signals;
+	std::vector<fstHandle> activated_signals;
 	bool all_samples;
 	std::string tmp_file;
+
+	// decode-ahead pipeline: a reader thread decodes the file into chunks of
+	// value changes and stages them in a bounded queue, the callbacks are
+	// replayed from memory on the main thread while the reader works ahead.
+	// The reader only touches the fst reader context and these raw buffers,
+	// never any kernel state.
+	struct BulkChange {
+		uint64_t time;
+		uint64_t offset;
+		fstHandle handle;
+		uint32_t len;
+	};
+	struct DecodeChunk {
+		std::vector<BulkChange> changes;
+		std::vector<unsigned char> values;
+	};
+	void decode_thread_main();
+	std::vector<BulkChange> bulk_changes;
+	std::vector<unsigned char> bulk_values;
+	std::deque<DecodeChunk> decode_queue;
+	std::mutex decode_mutex;
+	std::condition_variable decode_cv;
+	bool decode_done = false;
+	std::atomic<bool> decode_abort{false};
 };
 
 YOSYS_NAMESPACE_END
@@ -55,6 +55,48 @@ namespace hashlib {
 const int hashtable_size_trigger = 2;
 const int hashtable_size_factor = 3;
 
+// dicts with at most this many entries are searched linearly and carry no
+// hashtable index. The typical cell connection and parameter maps stay in
+// this regime, which saves the index allocation (~100 bytes for an otherwise
+// empty dict) and a pointer chase per lookup.
+const int dict_linear_search_threshold = 8;
+
+// When a lookup walks a collision chain of at least this many entries even
+// though the load factor is within bounds, the hashtable is rebuilt with a
+// larger prime size: clustered keys are usually spread out again by the
+// different modulus. The growth is bounded by hashtable_adaptive_max_factor
+// times the entry count -- chains that survive that are hash collisions
+// proper, which no table size can fix.
+const int hashtable_chain_rehash_trigger = 16;
+const int hashtable_adaptive_max_factor = 8;
+
+// Opt-in profiling counters for the hash containers, aggregated over all
+// dict and pool instances in the process. Compile with -DYOSYS_HASHLIB_STATS
+// to enable them; the 'internal_stats' command reports the numbers. They are
+// left out by default to keep the lookup path free of global stores.
+#ifdef YOSYS_HASHLIB_STATS
+struct hashlib_stats_t {
+	static const int probe_hist_buckets = 17;
+	uint64_t lookups = 0;    // do_lookup calls
+	uint64_t probes = 0;     // key comparisons spent walking chains
+	uint64_t rehashes = 0;   // hashtable (re)builds
+	uint64_t chain_rehashes = 0; // rehashes forced by overlong chains
+	uint64_t probe_hist[probe_hist_buckets] = {}; // lookups by chain length, last bucket collects the rest
+};
+inline hashlib_stats_t hashlib_stats;
+inline void hashlib_stat_rehash() { hashlib_stats.rehashes++; }
+inline void hashlib_stat_chain_rehash() { hashlib_stats.chain_rehashes++; }
+inline void hashlib_stat_lookup(int chain_len) {
+	hashlib_stats.lookups++;
+	hashlib_stats.probes += chain_len;
+	hashlib_stats.probe_hist[std::min(chain_len, hashlib_stats_t::probe_hist_buckets-1)]++;
+}
+#else
+inline void hashlib_stat_rehash() { }
+inline void hashlib_stat_chain_rehash() { }
+inline void hashlib_stat_lookup(int) { }
+#endif
+
 namespace legacy {
 	inline uint32_t djb2_add(uint32_t a, uint32_t b) {
 		return ((a << 5) + a) + b;
@@ -390,10 +432,15 @@ class dict {
 		return hash;
 	}
 
-	void do_rehash()
+	void do_rehash(int min_slots = 0)
 	{
 		hashtable.clear();
-		hashtable.resize(hashtable_size(entries.capacity() * hashtable_size_factor), -1);
+
+		if (min_slots == 0 && int(entries.size()) <= dict_linear_search_threshold)
+			return;
+
+		hashlib_stat_rehash();
+		hashtable.resize(hashtable_size(std::max(int(entries.capacity()) * hashtable_size_factor, min_slots)), -1);
 
 		for (int i = 0; i < int(entries.size()); i++) {
 			do_assert(-1 <= entries[i].next && entries[i].next < int(entries.size()));
@@ -406,9 +453,17 @@ class dict {
 	int do_erase(int index, Hasher::hash_t hash)
 	{
 		do_assert(index < int(entries.size()));
-		if (hashtable.empty() || index < 0)
+		if (index < 0)
 			return 0;
 
+		if (hashtable.empty()) {
+			int back_idx = entries.size()-1;
+			if (index != back_idx)
+				entries[index] = std::move(entries[back_idx]);
+			entries.pop_back();
+			return 1;
+		}
+
 		int k = hashtable[hash];
 		do_assert(0 <= k && k < int(entries.size()));
 
@@ -454,8 +509,15 @@ class dict {
 
 	int do_lookup(const K &key, Hasher::hash_t &hash) const
 	{
-		if (hashtable.empty())
+		if (hashtable.empty()) {
+			for (int i = 0; i < int(entries.size()); i++)
+				if (ops.cmp(entries[i].udata.first, key)) {
+					hashlib_stat_lookup(i);
+					return i;
+				}
+			hashlib_stat_lookup(entries.size());
 			return -1;
+		}
 
 		if (entries.size() * hashtable_size_trigger > hashtable.size()) {
 			((dict*)this)->do_rehash();
@@ -463,12 +525,25 @@ class dict {
 		}
 
 		int index = hashtable[hash];
+		int chain_len = 0;
 
 		while (index >= 0 && !ops.cmp(entries[index].udata.first, key)) {
 			index = entries[index].next;
+			chain_len++;
 			do_assert(-1 <= index && index < int(entries.size()));
 		}
 
+		hashlib_stat_lookup(chain_len);
+
+		// a rebuild relinks the chains but leaves the entry indices intact,
+		// so the looked-up index stays valid
+		if (chain_len >= hashtable_chain_rehash_trigger &&
+				entries.size() * hashtable_adaptive_max_factor > hashtable.size()) {
+			hashlib_stat_chain_rehash();
+			((dict*)this)->do_rehash(int(hashtable.size()) * 2);
+			hash = do_hash(key);
+		}
+
 		return index;
 	}
 
@@ -476,8 +551,10 @@ class dict {
 	{
 		if (hashtable.empty()) {
 			entries.emplace_back(std::pair<K, T>(key, T()), -1);
-			do_rehash();
-			hash = do_hash(key);
+			if (int(entries.size()) > dict_linear_search_threshold) {
+				do_rehash();
+				hash = do_hash(key);
+			}
 		} else {
 			entries.emplace_back(std::pair<K, T>(key, T()), hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
@@ -489,8 +566,10 @@ class dict {
 	{
 		if (hashtable.empty()) {
 			entries.emplace_back(value, -1);
-			do_rehash();
-			hash = do_hash(value.first);
+			if (int(entries.size()) > dict_linear_search_threshold) {
+				do_rehash();
+				hash = do_hash(value.first);
+			}
 		} else {
 			entries.emplace_back(value, hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
@@ -503,8 +582,10 @@ class dict {
 		if (hashtable.empty()) {
 			auto key = rvalue.first;
 			entries.emplace_back(std::forward<std::pair<K, T>>(rvalue), -1);
-			do_rehash();
-			hash = do_hash(key);
+			if (int(entries.size()) > dict_linear_search_threshold) {
+				do_rehash();
+				hash = do_hash(key);
+			}
 		} else {
 			entries.emplace_back(std::forward<std::pair<K, T>>(rvalue), hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
@@ -604,6 +685,10 @@ public:
 	template<class InputIterator>
 	void insert(InputIterator first, InputIterator last)
 	{
+		// for ranges of known length, size entry storage and index upfront
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+				typename std::iterator_traits<InputIterator>::iterator_category>)
+			reserve(entries.size() + std::distance(first, last));
 		for (; first != last; ++first)
 			insert(*first);
 	}
@@ -763,7 +848,13 @@ public:
 	template<typename Compare = std::less<K>>
 	void sort(Compare comp = Compare())
 	{
-		std::sort(entries.begin(), entries.end(), [comp](const entry_t &a, const entry_t &b){ return comp(b.udata.first, a.udata.first); });
+		// design->sort() is called by every backend, so back-to-back exports
+		// sort the same containers repeatedly; skip the sort and the rehash
+		// when the entries are already in order
+		auto entry_comp = [comp](const entry_t &a, const entry_t &b){ return comp(b.udata.first, a.udata.first); };
+		if (std::is_sorted(entries.begin(), entries.end(), entry_comp))
+			return;
+		std::sort(entries.begin(), entries.end(), entry_comp);
 		do_rehash();
 	}
 
@@ -799,11 +890,37 @@ public:
 		return h;
 	}
 
-	void reserve(size_t n) { entries.reserve(n); }
+	void reserve(size_t n)
+	{
+		entries.reserve(n);
+		// also pre-size the index, so that filling the container up to the
+		// reserved capacity triggers no further rehashing (an empty index is
+		// built at full capacity by the first insert)
+		if (!hashtable.empty() && entries.capacity() * hashtable_size_trigger > hashtable.size())
+			do_rehash();
+	}
+	size_t capacity() const { return entries.capacity(); }
 	size_t size() const { return entries.size(); }
 	bool empty() const { return entries.empty(); }
 	void clear() { hashtable.clear(); entries.clear(); }
 
+	// introspection for 'internal_stats': number of index slots (zero in the
+	// linear small-dict regime), the longest collision chain, and the bytes
+	// allocated by this container. longest_chain() walks all chains.
+	int hashtable_slots() const { return int(hashtable.size()); }
+	int longest_chain() const
+	{
+		int worst = 0;
+		for (int h = 0; h < int(hashtable.size()); h++) {
+			int len = 0;
+			for (int i = hashtable[h]; i >= 0; i = entries[i].next)
+				len++;
+			worst = std::max(worst, len);
+		}
+		return worst;
+	}
+	size_t memory_bytes() const { return sizeof(*this) + hashtable.capacity() * sizeof(int) + entries.capacity() * sizeof(entry_t); }
+
 	iterator begin() { return iterator(this, int(entries.size())-1); }
 	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
 	iterator end() { return iterator(nullptr, -1); }
@@ -849,10 +966,11 @@ protected:
 		return hash;
 	}
 
-	void do_rehash()
+	void do_rehash(int min_slots = 0)
 	{
+		hashlib_stat_rehash();
 		hashtable.clear();
-		hashtable.resize(hashtable_size(entries.capacity() * hashtable_size_factor), -1);
+		hashtable.resize(hashtable_size(std::max(int(entries.capacity()) * hashtable_size_factor, min_slots)), -1);
 
 		for (int i = 0; i < int(entries.size()); i++) {
 			do_assert(-1 <= entries[i].next && entries[i].next < int(entries.size()));
@@ -918,12 +1036,26 @@ protected:
 		}
 
 		int index = hashtable[hash];
+		int chain_len = 0;
 
 		while (index >= 0 && !ops.cmp(entries[index].udata, key)) {
 			index = entries[index].next;
+			chain_len++;
 			do_assert(-1 <= index && index < int(entries.size()));
 		}
 
+		hashlib_stat_lookup(chain_len);
+
+		// a rebuild relinks the chains but leaves the entry indices intact,
+		// so the looked-up index stays valid (idict relies on stable indices
+		// as well, which this preserves)
+		if (chain_len >= hashtable_chain_rehash_trigger &&
+				entries.size() * hashtable_adaptive_max_factor > hashtable.size()) {
+			hashlib_stat_chain_rehash();
+			((pool*)this)->do_rehash(int(hashtable.size()) * 2);
+			hash = do_hash(key);
+		}
+
 		return index;
 	}
 
@@ -1041,6 +1173,10 @@ public:
 	template<class InputIterator>
 	void insert(InputIterator first, InputIterator last)
 	{
+		// for ranges of known length, size entry storage and index upfront
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+				typename std::iterator_traits<InputIterator>::iterator_category>)
+			reserve(entries.size() + std::distance(first, last));
 		for (; first != last; ++first)
 			insert(*first);
 	}
@@ -1127,7 +1263,10 @@ public:
 	template<typename Compare = std::less<K>>
 	void sort(Compare comp = Compare())
 	{
-		std::sort(entries.begin(), entries.end(), [comp](const entry_t &a, const entry_t &b){ return comp(b.udata, a.udata); });
+		auto entry_comp = [comp](const entry_t &a, const entry_t &b){ return comp(b.udata, a.udata); };
+		if (std::is_sorted(entries.begin(), entries.end(), entry_comp))
+			return;
+		std::sort(entries.begin(), entries.end(), entry_comp);
 		do_rehash();
 	}
 
@@ -1166,11 +1305,35 @@ public:
 		return h;
 	}
 
-	void reserve(size_t n) { entries.reserve(n); }
+	void reserve(size_t n)
+	{
+		entries.reserve(n);
+		// also pre-size the index, so that filling the container up to the
+		// reserved capacity triggers no further rehashing (an empty index is
+		// built at full capacity by the first insert)
+		if (!hashtable.empty() && entries.capacity() * hashtable_size_trigger > hashtable.size())
+			do_rehash();
+	}
+	size_t capacity() const { return entries.capacity(); }
 	size_t size() const { return entries.size(); }
 	bool empty() const { return entries.empty(); }
 	void clear() { hashtable.clear(); entries.clear(); }
 
+	// introspection for 'internal_stats', see the dict counterparts
+	int hashtable_slots() const { return int(hashtable.size()); }
+	int longest_chain() const
+	{
+		int worst = 0;
+		for (int h = 0; h < int(hashtable.size()); h++) {
+			int len = 0;
+			for (int i = hashtable[h]; i >= 0; i = entries[i].next)
+				len++;
+			worst = std::max(worst, len);
+		}
+		return worst;
+	}
+	size_t memory_bytes() const { return sizeof(*this) + hashtable.capacity() * sizeof(int) + entries.capacity() * sizeof(entry_t); }
+
 	iterator begin() { return iterator(this, int(entries.size())-1); }
 	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
 	iterator end() { return iterator(nullptr, -1); }
@@ -0,0 +1,125 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/journal.h"
+#include "kernel/log.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+static std::map<RTLIL::Design*, std::unique_ptr<DesignJournal>> journal_registry;
+
+void DesignJournal::notify_module_add(RTLIL::Module *module)
+{
+	events.push_back(Event{EVENT_MODULE_ADD, module->name.str(), std::string(), std::string()});
+}
+
+void DesignJournal::notify_module_del(RTLIL::Module *module)
+{
+	events.push_back(Event{EVENT_MODULE_DEL, module->name.str(), std::string(), std::string()});
+}
+
+void DesignJournal::notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec &old_sig, const RTLIL::SigSpec &sig)
+{
+	std::string detail = port.str() + " " + log_signal(old_sig) + " -> " + log_signal(sig);
+	events.push_back(Event{EVENT_CELL_CONNECT, cell->module->name.str(), cell->name.str(), detail});
+}
+
+void DesignJournal::notify_connect(RTLIL::Module *module, const RTLIL::SigSig &sigsig)
+{
+	std::string detail = std::string(log_signal(sigsig.first)) + " -> " + log_signal(sigsig.second);
+	events.push_back(Event{EVENT_MODULE_CONNECT, module->name.str(), std::string(), detail});
+}
+
+void DesignJournal::notify_connect(RTLIL::Module *module, const std::vector<RTLIL::SigSig> &sigsig_vec)
+{
+	for (auto &sigsig : sigsig_vec)
+		notify_connect(module, sigsig);
+}
+
+void DesignJournal::notify_blackout(RTLIL::Module *module)
+{
+	events.push_back(Event{EVENT_BLACKOUT, module->name.str(), std::string(), std::string()});
+}
+
+void DesignJournal::record_pass_marker(const std::string &command)
+{
+	events.push_back(Event{EVENT_PASS, std::string(), std::string(), command});
+}
+
+pool<std::string> DesignJournal::touched_modules() const
+{
+	pool<std::string> result;
+	for (auto &event : events)
+		if (!event.module.empty())
+			result.insert(event.module);
+	return result;
+}
+
+static void write_u32(std::ostream &f, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		f.put(char((value >> (8*i)) & 0xff));
+}
+
+static void write_str(std::ostream &f, const std::string &str)
+{
+	write_u32(f, uint32_t(str.size()));
+	f.write(str.data(), str.size());
+}
+
+void DesignJournal::write_binary(std::ostream &f) const
+{
+	f.write("YSJN", 4);
+	write_u32(f, 1);
+	write_u32(f, uint32_t(events.size()));
+	for (auto &event : events) {
+		f.put(char(event.type));
+		write_str(f, event.module);
+		write_str(f, event.object);
+		write_str(f, event.detail);
+	}
+}
+
+DesignJournal *DesignJournal::get(RTLIL::Design *design)
+{
+	auto it = journal_registry.find(design);
+	return it == journal_registry.end() ? nullptr : it->second.get();
+}
+
+DesignJournal *DesignJournal::start(RTLIL::Design *design)
+{
+	DesignJournal *journal = get(design);
+	if (journal == nullptr) {
+		journal = new DesignJournal;
+		journal_registry[design].reset(journal);
+		design->monitors.insert(journal);
+	}
+	return journal;
+}
+
+void DesignJournal::stop(RTLIL::Design *design)
+{
+	DesignJournal *journal = get(design);
+	if (journal != nullptr) {
+		design->monitors.erase(journal);
+		journal_registry.erase(design);
+	}
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,85 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "kernel/rtlil.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// A change journal built on RTLIL::Monitor: while attached to a design it
+// records the events the monitor API reports (module add/del, cell port and
+// module connection rewrites, blackouts) together with pass boundary markers,
+// so an external incremental tool can consume the delta since its last
+// export instead of diffing full netlists.
+//
+// The monitor API does not report cell or wire creation, so a journal entry
+// names the containing module as "touched"; consumers are expected to
+// re-export at module granularity, which touched_modules() supports.
+//
+// Names are stored as plain strings: the journal outlives the objects (and
+// possibly the IdStrings) it describes.
+struct DesignJournal : RTLIL::Monitor
+{
+	enum EventType : uint8_t {
+		EVENT_PASS = 1,          // detail = command line of the pass
+		EVENT_MODULE_ADD = 2,    // module = added module
+		EVENT_MODULE_DEL = 3,    // module = deleted module
+		EVENT_CELL_CONNECT = 4,  // object = cell, detail = port old -> new
+		EVENT_MODULE_CONNECT = 5,// detail = lhs -> rhs connection
+		EVENT_BLACKOUT = 6       // module changed beyond the monitor API
+	};
+
+	struct Event {
+		EventType type;
+		std::string module, object, detail;
+	};
+
+	std::vector<Event> events;
+
+	void notify_module_add(RTLIL::Module *module) override;
+	void notify_module_del(RTLIL::Module *module) override;
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec &old_sig, const RTLIL::SigSpec &sig) override;
+	void notify_connect(RTLIL::Module *module, const RTLIL::SigSig &sigsig) override;
+	void notify_connect(RTLIL::Module *module, const std::vector<RTLIL::SigSig> &sigsig_vec) override;
+	void notify_blackout(RTLIL::Module *module) override;
+
+	// Fired by Pass::call() so consumers can attribute events to passes.
+	void record_pass_marker(const std::string &command);
+
+	// Query API
+	pool<std::string> touched_modules() const;
+	void clear() { events.clear(); }
+
+	// Compact binary format: "YSJN", u32 version, u32 event count, then per
+	// event one u8 type and three length-prefixed (u32) strings.
+	void write_binary(std::ostream &f) const;
+
+	// Per-design registry. start() attaches a journal (idempotent), stop()
+	// detaches it and discards the recorded events, get() returns the
+	// attached journal or nullptr.
+	static DesignJournal *get(RTLIL::Design *design);
+	static DesignJournal *start(RTLIL::Design *design);
+	static void stop(RTLIL::Design *design);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -33,6 +33,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <list>
 
@@ -101,6 +106,100 @@ int gettimeofday(struct timeval *tv, struct timezone *tz)
 }
 #endif
 
+// ---------------------------------------------------------------------------
+// Asynchronous log sink.
+//
+// When enabled (see the 'logger -[no]async' command), formatted log records
+// are appended to a single-producer single-consumer ring buffer and written
+// to log_files/log_streams by a background writer thread, so verbose
+// diagnostics do not serialize the compute path.  The producing side is the
+// main thread; this matches the kernel-wide rule that worker threads must
+// not log.
+//
+// log_flush() (and thereby log_error() and friends, as well as the places
+// that temporarily reconfigure the log sinks) drains the ring first, so
+// error messages and sink changes keep their ordering relative to the
+// buffered output.
+
+bool log_async = false;
+
+static constexpr uint64_t log_async_ring_size = 4096; // power of two
+static std::vector<std::string> log_async_ring;
+static std::atomic<uint64_t> log_async_head(0), log_async_tail(0);
+static std::atomic<bool> log_async_exit(false);
+static std::thread log_async_thread;
+static std::mutex log_async_wake_mutex;
+static std::condition_variable log_async_wake;
+
+static void log_async_worker()
+{
+	uint64_t tail = log_async_tail.load(std::memory_order_relaxed);
+	while (1) {
+		uint64_t head = log_async_head.load(std::memory_order_acquire);
+		if (tail == head) {
+			if (log_async_exit.load(std::memory_order_acquire))
+				return;
+			// the timeout makes a lost notify_one() harmless
+			std::unique_lock<std::mutex> lock(log_async_wake_mutex);
+			log_async_wake.wait_for(lock, std::chrono::milliseconds(10));
+			continue;
+		}
+		while (tail != head) {
+			std::string &str = log_async_ring[tail % log_async_ring_size];
+			for (auto f : log_files)
+				fputs(str.c_str(), f);
+			for (auto f : log_streams)
+				*f << str;
+			str.clear();
+			log_async_tail.store(++tail, std::memory_order_release);
+		}
+	}
+}
+
+static void log_async_enqueue(std::string str)
+{
+	uint64_t head = log_async_head.load(std::memory_order_relaxed);
+	// ring full: wait for the writer to catch up
+	while (head - log_async_tail.load(std::memory_order_acquire) >= log_async_ring_size)
+		std::this_thread::yield();
+	log_async_ring[head % log_async_ring_size] = std::move(str);
+	log_async_head.store(head + 1, std::memory_order_release);
+	log_async_wake.notify_one();
+}
+
+// wait until the writer thread has written out all queued records
+static void log_async_drain()
+{
+	uint64_t head = log_async_head.load(std::memory_order_relaxed);
+	log_async_wake.notify_one();
+	while (log_async_tail.load(std::memory_order_acquire) < head)
+		std::this_thread::yield();
+}
+
+void log_async_begin()
+{
+	if (log_async)
+		return;
+	log_async_ring.resize(log_async_ring_size);
+	log_async_exit.store(false);
+	log_async_head.store(0);
+	log_async_tail.store(0);
+	log_async_thread = std::thread(log_async_worker);
+	log_async = true;
+}
+
+void log_async_end()
+{
+	if (!log_async)
+		return;
+	log_async = false;
+	log_async_drain();
+	log_async_exit.store(true, std::memory_order_release);
+	log_async_wake.notify_one();
+	log_async_thread.join();
+	std::vector<std::string>().swap(log_async_ring);
+}
+
 void logv(const char *format, va_list ap)
 {
 	while (format[0] == '\n' && format[1] != 0) {
@@ -125,10 +224,10 @@ void logv(const char *format, va_list ap)
 	if (log_hasher)
 		log_hasher->update(str);
 
+	std::string time_str;
+
 	if (log_time)
 	{
-		std::string time_str;
-
 		if (next_print_log || initial_tv.tv_sec == 0) {
 			next_print_log = false;
 			struct timeval tv;
@@ -152,20 +251,31 @@ void logv(const char *format, va_list ap)
 		// is then in the first formatted argument
 		if (!strcmp(format, "%s") && str.back() == '\n')
 			next_print_log = true;
+	}
+
+	if (log_async)
+	{
+		// writing to the sinks is delegated to the writer thread; everything
+		// below (scratchpads, warning regexes) stays on the calling thread
+		log_async_enqueue(time_str + str);
+	}
+	else
+	{
+		if (!time_str.empty()) {
+			for (auto f : log_files)
+				fputs(time_str.c_str(), f);
+
+			for (auto f : log_streams)
+				*f << time_str;
+		}
 
 		for (auto f : log_files)
-			fputs(time_str.c_str(), f);
+			fputs(str.c_str(), f);
 
 		for (auto f : log_streams)
-			*f << time_str;
+			*f << str;
 	}
 
-	for (auto f : log_files)
-		fputs(str.c_str(), f);
-
-	for (auto f : log_streams)
-		*f << str;
-
 	RTLIL::Design *design = yosys_get_design();
 	if (design != nullptr)
 		for (auto &scratchpad : log_scratchpads)
@@ -212,6 +322,8 @@ void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 		header_count.back()++;
 
 	if (int(header_count.size()) <= log_verbose_level && log_errfile != NULL) {
+		if (log_async)
+			log_async_drain();
 		log_files.push_back(log_errfile);
 		pop_errfile = true;
 	}
@@ -238,8 +350,11 @@ void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 				log("#X# -- end of dump --\n");
 		}
 
-	if (pop_errfile)
+	if (pop_errfile) {
+		if (log_async)
+			log_async_drain();
 		log_files.pop_back();
+	}
 }
 
 static void logv_warning_with_prefix(const char *prefix,
@@ -341,6 +456,9 @@ static void logv_error_with_prefix(const char *prefix,
 	log_make_debug = 0;
 	log_suppressed();
 
+	if (log_async)
+		log_async_drain();
+
 	if (log_errfile != NULL)
 		log_files.push_back(log_errfile);
 
@@ -464,6 +582,8 @@ void log_cmd_error(const char *format, ...)
 		// of log output
 		bool pop_errfile = false;
 		if (log_errfile != NULL) {
+			if (log_async)
+				log_async_drain();
 			log_files.push_back(log_errfile);
 			pop_errfile = true;
 		}
@@ -609,6 +729,9 @@ void log_reset_stack()
 
 void log_flush()
 {
+	if (log_async)
+		log_async_drain();
+
 	for (auto f : log_files)
 		fflush(f);
 
@@ -764,6 +887,13 @@ void log_check_expected()
 
 dict<std::string, std::pair<std::string, int>> extra_coverage_data;
 
+std::vector<CoverListData*> cover_list_registry;
+
+CoverListData::CoverListData(const char *parent) : parent(parent)
+{
+	cover_list_registry.push_back(this);
+}
+
 void cover_extra(std::string parent, std::string id, bool increment) {
 	if (extra_coverage_data.count(id) == 0) {
 		for (CoverData *p = __start_yosys_cover_list; p != __stop_yosys_cover_list; p++)
@@ -792,6 +922,25 @@ dict<std::string, std::pair<std::string, int>> get_coverage_data()
 		coverage_data[it.first].second += it.second.second;
 	}
 
+	for (CoverListData *data : cover_list_registry)
+	{
+		std::string where;
+		for (CoverData *p = __start_yosys_cover_list; p != __stop_yosys_cover_list; p++)
+			if (!strcmp(p->id, data->parent))
+				where = stringf("%s:%d:%s", p->file, p->line, p->func);
+		log_assert(!where.empty());
+
+		for (int i = 0; i < int(data->counters.size()); i++) {
+			if (data->names[i].empty())
+				continue;
+			std::string id = std::string(data->parent) + "." + data->names[i];
+			if (coverage_data.count(id))
+				log_warning("found duplicate coverage id \"%s\".\n", id.c_str());
+			coverage_data[id].first = where;
+			coverage_data[id].second += data->counters[i];
+		}
+	}
+
 	for (CoverData *p = __start_yosys_cover_list; p != __stop_yosys_cover_list; p++) {
 		if (coverage_data.count(p->id))
 			log_warning("found duplicate coverage id \"%s\".\n", p->id);
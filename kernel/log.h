@@ -108,6 +108,7 @@ extern FILE *log_errfile;
 extern SHA1 *log_hasher;
 
 extern bool log_time;
+extern bool log_async;
 extern bool log_error_stderr;
 extern bool log_cmd_error_throw;
 extern bool log_quiet_warnings;
@@ -189,6 +190,12 @@ void log_backtrace(const char *prefix, int levels);
 void log_reset_stack();
 void log_flush();
 
+// Start/stop the asynchronous log writer thread (see "logger -async"). While
+// active, only the main thread may produce log output; log_flush() waits for
+// the queued messages to drain.
+void log_async_begin();
+void log_async_end();
+
 struct LogExpectedItem
 {
 	LogExpectedItem(const std::regex &pat, int expected) :
@@ -257,19 +264,48 @@ extern dict<std::string, std::pair<std::string, int>> extra_coverage_data;
 void cover_extra(std::string parent, std::string id, bool increment = true);
 dict<std::string, std::pair<std::string, int>> get_coverage_data();
 
+// Counter slots for one cover_list() call site. The candidates are visited in
+// a fixed order on every hit, so each one gets a positional slot in a static
+// per-site array; its name is recorded on the first hit and after that a hit
+// only bumps the slot counter instead of concatenating the id string and
+// doing a string-keyed map lookup.
+struct CoverListData
+{
+	const char *parent;
+	std::vector<std::string> names;
+	std::vector<int> counters;
+
+	CoverListData(const char *parent);
+
+	inline void hit(int idx, const std::string &name, bool increment)
+	{
+		if (idx >= int(counters.size())) {
+			counters.resize(idx+1, 0);
+			names.resize(idx+1);
+		}
+		if (names[idx].empty())
+			names[idx] = name;
+		if (increment)
+			counters[idx]++;
+	}
+};
+
+extern std::vector<CoverListData*> cover_list_registry;
+
 #define cover_list(_id, ...) do { cover(_id); \
-	std::string r = cover_list_worker(_id, __VA_ARGS__); \
+	static CoverListData __cld(_id); \
+	std::string r = cover_list_worker(__cld, __VA_ARGS__); \
 	log_assert(r.empty()); \
 } while (0)
 
-static inline std::string cover_list_worker(std::string, std::string last) {
+static inline std::string cover_list_worker(CoverListData&, const std::string &last) {
 	return last;
 }
 
 template<typename... T>
-std::string cover_list_worker(std::string prefix, std::string first, T... rest) {
-	std::string selected = cover_list_worker(prefix, rest...);
-	cover_extra(prefix, prefix + "." + first, first == selected);
+std::string cover_list_worker(CoverListData &data, const std::string &first, const T&... rest) {
+	std::string selected = cover_list_worker(data, rest...);
+	data.hit(int(sizeof...(rest)) - 1, first, first == selected);
 	return first == selected ? "" : selected;
 }
 
@@ -260,7 +260,24 @@ void Mem::emit() {
 				init.cell = nullptr;
 			}
 		}
-		cell->parameters[ID::INIT] = get_init_data();
+		// Build the INIT parameter from the initialized intervals only and
+		// leave off the fully-undefined tail — mem_from_cell pads a short
+		// INIT with Sx, so sparsely initialized memories don't pay for
+		// their full address space here.
+		auto init_intervals = get_init_intervals();
+		int init_words = 0;
+		for (auto &interval : init_intervals)
+			init_words = std::max(init_words, interval.first - start_offset + GetSize(interval.second) / width);
+		init_words = std::min(init_words, size);
+		Const init_data(State::Sx, init_words * width);
+		for (auto &interval : init_intervals) {
+			int offset = (interval.first - start_offset) * width;
+			for (int i = 0; i < GetSize(interval.second); i++)
+				if (0 <= i+offset && i+offset < GetSize(init_data))
+					init_data.bits()[i+offset] = interval.second[i];
+		}
+		init_data.compact();
+		cell->parameters[ID::INIT] = init_data;
 	} else {
 		if (cell) {
 			module->remove(cell);
@@ -448,9 +465,81 @@ Const Mem::get_init_data() const {
 			if (0 <= i+offset && i+offset < GetSize(init_data) && init.en[i % width] == State::S1)
 				init_data.bits()[i+offset] = init.data[i];
 	}
+	// fully initialized memories (e.g. ROMs) pack down to 1 bit per bit
+	init_data.compact();
 	return init_data;
 }
 
+std::vector<std::pair<int, Const>> Mem::get_init_intervals() const {
+	// start address -> end address
+	std::map<int, int> chunks;
+	// Figure out chunk boundaries, like coalesce_inits() does, but without
+	// modifying the inits list.
+	for (auto &init : inits) {
+		if (init.removed)
+			continue;
+		bool valid = false;
+		for (auto bit : init.en)
+			if (bit == State::S1)
+				valid = true;
+		if (!valid)
+			continue;
+		int addr = init.addr.as_int();
+		int addr_e = addr + GetSize(init.data) / width;
+		auto it_e = chunks.upper_bound(addr_e);
+		auto it = it_e;
+		while (it != chunks.begin()) {
+			--it;
+			if (it->second < addr) {
+				++it;
+				break;
+			}
+		}
+		if (it == it_e) {
+			// No overlapping inits — add this one to index.
+			chunks[addr] = addr_e;
+		} else {
+			// We have an overlap — all chunks in the [it, it_e)
+			// range will be merged with this init.
+			if (it->first < addr)
+				addr = it->first;
+			auto it_last = it_e;
+			it_last--;
+			if (it_last->second > addr_e)
+				addr_e = it_last->second;
+			chunks.erase(it, it_e);
+			chunks[addr] = addr_e;
+		}
+	}
+	// Fill the chunks, applying the inits in list order so that later
+	// (higher-priority) inits overwrite earlier ones.
+	std::vector<std::pair<int, Const>> res;
+	dict<int, int> chunk_index;
+	for (auto &chunk : chunks) {
+		chunk_index[chunk.first] = GetSize(res);
+		res.emplace_back(chunk.first, Const(State::Sx, (chunk.second - chunk.first) * width));
+	}
+	for (auto &init : inits) {
+		if (init.removed)
+			continue;
+		bool valid = false;
+		for (auto bit : init.en)
+			if (bit == State::S1)
+				valid = true;
+		if (!valid)
+			continue;
+		auto it = chunks.upper_bound(init.addr.as_int());
+		--it;
+		Const &cdata = res[chunk_index[it->first]].second;
+		int offset = (init.addr.as_int() - it->first) * width;
+		log_assert(offset >= 0 && offset + GetSize(init.data) <= GetSize(cdata));
+		for (int i = 0; i < GetSize(init.data); i++)
+			if (init.en[i % width] == State::S1)
+				cdata.bits()[i+offset] = init.data[i];
+	}
+	return res;
+}
+
 void Mem::check() {
 	int max_wide_log2 = 0;
 	for (auto &port : rd_ports) {
@@ -128,8 +128,18 @@ struct Mem : RTLIL::AttrObject {
 
 	// Gathers all initialization data into a single big const covering
 	// the whole memory.  For all non-initialized bits, Sx will be returned.
+	// Note that this materializes width*size bits regardless of how much
+	// of the memory is actually initialized — for sparsely initialized
+	// memories prefer get_init_intervals().
 	Const get_init_data() const;
 
+	// Gathers all initialization data into a sorted list of disjoint
+	// (address, data) chunks covering only the initialized parts of the
+	// memory, with enable masks already applied (disabled bits are Sx).
+	// Unlike get_init_data(), the cost of this function scales with the
+	// defined content instead of the address space size.
+	std::vector<std::pair<int, Const>> get_init_intervals() const;
+
 	// Constructs and returns the helper structures for all memories
 	// in a module.
 	static std::vector<Mem> get_all_memories(Module *module);
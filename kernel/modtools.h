@@ -23,6 +23,7 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
+#include "kernel/threadpool.h"
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -341,6 +342,11 @@ struct ModWalker
 
 	dict<RTLIL::Cell*, pool<RTLIL::SigBit>> cell_outputs, cell_inputs;
 
+	// compact cell numbering (in setup() order) used by the batched cone
+	// extraction API below
+	std::vector<RTLIL::Cell*> index_to_cell;
+	dict<RTLIL::Cell*, int> cell_to_index;
+
 	void add_wire(RTLIL::Wire *wire)
 	{
 		if (wire->port_input) {
@@ -376,6 +382,9 @@ struct ModWalker
 
 	void add_cell(RTLIL::Cell *cell)
 	{
+		cell_to_index.emplace(cell, GetSize(index_to_cell));
+		index_to_cell.push_back(cell);
+
 		if (ct.cell_known(cell->type)) {
 			for (auto &conn : cell->connections())
 				add_cell_port(cell, conn.first, sigmap(conn.second),
@@ -406,6 +415,8 @@ struct ModWalker
 		signal_outputs.clear();
 		cell_inputs.clear();
 		cell_outputs.clear();
+		index_to_cell.clear();
+		cell_to_index.clear();
 
 		for (auto &it : module->wires_)
 			add_wire(it.second);
@@ -575,6 +586,92 @@ struct ModWalker
 		pool<RTLIL::SigBit> result;
 		return get_outputs(result, sig);
 	}
+
+	// batched bounded-depth cone extraction
+
+	void get_cones(const std::vector<RTLIL::Cell*> &seeds, std::vector<std::vector<int>> &cones,
+			bool fanout, int max_depth, const CellTypes *expand_ct, int num_threads) const
+	{
+		cones.assign(seeds.size(), {});
+
+		auto worker = [&](int t) {
+			std::vector<int> stamp(GetSize(index_to_cell), -1);
+			std::vector<std::pair<RTLIL::Cell*, int>> queue;
+
+			for (int i = t; i < GetSize(seeds); i += num_threads)
+			{
+				auto seed_it = cell_to_index.find(seeds[i]);
+				if (seed_it == cell_to_index.end())
+					continue;
+
+				std::vector<int> &cone = cones[i];
+				stamp[seed_it->second] = i;
+				cone.push_back(seed_it->second);
+				queue.clear();
+				queue.emplace_back(seeds[i], 0);
+
+				for (int cursor = 0; cursor < GetSize(queue); cursor++)
+				{
+					RTLIL::Cell *cell = queue[cursor].first;
+					int depth = queue[cursor].second;
+
+					if (max_depth >= 0 && depth >= max_depth)
+						continue;
+
+					auto ports_it = fanout ? cell_outputs.find(cell) : cell_inputs.find(cell);
+					if (ports_it == (fanout ? cell_outputs.end() : cell_inputs.end()))
+						continue;
+
+					for (auto &bit : ports_it->second)
+					{
+						auto sig_it = fanout ? signal_consumers.find(bit) : signal_drivers.find(bit);
+						if (sig_it == (fanout ? signal_consumers.end() : signal_drivers.end()))
+							continue;
+
+						for (auto &pbit : sig_it->second) {
+							auto idx_it = cell_to_index.find(pbit.cell);
+							if (idx_it == cell_to_index.end() || stamp[idx_it->second] == i)
+								continue;
+							stamp[idx_it->second] = i;
+							if (expand_ct != nullptr && !expand_ct->cell_known(pbit.cell->type))
+								continue;
+							cone.push_back(idx_it->second);
+							queue.emplace_back(pbit.cell, depth + 1);
+						}
+					}
+				}
+
+				std::sort(cone.begin(), cone.end());
+			}
+		};
+
+		if (num_threads > 1)
+			ThreadPool::run(num_threads, num_threads, worker);
+		else
+			worker(0);
+	}
+
+	// Compute one fanout cone per seed cell. cones[i] is filled with the
+	// sorted compact indices (see index_to_cell) of all cells reachable
+	// from seeds[i] within max_depth steps (max_depth < 0 means
+	// unbounded), always including the seed itself. If expand_ct is
+	// non-null, reached cells of a type not known to it are neither
+	// reported nor expanded. The traversal only reads the prebuilt
+	// indices, so the seeds are processed with num_threads workers; it
+	// must not overlap with module modifications or another setup() call.
+	void get_fanout_cones(const std::vector<RTLIL::Cell*> &seeds, std::vector<std::vector<int>> &cones,
+			int max_depth = -1, const CellTypes *expand_ct = nullptr, int num_threads = 1) const
+	{
+		get_cones(seeds, cones, true, max_depth, expand_ct, num_threads);
+	}
+
+	// Same as get_fanout_cones(), but following the driver relation from
+	// cell inputs towards the fanin.
+	void get_fanin_cones(const std::vector<RTLIL::Cell*> &seeds, std::vector<std::vector<int>> &cones,
+			int max_depth = -1, const CellTypes *expand_ct = nullptr, int num_threads = 1) const
+	{
+		get_cones(seeds, cones, false, max_depth, expand_ct, num_threads);
+	}
 };
 
 YOSYS_NAMESPACE_END
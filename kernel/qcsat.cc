@@ -75,6 +75,26 @@ void QuickConeSat::prepare()
 	}
 }
 
+int QuickConeSat::begin_context()
+{
+	int context_lit = ez->frozen_literal();
+	context_stack.push_back(context_lit);
+	return context_lit;
+}
+
+void QuickConeSat::assume(int expr)
+{
+	log_assert(!context_stack.empty());
+	ez->assume(expr, context_stack.back());
+}
+
+void QuickConeSat::end_context()
+{
+	log_assert(!context_stack.empty());
+	ez->assume(ez->NOT(context_stack.back()));
+	context_stack.pop_back();
+}
+
 int QuickConeSat::cell_complexity(RTLIL::Cell *cell)
 {
 	if (cell->type.in(ID($concat), ID($slice), ID($pos), ID($buf), ID($_BUF_)))
@@ -67,8 +67,54 @@ struct QuickConeSat {
 	// the SAT solver.
 	void prepare();
 
+	// Assumption contexts for per-query conditions.  When one solver
+	// instance is kept alive across many queries, conditions that only
+	// apply to a single query must not be added with ez->assume() (that
+	// would constrain all later queries too).  Instead, bracket the query
+	// with begin_context()/end_context() and add the conditions with
+	// assume(); they are guarded by a fresh context literal that has to be
+	// passed to ez->solve() as an extra assumption (begin_context() returns
+	// it).  end_context() retires the literal, making the guarded clauses
+	// vacuous for all later queries.  Contexts nest like a stack.
+	int begin_context();
+	void assume(int expr);
+	void end_context();
+
 	// Returns the "complexity level" of a given cell.
 	static int cell_complexity(RTLIL::Cell *cell);
+
+private:
+	std::vector<int> context_stack;
+};
+
+// A per-module QuickConeSat kept alive across many queries, so that repeated
+// queries into overlapping input cones import each cell's clauses only once
+// instead of re-encoding the same cone for every query.  All imported clauses
+// model real circuit behavior, so clauses accumulated from earlier queries can
+// only rule out spurious solutions -- the "only UNSAT results are binding"
+// contract of QuickConeSat is unaffected.  Per-query conditions must use the
+// assumption context interface (or plain ez->solve() assumption arguments),
+// never a bare ez->assume().  Call invalidate() after modifying any logic that
+// may feed an imported cone; the next get() starts from a fresh solver.
+struct QuickConeSatPool {
+	ModWalker &modwalker;
+
+	QuickConeSatPool(ModWalker &modwalker) : modwalker(modwalker) {}
+
+	QuickConeSat &get()
+	{
+		if (qcsat == nullptr)
+			qcsat = std::unique_ptr<QuickConeSat>(new QuickConeSat(modwalker));
+		return *qcsat;
+	}
+
+	void invalidate()
+	{
+		qcsat = nullptr;
+	}
+
+private:
+	std::unique_ptr<QuickConeSat> qcsat;
 };
 
 YOSYS_NAMESPACE_END
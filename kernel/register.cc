@@ -20,12 +20,22 @@
 #include "kernel/yosys.h"
 #include "kernel/satgen.h"
 #include "kernel/json.h"
+#include "kernel/threadpool.h"
+#include "kernel/journal.h"
+#include "kernel/undo.h"
+#include "kernel/fileprefetch.h"
 
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #ifdef YOSYS_ENABLE_ZLIB
 #include <zlib.h>
 
@@ -85,6 +95,111 @@ PRIVATE_NAMESPACE_END
 
 #endif
 
+#ifdef YOSYS_ENABLE_ZSTD
+#include <zstd.h>
+
+PRIVATE_NAMESPACE_BEGIN
+void decompress_zstd(const std::string &filename, std::stringstream &out)
+{
+	FILE *zf = fopen(filename.c_str(), "rb");
+	if (zf == nullptr)
+		return;
+
+	std::vector<char> inbuf(ZSTD_DStreamInSize());
+	std::vector<char> outbuf(ZSTD_DStreamOutSize());
+	ZSTD_DCtx *dctx = ZSTD_createDCtx();
+
+	size_t bytes_read;
+	while ((bytes_read = fread(inbuf.data(), 1, inbuf.size(), zf)) > 0) {
+		ZSTD_inBuffer input = { inbuf.data(), bytes_read, 0 };
+		while (input.pos < input.size) {
+			ZSTD_outBuffer output = { outbuf.data(), outbuf.size(), 0 };
+			size_t ret = ZSTD_decompressStream(dctx, &output, &input);
+			if (ZSTD_isError(ret)) {
+				std::string errmsg = ZSTD_getErrorName(ret);
+				ZSTD_freeDCtx(dctx);
+				fclose(zf);
+				YOSYS_NAMESPACE_PREFIX log_cmd_error("Error decompressing zstd file `%s': %s\n", filename.c_str(), errmsg.c_str());
+			}
+			out.write(outbuf.data(), output.pos);
+		}
+	}
+
+	ZSTD_freeDCtx(dctx);
+	fclose(zf);
+}
+
+/*
+An output stream that uses a stringbuf to buffer data internally,
+using zstd to write compressed data every time the stream is flushed.
+Compression runs on libzstd worker threads (following the same thread
+count policy as ThreadPool) when libzstd was built with multithreading
+support; otherwise setting the worker count fails harmlessly and
+compression stays single-threaded.
+*/
+class zstd_ostream : public std::ostream  {
+public:
+	zstd_ostream() : std::ostream(nullptr)
+	{
+		rdbuf(&outbuf);
+	}
+	bool open(const std::string &filename)
+	{
+		return outbuf.open(filename);
+	}
+private:
+	class zstd_streambuf : public std::stringbuf {
+	public:
+		zstd_streambuf() { };
+		bool open(const std::string &filename)
+		{
+			zf = fopen(filename.c_str(), "wb");
+			if (zf == nullptr)
+				return false;
+			cctx = ZSTD_createCCtx();
+			int threads = YOSYS_NAMESPACE_PREFIX ThreadPool::thread_count(nullptr);
+			if (threads > 1)
+				ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, threads);
+			return true;
+		}
+		virtual int sync() override
+		{
+			compress_buffer(ZSTD_e_continue);
+			return 0;
+		}
+		virtual ~zstd_streambuf()
+		{
+			if (zf == nullptr)
+				return;
+			compress_buffer(ZSTD_e_end);
+			ZSTD_freeCCtx(cctx);
+			fclose(zf);
+		}
+	private:
+		void compress_buffer(ZSTD_EndDirective mode)
+		{
+			std::string data = str();
+			str("");
+			ZSTD_inBuffer input = { data.data(), data.size(), 0 };
+			std::vector<char> outbuf(ZSTD_CStreamOutSize());
+			while (1) {
+				ZSTD_outBuffer output = { outbuf.data(), outbuf.size(), 0 };
+				size_t remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+				if (ZSTD_isError(remaining))
+					break;
+				fwrite(outbuf.data(), 1, output.pos, zf);
+				if (mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size)
+					break;
+			}
+		}
+		FILE *zf = nullptr;
+		ZSTD_CCtx *cctx = nullptr;
+	} outbuf;
+};
+PRIVATE_NAMESPACE_END
+
+#endif
+
 YOSYS_NAMESPACE_BEGIN
 
 #define MAX_REG_COUNT 1000
@@ -97,6 +212,10 @@ std::map<std::string, Frontend*> frontend_register;
 std::map<std::string, Pass*> pass_register;
 std::map<std::string, Backend*> backend_register;
 
+bool pass_perf_active = false;
+bool pass_perf_counters = false;
+std::vector<PassPerfRecord> pass_perf_records;
+
 std::vector<std::string> Frontend::next_args;
 
 Pass::Pass(std::string name, std::string short_help) : pass_name(name), short_help(short_help)
@@ -229,6 +348,178 @@ void Pass::extra_args(std::vector<std::string> args, size_t argidx, RTLIL::Desig
 	// cmd_log_args(args);
 }
 
+static int64_t perf_peak_rss_kb()
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+	struct rusage ru_buffer;
+	if (getrusage(RUSAGE_SELF, &ru_buffer) == 0)
+		return (int64_t)ru_buffer.ru_maxrss;
+#elif defined(__APPLE__)
+	struct rusage ru_buffer;
+	if (getrusage(RUSAGE_SELF, &ru_buffer) == 0)
+		return (int64_t)ru_buffer.ru_maxrss / 1024;
+#endif
+	return 0;
+}
+
+static void perf_count_objects(RTLIL::Design *design, int64_t &cells, int64_t &wires)
+{
+	cells = 0, wires = 0;
+	for (auto module : design->modules()) {
+		cells += GetSize(module->cells_);
+		wires += GetSize(module->wires_);
+	}
+}
+
+// Per-process hardware counters (Linux perf_event). The counters are opened
+// once, keep running, and per-pass values are attributed by reading them at
+// pass begin/end. Opening can fail without perf privileges (see
+// /proc/sys/kernel/perf_event_paranoid); the affected values then stay zero.
+#if defined(__linux__)
+static struct {
+	int fds[3] = {-1, -1, -1};
+	bool tried = false;
+
+	static int open_counter(uint64_t config)
+	{
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = config;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+
+	void read_counters(int64_t values[3])
+	{
+		if (!tried) {
+			tried = true;
+			fds[0] = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+			fds[1] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+			fds[2] = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+			if (fds[0] == -1 && fds[1] == -1 && fds[2] == -1)
+				log_warning("Hardware performance counters are unavailable (perf_event_open: %s).\n", strerror(errno));
+		}
+		for (int i = 0; i < 3; i++) {
+			uint64_t value;
+			values[i] = 0;
+			if (fds[i] != -1 && read(fds[i], &value, sizeof(value)) == (ssize_t)sizeof(value))
+				values[i] = value;
+		}
+	}
+} perf_hw_counters;
+#else
+static struct {
+	void read_counters(int64_t values[3])
+	{
+		values[0] = values[1] = values[2] = 0;
+	}
+} perf_hw_counters;
+#endif
+
+// session-lifetime fallback for allocations made outside any Pass::call()
+static PassArena pass_arena_fallback;
+static std::vector<std::unique_ptr<PassArena>> pass_arena_stack;
+
+PassArena *pass_arena()
+{
+	return pass_arena_stack.empty() ? &pass_arena_fallback : pass_arena_stack.back().get();
+}
+
+void *PassArena::alloc(size_t size, size_t align)
+{
+	used = (used + align - 1) & ~(align - 1);
+	if (chunks.empty() || used + size > chunks.back().size) {
+		// operator new[] returns fundamentally aligned memory, so a fresh
+		// chunk needs no alignment fixup
+		size_t chunk_size = std::max(size, (size_t)1 << 20);
+		chunks.push_back(chunk_t{std::unique_ptr<char[]>(new char[chunk_size]), chunk_size});
+		used = 0;
+	}
+	void *ptr = chunks.back().data.get() + used;
+	used += size;
+	alloc_bytes += size;
+	alloc_calls++;
+	return ptr;
+}
+
+// one arena per pass invocation; destroying the scope bulk-frees everything
+// the pass routed through ArenaAllocator<>, also when the command is aborted
+// by an exception
+struct PassArenaScope
+{
+	PassArenaScope() { pass_arena_stack.push_back(std::make_unique<PassArena>()); }
+	~PassArenaScope() { pass_arena_stack.pop_back(); }
+};
+
+// collects one PassPerfRecord around a Pass::call() while profiling is
+// active; commands aborted by an exception are not recorded, but the
+// nesting depth is restored
+struct PassPerfScope
+{
+	RTLIL::Design *design;
+	bool active = false;
+	static int depth;
+	PassPerfRecord record;
+	std::chrono::steady_clock::time_point wall_begin;
+	int64_t cpu_begin, rss_begin, cells_begin, wires_begin;
+	int64_t arena_bytes_begin, arena_calls_begin;
+	int64_t hw_begin[3] = {0, 0, 0};
+
+	PassPerfScope(RTLIL::Design *design, const std::vector<std::string> &args) : design(design)
+	{
+		if (!pass_perf_active)
+			return;
+		active = true;
+		record.pass_name = args[0];
+		for (size_t i = 0; i < args.size(); i++)
+			record.command += (i ? " " : "") + args[i];
+		record.depth = depth++;
+		perf_count_objects(design, cells_begin, wires_begin);
+		rss_begin = perf_peak_rss_kb();
+		arena_bytes_begin = pass_arena()->alloc_bytes;
+		arena_calls_begin = pass_arena()->alloc_calls;
+		if (pass_perf_counters)
+			perf_hw_counters.read_counters(hw_begin);
+		cpu_begin = PerformanceTimer::query();
+		wall_begin = std::chrono::steady_clock::now();
+	}
+
+	void finish()
+	{
+		if (!active)
+			return;
+		record.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wall_begin).count();
+		record.cpu_ns = PerformanceTimer::query() - cpu_begin;
+		record.peak_rss_delta_kb = perf_peak_rss_kb() - rss_begin;
+		record.hw_cycles = record.hw_cache_misses = record.hw_branch_misses = 0;
+		if (pass_perf_counters) {
+			int64_t hw_end[3];
+			perf_hw_counters.read_counters(hw_end);
+			record.hw_cycles = hw_end[0] - hw_begin[0];
+			record.hw_cache_misses = hw_end[1] - hw_begin[1];
+			record.hw_branch_misses = hw_end[2] - hw_begin[2];
+		}
+		int64_t cells_end, wires_end;
+		perf_count_objects(design, cells_end, wires_end);
+		record.cells_delta = cells_end - cells_begin;
+		record.wires_delta = wires_end - wires_begin;
+		record.arena_bytes = pass_arena()->alloc_bytes - arena_bytes_begin;
+		record.arena_calls = pass_arena()->alloc_calls - arena_calls_begin;
+		pass_perf_records.push_back(std::move(record));
+	}
+
+	~PassPerfScope()
+	{
+		if (active)
+			depth--;
+	}
+};
+
+int PassPerfScope::depth = 0;
+
 void Pass::call(RTLIL::Design *design, std::string command)
 {
 	std::vector<std::string> args;
@@ -295,6 +586,47 @@ void Pass::call(RTLIL::Design *design, std::string command)
 	call(design, args);
 }
 
+static int64_t current_rss_kb()
+{
+#if defined(__linux__)
+	// ru_maxrss is the peak and never comes back down, so read the current
+	// resident set size from /proc instead
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f != nullptr) {
+		long pages_total, pages_resident;
+		int rc = fscanf(f, "%ld %ld", &pages_total, &pages_resident);
+		fclose(f);
+		if (rc == 2)
+			return (int64_t)pages_resident * (sysconf(_SC_PAGESIZE) >> 10);
+	}
+	return 0;
+#else
+	return perf_peak_rss_kb();
+#endif
+}
+
+// reclaim memory between commands when the process approaches the budget
+// configured via `scratchpad -set memory.budget <MiB>` (unset or 0 disables
+// the check): the named designs held by `design -save`/`design -stash` are
+// spilled to on-disk checkpoints and restored transparently on their next use
+static void check_memory_budget(RTLIL::Design *design)
+{
+	int budget_mb = design->scratchpad_get_int("memory.budget", 0);
+	if (budget_mb <= 0)
+		return;
+
+	int64_t rss_kb = current_rss_kb();
+	if (rss_kb <= 0 || rss_kb < (int64_t)budget_mb * 1024 * 9 / 10)
+		return;
+
+	if (saved_designs.empty())
+		return;
+
+	log_warning("Memory usage (%.1f MiB) is near the configured budget of %d MiB. "
+			"Spilling saved designs to disk checkpoints.\n", rss_kb / 1024.0, budget_mb);
+	spill_saved_designs();
+}
+
 void Pass::call(RTLIL::Design *design, std::vector<std::string> args)
 {
 	if (args.size() == 0 || args[0][0] == '#' || args[0][0] == ':')
@@ -307,18 +639,58 @@ void Pass::call(RTLIL::Design *design, std::vector<std::string> args)
 		log("\n");
 	}
 
-	if (pass_register.count(args[0]) == 0)
+	if (pass_register.count(args[0]) == 0 && !load_lazy_plugin(args[0]))
 		log_cmd_error("No such command: %s (type 'help' for a command overview)\n", args[0].c_str());
 
 	if (pass_register[args[0]]->experimental_flag)
 		log_experimental("%s", args[0].c_str());
 
+	if (DesignJournal *journal = DesignJournal::get(design)) {
+		std::string command;
+		for (auto &arg : args)
+			command += (command.empty() ? "" : " ") + arg;
+		journal->record_pass_marker(command);
+	}
+
+	check_memory_budget(design);
+
 	size_t orig_sel_stack_pos = design->selection_stack.size();
+
+	// Unfreeze via RAII so a log_cmd_error() thrown by a read-only pass
+	// does not leave the design frozen for the rest of the session.
+	struct FreezeGuard {
+		RTLIL::Design *design = nullptr;
+		~FreezeGuard() { if (design) design->unfreeze(); }
+	} freeze_guard;
+	if (pass_register[args[0]]->readonly_flag) {
+		design->freeze();
+		freeze_guard.design = design;
+	}
+
+	// nested commands (e.g. from script passes) fold into the undo record
+	// of the top-level command that ran them
+	static int call_depth = 0;
+	struct CallDepthGuard {
+		~CallDepthGuard() { call_depth--; }
+	} call_depth_guard;
+	call_depth++;
+
+	PassArenaScope arena_scope;
+	PassPerfScope perf_scope(design, args);
 	auto state = pass_register[args[0]]->pre_execute();
 	pass_register[args[0]]->execute(args, design);
 	pass_register[args[0]]->post_execute(state);
+	perf_scope.finish();
 	while (design->selection_stack.size() > orig_sel_stack_pos)
 		design->selection_stack.pop_back();
+
+	if (call_depth == 1)
+		if (DesignUndoHistory *history = DesignUndoHistory::get(design)) {
+			std::string command;
+			for (auto &arg : args)
+				command += (command.empty() ? "" : " ") + arg;
+			history->commit_command(command);
+		}
 }
 
 void Pass::call_on_selection(RTLIL::Design *design, const RTLIL::Selection &selection, std::string command)
@@ -371,6 +743,13 @@ void Pass::call_on_module(RTLIL::Design *design, RTLIL::Module *module, std::vec
 	design->selected_active_module = backup_selected_active_module;
 }
 
+void Pass::foreach_module_parallel(RTLIL::Design *design, const std::function<void(RTLIL::Module*)> &worker)
+{
+	std::vector<RTLIL::Module*> modules = design->selected_modules();
+	ThreadPool::run(ThreadPool::thread_count(design), GetSize(modules),
+			[&](int i) { worker(modules[i]); });
+}
+
 bool ScriptPass::check_label(std::string label, std::string info)
 {
 	if (active_design == nullptr) {
@@ -527,42 +906,66 @@ void Frontend::extra_args(std::istream *&f, std::string &filename, std::vector<s
 				next_args.insert(next_args.end(), args.begin(), args.begin()+argidx);
 				next_args.insert(next_args.end(), filenames.begin()+1, filenames.end());
 			}
-			std::ifstream *ff = new std::ifstream;
-			ff->open(filename.c_str(), bin_input ? std::ifstream::binary : std::ifstream::in);
-			yosys_input_files.insert(filename);
-			if (ff->fail()) {
-				delete ff;
-				ff = nullptr;
+			// serve files that the `prefetch' command read in the background
+			// from memory; compressed files still go through the regular path
+			// below (the prefetch then only warmed the OS file cache)
+			std::string prefetched;
+			bool use_prefetched = FilePrefetcher::fetch(filename, prefetched);
+			if (use_prefetched && prefetched.size() >= 4) {
+				unsigned char m0 = prefetched[0], m1 = prefetched[1], m2 = prefetched[2], m3 = prefetched[3];
+				if ((m0 == 0x1f && m1 == 0x8b) || (m0 == 0x28 && m1 == 0xb5 && m2 == 0x2f && m3 == 0xfd))
+					use_prefetched = false;
 			}
-			f = ff;
-			if (f != NULL) {
-				// Check for gzip magic
-				unsigned char magic[3];
-				int n = 0;
-				while (n < 3)
-				{
-					int c = ff->get();
-					if (c != EOF) {
-						magic[n] = (unsigned char) c;
-					}
-					n++;
+			if (use_prefetched) {
+				yosys_input_files.insert(filename);
+				f = new std::istringstream(std::move(prefetched));
+			} else {
+				std::ifstream *ff = new std::ifstream;
+				ff->open(filename.c_str(), bin_input ? std::ifstream::binary : std::ifstream::in);
+				yosys_input_files.insert(filename);
+				if (ff->fail()) {
+					delete ff;
+					ff = nullptr;
 				}
-				if (n == 3 && magic[0] == 0x1f && magic[1] == 0x8b) {
+				f = ff;
+				if (f != NULL) {
+					// Check for compression magic
+					unsigned char magic[4] = {};
+					int n = 0;
+					while (n < 4)
+					{
+						int c = ff->get();
+						if (c == EOF)
+							break;
+						magic[n++] = (unsigned char) c;
+					}
+					if (n >= 3 && magic[0] == 0x1f && magic[1] == 0x8b) {
 	#ifdef YOSYS_ENABLE_ZLIB
-					log("Found gzip magic in file `%s', decompressing using zlib.\n", filename.c_str());
-					if (magic[2] != 8)
-						log_cmd_error("gzip file `%s' uses unsupported compression type %02x\n",
-							filename.c_str(), unsigned(magic[2]));
-					delete ff;
-					std::stringstream *df = new std::stringstream();
-					decompress_gzip(filename, *df);
-					f = df;
+						log("Found gzip magic in file `%s', decompressing using zlib.\n", filename.c_str());
+						if (magic[2] != 8)
+							log_cmd_error("gzip file `%s' uses unsupported compression type %02x\n",
+								filename.c_str(), unsigned(magic[2]));
+						delete ff;
+						std::stringstream *df = new std::stringstream();
+						decompress_gzip(filename, *df);
+						f = df;
 	#else
-					log_cmd_error("File `%s' is a gzip file, but Yosys is compiled without zlib.\n", filename.c_str());
+						log_cmd_error("File `%s' is a gzip file, but Yosys is compiled without zlib.\n", filename.c_str());
 	#endif
-				} else {
-					ff->clear();
-					ff->seekg(0, std::ios::beg);
+					} else if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+	#ifdef YOSYS_ENABLE_ZSTD
+						log("Found zstd magic in file `%s', decompressing using libzstd.\n", filename.c_str());
+						delete ff;
+						std::stringstream *df = new std::stringstream();
+						decompress_zstd(filename, *df);
+						f = df;
+	#else
+						log_cmd_error("File `%s' is a zstd file, but Yosys is compiled without zstd support.\n", filename.c_str());
+	#endif
+					} else {
+						ff->clear();
+						ff->seekg(0, std::ios::beg);
+					}
 				}
 			}
 		}
@@ -686,6 +1089,18 @@ void Backend::extra_args(std::ostream *&f, std::string &filename, std::vector<st
 			f = gf;
 #else
 			log_cmd_error("Yosys is compiled without zlib support, unable to write gzip output.\n");
+#endif
+		} else if (filename.size() > 4 && filename.compare(filename.size()-4, std::string::npos, ".zst") == 0) {
+#ifdef YOSYS_ENABLE_ZSTD
+			zstd_ostream *zf = new zstd_ostream;
+			if (!zf->open(filename)) {
+				delete zf;
+				log_cmd_error("Can't open output file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+			}
+			yosys_output_files.insert(filename);
+			f = zf;
+#else
+			log_cmd_error("Yosys is compiled without zstd support, unable to write zstd output.\n");
 #endif
 		} else {
 			std::ofstream *ff = new std::ofstream;
@@ -748,6 +1163,15 @@ void Backend::backend_call(RTLIL::Design *design, std::ostream *f, std::string f
 		design->selection_stack.pop_back();
 }
 
+void Backend::backend_call_multi(RTLIL::Design *design, const std::vector<std::string> &commands)
+{
+	// the first backend sorts the design; dict::sort() detects the already
+	// sorted state, so the remaining backends skip the sort/rehash work and
+	// only pay for their own traversal and output formatting
+	for (auto &command : commands)
+		backend_call(design, nullptr, "", command);
+}
+
 struct SimHelper {
 	string name;
 	inline string filesafe_name() {
@@ -43,6 +43,16 @@ struct Pass
 		experimental_flag = true;
 	}
 
+	bool readonly_flag = false;
+
+	// Declares that this pass never modifies the netlist (scratchpad and
+	// selection changes are still allowed). Pass::call() freezes the design
+	// for the duration of such passes, turning an accidental modification
+	// into an assertion failure; see RTLIL::Design::freeze().
+	void readonly() {
+		readonly_flag = true;
+	}
+
 	struct pre_post_exec_state_t {
 		Pass *parent_pass;
 		int64_t begin_ns;
@@ -64,6 +74,13 @@ struct Pass
 	static void call_on_module(RTLIL::Design *design, RTLIL::Module *module, std::string command);
 	static void call_on_module(RTLIL::Design *design, RTLIL::Module *module, std::vector<std::string> args);
 
+	// Run worker on every selected module, across a thread pool when the
+	// "threads" scratchpad variable (or YOSYS_THREADS) asks for more than one
+	// thread. Only passes whose per-module work is independent may use this:
+	// the worker must not log, create IdStrings, or touch anything outside
+	// its module. See kernel/threadpool.h for the full contract.
+	static void foreach_module_parallel(RTLIL::Design *design, const std::function<void(RTLIL::Module*)> &worker);
+
 	Pass *next_queued_pass;
 	virtual void run_register();
 	static void init_register();
@@ -124,6 +141,11 @@ struct Backend : Pass
 
 	static void backend_call(RTLIL::Design *design, std::ostream *f, std::string filename, std::string command);
 	static void backend_call(RTLIL::Design *design, std::ostream *f, std::string filename, std::vector<std::string> args);
+
+	// run several backend command lines against the same design state in one
+	// call, so the design-wide preparation (sorting the object dictionaries)
+	// is only paid once (see the 'write_multi' command)
+	static void backend_call_multi(RTLIL::Design *design, const std::vector<std::string> &commands);
 };
 
 // implemented in passes/cmds/select.cc
@@ -135,6 +157,76 @@ extern std::map<std::string, Pass*> pass_register;
 extern std::map<std::string, Frontend*> frontend_register;
 extern std::map<std::string, Backend*> backend_register;
 
+// One record per completed pass invocation while profiling is active (see the
+// 'perfreport' command). Times are inclusive of nested Pass::call()s, which
+// are recorded as separate entries with a larger depth.
+struct PassPerfRecord
+{
+	std::string pass_name;
+	std::string command;
+	int depth;
+	int64_t wall_ns;
+	int64_t cpu_ns;
+	int64_t peak_rss_delta_kb;
+	int64_t cells_delta;
+	int64_t wires_delta;
+	// hardware counter deltas ('perfreport -record -counters', Linux only;
+	// zero when the counters could not be opened)
+	int64_t hw_cycles;
+	int64_t hw_cache_misses;
+	int64_t hw_branch_misses;
+	// pass-arena allocations made directly by this command (nested commands
+	// use their own arena and account separately)
+	int64_t arena_bytes;
+	int64_t arena_calls;
+};
+
+extern bool pass_perf_active;
+extern bool pass_perf_counters;
+extern std::vector<PassPerfRecord> pass_perf_records;
+
+// Pass-scoped bump allocator for temporaries that die before the pass
+// returns. Pass::call() opens one arena per pass invocation and bulk-frees it
+// when the command returns, so worker structs can route large short-lived
+// containers through ArenaAllocator<> instead of handing every node back to
+// the global allocator one by one at pass end. Allocation totals are recorded
+// per command while 'perfreport -record' is active.
+struct PassArena
+{
+	struct chunk_t {
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+	std::vector<chunk_t> chunks;
+	size_t used = 0;          // bytes used in the newest chunk
+	int64_t alloc_bytes = 0;  // lifetime statistics for perfreport
+	int64_t alloc_calls = 0;
+
+	void *alloc(size_t size, size_t align = alignof(std::max_align_t));
+};
+
+// arena of the innermost running pass; outside any Pass::call() a
+// session-lifetime fallback arena is returned, so the result is never null
+PassArena *pass_arena();
+
+// std-compatible allocator bound to the arena that was innermost when the
+// allocator was created. deallocate() is a no-op: the backing memory is
+// reclaimed in one step when the owning pass returns, so containers using
+// this allocator must not outlive the pass invocation that created them.
+template <typename T>
+struct ArenaAllocator
+{
+	typedef T value_type;
+	PassArena *arena;
+	ArenaAllocator() : arena(pass_arena()) { }
+	explicit ArenaAllocator(PassArena *arena) : arena(arena) { }
+	template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) { }
+	T *allocate(size_t n) { return static_cast<T*>(arena->alloc(n * sizeof(T), alignof(T))); }
+	void deallocate(T*, size_t) { }
+	bool operator==(const ArenaAllocator &other) const { return arena == other.arena; }
+	bool operator!=(const ArenaAllocator &other) const { return arena != other.arena; }
+};
+
 YOSYS_NAMESPACE_END
 
 #endif
@@ -22,6 +22,7 @@
 #include "kernel/celltypes.h"
 #include "kernel/binding.h"
 #include "kernel/sigtools.h"
+#include "kernel/utils.h"
 #include "frontends/verilog/verilog_frontend.h"
 #include "frontends/verilog/preproc.h"
 #include "backends/rtlil/rtlil_backend.h"
@@ -36,6 +37,7 @@ bool RTLIL::IdString::destruct_guard_ok = false;
 RTLIL::IdString::destruct_guard_t RTLIL::IdString::destruct_guard;
 std::vector<char*> RTLIL::IdString::global_id_storage_;
 dict<char*, int> RTLIL::IdString::global_id_index_;
+bool RTLIL::IdString::parallel_section_active = false;
 #ifndef YOSYS_NO_IDS_REFCNT
 std::vector<int> RTLIL::IdString::global_refcount_storage_;
 std::vector<int> RTLIL::IdString::global_free_idx_list_;
@@ -209,15 +211,34 @@ Const::bitvectype& Const::get_bits() const {
 	return *get_if_bits();
 }
 
-std::string& Const::get_str() const {
+const std::string& Const::get_str() const {
 	check(is_str());
 	return *get_if_str();
 }
 
+// Intern table for string constant backing. Like the IdString table this
+// lives for the whole process: attribute values (src strings dominate) repeat
+// across many objects but only a small number of distinct strings exist, so
+// pinning them is cheap and makes every repeated construction a lookup
+// instead of an allocation. Strings too large to plausibly repeat bypass the
+// table.
+static std::shared_ptr<const std::string> intern_const_str(const std::string &str)
+{
+	static dict<std::string, std::shared_ptr<const std::string>> interned_strings;
+
+	if (str.size() > 256)
+		return std::make_shared<const std::string>(str);
+
+	auto it = interned_strings.find(str);
+	if (it == interned_strings.end())
+		it = interned_strings.emplace(str, std::make_shared<const std::string>(str)).first;
+	return it->second;
+}
+
 RTLIL::Const::Const(const std::string &str)
 {
 	flags = RTLIL::CONST_FLAG_STRING;
-	new ((void*)&str_) std::string(str);
+	new ((void*)&str_) strvectype(intern_const_str(str));
 	tag = backing_tag::string;
 }
 
@@ -256,13 +277,47 @@ RTLIL::Const::Const(const std::vector<bool> &bits)
 		bv.emplace_back(b ? State::S1 : State::S0);
 }
 
+// Copying a Const whose bits payload is at least this large first switches
+// the source to the shared immutable backing, so the copy (and every further
+// copy) only bumps a reference count. Mutating accessors un-share through
+// bitvectorize(), which gives copy-on-write semantics for cell parameters,
+// attribute values and Mem init data duplicated by clone/stash flows. Small
+// payloads stay plain vectors: a shared_ptr plus control block costs more
+// than it saves there.
+static constexpr size_t CONST_COW_MIN_BITS = 64;
+
+void RTLIL::Const::share_payload() const
+{
+	if (!is_bits())
+		return;
+	// retagging bits->shared mutates the *source* of a copy, so copying a
+	// design-owned Const from a worker thread would race on tag/union state;
+	// fail fast like IdString refcounting does (see kernel/threadpool.h)
+	log_assert(!RTLIL::IdString::parallel_section_active);
+	sharedvectype payload = std::make_shared<const bitvectype>(std::move(bits_));
+	// sketchy zone
+	bits_.~bitvectype();
+	new ((void*)&shared_) sharedvectype(std::move(payload));
+	tag = backing_tag::shared;
+}
+
 RTLIL::Const::Const(const RTLIL::Const &other) {
+	if (other.is_bits() && other.bits_.size() >= CONST_COW_MIN_BITS)
+		other.share_payload();
 	tag = other.tag;
 	flags = other.flags;
 	if (is_str())
-		new ((void*)&str_) std::string(other.get_str());
+		new ((void*)&str_) strvectype(other.str_);
 	else if (is_bits())
 		new ((void*)&bits_) bitvectype(other.get_bits());
+	else if (is_packed()) {
+		new ((void*)&packed_) packedvectype(other.packed_);
+		packed_width_ = other.packed_width_;
+	} else if (is_spilled()) {
+		new ((void*)&spill_) spillvectype(other.spill_);
+		packed_width_ = other.packed_width_;
+	} else if (is_shared())
+		new ((void*)&shared_) sharedvectype(other.shared_);
 	else
 		check(false);
 }
@@ -271,35 +326,66 @@ RTLIL::Const::Const(RTLIL::Const &&other) {
 	tag = other.tag;
 	flags = other.flags;
 	if (is_str())
-		new ((void*)&str_) std::string(std::move(other.get_str()));
+		new ((void*)&str_) strvectype(std::move(other.str_));
 	else if (is_bits())
 		new ((void*)&bits_) bitvectype(std::move(other.get_bits()));
+	else if (is_packed()) {
+		new ((void*)&packed_) packedvectype(std::move(other.packed_));
+		packed_width_ = other.packed_width_;
+	} else if (is_spilled()) {
+		new ((void*)&spill_) spillvectype(std::move(other.spill_));
+		packed_width_ = other.packed_width_;
+	} else if (is_shared())
+		new ((void*)&shared_) sharedvectype(std::move(other.shared_));
 	else
 		check(false);
 }
 
 RTLIL::Const &RTLIL::Const::operator =(const RTLIL::Const &other) {
+	if (other.is_bits() && other.bits_.size() >= CONST_COW_MIN_BITS)
+		other.share_payload();
 	flags = other.flags;
-	if (other.is_str()) {
-		if (!is_str()) {
-			// sketchy zone
-			check(is_bits());
+	if (tag != other.tag) {
+		// sketchy zone
+		if (is_bits())
 			bits_.~bitvectype();
-			(void)new ((void*)&str_) std::string();
+		else if (is_str())
+			str_.~strvectype();
+		else if (is_packed())
+			packed_.~packedvectype();
+		else if (is_shared())
+			shared_.~sharedvectype();
+		else {
+			check(is_spilled());
+			spill_.~spillvectype();
 		}
-		tag = other.tag;
-		get_str() = other.get_str();
-	} else if (other.is_bits()) {
-		if (!is_bits()) {
-			// sketchy zone
-			check(is_str());
-			str_.~string();
+		if (other.is_str())
+			(void)new ((void*)&str_) strvectype();
+		else if (other.is_bits())
 			(void)new ((void*)&bits_) bitvectype();
+		else if (other.is_packed())
+			(void)new ((void*)&packed_) packedvectype();
+		else if (other.is_shared())
+			(void)new ((void*)&shared_) sharedvectype();
+		else {
+			check(other.is_spilled());
+			(void)new ((void*)&spill_) spillvectype();
 		}
 		tag = other.tag;
+	}
+	if (other.is_str())
+		str_ = other.str_;
+	else if (other.is_bits())
 		get_bits() = other.get_bits();
-	} else {
-		check(false);
+	else if (other.is_packed()) {
+		packed_ = other.packed_;
+		packed_width_ = other.packed_width_;
+	} else if (other.is_shared())
+		shared_ = other.shared_;
+	else {
+		check(other.is_spilled());
+		spill_ = other.spill_;
+		packed_width_ = other.packed_width_;
 	}
 	return *this;
 }
@@ -308,7 +394,13 @@ RTLIL::Const::~Const() {
 	if (is_bits())
 		bits_.~bitvectype();
 	else if (is_str())
-		str_.~string();
+		str_.~strvectype();
+	else if (is_packed())
+		packed_.~packedvectype();
+	else if (is_spilled())
+		spill_.~spillvectype();
+	else if (is_shared())
+		shared_.~sharedvectype();
 	else
 		check(false);
 }
@@ -499,7 +591,11 @@ std::string RTLIL::Const::decode_string() const
 
 int RTLIL::Const::size() const {
 	if (is_str())
-		return 8 * str_.size();
+		return 8 * str_->size();
+	else if (is_packed() || is_spilled())
+		return packed_width_;
+	else if (is_shared())
+		return shared_->size();
 	else {
 		check(is_bits());
 		return bits_.size();
@@ -508,7 +604,11 @@ int RTLIL::Const::size() const {
 
 bool RTLIL::Const::empty() const {
 	if (is_str())
-		return str_.empty();
+		return str_->empty();
+	else if (is_packed() || is_spilled())
+		return packed_width_ == 0;
+	else if (is_shared())
+		return shared_->empty();
 	else {
 		check(is_bits());
 		return bits_.empty();
@@ -519,13 +619,56 @@ void RTLIL::Const::bitvectorize() const {
 	if (tag == backing_tag::bits)
 		return;
 
-	check(is_str());
-
 	bitvectype new_bits;
 
-	new_bits.reserve(str_.size() * 8);
-	for (int i = str_.size() - 1; i >= 0; i--) {
-		unsigned char ch = str_[i];
+	if (is_shared()) {
+		new_bits = *shared_;
+
+		// sketchy zone
+		shared_.~sharedvectype();
+		(void)new ((void*)&bits_) bitvectype(std::move(new_bits));
+		tag = backing_tag::bits;
+		return;
+	}
+
+	if (is_spilled()) {
+		spilled_backing backing = *spill_;
+		if (backing.packed_words) {
+			packedvectype words(backing.region.bytes / sizeof(uint32_t));
+			ConstSpill::read(backing.region, words.data());
+			new_bits.reserve(packed_width_);
+			for (int i = 0; i < packed_width_; i++)
+				new_bits.push_back((words[i / 32] >> (i % 32)) & 1 ? State::S1 : State::S0);
+		} else {
+			static_assert(sizeof(State) == 1, "raw spill payloads are one byte per bit");
+			new_bits.resize(packed_width_);
+			ConstSpill::read(backing.region, new_bits.data());
+		}
+
+		// sketchy zone
+		spill_.~spillvectype();
+		(void)new ((void*)&bits_) bitvectype(std::move(new_bits));
+		tag = backing_tag::bits;
+		return;
+	}
+
+	if (is_packed()) {
+		new_bits.reserve(packed_width_);
+		for (int i = 0; i < packed_width_; i++)
+			new_bits.push_back((packed_[i / 32] >> (i % 32)) & 1 ? State::S1 : State::S0);
+
+		// sketchy zone
+		packed_.~packedvectype();
+		(void)new ((void*)&bits_) bitvectype(std::move(new_bits));
+		tag = backing_tag::bits;
+		return;
+	}
+
+	check(is_str());
+
+	new_bits.reserve(str_->size() * 8);
+	for (int i = str_->size() - 1; i >= 0; i--) {
+		unsigned char ch = (*str_)[i];
 		for (int j = 0; j < 8; j++) {
 			new_bits.push_back((ch & 1) != 0 ? State::S1 : State::S0);
 			ch = ch >> 1;
@@ -534,16 +677,126 @@ void RTLIL::Const::bitvectorize() const {
 
 	{
 		// sketchy zone
-		str_.~string();
+		str_.~strvectype();
 		(void)new ((void*)&bits_) bitvectype(std::move(new_bits));
 		tag = backing_tag::bits;
 	}
 }
 
+void RTLIL::Const::compact() const {
+	if (!is_bits())
+		return;
+
+	for (auto b : bits_)
+		if (b != State::S0 && b != State::S1)
+			return;
+
+	packedvectype words((bits_.size() + 31) / 32, 0);
+	for (size_t i = 0; i < bits_.size(); i++)
+		if (bits_[i] == State::S1)
+			words[i / 32] |= uint32_t(1) << (i % 32);
+	int width = GetSize(bits_);
+
+	{
+		// sketchy zone
+		bits_.~bitvectype();
+		(void)new ((void*)&packed_) packedvectype(std::move(words));
+		packed_width_ = width;
+		tag = backing_tag::packed;
+	}
+}
+
+bool RTLIL::Const::spill() const {
+	if (is_spilled())
+		return true;
+
+	// string backing is interned and shared, see intern_const_str()
+	if (is_str())
+		return false;
+
+	// interned constants already share one in-memory payload, see intern()
+	if (is_shared())
+		return false;
+
+	// prefer the 32x denser packed payload when the bits allow it
+	compact();
+
+	spilled_backing backing;
+	int width;
+	if (is_packed()) {
+		backing.region = ConstSpill::write(packed_.data(), packed_.size() * sizeof(uint32_t));
+		backing.packed_words = true;
+		width = packed_width_;
+	} else {
+		check(is_bits());
+		backing.region = ConstSpill::write(bits_.data(), bits_.size());
+		backing.packed_words = false;
+		width = GetSize(bits_);
+	}
+
+	{
+		// sketchy zone
+		if (is_packed())
+			packed_.~packedvectype();
+		else
+			bits_.~bitvectype();
+		(void)new ((void*)&spill_) spillvectype(std::make_shared<const spilled_backing>(backing));
+		packed_width_ = width;
+		tag = backing_tag::spilled;
+	}
+	return true;
+}
+
+void RTLIL::Const::intern(hashlib::pool<RTLIL::Const> &intern_pool) const {
+	// string backing is interned globally and spilled payloads are shared
+	// already; flags stay per-instance, so constants that differ only in
+	// flags can still share one payload
+	if (is_shared() || is_str() || is_spilled())
+		return;
+
+	auto it = intern_pool.find(*this);
+	if (it == intern_pool.end()) {
+		bitvectorize();
+		RTLIL::Const canonical;
+		canonical.flags = flags;
+		{
+			// sketchy zone
+			canonical.bits_.~bitvectype();
+			(void)new ((void*)&canonical.shared_) sharedvectype(std::make_shared<const bitvectype>(bits_));
+			canonical.tag = backing_tag::shared;
+		}
+		it = intern_pool.insert(std::move(canonical)).first;
+	}
+
+	sharedvectype payload = it->shared_;
+	{
+		// sketchy zone
+		if (is_bits())
+			bits_.~bitvectype();
+		else {
+			check(is_packed());
+			packed_.~packedvectype();
+		}
+		(void)new ((void*)&shared_) sharedvectype(std::move(payload));
+		tag = backing_tag::shared;
+	}
+}
+
 RTLIL::State RTLIL::Const::const_iterator::operator*() const {
+	if (parent.is_spilled())
+		parent.bitvectorize();
+
 	if (auto bv = parent.get_if_bits())
 		return (*bv)[idx];
 
+	// read interned constants through the shared payload, so iteration
+	// (and with it hashing and comparison) does not un-share them
+	if (auto sv = parent.get_if_shared())
+		return (*sv)[idx];
+
+	if (auto pw = parent.get_if_packed())
+		return ((*pw)[idx / 32] >> (idx % 32)) & 1 ? State::S1 : State::S0;
+
 	int char_idx = parent.get_str().size() - idx / 8 - 1;
 	bool bit = (parent.get_str()[char_idx] & (1 << (idx % 8)));
 	return bit ? State::S1 : State::S0;
@@ -551,6 +804,13 @@ RTLIL::State RTLIL::Const::const_iterator::operator*() const {
 
 bool RTLIL::Const::is_fully_zero() const
 {
+	if (auto pw = get_if_packed()) {
+		for (auto word : *pw)
+			if (word != 0)
+				return false;
+		return true;
+	}
+
 	bitvectorize();
 	bitvectype& bv = get_bits();
 	cover("kernel.rtlil.const.is_fully_zero");
@@ -564,6 +824,15 @@ bool RTLIL::Const::is_fully_zero() const
 
 bool RTLIL::Const::is_fully_ones() const
 {
+	if (auto pw = get_if_packed()) {
+		for (int i = 0; i < packed_width_; i += 32) {
+			uint32_t mask = packed_width_ - i >= 32 ? ~uint32_t(0) : (uint32_t(1) << (packed_width_ - i)) - 1;
+			if (((*pw)[i / 32] & mask) != mask)
+				return false;
+		}
+		return true;
+	}
+
 	bitvectorize();
 	bitvectype& bv = get_bits();
 	cover("kernel.rtlil.const.is_fully_ones");
@@ -579,6 +848,9 @@ bool RTLIL::Const::is_fully_def() const
 {
 	cover("kernel.rtlil.const.is_fully_def");
 
+	if (is_packed())
+		return true;
+
 	bitvectorize();
 	bitvectype& bv = get_bits();
 
@@ -593,6 +865,9 @@ bool RTLIL::Const::is_fully_undef() const
 {
 	cover("kernel.rtlil.const.is_fully_undef");
 
+	if (is_packed())
+		return packed_width_ == 0;
+
 	bitvectorize();
 	bitvectype& bv = get_bits();
 
@@ -607,6 +882,9 @@ bool RTLIL::Const::is_fully_undef_x_only() const
 {
 	cover("kernel.rtlil.const.is_fully_undef_x_only");
 
+	if (is_packed())
+		return packed_width_ == 0;
+
 	bitvectorize();
 	bitvectype& bv = get_bits();
 
@@ -921,6 +1199,7 @@ void RTLIL::Design::add(RTLIL::Module *module)
 {
 	log_assert(modules_.count(module->name) == 0);
 	log_assert(refcount_modules_ == 0);
+	log_assert(!frozen());
 	modules_[module->name] = module;
 	module->design = this;
 
@@ -944,6 +1223,7 @@ RTLIL::Module *RTLIL::Design::addModule(RTLIL::IdString name)
 	if (modules_.count(name) != 0)
 		log_error("Attempted to add new module named '%s', but a module by that name already exists\n", name.c_str());
 	log_assert(refcount_modules_ == 0);
+	log_assert(!frozen());
 
 	RTLIL::Module *module = new RTLIL::Module;
 	modules_[name] = module;
@@ -1028,6 +1308,8 @@ std::string RTLIL::Design::scratchpad_get_string(const std::string &varname, con
 
 void RTLIL::Design::remove(RTLIL::Module *module)
 {
+	log_assert(!frozen());
+
 	for (auto mon : monitors)
 		mon->notify_module_del(module);
 
@@ -1042,6 +1324,25 @@ void RTLIL::Design::remove(RTLIL::Module *module)
 	delete module;
 }
 
+void RTLIL::Design::transfer(RTLIL::Module *module, RTLIL::Design *new_design)
+{
+	log_assert(modules_.at(module->name) == module);
+	log_assert(refcount_modules_ == 0);
+	log_assert(!frozen() && !new_design->frozen());
+
+	for (auto mon : monitors)
+		mon->notify_module_del(module);
+
+	if (yosys_xtrace) {
+		log("#X# Transfer Module: %s\n", log_id(module));
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+
+	modules_.erase(module->name);
+	module->design = nullptr;
+	new_design->add(module);
+}
+
 void RTLIL::Design::rename(RTLIL::Module *module, RTLIL::IdString new_name)
 {
 	modules_.erase(module->name);
@@ -1243,7 +1544,51 @@ RTLIL::IdString RTLIL::Module::derive(RTLIL::Design*, const dict<RTLIL::IdString
 
 size_t RTLIL::Module::count_id(const RTLIL::IdString& id)
 {
-	return wires_.count(id) + memories.count(id) + cells_.count(id) + processes.count(id);
+	size_t count = memories.count(id) + processes.count(id);
+	if (name_filter_maybe(id))
+		count += wires_.count(id) + cells_.count(id);
+	return count;
+}
+
+void RTLIL::Module::name_filter_rebuild(int min_entries)
+{
+	size_t words = 16;
+	while (int(words) * 16 < min_entries)
+		words *= 2;
+
+	name_filter_.assign(words, 0);
+	name_filter_entries_ = 0;
+
+	for (auto &it : wires_)
+		name_filter_insert(it.first);
+	for (auto &it : cells_)
+		name_filter_insert(it.first);
+}
+
+void RTLIL::Module::name_filter_insert(const RTLIL::IdString &id)
+{
+	if (name_filter_entries_ >= GetSize(name_filter_) * 16)
+		name_filter_rebuild(2 * name_filter_entries_ + 64);
+
+	size_t mask = name_filter_.size() * 64 - 1;
+	unsigned int h1 = hashlib::mkhash_xorshift((unsigned int)id.index_);
+	unsigned int h2 = hashlib::mkhash_xorshift(h1 ^ 0x9e3779b9);
+	name_filter_[(h1 & mask) >> 6] |= uint64_t(1) << (h1 & 63);
+	name_filter_[(h2 & mask) >> 6] |= uint64_t(1) << (h2 & 63);
+	name_filter_entries_++;
+}
+
+bool RTLIL::Module::name_filter_maybe(const RTLIL::IdString &id) const
+{
+	if (name_filter_.empty())
+		return true;
+
+	size_t mask = name_filter_.size() * 64 - 1;
+	unsigned int h1 = hashlib::mkhash_xorshift((unsigned int)id.index_);
+	if ((name_filter_[(h1 & mask) >> 6] & (uint64_t(1) << (h1 & 63))) == 0)
+		return false;
+	unsigned int h2 = hashlib::mkhash_xorshift(h1 ^ 0x9e3779b9);
+	return (name_filter_[(h2 & mask) >> 6] & (uint64_t(1) << (h2 & 63))) != 0;
 }
 
 #ifndef NDEBUG
@@ -2183,6 +2528,89 @@ void RTLIL::Module::sort()
 		it.second->attributes.sort(sort_by_id_str());
 }
 
+void RTLIL::Module::compact()
+{
+	// The objects themselves are not moved (pointers into the module stay
+	// valid), but the dictionaries are rebuilt so that iteration visits cells
+	// in driver-before-reader order and wires in the order of their first use.
+	// Linear passes that walk the cells and chase their connections then touch
+	// the entry storage and the connected wires in a much more sequential
+	// pattern than the creation/erase order left behind.
+
+	log_assert(refcount_wires_ == 0);
+	log_assert(refcount_cells_ == 0);
+
+	SigMap sigmap(this);
+	dict<RTLIL::SigBit, pool<RTLIL::IdString>> bit_drivers, bit_users;
+	TopoSort<RTLIL::IdString, RTLIL::sort_by_id_str> toposort;
+
+	for (auto &it : cells_)
+	{
+		RTLIL::Cell *cell = it.second;
+		toposort.node(cell->name);
+
+		for (auto &conn : cell->connections())
+		{
+			// registers and memory read ports break the feedback paths
+			if (yosys_celltypes.cell_known(cell->type)) {
+				if (conn.first.in(ID::Q, ID::CTRL_OUT, ID::RD_DATA))
+					continue;
+				if (cell->type.in(ID($memrd), ID($memrd_v2)) && conn.first == ID::DATA)
+					continue;
+			}
+
+			if (cell->input(conn.first))
+				for (auto bit : sigmap(conn.second))
+					bit_users[bit].insert(cell->name);
+
+			if (cell->output(conn.first))
+				for (auto bit : sigmap(conn.second))
+					bit_drivers[bit].insert(cell->name);
+		}
+	}
+
+	for (auto &it : bit_users)
+		if (bit_drivers.count(it.first))
+			for (auto driver_cell : bit_drivers.at(it.first))
+			for (auto user_cell : it.second)
+				toposort.edge(driver_cell, user_cell);
+
+	toposort.analyze_loops = false;
+	toposort.sort();
+
+	dict<RTLIL::IdString, RTLIL::Cell*> new_cells;
+	new_cells.reserve(GetSize(cells_));
+	for (auto &name : toposort.sorted)
+		new_cells[name] = cells_.at(name);
+	log_assert(GetSize(new_cells) == GetSize(cells_));
+	cells_.swap(new_cells);
+
+	dict<RTLIL::IdString, RTLIL::Wire*> new_wires;
+	new_wires.reserve(GetSize(wires_));
+
+	auto visit_sig = [&](const RTLIL::SigSpec &sig) {
+		for (auto &chunk : sig.chunks())
+			if (chunk.wire != nullptr && !new_wires.count(chunk.wire->name))
+				new_wires[chunk.wire->name] = chunk.wire;
+	};
+
+	for (auto &name : ports)
+		new_wires[name] = wires_.at(name);
+	for (auto &it : cells_)
+		for (auto &conn : it.second->connections())
+			visit_sig(conn.second);
+	for (auto &conn : connections_) {
+		visit_sig(conn.first);
+		visit_sig(conn.second);
+	}
+	for (auto &it : wires_)
+		if (!new_wires.count(it.first))
+			new_wires[it.first] = it.second;
+
+	log_assert(GetSize(new_wires) == GetSize(wires_));
+	wires_.swap(new_wires);
+}
+
 void RTLIL::Module::check()
 {
 #ifndef NDEBUG
@@ -2309,8 +2737,14 @@ void RTLIL::Module::cloneInto(RTLIL::Module *new_mod) const
 	for (auto &attr : attributes)
 		new_mod->attributes[attr.first] = attr.second;
 
+	// mapping the old wire pointers directly avoids one name lookup per
+	// rewritten chunk below
+	dict<const RTLIL::Wire*, RTLIL::Wire*> wire_map;
+	wire_map.reserve(wires_.size());
+	new_mod->wires_.reserve(new_mod->wires_.size() + wires_.size());
+	new_mod->cells_.reserve(new_mod->cells_.size() + cells_.size());
 	for (auto &it : wires_)
-		new_mod->addWire(it.first, it.second);
+		wire_map[it.second] = new_mod->addWire(it.first, it.second);
 
 	for (auto &it : memories)
 		new_mod->addMemory(it.first, it.second);
@@ -2323,18 +2757,18 @@ void RTLIL::Module::cloneInto(RTLIL::Module *new_mod) const
 
 	struct RewriteSigSpecWorker
 	{
-		RTLIL::Module *mod;
+		const dict<const RTLIL::Wire*, RTLIL::Wire*> *wire_map;
 		void operator()(RTLIL::SigSpec &sig)
 		{
 			sig.pack();
 			for (auto &c : sig.chunks_)
 				if (c.wire != NULL)
-					c.wire = mod->wires_.at(c.wire->name);
+					c.wire = wire_map->at(c.wire);
 		}
 	};
 
 	RewriteSigSpecWorker rewriteSigSpecWorker;
-	rewriteSigSpecWorker.mod = new_mod;
+	rewriteSigSpecWorker.wire_map = &wire_map;
 	new_mod->rewrite_sigspecs(rewriteSigSpecWorker);
 	new_mod->fixup_ports();
 }
@@ -2393,24 +2827,29 @@ std::vector<RTLIL::Cell*> RTLIL::Module::selected_cells() const
 
 void RTLIL::Module::add(RTLIL::Wire *wire)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(!wire->name.empty());
 	log_assert(count_id(wire->name) == 0);
 	log_assert(refcount_wires_ == 0);
 	wires_[wire->name] = wire;
 	wire->module = this;
+	name_filter_insert(wire->name);
 }
 
 void RTLIL::Module::add(RTLIL::Cell *cell)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(!cell->name.empty());
 	log_assert(count_id(cell->name) == 0);
 	log_assert(refcount_cells_ == 0);
 	cells_[cell->name] = cell;
 	cell->module = this;
+	name_filter_insert(cell->name);
 }
 
 void RTLIL::Module::add(RTLIL::Process *process)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(!process->name.empty());
 	log_assert(count_id(process->name) == 0);
 	processes[process->name] = process;
@@ -2425,6 +2864,7 @@ void RTLIL::Module::add(RTLIL::Binding *binding)
 
 void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(refcount_wires_ == 0);
 
 	struct DeleteWireWorker
@@ -2461,8 +2901,44 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 	}
 }
 
+void RTLIL::Module::remove(const pool<RTLIL::Cell*> &cells)
+{
+	log_assert(design == nullptr || !design->frozen());
+	log_assert(refcount_cells_ == 0);
+
+	// without monitors attached there is no need for the per-port unsetPort
+	// bookkeeping, the connections die with the cell itself
+	bool notify = !monitors.empty() || (design != nullptr && !design->monitors.empty()) || yosys_xtrace;
+
+	for (auto cell : cells) {
+		log_assert(cells_.count(cell->name) != 0);
+		if (notify)
+			while (!cell->connections_.empty())
+				cell->unsetPort(cell->connections_.begin()->first);
+	}
+
+	if (GetSize(cells) > GetSize(cells_) / 2) {
+		// most of the module goes away: rebuild the dict once instead of
+		// erasing entry by entry
+		dict<RTLIL::IdString, RTLIL::Cell*> new_cells;
+		new_cells.reserve(GetSize(cells_) - GetSize(cells));
+		for (auto &it : cells_)
+			if (cells.count(it.second) == 0)
+				new_cells.insert(it);
+		cells_.swap(new_cells);
+	} else {
+		for (auto cell : cells)
+			cells_.erase(cell->name);
+	}
+
+	for (auto cell : cells)
+		delete cell;
+}
+
 void RTLIL::Module::remove(RTLIL::Cell *cell)
 {
+	log_assert(design == nullptr || !design->frozen());
+
 	while (!cell->connections_.empty())
 		cell->unsetPort(cell->connections_.begin()->first);
 
@@ -2474,6 +2950,7 @@ void RTLIL::Module::remove(RTLIL::Cell *cell)
 
 void RTLIL::Module::remove(RTLIL::Process *process)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(processes.count(process->name) != 0);
 	processes.erase(process->name);
 	delete process;
@@ -2508,8 +2985,55 @@ void RTLIL::Module::rename(RTLIL::IdString old_name, RTLIL::IdString new_name)
 		log_abort();
 }
 
+void RTLIL::Module::rename(const dict<RTLIL::Wire*, RTLIL::IdString> &new_wire_names, const dict<RTLIL::Cell*, RTLIL::IdString> &new_cell_names)
+{
+	log_assert(design == nullptr || !design->frozen());
+	log_assert(refcount_wires_ == 0);
+	log_assert(refcount_cells_ == 0);
+
+	if (!new_wire_names.empty()) {
+		dict<RTLIL::IdString, RTLIL::Wire*> new_wires;
+		new_wires.reserve(wires_.size());
+		for (auto &it : wires_) {
+			RTLIL::Wire *wire = it.second;
+			auto found = new_wire_names.find(wire);
+			if (found != new_wire_names.end()) {
+				log_assert(!found->second.empty());
+				wire->name = found->second;
+				name_filter_insert(wire->name);
+			}
+			bool inserted = new_wires.emplace(wire->name, wire).second;
+			log_assert(inserted);
+		}
+		wires_.swap(new_wires);
+	}
+
+	if (!new_cell_names.empty()) {
+		dict<RTLIL::IdString, RTLIL::Cell*> new_cells;
+		new_cells.reserve(cells_.size());
+		for (auto &it : cells_) {
+			RTLIL::Cell *cell = it.second;
+			auto found = new_cell_names.find(cell);
+			if (found != new_cell_names.end()) {
+				log_assert(!found->second.empty());
+				cell->name = found->second;
+				name_filter_insert(cell->name);
+			}
+			bool inserted = new_cells.emplace(cell->name, cell).second;
+			log_assert(inserted);
+		}
+		cells_.swap(new_cells);
+	}
+
+	for (auto &it : new_wire_names)
+		log_assert(cells_.count(it.second) == 0);
+	for (auto &it : new_cell_names)
+		log_assert(wires_.count(it.second) == 0);
+}
+
 void RTLIL::Module::swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(wires_[w1->name] == w1);
 	log_assert(wires_[w2->name] == w2);
 	log_assert(refcount_wires_ == 0);
@@ -2525,6 +3049,7 @@ void RTLIL::Module::swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2)
 
 void RTLIL::Module::swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2)
 {
+	log_assert(design == nullptr || !design->frozen());
 	log_assert(cells_[c1->name] == c1);
 	log_assert(cells_[c2->name] == c2);
 	log_assert(refcount_cells_ == 0);
@@ -2544,6 +3069,23 @@ RTLIL::IdString RTLIL::Module::uniquify(RTLIL::IdString name)
 	return uniquify(name, index);
 }
 
+RTLIL::IdString RTLIL::Module::uniquify_reserve(RTLIL::IdString name)
+{
+	int &index = uniquify_counters_[name];
+
+	if (index == 0) {
+		index++;
+		if (count_id(name) == 0)
+			return name;
+	}
+
+	while (1) {
+		RTLIL::IdString new_name = stringf("%s_%d", name.c_str(), index++);
+		if (count_id(new_name) == 0)
+			return new_name;
+	}
+}
+
 RTLIL::IdString RTLIL::Module::uniquify(RTLIL::IdString name, int &index)
 {
 	if (index == 0) {
@@ -2572,8 +3114,24 @@ static bool fixup_ports_compare(const RTLIL::Wire *a, const RTLIL::Wire *b)
 	return a->port_id < b->port_id;
 }
 
+void RTLIL::Monitor::notify_connect(RTLIL::Cell *cell, const dict<RTLIL::IdString, RTLIL::SigSpec> &new_connections)
+{
+	// report each port change through the per-port hook, so monitors that do
+	// not implement the bulk hook still observe bulk connection updates
+	for (auto &conn : new_connections) {
+		auto it = cell->connections().find(conn.first);
+		if (it != cell->connections().end()) {
+			if (it->second != conn.second)
+				notify_connect(cell, conn.first, it->second, conn.second);
+		} else
+			notify_connect(cell, conn.first, RTLIL::SigSpec(), conn.second);
+	}
+}
+
 void RTLIL::Module::connect(const RTLIL::SigSig &conn)
 {
+	log_assert(design == nullptr || !design->frozen());
+
 	for (auto mon : monitors)
 		mon->notify_connect(this, conn);
 
@@ -2608,8 +3166,52 @@ void RTLIL::Module::connect(const RTLIL::SigSpec &lhs, const RTLIL::SigSpec &rhs
 	connect(RTLIL::SigSig(lhs, rhs));
 }
 
+void RTLIL::Module::connect(const std::vector<RTLIL::SigSig> &new_conns)
+{
+	if (new_conns.empty())
+		return;
+
+	log_assert(design == nullptr || !design->frozen());
+
+	for (auto mon : monitors)
+		mon->notify_connect(this, new_conns);
+
+	if (design)
+		for (auto mon : design->monitors)
+			mon->notify_connect(this, new_conns);
+
+	if (yosys_xtrace) {
+		log("#X# Connect vector in %s:\n", log_id(this));
+		for (auto &conn : new_conns)
+			log("#X#    %s = %s (%d bits)\n", log_signal(conn.first), log_signal(conn.second), GetSize(conn.first));
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+
+	connections_.reserve(connections_.size() + new_conns.size());
+	for (auto &conn : new_conns)
+	{
+		// ignore all attempts to assign constants to other constants
+		if (conn.first.has_const()) {
+			RTLIL::SigSig new_conn;
+			for (int i = 0; i < GetSize(conn.first); i++)
+				if (conn.first[i].wire) {
+					new_conn.first.append(conn.first[i]);
+					new_conn.second.append(conn.second[i]);
+				}
+			if (GetSize(new_conn.first))
+				connections_.push_back(std::move(new_conn));
+			continue;
+		}
+
+		log_assert(GetSize(conn.first) == GetSize(conn.second));
+		connections_.push_back(conn);
+	}
+}
+
 void RTLIL::Module::new_connections(const std::vector<RTLIL::SigSig> &new_conn)
 {
+	log_assert(design == nullptr || !design->frozen());
+
 	for (auto mon : monitors)
 		mon->notify_connect(this, new_conn);
 
@@ -2651,6 +3253,18 @@ void RTLIL::Module::fixup_ports()
 	}
 }
 
+void RTLIL::Module::reserve_new_wires(int count)
+{
+	if (count > 0)
+		wires_.reserve(wires_.size() + count);
+}
+
+void RTLIL::Module::reserve_new_cells(int count)
+{
+	if (count > 0)
+		cells_.reserve(cells_.size() + count);
+}
+
 RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, int width)
 {
 	RTLIL::Wire *wire = new RTLIL::Wire;
@@ -2683,6 +3297,13 @@ RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, RTLIL::IdString type)
 	return cell;
 }
 
+RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, RTLIL::IdString type, dict<RTLIL::IdString, RTLIL::SigSpec> connections)
+{
+	RTLIL::Cell *cell = addCell(name, type);
+	cell->setPorts(std::move(connections));
+	return cell;
+}
+
 RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, const RTLIL::Cell *other)
 {
 	RTLIL::Cell *cell = addCell(name, other->type);
@@ -2692,6 +3313,114 @@ RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, const RTLIL::Cell *oth
 	return cell;
 }
 
+void RTLIL::Module::strash_begin()
+{
+	strash_index.clear();
+	strash_aliases.clear();
+	strash_active = true;
+}
+
+void RTLIL::Module::strash_end()
+{
+	strash_active = false;
+	strash_index.clear();
+	strash_aliases.clear();
+}
+
+// collect the input connections of a cell in canonical form: output aliases
+// introduced by earlier merges are resolved, the ports are sorted, and the
+// operands of commutative operations are swap-normalized (only when the A/B
+// parameters agree, so the parameter check stays a plain compare)
+static void strash_cell_inputs(RTLIL::Cell *cell, const dict<RTLIL::SigBit, RTLIL::SigBit> &aliases,
+		std::vector<std::pair<RTLIL::IdString, RTLIL::SigSpec>> &inputs)
+{
+	inputs.clear();
+	for (auto &conn : cell->connections()) {
+		if (yosys_celltypes.cell_output(cell->type, conn.first))
+			continue;
+		RTLIL::SigSpec sig = conn.second;
+		sig.replace(aliases);
+		inputs.emplace_back(conn.first, std::move(sig));
+	}
+
+	std::sort(inputs.begin(), inputs.end(),
+			[](const std::pair<RTLIL::IdString, RTLIL::SigSpec> &a, const std::pair<RTLIL::IdString, RTLIL::SigSpec> &b) {
+				return a.first < b.first;
+			});
+
+	bool commutative = cell->type.in(ID($_AND_), ID($_OR_), ID($_XOR_), ID($_XNOR_));
+	if (cell->type.in(ID($and), ID($or), ID($xor), ID($xnor), ID($add), ID($mul), ID($logic_and), ID($logic_or)))
+		commutative = cell->parameters.at(ID::A_WIDTH) == cell->parameters.at(ID::B_WIDTH) &&
+				cell->parameters.at(ID::A_SIGNED) == cell->parameters.at(ID::B_SIGNED);
+
+	if (commutative) {
+		RTLIL::SigSpec *sig_a = nullptr, *sig_b = nullptr;
+		for (auto &it : inputs) {
+			if (it.first == ID::A) sig_a = &it.second;
+			if (it.first == ID::B) sig_b = &it.second;
+		}
+		if (sig_a != nullptr && sig_b != nullptr && *sig_b < *sig_a)
+			std::swap(*sig_a, *sig_b);
+	}
+}
+
+RTLIL::Cell *RTLIL::Module::strashCell(RTLIL::Cell *cell)
+{
+	if (!strash_active)
+		return cell;
+
+	if (!yosys_celltypes.cell_evaluable(cell->type) || cell->has_keep_attr())
+		return cell;
+
+	std::vector<std::pair<RTLIL::IdString, RTLIL::SigSpec>> inputs;
+	strash_cell_inputs(cell, strash_aliases, inputs);
+
+	Hasher h;
+	h.eat(cell->type);
+	for (auto &it : inputs) {
+		h.eat(it.first);
+		h.eat(it.second);
+	}
+	Hasher::hash_t key = h.yield();
+
+	auto it = strash_index.find(key);
+	if (it != strash_index.end())
+		for (auto other : it->second)
+		{
+			if (other->type != cell->type)
+				continue;
+			if (!(other->parameters == cell->parameters))
+				continue;
+
+			std::vector<std::pair<RTLIL::IdString, RTLIL::SigSpec>> other_inputs;
+			strash_cell_inputs(other, strash_aliases, other_inputs);
+			if (other_inputs != inputs)
+				continue;
+
+			// equivalent cell found: alias the outputs and drop the duplicate
+			for (auto &conn : cell->connections_) {
+				if (!yosys_celltypes.cell_output(cell->type, conn.first))
+					continue;
+				RTLIL::SigSpec rep_sig = other->getPort(conn.first);
+				rep_sig.replace(strash_aliases);
+				RTLIL::SigSig alias_conn;
+				for (int i = 0; i < GetSize(conn.second) && i < GetSize(rep_sig); i++)
+					if (conn.second[i].wire != nullptr) {
+						strash_aliases[conn.second[i]] = rep_sig[i];
+						alias_conn.first.append(conn.second[i]);
+						alias_conn.second.append(rep_sig[i]);
+					}
+				if (GetSize(alias_conn.first) > 0)
+					connect(alias_conn);
+			}
+			remove(cell);
+			return other;
+		}
+
+	strash_index[key].insert(cell);
+	return cell;
+}
+
 RTLIL::Memory *RTLIL::Module::addMemory(RTLIL::IdString name, const RTLIL::Memory *other)
 {
 	RTLIL::Memory *mem = new RTLIL::Memory;
@@ -3971,6 +4700,38 @@ void RTLIL::Cell::setPort(const RTLIL::IdString& portname, RTLIL::SigSpec signal
 	conn_it->second = std::move(signal);
 }
 
+void RTLIL::Cell::setPorts(dict<RTLIL::IdString, RTLIL::SigSpec> new_connections)
+{
+	// the buffered-normalized flow maintains per-wire driver bookkeeping in
+	// setPort, so ports are set one at a time in that mode
+	if (module->design && module->design->flagBufferedNormalized) {
+		for (auto &conn : new_connections)
+			setPort(conn.first, std::move(conn.second));
+		return;
+	}
+
+	for (auto mon : module->monitors)
+		mon->notify_connect(this, new_connections);
+
+	if (module->design)
+		for (auto mon : module->design->monitors)
+			mon->notify_connect(this, new_connections);
+
+	if (yosys_xtrace) {
+		for (auto &conn : new_connections)
+			log("#X# Connect %s.%s.%s = %s (%d)\n", log_id(this->module), log_id(this), log_id(conn.first), log_signal(conn.second), GetSize(conn.second));
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+
+	if (connections_.empty()) {
+		connections_ = std::move(new_connections);
+	} else {
+		connections_.reserve(connections_.size() + new_connections.size());
+		for (auto &conn : new_connections)
+			connections_[conn.first] = std::move(conn.second);
+	}
+}
+
 const RTLIL::SigSpec &RTLIL::Cell::getPort(const RTLIL::IdString& portname) const
 {
 	return connections_.at(portname);
@@ -4368,6 +5129,17 @@ RTLIL::SigSpec::SigSpec(const std::vector<RTLIL::SigChunk> &chunks)
 	check();
 }
 
+RTLIL::SigSpec::SigSpec(const RTLIL::SigChunkVec &chunks)
+{
+	cover("kernel.rtlil.sigspec.init.chunkvec");
+
+	width_ = 0;
+	hash_ = 0;
+	for (const auto &c : chunks)
+		append(c);
+	check();
+}
+
 RTLIL::SigSpec::SigSpec(const std::vector<RTLIL::SigBit> &bits)
 {
 	cover("kernel.rtlil.sigspec.init.stdvec_bits");
@@ -4822,8 +5594,7 @@ void RTLIL::SigSpec::remove_const()
 	{
 		cover("kernel.rtlil.sigspec.remove_const.packed");
 
-		std::vector<RTLIL::SigChunk> new_chunks;
-		new_chunks.reserve(GetSize(chunks_));
+		RTLIL::SigChunkVec new_chunks;
 
 		width_ = 0;
 		for (auto &chunk : chunks_)
@@ -5109,6 +5880,12 @@ bool RTLIL::SigSpec::operator ==(const RTLIL::SigSpec &other) const
 	if (width_ == 0)
 		return true;
 
+	// Don't force a representation change on either side just to compare:
+	// equality of the bit sequences is equivalent to equality of the
+	// canonical chunk forms.
+	if (!packed() && !other.packed())
+		return bits_ == other.bits_;
+
 	pack();
 	other.pack();
 
@@ -5131,11 +5908,26 @@ bool RTLIL::SigSpec::operator ==(const RTLIL::SigSpec &other) const
 	return true;
 }
 
+// The read-only queries below answer from whichever representation is
+// currently cached instead of forcing a conversion. This keeps code that
+// interleaves bit-level access with these queries (common in the opt
+// passes) from ping-ponging between pack() and unpack(). Note that empty
+// SigSpecs always count as packed, so the unpacked branches can rely on
+// bits_ being non-empty.
+
 bool RTLIL::SigSpec::is_wire() const
 {
 	cover("kernel.rtlil.sigspec.is_wire");
 
-	pack();
+	if (!packed()) {
+		if (bits_[0].wire == NULL || bits_[0].wire->width != width_)
+			return false;
+		for (int i = 0; i < width_; i++)
+			if (bits_[i].wire != bits_[0].wire || bits_[i].offset != i)
+				return false;
+		return true;
+	}
+
 	return GetSize(chunks_) == 1 && chunks_[0].wire && chunks_[0].wire->width == width_;
 }
 
@@ -5143,7 +5935,19 @@ bool RTLIL::SigSpec::is_chunk() const
 {
 	cover("kernel.rtlil.sigspec.is_chunk");
 
-	pack();
+	if (!packed()) {
+		if (bits_[0].wire == NULL) {
+			for (auto &bit : bits_)
+				if (bit.wire != NULL)
+					return false;
+			return true;
+		}
+		for (int i = 0; i < width_; i++)
+			if (bits_[i].wire != bits_[0].wire || bits_[i].offset != bits_[0].offset + i)
+				return false;
+		return true;
+	}
+
 	return GetSize(chunks_) == 1;
 }
 
@@ -5151,7 +5955,13 @@ bool RTLIL::SigSpec::is_fully_const() const
 {
 	cover("kernel.rtlil.sigspec.is_fully_const");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire != NULL)
+				return false;
+		return true;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++)
 		if (it->width > 0 && it->wire != NULL)
 			return false;
@@ -5162,7 +5972,13 @@ bool RTLIL::SigSpec::is_fully_zero() const
 {
 	cover("kernel.rtlil.sigspec.is_fully_zero");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire != NULL || bit.data != RTLIL::State::S0)
+				return false;
+		return true;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++) {
 		if (it->width > 0 && it->wire != NULL)
 			return false;
@@ -5177,7 +5993,13 @@ bool RTLIL::SigSpec::is_fully_ones() const
 {
 	cover("kernel.rtlil.sigspec.is_fully_ones");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire != NULL || bit.data != RTLIL::State::S1)
+				return false;
+		return true;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++) {
 		if (it->width > 0 && it->wire != NULL)
 			return false;
@@ -5192,7 +6014,13 @@ bool RTLIL::SigSpec::is_fully_def() const
 {
 	cover("kernel.rtlil.sigspec.is_fully_def");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire != NULL || (bit.data != RTLIL::State::S0 && bit.data != RTLIL::State::S1))
+				return false;
+		return true;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++) {
 		if (it->width > 0 && it->wire != NULL)
 			return false;
@@ -5207,7 +6035,13 @@ bool RTLIL::SigSpec::is_fully_undef() const
 {
 	cover("kernel.rtlil.sigspec.is_fully_undef");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire != NULL || (bit.data != RTLIL::State::Sx && bit.data != RTLIL::State::Sz))
+				return false;
+		return true;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++) {
 		if (it->width > 0 && it->wire != NULL)
 			return false;
@@ -5222,7 +6056,13 @@ bool RTLIL::SigSpec::has_const() const
 {
 	cover("kernel.rtlil.sigspec.has_const");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire == NULL)
+				return true;
+		return false;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++)
 		if (it->width > 0 && it->wire == NULL)
 			return true;
@@ -5233,7 +6073,13 @@ bool RTLIL::SigSpec::has_marked_bits() const
 {
 	cover("kernel.rtlil.sigspec.has_marked_bits");
 
-	pack();
+	if (!packed()) {
+		for (auto &bit : bits_)
+			if (bit.wire == NULL && bit.data == RTLIL::State::Sm)
+				return true;
+		return false;
+	}
+
 	for (auto it = chunks_.begin(); it != chunks_.end(); it++)
 		if (it->width > 0 && it->wire == NULL) {
 			for (size_t i = 0; i < it->data.size(); i++)
@@ -5247,12 +6093,10 @@ bool RTLIL::SigSpec::is_onehot(int *pos) const
 {
 	cover("kernel.rtlil.sigspec.is_onehot");
 
-	pack();
 	if (!is_fully_const())
 		return false;
-	log_assert(GetSize(chunks_) <= 1);
 	if (width_)
-		return RTLIL::Const(chunks_[0].data).is_onehot(pos);
+		return as_const().is_onehot(pos);
 	return false;
 }
 
@@ -5260,10 +6104,9 @@ bool RTLIL::SigSpec::as_bool() const
 {
 	cover("kernel.rtlil.sigspec.as_bool");
 
-	pack();
-	log_assert(is_fully_const() && GetSize(chunks_) <= 1);
+	log_assert(is_fully_const());
 	if (width_)
-		return RTLIL::Const(chunks_[0].data).as_bool();
+		return as_const().as_bool();
 	return false;
 }
 
@@ -5271,10 +6114,9 @@ int RTLIL::SigSpec::as_int(bool is_signed) const
 {
 	cover("kernel.rtlil.sigspec.as_int");
 
-	pack();
-	log_assert(is_fully_const() && GetSize(chunks_) <= 1);
+	log_assert(is_fully_const());
 	if (width_)
-		return RTLIL::Const(chunks_[0].data).as_int(is_signed);
+		return as_const().as_int(is_signed);
 	return 0;
 }
 
@@ -5299,7 +6141,15 @@ RTLIL::Const RTLIL::SigSpec::as_const() const
 {
 	cover("kernel.rtlil.sigspec.as_const");
 
-	pack();
+	if (!packed()) {
+		log_assert(is_fully_const());
+		std::vector<RTLIL::State> data;
+		data.reserve(width_);
+		for (auto &bit : bits_)
+			data.push_back(bit.data);
+		return RTLIL::Const(data);
+	}
+
 	log_assert(is_fully_const() && GetSize(chunks_) <= 1);
 	if (width_)
 		return chunks_[0].data;
@@ -5310,8 +6160,9 @@ RTLIL::Wire *RTLIL::SigSpec::as_wire() const
 {
 	cover("kernel.rtlil.sigspec.as_wire");
 
-	pack();
 	log_assert(is_wire());
+	if (!packed())
+		return bits_[0].wire;
 	return chunks_[0].wire;
 }
 
@@ -5319,8 +6170,12 @@ RTLIL::SigChunk RTLIL::SigSpec::as_chunk() const
 {
 	cover("kernel.rtlil.sigspec.as_chunk");
 
-	pack();
 	log_assert(is_chunk());
+	if (!packed()) {
+		if (bits_[0].wire == NULL)
+			return RTLIL::SigChunk(as_const());
+		return RTLIL::SigChunk(bits_[0].wire, bits_[0].offset, width_);
+	}
 	return chunks_[0];
 }
 
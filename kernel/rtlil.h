@@ -22,6 +22,7 @@
 
 #include "kernel/yosys_common.h"
 #include "kernel/yosys.h"
+#include "kernel/constspill.h"
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -66,9 +67,11 @@ namespace RTLIL
 	struct Memory;
 	struct Cell;
 	struct SigChunk;
+	struct SigChunkVec;
 	struct SigBit;
 	struct SigSpecIterator;
 	struct SigSpecConstIterator;
+	struct SigSpecBitsView;
 	struct SigSpec;
 	struct CaseRule;
 	struct SwitchRule;
@@ -98,6 +101,14 @@ struct RTLIL::IdString
 
 	static std::vector<char*> global_id_storage_;
 	static dict<char*, int> global_id_index_;
+
+	// Set by ThreadPool while worker threads are running. The global id
+	// table is deliberately not synchronized (making the intern/refcount
+	// paths concurrent would tax every single-threaded IdString operation),
+	// so interning a new id or freeing one during a parallel section is a
+	// bug in the calling pass; the two table-mutating paths below assert on
+	// this flag so such bugs fail fast instead of corrupting the table.
+	static bool parallel_section_active;
 #ifndef YOSYS_NO_IDS_REFCNT
 	static std::vector<int> global_refcount_storage_;
 	static std::vector<int> global_free_idx_list_;
@@ -169,6 +180,7 @@ struct RTLIL::IdString
 			return it->second;
 		}
 
+		log_assert(!parallel_section_active);
 		log_assert(p[0] == '$' || p[0] == '\\');
 		log_assert(p[1] != 0);
 		for (const char *c = p; *c; c++)
@@ -249,6 +261,7 @@ struct RTLIL::IdString
 	}
 	static inline void free_reference(int idx)
 	{
+		log_assert(!parallel_section_active);
 		if (yosys_xtrace) {
 			log("#X# Removed IdString '%s' with index %d.\n", global_id_storage_.at(idx), idx);
 			log_backtrace("-X- ", yosys_xtrace-1);
@@ -394,6 +407,52 @@ struct RTLIL::IdString
 	inline bool in(const pool<IdString> &&rhs) const;
 
 	bool isPublic() const { return begins_with("\\"); }
+
+	// Incrementally builds families of "<prefix><suffix>" names, e.g. the
+	// hierarchical names stamped out by techmap and flatten. The prefix is
+	// copied into a reusable buffer once, each name only appends its suffix,
+	// and a per-builder cache short-circuits the global_id_index_ lookup for
+	// names this builder has produced before. The cache holds references to
+	// the produced ids, so they stay interned for the builder's lifetime.
+	struct Builder
+	{
+		std::string buffer;
+		size_t prefix_len = 0;
+		dict<std::string, IdString> cache;
+
+		Builder() { }
+		Builder(const std::string &prefix) { set_prefix(prefix); }
+
+		void set_prefix(const std::string &prefix)
+		{
+			buffer = prefix;
+			prefix_len = buffer.size();
+		}
+
+		IdString operator()(const std::string &suffix)
+		{
+			buffer.resize(prefix_len);
+			buffer += suffix;
+			return intern();
+		}
+
+		IdString operator()(const char *suffix)
+		{
+			buffer.resize(prefix_len);
+			buffer += suffix;
+			return intern();
+		}
+
+		IdString intern()
+		{
+			auto it = cache.find(buffer);
+			if (it != cache.end())
+				return it->second;
+			IdString id(buffer);
+			cache.emplace(buffer, id);
+			return id;
+		}
+	};
 };
 
 namespace hashlib {
@@ -690,23 +749,58 @@ private:
 	friend class KernelRtlilTest;
 	FRIEND_TEST(KernelRtlilTest, ConstStr);
 	using bitvectype = std::vector<RTLIL::State>;
-	enum class backing_tag: bool { bits, string };
+	// String constants share immutable backing: identical strings (src
+	// attributes in particular repeat across many objects) are interned so
+	// all copies point at one allocation, and copying a string constant is
+	// a reference count update instead of a string copy.
+	using strvectype = std::shared_ptr<const std::string>;
+	using packedvectype = std::vector<uint32_t>;
+	// Spilled constants keep only a descriptor of their payload in the
+	// process spill file, see spill(). Copies share the descriptor.
+	struct spilled_backing {
+		ConstSpill::Region region;
+		bool packed_words; // payload is packed words as per compact(), else raw State bytes
+	};
+	using spillvectype = std::shared_ptr<const spilled_backing>;
+	// Interned constants share one immutable bits allocation between all
+	// copies, see intern().
+	using sharedvectype = std::shared_ptr<const bitvectype>;
+	enum class backing_tag: unsigned char { bits, string, packed, spilled, shared };
 	// Do not access the union or tag even in Const methods unless necessary
 	mutable backing_tag tag;
 	union {
 		mutable bitvectype bits_;
-		mutable std::string str_;
+		mutable strvectype str_;
+		// 1 bit per bit for fully defined constants, see compact():
+		// bit i is (packed_[i/32] >> (i%32)) & 1
+		mutable packedvectype packed_;
+		mutable spillvectype spill_;
+		mutable sharedvectype shared_;
 	};
+	// width in bits for the packed and spilled representations
+	mutable int packed_width_ = 0;
 
 	// Use these private utilities instead
 	bool is_bits() const { return tag == backing_tag::bits; }
 	bool is_str() const { return tag == backing_tag::string; }
+	bool is_packed() const { return tag == backing_tag::packed; }
+	bool is_spilled() const { return tag == backing_tag::spilled; }
+	bool is_shared() const { return tag == backing_tag::shared; }
 
 	bitvectype* get_if_bits() const { return is_bits() ? &bits_ : NULL; }
-	std::string* get_if_str() const { return is_str() ? &str_ : NULL; }
+	const std::string* get_if_str() const { return is_str() ? str_.get() : NULL; }
+	packedvectype* get_if_packed() const { return is_packed() ? &packed_ : NULL; }
+	const bitvectype* get_if_shared() const { return is_shared() ? shared_.get() : NULL; }
 
 	bitvectype& get_bits() const;
-	std::string& get_str() const;
+	const std::string& get_str() const;
+
+	// Move a bits payload into the shared immutable representation in place,
+	// so further copies of this constant are reference count updates (see
+	// the copy constructor and assignment). No-op for other backings. Like
+	// compact()/spill()/intern() this invalidates references previously
+	// handed out by bits().
+	void share_payload() const;
 public:
 	Const() : flags(RTLIL::CONST_FLAG_NONE), tag(backing_tag::bits), bits_(std::vector<RTLIL::State>()) {}
 	Const(const std::string &str);
@@ -735,6 +829,34 @@ public:
 	bool empty() const;
 	void bitvectorize() const;
 
+	// Switch a fully defined constant to the packed words representation
+	// (1 bit per bit). No-op for constants with x/z bits or with string
+	// backing. Accessors that hand out State vectors or references switch
+	// the constant back transparently (via bitvectorize()).
+	void compact() const;
+
+	// Returns the packed word representation if this constant is currently
+	// stored packed (bit i is (words[i/32] >> (i%32)) & 1), nullptr
+	// otherwise. See compact().
+	const packedvectype *get_if_packed_words() const { return get_if_packed(); }
+
+	// Move the payload of this constant out to the process spill file (see
+	// kernel/constspill.h), leaving only a small descriptor in memory. Any
+	// accessor that needs the bits faults the payload back in transparently
+	// (via bitvectorize()). String-backed constants are interned and shared,
+	// so they are left alone. Returns true if the constant is backed by the
+	// spill file when the call returns.
+	bool spill() const;
+
+	// Deduplicate the payload of this constant through `intern_pool': the
+	// constant switches to a shared immutable bits backing, and identical
+	// constants interned through the same pool all point at one allocation,
+	// so copying them is a reference count update. Accessors that hand out
+	// State vectors or references switch the constant back to owned bits
+	// first (via bitvectorize()). Typically used with a per-module pool
+	// while generating RTLIL, see frontends/ast/ast.cc.
+	void intern(hashlib::pool<Const> &intern_pool) const;
+
 	class const_iterator {
 	private:
 		const Const& parent;
@@ -890,6 +1012,113 @@ struct RTLIL::SigChunk
 	bool operator !=(const RTLIL::SigChunk &other) const;
 };
 
+// Small-size-optimized vector of SigChunk. A single chunk -- by far the most
+// common case for a packed SigSpec, e.g. a cell port connected to one wire or
+// constant -- is stored inline so that simple cells do not pay an extra heap
+// allocation per connection. Larger signals spill to a heap-backed vector,
+// and the chunks are contiguous in memory either way.
+struct RTLIL::SigChunkVec
+{
+private:
+	RTLIL::SigChunk small_;
+	std::vector<RTLIL::SigChunk> heap_;
+	int size_;
+	bool spilled_;
+
+	void spill() {
+		heap_.reserve(4);
+		heap_.push_back(std::move(small_));
+		small_ = RTLIL::SigChunk();
+		spilled_ = true;
+	}
+
+public:
+	typedef RTLIL::SigChunk value_type;
+	typedef RTLIL::SigChunk *iterator;
+	typedef const RTLIL::SigChunk *const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	SigChunkVec() : size_(0), spilled_(false) {}
+
+	RTLIL::SigChunk *data() { return spilled_ ? heap_.data() : &small_; }
+	const RTLIL::SigChunk *data() const { return spilled_ ? heap_.data() : &small_; }
+
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + size_; }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + size_; }
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+	RTLIL::SigChunk &operator[](int index) { return data()[index]; }
+	const RTLIL::SigChunk &operator[](int index) const { return data()[index]; }
+
+	RTLIL::SigChunk &at(int index) { log_assert(index >= 0 && index < size_); return data()[index]; }
+	const RTLIL::SigChunk &at(int index) const { log_assert(index >= 0 && index < size_); return data()[index]; }
+
+	RTLIL::SigChunk &front() { return data()[0]; }
+	const RTLIL::SigChunk &front() const { return data()[0]; }
+	RTLIL::SigChunk &back() { return data()[size_-1]; }
+	const RTLIL::SigChunk &back() const { return data()[size_-1]; }
+
+	void reserve(size_t n) {
+		if (n > 1) {
+			if (!spilled_ && size_ > 0)
+				spill();
+			heap_.reserve(n);
+		}
+	}
+
+	template<typename... Args>
+	RTLIL::SigChunk &emplace_back(Args&&... args) {
+		if (size_ == 0 && !spilled_) {
+			small_ = RTLIL::SigChunk(std::forward<Args>(args)...);
+			size_ = 1;
+			return small_;
+		}
+		if (!spilled_)
+			spill();
+		size_++;
+		return heap_.emplace_back(std::forward<Args>(args)...);
+	}
+
+	void push_back(const RTLIL::SigChunk &chunk) { emplace_back(chunk); }
+	void push_back(RTLIL::SigChunk &&chunk) { emplace_back(std::move(chunk)); }
+
+	void pop_back() {
+		log_assert(size_ > 0);
+		size_--;
+		if (spilled_)
+			heap_.pop_back();
+		else
+			small_ = RTLIL::SigChunk();
+	}
+
+	void clear() {
+		small_ = RTLIL::SigChunk();
+		heap_.clear();
+		size_ = 0;
+		spilled_ = false;
+	}
+
+	void swap(RTLIL::SigChunkVec &other) {
+		std::swap(small_, other.small_);
+		heap_.swap(other.heap_);
+		std::swap(size_, other.size_);
+		std::swap(spilled_, other.spilled_);
+	}
+
+	operator std::vector<RTLIL::SigChunk>() const {
+		return std::vector<RTLIL::SigChunk>(begin(), end());
+	}
+};
+
 struct RTLIL::SigBit
 {
 	RTLIL::Wire *wire;
@@ -964,12 +1193,59 @@ struct RTLIL::SigSpecConstIterator
 	inline void operator++() { index++; }
 };
 
+// A read-only view for iterating over the bits of a SigSpec without
+// unpacking it: walks the chunks in place when the spec is packed and the
+// bit vector when it is not. Yields SigBit by value -- use begin()/end() on
+// the SigSpec itself when mutable references are needed. The view borrows
+// the spec, so the spec must outlive the iteration; in particular, do not
+// call bits_view() on a temporary inside a range-for.
+struct RTLIL::SigSpecBitsView
+{
+	const RTLIL::SigSpec *sig_p;
+
+	struct const_iterator
+	{
+		typedef std::input_iterator_tag iterator_category;
+		typedef RTLIL::SigBit value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const RTLIL::SigBit* pointer;
+		typedef const RTLIL::SigBit& reference;
+
+		// exactly one of the two walks is active: chunk_p for packed
+		// specs, bit_p for unpacked ones
+		const RTLIL::SigChunk *chunk_p;
+		const RTLIL::SigBit *bit_p;
+		int offset;
+
+		inline RTLIL::SigBit operator*() const {
+			if (bit_p != nullptr)
+				return *bit_p;
+			return RTLIL::SigBit(*chunk_p, offset);
+		}
+		inline void operator++() {
+			if (bit_p != nullptr) {
+				bit_p++;
+			} else if (++offset == chunk_p->width) {
+				chunk_p++;
+				offset = 0;
+			}
+		}
+		inline bool operator==(const const_iterator &other) const {
+			return chunk_p == other.chunk_p && bit_p == other.bit_p && offset == other.offset;
+		}
+		inline bool operator!=(const const_iterator &other) const { return !(*this == other); }
+	};
+
+	inline const_iterator begin() const;
+	inline const_iterator end() const;
+};
+
 struct RTLIL::SigSpec
 {
 private:
 	int width_;
 	Hasher::hash_t hash_;
-	std::vector<RTLIL::SigChunk> chunks_; // LSB at index 0
+	RTLIL::SigChunkVec chunks_; // LSB at index 0
 	std::vector<RTLIL::SigBit> bits_; // LSB at index 0
 
 	void pack() const;
@@ -989,6 +1265,8 @@ private:
 	// but cannot be more specific as it isn't yet declared
 	friend struct RTLIL::Module;
 
+	friend struct RTLIL::SigSpecBitsView;
+
 public:
 	SigSpec() : width_(0), hash_(0) {}
 	SigSpec(std::initializer_list<RTLIL::SigSpec> parts);
@@ -1004,12 +1282,13 @@ public:
 	SigSpec(RTLIL::State bit, int width = 1);
 	SigSpec(const RTLIL::SigBit &bit, int width = 1);
 	SigSpec(const std::vector<RTLIL::SigChunk> &chunks);
+	SigSpec(const RTLIL::SigChunkVec &chunks);
 	SigSpec(const std::vector<RTLIL::SigBit> &bits);
 	SigSpec(const pool<RTLIL::SigBit> &bits);
 	SigSpec(const std::set<RTLIL::SigBit> &bits);
 	explicit SigSpec(bool bit);
 
-	inline const std::vector<RTLIL::SigChunk> &chunks() const { pack(); return chunks_; }
+	inline const RTLIL::SigChunkVec &chunks() const { pack(); return chunks_; }
 	inline const std::vector<RTLIL::SigBit> &bits() const { inline_unpack(); return bits_; }
 
 	inline int size() const { return width_; }
@@ -1024,6 +1303,8 @@ public:
 	inline RTLIL::SigSpecConstIterator begin() const { RTLIL::SigSpecConstIterator it; it.sig_p = this; it.index = 0; return it; }
 	inline RTLIL::SigSpecConstIterator end() const { RTLIL::SigSpecConstIterator it; it.sig_p = this; it.index = width_; return it; }
 
+	inline RTLIL::SigSpecBitsView bits_view() const { return {this}; }
+
 	void sort();
 	void sort_and_unify();
 
@@ -1111,7 +1392,7 @@ public:
 	static bool parse_sel(RTLIL::SigSpec &sig, RTLIL::Design *design, RTLIL::Module *module, std::string str);
 	static bool parse_rhs(const RTLIL::SigSpec &lhs, RTLIL::SigSpec &sig, RTLIL::Module *module, std::string str);
 
-	operator std::vector<RTLIL::SigChunk>() const { return chunks(); }
+	operator std::vector<RTLIL::SigChunk>() const { const auto &c = chunks(); return std::vector<RTLIL::SigChunk>(c.begin(), c.end()); }
 	operator std::vector<RTLIL::SigBit>() const { return bits(); }
 	const RTLIL::SigBit &at(int offset, const RTLIL::SigBit &defval) { return offset < width_ ? (*this)[offset] : defval; }
 
@@ -1169,6 +1450,9 @@ struct RTLIL::Monitor
 	virtual void notify_module_add(RTLIL::Module*) { }
 	virtual void notify_module_del(RTLIL::Module*) { }
 	virtual void notify_connect(RTLIL::Cell*, const RTLIL::IdString&, const RTLIL::SigSpec&, const RTLIL::SigSpec&) { }
+	// fired once per Cell::setPorts() call; the default implementation
+	// reports each changed port through the per-port hook above
+	virtual void notify_connect(RTLIL::Cell*, const dict<RTLIL::IdString, RTLIL::SigSpec>&);
 	virtual void notify_connect(RTLIL::Module*, const RTLIL::SigSig&) { }
 	virtual void notify_connect(RTLIL::Module*, const std::vector<RTLIL::SigSig>&) { }
 	virtual void notify_blackout(RTLIL::Module*) { }
@@ -1189,6 +1473,15 @@ struct RTLIL::Design
 	void bufNormalize(bool enable=true);
 
 	int refcount_modules_;
+
+	// While nonzero the design is frozen: the netlist structure (modules,
+	// wires, cells, processes, connections) must not be modified, which the
+	// mutating methods enforce via log_assert. The scratchpad and the
+	// selection stack stay writable. Pass::call() freezes the design around
+	// passes declared read-only (see Pass::readonly()), so such passes may
+	// safely fan read work out across a thread pool.
+	int refcount_frozen_ = 0;
+
 	dict<RTLIL::IdString, RTLIL::Module*> modules_;
 	std::vector<RTLIL::Binding*> bindings_;
 
@@ -1211,6 +1504,10 @@ struct RTLIL::Design
 		return modules_.count(id) != 0;
 	}
 
+	bool frozen() const { return refcount_frozen_ > 0; }
+	void freeze() { refcount_frozen_++; }
+	void unfreeze() { log_assert(refcount_frozen_ > 0); refcount_frozen_--; }
+
 	void add(RTLIL::Module *module);
 	void add(RTLIL::Binding *binding);
 
@@ -1218,6 +1515,10 @@ struct RTLIL::Design
 	void remove(RTLIL::Module *module);
 	void rename(RTLIL::Module *module, RTLIL::IdString new_name);
 
+	// Detach a module from this design and add it to `new_design'. This
+	// moves the module without the cost of a Module::clone().
+	void transfer(RTLIL::Module *module, RTLIL::Design *new_design);
+
 	void scratchpad_unset(const std::string &varname);
 
 	void scratchpad_set_int(const std::string &varname, int value);
@@ -1302,6 +1603,17 @@ public:
 	dict<RTLIL::IdString, RTLIL::Wire*> wires_;
 	dict<RTLIL::IdString, RTLIL::Cell*> cells_;
 
+	// Bloom-style filter over the wire and cell namespaces: a clear bit pair
+	// means a name is definitely absent, so count_id() misses skip the dict
+	// probes. Removing objects leaves stale bits behind, which only costs the
+	// regular lookup. Maintained by add(); rebuilt (and resized) from the
+	// dicts when it gets too dense.
+	std::vector<uint64_t> name_filter_;
+	int name_filter_entries_ = 0;
+
+	// Per-prefix counters backing uniquify_reserve().
+	dict<RTLIL::IdString, int> uniquify_counters_;
+
 	std::vector<RTLIL::SigSig>   connections_;
 	std::vector<RTLIL::Binding*> bindings_;
 
@@ -1320,6 +1632,10 @@ public:
 	virtual bool reprocess_if_necessary(RTLIL::Design *design);
 
 	virtual void sort();
+	// Rebuild the wire and cell dictionaries in a cache-friendly iteration
+	// order: cells topologically (drivers before readers) and wires in the
+	// order of their first use. Object pointers stay valid.
+	void compact();
 	virtual void check();
 	virtual void optimize();
 	virtual void makeblackbox();
@@ -1330,6 +1646,8 @@ public:
 
 	void connect(const RTLIL::SigSig &conn);
 	void connect(const RTLIL::SigSpec &lhs, const RTLIL::SigSpec &rhs);
+	// append a whole span of connections with a single monitor notification
+	void connect(const std::vector<RTLIL::SigSig> &new_conns);
 	void new_connections(const std::vector<RTLIL::SigSig> &new_conn);
 	const std::vector<RTLIL::SigSig> &connections() const;
 
@@ -1339,6 +1657,22 @@ public:
 	pool<pair<RTLIL::Cell*, RTLIL::IdString>> bufNormQueue;
 	void bufNormalize();
 
+	// Optional structural hashing mode for pass-internal CSE. While active,
+	// strashCell() looks up a fully connected evaluable cell by type,
+	// parameters and input connections. If an equivalent cell was registered
+	// before, the new cell's outputs are connected to the existing outputs,
+	// the duplicate is removed and the existing cell is returned, so
+	// duplicates created by mapping passes never materialize. Output aliases
+	// created this way are tracked so chains of merged cells compare equal.
+	// Cells registered in the index must not be removed or rewired (except
+	// for output ports) while the mode is active.
+	bool strash_active = false;
+	dict<Hasher::hash_t, pool<RTLIL::Cell*>> strash_index;
+	dict<RTLIL::SigBit, RTLIL::SigBit> strash_aliases;
+	void strash_begin();
+	void strash_end();
+	RTLIL::Cell *strashCell(RTLIL::Cell *cell);
+
 	template<typename T> void rewrite_sigspecs(T &functor);
 	template<typename T> void rewrite_sigspecs2(T &functor);
 	void cloneInto(RTLIL::Module *new_mod) const;
@@ -1382,12 +1716,18 @@ public:
 
 	// Removing wires is expensive. If you have to remove wires, remove them all at once.
 	void remove(const pool<RTLIL::Wire*> &wires);
+	// Batch variant for delete-heavy passes: skips the per-port bookkeeping
+	// when possible and rebuilds the cell dict only once.
+	void remove(const pool<RTLIL::Cell*> &cells);
 	void remove(RTLIL::Cell *cell);
 	void remove(RTLIL::Process *process);
 
 	void rename(RTLIL::Wire *wire, RTLIL::IdString new_name);
 	void rename(RTLIL::Cell *cell, RTLIL::IdString new_name);
 	void rename(RTLIL::IdString old_name, RTLIL::IdString new_name);
+	// Batch variant for rename-heavy passes: applies all staged renames at
+	// once and rebuilds the name indices only once.
+	void rename(const dict<RTLIL::Wire*, RTLIL::IdString> &new_wire_names, const dict<RTLIL::Cell*, RTLIL::IdString> &new_cell_names);
 
 	void swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2);
 	void swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2);
@@ -1395,10 +1735,29 @@ public:
 	RTLIL::IdString uniquify(RTLIL::IdString name);
 	RTLIL::IdString uniquify(RTLIL::IdString name, int &index);
 
+	// Like uniquify(), but the per-prefix counter persists on the module, so
+	// the returned name is reserved for the caller and a loop that uniquifies
+	// the same base name many times is amortized constant time per name.
+	RTLIL::IdString uniquify_reserve(RTLIL::IdString name);
+
+	void name_filter_insert(const RTLIL::IdString &id);
+	bool name_filter_maybe(const RTLIL::IdString &id) const;
+	void name_filter_rebuild(int min_entries);
+
 	RTLIL::Wire *addWire(RTLIL::IdString name, int width = 1);
 	RTLIL::Wire *addWire(RTLIL::IdString name, const RTLIL::Wire *other);
 
+	// Pre-size the wire name index for `count' additional wires, so a batch
+	// of addWire() calls (flatten, techmap, memory_map) grows the hash table
+	// at most once instead of rehashing repeatedly while the batch is added.
+	void reserve_new_wires(int count);
+
+	// Same for the cell name index, for passes that materialize cells in
+	// large batches (see proc_dff).
+	void reserve_new_cells(int count);
+
 	RTLIL::Cell *addCell(RTLIL::IdString name, RTLIL::IdString type);
+	RTLIL::Cell *addCell(RTLIL::IdString name, RTLIL::IdString type, dict<RTLIL::IdString, RTLIL::SigSpec> connections);
 	RTLIL::Cell *addCell(RTLIL::IdString name, const RTLIL::Cell *other);
 
 	RTLIL::Memory *addMemory(RTLIL::IdString name, const RTLIL::Memory *other);
@@ -1717,6 +2076,9 @@ public:
 	bool hasPort(const RTLIL::IdString &portname) const;
 	void unsetPort(const RTLIL::IdString &portname);
 	void setPort(const RTLIL::IdString &portname, RTLIL::SigSpec signal);
+	// set several ports at once: the connection dict is grown in one step and
+	// monitors receive a single bulk notification
+	void setPorts(dict<RTLIL::IdString, RTLIL::SigSpec> new_connections);
 	const RTLIL::SigSpec &getPort(const RTLIL::IdString &portname) const;
 	const dict<RTLIL::IdString, RTLIL::SigSpec> &connections() const;
 
@@ -1877,6 +2239,18 @@ inline const RTLIL::SigBit &RTLIL::SigSpecConstIterator::operator*() const {
 	return (*sig_p)[index];
 }
 
+inline RTLIL::SigSpecBitsView::const_iterator RTLIL::SigSpecBitsView::begin() const {
+	if (sig_p->packed())
+		return {sig_p->chunks_.data(), nullptr, 0};
+	return {nullptr, sig_p->bits_.data(), 0};
+}
+
+inline RTLIL::SigSpecBitsView::const_iterator RTLIL::SigSpecBitsView::end() const {
+	if (sig_p->packed())
+		return {sig_p->chunks_.data() + sig_p->chunks_.size(), nullptr, 0};
+	return {nullptr, sig_p->bits_.data() + sig_p->bits_.size(), 0};
+}
+
 inline RTLIL::SigBit::SigBit(const RTLIL::SigSpec &sig) {
 	log_assert(sig.size() == 1 && sig.chunks().size() == 1);
 	*this = SigBit(sig.chunks().front());
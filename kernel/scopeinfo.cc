@@ -58,6 +58,25 @@ void ModuleHdlnameIndex::index_scopeinfo_cells()
 	index_items(cells.begin(), cells.end(), [](Cell *cell) { return cell->type == ID($scopeinfo); });
 }
 
+ModuleHdlnameIndex::Cursor ModuleHdlnameIndex::lookup_hdlname(const std::string &hdlname)
+{
+	std::vector<IdString> path;
+	for (auto const &item : split_tokens(hdlname, " "))
+		path.push_back("\\" + item);
+	if (path.empty())
+		return Cursor();
+	return tree.cursor(path);
+}
+
+std::vector<ModuleHdlnameIndex::Cursor> ModuleHdlnameIndex::lookup_hdlnames(const std::vector<std::string> &hdlnames)
+{
+	std::vector<Cursor> result;
+	result.reserve(hdlnames.size());
+	for (auto const &hdlname : hdlnames)
+		result.push_back(lookup_hdlname(hdlname));
+	return result;
+}
+
 std::vector<std::string> ModuleHdlnameIndex::scope_sources(Cursor cursor)
 {
 	std::vector<std::string> result;
@@ -401,6 +401,25 @@ public:
 		return {tree.cursor(pair.first), pair.second};
 	}
 
+	// Resolve a full hierarchical path (as produced by parse_hdlname) to the
+	// cursor for the named item. The lookup cost is proportional to the path
+	// length, independent of the design size. Returns an invalid cursor if no
+	// prefix-matching scope exists, and a cursor without an entry if the scope
+	// exists but nothing is indexed under the final path component.
+	template<typename P>
+	Cursor lookup_path(const P &path) {
+		return tree.cursor(path);
+	}
+
+	// Resolve a space-separated hierarchical name (hdlname attribute syntax,
+	// the same format `Cursor::path_str` produces) to a cursor.
+	Cursor lookup_hdlname(const std::string &hdlname);
+
+	// Resolve a batch of space-separated hierarchical names. The result uses
+	// the same indices as the argument, with invalid cursors for names that
+	// could not be resolved.
+	std::vector<Cursor> lookup_hdlnames(const std::vector<std::string> &hdlnames);
+
 	// Return a vector of source locations starting from the indexed module to
 	// the scope represented by the cursor. The vector alternates module and
 	// module item source locations, using empty strings for missing src
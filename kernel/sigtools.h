@@ -139,6 +139,123 @@ struct SigPool
 	}
 };
 
+// Assigns a dense integer id to every wire bit of a module, so passes can use
+// flat arrays indexed by bit id where they would otherwise build
+// dict<SigBit, ...> or pool<SigBit> structures that pay a hash probe per bit.
+// Ids are handed out per wire on first use, so the index grows incrementally
+// as a pass walks the module and existing ids stay stable when wires are
+// added. Deleted wires keep their ids reserved; constant bits have no id.
+struct SigBitIndex
+{
+	dict<RTLIL::Wire*, int> wire_base;
+	int num_bits = 0;
+
+	SigBitIndex() { }
+
+	SigBitIndex(RTLIL::Module *module)
+	{
+		for (auto wire : module->wires())
+			base(wire);
+	}
+
+	int size() const { return num_bits; }
+
+	// first id of the given wire, assigning ids to its bits if needed
+	int base(RTLIL::Wire *wire)
+	{
+		auto it = wire_base.find(wire);
+		if (it != wire_base.end())
+			return it->second;
+		int wire_bits = num_bits;
+		wire_base.emplace(wire, wire_bits);
+		num_bits += wire->width;
+		return wire_bits;
+	}
+
+	// id of the given bit, assigning ids to its wire if needed; -1 for
+	// constant bits
+	int operator()(const RTLIL::SigBit &bit)
+	{
+		if (bit.wire == nullptr)
+			return -1;
+		return base(bit.wire) + bit.offset;
+	}
+
+	// id of the given bit without assigning new ids; -1 if it has none
+	int lookup(const RTLIL::SigBit &bit) const
+	{
+		if (bit.wire == nullptr)
+			return -1;
+		auto it = wire_base.find(bit.wire);
+		if (it == wire_base.end())
+			return -1;
+		return it->second + bit.offset;
+	}
+};
+
+// Flat bit set over a shared SigBitIndex, mirroring the SigPool interface for
+// the common add/check use case. Several sets over the same module can share
+// one index; each membership test is an array access instead of a hash probe,
+// and signals are processed one chunk (instead of one bit) per index probe.
+struct SigBitFlatSet
+{
+	SigBitIndex &index;
+	std::vector<bool> set;
+
+	SigBitFlatSet(SigBitIndex &index) : index(index) { }
+
+	void add(const RTLIL::SigSpec &sig)
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int base = index.base(chunk.wire) + chunk.offset;
+			if (base + chunk.width > GetSize(set))
+				set.resize(index.size());
+			for (int i = 0; i < chunk.width; i++)
+				set[base + i] = true;
+		}
+	}
+
+	bool check(int id) const
+	{
+		return id >= 0 && id < GetSize(set) && set[id];
+	}
+
+	bool check(const RTLIL::SigBit &bit) const
+	{
+		return check(index.lookup(bit));
+	}
+
+	bool check_any(const RTLIL::SigSpec &sig) const
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int base = index.lookup(RTLIL::SigBit(chunk.wire, chunk.offset));
+			if (base < 0)
+				continue;
+			for (int i = 0; i < chunk.width; i++)
+				if (check(base + i))
+					return true;
+		}
+		return false;
+	}
+
+	bool check_all(const RTLIL::SigSpec &sig) const
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int base = index.lookup(RTLIL::SigBit(chunk.wire, chunk.offset));
+			for (int i = 0; i < chunk.width; i++)
+				if (!check(base < 0 ? -1 : base + i))
+					return false;
+		}
+		return true;
+	}
+};
+
 template <typename T, class Compare = void>
 struct SigSet
 {
@@ -314,7 +431,7 @@ struct SigMap
 
 	void add(const RTLIL::SigSpec &sig)
 	{
-		for (const auto &bit : sig)
+		for (auto bit : sig.bits_view())
 			add(bit);
 	}
 
@@ -328,8 +445,18 @@ struct SigMap
 
 	void apply(RTLIL::SigSpec &sig) const
 	{
-		for (auto &bit : sig)
-			apply(bit);
+		// scan the chunks in place first: if no bit is remapped, the
+		// packed representation is left alone instead of unpacking the
+		// spec into its bit vector (a frequent allocation in opt passes)
+		int index = 0;
+		for (auto bit : sig.bits_view()) {
+			if (bit.wire != nullptr && database.find(bit) != bit)
+				break;
+			index++;
+		}
+
+		for (int i = index; i < sig.size(); i++)
+			apply(sig[i]);
 	}
 
 	RTLIL::SigBit operator()(RTLIL::SigBit bit) const
@@ -362,6 +489,121 @@ struct SigMap
 	}
 };
 
+// A SigMap that stays attached to a module and tracks connection changes
+// through RTLIL::Monitor, so passes that alternate between rewriting and
+// querying do not pay for a full SigMap rebuild on every iteration. New
+// connections are merged into the union-find directly; operations that can
+// remove connections (replacing the whole connection list, blackout) only
+// mark the map dirty, and the rebuild happens lazily on the next query.
+//
+// Like SigMap itself, this class does not track wire removal: after
+// deleting wires from the module the map must be discarded or set() again.
+struct IncrementalSigMap : RTLIL::Monitor
+{
+	RTLIL::Module *module;
+	SigMap sigmap;
+	bool dirty;
+
+	IncrementalSigMap(RTLIL::Module *module = nullptr) : module(nullptr), dirty(false)
+	{
+		if (module != nullptr)
+			attach(module);
+	}
+
+	~IncrementalSigMap()
+	{
+		detach();
+	}
+
+	void attach(RTLIL::Module *mod)
+	{
+		detach();
+		module = mod;
+		module->monitors.insert(this);
+		sigmap.set(module);
+		dirty = false;
+	}
+
+	void detach()
+	{
+		if (module != nullptr) {
+			module->monitors.erase(this);
+			module = nullptr;
+		}
+		sigmap.clear();
+		dirty = false;
+	}
+
+	void notify_connect(RTLIL::Module *mod, const RTLIL::SigSig &sigsig) override
+	{
+		if (mod == module && !dirty)
+			sigmap.add(sigsig.first, sigsig.second);
+	}
+
+	void notify_connect(RTLIL::Module *mod, const std::vector<RTLIL::SigSig>&) override
+	{
+		// the whole connection list was replaced, which may remove
+		// connections and can not be modeled by further merging
+		if (mod == module)
+			dirty = true;
+	}
+
+	void notify_blackout(RTLIL::Module *mod) override
+	{
+		if (mod == module)
+			dirty = true;
+	}
+
+	void update()
+	{
+		if (dirty) {
+			sigmap.set(module);
+			dirty = false;
+		}
+	}
+
+	// Access the underlying SigMap (rebuilt first if needed), for code that
+	// wants to hand a plain SigMap& to existing helpers. Merging additional
+	// connections into the returned map is harmless, as the monitor performs
+	// the same merges; the reference is invalidated by the next update().
+	SigMap &get()
+	{
+		update();
+		return sigmap;
+	}
+
+	void apply(RTLIL::SigBit &bit)
+	{
+		update();
+		sigmap.apply(bit);
+	}
+
+	void apply(RTLIL::SigSpec &sig)
+	{
+		update();
+		sigmap.apply(sig);
+	}
+
+	RTLIL::SigBit operator()(RTLIL::SigBit bit)
+	{
+		apply(bit);
+		return bit;
+	}
+
+	RTLIL::SigSpec operator()(RTLIL::SigSpec sig)
+	{
+		apply(sig);
+		return sig;
+	}
+
+	RTLIL::SigSpec operator()(RTLIL::Wire *wire)
+	{
+		SigSpec sig(wire);
+		apply(sig);
+		return sig;
+	}
+};
+
 YOSYS_NAMESPACE_END
 
 #endif /* SIGTOOLS_H */
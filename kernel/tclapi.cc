@@ -163,6 +163,111 @@ static int tcl_yosys_cmd(ClientData, Tcl_Interp *interp, int argc, const char *a
 		return TCL_ERROR; \
 	}
 
+// Growable capture buffer exposed as a std::streambuf, so one batch of
+// commands shares a single allocation instead of copying the full log
+// output once per command.
+struct TclBatchStreambuf : public std::streambuf
+{
+	std::string buffer;
+
+	TclBatchStreambuf(size_t reserve_bytes) {
+		buffer.reserve(reserve_bytes);
+	}
+
+	std::streamsize xsputn(const char *s, std::streamsize n) override {
+		buffer.append(s, n);
+		return n;
+	}
+
+	int overflow(int c) override {
+		if (c != EOF)
+			buffer.push_back(c);
+		return c;
+	}
+};
+
+static int tcl_yosys_batch(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+	int i;
+	bool quiet_flag = false, continue_flag = false;
+	for (i = 1; i < objc; i++) {
+		FLAG2(quiet)
+		FLAG2(continue)
+		break;
+	}
+
+	if (i != objc - 1)
+		ERROR("bad usage: expected \"yosys_batch [-quiet] [-continue] <command-list>\"")
+
+	int listc;
+	Tcl_Obj **listv;
+	if (Tcl_ListObjGetElements(interp, objv[i], &listc, &listv) != TCL_OK)
+		return TCL_ERROR;
+
+	TclBatchStreambuf capture(64 * 1024);
+	std::ostream capture_stream(&capture);
+
+	std::vector<FILE*> backup_log_files = log_files;
+	std::vector<std::ostream*> backup_log_streams = log_streams;
+	bool restore_log_cmd_error_throw = log_cmd_error_throw;
+
+	if (quiet_flag) {
+		log_files.clear();
+		log_streams.clear();
+	}
+	log_streams.push_back(&capture_stream);
+	log_cmd_error_throw = true;
+
+	Tcl_Obj *results = Tcl_NewListObj(listc, nullptr);
+
+	for (int j = 0; j < listc; j++)
+	{
+		std::string command = Tcl_GetString(listv[j]);
+		size_t output_begin = capture.buffer.size();
+		int64_t time_begin = PerformanceTimer::query();
+		bool ok = true;
+
+		try {
+			Pass::call(yosys_get_design(), command);
+		} catch (log_cmd_error_exception) {
+			auto design = yosys_get_design();
+			while (design->selection_stack.size() > 1)
+				design->selection_stack.pop_back();
+			log_reset_stack();
+			ok = false;
+		} catch (...) {
+			log_files = backup_log_files;
+			log_streams = backup_log_streams;
+			log_cmd_error_throw = restore_log_cmd_error_throw;
+			log_error("uncaught exception during Yosys command invoked from TCL\n");
+		}
+
+		double seconds = 1e-9 * (PerformanceTimer::query() - time_begin);
+
+		Tcl_Obj *entry = Tcl_NewListObj(8, nullptr);
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj("command", -1));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj(command.data(), command.size()));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj("status", -1));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj(ok ? "ok" : "error", -1));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj("seconds", -1));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewDoubleObj(seconds));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj("output", -1));
+		Tcl_ListObjAppendElement(interp, entry, Tcl_NewStringObj(capture.buffer.data() + output_begin,
+				capture.buffer.size() - output_begin));
+		Tcl_ListObjAppendElement(interp, results, entry);
+
+		if (!ok && !continue_flag)
+			break;
+	}
+
+	log_files = backup_log_files;
+	log_streams = backup_log_streams;
+	log_cmd_error_throw = restore_log_cmd_error_throw;
+
+	Tcl_SetObjResult(interp, results);
+	return TCL_OK;
+}
+
 bool const_to_mp_int(const Const &a, mp_int *b, bool force_signed, bool force_unsigned)
 {
 	if (!a.is_fully_def())
@@ -537,6 +642,7 @@ int yosys_tcl_iterp_init(Tcl_Interp *interp)
 	if (Tcl_Init(interp)!=TCL_OK)
 		log_warning("Tcl_Init() call failed - %s\n",Tcl_ErrnoMsg(Tcl_GetErrno()));
 	Tcl_CreateCommand(interp, "yosys", tcl_yosys_cmd, NULL, NULL);
+	Tcl_CreateObjCommand(interp, "yosys_batch", tcl_yosys_batch, NULL, NULL);
 	Tcl_CreateCommand(interp, "rtlil::get_attr", tcl_get_attr, NULL, NULL);
 	Tcl_CreateCommand(interp, "rtlil::has_attr", tcl_has_attr, NULL, NULL);
 	Tcl_CreateObjCommand(interp, "rtlil::set_attr", tcl_set_attr, NULL, NULL);
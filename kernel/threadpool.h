@@ -0,0 +1,121 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "kernel/rtlil.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+YOSYS_NAMESPACE_BEGIN
+
+// A small fork-join helper for passes whose work items are independent.
+//
+// Workers must not touch shared kernel state: no IdString creation, no
+// logging, and no modification of design objects outside the work item
+// they were handed. Passes are expected to partition their work so each
+// item only mutates its own module (or only reads the design) and to do
+// all logging and design-level bookkeeping on the main thread afterwards.
+// While workers are running, interning or freeing an IdString trips an
+// assertion (see IdString::parallel_section_active), so contract
+// violations fail fast instead of corrupting the global id table.
+//
+// Note that "only reads the design" also rules out copying design-owned
+// Const values: copying a large Const retags the *source* to the shared
+// copy-on-write backing (Const::share_payload()), so even a plain copy
+// mutates shared state. This likewise trips an assertion inside a
+// parallel section; workers should hand indices or pointers to the main
+// thread instead of copying parameter/attribute values.
+//
+// With num_threads <= 1 all items run inline on the calling thread, so
+// serial execution stays the deterministic default.
+struct ThreadPool
+{
+	// Thread count policy: the "threads" scratchpad variable wins, then the
+	// YOSYS_THREADS environment variable, and the default is 1 (serial).
+	static int thread_count(const RTLIL::Design *design)
+	{
+		int threads = design ? design->scratchpad_get_int("threads", 0) : 0;
+		if (threads <= 0)
+			if (const char *env = getenv("YOSYS_THREADS"))
+				threads = atoi(env);
+		if (threads <= 0)
+			threads = 1;
+		return threads;
+	}
+
+	// Run body(0) .. body(num_items-1) on up to num_threads threads. Items are
+	// claimed from a shared atomic counter, so uneven item sizes balance out.
+	// The first exception thrown by any item is rethrown on the calling thread
+	// after all threads have joined.
+	static void run(int num_threads, int num_items, const std::function<void(int)> &body)
+	{
+		if (num_items <= 0)
+			return;
+
+		num_threads = min(num_threads, num_items);
+		if (num_threads <= 1) {
+			for (int i = 0; i < num_items; i++)
+				body(i);
+			return;
+		}
+
+		std::atomic<int> next_item(0);
+		std::atomic<bool> got_exception(false);
+		std::exception_ptr first_exception;
+		std::mutex exception_mutex;
+
+		auto worker = [&]() {
+			while (1) {
+				int item = next_item.fetch_add(1, std::memory_order_relaxed);
+				if (item >= num_items || got_exception.load(std::memory_order_relaxed))
+					return;
+				try {
+					body(item);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(exception_mutex);
+					if (!got_exception.exchange(true))
+						first_exception = std::current_exception();
+					return;
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		RTLIL::IdString::parallel_section_active = true;
+		for (int i = 1; i < num_threads; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto &thread : threads)
+			thread.join();
+		RTLIL::IdString::parallel_section_active = false;
+
+		if (got_exception)
+			std::rethrow_exception(first_exception);
+	}
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
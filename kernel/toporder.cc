@@ -0,0 +1,93 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/toporder.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+struct TopoOrderCacheEntry {
+	Hasher::hash_t fingerprint;
+	TopoOrderInfo info;
+};
+
+static std::map<std::pair<std::string, std::string>, TopoOrderCacheEntry> toporder_cache;
+
+Hasher::hash_t TopoOrderCache::module_fingerprint(RTLIL::Module *module)
+{
+	Hasher h;
+
+	h.eat(GetSize(module->wires_));
+	for (auto wire : module->wires()) {
+		h.eat(wire->name);
+		h.hash32(wire->width);
+		h.hash32((wire->port_input ? 1 : 0) | (wire->port_output ? 2 : 0));
+	}
+
+	h.eat(GetSize(module->cells_));
+	for (auto cell : module->cells()) {
+		h.eat(cell->name);
+		h.eat(cell->type);
+		// whether a cell resolves to a submodule affects how clients like
+		// the sim levelizer classify it
+		h.hash32(module->design != nullptr && module->design->module(cell->type) != nullptr ? 1 : 0);
+		for (auto &conn : cell->connections()) {
+			h.eat(conn.first);
+			h.eat(conn.second);
+		}
+	}
+
+	h.eat(GetSize(module->memories));
+	for (auto &it : module->memories) {
+		h.eat(it.first);
+		h.hash32(it.second->width);
+		h.hash32(it.second->size);
+	}
+
+	// module connections change sigmap aliasing and with it the edges of
+	// every cell graph built on top of it
+	h.eat(GetSize(module->connections()));
+	for (auto &conn : module->connections()) {
+		h.eat(conn.first);
+		h.eat(conn.second);
+	}
+
+	h.eat(GetSize(module->processes));
+
+	return h.yield();
+}
+
+const TopoOrderInfo *TopoOrderCache::lookup(RTLIL::Module *module, const std::string &key)
+{
+	auto it = toporder_cache.find(std::make_pair(module->name.str(), key));
+	if (it == toporder_cache.end())
+		return nullptr;
+	if (it->second.fingerprint != module_fingerprint(module))
+		return nullptr;
+	return &it->second.info;
+}
+
+const TopoOrderInfo *TopoOrderCache::store(RTLIL::Module *module, const std::string &key, TopoOrderInfo info)
+{
+	auto &entry = toporder_cache[std::make_pair(module->name.str(), key)];
+	entry.fingerprint = module_fingerprint(module);
+	entry.info = std::move(info);
+	return &entry.info;
+}
+
+YOSYS_NAMESPACE_END
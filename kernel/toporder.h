@@ -0,0 +1,60 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TOPORDER_H
+#define TOPORDER_H
+
+#include "kernel/rtlil.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// A cached topological order for one module under one graph construction.
+// `order` lists the cell names topologically, `ranks` maps a cell name to
+// its level (all dependencies have strictly smaller ranks; cells on
+// combinational loops keep the rank they were first reached with), `loops`
+// is only filled by clients that run loop analysis. Cell names rather than
+// pointers are stored so a cached entry can never dangle.
+struct TopoOrderInfo {
+	std::vector<RTLIL::IdString> order;
+	dict<RTLIL::IdString, int> ranks;
+	std::vector<std::vector<RTLIL::IdString>> loops;
+};
+
+// Process-lifetime cache of topological orders, shared by torder, the sim
+// levelizer and future schedulers. Entries are keyed by module name plus a
+// client key naming the graph construction (e.g. "torder", "sim") and are
+// validated against a content fingerprint of the module. The RTLIL monitor
+// API does not report cell or wire creation, so invalidation works like the
+// other derived-data caches in this tree (stat, write_smt2, abc9_ops): a
+// cheap linear rescan of the module instead of event tracking.
+struct TopoOrderCache {
+	static Hasher::hash_t module_fingerprint(RTLIL::Module *module);
+
+	// Returns the cached entry for (module, key), or nullptr if there is
+	// none or the module changed since it was stored.
+	static const TopoOrderInfo *lookup(RTLIL::Module *module, const std::string &key);
+
+	// Stores the entry for (module, key), replacing any previous one, and
+	// returns a pointer to the stored copy.
+	static const TopoOrderInfo *store(RTLIL::Module *module, const std::string &key, TopoOrderInfo info);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
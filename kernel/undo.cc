@@ -0,0 +1,238 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/undo.h"
+#include "kernel/log.h"
+#include "backends/rtlil/rtlil_binary.h"
+
+#include <sstream>
+
+YOSYS_NAMESPACE_BEGIN
+
+static std::map<RTLIL::Design*, std::unique_ptr<DesignUndoHistory>> undo_registry;
+
+void DesignUndoHistory::notify_module_add(RTLIL::Module *module)
+{
+	if (!applying)
+		touched.insert(module->name.str());
+}
+
+void DesignUndoHistory::notify_module_del(RTLIL::Module *module)
+{
+	if (!applying)
+		touched.insert(module->name.str());
+}
+
+void DesignUndoHistory::notify_connect(RTLIL::Cell *cell, const RTLIL::IdString&, const RTLIL::SigSpec&, const RTLIL::SigSpec&)
+{
+	if (!applying)
+		touched.insert(cell->module->name.str());
+}
+
+void DesignUndoHistory::notify_connect(RTLIL::Module *module, const RTLIL::SigSig&)
+{
+	if (!applying)
+		touched.insert(module->name.str());
+}
+
+void DesignUndoHistory::notify_connect(RTLIL::Module *module, const std::vector<RTLIL::SigSig>&)
+{
+	if (!applying)
+		touched.insert(module->name.str());
+}
+
+void DesignUndoHistory::notify_blackout(RTLIL::Module *module)
+{
+	if (!applying)
+		touched.insert(module->name.str());
+}
+
+DesignUndoHistory::ModuleCounts DesignUndoHistory::module_counts(RTLIL::Module *module)
+{
+	ModuleCounts counts;
+	counts.wires = GetSize(module->wires_);
+	counts.cells = GetSize(module->cells_);
+	counts.connections = GetSize(module->connections());
+	counts.processes = GetSize(module->processes);
+	counts.memories = GetSize(module->memories);
+	return counts;
+}
+
+std::shared_ptr<const std::string> DesignUndoHistory::serialize_module(RTLIL::Module *module) const
+{
+	std::ostringstream buf;
+	RTLIL::Selection sel(false);
+	sel.select(module);
+	design->selection_stack.push_back(sel);
+	RTLIL_BINARY::dump_design_bin(buf, design, true);
+	design->selection_stack.pop_back();
+	return std::make_shared<const std::string>(buf.str());
+}
+
+void DesignUndoHistory::apply_module_state(const std::string &name, std::shared_ptr<const std::string> blob)
+{
+	RTLIL::IdString id(name);
+	if (blob == nullptr) {
+		if (RTLIL::Module *module = design->module(id))
+			design->remove(module);
+		baseline.erase(name);
+	} else {
+		std::istringstream f(*blob);
+		RTLIL_BINARY::load_design_bin(f, design, false, true, false);
+		baseline[name] = BaselineEntry{blob, module_counts(design->module(id))};
+	}
+}
+
+void DesignUndoHistory::commit_command(const std::string &command)
+{
+	if (applying)
+		return;
+
+	// candidates: monitor-touched modules plus modules whose object counts
+	// changed (catches the wire/cell creation the monitor API cannot see)
+	// plus baseline modules that disappeared
+	pool<std::string> candidates;
+	candidates.swap(touched);
+	for (auto module : design->modules()) {
+		auto it = baseline.find(module->name.str());
+		if (it == baseline.end() || it->second.counts != module_counts(module))
+			candidates.insert(module->name.str());
+	}
+	for (auto &it : baseline)
+		if (design->module(RTLIL::IdString(it.first)) == nullptr)
+			candidates.insert(it.first);
+
+	UndoRecord record;
+	record.command = command;
+
+	for (auto &name : candidates) {
+		RTLIL::Module *module = design->module(RTLIL::IdString(name));
+		auto it = baseline.find(name);
+		std::shared_ptr<const std::string> old_blob = it != baseline.end() ? it->second.blob : nullptr;
+		std::shared_ptr<const std::string> new_blob = module ? serialize_module(module) : nullptr;
+		if (old_blob == nullptr && new_blob == nullptr)
+			continue;
+		// false positive, e.g. a connection rewritten to the same signal
+		if (old_blob != nullptr && new_blob != nullptr && *old_blob == *new_blob)
+			continue;
+		record.modules[name] = std::make_pair(old_blob, new_blob);
+		if (module != nullptr)
+			baseline[name] = BaselineEntry{new_blob, module_counts(module)};
+		else
+			baseline.erase(name);
+	}
+
+	if (record.modules.empty())
+		return;
+
+	redo_stack.clear();
+	undo_stack.push_back(std::move(record));
+	if (GetSize(undo_stack) > max_depth)
+		undo_stack.erase(undo_stack.begin(), undo_stack.end() - max_depth);
+}
+
+bool DesignUndoHistory::undo(std::string &last_command)
+{
+	if (undo_stack.empty())
+		return false;
+
+	UndoRecord record = std::move(undo_stack.back());
+	undo_stack.pop_back();
+
+	applying = true;
+	for (auto &it : record.modules)
+		apply_module_state(it.first, it.second.first);
+	applying = false;
+	touched.clear();
+
+	last_command = record.command;
+	redo_stack.push_back(std::move(record));
+	return true;
+}
+
+bool DesignUndoHistory::redo(std::string &last_command)
+{
+	if (redo_stack.empty())
+		return false;
+
+	UndoRecord record = std::move(redo_stack.back());
+	redo_stack.pop_back();
+
+	applying = true;
+	for (auto &it : record.modules)
+		apply_module_state(it.first, it.second.second);
+	applying = false;
+	touched.clear();
+
+	last_command = record.command;
+	undo_stack.push_back(std::move(record));
+	return true;
+}
+
+size_t DesignUndoHistory::memory_bytes() const
+{
+	// blobs are shared between the baseline and adjacent records; count
+	// every payload once
+	pool<const std::string*> seen;
+	size_t total = 0;
+	auto count = [&](const std::shared_ptr<const std::string> &blob) {
+		if (blob != nullptr && seen.insert(blob.get()).second)
+			total += blob->size();
+	};
+	for (auto &it : baseline)
+		count(it.second.blob);
+	for (auto &record : undo_stack)
+		for (auto &it : record.modules)
+			count(it.second.first), count(it.second.second);
+	for (auto &record : redo_stack)
+		for (auto &it : record.modules)
+			count(it.second.first), count(it.second.second);
+	return total;
+}
+
+DesignUndoHistory *DesignUndoHistory::get(RTLIL::Design *design)
+{
+	auto it = undo_registry.find(design);
+	return it == undo_registry.end() ? nullptr : it->second.get();
+}
+
+DesignUndoHistory *DesignUndoHistory::start(RTLIL::Design *design)
+{
+	DesignUndoHistory *history = get(design);
+	if (history == nullptr) {
+		history = new DesignUndoHistory;
+		history->design = design;
+		undo_registry[design].reset(history);
+		design->monitors.insert(history);
+		for (auto module : design->modules())
+			history->baseline[module->name.str()] = BaselineEntry{history->serialize_module(module), module_counts(module)};
+	}
+	return history;
+}
+
+void DesignUndoHistory::stop(RTLIL::Design *design)
+{
+	DesignUndoHistory *history = get(design);
+	if (history != nullptr) {
+		design->monitors.erase(history);
+		undo_registry.erase(design);
+	}
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,107 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef UNDO_H
+#define UNDO_H
+
+#include "kernel/rtlil.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Opt-in undo/redo history for interactive sessions (see the 'undo' and
+// 'redo' commands). While attached to a design it listens to the same
+// RTLIL::Monitor events the change journal uses to find the modules a
+// command touched, and keeps one compact reverse delta per top-level
+// command: the binary RTLIL blobs of just the changed modules before and
+// after the command. Undoing a command swaps the old blobs back in. Memory
+// is bounded by keeping at most max_depth deltas plus one serialized
+// baseline of the current design state.
+//
+// The monitor API does not see wire or cell creation/deletion, so modules
+// are additionally re-checked with a cheap object-count fingerprint.
+// Attribute- or parameter-only edits that change no counts and raise no
+// monitor events escape both nets; commands doing only that cannot be
+// undone (the same blind spot kernel/journal.h documents).
+struct DesignUndoHistory : RTLIL::Monitor
+{
+	struct ModuleCounts {
+		int wires, cells, connections, processes, memories;
+		bool operator==(const ModuleCounts &other) const {
+			return wires == other.wires && cells == other.cells && connections == other.connections &&
+					processes == other.processes && memories == other.memories;
+		}
+		bool operator!=(const ModuleCounts &other) const { return !(*this == other); }
+	};
+
+	struct BaselineEntry {
+		std::shared_ptr<const std::string> blob;
+		ModuleCounts counts;
+	};
+
+	// one reverse delta: per changed module the serialized state before and
+	// after the command (a null blob means the module did not exist)
+	struct UndoRecord {
+		std::string command;
+		std::map<std::string, std::pair<std::shared_ptr<const std::string>, std::shared_ptr<const std::string>>> modules;
+	};
+
+	RTLIL::Design *design;
+	pool<std::string> touched;
+	bool applying = false;
+	int max_depth = 20;
+	std::map<std::string, BaselineEntry> baseline;
+	std::vector<UndoRecord> undo_stack, redo_stack;
+
+	void notify_module_add(RTLIL::Module *module) override;
+	void notify_module_del(RTLIL::Module *module) override;
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec &old_sig, const RTLIL::SigSpec &sig) override;
+	void notify_connect(RTLIL::Module *module, const RTLIL::SigSig &sigsig) override;
+	void notify_connect(RTLIL::Module *module, const std::vector<RTLIL::SigSig> &sigsig_vec) override;
+	void notify_blackout(RTLIL::Module *module) override;
+
+	// Fired by Pass::call() after every completed top-level command; creates
+	// the reverse delta for the command and advances the baseline.
+	void commit_command(const std::string &command);
+
+	// Swap one recorded delta in or out. Return false when the respective
+	// stack is empty; otherwise the name of the reverted command is stored
+	// in the last_command output argument.
+	bool undo(std::string &last_command);
+	bool redo(std::string &last_command);
+
+	// total size of the stored blobs, for the -status report
+	size_t memory_bytes() const;
+
+	// Per-design registry, following the DesignJournal pattern. start()
+	// attaches a history and serializes the baseline (idempotent), stop()
+	// detaches it and discards all recorded state, get() returns the
+	// attached history or nullptr.
+	static DesignUndoHistory *get(RTLIL::Design *design);
+	static DesignUndoHistory *start(RTLIL::Design *design);
+	static void stop(RTLIL::Design *design);
+
+private:
+	std::shared_ptr<const std::string> serialize_module(RTLIL::Module *module) const;
+	void apply_module_state(const std::string &name, std::shared_ptr<const std::string> blob);
+	static ModuleCounts module_counts(RTLIL::Module *module);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/xanalysis.h"
+#include "kernel/ff.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+void MaybeXAnalysis::setup(RTLIL::Module *module_, ModWalker *modwalker_, FfInitVals *initvals_, bool assume_def_inputs)
+{
+	module = module_;
+	modwalker = modwalker_;
+	initvals = initvals_;
+
+	mask.setup(module);
+	pending_cells.clear();
+	pending_cell_queue.clear();
+
+	for (auto cell : module->cells()) {
+		pending_cells.insert(cell);
+		pending_cell_queue.push_back(cell);
+	}
+
+	if (!assume_def_inputs) {
+		for (auto port : module->ports) {
+			auto wire = module->wire(port);
+			if (wire->port_input)
+				mark(SigSpec(wire));
+		}
+	}
+}
+
+void MaybeXAnalysis::run()
+{
+	while (!pending_cell_queue.empty()) {
+		Cell *cell = pending_cell_queue.front();
+		pending_cell_queue.pop_front();
+		pending_cells.erase(cell);
+
+		process_cell(cell);
+	}
+}
+
+void MaybeXAnalysis::gather(const RTLIL::SigSpec &sig, std::vector<uint64_t> &buf, int width, bool is_signed) const
+{
+	buf.assign((width + 63) / 64, 0);
+
+	SigSpec mapped = modwalker->sigmap(sig);
+	int pos = 0;
+
+	for (auto &chunk : mapped.chunks()) {
+		if (pos >= width)
+			break;
+		if (chunk.wire == nullptr) {
+			for (int i = 0; i < chunk.width && pos + i < width; i++)
+				if (chunk.data[i] == State::Sx)
+					buf[(pos + i) >> 6] |= uint64_t(1) << ((pos + i) & 63);
+		} else {
+			int src = mask.offsets.at(chunk.wire) + chunk.offset;
+			int copy_width = std::min(chunk.width, width - pos);
+			for (int i = 0; i < copy_width; i += 64) {
+				uint64_t value = mask.read_word(src + i);
+				int n = std::min(copy_width - i, 64);
+				if (n < 64)
+					value &= (uint64_t(1) << n) - 1;
+				buf[(pos + i) >> 6] |= value << ((pos + i) & 63);
+				if (((pos + i) & 63) != 0 && ((pos + i) & 63) + n > 64)
+					buf[((pos + i) >> 6) + 1] |= value >> (64 - ((pos + i) & 63));
+			}
+		}
+		pos += chunk.width;
+	}
+
+	// extend_u0 semantics: signed signals replicate their top bit
+	if (is_signed && GetSize(mapped) > 0 && GetSize(mapped) < width) {
+		int top = GetSize(mapped) - 1;
+		if ((buf[top >> 6] >> (top & 63)) & 1)
+			for (int i = GetSize(mapped); i < width; i++)
+				buf[i >> 6] |= uint64_t(1) << (i & 63);
+	}
+}
+
+void MaybeXAnalysis::enqueue_consumers(RTLIL::SigBit bit)
+{
+	auto it = modwalker->signal_consumers.find(bit);
+	if (it == modwalker->signal_consumers.end())
+		return;
+	for (auto &consumer : it->second)
+		if (pending_cells.insert(consumer.cell).second)
+			pending_cell_queue.push_back(consumer.cell);
+}
+
+void MaybeXAnalysis::scatter(const RTLIL::SigSpec &sig, const std::vector<uint64_t> &buf)
+{
+	SigSpec mapped = modwalker->sigmap(sig);
+	int pos = 0;
+
+	for (auto &chunk : mapped.chunks()) {
+		if (chunk.wire != nullptr) {
+			int dst = mask.offsets.at(chunk.wire) + chunk.offset;
+			for (int i = 0; i < chunk.width; i += 64) {
+				int n = std::min(chunk.width - i, 64);
+				uint64_t value = buf[(pos + i) >> 6] >> ((pos + i) & 63);
+				if (((pos + i) & 63) != 0 && ((pos + i) & 63) + n > 64)
+					value |= buf[((pos + i) >> 6) + 1] << (64 - ((pos + i) & 63));
+				uint64_t fresh = mask.or_word(dst + i, value, n);
+				while (fresh != 0) {
+					int b = __builtin_ctzll(fresh);
+					fresh &= fresh - 1;
+					enqueue_consumers(SigBit(chunk.wire, chunk.offset + i + b));
+				}
+			}
+		}
+		pos += chunk.width;
+	}
+}
+
+void MaybeXAnalysis::mark(const RTLIL::SigSpec &sig)
+{
+	std::vector<uint64_t> buf((GetSize(sig) + 63) / 64, ~uint64_t(0));
+	scatter(sig, buf);
+}
+
+void MaybeXAnalysis::mark_outputs(RTLIL::Cell *cell)
+{
+	for (auto &conn : cell->connections())
+		if (cell->output(conn.first))
+			mark(conn.second);
+}
+
+bool MaybeXAnalysis::inputs_maybe_x(RTLIL::Cell *cell) const
+{
+	for (auto &conn : cell->connections())
+		if (cell->input(conn.first) && maybe_x(conn.second))
+			return true;
+	return false;
+}
+
+// The rules below mirror the per-cell maybe-x marking of the xprop pass,
+// with the per-bit loops replaced by word-wise operations on packed masks.
+void MaybeXAnalysis::process_cell(RTLIL::Cell *cell)
+{
+	if (cell->type.in(ID($bweqx), ID($eqx), ID($nex), ID($initstate), ID($assert), ID($assume), ID($cover), ID($anyseq), ID($anyconst)))
+		return;
+
+	if (cell->type.in(ID($pmux))) {
+		mark_outputs(cell);
+		return;
+	}
+
+	if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit)) {
+		FfData ff(initvals, cell);
+
+		std::vector<uint64_t> buf;
+		gather(ff.sig_d, buf, ff.width);
+
+		if (cell->type != ID($anyinit))
+			for (int i = 0; i < ff.width; i++)
+				if (ff.val_init[i] == State::Sx)
+					buf[i >> 6] |= uint64_t(1) << (i & 63);
+
+		scatter(ff.sig_q, buf);
+
+		if ((ff.has_clk || ff.has_gclk) && !ff.has_ce && !ff.has_aload && !ff.has_srst && !ff.has_arst && !ff.has_sr)
+			return;
+	}
+
+	if (cell->type == ID($not)) {
+		auto &sig_y = cell->getPort(ID::Y);
+		std::vector<uint64_t> buf;
+		gather(cell->getPort(ID::A), buf, GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
+		scatter(sig_y, buf);
+		return;
+	}
+
+	if (cell->type.in(ID($and), ID($or), ID($xor), ID($xnor))) {
+		auto &sig_y = cell->getPort(ID::Y);
+		std::vector<uint64_t> buf_a, buf_b;
+		gather(cell->getPort(ID::A), buf_a, GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
+		gather(cell->getPort(ID::B), buf_b, GetSize(sig_y), cell->getParam(ID::B_SIGNED).as_bool());
+		for (int i = 0; i < GetSize(buf_a); i++)
+			buf_a[i] |= buf_b[i];
+		scatter(sig_y, buf_a);
+		return;
+	}
+
+	if (cell->type.in(ID($bwmux))) {
+		auto &sig_y = cell->getPort(ID::Y);
+		std::vector<uint64_t> buf_a, buf_b, buf_s;
+		gather(cell->getPort(ID::A), buf_a, GetSize(sig_y));
+		gather(cell->getPort(ID::B), buf_b, GetSize(sig_y));
+		gather(cell->getPort(ID::S), buf_s, GetSize(sig_y));
+		for (int i = 0; i < GetSize(buf_a); i++)
+			buf_a[i] |= buf_b[i] | buf_s[i];
+		scatter(sig_y, buf_a);
+		return;
+	}
+
+	if (cell->type.in(ID($_MUX_), ID($mux), ID($bmux))) {
+		auto &sig_y = cell->getPort(ID::Y);
+		auto &sig_b = cell->getPort(ID::B);
+		if (maybe_x(cell->getPort(ID::S))) {
+			mark(sig_y);
+			return;
+		}
+		int width = GetSize(sig_y);
+		std::vector<uint64_t> buf, buf_b;
+		gather(cell->getPort(ID::A), buf, width);
+		gather(sig_b, buf_b, GetSize(sig_b));
+		for (int j = 0; j < GetSize(sig_b); j += width)
+			for (int i = 0; i < width; i++)
+				if ((buf_b[(j + i) >> 6] >> ((j + i) & 63)) & 1)
+					buf[i >> 6] |= uint64_t(1) << (i & 63);
+		scatter(sig_y, buf);
+		return;
+	}
+
+	if (cell->type.in(ID($demux))) {
+		auto &sig_y = cell->getPort(ID::Y);
+		auto &sig_a = cell->getPort(ID::A);
+		if (maybe_x(cell->getPort(ID::S))) {
+			mark(sig_y);
+			return;
+		}
+		int width = GetSize(sig_a);
+		std::vector<uint64_t> buf_a, buf((GetSize(sig_y) + 63) / 64, 0);
+		gather(sig_a, buf_a, width);
+		for (int j = 0; j < GetSize(sig_y); j += width)
+			for (int i = 0; i < width; i++)
+				if ((buf_a[i >> 6] >> (i & 63)) & 1)
+					buf[(j + i) >> 6] |= uint64_t(1) << ((j + i) & 63);
+		scatter(sig_y, buf);
+		return;
+	}
+
+	if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr), ID($shift))) {
+		// We could be more precise for shifts, but that's not required
+		// for correctness, so let's keep it simple
+		if (maybe_x(cell->getPort(ID::B)) || maybe_x(cell->getPort(ID::A)))
+			mark(cell->getPort(ID::Y));
+		return;
+	}
+
+	if (cell->type.in(ID($shiftx))) {
+		auto &sig_b = cell->getPort(ID::B);
+		auto &sig_y = cell->getPort(ID::Y);
+		auto &sig_a = cell->getPort(ID::A);
+
+		if (cell->getParam(ID::B_SIGNED).as_bool() || GetSize(sig_b) >= 30) {
+			mark(sig_y);
+		} else {
+			int max_shift = (1 << GetSize(sig_b)) - 1;
+			std::vector<uint64_t> buf((GetSize(sig_y) + 63) / 64, 0);
+			for (int i = 0; i < GetSize(sig_y); i++)
+				if (i + max_shift >= GetSize(sig_a))
+					buf[i >> 6] |= uint64_t(1) << (i & 63);
+			scatter(sig_y, buf);
+		}
+
+		if (maybe_x(sig_b) || maybe_x(sig_a))
+			mark(sig_y);
+		return;
+	}
+
+	if (cell->type.in(ID($add), ID($sub), ID($mul), ID($neg))) {
+		if (inputs_maybe_x(cell))
+			mark_outputs(cell);
+		return;
+	}
+
+	if (cell->type.in(ID($div), ID($mod), ID($divfloor), ID($modfloor))) {
+		mark_outputs(cell);
+		return;
+	}
+
+	if (cell->type.in(
+		ID($le), ID($lt), ID($ge), ID($gt),
+		ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor),
+		ID($reduce_bool), ID($logic_not), ID($logic_or), ID($logic_and),
+		ID($eq), ID($ne),
+
+		ID($_NOT_), ID($_AND_), ID($_NAND_), ID($_ANDNOT_), ID($_OR_), ID($_NOR_), ID($_ORNOT_), ID($_XOR_), ID($_XNOR_)
+	)) {
+		auto &sig_y = cell->getPort(ID::Y);
+		if (inputs_maybe_x(cell))
+			mark(sig_y[0]);
+		return;
+	}
+
+	log_warning("Unhandled cell %s (%s) during maybe-x marking\n", log_id(cell), log_id(cell->type));
+	mark_outputs(cell);
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,231 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef XANALYSIS_H
+#define XANALYSIS_H
+
+#include "kernel/yosys.h"
+#include "kernel/ffinit.h"
+#include "kernel/modtools.h"
+#include <deque>
+
+YOSYS_NAMESPACE_BEGIN
+
+// A bit mask over all wire bits of a module, packed 64 bits per word so
+// that whole SigSpecs can be set, cleared and tested with word-wise
+// operations instead of per-bit pool/dict lookups. Callers are expected
+// to canonicalize signals through their SigMap before passing them in;
+// non-wire bits are ignored by the SigSpec operations.
+struct BitMaskMap
+{
+	dict<RTLIL::Wire*, int> offsets;
+	std::vector<uint64_t> words;
+	int num_bits = 0;
+
+	void setup(RTLIL::Module *module)
+	{
+		offsets.clear();
+		num_bits = 0;
+		for (auto wire : module->wires()) {
+			offsets.emplace(wire, num_bits);
+			num_bits += wire->width;
+		}
+		words.assign((num_bits + 63) / 64, 0);
+	}
+
+	// Read up to 64 bits starting at the given absolute bit position.
+	uint64_t read_word(int pos) const
+	{
+		int w = pos >> 6, s = pos & 63;
+		uint64_t value = words[w] >> s;
+		if (s != 0 && w + 1 < GetSize(words))
+			value |= words[w + 1] << (64 - s);
+		return value;
+	}
+
+	// OR up to 64 bits into the mask at the given absolute bit position,
+	// returning the mask of bits that were newly set.
+	uint64_t or_word(int pos, uint64_t value, int width)
+	{
+		if (width < 64)
+			value &= (uint64_t(1) << width) - 1;
+		int w = pos >> 6, s = pos & 63;
+		uint64_t old_lo = words[w];
+		words[w] |= value << s;
+		uint64_t fresh = (words[w] ^ old_lo) >> s;
+		if (s != 0 && s + width > 64) {
+			uint64_t old_hi = words[w + 1];
+			words[w + 1] |= value >> (64 - s);
+			fresh |= (words[w + 1] ^ old_hi) << (64 - s);
+		}
+		return fresh;
+	}
+
+	// Clear up to 64 bits at the given absolute bit position.
+	void clear_word(int pos, uint64_t value, int width)
+	{
+		if (width < 64)
+			value &= (uint64_t(1) << width) - 1;
+		int w = pos >> 6, s = pos & 63;
+		words[w] &= ~(value << s);
+		if (s != 0 && s + width > 64)
+			words[w + 1] &= ~(value >> (64 - s));
+	}
+
+	bool get(RTLIL::SigBit bit) const
+	{
+		if (bit.wire == nullptr)
+			return false;
+		auto it = offsets.find(bit.wire);
+		if (it == offsets.end())
+			return false;
+		return (words[(it->second + bit.offset) >> 6] >> ((it->second + bit.offset) & 63)) & 1;
+	}
+
+	void set(const RTLIL::SigSpec &sig)
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int pos = offsets.at(chunk.wire) + chunk.offset;
+			for (int i = 0; i < chunk.width; i += 64)
+				or_word(pos + i, ~uint64_t(0), std::min(chunk.width - i, 64));
+		}
+	}
+
+	void clear(const RTLIL::SigSpec &sig)
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int pos = offsets.at(chunk.wire) + chunk.offset;
+			for (int i = 0; i < chunk.width; i += 64)
+				clear_word(pos + i, ~uint64_t(0), std::min(chunk.width - i, 64));
+		}
+	}
+
+	// Remove all bits set in the other mask (which must be set up on the
+	// same module).
+	void subtract(const BitMaskMap &other)
+	{
+		log_assert(GetSize(words) == GetSize(other.words));
+		for (int i = 0; i < GetSize(words); i++)
+			words[i] &= ~other.words[i];
+	}
+
+	// Export all set bits as a SigSpec, with adjacent bits of the same
+	// wire merged into chunks.
+	RTLIL::SigSpec export_bits() const
+	{
+		RTLIL::SigSpec sig;
+		for (auto &it : offsets) {
+			RTLIL::Wire *wire = it.first;
+			for (int cursor = 0; cursor < wire->width; cursor += 64) {
+				int width = std::min(wire->width - cursor, 64);
+				uint64_t value = read_word(it.second + cursor);
+				if (width < 64)
+					value &= (uint64_t(1) << width) - 1;
+				while (value != 0) {
+					int b = __builtin_ctzll(value);
+					value &= value - 1;
+					sig.append(RTLIL::SigBit(wire, cursor + b));
+				}
+			}
+		}
+		return sig;
+	}
+
+	bool any(const RTLIL::SigSpec &sig) const
+	{
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr)
+				continue;
+			int pos = offsets.at(chunk.wire) + chunk.offset;
+			for (int i = 0; i < chunk.width; i += 64) {
+				int width = std::min(chunk.width - i, 64);
+				uint64_t value = read_word(pos + i);
+				if (width < 64)
+					value &= (uint64_t(1) << width) - 1;
+				if (value != 0)
+					return true;
+			}
+		}
+		return false;
+	}
+};
+
+// Bit-parallel maybe-x dataflow analysis. Starting from x constants,
+// x init values and (optionally) the input ports, x-ness is propagated
+// through the cells of a module with word-wise transfer functions until a
+// fixpoint is reached. The transfer functions match the per-cell marking
+// rules of the xprop pass; unhandled cell types conservatively mark all
+// their outputs.
+struct MaybeXAnalysis
+{
+	ModWalker *modwalker = nullptr;
+	FfInitVals *initvals = nullptr;
+	RTLIL::Module *module = nullptr;
+
+	BitMaskMap mask;
+
+	pool<RTLIL::Cell*> pending_cells;
+	std::deque<RTLIL::Cell*> pending_cell_queue;
+
+	// When assume_def_inputs is set the input ports are not used as x
+	// sources. The ModWalker must already be set up on the module and the
+	// FfInitVals instance on the same SigMap.
+	void setup(RTLIL::Module *module, ModWalker *modwalker, FfInitVals *initvals, bool assume_def_inputs);
+
+	// Run the dataflow to its fixpoint. Must be called before maybe_x().
+	void run();
+
+	bool maybe_x(RTLIL::SigBit bit) const
+	{
+		if (bit.wire == nullptr)
+			return bit == RTLIL::State::Sx;
+		return mask.get(modwalker->sigmap(bit));
+	}
+
+	bool maybe_x(const RTLIL::SigSpec &sig) const
+	{
+		for (auto bit : sig)
+			if (maybe_x(bit))
+				return true;
+		return false;
+	}
+
+private:
+	// Gather the maybe-x bits of a signal into a packed buffer of the
+	// given width, applying extend_u0 semantics for the padding bits.
+	void gather(const RTLIL::SigSpec &sig, std::vector<uint64_t> &buf, int width, bool is_signed = false) const;
+
+	// OR a packed buffer into the mask bits of a signal, scheduling the
+	// consumers of all newly set bits.
+	void scatter(const RTLIL::SigSpec &sig, const std::vector<uint64_t> &buf);
+
+	void mark(const RTLIL::SigSpec &sig);
+	void mark_outputs(RTLIL::Cell *cell);
+	bool inputs_maybe_x(RTLIL::Cell *cell) const;
+	void enqueue_consumers(RTLIL::SigBit bit);
+	void process_cell(RTLIL::Cell *cell);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
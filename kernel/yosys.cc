@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
+#include "kernel/fileprefetch.h"
 
 #ifdef YOSYS_ENABLE_READLINE
 #  include <readline/readline.h>
@@ -292,6 +293,60 @@ bool patmatch(const char *pattern, const char *string)
 	return false;
 }
 
+PatternMatcher::PatternMatcher(const std::string &pattern) : pattern_(pattern)
+{
+	// `?', `[' and `\' need the full matcher. With only `*' wildcards the
+	// pattern can be classified by where the stars sit.
+	if (pattern.find_first_of("?[\\") != std::string::npos) {
+		kind_ = KIND_GENERIC;
+		return;
+	}
+
+	size_t first_star = pattern.find('*');
+	size_t last_star = pattern.rfind('*');
+
+	if (first_star == std::string::npos) {
+		kind_ = KIND_LITERAL;
+		literal_ = pattern;
+	} else if (first_star == last_star && first_star == pattern.size()-1) {
+		kind_ = pattern.size() == 1 ? KIND_ANY : KIND_PREFIX;
+		literal_ = pattern.substr(0, pattern.size()-1);
+	} else if (first_star == last_star && first_star == 0) {
+		kind_ = KIND_SUFFIX;
+		literal_ = pattern.substr(1);
+	} else if (first_star == 0 && last_star == pattern.size()-1 &&
+			pattern.find('*', 1) == last_star) {
+		// note that plain "**" is not equivalent to "*": it does not
+		// match the empty string, so it takes the generic path
+		kind_ = pattern.size() == 2 ? KIND_GENERIC : KIND_SUBSTRING;
+		literal_ = pattern.substr(1, pattern.size()-2);
+	} else {
+		kind_ = KIND_GENERIC;
+	}
+}
+
+bool PatternMatcher::match(const char *string) const
+{
+	size_t len;
+	switch (kind_)
+	{
+	case KIND_ANY:
+		return true;
+	case KIND_LITERAL:
+		return literal_ == string;
+	case KIND_PREFIX:
+		return strncmp(literal_.c_str(), string, literal_.size()) == 0;
+	case KIND_SUFFIX:
+		len = strlen(string);
+		return len >= literal_.size() && memcmp(string + len - literal_.size(), literal_.c_str(), literal_.size()) == 0;
+	case KIND_SUBSTRING:
+		return strstr(string, literal_.c_str()) != nullptr;
+	case KIND_GENERIC:
+		break;
+	}
+	return patmatch(pattern_.c_str(), string);
+}
+
 #if !defined(YOSYS_DISABLE_SPAWN)
 int run_command(const std::string &command, std::function<void(const std::string&)> process_line)
 {
@@ -589,6 +644,11 @@ void yosys_shutdown()
 	already_shutdown = true;
 	log_pop();
 
+	FilePrefetcher::join_all();
+
+	if (log_async)
+		log_async_end();
+
 	Pass::done_register();
 
 	delete yosys_design;
@@ -1045,6 +1105,8 @@ bool run_frontend(std::string filename, std::string command, RTLIL::Design *desi
 
 	  if (has_extension(filename_trim, ".gz")) {
 	    filename_trim.erase(filename_trim.size() - 3);
+	  } else if (has_extension(filename_trim, ".zst")) {
+	    filename_trim.erase(filename_trim.size() - 4);
 	  }
 
 	  if (has_extension(filename_trim, ".v")) {
@@ -86,13 +86,24 @@ extern const char *yosys_version_str;
 extern std::map<std::string, RTLIL::Design*> saved_designs;
 extern std::vector<RTLIL::Design*> pushed_designs;
 
+// spill all named saved designs to on-disk checkpoints and free their
+// in-memory copies; they are transparently restored on the next access via
+// the 'design' command. Returns the number of designs spilled. Used by the
+// memory budget check in Pass::call. (from passes/cmds/design.cc)
+int spill_saved_designs();
+
 // from passes/cmds/pluginc.cc
 extern std::map<std::string, void*> loaded_plugins;
 #ifdef WITH_PYTHON
 extern std::map<std::string, void*> loaded_python_plugins;
 #endif
 extern std::map<std::string, std::string> loaded_plugin_aliases;
+// pass name -> plugin filename, registered from a plugin manifest; the
+// plugin is loaded on first use of one of its pass names
+extern std::map<std::string, std::string> lazy_plugins;
 void load_plugin(std::string filename, std::vector<std::string> aliases);
+void register_plugin_manifest(std::string filename);
+bool load_lazy_plugin(const std::string &pass_name);
 
 extern std::string yosys_share_dirname;
 extern std::string yosys_abc_executable;
@@ -306,6 +306,24 @@ int readsome(std::istream &f, char *s, int n);
 std::string next_token(std::string &text, const char *sep = " \t\r\n", bool long_strings = false);
 std::vector<std::string> split_tokens(const std::string &text, const char *sep = " \t\r\n");
 bool patmatch(const char *pattern, const char *string);
+
+// Compiled form of a patmatch() pattern. Analyzing the pattern once up front
+// lets the common shapes -- plain literals and single-`*` prefix, suffix and
+// substring patterns -- be matched with memcmp/strstr instead of the recursive
+// matcher, which matters when one pattern is tested against millions of
+// object names (see match_ids() in passes/cmds/select.cc).
+struct PatternMatcher
+{
+	explicit PatternMatcher(const std::string &pattern);
+	bool match(const char *string) const;
+	bool match(const std::string &string) const { return match(string.c_str()); }
+	const std::string &pattern() const { return pattern_; }
+
+private:
+	enum kind_t { KIND_ANY, KIND_LITERAL, KIND_PREFIX, KIND_SUFFIX, KIND_SUBSTRING, KIND_GENERIC };
+	kind_t kind_;
+	std::string pattern_, literal_;
+};
 #if !defined(YOSYS_DISABLE_SPAWN)
 int run_command(const std::string &command, std::function<void(const std::string&)> process_line = std::function<void(const std::string&)>());
 #endif
@@ -30,6 +30,8 @@
 #include <limits.h>
 #include <stdint.h>
 #include <cinttypes>
+#include <atomic>
+#include <thread>
 
 #if !defined(_WIN32) && !defined(__wasm)
 #  include <csignal>
@@ -51,16 +53,31 @@ ezMiniSAT::ezMiniSAT() : minisatSolver(NULL)
 
 ezMiniSAT::~ezMiniSAT()
 {
-	if (minisatSolver != NULL)
-		delete minisatSolver;
+	deleteSolvers();
 }
 
-void ezMiniSAT::clear()
+void ezMiniSAT::deleteSolvers()
 {
 	if (minisatSolver != NULL) {
 		delete minisatSolver;
 		minisatSolver = NULL;
 	}
+	for (auto solver : portfolioSolvers)
+		delete solver;
+	portfolioSolvers.clear();
+}
+
+void ezMiniSAT::interruptAllSolvers()
+{
+	if (minisatSolver != NULL)
+		minisatSolver->interrupt();
+	for (auto solver : portfolioSolvers)
+		solver->interrupt();
+}
+
+void ezMiniSAT::clear()
+{
+	deleteSolvers();
 	foundContradiction = false;
 	minisatVars.clear();
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
@@ -92,7 +109,7 @@ clock_t ezMiniSAT::alarmHandlerTimeout = 0;
 void ezMiniSAT::alarmHandler(int)
 {
 	if (clock() > alarmHandlerTimeout) {
-		alarmHandlerThis->minisatSolver->interrupt();
+		alarmHandlerThis->interruptAllSolvers();
 		alarmHandlerTimeout = 0;
 	} else
 		alarm(1);
@@ -107,8 +124,7 @@ bool ezMiniSAT::solver(const std::vector<int> &modelExpressions, std::vector<boo
 
 	if (0) {
 contradiction:
-		delete minisatSolver;
-		minisatSolver = NULL;
+		deleteSolvers();
 		minisatVars.clear();
 		foundContradiction = true;
 		return false;
@@ -129,6 +145,15 @@ contradiction:
 	if (minisatSolver == NULL) {
 		minisatSolver = new Solver;
 		minisatSolver->verbosity = EZMINISAT_VERBOSITY;
+		// portfolio mode: extra diversified solver instances race the main
+		// solver on every query, the first definite answer wins
+		for (int i = 1; i < solverThreads; i++) {
+			Solver *solver = new Solver;
+			solver->verbosity = EZMINISAT_VERBOSITY;
+			solver->random_seed = 91648253 ^ (2654435761u * i);
+			solver->rnd_init_act = (i % 2) == 1;
+			portfolioSolvers.push_back(solver);
+		}
 	}
 
 #if EZMINISAT_INCREMENTAL
@@ -138,12 +163,18 @@ contradiction:
 	const std::vector<std::vector<int>> &cnf = this->cnf();
 #endif
 
-	while (int(minisatVars.size()) < numCnfVariables())
+	while (int(minisatVars.size()) < numCnfVariables()) {
 		minisatVars.push_back(minisatSolver->newVar());
+		for (auto solver : portfolioSolvers)
+			solver->newVar();
+	}
 
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
-	for (auto idx : cnfFrozenVars)
+	for (auto idx : cnfFrozenVars) {
 		minisatSolver->setFrozen(minisatVars.at(idx > 0 ? idx-1 : -idx-1), true);
+		for (auto solver : portfolioSolvers)
+			solver->setFrozen(minisatVars.at(idx > 0 ? idx-1 : -idx-1), true);
+	}
 	cnfFrozenVars.clear();
 #endif
 
@@ -164,10 +195,18 @@ contradiction:
 		}
 		if (!minisatSolver->addClause(ps))
 			goto contradiction;
+		for (auto solver : portfolioSolvers)
+			if (!solver->addClause(ps))
+				goto contradiction;
 	}
 
-	if (cnf.size() > 0 && !minisatSolver->simplify())
-		goto contradiction;
+	if (cnf.size() > 0) {
+		if (!minisatSolver->simplify())
+			goto contradiction;
+		for (auto solver : portfolioSolvers)
+			if (!solver->simplify())
+				goto contradiction;
+	}
 
 	Minisat::vec<Minisat::Lit> assumps;
 
@@ -201,7 +240,56 @@ contradiction:
 	}
 #endif
 
-	bool foundSolution = minisatSolver->solve(assumps);
+	bool foundSolution;
+	Solver *modelSolver = minisatSolver;
+
+	if (portfolioSolvers.empty()) {
+		foundSolution = minisatSolver->solve(assumps);
+	} else {
+		std::vector<Solver*> allSolvers;
+		allSolvers.push_back(minisatSolver);
+		allSolvers.insert(allSolvers.end(), portfolioSolvers.begin(), portfolioSolvers.end());
+
+		std::atomic<int> winner(-1);
+		std::vector<char> results(allSolvers.size(), 0);
+		std::vector<std::thread> threads;
+
+		for (size_t i = 0; i < allSolvers.size(); i++)
+			threads.emplace_back([&, i]() {
+				using namespace Minisat;
+				Minisat::vec<Minisat::Lit> thread_assumps;
+				for (auto idx : extraClauses) {
+					if (idx > 0)
+						thread_assumps.push(Minisat::mkLit(minisatVars.at(idx-1)));
+					else
+						thread_assumps.push(Minisat::mkLit(minisatVars.at(-idx-1), true));
+				}
+				Minisat::lbool ret = allSolvers[i]->solveLimited(thread_assumps);
+				if (ret != l_Undef) {
+					int expected = -1;
+					if (winner.compare_exchange_strong(expected, int(i))) {
+						results[i] = ret == l_True ? 1 : 0;
+						for (size_t j = 0; j < allSolvers.size(); j++)
+							if (j != i)
+								allSolvers[j]->interrupt();
+					}
+				}
+			});
+
+		for (auto &thread : threads)
+			thread.join();
+		for (auto solver : allSolvers)
+			solver->clearInterrupt();
+
+		int w = winner.load();
+		if (w < 0) {
+			// all instances were interrupted (solver timeout)
+			foundSolution = false;
+		} else {
+			foundSolution = results[w] != 0;
+			modelSolver = allSolvers[w];
+		}
+	}
 
 #if defined(HAS_ALARM)
 	if (solverTimeout > 0) {
@@ -215,8 +303,7 @@ contradiction:
 
 	if (!foundSolution) {
 #if !EZMINISAT_INCREMENTAL
-		delete minisatSolver;
-		minisatSolver = NULL;
+		deleteSolvers();
 		minisatVars.clear();
 #endif
 		return false;
@@ -234,13 +321,12 @@ contradiction:
 			idx = -idx, refvalue = false;
 
 		using namespace Minisat;
-		lbool value = minisatSolver->modelValue(minisatVars.at(idx-1));
+		lbool value = modelSolver->modelValue(minisatVars.at(idx-1));
 		modelValues[i] = (value == Minisat::lbool(refvalue));
 	}
 
 #if !EZMINISAT_INCREMENTAL
-	delete minisatSolver;
-	minisatSolver = NULL;
+	deleteSolvers();
 	minisatVars.clear();
 #endif
 	return true;
@@ -44,9 +44,13 @@ private:
 	typedef Minisat::Solver Solver;
 #endif
 	Solver *minisatSolver;
+	std::vector<Solver*> portfolioSolvers;
 	std::vector<int> minisatVars;
 	bool foundContradiction;
 
+	void deleteSolvers();
+	void interruptAllSolvers();
+
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
 	std::set<int> cnfFrozenVars;
 #endif
@@ -55,6 +55,7 @@ ezSAT::ezSAT()
 
 	solverTimeout = 0;
 	solverTimoutStatus = false;
+	solverThreads = 1;
 
 	literal("CONST_TRUE");
 	literal("CONST_FALSE");
@@ -85,11 +86,12 @@ int ezSAT::literal()
 
 int ezSAT::literal(const std::string &name)
 {
-	if (literalsCache.count(name) == 0) {
+	auto it = literalsCache.find(name);
+	if (it == literalsCache.end()) {
 		literals.push_back(name);
-		literalsCache[name] = literals.size();
+		it = literalsCache.emplace(name, literals.size()).first;
 	}
-	return literalsCache.at(name);
+	return it->second;
 }
 
 int ezSAT::frozen_literal()
@@ -202,15 +204,16 @@ int ezSAT::expression(OpId op, const std::vector<int> &args)
 		abort();
 	}
 
-	std::pair<OpId, std::vector<int>> myExpr(op, myArgs);
+	std::pair<OpId, std::vector<int>> myExpr(op, std::move(myArgs));
 	int id = 0;
 
-	if (expressionsCache.count(myExpr) > 0) {
-		id = expressionsCache.at(myExpr);
+	auto it = expressionsCache.find(myExpr);
+	if (it != expressionsCache.end()) {
+		id = it->second;
 	} else {
 		id = -(int(expressions.size()) + 1);
-		expressionsCache[myExpr] = id;
 		expressions.push_back(myExpr);
+		expressionsCache.emplace(std::move(myExpr), id);
 	}
 
 	if (xorRemovedOddTrues)
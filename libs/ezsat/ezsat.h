@@ -22,6 +22,7 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <stdio.h>
@@ -54,10 +55,22 @@ private:
 
 	bool non_incremental_solve_used_up;
 
-	std::map<std::string, int> literalsCache;
+	// hash-consing tables for atoms and expression nodes. the expression
+	// DAG itself lives in the flat 'expressions' vector (negative token
+	// numbers are indices into it), these tables only deduplicate.
+	struct exprHash {
+		size_t operator()(const std::pair<OpId, std::vector<int>> &expr) const {
+			size_t hash = 5381 + expr.first;
+			for (int arg : expr.second)
+				hash = ((hash << 5) + hash) ^ size_t(arg);
+			return hash;
+		}
+	};
+
+	std::unordered_map<std::string, int> literalsCache;
 	std::vector<std::string> literals;
 
-	std::map<std::pair<OpId, std::vector<int>>, int> expressionsCache;
+	std::unordered_map<std::pair<OpId, std::vector<int>>, int, exprHash> expressionsCache;
 	std::vector<std::pair<OpId, std::vector<int>>> expressions;
 
 	bool cnfConsumed;
@@ -80,6 +93,11 @@ public:
 	int solverTimeout;
 	bool solverTimoutStatus;
 
+	// run this many diversified solver instances in parallel and take the
+	// first result (a hint -- backends without portfolio support solve
+	// single-threaded). must be set before the first call to solve().
+	int solverThreads;
+
 	ezSAT();
 	virtual ~ezSAT();
 
@@ -28,3 +28,11 @@
 # ifndef __STDC_FORMAT_MACROS
 #  define __STDC_FORMAT_MACROS 1
 # endif
+
+/* Compile the parallel writer so fstWriterSetParallelMode() can compress
+   value-change blocks on a background thread. Keep this condition in sync
+   with the call site in passes/sat/sim.cc: calling SetParallelMode(ctx, 1)
+   on a build without FST_WRITER_PARALLEL terminates the process. */
+#if defined(HAVE_LIBPTHREAD) && (defined(__linux__) || defined(__FreeBSD__))
+#define FST_WRITER_PARALLEL 1
+#endif
@@ -20,6 +20,8 @@
 #include "kernel/yosys.h"
 #include "backends/rtlil/rtlil_backend.h"
 
+#include <thread>
+
 USING_YOSYS_NAMESPACE
 using namespace RTLIL_BACKEND;
 PRIVATE_NAMESPACE_BEGIN
@@ -92,21 +94,34 @@ struct BugpointPass : public Pass {
 		log("    -runner \"<prefix>\"\n");
 		log("        child process wrapping command, e.g., \"timeout 30\", or valgrind.\n");
 		log("\n");
+		log("    -jobs <N>\n");
+		log("        speculatively test up to N minimization candidates in concurrent child\n");
+		log("        processes and continue from the first one (in candidate order) that\n");
+		log("        still crashes. each job keeps its own copy of the design in memory and\n");
+		log("        writes its own bugpoint-case-<j>.il/.log files.\n");
+		log("\n");
 	}
 
-	bool run_yosys(RTLIL::Design *design, string runner, string yosys_cmd, string yosys_arg)
+	void write_testcase(RTLIL::Design *design, const string &case_file)
 	{
 		design->sort();
 
-		std::ofstream f("bugpoint-case.il");
+		std::ofstream f(case_file);
 		RTLIL_BACKEND::dump_design(f, design, /*only_selected=*/false, /*flag_m=*/true, /*flag_n=*/false);
-		f.close();
+	}
+
+	string yosys_cmdline(const string &runner, const string &yosys_cmd, const string &yosys_arg, const string &case_file, const string &log_file)
+	{
+		return stringf("%s %s -qq -L %s %s %s", runner.c_str(), yosys_cmd.c_str(), log_file.c_str(), yosys_arg.c_str(), case_file.c_str());
+	}
 
-		string yosys_cmdline = stringf("%s %s -qq -L bugpoint-case.log %s bugpoint-case.il", runner.c_str(), yosys_cmd.c_str(), yosys_arg.c_str());
-		return run_command(yosys_cmdline) == 0;
+	bool run_yosys(RTLIL::Design *design, string runner, string yosys_cmd, string yosys_arg)
+	{
+		write_testcase(design, "bugpoint-case.il");
+		return run_command(yosys_cmdline(runner, yosys_cmd, yosys_arg, "bugpoint-case.il", "bugpoint-case.log")) == 0;
 	}
 
-	bool check_logfile(string grep)
+	bool check_logfile(string grep, string log_file = "bugpoint-case.log")
 	{
 		if (grep.empty())
 			return true;
@@ -114,7 +129,7 @@ struct BugpointPass : public Pass {
 		if (grep.size() > 2 && grep.front() == '"' && grep.back() == '"')
 			grep = grep.substr(1, grep.size() - 2);
 
-		std::ifstream f("bugpoint-case.log");
+		std::ifstream f(log_file);
 		while (!f.eof())
 		{
 			string line;
@@ -141,11 +156,28 @@ struct BugpointPass : public Pass {
 		return design_copy;
 	}
 
-	RTLIL::Design *simplify_something(RTLIL::Design *design, int &seed, bool stage2, bool modules, bool ports, bool cells, bool connections, bool processes, bool assigns, bool updates, bool wires)
+	// Lazy-copy bookkeeping: before the candidate design mutates a module it
+	// shares with the reference design, stash a pristine clone so a failed
+	// attempt can be reverted without ever deep-copying the whole design.
+	static void backup_module(RTLIL::Design **backup_out, RTLIL::Module *mod)
+	{
+		if (backup_out == nullptr)
+			return;
+		if (*backup_out == nullptr)
+			*backup_out = new RTLIL::Design;
+		if ((*backup_out)->module(mod->name) == nullptr)
+			(*backup_out)->add(mod->clone());
+	}
+
+	RTLIL::Design *simplify_something(RTLIL::Design *design, int &seed, bool stage2, bool modules, bool ports, bool cells, bool connections, bool processes, bool assigns, bool updates, bool wires, RTLIL::Design **backup_out = nullptr)
 	{
 		RTLIL::Design *design_copy = new RTLIL::Design;
-		for (auto module : design->modules())
-			design_copy->add(module->clone());
+		if (backup_out != nullptr)
+			for (auto module : design->modules().to_vector())
+				design->transfer(module, design_copy);
+		else
+			for (auto module : design->modules())
+				design_copy->add(module->clone());
 
 		int index = 0;
 		if (modules)
@@ -167,7 +199,12 @@ struct BugpointPass : public Pass {
 				}
 			}
 			if (removed_module) {
-				design_copy->remove(removed_module);
+				if (backup_out != nullptr) {
+					if (*backup_out == nullptr)
+						*backup_out = new RTLIL::Design;
+					design_copy->transfer(removed_module, *backup_out);
+				} else
+					design_copy->remove(removed_module);
 				return design_copy;
 			}
 		}
@@ -192,6 +229,7 @@ struct BugpointPass : public Pass {
 					if (index++ == seed)
 					{
 						log_header(design, "Trying to remove module port %s.\n", log_id(wire));
+						backup_module(backup_out, mod);
 						wire->port_input = wire->port_output = false;
 						mod->fixup_ports();
 						return design_copy;
@@ -220,6 +258,7 @@ struct BugpointPass : public Pass {
 					}
 				}
 				if (removed_cell) {
+					backup_module(backup_out, mod);
 					mod->remove(removed_cell);
 					return design_copy;
 				}
@@ -246,6 +285,7 @@ struct BugpointPass : public Pass {
 						if (index++ == seed)
 						{
 							log_header(design, "Trying to remove cell port %s.%s.%s.\n", log_id(mod), log_id(cell), log_id(it.first));
+							backup_module(backup_out, mod);
 							RTLIL::SigSpec port_x(State::Sx, port.size());
 							cell->unsetPort(it.first);
 							cell->setPort(it.first, port_x);
@@ -255,6 +295,7 @@ struct BugpointPass : public Pass {
 						if (!stage2 && (cell->input(it.first) || cell->output(it.first)) && index++ == seed)
 						{
 							log_header(design, "Trying to expose cell port %s.%s.%s as module port.\n", log_id(mod), log_id(cell), log_id(it.first));
+							backup_module(backup_out, mod);
 							RTLIL::Wire *wire = mod->addWire(NEW_ID, port.size());
 							wire->set_bool_attribute(ID($bugpoint));
 							wire->port_input = cell->input(it.first);
@@ -289,6 +330,7 @@ struct BugpointPass : public Pass {
 					}
 				}
 				if (removed_process) {
+					backup_module(backup_out, mod);
 					mod->remove(removed_process);
 					return design_copy;
 				}
@@ -313,6 +355,7 @@ struct BugpointPass : public Pass {
 							if (index++ == seed)
 							{
 								log_header(design, "Trying to remove assign %s %s in %s.%s.\n", log_signal(it->first), log_signal(it->second), log_id(mod), log_id(pr.first));
+								backup_module(backup_out, mod);
 								cs->actions.erase(it);
 								return design_copy;
 							}
@@ -339,6 +382,7 @@ struct BugpointPass : public Pass {
 							if (index++ == seed)
 							{
 								log_header(design, "Trying to remove sync %s update %s %s in %s.%s.\n", log_signal(sy->signal), log_signal(it->first), log_signal(it->second), log_id(mod), log_id(pr.first));
+								backup_module(backup_out, mod);
 								sy->actions.erase(it);
 								return design_copy;
 							}
@@ -349,6 +393,7 @@ struct BugpointPass : public Pass {
 							if (index++ == seed)
 							{
 								log_header(design, "Trying to remove sync %s memwr %s %s %s %s in %s.%s.\n", log_signal(sy->signal), log_id(it->memid), log_signal(it->address), log_signal(it->data), log_signal(it->enable), log_id(mod), log_id(pr.first));
+								backup_module(backup_out, mod);
 								sy->mem_write_actions.erase(it);
 								// Remove the bit for removed action from other actions' priority masks.
 								for (auto it2 = sy->mem_write_actions.begin(); it2 != sy->mem_write_actions.end(); ++it2) {
@@ -388,11 +433,15 @@ struct BugpointPass : public Pass {
 					}
 				}
 				if (removed_wire) {
+					backup_module(backup_out, mod);
 					mod->remove({removed_wire});
 					return design_copy;
 				}
 			}
 		}
+		if (backup_out != nullptr)
+			for (auto module : design_copy->modules().to_vector())
+				design_copy->transfer(module, design);
 		delete design_copy;
 		return nullptr;
 	}
@@ -400,6 +449,7 @@ struct BugpointPass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		string yosys_cmd = "yosys", yosys_arg, grep, runner;
+		int jobs = 1;
 		bool fast = false, clean = false;
 		bool modules = false, ports = false, cells = false, connections = false, processes = false, assigns = false, updates = false, wires = false, has_part = false;
 
@@ -477,6 +527,12 @@ struct BugpointPass : public Pass {
 				has_part = true;
 				continue;
 			}
+			if (args[argidx] == "-jobs" && argidx + 1 < args.size()) {
+				jobs = atoi(args[++argidx].c_str());
+				if (jobs < 1)
+					log_cmd_error("Invalid number of jobs: %s\n", args[argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-runner" && argidx + 1 < args.size()) {
 				runner = args[++argidx];
 				if (runner.size() && runner.at(0) == '"') {
@@ -517,7 +573,106 @@ struct BugpointPass : public Pass {
 		bool found_something = false, stage2 = false;
 		while (true)
 		{
-			if (RTLIL::Design *simplified = simplify_something(crashing_design, seed, stage2, modules, ports, cells, connections, processes, assigns, updates, wires))
+			if (jobs > 1)
+			{
+				// speculative batch: derive up to 'jobs' candidates from the
+				// current base design (each one a full copy, so the base
+				// stays untouched), run the children concurrently and adopt
+				// the first candidate in seed order that still crashes --
+				// that matches the serial algorithm, which also keeps the
+				// crashing seed and forgets the failures before it
+				std::vector<RTLIL::Design*> candidates;
+				for (int j = 0; j < jobs; j++) {
+					int cand_seed = seed + j;
+					RTLIL::Design *simplified = simplify_something(crashing_design, cand_seed, stage2, modules, ports, cells, connections, processes, assigns, updates, wires);
+					if (simplified == nullptr)
+						break;
+					candidates.push_back(clean_design(simplified, fast, /*do_delete=*/true));
+				}
+
+				if (!candidates.empty())
+				{
+					// write the testcases serially, then only the child
+					// processes run concurrently (the worker threads touch
+					// no RTLIL state, they just wait on run_command)
+					std::vector<string> cmdlines;
+					for (int j = 0; j < GetSize(candidates); j++) {
+						string case_file = stringf("bugpoint-case-%d.il", j);
+						string log_file = stringf("bugpoint-case-%d.log", j);
+						RTLIL::Design *testcase = clean ? clean_design(candidates[j]) : candidates[j];
+						write_testcase(testcase, case_file);
+						if (clean)
+							delete testcase;
+						cmdlines.push_back(yosys_cmdline(runner, yosys_cmd, yosys_arg, case_file, log_file));
+					}
+
+					std::vector<int> results(GetSize(candidates), 0);
+					std::vector<std::thread> threads;
+					for (int j = 0; j < GetSize(candidates); j++)
+						threads.emplace_back([&results, &cmdlines, j]() {
+							results[j] = run_command(cmdlines[j]);
+						});
+					for (auto &thread : threads)
+						thread.join();
+
+					int crashing_idx = -1;
+					for (int j = 0; j < GetSize(candidates); j++)
+						if (results[j] != 0 && check_logfile(grep, stringf("bugpoint-case-%d.log", j))) {
+							crashing_idx = j;
+							break;
+						}
+
+					if (crashing_idx >= 0)
+					{
+						log("Testcase crashes (batch candidate %d).\n", crashing_idx);
+						seed += crashing_idx;
+						if (crashing_design != design)
+							delete crashing_design;
+						crashing_design = candidates[crashing_idx];
+						for (int j = 0; j < GetSize(candidates); j++)
+							if (j != crashing_idx)
+								delete candidates[j];
+						found_something = true;
+					}
+					else
+					{
+						log("No testcase in batch of %d crashes.\n", GetSize(candidates));
+						for (auto candidate : candidates)
+							delete candidate;
+						seed += GetSize(candidates);
+					}
+					continue;
+				}
+
+				// fall through to the exhaustion handling below
+				seed = 0;
+				if (found_something)
+					found_something = false;
+				else
+				{
+					if (!stage2)
+					{
+						log("Demoting introduced module ports.\n");
+						stage2 = true;
+					}
+					else
+					{
+						log("Simplifications exhausted.\n");
+						break;
+					}
+				}
+				continue;
+			}
+
+			// without -fast the candidate design is not rewritten after the
+			// simplification step, so modules can be moved between the
+			// reference design and the candidate instead of deep-copied
+			RTLIL::Design *backup = nullptr;
+			std::vector<RTLIL::IdString> module_order;
+			if (!fast)
+				for (auto module : crashing_design->modules())
+					module_order.push_back(module->name);
+			if (RTLIL::Design *simplified = simplify_something(crashing_design, seed, stage2, modules, ports, cells, connections, processes, assigns, updates, wires, fast ? nullptr : &backup))
 			{
 				simplified = clean_design(simplified, fast, /*do_delete=*/true);
 
@@ -536,6 +691,7 @@ struct BugpointPass : public Pass {
 				if (crashes && check_logfile(grep))
 				{
 					log("Testcase crashes.\n");
+					delete backup;
 					if (crashing_design != design)
 						delete crashing_design;
 					crashing_design = simplified;
@@ -544,6 +700,25 @@ struct BugpointPass : public Pass {
 				else
 				{
 					log("Testcase does not crash.\n");
+					if (backup != nullptr) {
+						// hand the unmodified modules back to the reference
+						// design and restore the stashed originals of the
+						// mutated ones
+						for (auto module : simplified->modules().to_vector())
+							if (backup->module(module->name) == nullptr)
+								simplified->transfer(module, crashing_design);
+						for (auto module : backup->modules().to_vector())
+							backup->transfer(module, crashing_design);
+						delete backup;
+						// the seed cursor assumes a stable candidate enumeration
+						// across attempts, so also restore the pre-attempt module
+						// order (the stashed originals come back last otherwise)
+						dict<RTLIL::IdString, RTLIL::Module*> ordered_modules;
+						for (auto &name : module_order)
+							ordered_modules.insert({name, crashing_design->modules_.at(name)});
+						log_assert(GetSize(ordered_modules) == GetSize(crashing_design->modules_));
+						crashing_design->modules_.swap(ordered_modules);
+					}
 					delete simplified;
 					seed++;
 				}
@@ -0,0 +1,111 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/rtlil.h"
+#include "kernel/constspill.h"
+#include "kernel/log.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct ConstspillPass : public Pass {
+	ConstspillPass() : Pass("constspill", "spill large constants to disk") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    constspill [options] [selection]\n");
+		log("\n");
+		log("Move the payloads of large constants (attribute values and cell parameters,\n");
+		log("e.g. big memory INIT data) out to an on-disk spill file so that designs\n");
+		log("carrying big initialization data don't keep it resident through passes that\n");
+		log("never look at it. Any pass that does access a spilled constant faults its\n");
+		log("payload back into memory transparently.\n");
+		log("\n");
+		log("The spill file lives in the temp directory, grows append-only and is removed\n");
+		log("when yosys exits. String-valued constants are not spilled (their backing is\n");
+		log("already shared between copies).\n");
+		log("\n");
+		log("    -threshold <bits>\n");
+		log("        only spill constants of at least this many bits (default: 65536)\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		log_header(design, "Executing CONSTSPILL pass (spill large constants to disk).\n");
+
+		int threshold = 65536;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			std::string arg = args[argidx];
+			if (arg == "-threshold" && argidx+1 < args.size()) {
+				threshold = atoi(args[++argidx].c_str());
+				if (threshold < 1)
+					log_cmd_error("Invalid threshold: %s\n", args[argidx].c_str());
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		int spilled_count = 0;
+		long long spilled_bits = 0;
+
+		auto spill_consts = [&](dict<RTLIL::IdString, RTLIL::Const> &values) {
+			for (auto &it : values) {
+				if (it.second.size() < threshold)
+					continue;
+				if (it.second.spill()) {
+					spilled_count++;
+					spilled_bits += it.second.size();
+				}
+			}
+		};
+
+		for (auto module : design->modules())
+		{
+			if (design->selected_whole_module(module->name))
+				spill_consts(module->attributes);
+
+			if (!design->selected(module))
+				continue;
+
+			for (auto wire : module->wires())
+				if (design->selected(module, wire))
+					spill_consts(wire->attributes);
+
+			for (auto &it : module->memories)
+				if (design->selected(module, it.second))
+					spill_consts(it.second->attributes);
+
+			for (auto cell : module->cells())
+				if (design->selected(module, cell)) {
+					spill_consts(cell->attributes);
+					spill_consts(cell->parameters);
+				}
+		}
+
+		log("Spilled %d constants (%lld bits), spill file now holds %.2f MiB.\n",
+				spilled_count, spilled_bits, ConstSpill::total_bytes() / (1024.0 * 1024));
+	}
+} ConstspillPass;
+
+PRIVATE_NAMESPACE_END
@@ -26,6 +26,70 @@ YOSYS_NAMESPACE_BEGIN
 std::map<std::string, RTLIL::Design*> saved_designs;
 std::vector<RTLIL::Design*> pushed_designs;
 
+// saved designs spilled to disk checkpoints by spill_saved_designs(),
+// mapping the design name to the checkpoint filename
+static std::map<std::string, std::string> spilled_designs;
+
+static void drop_spilled_design(const std::string &name)
+{
+	auto it = spilled_designs.find(name);
+	if (it == spilled_designs.end())
+		return;
+	remove(it->second.c_str());
+	spilled_designs.erase(it);
+}
+
+static bool saved_design_exists(const std::string &name)
+{
+	return saved_designs.count(name) != 0 || spilled_designs.count(name) != 0;
+}
+
+// look up a saved design by name, restoring it from its disk checkpoint
+// first if it has been spilled; returns nullptr if there is no such design
+static RTLIL::Design *fetch_saved_design(const std::string &name)
+{
+	auto it = saved_designs.find(name);
+	if (it != saved_designs.end())
+		return it->second;
+
+	auto spilled = spilled_designs.find(name);
+	if (spilled == spilled_designs.end())
+		return nullptr;
+
+	log("Restoring design '%s' from checkpoint file `%s'.\n", name.c_str(), spilled->second.c_str());
+
+	RTLIL::Design *restored = new RTLIL::Design;
+	Frontend::frontend_call(restored, nullptr, spilled->second, "rtlil");
+	remove(spilled->second.c_str());
+	spilled_designs.erase(spilled);
+
+	saved_designs[name] = restored;
+	return restored;
+}
+
+int spill_saved_designs()
+{
+	int count = 0;
+
+	for (auto &it : saved_designs)
+	{
+#ifdef YOSYS_ENABLE_ZLIB
+		std::string filename = make_temp_file() + ".il.gz";
+#else
+		std::string filename = make_temp_file() + ".il";
+#endif
+		log("Spilling design '%s' to checkpoint file `%s'.\n", it.first.c_str(), filename.c_str());
+
+		Backend::backend_call(it.second, nullptr, filename, "rtlil");
+		delete it.second;
+		spilled_designs[it.first] = filename;
+		count++;
+	}
+
+	saved_designs.clear();
+	return count;
+}
+
 struct DesignPass : public Pass {
 	DesignPass() : Pass("design", "save, restore and reset current design") { }
 	~DesignPass() override {
@@ -35,6 +99,9 @@ struct DesignPass : public Pass {
 		for (auto &it : pushed_designs)
 			delete it;
 		pushed_designs.clear();
+		for (auto &it : spilled_designs)
+			remove(it.second.c_str());
+		spilled_designs.clear();
 	}
 	void help() override
 	{
@@ -76,6 +143,13 @@ struct DesignPass : public Pass {
 		log("name.\n");
 		log("\n");
 		log("\n");
+		log("    design -swap <name>\n");
+		log("\n");
+		log("Exchange the current design and the design previously saved under the given\n");
+		log("name. The modules are moved, not copied, so switching between designs held in\n");
+		log("the same process is cheap regardless of design size.\n");
+		log("\n");
+		log("\n");
 		log("    design -copy-from <name> [-as <new_mod_name>] <selection>\n");
 		log("\n");
 		log("Copy modules from the specified design into the current one. The selection is\n");
@@ -103,6 +177,12 @@ struct DesignPass : public Pass {
 		log("\n");
 		log("Delete the design previously saved under the given name.\n");
 		log("\n");
+		log("When the scratchpad variable 'memory.budget' is set to a memory budget in\n");
+		log("MiB, saved designs may be spilled to temporary disk checkpoints between\n");
+		log("commands once the process gets close to the budget. They are restored\n");
+		log("transparently on their next use, but selection state saved with a design\n");
+		log("does not survive a spill.\n");
+		log("\n");
 
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
@@ -115,7 +195,7 @@ struct DesignPass : public Pass {
 		bool pop_mode = false;
 		bool import_mode = false;
 		RTLIL::Design *copy_from_design = NULL, *copy_to_design = NULL;
-		std::string save_name, load_name, as_name, delete_name;
+		std::string save_name, load_name, swap_name, as_name, delete_name;
 		std::vector<RTLIL::Module*> copy_src_modules;
 
 		if (!design)
@@ -164,32 +244,41 @@ struct DesignPass : public Pass {
 			if (!got_mode && args[argidx] == "-load" && argidx+1 < args.size()) {
 				got_mode = true;
 				load_name = args[++argidx];
-				if (saved_designs.count(load_name) == 0)
+				if (!saved_design_exists(load_name))
 					log_cmd_error("No saved design '%s' found!\n", load_name.c_str());
 				continue;
 			}
+			if (!got_mode && args[argidx] == "-swap" && argidx+1 < args.size()) {
+				got_mode = true;
+				swap_name = args[++argidx];
+				if (!saved_design_exists(swap_name))
+					log_cmd_error("No saved design '%s' found!\n", swap_name.c_str());
+				continue;
+			}
 			if (!got_mode && args[argidx] == "-copy-from" && argidx+1 < args.size()) {
 				got_mode = true;
-				if (saved_designs.count(args[++argidx]) == 0)
+				copy_from_design = fetch_saved_design(args[++argidx]);
+				if (copy_from_design == nullptr)
 					log_cmd_error("No saved design '%s' found!\n", args[argidx].c_str());
-				copy_from_design = saved_designs.at(args[argidx]);
 				copy_to_design = design;
 				continue;
 			}
 			if (!got_mode && args[argidx] == "-copy-to" && argidx+1 < args.size()) {
 				got_mode = true;
-				if (saved_designs.count(args[++argidx]) == 0)
+				copy_to_design = fetch_saved_design(args[++argidx]);
+				if (copy_to_design == nullptr) {
 					saved_designs[args[argidx]] = new RTLIL::Design;
-				copy_to_design = saved_designs.at(args[argidx]);
+					copy_to_design = saved_designs.at(args[argidx]);
+				}
 				copy_from_design = design;
 				continue;
 			}
 			if (!got_mode && args[argidx] == "-import" && argidx+1 < args.size()) {
 				got_mode = true;
 				import_mode = true;
-				if (saved_designs.count(args[++argidx]) == 0)
+				copy_from_design = fetch_saved_design(args[++argidx]);
+				if (copy_from_design == nullptr)
 					log_cmd_error("No saved design '%s' found!\n", args[argidx].c_str());
-				copy_from_design = saved_designs.at(args[argidx]);
 				copy_to_design = design;
 				as_name = args[argidx];
 				continue;
@@ -201,7 +290,7 @@ struct DesignPass : public Pass {
 			if (!got_mode && args[argidx] == "-delete" && argidx+1 < args.size()) {
 				got_mode = true;
 				delete_name = args[++argidx];
-				if (saved_designs.count(delete_name) == 0)
+				if (!saved_design_exists(delete_name))
 					log_cmd_error("No saved design '%s' found!\n", delete_name.c_str());
 				continue;
 			}
@@ -343,8 +432,14 @@ struct DesignPass : public Pass {
 		{
 			RTLIL::Design *design_copy = new RTLIL::Design;
 
-			for (auto mod : design->modules())
-				design_copy->add(mod->clone());
+			// when the current design is cleared right afterwards (-stash and
+			// -push), move the modules instead of deep-copying them
+			if (reset_mode || push_mode)
+				for (auto mod : design->modules().to_vector())
+					design->transfer(mod, design_copy);
+			else
+				for (auto mod : design->modules())
+					design_copy->add(mod->clone());
 
 			design_copy->selection_stack = design->selection_stack;
 			design_copy->selection_vars = design->selection_vars;
@@ -352,6 +447,7 @@ struct DesignPass : public Pass {
 
 			if (saved_designs.count(save_name))
 				delete saved_designs.at(save_name);
+			drop_spilled_design(save_name);
 
 			if (push_mode || push_copy_mode)
 				pushed_designs.push_back(design_copy);
@@ -386,10 +482,16 @@ struct DesignPass : public Pass {
 
 		if (!load_name.empty() || pop_mode)
 		{
-			RTLIL::Design *saved_design = pop_mode ? pushed_designs.back() : saved_designs.at(load_name);
+			RTLIL::Design *saved_design = pop_mode ? pushed_designs.back() : fetch_saved_design(load_name);
 
-			for (auto mod : saved_design->modules())
-				design->add(mod->clone());
+			// the popped design is deleted right afterwards, so its modules
+			// can be moved instead of deep-copied
+			if (pop_mode)
+				for (auto mod : saved_design->modules().to_vector())
+					saved_design->transfer(mod, design);
+			else
+				for (auto mod : saved_design->modules())
+					design->add(mod->clone());
 
 			design->selection_stack = saved_design->selection_stack;
 			design->selection_vars = saved_design->selection_vars;
@@ -401,12 +503,43 @@ struct DesignPass : public Pass {
 			}
 		}
 
+		if (!swap_name.empty())
+		{
+			RTLIL::Design *saved_design = fetch_saved_design(swap_name);
+
+			// exchange the two designs by moving the modules in both
+			// directions (via a scratch design to avoid name collisions);
+			// nothing is deep-copied, so the cost is proportional to the
+			// module count, not the design size
+			RTLIL::Design *scratch = new RTLIL::Design;
+
+			for (auto mod : design->modules().to_vector())
+				design->transfer(mod, scratch);
+			for (auto mod : saved_design->modules().to_vector())
+				saved_design->transfer(mod, design);
+			for (auto mod : scratch->modules().to_vector())
+				scratch->transfer(mod, saved_design);
+
+			delete scratch;
+
+			std::swap(design->selection_stack, saved_design->selection_stack);
+			std::swap(design->selection_vars, saved_design->selection_vars);
+			std::swap(design->selected_active_module, saved_design->selected_active_module);
+			std::swap(design->verilog_packages, saved_design->verilog_packages);
+			std::swap(design->verilog_globals, saved_design->verilog_globals);
+			design->verilog_defines.swap(saved_design->verilog_defines);
+		}
+
 		if (!delete_name.empty())
 		{
 			auto it = saved_designs.find(delete_name);
-			log_assert(it != saved_designs.end());
-			delete it->second;
-			saved_designs.erase(it);
+			if (it != saved_designs.end()) {
+				delete it->second;
+				saved_designs.erase(it);
+			} else {
+				log_assert(spilled_designs.count(delete_name) != 0);
+				drop_spilled_design(delete_name);
+			}
 		}
 	}
 } DesignPass;
@@ -0,0 +1,215 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/cost.h"
+#include "kernel/threadpool.h"
+#include "backends/rtlil/rtlil_binary.h"
+
+#include <fstream>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+// quote a string for POSIX sh, so the subjob script survives the launcher
+// command line unchanged
+std::string shell_quote(const std::string &str)
+{
+	std::string result = "'";
+	for (char c : str)
+		if (c == '\'')
+			result += "'\\''";
+		else
+			result += c;
+	result += "'";
+	return result;
+}
+
+struct DispatchPass : public Pass {
+	DispatchPass() : Pass("dispatch", "run a command on hierarchy partitions in child processes") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    dispatch -jobs <num> -run <command> [options] [selection]\n");
+		log("\n");
+		log("Partition the selected modules into balanced groups, run the given command on\n");
+		log("every group in a child yosys process, and merge the rewritten modules back\n");
+		log("into the current design. The groups are exchanged with the children as binary\n");
+		log("RTLIL checkpoint files; the balance weights come from the cell cost model\n");
+		log("(see kernel/cost.cc).\n");
+		log("\n");
+		log("Each subjob only sees the modules of its own group. Instances of modules\n");
+		log("outside the group have no definition in the child, so the command must work\n");
+		log("module-locally and keep the port interfaces of the modules intact.\n");
+		log("\n");
+		log("    -jobs <num>\n");
+		log("        number of subjobs (required). all subjobs are started concurrently;\n");
+		log("        without a launcher, pick a value that matches the local machine.\n");
+		log("\n");
+		log("    -run <command>\n");
+		log("        command (or semicolon-separated list of commands) each subjob runs\n");
+		log("        on its group of modules (required)\n");
+		log("\n");
+		log("    -launcher <command>\n");
+		log("        prefix for the child command lines, e.g. a cluster submit wrapper\n");
+		log("        that runs its argument on a remote machine and waits for it. the\n");
+		log("        temporary directory must be shared with the machines running the\n");
+		log("        subjobs. without this option children run on the local machine.\n");
+		log("\n");
+		log("    -yosys <path>\n");
+		log("        yosys executable for the subjobs. the default is the executable\n");
+		log("        that is currently running.\n");
+		log("\n");
+		log("    -keep\n");
+		log("        keep the temporary directory with the checkpoint and log files\n");
+		log("        instead of removing it when all subjobs succeed. on failure the\n");
+		log("        directory is always kept.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		log_header(design, "Executing DISPATCH pass (run a command on hierarchy partitions).\n");
+
+		int num_jobs = 0;
+		std::string run_cmd, launcher, yosys_exe;
+		bool keep_mode = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-jobs" && argidx+1 < args.size()) {
+				num_jobs = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-run" && argidx+1 < args.size()) {
+				run_cmd = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-launcher" && argidx+1 < args.size()) {
+				launcher = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-yosys" && argidx+1 < args.size()) {
+				yosys_exe = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-keep") {
+				keep_mode = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		if (num_jobs < 1)
+			log_cmd_error("Option -jobs with a positive number of subjobs is required.\n");
+		if (run_cmd.empty())
+			log_cmd_error("Option -run is required.\n");
+		if (yosys_exe.empty())
+			yosys_exe = proc_self_dirname() + "yosys";
+
+		std::vector<RTLIL::Module*> partition_modules;
+		for (auto module : design->selected_modules())
+			if (!module->get_blackbox_attribute())
+				partition_modules.push_back(module);
+		if (partition_modules.empty())
+			log_cmd_error("No non-blackbox modules selected.\n");
+		num_jobs = min(num_jobs, GetSize(partition_modules));
+
+		// balance the modules over the jobs by estimated cost: heaviest
+		// module first, always into the currently lightest job
+		CellCosts costs(design);
+		std::vector<unsigned int> weight;
+		for (auto module : partition_modules)
+			weight.push_back(costs.get_selected(module));
+
+		std::vector<int> order(GetSize(partition_modules));
+		for (int i = 0; i < GetSize(order); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			return weight[a] > weight[b];
+		});
+
+		std::vector<size_t> job_load(num_jobs, 0);
+		std::vector<std::vector<RTLIL::Module*>> job_modules(num_jobs);
+		for (int idx : order) {
+			int lightest = 0;
+			for (int job = 1; job < num_jobs; job++)
+				if (job_load[job] < job_load[lightest])
+					lightest = job;
+			job_modules[lightest].push_back(partition_modules[idx]);
+			job_load[lightest] += weight[idx];
+		}
+
+		std::string tempdir_name = make_temp_dir(get_base_tmpdir() + "/yosys-dispatch-XXXXXX");
+		log("Dispatching %d modules as %d subjobs via `%s'.\n",
+				GetSize(partition_modules), num_jobs, tempdir_name.c_str());
+
+		std::vector<std::string> job_command(num_jobs), out_filename(num_jobs), log_filename(num_jobs);
+		for (int job = 0; job < num_jobs; job++) {
+			std::string in_filename = stringf("%s/job%d_in.il", tempdir_name.c_str(), job);
+			out_filename[job] = stringf("%s/job%d_out.il", tempdir_name.c_str(), job);
+			log_filename[job] = stringf("%s/job%d.log", tempdir_name.c_str(), job);
+
+			std::ofstream f(in_filename, std::ofstream::trunc | std::ofstream::binary);
+			if (f.fail())
+				log_error("Can't open file `%s' for writing: %s\n", in_filename.c_str(), strerror(errno));
+			RTLIL::Selection sel(false);
+			for (auto module : job_modules[job])
+				sel.select(module);
+			design->selection_stack.push_back(sel);
+			RTLIL_BINARY::dump_design_bin(f, design, true);
+			design->selection_stack.pop_back();
+
+			std::string script = stringf("read_rtlil %s; %s; write_rtlil -binary %s",
+					in_filename.c_str(), run_cmd.c_str(), out_filename[job].c_str());
+			job_command[job] = stringf("%s%s -ql %s -p %s",
+					launcher.empty() ? "" : (launcher + " ").c_str(),
+					shell_quote(yosys_exe).c_str(), log_filename[job].c_str(),
+					shell_quote(script).c_str());
+			log_debug("Subjob %d (%d modules, weight %d): %s\n", job,
+					GetSize(job_modules[job]), (int)job_load[job], job_command[job].c_str());
+		}
+
+		// the workers only start child processes and wait for them, which
+		// keeps them within the ThreadPool contract
+		std::vector<int> job_status(num_jobs, -1);
+		ThreadPool::run(num_jobs, num_jobs, [&](int job) {
+			job_status[job] = run_command(job_command[job]);
+		});
+
+		for (int job = 0; job < num_jobs; job++)
+			if (job_status[job] != 0)
+				log_error("Subjob %d failed with status %d, see log file `%s'.\n",
+						job, job_status[job], log_filename[job].c_str());
+
+		for (int job = 0; job < num_jobs; job++) {
+			std::ifstream f(out_filename[job], std::ifstream::binary);
+			if (f.fail())
+				log_error("Can't open file `%s' for reading: %s\n", out_filename[job].c_str(), strerror(errno));
+			RTLIL_BINARY::load_design_bin(f, design, false, true, false);
+		}
+		log("Reassembled %d modules from %d subjobs.\n", GetSize(partition_modules), num_jobs);
+
+		if (!keep_mode)
+			remove_directory(tempdir_name);
+	}
+} DispatchPass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,297 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct EcoWorker
+{
+	RTLIL::Design *design;
+	bool dry_run;
+
+	int num_added_cells = 0;
+	int num_removed_cells = 0;
+	int num_updated_cells = 0;
+	int num_added_wires = 0;
+	int num_added_conns = 0;
+	int num_removed_conns = 0;
+	int num_added_modules = 0;
+
+	EcoWorker(RTLIL::Design *design, bool dry_run) : design(design), dry_run(dry_run) { }
+
+	// Compare signals from different designs structurally, matching wires by
+	// name instead of by pointer.
+	static bool sig_equal_by_name(const SigSpec &a, const SigSpec &b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (int i = 0; i < a.size(); i++) {
+			SigBit a_bit = a[i], b_bit = b[i];
+			if ((a_bit.wire == nullptr) != (b_bit.wire == nullptr))
+				return false;
+			if (a_bit.wire == nullptr) {
+				if (a_bit.data != b_bit.data)
+					return false;
+			} else {
+				if (a_bit.wire->name != b_bit.wire->name || a_bit.offset != b_bit.offset)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	static bool cells_equal_by_name(const RTLIL::Cell *a, const RTLIL::Cell *b)
+	{
+		if (a->type != b->type)
+			return false;
+		if (a->parameters != b->parameters)
+			return false;
+		if (GetSize(a->connections()) != GetSize(b->connections()))
+			return false;
+		for (auto &conn : a->connections()) {
+			if (!b->hasPort(conn.first))
+				return false;
+			if (!sig_equal_by_name(conn.second, b->getPort(conn.first)))
+				return false;
+		}
+		return true;
+	}
+
+	// Translate a signal from the revised design into the target module,
+	// creating missing wires on demand.
+	SigSpec map_sig(RTLIL::Module *target, const SigSpec &sig)
+	{
+		SigSpec result;
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr) {
+				result.append(chunk);
+				continue;
+			}
+			Wire *wire = target->wire(chunk.wire->name);
+			if (wire == nullptr) {
+				log("    Adding wire %s.\n", log_id(chunk.wire->name));
+				num_added_wires++;
+				wire = target->addWire(chunk.wire->name, chunk.wire->width);
+				wire->start_offset = chunk.wire->start_offset;
+				wire->upto = chunk.wire->upto;
+				wire->attributes = chunk.wire->attributes;
+			}
+			if (chunk.offset + chunk.width > wire->width)
+				log_error("Wire %s is narrower in the current design (%d bits) than in the revised design (%d bits).\n",
+						log_id(wire), wire->width, chunk.wire->width);
+			result.append(SigChunk(wire, chunk.offset, chunk.width));
+		}
+		return result;
+	}
+
+	void patch_cell(RTLIL::Module *target, const RTLIL::Cell *src)
+	{
+		Cell *cell = target->cell(src->name);
+		if (cell != nullptr)
+			target->remove(cell);
+		cell = target->addCell(src->name, src->type);
+		cell->parameters = src->parameters;
+		cell->attributes = src->attributes;
+		for (auto &conn : src->connections())
+			cell->setPort(conn.first, map_sig(target, conn.second));
+	}
+
+	void patch_module(RTLIL::Module *golden, RTLIL::Module *revised, RTLIL::Module *target)
+	{
+		log("  Patching module %s.\n", log_id(target));
+
+		for (auto cell : revised->cells())
+		{
+			Cell *golden_cell = golden->cell(cell->name);
+			if (golden_cell == nullptr) {
+				log("    Adding cell %s (%s).\n", log_id(cell), log_id(cell->type));
+				num_added_cells++;
+				if (!dry_run)
+					patch_cell(target, cell);
+			} else if (!cells_equal_by_name(golden_cell, cell)) {
+				log("    Updating cell %s (%s).\n", log_id(cell), log_id(cell->type));
+				num_updated_cells++;
+				if (!dry_run)
+					patch_cell(target, cell);
+			}
+		}
+
+		for (auto cell : golden->cells())
+		{
+			if (revised->cell(cell->name) != nullptr)
+				continue;
+			Cell *target_cell = target->cell(cell->name);
+			if (target_cell == nullptr) {
+				log_warning("Cell %s was removed in the revised design but does not exist in the current design.\n", log_id(cell));
+				continue;
+			}
+			log("    Removing cell %s (%s).\n", log_id(cell), log_id(cell->type));
+			num_removed_cells++;
+			if (!dry_run)
+				target->remove(target_cell);
+		}
+
+		// Patch the list of module-level connections: drop connections that
+		// were removed in the revised design and append the new ones.
+		for (auto &conn : golden->connections()) {
+			bool found = false;
+			for (auto &other : revised->connections())
+				if (sig_equal_by_name(conn.first, other.first) && sig_equal_by_name(conn.second, other.second))
+					found = true;
+			if (found)
+				continue;
+			num_removed_conns++;
+			if (dry_run)
+				continue;
+			std::vector<RTLIL::SigSig> new_conns;
+			for (auto &target_conn : target->connections())
+				if (!sig_equal_by_name(target_conn.first, conn.first) || !sig_equal_by_name(target_conn.second, conn.second))
+					new_conns.push_back(target_conn);
+			target->new_connections(new_conns);
+		}
+
+		for (auto &conn : revised->connections()) {
+			bool found = false;
+			for (auto &other : golden->connections())
+				if (sig_equal_by_name(conn.first, other.first) && sig_equal_by_name(conn.second, other.second))
+					found = true;
+			if (found)
+				continue;
+			num_added_conns++;
+			if (!dry_run)
+				target->connect(map_sig(target, conn.first), map_sig(target, conn.second));
+		}
+	}
+
+	void run(RTLIL::Design *golden, RTLIL::Design *revised)
+	{
+		for (auto revised_mod : revised->modules())
+		{
+			RTLIL::Module *golden_mod = golden->module(revised_mod->name);
+
+			if (golden_mod == nullptr) {
+				if (design->module(revised_mod->name) != nullptr) {
+					log_warning("Module %s is new in the revised design but already exists in the current design.\n",
+							log_id(revised_mod));
+					continue;
+				}
+				log("  Adding module %s.\n", log_id(revised_mod));
+				num_added_modules++;
+				if (!dry_run)
+					design->add(revised_mod->clone());
+				continue;
+			}
+
+			RTLIL::Module *target = design->module(revised_mod->name);
+			if (target == nullptr) {
+				log_warning("Module %s does not exist in the current design, skipping.\n", log_id(revised_mod));
+				continue;
+			}
+			if (target->has_processes())
+				log_error("Module %s contains processes, run `proc` first.\n", log_id(target));
+
+			patch_module(golden_mod, revised_mod, target);
+		}
+
+		for (auto golden_mod : golden->modules())
+			if (revised->module(golden_mod->name) == nullptr && design->module(golden_mod->name) != nullptr)
+				log_warning("Module %s was removed in the revised design; not removing it from the current design.\n",
+						log_id(golden_mod));
+
+		log("Summary: %d modules added, %d cells added, %d cells updated, %d cells removed,\n",
+				num_added_modules, num_added_cells, num_updated_cells, num_removed_cells);
+		log("         %d wires added, %d connections added, %d connections removed.\n",
+				num_added_wires, num_added_conns, num_removed_conns);
+	}
+};
+
+struct EcoPass : public Pass {
+	EcoPass() : Pass("eco", "apply the difference between two saved designs as a patch") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    eco -golden <name> -revised <name> [options]\n");
+		log("\n");
+		log("This command computes the structural difference between two saved designs\n");
+		log("(see `design -save`) and applies it to the current design as a minimal patch,\n");
+		log("matching modules, cells and wires by name. This allows small source changes\n");
+		log("to be carried over to an already mapped netlist without re-running the full\n");
+		log("synthesis flow.\n");
+		log("\n");
+		log("    -golden <name>\n");
+		log("        saved design holding the original (pre-change) sources\n");
+		log("\n");
+		log("    -revised <name>\n");
+		log("        saved design holding the changed sources\n");
+		log("\n");
+		log("    -dry\n");
+		log("        only report the patch that would be applied, do not modify the\n");
+		log("        current design\n");
+		log("\n");
+		log("Cells and connections that exist only in the revised design are added to the\n");
+		log("current design, cells that were removed are deleted, and cells whose type,\n");
+		log("parameters or connections changed are replaced. Both saved designs should be\n");
+		log("elaborated the same way (e.g. with `proc`) so the diff reflects the actual\n");
+		log("source change. Typically `clean` and a light `opt` on the patched modules\n");
+		log("complete the ECO.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		log_header(design, "Executing ECO pass (apply design diff as patch).\n");
+
+		std::string golden_name, revised_name;
+		bool dry_run = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-golden" && argidx+1 < args.size()) {
+				golden_name = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-revised" && argidx+1 < args.size()) {
+				revised_name = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-dry") {
+				dry_run = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (golden_name.empty() || revised_name.empty())
+			log_cmd_error("Both -golden and -revised are required.\n");
+
+		if (saved_designs.count(golden_name) == 0)
+			log_cmd_error("No saved design '%s' found!\n", golden_name.c_str());
+		if (saved_designs.count(revised_name) == 0)
+			log_cmd_error("No saved design '%s' found!\n", revised_name.c_str());
+
+		EcoWorker worker(design, dry_run);
+		worker.run(saved_designs.at(golden_name), saved_designs.at(revised_name));
+	}
+} EcoPass;
+
+PRIVATE_NAMESPACE_END
@@ -53,6 +53,15 @@ struct ExecPass : public Pass {
 		log("    -q\n");
 		log("        Suppress stdout and stderr from subprocess\n");
 		log("\n");
+		log("    -stdin <filename>\n");
+		log("        Connect the stdin of the subprocess to the specified file instead of\n");
+		log("        leaving it unconnected.\n");
+		log("\n");
+		log("    -buffer <size>\n");
+		log("        Read the stdout of the subprocess in chunks of <size> bytes (default\n");
+		log("        4096). Larger buffers reduce the I/O overhead with commands that\n");
+		log("        produce a lot of output.\n");
+		log("\n");
 		log("    -expect-return <int>\n");
 		log("        Generate an error if popen() does not return specified value.\n");
 		log("        May only be specified once; the final specified value is controlling\n");
@@ -74,8 +83,9 @@ struct ExecPass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		std::string cmd = "";
-		char buf[1024] = {};
 		std::string linebuf = "";
+		std::string stdin_file = "";
+		int buffer_size = 4096;
 		bool flag_cmd = false;
 		bool flag_quiet = false;
 		bool flag_expect_return = false;
@@ -103,7 +113,21 @@ struct ExecPass : public Pass {
 					flag_cmd = true;
 				else if (args[argidx] == "-q")
 					flag_quiet = true;
-				else if (args[argidx] == "-expect-return") {
+				else if (args[argidx] == "-stdin") {
+					++argidx;
+					if (argidx >= args.size())
+						log_cmd_error("No stdin file specified.\n");
+
+					stdin_file = args[argidx];
+				} else if (args[argidx] == "-buffer") {
+					++argidx;
+					if (argidx >= args.size())
+						log_cmd_error("No buffer size specified.\n");
+
+					buffer_size = atoi(args[argidx].c_str());
+					if (buffer_size < 1)
+						log_cmd_error("Invalid buffer size \"%s\".\n", args[argidx].c_str());
+				} else if (args[argidx] == "-expect-return") {
 					flag_expect_return = true;
 					++argidx;
 					if (argidx >= args.size())
@@ -148,24 +172,34 @@ struct ExecPass : public Pass {
 		log_header(design, "Executing command \"%s\".\n", cmd.c_str());
 		log_push();
 
+		if (!stdin_file.empty())
+			cmd = stringf("( %s ) < %s", cmd.c_str(), stdin_file.c_str());
+
 		fflush(stdout);
 		bool keep_reading = true;
 		int status = 0;
 		int retval = 0;
 
 #ifndef EMSCRIPTEN
+		std::vector<char> buf(buffer_size);
 		FILE *f = popen(cmd.c_str(), "r");
 		if (f == nullptr)
 			log_cmd_error("errno %d after popen() returned NULL.\n", errno);
 		while (keep_reading) {
-			keep_reading = (fgets(buf, sizeof(buf), f) != nullptr);
-			linebuf += buf;
-			memset(buf, 0, sizeof(buf));
-
+			// fread() only returns short on EOF or error, so reading in
+			// chunks of the full buffer size keeps the number of syscalls
+			// independent of the line structure of the output
+			size_t nread = fread(buf.data(), 1, buf.size(), f);
+			keep_reading = (nread == buf.size());
+			linebuf.append(buf.data(), nread);
+
+			// process all complete lines in one pass over the buffer
+			// instead of erasing the buffer front once per line
+			size_t begin = 0;
 			auto pos = linebuf.find('\n');
 			while (pos != std::string::npos) {
-				std::string line = linebuf.substr(0, pos);
-				linebuf.erase(0, pos + 1);
+				std::string line = linebuf.substr(begin, pos - begin);
+				begin = pos + 1;
 				if (!flag_quiet)
 					log("%s\n", line.c_str());
 
@@ -174,8 +208,9 @@ struct ExecPass : public Pass {
 						if (std::regex_search(line, x.re))
 							x.matched = true;
 
-				pos = linebuf.find('\n');
+				pos = linebuf.find('\n', begin);
 			}
+			linebuf.erase(0, begin);
 		}
 		status = pclose(f);
 #endif
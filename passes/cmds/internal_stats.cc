@@ -70,6 +70,56 @@ std::optional<uint64_t> current_mem_bytes() {
 #endif
 }
 
+// aggregated hashlib statistics for one class of containers (all cell
+// connection dicts, all module wire dicts, ...)
+struct container_site_t
+{
+	const char *name;
+	uint64_t containers = 0;
+	uint64_t entries = 0;
+	uint64_t slots = 0;
+	uint64_t memory = 0;
+	int longest_chain = 0;
+
+	container_site_t(const char *name) : name(name) { }
+
+	template<typename Container>
+	void add(const Container &container)
+	{
+		containers++;
+		entries += container.size();
+		slots += container.hashtable_slots();
+		memory += container.memory_bytes();
+		longest_chain = max(longest_chain, container.longest_chain());
+	}
+};
+
+std::vector<container_site_t> collect_container_sites(RTLIL::Design *design)
+{
+	container_site_t site_modules("design.modules");
+	container_site_t site_wires("module.wires");
+	container_site_t site_cells("module.cells");
+	container_site_t site_attrs("attributes");
+	container_site_t site_conns("cell.connections");
+	container_site_t site_params("cell.parameters");
+
+	site_modules.add(design->modules_);
+	for (auto module : design->modules()) {
+		site_wires.add(module->wires_);
+		site_cells.add(module->cells_);
+		site_attrs.add(module->attributes);
+		for (auto wire : module->wires())
+			site_attrs.add(wire->attributes);
+		for (auto cell : module->cells()) {
+			site_conns.add(cell->connections_);
+			site_params.add(cell->parameters);
+			site_attrs.add(cell->attributes);
+		}
+	}
+
+	return {site_modules, site_wires, site_cells, site_attrs, site_conns, site_params};
+}
+
 struct InternalStatsPass : public Pass {
 	InternalStatsPass() : Pass("internal_stats", "print internal statistics") { }
 	void help() override
@@ -110,7 +160,65 @@ struct InternalStatsPass : public Pass {
 			log("   \"memory_ast\": %s,\n", std::to_string(ast_bytes).c_str());
 		}
 
-		// stats go here
+		auto sites = collect_container_sites(design);
+
+		if (json_mode) {
+			log("   \"hash_containers\": {\n");
+			for (size_t i = 0; i < sites.size(); i++) {
+				auto &site = sites[i];
+				log("      %s: { \"containers\": %llu, \"entries\": %llu, \"slots\": %llu, \"memory\": %llu, \"longest_chain\": %d }%s\n",
+						json11::Json(site.name).dump().c_str(),
+						(unsigned long long)site.containers, (unsigned long long)site.entries,
+						(unsigned long long)site.slots, (unsigned long long)site.memory,
+						site.longest_chain, i+1 < sites.size() ? "," : "");
+			}
+			log("   }\n");
+		} else {
+			log("\n");
+			log("Hash container statistics by site:\n");
+			log("  %-20s %10s %12s %12s %14s %8s\n", "site", "count", "entries", "slots", "memory[B]", "chain");
+			for (auto &site : sites)
+				log("  %-20s %10llu %12llu %12llu %14llu %8d\n", site.name,
+						(unsigned long long)site.containers, (unsigned long long)site.entries,
+						(unsigned long long)site.slots, (unsigned long long)site.memory,
+						site.longest_chain);
+		}
+
+#ifdef YOSYS_HASHLIB_STATS
+		auto &hs = hashlib::hashlib_stats;
+		if (json_mode) {
+			log("   ,\"hashlib\": {\n");
+			log("      \"lookups\": %llu,\n", (unsigned long long)hs.lookups);
+			log("      \"probes\": %llu,\n", (unsigned long long)hs.probes);
+			log("      \"rehashes\": %llu,\n", (unsigned long long)hs.rehashes);
+			log("      \"chain_rehashes\": %llu,\n", (unsigned long long)hs.chain_rehashes);
+			log("      \"probe_hist\": [");
+			for (int i = 0; i < hashlib::hashlib_stats_t::probe_hist_buckets; i++)
+				log("%s%llu", i ? ", " : "", (unsigned long long)hs.probe_hist[i]);
+			log("]\n");
+			log("   }\n");
+		} else {
+			log("\n");
+			log("Global hashlib counters (since process start):\n");
+			log("  lookups: %llu, probes: %llu (%.2f per lookup)\n",
+					(unsigned long long)hs.lookups, (unsigned long long)hs.probes,
+					hs.lookups ? (double)hs.probes / (double)hs.lookups : 0.0);
+			log("  rehashes: %llu, of which %llu forced by overlong chains\n",
+					(unsigned long long)hs.rehashes, (unsigned long long)hs.chain_rehashes);
+			log("  probe length histogram:\n");
+			for (int i = 0; i < hashlib::hashlib_stats_t::probe_hist_buckets; i++)
+				if (hs.probe_hist[i] != 0)
+					log("    %3d%s: %llu\n", i, i == hashlib::hashlib_stats_t::probe_hist_buckets-1 ? "+" : " ",
+							(unsigned long long)hs.probe_hist[i]);
+		}
+#else
+		if (!json_mode) {
+			log("\n");
+			log("Global hashlib counters are not compiled in. Rebuild with\n");
+			log("CXXFLAGS += -DYOSYS_HASHLIB_STATS to collect probe length histograms\n");
+			log("and rehash counts.\n");
+		}
+#endif
 
 		if (json_mode) {
 			log("\n");
@@ -0,0 +1,209 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct IsynthPass : public Pass {
+	IsynthPass() : Pass("isynth", "incrementally re-synthesize changed modules into a checkpoint") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    isynth -checkpoint <name> [options]\n");
+		log("\n");
+		log("Re-synthesize only the modules in the current design and splice the results\n");
+		log("into the synthesized netlist saved with `design -save <name>` after the last\n");
+		log("full run. The current design must hold the freshly elaborated modules from\n");
+		log("the changed source files, e.g.:\n");
+		log("\n");
+		log("    design -reset\n");
+		log("    read_verilog changed_file.v\n");
+		log("    isynth -checkpoint last_run\n");
+		log("\n");
+		log("Unchanged submodules instantiated by the changed modules are temporarily\n");
+		log("added as black box interfaces so the synthesis script can resolve the\n");
+		log("hierarchy; afterwards all unchanged modules are carried over from the\n");
+		log("checkpoint unmodified.\n");
+		log("\n");
+		log("    -checkpoint <name>\n");
+		log("        saved design holding the previous synthesized netlist (required)\n");
+		log("\n");
+		log("    -run <command>\n");
+		log("        synthesis command to run on the changed modules (default: synth)\n");
+		log("\n");
+		log("    -equiv\n");
+		log("        verify each re-synthesized module against its elaborated source\n");
+		log("        using equiv_make/equiv_simple/equiv_status; this covers plain\n");
+		log("        logic and registers, not mapped memories\n");
+		log("\n");
+		log("After splicing, every instantiation of a changed module in an unchanged\n");
+		log("module is checked against the new interface; a removed port or a changed\n");
+		log("port width is an error, since the parent module then needs re-synthesis\n");
+		log("as well.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		std::string checkpoint_name;
+		std::string run_command = "synth";
+		bool flag_equiv = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-checkpoint" && argidx+1 < args.size()) {
+				checkpoint_name = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-run" && argidx+1 < args.size()) {
+				run_command = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-equiv") {
+				flag_equiv = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (checkpoint_name.empty())
+			log_cmd_error("Option -checkpoint is required.\n");
+		if (saved_designs.count(checkpoint_name) == 0)
+			log_cmd_error("No saved design '%s' found!\n", checkpoint_name.c_str());
+
+		RTLIL::Design *ckpt = saved_designs.at(checkpoint_name);
+
+		pool<IdString> changed;
+		for (auto module : design->modules())
+			if (!module->get_blackbox_attribute())
+				changed.insert(module->name);
+
+		if (changed.empty())
+			log_cmd_error("Current design contains no modules; read the changed source files first.\n");
+
+		log_header(design, "Executing ISYNTH pass (incremental re-synthesis).\n");
+		log_push();
+
+		for (auto name : changed)
+			log("Re-synthesizing changed module %s.\n", log_id(name));
+
+		// keep the elaborated sources around for -equiv before the synthesis
+		// script rewrites them
+		std::unique_ptr<RTLIL::Design> gold;
+		if (flag_equiv) {
+			gold.reset(new RTLIL::Design);
+			for (auto name : changed)
+				gold->add(design->module(name)->clone());
+		}
+
+		// temporary black box interfaces for unchanged submodules, so the
+		// synthesis script can resolve the hierarchy of the changed cone
+		pool<IdString> stubs;
+		for (auto name : changed)
+			for (auto cell : design->module(name)->cells())
+				if (design->module(cell->type) == nullptr && ckpt->module(cell->type) != nullptr && !stubs.count(cell->type)) {
+					RTLIL::Module *stub = ckpt->module(cell->type)->clone();
+					design->add(stub);
+					stub->makeblackbox();
+					stubs.insert(cell->type);
+				}
+
+		Pass::call(design, run_command);
+
+		if (flag_equiv)
+			for (auto name : changed)
+			{
+				log_header(design, "Verifying re-synthesized module %s against its source.\n", log_id(name));
+
+				std::unique_ptr<RTLIL::Design> edesign(new RTLIL::Design);
+
+				RTLIL::Module *gold_mod = gold->module(name)->clone();
+				gold_mod->name = ID(isynth_gold);
+				edesign->add(gold_mod);
+
+				RTLIL::Module *gate_mod = design->module(name)->clone();
+				gate_mod->name = ID(isynth_gate);
+				edesign->add(gate_mod);
+
+				for (auto mod : {gold_mod, gate_mod})
+					for (auto cell : mod->cells())
+						if (edesign->module(cell->type) == nullptr) {
+							RTLIL::Module *box = design->module(cell->type) ? design->module(cell->type) : ckpt->module(cell->type);
+							if (box == nullptr)
+								continue;
+							RTLIL::Module *stub = box->clone();
+							edesign->add(stub);
+							stub->makeblackbox();
+						}
+
+				Pass::call(edesign.get(), "proc");
+				Pass::call(edesign.get(), "equiv_make isynth_gold isynth_gate isynth_equiv");
+				Pass::call(edesign.get(), "equiv_simple isynth_equiv");
+				Pass::call(edesign.get(), "equiv_status -assert isynth_equiv");
+			}
+
+		// drop the interface stubs again, then carry the unchanged modules
+		// over from the checkpoint
+		for (auto name : stubs) {
+			RTLIL::Module *stub = design->module(name);
+			if (stub != nullptr && stub->get_blackbox_attribute())
+				design->remove(stub);
+		}
+
+		int spliced = 0;
+		for (auto mod : ckpt->modules())
+			if (design->module(mod->name) == nullptr) {
+				design->add(mod->clone());
+				spliced++;
+			}
+
+		// boundary verification: instantiations of changed modules in
+		// unchanged modules must still match the re-synthesized interface
+		for (auto mod : design->modules()) {
+			if (changed.count(mod->name))
+				continue;
+			for (auto cell : mod->cells()) {
+				if (!changed.count(cell->type))
+					continue;
+				RTLIL::Module *target = design->module(cell->type);
+				for (auto &conn : cell->connections()) {
+					RTLIL::Wire *port = target->wire(conn.first);
+					if (port == nullptr || port->port_id == 0)
+						log_error("Instance %s in unchanged module %s connects to port %s, which no longer exists on "
+								"re-synthesized module %s. Re-synthesize the parent module as well.\n",
+								log_id(cell), log_id(mod), log_id(conn.first), log_id(target));
+					if (port->width != GetSize(conn.second))
+						log_error("Port %s of re-synthesized module %s changed width (%d bits, instance %s in unchanged "
+								"module %s connects %d bits). Re-synthesize the parent module as well.\n",
+								log_id(port), log_id(target), port->width, log_id(cell), log_id(mod), GetSize(conn.second));
+				}
+			}
+		}
+
+		log("Re-synthesized %d changed modules, spliced %d unchanged modules from checkpoint '%s'.\n",
+				GetSize(changed), spliced, checkpoint_name.c_str());
+		log_pop();
+	}
+} IsynthPass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,145 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/journal.h"
+#include "kernel/log.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct JournalPass : public Pass {
+	JournalPass() : Pass("journal", "record netlist changes for incremental consumers") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    journal -start\n");
+		log("\n");
+		log("Attach a change journal to the current design. While attached, the journal\n");
+		log("records the events the RTLIL monitor API reports (module add/del, cell port\n");
+		log("and module connection rewrites, blackouts) plus one marker per executed\n");
+		log("command, so external incremental tools can consume the delta since the last\n");
+		log("export instead of diffing full netlists. Cell and wire creation are not\n");
+		log("reported by the monitor API; consumers should re-export at the granularity\n");
+		log("of the touched modules listed by -status.\n");
+		log("\n");
+		log("    journal -stop\n");
+		log("\n");
+		log("Detach the journal and discard the recorded events.\n");
+		log("\n");
+		log("    journal -clear\n");
+		log("\n");
+		log("Discard the recorded events but keep recording.\n");
+		log("\n");
+		log("    journal -status\n");
+		log("\n");
+		log("Print the number of recorded events per type and the touched modules.\n");
+		log("\n");
+		log("    journal -write <filename>\n");
+		log("\n");
+		log("Write the recorded events to a compact binary file: the magic \"YSJN\",\n");
+		log("a 32-bit format version (1) and a 32-bit event count, followed per event\n");
+		log("by one type byte and three 32-bit-length-prefixed strings (module, object,\n");
+		log("detail). All integers are little endian.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		std::string write_filename;
+		bool start_mode = false, stop_mode = false, clear_mode = false, status_mode = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-start") {
+				start_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-stop") {
+				stop_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-clear") {
+				clear_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-status") {
+				status_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-write" && argidx+1 < args.size()) {
+				write_filename = args[++argidx];
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		if (!start_mode && !stop_mode && !clear_mode && !status_mode && write_filename.empty())
+			log_cmd_error("Missing option: one of -start, -stop, -clear, -status or -write is required.\n");
+
+		if (start_mode) {
+			DesignJournal::start(design);
+			log("Journal attached to the current design.\n");
+		}
+
+		DesignJournal *journal = DesignJournal::get(design);
+		if (journal == nullptr && (stop_mode || clear_mode || status_mode || !write_filename.empty()))
+			log_cmd_error("No journal is attached to the current design. Use 'journal -start' first.\n");
+
+		if (status_mode) {
+			int counts[7] = {0};
+			for (auto &event : journal->events)
+				counts[event.type]++;
+			log("Recorded %d journal event(s):\n", GetSize(journal->events));
+			log("  pass markers:       %d\n", counts[DesignJournal::EVENT_PASS]);
+			log("  module add:         %d\n", counts[DesignJournal::EVENT_MODULE_ADD]);
+			log("  module del:         %d\n", counts[DesignJournal::EVENT_MODULE_DEL]);
+			log("  cell connects:      %d\n", counts[DesignJournal::EVENT_CELL_CONNECT]);
+			log("  module connects:    %d\n", counts[DesignJournal::EVENT_MODULE_CONNECT]);
+			log("  blackouts:          %d\n", counts[DesignJournal::EVENT_BLACKOUT]);
+			auto touched = journal->touched_modules();
+			log("Touched modules (%d):\n", GetSize(touched));
+			for (auto &name : touched)
+				log("  %s\n", name.c_str());
+			design->scratchpad_set_int("journal.num_events", GetSize(journal->events));
+			design->scratchpad_set_int("journal.num_touched_modules", GetSize(touched));
+		}
+
+		if (!write_filename.empty()) {
+			rewrite_filename(write_filename);
+			std::ofstream f(write_filename, std::ofstream::trunc | std::ofstream::binary);
+			if (f.fail())
+				log_cmd_error("Can't open file `%s' for writing: %s\n", write_filename.c_str(), strerror(errno));
+			journal->write_binary(f);
+			log("Wrote %d journal event(s) to %s.\n", GetSize(journal->events), write_filename.c_str());
+		}
+
+		if (clear_mode)
+			journal->clear();
+
+		if (stop_mode) {
+			DesignJournal::stop(design);
+			log("Journal detached from the current design.\n");
+		}
+	}
+} JournalPass;
+
+PRIVATE_NAMESPACE_END
@@ -54,6 +54,12 @@ struct LoggerPass : public Pass {
 		log("    -[no]debug\n");
 		log("        globally enable/disable debug log messages.\n");
 		log("\n");
+		log("    -[no]async\n");
+		log("        enable/disable writing log output from a background thread. Messages\n");
+		log("        are queued in a ring buffer and written to the log files by a writer\n");
+		log("        thread, so slow log sinks do not stall the command being executed.\n");
+		log("        Errors and log_flush() force a drain of the queue first.\n");
+		log("\n");
 		log("    -experimental <feature>\n");
 		log("        do not print warnings for the specified experimental feature\n");
 		log("\n");
@@ -143,6 +149,20 @@ struct LoggerPass : public Pass {
 				log("Disabled debug log messages.\n");
 				continue;
 			}
+			if (args[argidx] == "-async") {
+				if (!log_async) {
+					log_async_begin();
+					log("Enabled asynchronous log output.\n");
+				}
+				continue;
+			}
+			if (args[argidx] == "-noasync") {
+				if (log_async) {
+					log_async_end();
+					log("Disabled asynchronous log output.\n");
+				}
+				continue;
+			}
 			if (args[argidx] == "-experimental" && argidx+1 < args.size()) {
 				std::string value = args[++argidx];
 				log("Added '%s' experimental ignore list.\n", value.c_str());
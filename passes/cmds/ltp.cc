@@ -20,6 +20,7 @@
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -137,10 +138,100 @@ struct LtpWorker
 		if (bit2ff.count(maxbit))
 			log("%5s: %s (via %s)\n", "ff", log_signal(get<0>(bit2ff.at(maxbit))), log_id(get<1>(bit2ff.at(maxbit))));
 	}
+
+	// Endpoint-seeded query: only the fan-in cone of each endpoint bit is
+	// visited, and the per-bit depth memo prunes every path that reaches an
+	// already-solved bit, so the cost is the cone size instead of the whole
+	// module.
+	struct endpoint_result_t
+	{
+		SigBit endpoint;
+		int maxlvl = -1;
+		dict<SigBit, tuple<int, SigBit, Cell*>> depth; // level, fanin bit, via cell
+		pool<SigBit> loop_bits;
+	};
+
+	dict<SigBit, dict<SigBit, Cell*>> bit2bits_rev;
+
+	int backward_runner(endpoint_result_t &res, pool<SigBit> &busy, SigBit bit)
+	{
+		auto it = res.depth.find(bit);
+		if (it != res.depth.end())
+			return get<0>(it->second);
+
+		if (busy.count(bit) > 0) {
+			res.loop_bits.insert(bit);
+			return 0;
+		}
+
+		int level = 0;
+		SigBit from = State::Sx;
+		Cell *via = nullptr;
+
+		auto fanins = bit2bits_rev.find(bit);
+		if (fanins != bit2bits_rev.end()) {
+			busy.insert(bit);
+			for (auto &f : fanins->second) {
+				int l = backward_runner(res, busy, f.first) + 1;
+				if (l > level) {
+					level = l;
+					from = f.first;
+					via = f.second;
+				}
+			}
+			busy.erase(bit);
+		}
+
+		res.depth[bit] = tuple<int, SigBit, Cell*>(level, from, via);
+		return level;
+	}
+
+	void print_endpoint_path(endpoint_result_t &res, SigBit bit)
+	{
+		auto &bitinfo = res.depth.at(bit);
+		if (get<2>(bitinfo)) {
+			print_endpoint_path(res, get<1>(bitinfo));
+			log("%5d: %s (via %s)\n", get<0>(bitinfo), log_signal(bit), log_id(get<2>(bitinfo)));
+		} else {
+			log("%5d: %s\n", get<0>(bitinfo), log_signal(bit));
+		}
+	}
+
+	void run_endpoints(const std::vector<SigBit> &endpoints)
+	{
+		for (auto &it : bit2bits)
+			for (auto &d : it.second)
+				bit2bits_rev[d.first][it.first] = d.second;
+
+		// one worker per endpoint; workers only read the prebuilt reverse
+		// graph and fill their own result slot, all logging happens below
+		std::vector<endpoint_result_t> results(endpoints.size());
+		int num_threads = ThreadPool::thread_count(design);
+		ThreadPool::run(num_threads, GetSize(endpoints), [&](int idx) {
+			endpoint_result_t &res = results[idx];
+			res.endpoint = endpoints[idx];
+			pool<SigBit> busy;
+			res.maxlvl = backward_runner(res, busy, res.endpoint);
+		});
+
+		for (auto &res : results)
+		{
+			for (auto bit : res.loop_bits)
+				log_warning("Detected loop at %s in %s\n", log_signal(bit), log_id(module));
+
+			log("\n");
+			log("Longest topological path into %s in %s (length=%d):\n",
+					log_signal(res.endpoint), log_id(module), res.maxlvl);
+			print_endpoint_path(res, res.endpoint);
+
+			if (bit2ff.count(res.endpoint))
+				log("%5s: %s (via %s)\n", "ff", log_signal(get<0>(bit2ff.at(res.endpoint))), log_id(get<1>(bit2ff.at(res.endpoint))));
+		}
+	}
 };
 
 struct LtpPass : public Pass {
-	LtpPass() : Pass("ltp", "print longest topological path") { }
+	LtpPass() : Pass("ltp", "print longest topological path") { readonly(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -153,10 +244,17 @@ struct LtpPass : public Pass {
 		log("    -noff\n");
 		log("        automatically exclude FF cell types\n");
 		log("\n");
+		log("    -endpoint <wirename>\n");
+		log("        instead of analyzing the whole module, print the longest path ending\n");
+		log("        in the given wire. May be used multiple times. Only the fan-in cones\n");
+		log("        of the endpoints are traversed (one worker per endpoint, thread count\n");
+		log("        from the 'threads' scratchpad variable).\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool noff = false;
+		std::vector<std::string> endpoint_names;
 
 		log_header(design, "Executing LTP pass (find longest path).\n");
 
@@ -166,19 +264,45 @@ struct LtpPass : public Pass {
 				noff = true;
 				continue;
 			}
+			if (args[argidx] == "-endpoint" && argidx+1 < args.size()) {
+				endpoint_names.push_back(args[++argidx]);
+				continue;
+			}
 			break;
 		}
 
 		extra_args(args, argidx, design);
 
+		bool found_endpoint = endpoint_names.empty();
+
 		for (Module *module : design->selected_modules())
 		{
 			if (module->has_processes_warn())
 				continue;
 
 			LtpWorker worker(module, noff);
-			worker.run();
+
+			if (endpoint_names.empty()) {
+				worker.run();
+				continue;
+			}
+
+			std::vector<SigBit> endpoints;
+			for (auto &name : endpoint_names) {
+				RTLIL::Wire *wire = module->wire(RTLIL::escape_id(name));
+				if (wire == nullptr)
+					continue;
+				for (auto bit : worker.sigmap(wire))
+					endpoints.push_back(bit);
+				found_endpoint = true;
+			}
+
+			if (!endpoints.empty())
+				worker.run_endpoints(endpoints);
 		}
+
+		if (!found_endpoint)
+			log_warning("None of the given endpoint wires were found in the selected modules.\n");
 	}
 } LtpPass;
 
@@ -0,0 +1,519 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/json.h"
+#include "kernel/threadpool.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+// Diff result for one module pair. Workers fill these with plain strings
+// so all logging and JSON output can happen on the main thread.
+struct ModuleDiffResult
+{
+	std::string name;
+	std::vector<std::pair<std::string, std::string>> cells_added;    // name, type
+	std::vector<std::pair<std::string, std::string>> cells_removed;  // name, type
+	std::vector<std::pair<std::string, std::string>> cells_changed;  // name, what changed
+	std::vector<std::tuple<std::string, std::string, std::string>> cells_renamed; // old name, new name, type
+	std::vector<std::string> wires_added, wires_removed;
+
+	bool clean() const {
+		return cells_added.empty() && cells_removed.empty() && cells_changed.empty() &&
+				cells_renamed.empty() && wires_added.empty() && wires_removed.empty();
+	}
+};
+
+// IdStrings are interned in a process-global table, so names from two
+// different designs compare directly; only Wire*/Cell* pointers and
+// SigBits must not cross designs.
+static bool same_connections(SigMap &sigmap_a, SigMap &sigmap_b, Cell *a, Cell *b)
+{
+	if (GetSize(a->connections()) != GetSize(b->connections()))
+		return false;
+
+	for (auto &conn : a->connections()) {
+		if (!b->hasPort(conn.first))
+			return false;
+		SigSpec sig_a = sigmap_a(conn.second);
+		SigSpec sig_b = sigmap_b(b->getPort(conn.first));
+		if (GetSize(sig_a) != GetSize(sig_b))
+			return false;
+		for (int i = 0; i < GetSize(sig_a); i++) {
+			SigBit bit_a = sig_a[i], bit_b = sig_b[i];
+			if ((bit_a.wire == nullptr) != (bit_b.wire == nullptr))
+				return false;
+			if (bit_a.wire == nullptr) {
+				if (bit_a.data != bit_b.data)
+					return false;
+			} else {
+				if (bit_a.wire->name != bit_b.wire->name || bit_a.offset != bit_b.offset)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool same_parameters(Cell *a, Cell *b)
+{
+	if (GetSize(a->parameters) != GetSize(b->parameters))
+		return false;
+	for (auto &param : a->parameters) {
+		auto it = b->parameters.find(param.first);
+		if (it == b->parameters.end() || it->second != param.second)
+			return false;
+	}
+	return true;
+}
+
+// Structural cell signatures in the spirit of the equiv_struct merge keys:
+// the initial signature covers the iteration-invariant part of a cell (type,
+// parameters, port names and sizes, constant input bits), refinement rounds
+// then mix in the signatures of the neighbors on each connected net, with
+// module ports as anchors. Per-net aggregate sums keep each round linear in
+// the number of connection bits, so high-fanout nets (clocks, resets) do not
+// blow up the runtime.
+struct StructSignatures
+{
+	SigMap sigmap;
+	std::vector<Cell*> cells;
+	dict<Cell*, int> cell_index;
+	// levels[r] holds the signatures after r refinement rounds; keeping
+	// every level lets the matcher fall back to a coarser neighborhood
+	// when an edit near a renamed cell perturbed its refined signature
+	std::vector<std::vector<uint64_t>> levels;
+
+	StructSignatures(Module *module, int rounds) : sigmap(module)
+	{
+		for (auto cell : module->cells()) {
+			cell_index[cell] = GetSize(cells);
+			cells.push_back(cell);
+		}
+
+		std::vector<uint64_t> signature(GetSize(cells));
+		for (int i = 0; i < GetSize(cells); i++)
+			signature[i] = initial_signature(cells[i]);
+		levels.push_back(signature);
+
+		for (int round = 0; round < rounds; round++)
+			levels.push_back(refine(levels.back()));
+	}
+
+	static uint64_t mix(uint64_t a, uint64_t b)
+	{
+		Hasher h;
+		h.eat(a);
+		h.eat(b);
+		uint64_t lo = h.yield();
+		h.eat(lo);
+		return (uint64_t)h.yield() << 32 | lo;
+	}
+
+	uint64_t initial_signature(Cell *cell)
+	{
+		Hasher h;
+		h.eat(cell->type);
+
+		std::vector<std::pair<IdString, Const>> params(cell->parameters.begin(), cell->parameters.end());
+		std::sort(params.begin(), params.end());
+		h.eat(params);
+
+		std::vector<IdString> ports;
+		for (auto &conn : cell->connections())
+			ports.push_back(conn.first);
+		std::sort(ports.begin(), ports.end());
+
+		for (auto &port : ports) {
+			h.eat(port);
+			SigSpec sig = sigmap(cell->getPort(port));
+			h.eat(GetSize(sig));
+			for (auto bit : sig)
+				h.eat(bit.wire == nullptr ? (int)bit.data : -1);
+		}
+		return mix(h.yield(), 1);
+	}
+
+	// signature contribution a cell makes to one of its nets, tagged with
+	// the port and bit position so a net "knows" how its neighbors use it
+	static uint64_t contribution(const std::vector<uint64_t> &signature, int idx, IdString port, int bitpos)
+	{
+		Hasher h;
+		h.eat(port);
+		h.eat(bitpos);
+		return signature[idx] + mix(h.yield(), 2);
+	}
+
+	// anchor value of a net that is independent of the connected cells:
+	// module port bits keep their identity across the two designs
+	static uint64_t net_anchor(SigBit bit)
+	{
+		if (bit.wire == nullptr || bit.wire->port_id == 0)
+			return 0;
+		Hasher h;
+		h.eat(bit.wire->name);
+		h.eat(bit.offset);
+		return mix(h.yield(), 3);
+	}
+
+	std::vector<uint64_t> refine(const std::vector<uint64_t> &signature)
+	{
+		dict<SigBit, uint64_t> net_sum;
+		for (int i = 0; i < GetSize(cells); i++)
+			for (auto &conn : cells[i]->connections()) {
+				SigSpec sig = sigmap(conn.second);
+				for (int k = 0; k < GetSize(sig); k++)
+					if (sig[k].wire != nullptr)
+						net_sum[sig[k]] += contribution(signature, i, conn.first, k);
+			}
+
+		std::vector<uint64_t> next(GetSize(cells));
+		for (int i = 0; i < GetSize(cells); i++) {
+			uint64_t acc = signature[i];
+			for (auto &conn : cells[i]->connections()) {
+				SigSpec sig = sigmap(conn.second);
+				for (int k = 0; k < GetSize(sig); k++)
+					if (sig[k].wire != nullptr)
+						acc = mix(acc, net_sum.at(sig[k]) - contribution(signature, i, conn.first, k) + net_anchor(sig[k]));
+			}
+			next[i] = acc;
+		}
+		return next;
+	}
+};
+
+static void diff_module(Module *old_mod, Module *new_mod, int rounds, ModuleDiffResult &result)
+{
+	SigMap old_sigmap(old_mod), new_sigmap(new_mod);
+
+	std::vector<Cell*> only_old, only_new;
+
+	for (auto cell : old_mod->cells()) {
+		Cell *other = new_mod->cell(cell->name);
+		if (other == nullptr) {
+			only_old.push_back(cell);
+			continue;
+		}
+		if (cell->type != other->type)
+			result.cells_changed.push_back({cell->name.str(), "type"});
+		else if (!same_parameters(cell, other))
+			result.cells_changed.push_back({cell->name.str(), "parameters"});
+		else if (!same_connections(old_sigmap, new_sigmap, cell, other))
+			result.cells_changed.push_back({cell->name.str(), "connections"});
+	}
+
+	for (auto cell : new_mod->cells())
+		if (old_mod->cell(cell->name) == nullptr)
+			only_new.push_back(cell);
+
+	// structural matching of the leftovers: equal signatures on both sides
+	// are reported as renames/moves instead of a remove/add pair. The most
+	// refined level (largest distinguishing neighborhood) is tried first;
+	// cells left over because a nearby edit perturbed their refined
+	// signature are retried with the coarser levels.
+	if (!only_old.empty() && !only_new.empty()) {
+		StructSignatures old_sigs(old_mod, rounds), new_sigs(new_mod, rounds);
+
+		for (int level = rounds; level >= 0 && !only_old.empty() && !only_new.empty(); level--)
+		{
+			dict<uint64_t, std::vector<Cell*>> old_groups, new_groups;
+			for (auto cell : only_old)
+				old_groups[old_sigs.levels[level][old_sigs.cell_index.at(cell)]].push_back(cell);
+			for (auto cell : only_new)
+				new_groups[new_sigs.levels[level][new_sigs.cell_index.at(cell)]].push_back(cell);
+
+			only_old.clear(), only_new.clear();
+
+			for (auto &group : old_groups) {
+				auto it = new_groups.find(group.first);
+				std::vector<Cell*> &old_cells = group.second;
+				std::vector<Cell*> *new_cells = it != new_groups.end() ? &it->second : nullptr;
+
+				auto by_name = [](Cell *a, Cell *b) { return a->name < b->name; };
+				std::sort(old_cells.begin(), old_cells.end(), by_name);
+				if (new_cells)
+					std::sort(new_cells->begin(), new_cells->end(), by_name);
+
+				int matched = new_cells ? std::min(GetSize(old_cells), GetSize(*new_cells)) : 0;
+				for (int i = 0; i < matched; i++)
+					if (old_cells[i]->type == new_cells->at(i)->type)
+						result.cells_renamed.push_back({old_cells[i]->name.str(),
+								new_cells->at(i)->name.str(), old_cells[i]->type.str()});
+					else
+						only_old.push_back(old_cells[i]), only_new.push_back(new_cells->at(i));
+				for (int i = matched; i < GetSize(old_cells); i++)
+					only_old.push_back(old_cells[i]);
+				if (new_cells) {
+					for (int i = matched; i < GetSize(*new_cells); i++)
+						only_new.push_back(new_cells->at(i));
+					new_groups.erase(it);
+				}
+			}
+			for (auto &group : new_groups)
+				for (auto cell : group.second)
+					only_new.push_back(cell);
+		}
+	}
+
+	for (auto cell : only_old)
+		result.cells_removed.push_back({cell->name.str(), cell->type.str()});
+	for (auto cell : only_new)
+		result.cells_added.push_back({cell->name.str(), cell->type.str()});
+
+	for (auto wire : old_mod->wires())
+		if (new_mod->wire(wire->name) == nullptr)
+			result.wires_removed.push_back(wire->name.str());
+	for (auto wire : new_mod->wires())
+		if (old_mod->wire(wire->name) == nullptr)
+			result.wires_added.push_back(wire->name.str());
+
+	auto sort_pairs = [](std::vector<std::pair<std::string, std::string>> &v) { std::sort(v.begin(), v.end()); };
+	sort_pairs(result.cells_added), sort_pairs(result.cells_removed), sort_pairs(result.cells_changed);
+	std::sort(result.cells_renamed.begin(), result.cells_renamed.end());
+	std::sort(result.wires_added.begin(), result.wires_added.end());
+	std::sort(result.wires_removed.begin(), result.wires_removed.end());
+}
+
+struct NetdiffPass : public Pass {
+	NetdiffPass() : Pass("netdiff", "structural diff between two designs") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    netdiff [options] <old_design> [<new_design>]\n");
+		log("\n");
+		log("Compare two designs object by object and report added, removed, changed and\n");
+		log("renamed cells as well as added and removed wires per module. The design names\n");
+		log("refer to designs stored with 'design -save'; when <new_design> is omitted the\n");
+		log("current design is compared against <old_design>.\n");
+		log("\n");
+		log("Objects are matched by name first. Cells that exist on only one side are then\n");
+		log("matched by structural signature (cell type, parameters, port sizes, constant\n");
+		log("bits, iteratively refined with the signatures of the neighbors on each net,\n");
+		log("anchored at module ports) and equal signatures are reported as renames rather\n");
+		log("than a remove/add pair. Matching starts at the most refined signature and\n");
+		log("falls back to coarser ones for cells whose neighborhood also changed. Module\n");
+		log("pairs are diffed in parallel on the number of threads given by the 'threads'\n");
+		log("scratchpad variable.\n");
+		log("\n");
+		log("    -json <filename>\n");
+		log("        write the diff as a machine-readable JSON report to the given file\n");
+		log("\n");
+		log("    -rounds <integer>\n");
+		log("        number of signature refinement rounds for structural matching\n");
+		log("        (default: 3). more rounds distinguish cells by a larger neighborhood\n");
+		log("        but cost one pass over all connections each.\n");
+		log("\n");
+		log("    -quiet\n");
+		log("        only log the per-module summary counts, not the individual objects\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		std::string json_filename;
+		int rounds = 3;
+		bool quiet = false;
+
+		log_header(design, "Executing NETDIFF pass (structural diff between two designs).\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-json" && argidx+1 < args.size()) {
+				json_filename = args[++argidx];
+				rewrite_filename(json_filename);
+				continue;
+			}
+			if (args[argidx] == "-rounds" && argidx+1 < args.size()) {
+				rounds = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-quiet") {
+				quiet = true;
+				continue;
+			}
+			break;
+		}
+
+		if (argidx >= args.size())
+			log_cmd_error("Missing name of the design to compare against.\n");
+
+		std::string old_name = args[argidx++];
+		auto old_it = saved_designs.find(old_name);
+		if (old_it == saved_designs.end())
+			log_cmd_error("No saved design '%s' found (see 'design -save').\n", old_name.c_str());
+		Design *old_design = old_it->second;
+
+		std::string new_name = "<current>";
+		Design *new_design = design;
+		if (argidx < args.size()) {
+			new_name = args[argidx++];
+			auto new_it = saved_designs.find(new_name);
+			if (new_it == saved_designs.end())
+				log_cmd_error("No saved design '%s' found (see 'design -save').\n", new_name.c_str());
+			new_design = new_it->second;
+		}
+
+		if (argidx != args.size())
+			log_cmd_error("Extra argument `%s'.\n", args[argidx].c_str());
+
+		if (rounds < 0)
+			log_cmd_error("Invalid -rounds value.\n");
+
+		std::vector<std::string> modules_added, modules_removed;
+		std::vector<std::pair<Module*, Module*>> pairs;
+
+		for (auto module : old_design->modules())
+			if (new_design->module(module->name) == nullptr)
+				modules_removed.push_back(module->name.str());
+		for (auto module : new_design->modules()) {
+			Module *old_mod = old_design->module(module->name);
+			if (old_mod == nullptr)
+				modules_added.push_back(module->name.str());
+			else
+				pairs.push_back({old_mod, module});
+		}
+		std::sort(modules_added.begin(), modules_added.end());
+		std::sort(modules_removed.begin(), modules_removed.end());
+		std::sort(pairs.begin(), pairs.end(),
+				[](const std::pair<Module*, Module*> &a, const std::pair<Module*, Module*> &b) {
+					return a.first->name < b.first->name;
+				});
+
+		std::vector<ModuleDiffResult> results(GetSize(pairs));
+		int num_threads = ThreadPool::thread_count(design);
+		ThreadPool::run(num_threads, GetSize(pairs), [&](int i) {
+			results[i].name = pairs[i].first->name.str();
+			diff_module(pairs[i].first, pairs[i].second, rounds, results[i]);
+		});
+
+		int total_added = 0, total_removed = 0, total_changed = 0, total_renamed = 0;
+
+		for (auto &name : modules_removed)
+			log("Removed module %s.\n", name.c_str());
+		for (auto &name : modules_added)
+			log("Added module %s.\n", name.c_str());
+
+		for (auto &result : results) {
+			if (result.clean())
+				continue;
+			log("Module %s: %d cells added, %d removed, %d changed, %d renamed, %d wires added, %d removed.\n",
+					result.name.c_str(), GetSize(result.cells_added), GetSize(result.cells_removed),
+					GetSize(result.cells_changed), GetSize(result.cells_renamed),
+					GetSize(result.wires_added), GetSize(result.wires_removed));
+			if (!quiet) {
+				for (auto &it : result.cells_removed)
+					log("  removed cell %s (%s)\n", it.first.c_str(), it.second.c_str());
+				for (auto &it : result.cells_added)
+					log("  added cell %s (%s)\n", it.first.c_str(), it.second.c_str());
+				for (auto &it : result.cells_changed)
+					log("  changed cell %s (%s)\n", it.first.c_str(), it.second.c_str());
+				for (auto &it : result.cells_renamed)
+					log("  renamed cell %s -> %s (%s)\n", std::get<0>(it).c_str(),
+							std::get<1>(it).c_str(), std::get<2>(it).c_str());
+				for (auto &it : result.wires_removed)
+					log("  removed wire %s\n", it.c_str());
+				for (auto &it : result.wires_added)
+					log("  added wire %s\n", it.c_str());
+			}
+			total_added += GetSize(result.cells_added);
+			total_removed += GetSize(result.cells_removed);
+			total_changed += GetSize(result.cells_changed);
+			total_renamed += GetSize(result.cells_renamed);
+		}
+
+		log("Netdiff summary: %d modules added, %d removed; %d cells added, %d removed, %d changed, %d renamed.\n",
+				GetSize(modules_added), GetSize(modules_removed), total_added, total_removed,
+				total_changed, total_renamed);
+
+		if (json_filename.empty())
+			return;
+
+		PrettyJson json;
+		if (!json.write_to_file(json_filename))
+			log_error("Can't open file `%s' for writing: %s\n", json_filename.c_str(), strerror(errno));
+
+		json.begin_object();
+		json.entry("version", "Yosys netdiff");
+		json.entry("generator", yosys_version_str);
+		json.entry("old", old_name);
+		json.entry("new", new_name);
+		json.name("modules_added");
+		json.begin_array();
+		for (auto &name : modules_added)
+			json.value(name);
+		json.end_array();
+		json.name("modules_removed");
+		json.begin_array();
+		for (auto &name : modules_removed)
+			json.value(name);
+		json.end_array();
+		json.name("modules");
+		json.begin_array();
+		for (auto &result : results) {
+			if (result.clean())
+				continue;
+			json.begin_object();
+			json.entry("name", result.name);
+			auto cell_list = [&](const char *key, const std::vector<std::pair<std::string, std::string>> &cells,
+					const char *second_key) {
+				json.name(key);
+				json.begin_array();
+				for (auto &it : cells) {
+					json.begin_object();
+					json.compact();
+					json.entry("name", it.first);
+					json.entry(second_key, it.second);
+					json.end_object();
+				}
+				json.end_array();
+			};
+			cell_list("cells_added", result.cells_added, "type");
+			cell_list("cells_removed", result.cells_removed, "type");
+			cell_list("cells_changed", result.cells_changed, "what");
+			json.name("cells_renamed");
+			json.begin_array();
+			for (auto &it : result.cells_renamed) {
+				json.begin_object();
+				json.compact();
+				json.entry("old", std::get<0>(it));
+				json.entry("new", std::get<1>(it));
+				json.entry("type", std::get<2>(it));
+				json.end_object();
+			}
+			json.end_array();
+			json.name("wires_added");
+			json.begin_array();
+			for (auto &name : result.wires_added)
+				json.value(name);
+			json.end_array();
+			json.name("wires_removed");
+			json.begin_array();
+			for (auto &name : result.wires_removed)
+				json.value(name);
+			json.end_array();
+			json.end_object();
+		}
+		json.end_array();
+		json.end_object();
+	}
+} NetdiffPass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,175 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/json.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct PerfreportPass : public Pass {
+	PerfreportPass() : Pass("perfreport", "record and report per-command performance data") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    perfreport [options]\n");
+		log("\n");
+		log("While recording is active, every executed command is recorded with its\n");
+		log("wall-clock and CPU time, the change in peak resident set size, the change\n");
+		log("in the total number of cells and wires in the design, and the amount of\n");
+		log("memory the command routed through its pass arena (see ArenaAllocator in\n");
+		log("kernel/register.h). Commands that invoke\n");
+		log("other commands (e.g. script passes) are recorded inclusively; the nested\n");
+		log("commands appear as separate entries with a larger nesting depth, listed\n");
+		log("before the command that invoked them. Commands aborted by an error are not\n");
+		log("recorded.\n");
+		log("\n");
+		log("    -record\n");
+		log("        discard previously recorded data and start recording\n");
+		log("\n");
+		log("    -counters\n");
+		log("        also record hardware counter deltas per command (CPU cycles, cache\n");
+		log("        misses, branch misses). uses perf_event_open and is only available\n");
+		log("        on Linux; opening the counters may require lowering\n");
+		log("        /proc/sys/kernel/perf_event_paranoid. use together with -record.\n");
+		log("\n");
+		log("    -stop\n");
+		log("        stop recording (recorded data is kept)\n");
+		log("\n");
+		log("    -json <filename>\n");
+		log("        write the recorded data to the specified file in JSON format\n");
+		log("\n");
+		log("When no options are given, a table of the recorded data is printed.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool record_mode = false, stop_mode = false, counters_mode = false, table_mode = true;
+		std::string json_filename;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-record") {
+				record_mode = true;
+				table_mode = false;
+				continue;
+			}
+			if (args[argidx] == "-counters") {
+				counters_mode = true;
+				table_mode = false;
+				continue;
+			}
+			if (args[argidx] == "-stop") {
+				stop_mode = true;
+				table_mode = false;
+				continue;
+			}
+			if (args[argidx] == "-json" && argidx+1 < args.size()) {
+				json_filename = args[++argidx];
+				table_mode = false;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (record_mode && stop_mode)
+			log_cmd_error("Options -record and -stop are exclusive.\n");
+
+		if (counters_mode && !record_mode)
+			log_cmd_error("Option -counters is only valid together with -record.\n");
+
+		if (record_mode) {
+			pass_perf_records.clear();
+			pass_perf_active = true;
+			pass_perf_counters = counters_mode;
+			log("Started recording per-command performance data%s.\n",
+					counters_mode ? " with hardware counters" : "");
+		}
+
+		if (stop_mode) {
+			pass_perf_active = false;
+			pass_perf_counters = false;
+			log("Stopped recording per-command performance data (%d records).\n", GetSize(pass_perf_records));
+		}
+
+		if (!json_filename.empty()) {
+			PrettyJson json;
+			if (!json.write_to_file(json_filename))
+				log_error("Can't open file `%s' for writing: %s\n", json_filename.c_str(), strerror(errno));
+			json.begin_object();
+			json.entry("generator", yosys_version_str);
+			json.name("commands");
+			json.begin_array();
+			for (auto &rec : pass_perf_records) {
+				json.begin_object();
+				json.compact();
+				json.entry("pass", rec.pass_name);
+				json.entry("command", rec.command);
+				json.entry("depth", rec.depth);
+				json.entry("wall_s", 1e-9 * rec.wall_ns);
+				json.entry("cpu_s", 1e-9 * rec.cpu_ns);
+				json.entry("peak_rss_delta_kb", (int)rec.peak_rss_delta_kb);
+				json.entry("cells_delta", (int)rec.cells_delta);
+				json.entry("wires_delta", (int)rec.wires_delta);
+				if (rec.arena_calls) {
+					json.entry("arena_bytes", (double)rec.arena_bytes);
+					json.entry("arena_allocs", (double)rec.arena_calls);
+				}
+				if (rec.hw_cycles || rec.hw_cache_misses || rec.hw_branch_misses) {
+					json.entry("hw_cycles", (double)rec.hw_cycles);
+					json.entry("hw_cache_misses", (double)rec.hw_cache_misses);
+					json.entry("hw_branch_misses", (double)rec.hw_branch_misses);
+				}
+				json.end_object();
+			}
+			json.end_array();
+			json.end_object();
+			log("Wrote %d records to `%s'.\n", GetSize(pass_perf_records), json_filename.c_str());
+		}
+
+		if (table_mode) {
+			if (pass_perf_records.empty()) {
+				log("No recorded performance data. Use 'perfreport -record' to start recording.\n");
+				return;
+			}
+			log("\n");
+			log("  %10s %10s %12s %10s %10s %11s  %s\n", "wall [s]", "cpu [s]", "rss [kB]", "cells", "wires", "arena [kB]", "command");
+			int64_t total_wall = 0, total_cpu = 0;
+			for (auto &rec : pass_perf_records) {
+				log("  %10.3f %10.3f %12lld %10lld %10lld %11lld  %*s%s\n",
+						1e-9 * rec.wall_ns, 1e-9 * rec.cpu_ns,
+						(long long)rec.peak_rss_delta_kb,
+						(long long)rec.cells_delta, (long long)rec.wires_delta,
+						(long long)(rec.arena_bytes >> 10),
+						2*rec.depth, "", rec.command.c_str());
+				if (rec.depth == 0) {
+					total_wall += rec.wall_ns;
+					total_cpu += rec.cpu_ns;
+				}
+			}
+			log("\n");
+			log("  %10.3f %10.3f %50s total (top-level commands)\n", 1e-9 * total_wall, 1e-9 * total_cpu, "");
+			log("\n");
+		}
+	}
+} PerfreportPass;
+
+PRIVATE_NAMESPACE_END
@@ -36,6 +36,7 @@ std::map<std::string, void*> loaded_plugins;
 std::map<std::string, void*> loaded_python_plugins;
 #endif
 std::map<std::string, std::string> loaded_plugin_aliases;
+std::map<std::string, std::string> lazy_plugins;
 
 #ifdef YOSYS_ENABLE_PLUGINS
 void load_plugin(std::string filename, std::vector<std::string> aliases)
@@ -120,6 +121,65 @@ void load_plugin(std::string, std::vector<std::string>)
 }
 #endif
 
+// A plugin manifest lists the pass names a plugin provides, one
+// "<pass_name> <plugin_filename>" pair per line ('#' starts a comment).
+// Registering a manifest defers the dlopen (and the static pass registration
+// it triggers) until one of the listed pass names is first used.
+void register_plugin_manifest(std::string filename)
+{
+	rewrite_filename(filename);
+
+	std::ifstream f(filename);
+	if (f.fail())
+		log_cmd_error("Can't open plugin manifest file `%s'.\n", filename.c_str());
+
+	std::string line;
+	int linenr = 0, count = 0;
+	while (std::getline(f, line))
+	{
+		linenr++;
+		size_t hash_pos = line.find('#');
+		if (hash_pos != std::string::npos)
+			line = line.substr(0, hash_pos);
+
+		std::istringstream ls(line);
+		std::string pass_name, plugin_filename, extra;
+		if (!(ls >> pass_name))
+			continue;
+		if (!(ls >> plugin_filename) || (ls >> extra))
+			log_cmd_error("Malformed line %d in plugin manifest file `%s'.\n", linenr, filename.c_str());
+
+		if (pass_register.count(pass_name))
+			continue;
+
+		lazy_plugins[pass_name] = plugin_filename;
+		count++;
+	}
+
+	log("Registered %d lazy command(s) from plugin manifest file `%s'.\n", count, filename.c_str());
+}
+
+bool load_lazy_plugin(const std::string &pass_name)
+{
+	auto it = lazy_plugins.find(pass_name);
+	if (it == lazy_plugins.end())
+		return false;
+
+	std::string plugin_filename = it->second;
+	log("Loading plugin `%s' for command `%s'.\n", plugin_filename.c_str(), pass_name.c_str());
+
+	// drop all entries for this plugin up front, so a plugin that fails to
+	// provide an advertised pass can't cause repeated load attempts
+	for (auto entry = lazy_plugins.begin(); entry != lazy_plugins.end();)
+		if (entry->second == plugin_filename)
+			entry = lazy_plugins.erase(entry);
+		else
+			++entry;
+
+	load_plugin(plugin_filename, {});
+	return pass_register.count(pass_name) != 0;
+}
+
 struct PluginPass : public Pass {
 	PluginPass() : Pass("plugin", "load and list loaded plugins") { }
 	void help() override
@@ -136,6 +196,12 @@ struct PluginPass : public Pass {
 		log("    -a <alias_name>\n");
 		log("        Register the specified alias name for the loaded plugin\n");
 		log("\n");
+		log("    -m <manifest_filename>\n");
+		log("        Register the passes listed in the specified manifest file without\n");
+		log("        loading the plugins yet. Each line of the manifest file contains a\n");
+		log("        pass name followed by the plugin filename providing it ('#' starts\n");
+		log("        a comment). The plugin is loaded on first use of one of its passes.\n");
+		log("\n");
 		log("    -l\n");
 		log("        List loaded plugins\n");
 		log("\n");
@@ -143,6 +209,7 @@ struct PluginPass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		std::string plugin_filename;
+		std::string manifest_filename;
 		std::vector<std::string> plugin_aliases;
 		bool list_mode = false;
 
@@ -157,6 +224,10 @@ struct PluginPass : public Pass {
 				plugin_aliases.push_back(args[++argidx]);
 				continue;
 			}
+			if ((args[argidx] == "-m") && argidx+1 < args.size() && manifest_filename.empty()) {
+				manifest_filename = args[++argidx];
+				continue;
+			}
 			if (args[argidx] == "-l") {
 				list_mode = true;
 				continue;
@@ -168,6 +239,9 @@ struct PluginPass : public Pass {
 		if (!plugin_filename.empty())
 			load_plugin(plugin_filename, plugin_aliases);
 
+		if (!manifest_filename.empty())
+			register_plugin_manifest(manifest_filename);
+
 		if (list_mode)
 		{
 			log("\n");
@@ -196,6 +270,15 @@ struct PluginPass : public Pass {
 				for (auto &it : loaded_plugin_aliases)
 					log("Alias: %-*s %s\n", max_alias_len, it.first.c_str(), it.second.c_str());
 			}
+
+			if (!lazy_plugins.empty()) {
+				log("\n");
+				int max_pass_len = 1;
+				for (auto &it : lazy_plugins)
+					max_pass_len = max(max_pass_len, GetSize(it.first));
+				for (auto &it : lazy_plugins)
+					log("Lazy:  %-*s %s\n", max_pass_len, it.first.c_str(), it.second.c_str());
+			}
 		}
 	}
 } PluginPass;
@@ -0,0 +1,458 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
+#include "kernel/fstdata.h"
+#include "passes/techmap/libparse.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct cell_power_t {
+	double leakage = 0;
+	dict<IdString, double> pin_energy;
+};
+
+struct power_data_t {
+	double leakage = 0;
+	double switching = 0;
+	unsigned int num_cells = 0;
+	unsigned int num_cells_known = 0;
+
+	std::map<RTLIL::IdString, unsigned int, RTLIL::sort_by_id_str> num_insts_by_type;
+	std::set<RTLIL::IdString> unknown_cell_power;
+
+	power_data_t operator+(const power_data_t &other) const
+	{
+		power_data_t sum = other;
+		sum.leakage += leakage;
+		sum.switching += switching;
+		sum.num_cells += num_cells;
+		sum.num_cells_known += num_cells_known;
+		sum.unknown_cell_power.insert(unknown_cell_power.begin(), unknown_cell_power.end());
+		return sum;
+	}
+
+	power_data_t operator*(unsigned int num) const
+	{
+		power_data_t prod = *this;
+		prod.leakage *= num;
+		prod.switching *= num;
+		prod.num_cells *= num;
+		prod.num_cells_known *= num;
+		return prod;
+	}
+
+	void log_data(RTLIL::IdString mod_name, bool top_mod) const
+	{
+		if (!unknown_cell_power.empty()) {
+			for (auto cell_type : unknown_cell_power)
+				log("   Power for cell type %s is unknown!\n", log_id(cell_type));
+			log("\n");
+		}
+
+		log("   Power estimate for %smodule '%s' (%u of %u cells with power data):\n",
+				top_mod ? "top " : "", log_id(mod_name), num_cells_known, num_cells);
+		log("     Leakage power:   %f\n", leakage);
+		log("     Switching power: %f\n", switching);
+	}
+};
+
+// A Liberty power table is either a scalar attribute or a values() group;
+// the average over all table entries is used as the energy per switching
+// event, i.e. input slew and output load are averaged out.
+static double liberty_table_average(const LibertyAst *ast)
+{
+	if (ast == nullptr)
+		return 0;
+
+	const LibertyAst *values = ast->find("values");
+	if (values == nullptr)
+		return ast->value.empty() ? 0 : atof(ast->value.c_str());
+
+	double sum = 0;
+	int n = 0;
+	for (auto &arg : values->args) {
+		const char *p = arg.c_str();
+		char *endp;
+		while (*p) {
+			double v = strtod(p, &endp);
+			if (endp == p) {
+				p++;
+				continue;
+			}
+			sum += v;
+			n++;
+			p = endp;
+		}
+	}
+	return n > 0 ? sum / n : 0;
+}
+
+void read_liberty_power(dict<IdString, cell_power_t> &cell_power, string liberty_file)
+{
+	std::ifstream f;
+	f.open(liberty_file.c_str());
+	yosys_input_files.insert(liberty_file);
+	if (f.fail())
+		log_cmd_error("Can't open liberty file `%s': %s\n", liberty_file.c_str(), strerror(errno));
+	LibertyParser libparser(f);
+	f.close();
+
+	for (auto cell : libparser.ast->children)
+	{
+		if (cell->id != "cell" || cell->args.size() != 1)
+			continue;
+
+		cell_power_t power;
+
+		const LibertyAst *lk = cell->find("cell_leakage_power");
+		if (lk != nullptr && !lk->value.empty()) {
+			power.leakage = atof(lk->value.c_str());
+		} else {
+			// average the state-dependent leakage_power groups
+			double sum = 0;
+			int n = 0;
+			for (auto child : cell->children)
+				if (child->id == "leakage_power") {
+					const LibertyAst *v = child->find("value");
+					if (v != nullptr && !v->value.empty()) {
+						sum += atof(v->value.c_str());
+						n++;
+					}
+				}
+			if (n > 0)
+				power.leakage = sum / n;
+		}
+
+		for (auto pin : cell->children)
+		{
+			if (pin->id != "pin" || pin->args.size() != 1)
+				continue;
+
+			const LibertyAst *dir = pin->find("direction");
+			if (dir == nullptr || dir->value != "output")
+				continue;
+
+			// average over the per-arc internal_power groups of the pin
+			double energy = 0;
+			int n = 0;
+			for (auto ip : pin->children) {
+				if (ip->id != "internal_power")
+					continue;
+				double rise = liberty_table_average(ip->find("rise_power"));
+				double fall = liberty_table_average(ip->find("fall_power"));
+				energy += (rise + fall) / 2;
+				n++;
+			}
+			if (n > 0)
+				power.pin_energy["\\" + pin->args[0]] = energy / n;
+		}
+
+		cell_power["\\" + cell->args[0]] = power;
+	}
+}
+
+// Replay the FST file once and derive a per-bit toggle rate (in transitions
+// per second of simulated time) for every selected wire that can be matched
+// under the given scope. Transitions from or to undefined values do not count.
+void read_fst_activity(string filename, string scope, RTLIL::Design *design, dict<SigBit, double> &toggle_rate)
+{
+	FstData fst(filename);
+
+	std::vector<std::pair<fstHandle, std::vector<SigBit>>> watch;
+	pool<fstHandle> seen;
+	std::vector<fstHandle> handles;
+
+	for (auto module : design->selected_modules()) {
+		SigMap sigmap(module);
+		for (auto wire : module->wires()) {
+			if (wire->name[0] == '$')
+				continue;
+			fstHandle id = fst.getHandle(scope + "." + RTLIL::unescape_id(wire->name));
+			if (id == 0)
+				continue;
+			std::vector<SigBit> bits;
+			for (auto bit : sigmap(SigSpec(wire)))
+				bits.push_back(bit);
+			watch.emplace_back(id, std::move(bits));
+			if (seen.insert(id).second)
+				handles.push_back(id);
+		}
+	}
+
+	if (handles.empty()) {
+		log_warning("No wire of the selected modules was found in FST file `%s' under scope `%s'.\n",
+				filename.c_str(), scope.c_str());
+		return;
+	}
+
+	fst.activateSignals(handles);
+
+	uint64_t start_time = fst.getStartTime();
+	uint64_t end_time = fst.getEndTime();
+
+	dict<fstHandle, std::string> prev_value;
+	dict<fstHandle, std::vector<int64_t>> toggles;
+
+	std::vector<fstHandle> no_clocks;
+	fst.reconstructAllAtTimes(no_clocks, start_time, end_time, [&](uint64_t) {
+		for (auto h : handles) {
+			std::string v = fst.valueOf(h);
+			auto it = prev_value.find(h);
+			if (it != prev_value.end() && GetSize(it->second) == GetSize(v)) {
+				auto &cnt = toggles[h];
+				cnt.resize(GetSize(v));
+				for (int i = 0; i < GetSize(v); i++) {
+					char a = it->second[i], b = v[i];
+					if ((a == '0' || a == '1') && (b == '0' || b == '1') && a != b)
+						cnt[i]++;
+				}
+			}
+			prev_value[h] = v;
+		}
+	});
+
+	double duration = (end_time - start_time) * fst.getTimescale();
+	if (duration <= 0) {
+		log_warning("FST file `%s' covers no simulated time, ignoring it.\n", filename.c_str());
+		return;
+	}
+
+	for (auto &it : watch) {
+		auto ct = toggles.find(it.first);
+		if (ct == toggles.end() || GetSize(ct->second) != GetSize(it.second))
+			continue;
+		for (int i = 0; i < GetSize(it.second); i++) {
+			SigBit bit = it.second[i];
+			if (bit.wire == nullptr)
+				continue;
+			// FST value strings are MSB first
+			toggle_rate[bit] = ct->second[GetSize(it.second)-1-i] / duration;
+		}
+	}
+
+	log("Collected switching activity for %d signals over %g seconds of simulated time.\n",
+			GetSize(handles), duration);
+}
+
+// The per-module arithmetic only reads the module and the prebuilt tables,
+// so the selected modules run on ThreadPool workers. Everything that copies
+// IdStrings (instance counts, unknown-type reporting) happens afterwards in
+// collect_types() on the main thread.
+void compute_power(RTLIL::Module *mod, const dict<IdString, cell_power_t> &cell_power,
+		const dict<SigBit, double> &toggle_rate, double default_rate, power_data_t &data)
+{
+	SigMap sigmap(mod);
+
+	for (auto cell : mod->cells())
+	{
+		data.num_cells++;
+
+		auto it = cell_power.find(cell->type);
+		if (it == cell_power.end())
+			continue;
+		data.num_cells_known++;
+
+		const cell_power_t &power = it->second;
+		data.leakage += power.leakage;
+
+		for (auto &pin : power.pin_energy) {
+			if (!cell->hasPort(pin.first))
+				continue;
+			for (auto bit : sigmap(cell->getPort(pin.first))) {
+				if (bit.wire == nullptr)
+					continue;
+				auto rt = toggle_rate.find(bit);
+				data.switching += pin.second * (rt != toggle_rate.end() ? rt->second : default_rate);
+			}
+		}
+	}
+}
+
+void collect_types(RTLIL::Design *design, RTLIL::Module *mod, const dict<IdString, cell_power_t> &cell_power, power_data_t &data)
+{
+	for (auto cell : mod->cells()) {
+		if (cell_power.count(cell->type))
+			continue;
+		if (design->module(cell->type) != nullptr)
+			data.num_insts_by_type[cell->type]++;
+		else
+			data.unknown_cell_power.insert(cell->type);
+	}
+}
+
+power_data_t hierarchy_worker(std::map<RTLIL::IdString, power_data_t> &mod_power, RTLIL::IdString mod, int level)
+{
+	power_data_t mod_data = mod_power.at(mod);
+	std::map<RTLIL::IdString, unsigned int, RTLIL::sort_by_id_str> num_insts_by_type;
+	num_insts_by_type.swap(mod_data.num_insts_by_type);
+
+	for (auto &it : num_insts_by_type)
+		if (mod_power.count(it.first) > 0) {
+			log("     %*s%-*s %6u\n", 2*level, "", 26-2*level, log_id(it.first), it.second);
+			mod_data = mod_data + hierarchy_worker(mod_power, it.first, level+1) * it.second;
+			mod_data.num_cells -= it.second;
+		} else {
+			mod_data.num_insts_by_type[it.first] += it.second;
+		}
+
+	return mod_data;
+}
+
+struct PowerPass : public Pass {
+	PowerPass() : Pass("power", "estimate the power consumption of the design") { readonly(); }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    power -liberty <file> [options] [selection]\n");
+		log("\n");
+		log("Estimate the power consumption of the selected (mapped) portion of the design\n");
+		log("from the power data in a Liberty file. For every cell the leakage power and,\n");
+		log("weighted with the switching activity of its output nets, the average internal\n");
+		log("energy per transition are summed up. The results use the power and energy\n");
+		log("units of the Liberty library: leakage in the library's leakage power unit,\n");
+		log("switching power in energy units per second of simulated time.\n");
+		log("\n");
+		log("This is a coarse pre-P&R estimate: interconnect capacitance is not modeled\n");
+		log("and the internal power tables are averaged over slew and load.\n");
+		log("\n");
+		log("    -liberty <liberty_file>\n");
+		log("        use the cell power information from the provided liberty file. may be\n");
+		log("        called multiple times to load multiple libraries.\n");
+		log("\n");
+		log("    -fst <fst_file>\n");
+		log("        read switching activity from the given FST waveform file (e.g. as\n");
+		log("        written by 'sim -fst' or an external simulator). requires -scope.\n");
+		log("\n");
+		log("    -scope <name>\n");
+		log("        hierarchical name of the design in the FST file.\n");
+		log("\n");
+		log("    -activity <float>\n");
+		log("        toggle rate (transitions per second) assumed for nets without\n");
+		log("        recorded activity. default: 0\n");
+		log("\n");
+		log("    -top <module>\n");
+		log("        aggregate the estimates hierarchically with this module as top. if\n");
+		log("        the design is fully selected and a module has the 'top' attribute\n");
+		log("        set, this module is used as default value for this option.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		dict<IdString, cell_power_t> cell_power;
+		std::string fst_file, scope;
+		double default_rate = 0;
+		RTLIL::Module *top_mod = nullptr;
+
+		log_header(design, "Executing POWER pass (estimating power consumption).\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-liberty" && argidx+1 < args.size()) {
+				string liberty_file = args[++argidx];
+				rewrite_filename(liberty_file);
+				read_liberty_power(cell_power, liberty_file);
+				continue;
+			}
+			if (args[argidx] == "-fst" && argidx+1 < args.size()) {
+				fst_file = args[++argidx];
+				rewrite_filename(fst_file);
+				continue;
+			}
+			if (args[argidx] == "-scope" && argidx+1 < args.size()) {
+				scope = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-activity" && argidx+1 < args.size()) {
+				default_rate = atof(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-top" && argidx+1 < args.size()) {
+				if (design->module(RTLIL::escape_id(args[argidx+1])) == nullptr)
+					log_cmd_error("Can't find module %s.\n", args[argidx+1].c_str());
+				top_mod = design->module(RTLIL::escape_id(args[++argidx]));
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		if (cell_power.empty())
+			log_cmd_error("Option -liberty with a library containing power data is required.\n");
+		if (!fst_file.empty() && scope.empty())
+			log_cmd_error("Option -scope is required when reading activity from an FST file.\n");
+
+		dict<SigBit, double> toggle_rate;
+		if (!fst_file.empty())
+			read_fst_activity(fst_file, scope, design, toggle_rate);
+
+		std::vector<RTLIL::Module*> modules = design->selected_modules();
+		std::vector<power_data_t> mod_data(GetSize(modules));
+
+		ThreadPool::run(ThreadPool::thread_count(design), GetSize(modules), [&](int idx) {
+			compute_power(modules[idx], cell_power, toggle_rate, default_rate, mod_data[idx]);
+		});
+
+		std::map<RTLIL::IdString, power_data_t> mod_power;
+		for (int i = 0; i < GetSize(modules); i++)
+		{
+			RTLIL::Module *mod = modules[i];
+
+			if (!top_mod && design->full_selection())
+				if (mod->get_bool_attribute(ID::top))
+					top_mod = mod;
+
+			collect_types(design, mod, cell_power, mod_data[i]);
+			mod_power[mod->name] = mod_data[i];
+
+			log("\n");
+			log("=== %s%s ===\n", log_id(mod->name), design->selected_whole_module(mod->name) ? "" : " (partially selected)");
+			log("\n");
+			mod_data[i].log_data(mod->name, false);
+		}
+
+		if (top_mod != nullptr)
+		{
+			if (GetSize(mod_power) > 1) {
+				log("\n");
+				log("=== design hierarchy ===\n");
+				log("\n");
+				log("   %-28s %6d\n", log_id(top_mod->name), 1);
+			}
+
+			power_data_t data = hierarchy_worker(mod_power, top_mod->name, 0);
+
+			if (GetSize(mod_power) > 1) {
+				log("\n");
+				data.log_data(top_mod->name, true);
+			}
+
+			design->scratchpad_set_string("power.leakage", stringf("%f", data.leakage));
+			design->scratchpad_set_string("power.switching", stringf("%f", data.switching));
+		}
+
+		log("\n");
+	}
+} PowerPass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,67 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/fileprefetch.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct PrefetchPass : public Pass {
+	PrefetchPass() : Pass("prefetch", "read files into memory in the background") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    prefetch <filename> [<filename>..]\n");
+		log("\n");
+		log("Start reading the given files into memory in the background. When a frontend\n");
+		log("command (e.g. 'read_verilog -lib' or a techmap file autoload) later opens one\n");
+		log("of the files, its contents are served from memory, so the file I/O overlaps\n");
+		log("with the commands that run in between. Typical use is declaring the techlib\n");
+		log("files of a flow at the start of the script:\n");
+		log("\n");
+		log("    prefetch +/ice40/cells_sim.v +/ice40/cells_map.v\n");
+		log("    ...\n");
+		log("    synth_ice40\n");
+		log("\n");
+		log("Prefetching a file that is never read only wastes the memory for its\n");
+		log("contents. A file that does not exist is not an error here; the error is\n");
+		log("reported when the file is actually opened. Compressed files are prefetched\n");
+		log("but decompressed from disk again when read.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design*) override
+	{
+		if (args.size() < 2)
+			log_cmd_error("No filename given.\n");
+
+		for (size_t argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx].compare(0, 1, "-") == 0)
+				log_cmd_error("Unknown option \"%s\".\n", args[argidx].c_str());
+
+			std::string filename = args[argidx];
+			rewrite_filename(filename);
+			for (auto &fn : glob_filename(filename))
+				FilePrefetcher::start(fn);
+		}
+	}
+} PrefetchPass;
+
+PRIVATE_NAMESPACE_END
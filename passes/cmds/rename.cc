@@ -347,11 +347,7 @@ struct RenamePass : public Pass {
 					if (cell->name[0] == '$')
 						new_cell_names.emplace(cell, derive_name_from_src(cell->get_src_attribute(), counter++));
 
-				for (auto &it : new_wire_names)
-					module->rename(it.first, it.second);
-
-				for (auto &it : new_cell_names)
-					module->rename(it.first, it.second);
+				module->rename(new_wire_names, new_cell_names);
 			}
 		}
 		else
@@ -364,8 +360,7 @@ struct RenamePass : public Pass {
 				for (auto cell : module->selected_cells())
 					if (cell->name[0] == '$')
 						new_cell_names[cell] = derive_name_from_cell_output_wire(cell, cell_suffix);
-				for (auto &it : new_cell_names)
-					module->rename(it.first, it.second);
+				module->rename({}, new_cell_names);
 			}
 		}
 		else
@@ -395,11 +390,7 @@ struct RenamePass : public Pass {
 						new_cell_names[cell] = buf;
 					}
 
-				for (auto &it : new_wire_names)
-					module->rename(it.first, it.second);
-
-				for (auto &it : new_cell_names)
-					module->rename(it.first, it.second);
+				module->rename(new_wire_names, new_cell_names);
 			}
 		}
 		else
@@ -433,11 +424,7 @@ struct RenamePass : public Pass {
 					if (cell->name.isPublic())
 						new_cell_names[cell] = NEW_ID;
 
-				for (auto &it : new_wire_names)
-					module->rename(it.first, it.second);
-
-				for (auto &it : new_cell_names)
-					module->rename(it.first, it.second);
+				module->rename(new_wire_names, new_cell_names);
 			}
 		}
 		else
@@ -484,11 +471,7 @@ struct RenamePass : public Pass {
 					new_cell_names[cell] = stringf("$_%u_", seed);
 				}
 
-				for (auto &it : new_wire_names)
-					module->rename(it.first, it.second);
-
-				for (auto &it : new_cell_names)
-					module->rename(it.first, it.second);
+				module->rename(new_wire_names, new_cell_names);
 			}
 		}
 		else
@@ -24,7 +24,9 @@
 #include "kernel/register.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 #include "kernel/log.h"
+#include <atomic>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -37,8 +39,11 @@ struct SccWorker
 	RTLIL::Module *module;
 	SigMap sigmap;
 	CellTypes ct, specifyCells;
+	bool nofeedbackMode;
+	bool active = false;
 
 	pool<RTLIL::Cell*> workQueue;
+	SigSet<RTLIL::Cell*> sigToNextCells;
 	dict<RTLIL::Cell*, pool<RTLIL::Cell*>> cellToNextCell;
 	dict<RTLIL::Cell*, RTLIL::SigSpec> cellToPrevSig, cellToNextSig;
 
@@ -48,9 +53,20 @@ struct SccWorker
 	std::vector<RTLIL::Cell*> cellStack;
 	int labelCounter;
 
+	int maxCycles;
+	std::atomic<int> *cycleCounter;
+	bool limitReached;
+
 	dict<RTLIL::Cell*, int> cell2scc;
 	std::vector<pool<RTLIL::Cell*>> sccList;
 
+	void record_scc(pool<RTLIL::Cell*> &scc)
+	{
+		sccList.push_back(scc);
+		if (maxCycles >= 0 && cycleCounter->fetch_add(1) + 1 >= maxCycles)
+			limitReached = true;
+	}
+
 	void run(RTLIL::Cell *cell, int depth, int maxDepth)
 	{
 		log_assert(workQueue.count(cell) > 0);
@@ -65,7 +81,9 @@ struct SccWorker
 		if (maxDepth >= 0)
 			cellDepth[cell] = depth;
 
-		for (auto nextCell : cellToNextCell[cell])
+		for (auto nextCell : cellToNextCell[cell]) {
+			if (limitReached)
+				return;
 			if (cellLabels.count(nextCell) == 0) {
 				run(nextCell, depth+1, maxDepth);
 				cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
@@ -73,6 +91,10 @@ struct SccWorker
 			if (cellsOnStack.count(nextCell) > 0 && (maxDepth < 0 || cellDepth[nextCell] + maxDepth > depth)) {
 					cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
 			}
+		}
+
+		if (limitReached)
+			return;
 
 		if (cellLabels[cell].first == cellLabels[cell].second)
 		{
@@ -83,24 +105,21 @@ struct SccWorker
 			}
 			else
 			{
-				log("Found an SCC:");
 				pool<RTLIL::Cell*> scc;
 				while (cellsOnStack.count(cell) > 0) {
 					RTLIL::Cell *c = cellStack.back();
 					cellStack.pop_back();
 					cellsOnStack.erase(c);
-					log(" %s", RTLIL::id2cstr(c->name));
 					cell2scc[c] = sccList.size();
 					scc.insert(c);
 				}
-				sccList.push_back(scc);
-				log("\n");
+				record_scc(scc);
 			}
 		}
 	}
 
-	SccWorker(RTLIL::Design *design, RTLIL::Module *module, bool nofeedbackMode, bool allCellTypes, bool specifyMode, int maxDepth) :
-			design(design), module(module), sigmap(module)
+	SccWorker(RTLIL::Design *design, RTLIL::Module *module, bool nofeedbackMode, bool allCellTypes, bool specifyMode) :
+			design(design), module(module), sigmap(module), nofeedbackMode(nofeedbackMode)
 	{
 		if (module->processes.size() > 0) {
 			log("Skipping module %s as it contains processes (run 'proc' pass first).\n", module->name.c_str());
@@ -127,7 +146,6 @@ struct SccWorker
 		}
 
 		SigPool selectedSignals;
-		SigSet<RTLIL::Cell*> sigToNextCells;
 
 		for (auto &it : module->wires_)
 			if (design->selected(module, it.second))
@@ -196,25 +214,41 @@ struct SccWorker
 			sigToNextCells.insert(inputSignals, cell);
 		}
 
+		active = true;
+	}
+
+	// The actual traversal only walks the Cell* graph built by the
+	// constructor and never touches IdStrings or logs, so different
+	// modules can be processed by ThreadPool workers. All reporting
+	// happens in report() on the main thread afterwards.
+	void detect(int maxDepth, int maxCycles, std::atomic<int> &cycleCounter)
+	{
+		if (!active)
+			return;
+
+		this->maxCycles = maxCycles;
+		this->cycleCounter = &cycleCounter;
+		limitReached = maxCycles >= 0 && cycleCounter >= maxCycles;
+
 		for (auto cell : workQueue)
 		{
+			if (limitReached)
+				return;
+
 			sigToNextCells.find(cellToNextSig[cell], cellToNextCell[cell]);
 
 			if (!nofeedbackMode && cellToNextCell[cell].count(cell)) {
-				log("Found an SCC:");
 				pool<RTLIL::Cell*> scc;
-				log(" %s", RTLIL::id2cstr(cell->name));
 				cell2scc[cell] = sccList.size();
 				scc.insert(cell);
-				sccList.push_back(scc);
-				log("\n");
+				record_scc(scc);
 			}
 		}
 
 		labelCounter = 0;
 		cellLabels.clear();
 
-		while (!workQueue.empty())
+		while (!workQueue.empty() && !limitReached)
 		{
 			RTLIL::Cell *cell = *workQueue.begin();
 			log_assert(cellStack.size() == 0);
@@ -222,6 +256,19 @@ struct SccWorker
 
 			run(cell, 0, maxDepth);
 		}
+	}
+
+	void report()
+	{
+		if (!active)
+			return;
+
+		for (auto &scc : sccList) {
+			log("Found an SCC:");
+			for (auto cell : scc)
+				log(" %s", RTLIL::id2cstr(cell->name));
+			log("\n");
+		}
 
 		log("Found %d SCCs in module %s.\n", int(sccList.size()), RTLIL::id2cstr(module->name));
 	}
@@ -270,6 +317,12 @@ struct SccPass : public Pass {
 		log("        can e.g. be useful in identifying small local loops in a module that\n");
 		log("        implements one large SCC.\n");
 		log("\n");
+		log("    -max_cycles <num>\n");
+		log("        stop the search after <num> SCCs have been found. This makes the\n");
+		log("        command usable as a fast-fail lint check on designs that are\n");
+		log("        expected to be loop-free, where the full list of loops is not\n");
+		log("        needed to reject the design.\n");
+		log("\n");
 		log("    -nofeedback\n");
 		log("        do not count cells that have their output fed back into one of their\n");
 		log("        inputs as single-cell scc.\n");
@@ -300,6 +353,7 @@ struct SccPass : public Pass {
 		bool nofeedbackMode = false;
 		bool specifyMode = false;
 		int maxDepth = -1;
+		int maxCycles = -1;
 		int expect = -1;
 
 		log_header(design, "Executing SCC pass (detecting logic loops).\n");
@@ -310,6 +364,10 @@ struct SccPass : public Pass {
 				maxDepth = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-max_cycles" && argidx+1 < args.size()) {
+				maxCycles = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-expect" && argidx+1 < args.size()) {
 				expect = atoi(args[++argidx].c_str());
 				continue;
@@ -343,9 +401,23 @@ struct SccPass : public Pass {
 		RTLIL::Selection newSelection(false);
 		int scc_counter = 0;
 
+		// Building the cell graphs handles IdStrings (and logs about
+		// skipped modules), so it stays on the main thread. The
+		// per-module traversals are independent and run in parallel;
+		// the shared counter lets -max_cycles stop all of them early.
+		std::vector<std::unique_ptr<SccWorker>> workers;
 		for (auto mod : design->selected_modules())
+			workers.push_back(std::unique_ptr<SccWorker>(new SccWorker(design, mod, nofeedbackMode, allCellTypes, specifyMode)));
+
+		std::atomic<int> cycleCounter(0);
+		ThreadPool::run(ThreadPool::thread_count(design), GetSize(workers), [&](int idx) {
+			workers[idx]->detect(maxDepth, maxCycles, cycleCounter);
+		});
+
+		for (auto &worker_p : workers)
 		{
-			SccWorker worker(design, mod, nofeedbackMode, allCellTypes, specifyMode, maxDepth);
+			SccWorker &worker = *worker_p;
+			worker.report();
 
 			if (!setAttr.empty())
 			{
@@ -378,6 +450,9 @@ struct SccPass : public Pass {
 				worker.select(newSelection);
 		}
 
+		if (maxCycles >= 0 && scc_counter >= maxCycles)
+			log("Stopped searching after finding %d SCCs (-max_cycles).\n", scc_counter);
+
 		if (expect >= 0) {
 			if (scc_counter == expect)
 				log("Found and expected %d SCCs.\n", scc_counter);
@@ -30,8 +30,10 @@ using RTLIL::id2cstr;
 
 static std::vector<RTLIL::Selection> work_stack;
 
-static bool match_ids(RTLIL::IdString id, const std::string &pattern)
+static bool match_ids(RTLIL::IdString id, const PatternMatcher &matcher)
 {
+	const std::string &pattern = matcher.pattern();
+
 	if (id == pattern)
 		return true;
 
@@ -42,9 +44,9 @@ static bool match_ids(RTLIL::IdString id, const std::string &pattern)
 
 	if (*id_c == '\\' && id_size == 1 + pat_size && memcmp(id_c + 1, pat_c, pat_size) == 0)
 		return true;
-	if (patmatch(pat_c, id_c))
+	if (matcher.match(id_c))
 		return true;
-	if (*id_c == '\\' && patmatch(pat_c, id_c + 1))
+	if (*id_c == '\\' && matcher.match(id_c + 1))
 		return true;
 	if (*id_c == '$' && *pat_c == '$') {
 		const char *q = strrchr(id_c, '$');
@@ -431,7 +433,186 @@ static int parse_comma_list(std::set<RTLIL::IdString> &tokens, const std::string
 	}
 }
 
-static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, int max_objects, char mode, CellTypes &ct, bool eval_only)
+// Dense index over the members (wires first, then cells) of one module.
+// select_op_expand() keeps the selection state of each expansion step in
+// bitmaps over this index, so membership tests and updates are single bit
+// operations instead of pool lookups and per-step pool copies.
+struct ModuleMemberIndex
+{
+	dict<RTLIL::Wire*, int> wire_index;
+	dict<RTLIL::Cell*, int> cell_index;
+	int num_members;
+
+	ModuleMemberIndex(RTLIL::Module *mod)
+	{
+		int pos = 0;
+		wire_index.reserve(mod->wires().size());
+		for (auto wire : mod->wires())
+			wire_index[wire] = pos++;
+		cell_index.reserve(mod->cells().size());
+		for (auto cell : mod->cells())
+			cell_index[cell] = pos++;
+		num_members = pos;
+	}
+
+	std::vector<uint64_t> bitmap() const
+	{
+		return std::vector<uint64_t>((num_members + 63) / 64, 0);
+	}
+
+	static bool test(const std::vector<uint64_t> &bits, int i)
+	{
+		return (bits[i / 64] >> (i % 64)) & 1;
+	}
+
+	static void set(std::vector<uint64_t> &bits, int i)
+	{
+		bits[i / 64] |= uint64_t(1) << (i % 64);
+	}
+};
+
+// Cached per-module fanin/fanout adjacency for the expansion operators
+// (%x/%ci/%co). Decoding all connections and cell ports of a large module
+// into wire indices dominates the cost of an expansion step, so the decoded
+// tables are kept around and reused across steps and across repeated select
+// invocations in a script. A monitor on the design drops a module's entry
+// whenever one of its connections changes; entries are also rebuilt when
+// the module's wire or cell count changed, since wire and cell creation is
+// not reported through the monitor interface.
+struct SelectExpandCache : RTLIL::Monitor
+{
+	struct PortEntry {
+		RTLIL::Cell *cell;
+		RTLIL::IdString cell_type, port_name;
+		int cell_pos;
+		int first_wire, num_wires;
+		bool is_input, is_output, evaluable;
+	};
+
+	struct ModuleIndex {
+		ModuleMemberIndex members;
+		std::vector<std::pair<int, int>> conn_pairs;
+		std::vector<PortEntry> ports;
+		std::vector<int> port_wires;
+		int num_wires, num_cells;
+
+		ModuleIndex(RTLIL::Module *mod, CellTypes &ct) : members(mod)
+		{
+			num_wires = GetSize(mod->wires());
+			num_cells = GetSize(mod->cells());
+
+			for (auto &conn : mod->connections()) {
+				std::vector<RTLIL::SigBit> conn_lhs = conn.first.to_sigbit_vector();
+				std::vector<RTLIL::SigBit> conn_rhs = conn.second.to_sigbit_vector();
+				for (size_t i = 0; i < conn_lhs.size(); i++) {
+					if (conn_lhs[i].wire == nullptr || conn_rhs[i].wire == nullptr)
+						continue;
+					conn_pairs.emplace_back(members.wire_index.at(conn_lhs[i].wire),
+							members.wire_index.at(conn_rhs[i].wire));
+				}
+			}
+
+			for (auto cell : mod->cells())
+			for (auto &conn : cell->connections()) {
+				PortEntry entry;
+				entry.cell = cell;
+				entry.cell_type = cell->type;
+				entry.port_name = conn.first;
+				entry.cell_pos = members.cell_index.at(cell);
+				entry.first_wire = GetSize(port_wires);
+				entry.is_input = ct.cell_input(cell->type, conn.first);
+				entry.is_output = ct.cell_output(cell->type, conn.first);
+				entry.evaluable = yosys_celltypes.cell_evaluable(cell->type);
+				for (auto &chunk : conn.second.chunks())
+					if (chunk.wire != nullptr)
+						port_wires.push_back(members.wire_index.at(chunk.wire));
+				entry.num_wires = GetSize(port_wires) - entry.first_wire;
+				ports.push_back(entry);
+			}
+		}
+	};
+
+	RTLIL::Design *design = nullptr;
+	Hasher::hash_t design_hashidx = 0;
+	dict<RTLIL::Module*, ModuleIndex*> entries;
+
+	~SelectExpandCache() override
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		for (auto &it : entries)
+			delete it.second;
+		entries.clear();
+	}
+
+	void drop(RTLIL::Module *mod)
+	{
+		auto it = entries.find(mod);
+		if (it != entries.end()) {
+			delete it->second;
+			entries.erase(it);
+		}
+	}
+
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString&, const RTLIL::SigSpec&, const RTLIL::SigSpec&) override
+	{
+		drop(cell->module);
+	}
+
+	void notify_connect(RTLIL::Module *mod, const RTLIL::SigSig&) override
+	{
+		drop(mod);
+	}
+
+	void notify_connect(RTLIL::Module *mod, const std::vector<RTLIL::SigSig>&) override
+	{
+		drop(mod);
+	}
+
+	void notify_blackout(RTLIL::Module *mod) override
+	{
+		drop(mod);
+	}
+
+	void notify_module_del(RTLIL::Module *mod) override
+	{
+		drop(mod);
+	}
+
+	ModuleIndex *get(RTLIL::Design *current_design, RTLIL::Module *mod)
+	{
+		if (design != current_design || design_hashidx != current_design->hashidx_) {
+			// the previously monitored design may already be deleted, so
+			// just forget about it instead of detaching from it
+			clear();
+			design = current_design;
+			design_hashidx = current_design->hashidx_;
+			design->monitors.insert(this);
+		}
+
+		auto it = entries.find(mod);
+		if (it != entries.end()) {
+			if (it->second->num_wires == GetSize(mod->wires()) && it->second->num_cells == GetSize(mod->cells()))
+				return it->second;
+			delete it->second;
+			entries.erase(mod);
+		}
+
+		CellTypes ct;
+		ct.setup(design);
+
+		ModuleIndex *idx = new ModuleIndex(mod, ct);
+		entries[mod] = idx;
+		return idx;
+	}
+};
+
+static SelectExpandCache select_expand_cache;
+
+static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, int max_objects, char mode, bool eval_only)
 {
 	int sel_objects = 0;
 	bool is_input, is_output;
@@ -440,39 +621,48 @@ static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::v
 		if (lhs.selected_whole_module(mod->name) || !lhs.selected_module(mod->name))
 			continue;
 
-		std::set<RTLIL::Wire*> selected_wires;
-		auto selected_members = lhs.selected_members[mod->name];
-
-		for (auto wire : mod->wires())
-			if (lhs.selected_member(mod->name, wire->name) && limits.count(wire->name) == 0)
-				selected_wires.insert(wire);
+		SelectExpandCache::ModuleIndex *cache = select_expand_cache.get(design, mod);
+		ModuleMemberIndex &idx = cache->members;
+
+		// members selected when entering this expansion step, the subset of
+		// wires eligible as expansion seeds, and the updated selection
+		std::vector<uint64_t> snap_members = idx.bitmap();
+		std::vector<uint64_t> snap_wires = idx.bitmap();
+		std::vector<uint64_t> live = idx.bitmap();
+
+		for (auto &it : idx.wire_index)
+			if (lhs.selected_member(mod->name, it.first->name)) {
+				ModuleMemberIndex::set(snap_members, it.second);
+				ModuleMemberIndex::set(live, it.second);
+				if (limits.count(it.first->name) == 0)
+					ModuleMemberIndex::set(snap_wires, it.second);
+			}
+		for (auto &it : idx.cell_index)
+			if (lhs.selected_member(mod->name, it.first->name)) {
+				ModuleMemberIndex::set(snap_members, it.second);
+				ModuleMemberIndex::set(live, it.second);
+			}
 
-		for (auto &conn : mod->connections())
+		for (auto &pair : cache->conn_pairs)
 		{
-			std::vector<RTLIL::SigBit> conn_lhs = conn.first.to_sigbit_vector();
-			std::vector<RTLIL::SigBit> conn_rhs = conn.second.to_sigbit_vector();
-
-			for (size_t i = 0; i < conn_lhs.size(); i++) {
-				if (conn_lhs[i].wire == nullptr || conn_rhs[i].wire == nullptr)
-					continue;
-				if (mode != 'i' && selected_wires.count(conn_rhs[i].wire) && selected_members.count(conn_lhs[i].wire->name) == 0)
-					lhs.selected_members[mod->name].insert(conn_lhs[i].wire->name), sel_objects++, max_objects--;
-				if (mode != 'o' && selected_wires.count(conn_lhs[i].wire) && selected_members.count(conn_rhs[i].wire->name) == 0)
-					lhs.selected_members[mod->name].insert(conn_rhs[i].wire->name), sel_objects++, max_objects--;
-			}
+			int li = pair.first, ri = pair.second;
+			if (mode != 'i' && ModuleMemberIndex::test(snap_wires, ri) && !ModuleMemberIndex::test(live, li))
+				ModuleMemberIndex::set(live, li), sel_objects++, max_objects--;
+			if (mode != 'o' && ModuleMemberIndex::test(snap_wires, li) && !ModuleMemberIndex::test(live, ri))
+				ModuleMemberIndex::set(live, ri), sel_objects++, max_objects--;
 		}
 
-		for (auto cell : mod->cells())
-		for (auto &conn : cell->connections())
+		for (auto &entry : cache->ports)
 		{
 			char last_mode = '-';
-			if (eval_only && !yosys_celltypes.cell_evaluable(cell->type))
+			int ci = entry.cell_pos;
+			if (eval_only && !entry.evaluable)
 				goto exclude_match;
 			for (auto &rule : rules) {
 				last_mode = rule.mode;
-				if (rule.cell_types.size() > 0 && rule.cell_types.count(cell->type) == 0)
+				if (rule.cell_types.size() > 0 && rule.cell_types.count(entry.cell_type) == 0)
 					continue;
-				if (rule.port_names.size() > 0 && rule.port_names.count(conn.first) == 0)
+				if (rule.port_names.size() > 0 && rule.port_names.count(entry.port_name) == 0)
 					continue;
 				if (rule.mode == '+')
 					goto include_match;
@@ -482,19 +672,28 @@ static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::v
 			if (last_mode == '+')
 				goto exclude_match;
 		include_match:
-			is_input = mode == 'x' || ct.cell_input(cell->type, conn.first);
-			is_output = mode == 'x' || ct.cell_output(cell->type, conn.first);
-			for (auto &chunk : conn.second.chunks())
-				if (chunk.wire != nullptr) {
-					if (max_objects != 0 && selected_wires.count(chunk.wire) > 0 && selected_members.count(cell->name) == 0)
-						if (mode == 'x' || (mode == 'i' && is_output) || (mode == 'o' && is_input))
-							lhs.selected_members[mod->name].insert(cell->name), sel_objects++, max_objects--;
-					if (max_objects != 0 && selected_members.count(cell->name) > 0 && limits.count(cell->name) == 0 && selected_members.count(chunk.wire->name) == 0)
-						if (mode == 'x' || (mode == 'i' && is_input) || (mode == 'o' && is_output))
-							lhs.selected_members[mod->name].insert(chunk.wire->name), sel_objects++, max_objects--;
-				}
+			is_input = mode == 'x' || entry.is_input;
+			is_output = mode == 'x' || entry.is_output;
+			for (int k = 0; k < entry.num_wires; k++) {
+				int wi = cache->port_wires[entry.first_wire + k];
+				if (max_objects != 0 && ModuleMemberIndex::test(snap_wires, wi) && !ModuleMemberIndex::test(live, ci))
+					if (mode == 'x' || (mode == 'i' && is_output) || (mode == 'o' && is_input))
+						ModuleMemberIndex::set(live, ci), sel_objects++, max_objects--;
+				if (max_objects != 0 && ModuleMemberIndex::test(snap_members, ci) && limits.count(entry.cell->name) == 0 && !ModuleMemberIndex::test(live, wi))
+					if (mode == 'x' || (mode == 'i' && is_input) || (mode == 'o' && is_output))
+						ModuleMemberIndex::set(live, wi), sel_objects++, max_objects--;
+			}
 		exclude_match:;
 		}
+
+		// commit the newly selected members back into the selection
+		auto &members = lhs.selected_members[mod->name];
+		for (auto &it : idx.wire_index)
+			if (ModuleMemberIndex::test(live, it.second) && !ModuleMemberIndex::test(snap_members, it.second))
+				members.insert(it.first->name);
+		for (auto &it : idx.cell_index)
+			if (ModuleMemberIndex::test(live, it.second) && !ModuleMemberIndex::test(snap_members, it.second))
+				members.insert(it.first->name);
 	}
 
 	return sel_objects;
@@ -507,11 +706,6 @@ static void select_op_expand(RTLIL::Design *design, const std::string &arg, char
 	std::vector<expand_rule_t> rules;
 	std::set<RTLIL::IdString> limits;
 
-	CellTypes ct;
-
-	if (mode != 'x')
-		ct.setup(design);
-
 	if (pos < int(arg.size()) && arg[pos] == '*') {
 		levels = 1000000;
 		pos++;
@@ -594,7 +788,7 @@ static void select_op_expand(RTLIL::Design *design, const std::string &arg, char
 #endif
 
 	while (levels-- > 0 && rem_objects != 0) {
-		int num_objects = select_op_expand(design, work_stack.back(), rules, limits, rem_objects, mode, ct, eval_only);
+		int num_objects = select_op_expand(design, work_stack.back(), rules, limits, rem_objects, mode, eval_only);
 		if (num_objects == 0)
 			break;
 		rem_objects -= num_objects;
@@ -805,6 +999,11 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 	}
 
 	sel.full_selection = false;
+
+	// compile the module pattern once instead of re-matching the raw string
+	// against every module name
+	PatternMatcher mod_matcher(arg_mod.compare(0, 2, "N:") == 0 ? arg_mod.substr(2) : arg_mod);
+
 	for (auto mod : design->modules())
 	{
 		if (!select_blackboxes && mod->get_blackbox_attribute())
@@ -815,10 +1014,10 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 				continue;
 		} else
 		if (arg_mod.compare(0, 2, "N:") == 0) {
-			if (!match_ids(mod->name, arg_mod.substr(2)))
+			if (!match_ids(mod->name, mod_matcher))
 				continue;
 		} else
-		if (!match_ids(mod->name, arg_mod))
+		if (!match_ids(mod->name, mod_matcher))
 			continue;
 		else
 			arg_mod_found[arg_mod] = true;
@@ -829,23 +1028,27 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 		}
 
 		if (arg_memb.compare(0, 2, "w:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto wire : mod->wires())
-				if (match_ids(wire->name, arg_memb.substr(2)))
+				if (match_ids(wire->name, matcher))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "i:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto wire : mod->wires())
-				if (wire->port_input && match_ids(wire->name, arg_memb.substr(2)))
+				if (wire->port_input && match_ids(wire->name, matcher))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "o:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto wire : mod->wires())
-				if (wire->port_output && match_ids(wire->name, arg_memb.substr(2)))
+				if (wire->port_output && match_ids(wire->name, matcher))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "x:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto wire : mod->wires())
-				if ((wire->port_input || wire->port_output) && match_ids(wire->name, arg_memb.substr(2)))
+				if ((wire->port_input || wire->port_output) && match_ids(wire->name, matcher))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "s:") == 0) {
@@ -866,13 +1069,15 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			}
 		} else
 		if (arg_memb.compare(0, 2, "m:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto &it : mod->memories)
-				if (match_ids(it.first, arg_memb.substr(2)))
+				if (match_ids(it.first, matcher))
 					sel.selected_members[mod->name].insert(it.first);
 		} else
 		if (arg_memb.compare(0, 2, "c:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto cell : mod->cells())
-				if (match_ids(cell->name, arg_memb.substr(2)))
+				if (match_ids(cell->name, matcher))
 					sel.selected_members[mod->name].insert(cell->name);
 		} else
 		if (arg_memb.compare(0, 2, "t:") == 0) {
@@ -886,14 +1091,16 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 					if (muster.selected_modules.count(cell->type))
 						sel.selected_members[mod->name].insert(cell->name);
 			} else {
+				PatternMatcher matcher(arg_memb.substr(2));
 				for (auto cell : mod->cells())
-					if (match_ids(cell->type, arg_memb.substr(2)))
+					if (match_ids(cell->type, matcher))
 						sel.selected_members[mod->name].insert(cell->name);
 			}
 		} else
 		if (arg_memb.compare(0, 2, "p:") == 0) {
+			PatternMatcher matcher(arg_memb.substr(2));
 			for (auto &it : mod->processes)
-				if (match_ids(it.first, arg_memb.substr(2)))
+				if (match_ids(it.first, matcher))
 					sel.selected_members[mod->name].insert(it.first);
 		} else
 		if (arg_memb.compare(0, 2, "a:") == 0) {
@@ -918,23 +1125,24 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			std::string orig_arg_memb = arg_memb;
 			if (arg_memb.compare(0, 2, "n:") == 0)
 				arg_memb = arg_memb.substr(2);
+			PatternMatcher matcher(arg_memb);
 			for (auto wire : mod->wires())
-				if (match_ids(wire->name, arg_memb)) {
+				if (match_ids(wire->name, matcher)) {
 					sel.selected_members[mod->name].insert(wire->name);
 					arg_memb_found[orig_arg_memb] = true;
 				}
 			for (auto &it : mod->memories)
-				if (match_ids(it.first, arg_memb)) {
+				if (match_ids(it.first, matcher)) {
 					sel.selected_members[mod->name].insert(it.first);
 					arg_memb_found[orig_arg_memb] = true;
 				}
 			for (auto cell : mod->cells())
-				if (match_ids(cell->name, arg_memb)) {
+				if (match_ids(cell->name, matcher)) {
 					sel.selected_members[mod->name].insert(cell->name);
 					arg_memb_found[orig_arg_memb] = true;
 				}
 			for (auto &it : mod->processes)
-				if (match_ids(it.first, arg_memb)) {
+				if (match_ids(it.first, matcher)) {
 					sel.selected_members[mod->name].insert(it.first);
 					arg_memb_found[orig_arg_memb] = true;
 				}
@@ -0,0 +1,213 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+
+#ifndef _WIN32
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#  include <errno.h>
+#endif
+
+#include <sstream>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+#ifndef _WIN32
+
+bool read_all(int fd, void *data, size_t len)
+{
+	char *p = (char*)data;
+	while (len > 0) {
+		ssize_t n = read(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n, len -= n;
+	}
+	return true;
+}
+
+bool write_all(int fd, const void *data, size_t len)
+{
+	const char *p = (const char*)data;
+	while (len > 0) {
+		ssize_t n = write(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n, len -= n;
+	}
+	return true;
+}
+
+#endif
+
+struct ServerPass : public Pass {
+	ServerPass() : Pass("server", "serve commands on the resident design over a local socket") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    server -listen <socket_path> [-once]\n");
+		log("\n");
+		log("Keep the current design resident and serve commands received over a unix\n");
+		log("domain socket, so interactive tooling can run select/stat/show/eval queries\n");
+		log("against a loaded design without re-launching yosys and re-reading the design\n");
+		log("for every query.\n");
+		log("\n");
+		log("Each request frame is a 32-bit little-endian payload length followed by the\n");
+		log("command text. Each response frame is a 32-bit little-endian payload length\n");
+		log("followed by one status byte ('0' on success, '1' on command error) and the\n");
+		log("log output captured while the command ran.\n");
+		log("\n");
+		log("Clients are served one at a time; closing the connection ends the session.\n");
+		log("Sending the command 'shutdown' stops the server and returns to the caller.\n");
+		log("\n");
+		log("    -listen <socket_path>\n");
+		log("        Path of the unix domain socket to create. An existing file at this\n");
+		log("        path is removed first.\n");
+		log("\n");
+		log("    -once\n");
+		log("        Stop the server after the first client disconnects.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+#ifndef _WIN32
+		std::string socket_path;
+		bool once_mode = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-listen" && argidx+1 < args.size()) {
+				socket_path = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-once") {
+				once_mode = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (socket_path.empty())
+			log_cmd_error("Missing required -listen option.\n");
+
+		sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		if (socket_path.size() >= sizeof(addr.sun_path))
+			log_cmd_error("Socket path `%s' is too long.\n", socket_path.c_str());
+		strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+		int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (server_fd < 0)
+			log_cmd_error("Can't create socket: %s\n", strerror(errno));
+
+		unlink(socket_path.c_str());
+		if (bind(server_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server_fd, 1) < 0) {
+			close(server_fd);
+			log_cmd_error("Can't listen on `%s': %s\n", socket_path.c_str(), strerror(errno));
+		}
+
+		log("Serving design on `%s'. Send 'shutdown' to stop the server.\n", socket_path.c_str());
+
+		bool old_log_cmd_error_throw = log_cmd_error_throw;
+		log_cmd_error_throw = true;
+		bool shutdown_requested = false;
+
+		while (!shutdown_requested)
+		{
+			int client_fd = accept(server_fd, nullptr, nullptr);
+			if (client_fd < 0)
+				break;
+
+			while (1)
+			{
+				uint32_t len;
+				if (!read_all(client_fd, &len, sizeof(len)))
+					break;
+				len = uint32_t(((unsigned char*)&len)[0]) | uint32_t(((unsigned char*)&len)[1]) << 8 |
+						uint32_t(((unsigned char*)&len)[2]) << 16 | uint32_t(((unsigned char*)&len)[3]) << 24;
+
+				std::string command(len, 0);
+				if (len > 0 && !read_all(client_fd, &command[0], len))
+					break;
+
+				std::string trimmed = command;
+				size_t first = trimmed.find_first_not_of(" \t\r\n");
+				if (first == std::string::npos)
+					trimmed.clear();
+				else
+					trimmed = trimmed.substr(first, trimmed.find_last_not_of(" \t\r\n") - first + 1);
+
+				if (trimmed == "shutdown")
+					shutdown_requested = true;
+
+				char status = '0';
+				std::ostringstream capture;
+
+				if (!shutdown_requested && !trimmed.empty()) {
+					log_streams.push_back(&capture);
+					try {
+						log_assert(design->selection_stack.size() == 1);
+						Pass::call(design, command);
+					} catch (log_cmd_error_exception) {
+						while (design->selection_stack.size() > 1)
+							design->selection_stack.pop_back();
+						log_reset_stack();
+						status = '1';
+					}
+					log_streams.pop_back();
+					design->check();
+				}
+
+				std::string payload = capture.str();
+				uint32_t payload_len = GetSize(payload) + 1;
+				unsigned char len_bytes[4] = {
+					(unsigned char)(payload_len & 0xff), (unsigned char)((payload_len >> 8) & 0xff),
+					(unsigned char)((payload_len >> 16) & 0xff), (unsigned char)((payload_len >> 24) & 0xff)
+				};
+				if (!write_all(client_fd, len_bytes, 4) || !write_all(client_fd, &status, 1) ||
+						!write_all(client_fd, payload.data(), payload.size()))
+					break;
+
+				if (shutdown_requested)
+					break;
+			}
+
+			close(client_fd);
+
+			if (once_mode)
+				break;
+		}
+
+		close(server_fd);
+		unlink(socket_path.c_str());
+		log_cmd_error_throw = old_log_cmd_error_throw;
+
+		log("Server on `%s' stopped.\n", socket_path.c_str());
+#else
+		log_cmd_error("This version of Yosys cannot run the command server on this platform.\n");
+#endif
+	}
+} ServerPass;
+
+PRIVATE_NAMESPACE_END
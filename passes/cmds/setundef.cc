@@ -23,6 +23,7 @@
 #include "kernel/mem.h"
 #include "kernel/rtlil.h"
 #include "kernel/log.h"
+#include "kernel/xanalysis.h"
 
 #define MODE_ZERO     0
 #define MODE_ONE      1
@@ -259,56 +260,49 @@ struct SetundefPass : public Pass {
 				if (expose_mode)
 				{
 					SigMap sigmap(module);
-					dict<SigBit, bool> wire_drivers;
-					pool<SigBit> used_wires;
-					SigPool undriven_signals;
+					BitMaskMap wire_drivers, used_wires;
+					wire_drivers.setup(module);
+					used_wires.setup(module);
 
 					for (auto cell : module->cells())
 						for (auto &conn : cell->connections()) {
 							SigSpec sig = sigmap(conn.second);
 							if (cell->input(conn.first))
-								for (auto bit : sig)
-									if (bit.wire)
-										used_wires.insert(bit);
+								used_wires.set(sig);
 							if (cell->output(conn.first))
-								for (int i = 0; i < GetSize(sig); i++)
-									if (sig[i].wire)
-										wire_drivers[sig[i]] = true;
+								wire_drivers.set(sig);
 						}
 
 					for (auto wire : module->wires()) {
-						if (wire->port_input) {
-							SigSpec sig = sigmap(wire);
-							for (int i = 0; i < GetSize(sig); i++)
-								wire_drivers[sig[i]] = true;
-						}
-						if (wire->port_output) {
-							SigSpec sig = sigmap(wire);
-							for (auto bit : sig)
-								if (bit.wire)
-									used_wires.insert(bit);
-						}
+						if (wire->port_input)
+							wire_drivers.set(sigmap(wire));
+						if (wire->port_output)
+							used_wires.set(sigmap(wire));
 					}
 
+					used_wires.subtract(wire_drivers);
+
 					pool<RTLIL::Wire*> undriven_wires;
-					for (auto bit : used_wires)
-						if (!wire_drivers.count(bit))
-							undriven_wires.insert(bit.wire);
+					for (auto bit : used_wires.export_bits())
+						undriven_wires.insert(bit.wire);
+
+					BitMaskMap undriven_signals;
+					undriven_signals.setup(module);
 
 					for (auto &it : undriven_wires)
-						undriven_signals.add(sigmap(it));
+						undriven_signals.set(sigmap(it));
 
 					for (auto &it : undriven_wires)
 						if (it->port_input)
-							undriven_signals.del(sigmap(it));
+							undriven_signals.clear(sigmap(it));
 
 					CellTypes ct(design);
 					for (auto &it : module->cells_)
 					for (auto &conn : it.second->connections())
 						if (!ct.cell_known(it.second->type) || ct.cell_output(it.second->type, conn.first))
-							undriven_signals.del(sigmap(conn.second));
+							undriven_signals.clear(sigmap(conn.second));
 
-					RTLIL::SigSpec sig = undriven_signals.export_all();
+					RTLIL::SigSpec sig = undriven_signals.export_bits();
 					for (auto &c : sig.chunks()) {
 						RTLIL::Wire * wire;
 						if (c.wire->width == c.width) {
@@ -326,22 +320,23 @@ struct SetundefPass : public Pass {
 				else
 				{
 					SigMap sigmap(module);
-					SigPool undriven_signals;
+					BitMaskMap undriven_signals;
+					undriven_signals.setup(module);
 
 					for (auto &it : module->wires_)
-						undriven_signals.add(sigmap(it.second));
+						undriven_signals.set(sigmap(it.second));
 
 					for (auto &it : module->wires_)
 						if (it.second->port_input)
-							undriven_signals.del(sigmap(it.second));
+							undriven_signals.clear(sigmap(it.second));
 
 					CellTypes ct(design);
 					for (auto &it : module->cells_)
 					for (auto &conn : it.second->connections())
 						if (!ct.cell_known(it.second->type) || ct.cell_output(it.second->type, conn.first))
-							undriven_signals.del(sigmap(conn.second));
+							undriven_signals.clear(sigmap(conn.second));
 
-					RTLIL::SigSpec sig = undriven_signals.export_all();
+					RTLIL::SigSpec sig = undriven_signals.export_bits();
 					for (auto &c : sig.chunks()) {
 						RTLIL::SigSpec bits;
 						if (worker.next_bit_mode == MODE_ANYSEQ)
@@ -19,6 +19,7 @@
 
 #include "kernel/register.h"
 #include "kernel/celltypes.h"
+#include "kernel/sigtools.h"
 #include "kernel/log.h"
 #include <string.h>
 
@@ -66,6 +67,7 @@ struct ShowWorker
 	bool abbreviateIds;
 	bool notitle;
 	bool href;
+	int budget;
 	int page_counter;
 
 	const std::vector<std::pair<std::string, RTLIL::Selection>> &color_selections;
@@ -412,8 +414,89 @@ struct ShowWorker
 			collect_proc_signals(it, input_signals, output_signals);
 	}
 
+	// Summary mode for selections past the node budget: one box per cell
+	// type and one octagon per module port, edges weighted with the number
+	// of connecting bits. The graph stays readable (and the exporter cheap)
+	// for cones that are far too large to draw cell by cell.
+	void handle_module_summarized(int num_cells)
+	{
+		single_idx_count = 0;
+		dot_escape_store.clear();
+		dot_id2num_store.clear();
+		net_conn_map.clear();
+
+		SigMap sigmap(module);
+		dict<RTLIL::IdString, int> type_count;
+		dict<RTLIL::SigBit, std::string> bit_driver;
+		dict<std::pair<std::string, std::string>, int> edge_bits;
+
+		auto type_node = [&](RTLIL::IdString type) {
+			return stringf("t%d", id2num(type));
+		};
+		auto port_node = [&](RTLIL::IdString port) {
+			return stringf("n%d", id2num(port));
+		};
+
+		for (auto wire : module->wires())
+			if (wire->port_input)
+				for (auto bit : sigmap(RTLIL::SigSpec(wire)))
+					bit_driver[bit] = port_node(wire->name);
+
+		for (auto cell : module->selected_cells()) {
+			type_count[cell->type]++;
+			for (auto &conn : cell->connections())
+				if (ct.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second))
+						if (bit.wire)
+							bit_driver[bit] = type_node(cell->type);
+		}
+
+		for (auto cell : module->selected_cells())
+			for (auto &conn : cell->connections()) {
+				if (ct.cell_output(cell->type, conn.first))
+					continue;
+				for (auto bit : sigmap(conn.second)) {
+					auto it = bit_driver.find(bit);
+					if (it != bit_driver.end() && it->second != type_node(cell->type))
+						edge_bits[std::make_pair(it->second, type_node(cell->type))]++;
+				}
+			}
+
+		for (auto wire : module->wires())
+			if (wire->port_output)
+				for (auto bit : sigmap(RTLIL::SigSpec(wire))) {
+					auto it = bit_driver.find(bit);
+					if (it != bit_driver.end() && it->second != port_node(wire->name))
+						edge_bits[std::make_pair(it->second, port_node(wire->name))]++;
+				}
+
+		fprintf(f, "digraph \"%s\" {\n", escape(module->name.str()));
+		if (!notitle)
+			fprintf(f, "label=\"%s (%d cells, summarized by type)\";\n", escape(module->name.str()), num_cells);
+		fprintf(f, "rankdir=\"LR\";\n");
+		fprintf(f, "remincross=true;\n");
+
+		for (auto wire : module->wires())
+			if (wire->port_input || wire->port_output)
+				fprintf(f, "%s [ shape=octagon, label=\"%s\" ];\n", port_node(wire->name).c_str(), findLabel(wire->name.str()));
+
+		for (auto &it : type_count)
+			fprintf(f, "%s [ shape=box, label=\"%s\\nx%d\" ];\n", type_node(it.first).c_str(), escape(it.first.str()), it.second);
+
+		for (auto &it : edge_bits)
+			fprintf(f, "%s:e -> %s:w [%s];\n", it.first.first.c_str(), it.first.second.c_str(), widthLabel(it.second).c_str());
+
+		fprintf(f, "}\n");
+	}
+
 	void handle_module()
 	{
+		if (budget > 0 && GetSize(module->selected_cells()) > budget) {
+			log("Module %s has more than %d selected cells, summarizing by cell type.\n", log_id(module->name), budget);
+			handle_module_summarized(GetSize(module->selected_cells()));
+			return;
+		}
+
 		single_idx_count = 0;
 		dot_escape_store.clear();
 		dot_id2num_store.clear();
@@ -619,10 +702,10 @@ struct ShowWorker
 	ShowWorker(FILE *f, RTLIL::Design *design, std::vector<RTLIL::Design*> &libs, uint32_t colorSeed, bool genWidthLabels,
 			bool genSignedLabels, bool stretchIO, bool enumerateIds, bool abbreviateIds, bool notitle, bool href,
 			const std::vector<std::pair<std::string, RTLIL::Selection>> &color_selections,
-			const std::vector<std::pair<std::string, RTLIL::Selection>> &label_selections, RTLIL::IdString colorattr) :
+			const std::vector<std::pair<std::string, RTLIL::Selection>> &label_selections, RTLIL::IdString colorattr, int budget) :
 			f(f), design(design), currentColor(colorSeed), genWidthLabels(genWidthLabels),
 			genSignedLabels(genSignedLabels), stretchIO(stretchIO), enumerateIds(enumerateIds), abbreviateIds(abbreviateIds),
-			notitle(notitle), href(href), color_selections(color_selections), label_selections(label_selections), colorattr(colorattr)
+			notitle(notitle), href(href), budget(budget), color_selections(color_selections), label_selections(label_selections), colorattr(colorattr)
 	{
 		ct.setup_internals();
 		ct.setup_internals_mem();
@@ -731,6 +814,12 @@ struct ShowPass : public Pass {
 		log("    -notitle\n");
 		log("        do not add the module name as graph title to the dot file\n");
 		log("\n");
+		log("    -budget <num_cells>\n");
+		log("        when a module has more than <num_cells> selected cells, emit a\n");
+		log("        summary graph with one node per cell type (plus the module ports)\n");
+		log("        instead of drawing every cell, keeping huge cones viewable\n");
+		log("        (default: 0, always draw every cell)\n");
+		log("\n");
 		log("    -nobg\n");
 		log("        don't run viewer in the background, IE wait for the viewer tool to\n");
 		log("        exit before returning\n");
@@ -778,6 +867,7 @@ struct ShowPass : public Pass {
 		bool flag_notitle = false;
 		bool flag_href = false;
 		bool custom_prefix = false;
+		int budget = 0;
 		std::string background = "&";
 		RTLIL::IdString colorattr;
 
@@ -860,6 +950,10 @@ struct ShowPass : public Pass {
 				flag_notitle = true;
 				continue;
 			}
+			if (arg == "-budget" && argidx+1 < args.size()) {
+				budget = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (arg == "-nobg") {
 				background= "";
 				continue;
@@ -912,7 +1006,7 @@ struct ShowPass : public Pass {
 				delete lib;
 			log_cmd_error("Can't open dot file `%s' for writing.\n", dot_file.c_str());
 		}
-		ShowWorker worker(f, design, libs, colorSeed, flag_width, flag_signed, flag_stretch, flag_enum, flag_abbreviate, flag_notitle, flag_href, color_selections, label_selections, colorattr);
+		ShowWorker worker(f, design, libs, colorSeed, flag_width, flag_signed, flag_stretch, flag_enum, flag_abbreviate, flag_notitle, flag_href, color_selections, label_selections, colorattr, budget);
 		fclose(f);
 
 		for (auto lib : libs)
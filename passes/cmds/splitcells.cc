@@ -66,7 +66,77 @@ struct SplitcellsWorker
 		}
 	}
 
-	int split(Cell *cell, const std::string &format)
+	// the usage index is maintained incrementally while cells are split, so
+	// it is built only once per module: split() removes the index entries of
+	// the original cell and registers its slices, and reports the drivers of
+	// the split cell's inputs (the only cells whose output usage changed) so
+	// the caller can re-examine just those
+
+	void remove_cell_users(Cell *cell)
+	{
+		for (auto conn : cell->connections()) {
+			if (!cell->input(conn.first)) continue;
+			for (int i = 0; i < GetSize(conn.second); i++) {
+				SigBit bit(sigmap(conn.second[i]));
+				auto it = bit_drivers_db.find(bit);
+				if (it == bit_drivers_db.end()) continue;
+				bit_users_db[bit].erase(tuple<IdString,IdString,int>(cell->name,
+						conn.first, i-std::get<2>(it->second)));
+			}
+		}
+	}
+
+	void set_bit_driver(SigBit bit, IdString cell_name, IdString port, int offset)
+	{
+		// user entries are normalized to the driver offset, so when the
+		// driver of a bit changes, shift the existing entries to the new
+		// baseline to keep later lookups and comparisons consistent
+		auto it = bit_drivers_db.find(bit);
+		if (it != bit_drivers_db.end() && bit_users_db.count(bit)) {
+			int delta = std::get<2>(it->second) - offset;
+			if (delta != 0) {
+				pool<tuple<IdString,IdString,int>> new_users;
+				for (auto &user : bit_users_db.at(bit))
+					new_users.insert(tuple<IdString,IdString,int>(std::get<0>(user),
+							std::get<1>(user), std::get<2>(user)+delta));
+				bit_users_db.at(bit) = std::move(new_users);
+			}
+		}
+		bit_drivers_db[bit] = tuple<IdString,IdString,int>(cell_name, port, offset);
+	}
+
+	void register_cell(Cell *cell)
+	{
+		for (auto conn : cell->connections()) {
+			if (!cell->output(conn.first)) continue;
+			for (int i = 0; i < GetSize(conn.second); i++)
+				set_bit_driver(sigmap(conn.second[i]), cell->name, conn.first, i);
+		}
+
+		for (auto conn : cell->connections()) {
+			if (!cell->input(conn.first)) continue;
+			for (int i = 0; i < GetSize(conn.second); i++) {
+				SigBit bit(sigmap(conn.second[i]));
+				if (!bit_drivers_db.count(bit)) continue;
+				bit_users_db[bit].insert(tuple<IdString,IdString,int>(cell->name,
+						conn.first, i-std::get<2>(bit_drivers_db[bit])));
+			}
+		}
+	}
+
+	void collect_input_drivers(Cell *cell, pool<IdString> &driver_cells)
+	{
+		for (auto conn : cell->connections()) {
+			if (!cell->input(conn.first)) continue;
+			for (auto bit : sigmap(conn.second)) {
+				auto it = bit_drivers_db.find(bit);
+				if (it != bit_drivers_db.end())
+					driver_cells.insert(std::get<0>(it->second));
+			}
+		}
+	}
+
+	int split(Cell *cell, const std::string &format, pool<IdString> &retry_cells)
 	{
 		if (cell->type.in("$and", "$mux", "$not", "$or", "$pmux", "$xnor", "$xor"))
 		{
@@ -89,6 +159,9 @@ struct SplitcellsWorker
 			if (GetSize(slices) <= 1) return 0;
 			slices.push_back(GetSize(outsig));
 
+			collect_input_drivers(cell, retry_cells);
+			remove_cell_users(cell);
+
 			log("Splitting %s cell %s/%s into %d slices:\n", log_id(cell->type), log_id(module), log_id(cell), GetSize(slices)-1);
 			for (int i = 1; i < GetSize(slices); i++)
 			{
@@ -127,6 +200,8 @@ struct SplitcellsWorker
 				if (slice->hasParam(ID::WIDTH))
 					slice->setParam(ID::WIDTH, GetSize(slice->getPort(ID::Y)));
 
+				register_cell(slice);
+
 				log("  slice %d: %s => %s\n", i, log_id(slice_name), log_signal(slice->getPort(ID::Y)));
 			}
 
@@ -156,6 +231,9 @@ struct SplitcellsWorker
 			if (GetSize(slices) <= 1) return 0;
 			slices.push_back(GetSize(outsig));
 
+			collect_input_drivers(cell, retry_cells);
+			remove_cell_users(cell);
+
 			log("Splitting %s cell %s/%s into %d slices:\n", log_id(cell->type), log_id(module), log_id(cell), GetSize(slices)-1);
 			for (int i = 1; i < GetSize(slices); i++)
 			{
@@ -186,6 +264,8 @@ struct SplitcellsWorker
 
 				slice->setParam(ID::WIDTH, GetSize(slice->getPort(ID::Q)));
 
+				register_cell(slice);
+
 				log("  slice %d: %s => %s\n", i, log_id(slice_name), log_signal(slice->getPort(ID::Q)));
 			}
 
@@ -244,17 +324,25 @@ struct SplitcellsPass : public Pass {
 			int count_split_pre = 0;
 			int count_split_post = 0;
 
-			while (1) {
-				SplitcellsWorker worker(module);
-				bool did_something = false;
-				for (auto cell : module->selected_cells()) {
-					int n = worker.split(cell, format);
-					did_something |= (n != 0);
+			SplitcellsWorker worker(module);
+			std::vector<Cell*> worklist = module->selected_cells();
+
+			// splitting a cell can only make the drivers of its inputs newly
+			// splittable, so instead of re-scanning the whole module until
+			// fixpoint, re-examine just those cells
+			while (!worklist.empty()) {
+				pool<IdString> retry_cells;
+				for (auto cell : worklist) {
+					int n = worker.split(cell, format, retry_cells);
 					count_split_pre += (n != 0);
 					count_split_post += n;
 				}
-				if (!did_something)
-					break;
+				worklist.clear();
+				for (auto cell_name : retry_cells) {
+					Cell *cell = module->cell(cell_name);
+					if (cell != nullptr && design->selected(module, cell))
+						worklist.push_back(cell);
+				}
 			}
 
 			if (count_split_pre)
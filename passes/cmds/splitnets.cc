@@ -27,7 +27,7 @@ PRIVATE_NAMESPACE_BEGIN
 
 struct SplitnetsWorker
 {
-	std::map<RTLIL::Wire*, std::vector<RTLIL::SigBit>> splitmap;
+	dict<RTLIL::Wire*, std::vector<RTLIL::SigBit>> splitmap;
 
 	void append_wire(RTLIL::Module *module, RTLIL::Wire *wire, int offset, int width, std::string format)
 	{
@@ -87,9 +87,20 @@ struct SplitnetsWorker
 
 	void operator()(RTLIL::SigSpec &sig)
 	{
-		for (auto &bit : sig)
-			if (splitmap.count(bit.wire) > 0)
-				bit = splitmap.at(bit.wire).at(bit.offset);
+		// consecutive bits usually belong to the same wire, so cache the
+		// last lookup instead of querying the map once per bit
+		RTLIL::Wire *last_wire = nullptr;
+		const std::vector<RTLIL::SigBit> *last_map = nullptr;
+
+		for (auto &bit : sig) {
+			if (bit.wire != last_wire) {
+				last_wire = bit.wire;
+				auto it = splitmap.find(bit.wire);
+				last_map = it != splitmap.end() ? &it->second : nullptr;
+			}
+			if (last_map != nullptr)
+				bit = last_map->at(bit.offset);
+		}
 	}
 };
 
@@ -172,7 +183,7 @@ struct SplitnetsPass : public Pass {
 			{
 				CellTypes ct(design);
 
-				std::map<RTLIL::Wire*, std::set<int>> split_wires_at;
+				dict<RTLIL::Wire*, std::set<int>> split_wires_at;
 
 				for (auto c : module->cells())
 				for (auto &p : c->connections())
@@ -53,11 +53,10 @@ struct StaWorker
 	SigBit maxbit;
 
 	pool<SigBit> driven;
+	dict<SigBit, int> arrivals;
 
-	StaWorker(RTLIL::Module *module) : design(module->design), module(module), sigmap(module), maxarrival(0)
+	StaWorker(RTLIL::Module *module, TimingInfo &timing) : design(module->design), module(module), sigmap(module), maxarrival(0)
 	{
-		TimingInfo timing;
-
 		pool<IdString> unrecognised_cells;
 
 		for (auto cell : module->cells())
@@ -142,12 +141,13 @@ struct StaWorker
 		for (auto port_name : module->ports) {
 			auto wire = module->wire(port_name);
 			if (wire->port_input) {
+				// All primary inputs to arrive at time zero
 				for (const auto &b : sigmap(wire)) {
 					queue.emplace_back(b);
 					driven.insert(b);
+					if (b.wire)
+						arrivals[b] = 0;
 				}
-				// All primary inputs to arrive at time zero
-				wire->set_intvec_attribute(ID::sta_arrival, std::vector<int>(GetSize(wire), 0));
 			}
 			if (wire->port_output)
 				for (const auto &b : sigmap(wire))
@@ -164,38 +164,44 @@ struct StaWorker
 			auto it = data.find(b);
 			if (it == data.end())
 				continue;
-			const auto& src_arrivals = b.wire->get_intvec_attribute(ID::sta_arrival);
-			log_assert(GetSize(src_arrivals) == GetSize(b.wire));
-			auto src_arrival = src_arrivals[b.offset];
+			auto src_arrival = arrivals.at(b);
 			for (const auto &d : it->second.fanouts) {
 				const auto &dst_bit = std::get<0>(d);
-				auto dst_arrivals = dst_bit.wire->get_intvec_attribute(ID::sta_arrival);
-				if (dst_arrivals.empty())
-					dst_arrivals = std::vector<int>(GetSize(dst_bit.wire), -1);
-				else
-					log_assert(GetSize(dst_arrivals) == GetSize(dst_bit.wire));
-				auto &dst_arrival = dst_arrivals[dst_bit.offset];
 				auto new_arrival = src_arrival + std::get<1>(d);
-				if (dst_arrival < new_arrival) {
-					auto dst_wire = dst_bit.wire;
-					dst_arrival = std::max(dst_arrival, new_arrival);
-					dst_wire->set_intvec_attribute(ID::sta_arrival, dst_arrivals);
-					queue.emplace_back(dst_bit);
-
-					data[dst_bit].backtrack = b;
-					data[dst_bit].src_port = std::get<2>(d);
-
-					auto it = endpoints.find(dst_bit);
-					if (it != endpoints.end())
-						new_arrival += it->second.required;
-					if (new_arrival > maxarrival && driven.count(b)) {
-						maxarrival = new_arrival;
-						maxbit = dst_bit;
-					}
+				auto r = arrivals.insert(std::make_pair(dst_bit, new_arrival));
+				if (!r.second) {
+					if (r.first->second >= new_arrival)
+						continue;
+					r.first->second = new_arrival;
+				}
+				queue.emplace_back(dst_bit);
+
+				data[dst_bit].backtrack = b;
+				data[dst_bit].src_port = std::get<2>(d);
+
+				auto et = endpoints.find(dst_bit);
+				if (et != endpoints.end())
+					new_arrival += et->second.required;
+				if (new_arrival > maxarrival && driven.count(b)) {
+					maxarrival = new_arrival;
+					maxbit = dst_bit;
 				}
 			}
 		}
 
+		// write the computed arrival times back as (* sta_arrival *) in one
+		// go, instead of rewriting a whole per-wire vector on every single
+		// relaxation during propagation
+		dict<Wire*, std::vector<int>> wire_arrivals;
+		for (auto &it : arrivals) {
+			auto r = wire_arrivals.insert(std::make_pair(it.first.wire, std::vector<int>()));
+			if (r.second)
+				r.first->second.assign(GetSize(it.first.wire), -1);
+			r.first->second[it.first.offset] = it.second;
+		}
+		for (auto &it : wire_arrivals)
+			it.first->set_intvec_attribute(ID::sta_arrival, it.second);
+
 		auto b = maxbit;
 		if (b == SigBit()) {
 			log("No timing paths found.\n");
@@ -213,7 +219,7 @@ struct StaWorker
 		}
 		auto jt = data.find(b);
 		while (jt != data.end()) {
-			int arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
+			int arrival = arrivals.at(b);
 			if (jt->second.driver) {
 				log("           %s\n", log_signal(b));
 				log("  %6d %s (%s.%s->%s)\n", arrival, log_id(jt->second.driver), log_id(jt->second.driver->type), log_id(jt->second.src_port), log_id(jt->second.dst_port));
@@ -232,17 +238,13 @@ struct StaWorker
 			if (!driven.count(b))
 				continue;
 
-			if (!b.wire->attributes.count(ID::sta_arrival)) {
+			auto at = arrivals.find(b);
+			if (at == arrivals.end()) {
 				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
 				continue;
 			}
 
-			auto arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
-			if (arrival < 0) {
-				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
-				continue;
-			}
-			arrival += i.second.required;
+			auto arrival = at->second + i.second.required;
 			arrival_histogram[arrival]++;
 		}
 		// Adapted from https://github.com/YosysHQ/nextpnr/blob/affb12cc27ebf409eade062c4c59bb98569d8147/common/timing.cc#L946-L969
@@ -274,7 +276,7 @@ struct StaWorker
 };
 
 struct StaPass : public Pass {
-	StaPass() : Pass("sta", "perform static timing analysis") { }
+	StaPass() : Pass("sta", "perform static timing analysis") { readonly(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -301,12 +303,16 @@ struct StaPass : public Pass {
 
 		extra_args(args, 1, design);
 
+		// collect the timing arcs of each box type only once and share them
+		// across all selected modules
+		TimingInfo timing;
+
 		for (Module *module : design->selected_modules())
 		{
 			if (module->has_processes_warn())
 				continue;
 
-			StaWorker worker(module);
+			StaWorker worker(module, timing);
 			worker.run();
 		}
 	}
@@ -21,6 +21,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
+#include "kernel/threadpool.h"
 #include "passes/techmap/libparse.h"
 #include "kernel/cost.h"
 #include "libs/json11/json11.hpp"
@@ -367,8 +368,56 @@ void read_liberty_cellarea(dict<IdString, cell_area_t> &cell_area, string libert
 	}
 }
 
+// Flows tend to call `stat` after every major stage, and most modules are
+// unchanged between two calls. The per-module summaries are therefore kept
+// across invocations and revalidated with a content fingerprint: the monitor
+// API does not report cell creation or type rewrites, so hashing the module
+// is the only reliable invalidation signal. Fingerprinting only reads the
+// module, so it runs over all selected modules in parallel (see the
+// "threads" scratchpad variable).
+struct StatCacheEntry {
+	Hasher::hash_t fingerprint;
+	bool width_mode;
+	string tech, area_src;
+	statdata_t data;
+};
+
+static std::map<std::string, StatCacheEntry> stat_cache;
+
+static Hasher::hash_t module_fingerprint(RTLIL::Module *mod)
+{
+	Hasher h;
+
+	h.eat(GetSize(mod->wires_));
+	for (auto wire : mod->wires()) {
+		h.eat(wire->name);
+		h.hash32(wire->width);
+		h.hash32((wire->port_input ? 1 : 0) | (wire->port_output ? 2 : 0));
+	}
+
+	h.eat(GetSize(mod->memories));
+	for (auto &it : mod->memories) {
+		h.eat(it.first);
+		h.hash32(it.second->width);
+		h.hash32(it.second->size);
+	}
+
+	h.eat(GetSize(mod->cells_));
+	for (auto cell : mod->cells()) {
+		h.eat(cell->type);
+		for (auto &conn : cell->connections()) {
+			h.eat(conn.first);
+			h.hash32(GetSize(conn.second));
+		}
+	}
+
+	h.eat(GetSize(mod->processes));
+
+	return h.yield();
+}
+
 struct StatPass : public Pass {
-	StatPass() : Pass("stat", "print some statistics") { }
+	StatPass() : Pass("stat", "print some statistics") { readonly(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
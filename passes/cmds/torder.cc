@@ -20,13 +20,14 @@
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
+#include "kernel/toporder.h"
 #include "kernel/utils.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 struct TorderPass : public Pass {
-	TorderPass() : Pass("torder", "print cells in topological order") { }
+	TorderPass() : Pass("torder", "print cells in topological order") { readonly(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -70,51 +71,70 @@ struct TorderPass : public Pass {
 		{
 			log("module %s\n", log_id(module));
 
-			SigMap sigmap(module);
-			dict<SigBit, pool<IdString>> bit_drivers, bit_users;
-			TopoSort<IdString, RTLIL::sort_by_id_str> toposort;
+			// Only the default graph construction on a whole module is
+			// worth caching; custom stop rules and partial selections
+			// change the graph.
+			bool cacheable = stop_db.empty() && !noautostop && design->selected_whole_module(module);
 
-			for (auto cell : module->selected_cells())
-			for (auto conn : cell->connections())
-			{
-				if (stop_db.count(cell->type) && stop_db.at(cell->type).count(conn.first))
-					continue;
+			const TopoOrderInfo *info = cacheable ? TopoOrderCache::lookup(module, "torder") : nullptr;
+			TopoOrderInfo fresh;
 
-				if (!noautostop && yosys_celltypes.cell_known(cell->type)) {
-					if (conn.first.in(ID::Q, ID::CTRL_OUT, ID::RD_DATA))
-						continue;
-					if (cell->type.in(ID($memrd), ID($memrd_v2)) && conn.first == ID::DATA)
+			if (info == nullptr)
+			{
+				SigMap sigmap(module);
+				dict<SigBit, pool<IdString>> bit_drivers, bit_users;
+				TopoSort<IdString, RTLIL::sort_by_id_str> toposort;
+
+				for (auto cell : module->selected_cells())
+				for (auto conn : cell->connections())
+				{
+					if (stop_db.count(cell->type) && stop_db.at(cell->type).count(conn.first))
 						continue;
-				}
 
-				if (cell->input(conn.first))
-					for (auto bit : sigmap(conn.second))
-						bit_users[bit].insert(cell->name);
+					if (!noautostop && yosys_celltypes.cell_known(cell->type)) {
+						if (conn.first.in(ID::Q, ID::CTRL_OUT, ID::RD_DATA))
+							continue;
+						if (cell->type.in(ID($memrd), ID($memrd_v2)) && conn.first == ID::DATA)
+							continue;
+					}
 
-				if (cell->output(conn.first))
-					for (auto bit : sigmap(conn.second))
-						bit_drivers[bit].insert(cell->name);
+					if (cell->input(conn.first))
+						for (auto bit : sigmap(conn.second))
+							bit_users[bit].insert(cell->name);
 
-				toposort.node(cell->name);
-			}
+					if (cell->output(conn.first))
+						for (auto bit : sigmap(conn.second))
+							bit_drivers[bit].insert(cell->name);
 
-			for (auto &it : bit_users)
-				if (bit_drivers.count(it.first))
-					for (auto driver_cell : bit_drivers.at(it.first))
-					for (auto user_cell : it.second)
-						toposort.edge(driver_cell, user_cell);
+					toposort.node(cell->name);
+				}
+
+				for (auto &it : bit_users)
+					if (bit_drivers.count(it.first))
+						for (auto driver_cell : bit_drivers.at(it.first))
+						for (auto user_cell : it.second)
+							toposort.edge(driver_cell, user_cell);
+
+				toposort.analyze_loops = true;
+				toposort.sort();
 
-			toposort.analyze_loops = true;
-			toposort.sort();
+				fresh.loops.assign(toposort.loops.begin(), toposort.loops.end());
+				fresh.order = std::move(toposort.sorted);
+
+				if (cacheable)
+					info = TopoOrderCache::store(module, "torder", std::move(fresh));
+				else
+					info = &fresh;
+			}
 
-			for (auto &it : toposort.loops) {
+			for (auto &it : info->loops) {
 				log("  loop");
 				for (auto cell : it)
 					log(" %s", log_id(cell));
 				log("\n");
 			}
 
-			for (auto cell : toposort.sorted)
+			for (auto cell : info->order)
 					log("  cell %s\n", log_id(cell));
 		}
 	}
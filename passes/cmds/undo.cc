@@ -0,0 +1,164 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/undo.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct UndoPass : public Pass {
+	UndoPass() : Pass("undo", "revert the changes of the last command") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    undo [-start [-depth <n>] | -stop | -status]\n");
+		log("\n");
+		log("Without options, revert the design changes made by the last recorded command.\n");
+		log("Undone commands can be re-applied with the 'redo' command until the next\n");
+		log("design-changing command discards the redo stack.\n");
+		log("\n");
+		log("Recording is opt-in. While it is active, every completed top-level command\n");
+		log("is stored as a compact reverse delta: the binary RTLIL state of just the\n");
+		log("modules it changed, before and after the command. Changed modules are found\n");
+		log("via the RTLIL::Monitor events (the same mechanism the 'journal' command\n");
+		log("uses) plus an object-count check; commands that only change attributes or\n");
+		log("parameters of existing objects escape both and cannot be undone.\n");
+		log("\n");
+		log("    -start\n");
+		log("        start recording. serializes a baseline of the current design, so\n");
+		log("        this costs one in-memory design snapshot up front.\n");
+		log("\n");
+		log("    -depth <n>\n");
+		log("        with -start: keep at most <n> undo records, discarding the oldest\n");
+		log("        (default 20). bounds the history memory together with the\n");
+		log("        per-command deltas only covering changed modules.\n");
+		log("\n");
+		log("    -stop\n");
+		log("        stop recording and discard all recorded state\n");
+		log("\n");
+		log("    -status\n");
+		log("        print the recorded commands and the history memory usage\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool start_mode = false, stop_mode = false, status_mode = false;
+		int depth = -1;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-start") {
+				start_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-depth" && argidx+1 < args.size()) {
+				depth = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-stop") {
+				stop_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-status") {
+				status_mode = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (start_mode && stop_mode)
+			log_cmd_error("Options -start and -stop are exclusive.\n");
+
+		if (depth == 0 || depth < -1)
+			log_cmd_error("Invalid -depth value.\n");
+
+		if (depth > 0 && !start_mode)
+			log_cmd_error("Option -depth is only valid together with -start.\n");
+
+		if (start_mode) {
+			bool was_active = DesignUndoHistory::get(design) != nullptr;
+			DesignUndoHistory *history = DesignUndoHistory::start(design);
+			if (depth > 0)
+				history->max_depth = depth;
+			log("%s undo history (depth %d).\n", was_active ? "Already recording" : "Started recording", history->max_depth);
+			return;
+		}
+
+		if (stop_mode) {
+			DesignUndoHistory::stop(design);
+			log("Stopped recording undo history.\n");
+			return;
+		}
+
+		DesignUndoHistory *history = DesignUndoHistory::get(design);
+		if (history == nullptr)
+			log_cmd_error("No undo history is recorded for this design. Use 'undo -start' first.\n");
+
+		if (status_mode) {
+			log("Undo history status:\n");
+			log("  baseline modules:   %d\n", GetSize(history->baseline));
+			log("  undo records:       %d (depth limit %d)\n", GetSize(history->undo_stack), history->max_depth);
+			log("  redo records:       %d\n", GetSize(history->redo_stack));
+			log("  history memory:     %.1f MiB\n", history->memory_bytes() / 1024.0 / 1024.0);
+			for (auto &record : history->undo_stack)
+				log("  undo: %s (%d modules)\n", record.command.c_str(), GetSize(record.modules));
+			for (auto &record : history->redo_stack)
+				log("  redo: %s (%d modules)\n", record.command.c_str(), GetSize(record.modules));
+			return;
+		}
+
+		std::string command;
+		if (!history->undo(command))
+			log_cmd_error("Nothing to undo.\n");
+		log("Reverted the changes of `%s'.\n", command.c_str());
+	}
+} UndoPass;
+
+struct RedoPass : public Pass {
+	RedoPass() : Pass("redo", "re-apply the changes of the last undone command") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    redo\n");
+		log("\n");
+		log("Re-apply the design changes of the last command reverted with 'undo'. The\n");
+		log("redo stack is discarded when a new design-changing command runs. See the\n");
+		log("'undo' command for how recording is enabled.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		extra_args(args, 1, design, false);
+
+		DesignUndoHistory *history = DesignUndoHistory::get(design);
+		if (history == nullptr)
+			log_cmd_error("No undo history is recorded for this design. Use 'undo -start' first.\n");
+
+		std::string command;
+		if (!history->redo(command))
+			log_cmd_error("Nothing to redo.\n");
+		log("Re-applied the changes of `%s'.\n", command.c_str());
+	}
+} RedoPass;
+
+PRIVATE_NAMESPACE_END
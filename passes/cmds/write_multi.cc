@@ -0,0 +1,72 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct WriteMultiPass : public Pass {
+	WriteMultiPass() : Pass("write_multi", "export the design in several formats in one command") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    write_multi -b <backend_command> [-b <backend_command> ...]\n");
+		log("\n");
+		log("Run several backend command lines against the same design state, e.g. to\n");
+		log("export both Verilog and JSON of a netlist in one go:\n");
+		log("\n");
+		log("    write_multi -b \"verilog -noattr top.v\" -b \"json top.json\"\n");
+		log("\n");
+		log("The design-wide preparation that each write command would otherwise redo\n");
+		log("(sorting the object dictionaries of all modules) is only paid by the first\n");
+		log("backend; each further backend only pays for its own traversal and output\n");
+		log("formatting.\n");
+		log("\n");
+		log("    -b <backend_command>\n");
+		log("        a backend command line, including the output filename, as it would\n");
+		log("        be given to the corresponding write_* command. can be used multiple\n");
+		log("        times; the commands run in the given order.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		std::vector<std::string> commands;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-b" && argidx+1 < args.size()) {
+				commands.push_back(args[++argidx]);
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design, false);
+
+		if (commands.empty())
+			log_cmd_error("Missing required -b option.\n");
+
+		log_header(design, "Executing WRITE_MULTI pass (multi-format export).\n");
+
+		Backend::backend_call_multi(design, commands);
+	}
+} WriteMultiPass;
+
+PRIVATE_NAMESPACE_END
@@ -23,8 +23,8 @@
 #include "kernel/modtools.h"
 #include "kernel/sigtools.h"
 #include "kernel/utils.h"
+#include "kernel/xanalysis.h"
 #include "kernel/yosys.h"
-#include <deque>
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -88,12 +88,9 @@ struct XpropWorker
 	SigMap &sigmap;
 	FfInitVals initvals;
 
-	pool<SigBit> maybe_x_bits;
+	MaybeXAnalysis xanalysis;
 	dict<SigBit, EncodedBit> encoded_bits;
 
-	pool<Cell *> pending_cells;
-	std::deque<Cell *> pending_cell_queue;
-
 	XpropWorker(Module *module, XpropOptions options) :
 		module(module), options(options),
 		modwalker(module->design), sigmap(modwalker.sigmap)
@@ -101,32 +98,17 @@ struct XpropWorker
 		modwalker.setup(module);
 		initvals.set(&modwalker.sigmap, module);
 
-		maybe_x_bits.insert(State::Sx);
-
-		for (auto cell : module->cells()) {
-			pending_cells.insert(cell);
-			pending_cell_queue.push_back(cell);
-		}
-
-		if (!options.assume_def_inputs) {
-			for (auto port : module->ports) {
-				auto wire = module->wire(port);
-				if (wire->port_input)
-					mark_maybe_x(SigSpec(wire));
-			}
-		}
+		xanalysis.setup(module, &modwalker, &initvals, options.assume_def_inputs);
 	}
 
 	bool maybe_x(SigBit bit)
 	{
-		return maybe_x_bits.count(sigmap(bit));
+		return xanalysis.maybe_x(bit);
 	}
 
 	bool maybe_x(const SigSpec &sig)
 	{
-		for (auto bit : sig)
-			if (maybe_x(bit)) return true;
-		return false;
+		return xanalysis.maybe_x(sig);
 	}
 
 	bool ports_maybe_x(Cell *cell)
@@ -145,32 +127,6 @@ struct XpropWorker
 		return false;
 	}
 
-	void mark_maybe_x(SigBit bit)
-	{
-		sigmap.apply(bit);
-		if (!maybe_x_bits.insert(bit).second)
-			return;
-		auto it = modwalker.signal_consumers.find(bit);
-		if (it == modwalker.signal_consumers.end())
-			return;
-		for (auto &consumer : it->second)
-			if (pending_cells.insert(consumer.cell).second)
-				pending_cell_queue.push_back(consumer.cell);
-	}
-
-	void mark_maybe_x(const SigSpec &sig)
-	{
-		for (auto bit : sig)
-			mark_maybe_x(bit);
-	}
-
-	void mark_outputs_maybe_x(Cell *cell)
-	{
-		for (auto &conn : cell->connections())
-			if (cell->output(conn.first))
-				mark_maybe_x(conn.second);
-	}
-
 	EncodedSig encoded(SigSpec sig, bool driving = false)
 	{
 		EncodedSig result;
@@ -283,187 +239,7 @@ struct XpropWorker
 
 	void mark_all_maybe_x()
 	{
-		while (!pending_cell_queue.empty()) {
-			Cell *cell = pending_cell_queue.front();
-			pending_cell_queue.pop_front();
-			pending_cells.erase(cell);
-
-			mark_maybe_x(cell);
-		}
-	}
-
-	void mark_maybe_x(Cell *cell) {
-		if (cell->type.in(ID($bweqx), ID($eqx), ID($nex), ID($initstate), ID($assert), ID($assume), ID($cover), ID($anyseq), ID($anyconst)))
-			return;
-
-		if (cell->type.in(ID($pmux))) {
-			mark_outputs_maybe_x(cell);
-			return;
-		}
-
-		if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit)) {
-			FfData ff(&initvals, cell);
-
-			if (cell->type != ID($anyinit))
-				for (int i = 0; i < ff.width; i++)
-					if (ff.val_init[i] == State::Sx)
-						mark_maybe_x(ff.sig_q[i]);
-
-			for (int i = 0; i < ff.width; i++)
-				if (maybe_x(ff.sig_d[i]))
-					mark_maybe_x(ff.sig_q[i]);
-
-			if ((ff.has_clk || ff.has_gclk) && !ff.has_ce && !ff.has_aload && !ff.has_srst && !ff.has_arst && !ff.has_sr)
-				return;
-		}
-
-		if (cell->type == ID($not)) {
-			auto &sig_y = cell->getPort(ID::Y);
-			auto sig_a = cell->getPort(ID::A); sig_a.extend_u0(GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
-			for (int i = 0; i < GetSize(sig_y); i++)
-				if (maybe_x(sig_a[i]))
-					mark_maybe_x(sig_y[i]);
-			return;
-		}
-
-		if (cell->type.in(ID($and), ID($or), ID($xor), ID($xnor))) {
-			auto &sig_y = cell->getPort(ID::Y);
-			auto sig_a = cell->getPort(ID::A); sig_a.extend_u0(GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
-			auto sig_b = cell->getPort(ID::B); sig_b.extend_u0(GetSize(sig_y), cell->getParam(ID::B_SIGNED).as_bool());
-			for (int i = 0; i < GetSize(sig_y); i++)
-				if (maybe_x(sig_a[i]) || maybe_x(sig_b[i]))
-					mark_maybe_x(sig_y[i]);
-			return;
-		}
-
-		if (cell->type.in(ID($bwmux))) {
-			auto &sig_y = cell->getPort(ID::Y);
-			auto &sig_a = cell->getPort(ID::A);
-			auto &sig_b = cell->getPort(ID::B);
-			auto &sig_s = cell->getPort(ID::S);
-			for (int i = 0; i < GetSize(sig_y); i++)
-				if (maybe_x(sig_a[i]) || maybe_x(sig_b[i]) || maybe_x(sig_s[i]))
-					mark_maybe_x(sig_y[i]);
-			return;
-		}
-
-		if (cell->type.in(ID($_MUX_), ID($mux), ID($bmux))) {
-			auto &sig_y = cell->getPort(ID::Y);
-			auto &sig_a = cell->getPort(ID::A);
-			auto &sig_b = cell->getPort(ID::B);
-			auto &sig_s = cell->getPort(ID::S);
-			if (maybe_x(sig_s)) {
-				mark_maybe_x(sig_y);
-				return;
-			}
-			for (int i = 0; i < GetSize(sig_y); i++) {
-				if (maybe_x(sig_a[i])) {
-					mark_maybe_x(sig_y[i]);
-					continue;
-				}
-				for (int j = i; j < GetSize(sig_b); j += GetSize(sig_y)) {
-					if (maybe_x(sig_b[j])) {
-						mark_maybe_x(sig_y[i]);
-						break;
-					}
-				}
-			}
-			return;
-		}
-
-		if (cell->type.in(ID($demux))) {
-			auto &sig_y = cell->getPort(ID::Y);
-			auto &sig_a = cell->getPort(ID::A);
-			auto &sig_s = cell->getPort(ID::S);
-			if (maybe_x(sig_s)) {
-				mark_maybe_x(sig_y);
-				return;
-			}
-			for (int i = 0; i < GetSize(sig_a); i++)
-				if (maybe_x(sig_a[i]))
-					for (int j = i; j < GetSize(sig_y); j += GetSize(sig_a))
-						mark_maybe_x(sig_y[j]);
-			return;
-		}
-
-		if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr), ID($shift))) {
-			auto &sig_b = cell->getPort(ID::B);
-			auto &sig_y = cell->getPort(ID::Y);
-
-			if (maybe_x(sig_b)) {
-				mark_maybe_x(sig_y);
-				return;
-			}
-
-			auto &sig_a = cell->getPort(ID::A);
-
-			if (maybe_x(sig_a)) {
-				// We could be more precise for shifts, but that's not required
-				// for correctness, so let's keep it simple
-				mark_maybe_x(sig_y);
-				return;
-			}
-			return;
-		}
-
-		if (cell->type.in(ID($shiftx))) {
-			auto &sig_b = cell->getPort(ID::B);
-			auto &sig_y = cell->getPort(ID::Y);
-
-			if (cell->getParam(ID::B_SIGNED).as_bool() || GetSize(sig_b) >= 30) {
-				mark_maybe_x(sig_y);
-			} else {
-				int max_shift = (1 << GetSize(sig_b)) - 1;
-
-				auto &sig_a = cell->getPort(ID::A);
-
-				for (int i = 0; i < GetSize(sig_y); i++)
-					if (i + max_shift >= GetSize(sig_a))
-						mark_maybe_x(sig_y[i]);
-			}
-
-			if (maybe_x(sig_b)) {
-				mark_maybe_x(sig_y);
-				return;
-			}
-
-			auto &sig_a = cell->getPort(ID::A);
-			if (maybe_x(sig_a)) {
-				// We could be more precise for shifts, but that's not required
-				// for correctness, so let's keep it simple
-				mark_maybe_x(sig_y);
-				return;
-			}
-			return;
-		}
-
-		if (cell->type.in(ID($add), ID($sub), ID($mul), ID($neg))) {
-			if (inputs_maybe_x(cell))
-				mark_outputs_maybe_x(cell);
-			return;
-		}
-
-		if (cell->type.in(ID($div), ID($mod), ID($divfloor), ID($modfloor))) {
-			mark_outputs_maybe_x(cell);
-			return;
-		}
-
-		if (cell->type.in(
-			ID($le), ID($lt), ID($ge), ID($gt),
-			ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor),
-			ID($reduce_bool), ID($logic_not), ID($logic_or), ID($logic_and),
-			ID($eq), ID($ne),
-
-			ID($_NOT_), ID($_AND_), ID($_NAND_), ID($_ANDNOT_), ID($_OR_), ID($_NOR_), ID($_ORNOT_), ID($_XOR_), ID($_XNOR_)
-		)) {
-			auto &sig_y = cell->getPort(ID::Y);
-			if (inputs_maybe_x(cell))
-				mark_maybe_x(sig_y[0]);
-			return;
-		}
-
-		log_warning("Unhandled cell %s (%s) during maybe-x marking\n", log_id(cell), log_id(cell->type));
-		mark_outputs_maybe_x(cell);
+		xanalysis.run();
 	}
 
 	void process_cells()
@@ -20,6 +20,7 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -30,6 +31,11 @@ struct EquivMakeWorker
 	pool<IdString> wire_names, cell_names;
 	CellTypes ct;
 
+	// candidate names with their _gold/_gate variants, interned once after
+	// copy_to_equiv instead of once per matching loop
+	struct name_pair_t { IdString id, gold_id, gate_id; };
+	vector<name_pair_t> wire_pairs, cell_pairs;
+
 	bool inames;
 	vector<string> blacklists;
 	vector<string> encfiles;
@@ -132,6 +138,11 @@ struct EquivMakeWorker
 		gate_clone->cloneInto(equiv_mod);
 		delete gold_clone;
 		delete gate_clone;
+
+		for (auto id : wire_names)
+			wire_pairs.push_back({id, id.str() + "_gold", id.str() + "_gate"});
+		for (auto id : cell_names)
+			cell_pairs.push_back({id, id.str() + "_gold", id.str() + "_gate"});
 	}
 
 	void add_eq_assertion(const SigSpec &gold_sig, const SigSpec &gate_sig)
@@ -149,13 +160,24 @@ struct EquivMakeWorker
 		// list of cells without added $equiv cells
 		auto cells_list = equiv_mod->cells().to_vector();
 
-		for (auto id : wire_names)
+		// resolving the candidate names to wire pairs is a read-only join
+		// and runs on the thread pool; all mutation below stays on the
+		// main thread
+		std::vector<std::pair<Wire*, Wire*>> resolved(GetSize(wire_pairs));
+		ThreadPool::run(ThreadPool::thread_count(equiv_mod->design), GetSize(wire_pairs), [&](int idx) {
+			resolved[idx].first = equiv_mod->wire(wire_pairs[idx].gold_id);
+			resolved[idx].second = equiv_mod->wire(wire_pairs[idx].gate_id);
+		});
+
+		// new connections are committed in one batch at the end
+		std::vector<SigSig> new_conns;
+
+		for (int pair_idx = 0; pair_idx < GetSize(wire_pairs); pair_idx++)
 		{
-			IdString gold_id = id.str() + "_gold";
-			IdString gate_id = id.str() + "_gate";
+			IdString id = wire_pairs[pair_idx].id;
 
-			Wire *gold_wire = equiv_mod->wire(gold_id);
-			Wire *gate_wire = equiv_mod->wire(gate_id);
+			Wire *gold_wire = resolved[pair_idx].first;
+			Wire *gate_wire = resolved[pair_idx].second;
 
 			if (encdata.count(id))
 			{
@@ -249,7 +271,7 @@ struct EquivMakeWorker
 				if (make_assert)
 				{
 					add_eq_assertion(gold_wire, gate_wire);
-					equiv_mod->connect(wire, gold_wire);
+					new_conns.push_back(SigSig(wire, gold_wire));
 				}
 				else
 				{
@@ -267,8 +289,8 @@ struct EquivMakeWorker
 				wire->port_input = true;
 				gold_wire->port_input = false;
 				gate_wire->port_input = false;
-				equiv_mod->connect(gold_wire, wire);
-				equiv_mod->connect(gate_wire, wire);
+				new_conns.push_back(SigSig(gold_wire, wire));
+				new_conns.push_back(SigSig(gate_wire, wire));
 				primary_inputs.add(assign_map(gold_wire));
 				primary_inputs.add(assign_map(gate_wire));
 				primary_inputs.add(wire);
@@ -319,6 +341,12 @@ struct EquivMakeWorker
 				}
 			}
 
+		if (!new_conns.empty()) {
+			std::vector<SigSig> conns = equiv_mod->connections();
+			conns.insert(conns.end(), new_conns.begin(), new_conns.end());
+			equiv_mod->new_connections(conns);
+		}
+
 		equiv_mod->fixup_ports();
 	}
 
@@ -326,22 +354,37 @@ struct EquivMakeWorker
 	{
 		SigMap assign_map(equiv_mod);
 
-		for (auto id : cell_names)
-		{
-			IdString gold_id = id.str() + "_gold";
-			IdString gate_id = id.str() + "_gate";
-
-			Cell *gold_cell = equiv_mod->cell(gold_id);
-			Cell *gate_cell = equiv_mod->cell(gate_id);
+		// the name-indexed join of gold vs. gate cells only reads the
+		// module, so the candidates are resolved and filtered on the
+		// thread pool; the rewiring below stays on the main thread
+		std::vector<std::pair<Cell*, Cell*>> resolved(GetSize(cell_pairs), {nullptr, nullptr});
+		ThreadPool::run(ThreadPool::thread_count(equiv_mod->design), GetSize(cell_pairs), [&](int idx) {
+			Cell *gold_cell = equiv_mod->cell(cell_pairs[idx].gold_id);
+			Cell *gate_cell = equiv_mod->cell(cell_pairs[idx].gate_id);
 
 			if (gold_cell == nullptr || gate_cell == nullptr || gold_cell->type != gate_cell->type || !ct.cell_known(gold_cell->type) ||
 					gold_cell->parameters != gate_cell->parameters || GetSize(gold_cell->connections()) != GetSize(gate_cell->connections()))
-		try_next_cell_name:
-				continue;
+				return;
 
-			for (auto gold_conn : gold_cell->connections())
+			for (auto &gold_conn : gold_cell->connections())
 				if (!gate_cell->connections().count(gold_conn.first))
-					goto try_next_cell_name;
+					return;
+
+			resolved[idx] = {gold_cell, gate_cell};
+		});
+
+		// new connections are committed in one batch at the end
+		std::vector<SigSig> new_conns;
+
+		for (int pair_idx = 0; pair_idx < GetSize(cell_pairs); pair_idx++)
+		{
+			IdString id = cell_pairs[pair_idx].id;
+
+			Cell *gold_cell = resolved[pair_idx].first;
+			Cell *gate_cell = resolved[pair_idx].second;
+
+			if (gold_cell == nullptr)
+				continue;
 
 			log("Presumably equivalent cells: %s %s (%s) -> %s\n",
 					log_id(gold_cell), log_id(gate_cell), log_id(gold_cell->type), log_id(id));
@@ -352,7 +395,7 @@ struct EquivMakeWorker
 				SigSpec gate_sig = assign_map(gate_cell->getPort(gold_conn.first));
 
 				if (ct.cell_output(gold_cell->type, gold_conn.first)) {
-					equiv_mod->connect(gate_sig, gold_sig);
+					new_conns.push_back(SigSig(gate_sig, gold_sig));
 					continue;
 				}
 
@@ -377,6 +420,12 @@ struct EquivMakeWorker
 			equiv_mod->remove(gate_cell);
 			equiv_mod->rename(gold_cell, id);
 		}
+
+		if (!new_conns.empty()) {
+			std::vector<SigSig> conns = equiv_mod->connections();
+			conns.insert(conns.end(), new_conns.begin(), new_conns.end());
+			equiv_mod->new_connections(conns);
+		}
 	}
 
 	void find_undriven_nets(bool mark)
@@ -26,7 +26,6 @@ PRIVATE_NAMESPACE_BEGIN
 struct EquivSimpleWorker
 {
 	Module *module;
-	const vector<Cell*> &equiv_cells;
 	Cell *equiv_cell;
 
 	SigMap &sigmap;
@@ -40,8 +39,8 @@ struct EquivSimpleWorker
 
 	pool<pair<Cell*, int>> imported_cells_cache;
 
-	EquivSimpleWorker(const vector<Cell*> &equiv_cells, SigMap &sigmap, dict<SigBit, Cell*> &bit2driver, int max_seq, bool short_cones, bool verbose, bool model_undef) :
-			module(equiv_cells.front()->module), equiv_cells(equiv_cells), equiv_cell(nullptr),
+	EquivSimpleWorker(Module *module, SigMap &sigmap, dict<SigBit, Cell*> &bit2driver, int max_seq, bool short_cones, bool verbose, bool model_undef) :
+			module(module), equiv_cell(nullptr),
 			sigmap(sigmap), bit2driver(bit2driver), satgen(ez.get(), &sigmap), max_seq(max_seq), short_cones(short_cones), verbose(verbose)
 	{
 		satgen.model_undef = model_undef;
@@ -255,7 +254,7 @@ struct EquivSimpleWorker
 		return false;
 	}
 
-	int run()
+	int run(const vector<Cell*> &equiv_cells)
 	{
 		if (GetSize(equiv_cells) > 1) {
 			SigSpec sig;
@@ -298,13 +297,21 @@ struct EquivSimplePass : public Pass {
 		log("    -nogroup\n");
 		log("        disabling grouping of $equiv cells by output wire\n");
 		log("\n");
+		log("    -incremental\n");
+		log("        use a single incremental SAT solver per module instead of a fresh\n");
+		log("        solver per group of $equiv cells. The encoded input cones stay in\n");
+		log("        the solver across groups (handled cells are retired via assumptions),\n");
+		log("        so shared logic is only encoded once. This is faster on designs with\n");
+		log("        many $equiv cells over common fanin cones, at the cost of a growing\n");
+		log("        SAT problem.\n");
+		log("\n");
 		log("    -seq <N>\n");
 		log("        the max. number of time steps to be considered (default = 1)\n");
 		log("\n");
 	}
 	void execute(std::vector<std::string> args, Design *design) override
 	{
-		bool verbose = false, short_cones = false, model_undef = false, nogroup = false;
+		bool verbose = false, short_cones = false, model_undef = false, nogroup = false, incremental = false;
 		int success_counter = 0;
 		int max_seq = 1;
 
@@ -328,6 +335,10 @@ struct EquivSimplePass : public Pass {
 				nogroup = true;
 				continue;
 			}
+			if (args[argidx] == "-incremental") {
+				incremental = true;
+				continue;
+			}
 			if (args[argidx] == "-seq" && argidx+1 < args.size()) {
 				max_seq = atoi(args[++argidx].c_str());
 				continue;
@@ -375,6 +386,13 @@ struct EquivSimplePass : public Pass {
 			}
 
 			unproven_equiv_cells.sort();
+
+			// In incremental mode one solver serves all groups of the module,
+			// so the cone clauses encoded for one group are reused by the next.
+			std::unique_ptr<EquivSimpleWorker> shared_worker;
+			if (incremental)
+				shared_worker.reset(new EquivSimpleWorker(module, sigmap, bit2driver, max_seq, short_cones, verbose, model_undef));
+
 			for (auto it : unproven_equiv_cells)
 			{
 				it.second.sort();
@@ -383,8 +401,12 @@ struct EquivSimplePass : public Pass {
 				for (auto it2 : it.second)
 					cells.push_back(it2.second);
 
-				EquivSimpleWorker worker(cells, sigmap, bit2driver, max_seq, short_cones, verbose, model_undef);
-				success_counter += worker.run();
+				if (incremental) {
+					success_counter += shared_worker->run(cells);
+				} else {
+					EquivSimpleWorker worker(module, sigmap, bit2driver, max_seq, short_cones, verbose, model_undef);
+					success_counter += worker.run(cells);
+				}
 			}
 		}
 
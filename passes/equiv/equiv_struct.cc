@@ -34,22 +34,48 @@ struct EquivStructWorker
 
 	const pool<IdString> &fwonly_cells;
 
-	struct merge_key_t
+	// The iteration-invariant part of a merge key: cell type, parameters and
+	// port sizes never change across the fixpoint iterations (merging only
+	// rewires connections), so these are interned into dense class ids that
+	// are cached per cell name for the whole pass.
+	struct static_key_t
 	{
 		IdString type;
 		vector<pair<IdString, Const>> parameters;
 		vector<pair<IdString, int>> port_sizes;
-		vector<tuple<IdString, int, SigBit>> connections;
 
-		bool operator==(const merge_key_t &other) const {
-			return type == other.type && connections == other.connections &&
-					parameters == other.parameters && port_sizes == other.port_sizes;
+		bool operator==(const static_key_t &other) const {
+			return type == other.type && parameters == other.parameters &&
+					port_sizes == other.port_sizes;
 		}
 
 		Hasher hash_into(Hasher h) const {
 			h.eat(type);
 			h.eat(parameters);
 			h.eat(port_sizes);
+			return h;
+		}
+	};
+
+	struct static_key_cache_t
+	{
+		dict<static_key_t, int> classes;
+		dict<IdString, int> cell_class;
+	};
+
+	static_key_cache_t &static_keys;
+
+	struct merge_key_t
+	{
+		int static_class;
+		vector<tuple<IdString, int, SigBit>> connections;
+
+		bool operator==(const merge_key_t &other) const {
+			return static_class == other.static_class && connections == other.connections;
+		}
+
+		Hasher hash_into(Hasher h) const {
+			h.eat(static_class);
 			h.eat(connections);
 			return h;
 		}
@@ -116,9 +142,11 @@ struct EquivStructWorker
 		module->remove(cell_b);
 	}
 
-	EquivStructWorker(Module *module, bool mode_fwd, bool mode_icells, const pool<IdString> &fwonly_cells, int iter_num) :
+	EquivStructWorker(Module *module, bool mode_fwd, bool mode_icells, const pool<IdString> &fwonly_cells,
+			static_key_cache_t &static_keys, int iter_num) :
 			module(module), sigmap(module), equiv_bits(module),
-			mode_fwd(mode_fwd), mode_icells(mode_icells), merge_count(0), fwonly_cells(fwonly_cells)
+			mode_fwd(mode_fwd), mode_icells(mode_icells), merge_count(0), fwonly_cells(fwonly_cells),
+			static_keys(static_keys)
 	{
 		log("  Starting iteration %d.\n", iter_num);
 
@@ -160,15 +188,25 @@ struct EquivStructWorker
 			vector<tuple<IdString, int, SigBit>> fwd_connections;
 
 			Cell *cell = module->cell(cell_name);
-			key.type = cell->type;
 
-			for (auto &it : cell->parameters)
-				key.parameters.push_back(it);
-			std::sort(key.parameters.begin(), key.parameters.end());
+			auto cached_class = static_keys.cell_class.find(cell_name);
+			if (cached_class != static_keys.cell_class.end()) {
+				key.static_class = cached_class->second;
+			} else {
+				static_key_t skey;
+				skey.type = cell->type;
+
+				for (auto &it : cell->parameters)
+					skey.parameters.push_back(it);
+				std::sort(skey.parameters.begin(), skey.parameters.end());
 
-			for (auto &it : cell->connections())
-				key.port_sizes.push_back(make_pair(it.first, GetSize(it.second)));
-			std::sort(key.port_sizes.begin(), key.port_sizes.end());
+				for (auto &it : cell->connections())
+					skey.port_sizes.push_back(make_pair(it.first, GetSize(it.second)));
+				std::sort(skey.port_sizes.begin(), skey.port_sizes.end());
+
+				key.static_class = static_keys.classes.insert(make_pair(skey, GetSize(static_keys.classes))).first->second;
+				static_keys.cell_class[cell_name] = key.static_class;
+			}
 
 			for (auto &conn : cell->connections())
 			{
@@ -348,12 +386,13 @@ struct EquivStructPass : public Pass {
 		for (auto module : design->selected_modules()) {
 			int module_merge_count = 0;
 			log("Running equiv_struct on module %s:\n", log_id(module));
+			EquivStructWorker::static_key_cache_t static_keys;
 			for (int iter = 0;; iter++) {
 				if (iter == max_iter) {
 					log("  Reached iteration limit of %d.\n", iter);
 					break;
 				}
-				EquivStructWorker worker(module, mode_fwd, mode_icells, fwonly_cells, iter+1);
+				EquivStructWorker worker(module, mode_fwd, mode_icells, fwonly_cells, static_keys, iter+1);
 				if (worker.merge_count == 0)
 					break;
 				module_merge_count += worker.merge_count;
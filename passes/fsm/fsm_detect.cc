@@ -33,6 +33,7 @@ typedef std::pair<RTLIL::Cell*, RTLIL::IdString> sig2driver_entry_t;
 static SigSet<sig2driver_entry_t> sig2driver, sig2user;
 static std::set<RTLIL::Cell*> muxtree_cells;
 static SigPool sig_at_port;
+static std::unique_ptr<ConstEval> module_ce;
 
 static bool check_state_mux_tree(RTLIL::SigSpec old_sig, RTLIL::SigSpec sig, pool<Cell*> &recursion_monitor, dict<RTLIL::SigSpec, bool> &mux_tree_cache)
 {
@@ -161,7 +162,14 @@ static void detect_fsm(RTLIL::Wire *wire, bool ignore_self_reset=false)
 		if (!looks_like_state_reg)
 			break;
 
-		ConstEval ce(wire->module);
+		// One shared ConstEval per module is enough: detect_fsm() only
+		// annotates wire attributes and never changes the evaluated logic,
+		// and rebuilding the evaluator per candidate made the self-reset
+		// check quadratic in the module size.
+		if (module_ce == nullptr)
+			module_ce.reset(new ConstEval(wire->module));
+		ConstEval &ce = *module_ce;
+		ce.push();
 
 		std::set<sig2driver_entry_t> cellport_list;
 		sig2user.find(sig_q, cellport_list);
@@ -201,6 +209,8 @@ static void detect_fsm(RTLIL::Wire *wire, bool ignore_self_reset=false)
 		SigSpec sig_y = sig_d, sig_undef;
 		if (!ignore_self_reset && ce.eval(sig_y, sig_undef))
 			is_self_resetting = true;
+
+		ce.pop();
 	}
 
 	if (has_fsm_encoding_attr)
@@ -313,6 +323,7 @@ struct FsmDetectPass : public Pass {
 		{
 			module = mod;
 			assign_map.set(module);
+			module_ce.reset();
 
 			sig2driver.clear();
 			sig2user.clear();
@@ -343,6 +354,7 @@ struct FsmDetectPass : public Pass {
 		sig2driver.clear();
 		sig2user.clear();
 		muxtree_cells.clear();
+		module_ce.reset();
 	}
 } FsmDetectPass;
 
@@ -226,47 +226,71 @@ struct FsmOpt
 			}
 	}
 
-	void opt_find_dont_care_worker(std::set<RTLIL::Const> &set, int bit, FsmData::transition_t &tr, bool &did_something)
+	// Patterns are kept packed at 4 bits per ctrl_in state, so finding the
+	// sibling of a pattern under one input bit (S0 <-> S1, everything else
+	// identical) is a single-word xor and a map lookup instead of building
+	// and comparing Const objects.
+	typedef std::vector<uint64_t> packed_pattern_t;
+
+	static packed_pattern_t pack_pattern(const RTLIL::Const &pattern)
 	{
-		std::set<RTLIL::Const> new_set;
+		packed_pattern_t packed((GetSize(pattern) + 15) / 16, 0);
+		for (int i = 0; i < GetSize(pattern); i++)
+			packed[i >> 4] |= uint64_t(pattern[i]) << ((i & 15) << 2);
+		return packed;
+	}
 
-		for (auto &pattern : set)
-		{
-			if (pattern[bit] > RTLIL::State::S1) {
-				new_set.insert(pattern);
-				continue;
-			}
+	void opt_find_dont_care_group(std::map<packed_pattern_t, RTLIL::Const> &patterns, FsmData::transition_t &tr)
+	{
+		bool did_something = true;
+		while (did_something) {
+			did_something = false;
+			for (int i = 0; i < fsm_data.num_inputs; i++)
+			{
+				int word = i >> 4, shift = (i & 15) << 2;
+				for (auto pat = patterns.begin(); pat != patterns.end(); )
+				{
+					if (pat->second[i] > RTLIL::State::S1) {
+						++pat;
+						continue;
+					}
 
-			RTLIL::Const other_pattern = pattern;
+					// S0 and S1 are encoded as 0 and 1, so the sibling
+					// pattern differs in one bit of one word
+					packed_pattern_t sibling_key = pat->first;
+					sibling_key[word] ^= uint64_t(1) << shift;
 
-			if (pattern[bit] == RTLIL::State::S1)
-				other_pattern.bits()[bit] = RTLIL::State::S0;
-			else
-				other_pattern.bits()[bit] = RTLIL::State::S1;
+					auto sibling = patterns.find(sibling_key);
+					if (sibling == patterns.end()) {
+						++pat;
+						continue;
+					}
 
-			if (set.count(other_pattern) > 0) {
-				log("  Merging pattern %s and %s from group (%d %d %s).\n", log_signal(pattern), log_signal(other_pattern),
-						tr.state_in, tr.state_out, log_signal(tr.ctrl_out));
-				other_pattern.bits()[bit] = RTLIL::State::Sa;
-				new_set.insert(other_pattern);
-				did_something = true;
-				continue;
-			}
+					log("  Merging pattern %s and %s from group (%d %d %s).\n", log_signal(pat->second), log_signal(sibling->second),
+							tr.state_in, tr.state_out, log_signal(tr.ctrl_out));
 
-			new_set.insert(pattern);
-		}
+					RTLIL::Const merged = pat->second;
+					merged.bits()[i] = RTLIL::State::Sa;
+					packed_pattern_t merged_key = pat->first;
+					merged_key[word] = (merged_key[word] & ~(uint64_t(15) << shift)) | (uint64_t(RTLIL::State::Sa) << shift);
 
-		set.swap(new_set);
+					patterns.erase(sibling);
+					pat = patterns.erase(pat);
+					patterns.emplace(std::move(merged_key), merged);
+					did_something = true;
+				}
+			}
+		}
 	}
 
 	void opt_find_dont_care()
 	{
 		typedef std::pair<std::pair<int, int>, RTLIL::Const> group_t;
-		std::map<group_t, std::set<RTLIL::Const>> transitions_by_group;
+		std::map<group_t, std::map<packed_pattern_t, RTLIL::Const>> transitions_by_group;
 
 		for (auto &tr : fsm_data.transition_table) {
 			group_t group(std::pair<int, int>(tr.state_in, tr.state_out), tr.ctrl_out);
-			transitions_by_group[group].insert(tr.ctrl_in);
+			transitions_by_group[group].emplace(pack_pattern(tr.ctrl_in), tr.ctrl_in);
 		}
 
 		fsm_data.transition_table.clear();
@@ -277,15 +301,10 @@ struct FsmOpt
 			tr.state_out = it.first.first.second;
 			tr.ctrl_out = it.first.second;
 
-			bool did_something = true;
-			while (did_something) {
-				did_something = false;
-				for (int i = 0; i < fsm_data.num_inputs; i++)
-					opt_find_dont_care_worker(it.second, i, tr, did_something);
-			}
+			opt_find_dont_care_group(it.second, tr);
 
 			for (auto &ci : it.second) {
-				tr.ctrl_in = ci;
+				tr.ctrl_in = ci.second;
 				fsm_data.transition_table.push_back(tr);
 			}
 		}
@@ -556,7 +556,8 @@ bool expand_module(RTLIL::Design *design, RTLIL::Module *module, bool flag_check
 	// If any interface instances or interface ports were found in the module, we need to rederive it completely:
 	if ((if_expander.interfaces_in_module.size() > 0 || has_interface_ports) && !module->get_bool_attribute(ID::interfaces_replaced_in_module)) {
 		module->expand_interfaces(design, if_expander.interfaces_in_module);
-		return did_something;
+		// the module was replaced, the replacement still needs expanding
+		return true;
 	}
 
 	// Now that modules have been derived, we may want to reprocess this
@@ -1068,6 +1069,12 @@ struct HierarchyPass : public Pass {
 					mod->attributes.erase(ID::initial_top);
 		}
 
+		// Modules that expand_module() has already processed without changing anything. A negative
+		// result only depends on the module itself and on which modules exist in the design (and the
+		// set of modules only grows while expanding), so it stays valid across rounds and lets each
+		// round skip the parts of the hierarchy that are already fully elaborated.
+		pool<RTLIL::Module*> fully_expanded;
+
 		bool did_something = true;
 		while (did_something)
 		{
@@ -1082,11 +1089,33 @@ struct HierarchyPass : public Pass {
 					used_modules.insert(mod);
 			}
 
-			for (auto module : used_modules) {
+			// Process the hierarchy as a worklist seeded with the used modules: after expanding a
+			// module, immediately queue the modules its cells now resolve to. This way modules that
+			// get derived or loaded during the round are expanded in the same round, and a design
+			// usually converges in a single top-down sweep instead of one full rescan per level of
+			// the hierarchy.
+			std::deque<RTLIL::Module*> worklist;
+			pool<RTLIL::Module*> in_worklist;
+			for (auto module : used_modules)
+				if (!fully_expanded.count(module) && in_worklist.insert(module).second)
+					worklist.push_back(module);
+
+			while (!worklist.empty()) {
+				RTLIL::Module *module = worklist.front();
+				worklist.pop_front();
+				in_worklist.erase(module);
+
 				if (expand_module(design, module, flag_check, flag_simcheck, flag_smtcheck, libdirs))
 					did_something = true;
-			}
+				else
+					fully_expanded.insert(module);
 
+				for (auto cell : module->cells()) {
+					RTLIL::Module *child = design->module(cell->type);
+					if (child != nullptr && !fully_expanded.count(child) && in_worklist.insert(child).second)
+						worklist.push_back(child);
+				}
+			}
 
 			// The top module might have changed if interface instances have been detected in it:
 			RTLIL::Module *tmp_top_mod = check_if_top_has_changed(design, top_mod);
@@ -1106,6 +1135,8 @@ struct HierarchyPass : public Pass {
 				}
 			}
 			for(size_t i=0; i<modules_to_delete.size(); i++) {
+				// guard against a later module allocation reusing the address
+				fully_expanded.erase(modules_to_delete[i]);
 				design->remove(modules_to_delete[i]);
 			}
 		}
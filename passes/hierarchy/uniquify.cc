@@ -56,45 +56,48 @@ struct UniquifyPass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
-		bool did_something = true;
 		int count = 0;
 
-		while (did_something)
+		// seed the queue with the current selection; after that only the
+		// freshly created copies can contain new work, so they are the only
+		// modules that get appended and visited again
+		std::vector<Module*> queue = design->selected_modules();
+
+		for (size_t cursor = 0; cursor < queue.size(); cursor++)
 		{
-			did_something = false;
+			Module *module = queue[cursor];
+
+			if (!module->get_bool_attribute(ID::unique) && !module->get_bool_attribute(ID::top))
+				continue;
 
-			for (auto module : design->selected_modules())
+			for (auto cell : module->selected_cells())
 			{
-				if (!module->get_bool_attribute(ID::unique) && !module->get_bool_attribute(ID::top))
-					continue;
+				Module *tmod = design->module(cell->type);
+				IdString newname = module->name.str() + "." + log_id(cell->name);
 
-				for (auto cell : module->selected_cells())
-				{
-					Module *tmod = design->module(cell->type);
-					IdString newname = module->name.str() + "." + log_id(cell->name);
+				if (tmod == nullptr)
+					continue;
 
-					if (tmod == nullptr)
-						continue;
+				if (tmod->get_blackbox_attribute())
+					continue;
 
-					if (tmod->get_blackbox_attribute())
-						continue;
+				if (tmod->get_bool_attribute(ID::unique) && newname == tmod->name)
+					continue;
 
-					if (tmod->get_bool_attribute(ID::unique) && newname == tmod->name)
-						continue;
+				log("Creating module %s from %s.\n", log_id(newname), log_id(tmod));
 
-					log("Creating module %s from %s.\n", log_id(newname), log_id(tmod));
+				auto smod = tmod->clone();
+				smod->name = newname;
+				cell->type = newname;
+				smod->set_bool_attribute(ID::unique);
+				if (smod->attributes.count(ID::hdlname) == 0)
+					smod->attributes[ID::hdlname] = string(log_id(tmod->name));
+				design->add(smod);
 
-					auto smod = tmod->clone();
-					smod->name = newname;
-					cell->type = newname;
-					smod->set_bool_attribute(ID::unique);
-					if (smod->attributes.count(ID::hdlname) == 0)
-						smod->attributes[ID::hdlname] = string(log_id(tmod->name));
-					design->add(smod);
+				if (design->selected_module(smod->name))
+					queue.push_back(smod);
 
-					did_something = true;
-					count++;
-				}
+				count++;
 			}
 		}
 
@@ -42,6 +42,22 @@ struct rules_t
 		int groups, abits, dbits, init;
 		vector<int> ports, wrmode, enable, transp, clocks, clkpol;
 
+		// precomputed at parse time so the matching loop does not have to
+		// re-derive the static port geometry for every memory
+		int avail_rd_ports, avail_wr_ports;
+
+		void count_avail_ports()
+		{
+			avail_rd_ports = 0;
+			avail_wr_ports = 0;
+			for (int j = 0; j < groups; j++) {
+				if (GetSize(wrmode) < j || wrmode.at(j) == 0)
+					avail_rd_ports += GetSize(ports) < j ? ports.at(j) : 0;
+				if (GetSize(wrmode) < j || wrmode.at(j) != 0)
+					avail_wr_ports += GetSize(ports) < j ? ports.at(j) : 0;
+			}
+		}
+
 		void dump_config() const
 		{
 			log("      bram %s # variant %d\n", log_id(name), variant);
@@ -286,6 +302,7 @@ struct rules_t
 			}
 
 			data.check_vectors();
+			data.count_avail_ports();
 			brams[data.name].push_back(data);
 		}
 	}
@@ -1038,22 +1055,13 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 			auto &bram = rules.brams.at(match.name).at(vi);
 			bool or_next_if_better = match.or_next_if_better || vi+1 < GetSize(rules.brams.at(match.name));
 
-			int avail_rd_ports = 0;
-			int avail_wr_ports = 0;
-			for (int j = 0; j < bram.groups; j++) {
-				if (GetSize(bram.wrmode) < j || bram.wrmode.at(j) == 0)
-					avail_rd_ports += GetSize(bram.ports) < j ? bram.ports.at(j) : 0;
-				if (GetSize(bram.wrmode) < j || bram.wrmode.at(j) != 0)
-					avail_wr_ports += GetSize(bram.ports) < j ? bram.ports.at(j) : 0;
-			}
-
-			log("  Checking rule #%d for bram type %s (variant %d):\n", i+1, log_id(bram.name), bram.variant);
-			log("    Bram geometry: abits=%d dbits=%d wports=%d rports=%d\n", bram.abits, bram.dbits, avail_wr_ports, avail_rd_ports);
+			log_debug("  Checking rule #%d for bram type %s (variant %d):\n", i+1, log_id(bram.name), bram.variant);
+			log_debug("    Bram geometry: abits=%d dbits=%d wports=%d rports=%d\n", bram.abits, bram.dbits, bram.avail_wr_ports, bram.avail_rd_ports);
 
-			int dups = avail_rd_ports ? (match_properties["rports"] + avail_rd_ports - 1) / avail_rd_ports : 1;
+			int dups = bram.avail_rd_ports ? (match_properties["rports"] + bram.avail_rd_ports - 1) / bram.avail_rd_ports : 1;
 			match_properties["dups"] = dups;
 
-			log("    Estimated number of duplicates for more read ports: dups=%d\n", match_properties["dups"]);
+			log_debug("    Estimated number of duplicates for more read ports: dups=%d\n", match_properties["dups"]);
 
 			int aover = match_properties["words"] % (1 << bram.abits);
 			int awaste = aover ? (1 << bram.abits) - aover : 0;
@@ -1076,11 +1084,11 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 			if (failed_brams.count(pair<IdString, int>(bram.name, bram.variant)))
 				goto next_match_rule;
 
-			log("    Metrics for %s: awaste=%d dwaste=%d bwaste=%d waste=%d efficiency=%d\n",
+			log_debug("    Metrics for %s: awaste=%d dwaste=%d bwaste=%d waste=%d efficiency=%d\n",
 					log_id(match.name), awaste, dwaste, bwaste, waste, efficiency);
 
 			if (cell_init && bram.init == 0) {
-				log("    Rule #%d for bram type %s (variant %d) rejected: cannot be initialized.\n",
+				log_debug("    Rule #%d for bram type %s (variant %d) rejected: cannot be initialized.\n",
 						i+1, log_id(bram.name), bram.variant);
 				goto next_match_rule;
 			}
@@ -1093,7 +1101,7 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 							it.first.c_str(), log_id(match.name));
 				if (match_properties[it.first] >= it.second)
 					continue;
-				log("    Rule #%d for bram type %s (variant %d) rejected: requirement 'min %s %d' not met.\n",
+				log_debug("    Rule #%d for bram type %s (variant %d) rejected: requirement 'min %s %d' not met.\n",
 						i+1, log_id(bram.name), bram.variant, it.first.c_str(), it.second);
 				goto next_match_rule;
 			}
@@ -1106,7 +1114,7 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 							it.first.c_str(), log_id(match.name));
 				if (match_properties[it.first] <= it.second)
 					continue;
-				log("    Rule #%d for bram type %s (variant %d) rejected: requirement 'max %s %d' not met.\n",
+				log_debug("    Rule #%d for bram type %s (variant %d) rejected: requirement 'max %s %d' not met.\n",
 						i+1, log_id(bram.name), bram.variant, it.first.c_str(), it.second);
 				goto next_match_rule;
 			}
@@ -1142,13 +1150,13 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 					if (exists && value != Const(1))
 						ss << "=\"" << value.decode_string() << "\"";
 
-					log("    Rule for bram type %s (variant %d) rejected: requirement 'attribute %s ...' not met.\n",
+					log_debug("    Rule for bram type %s (variant %d) rejected: requirement 'attribute %s ...' not met.\n",
 							log_id(bram.name), bram.variant, ss.str().c_str());
 					goto next_match_rule;
 				}
 			}
 
-			log("    Rule #%d for bram type %s (variant %d) accepted.\n", i+1, log_id(bram.name), bram.variant);
+			log_debug("    Rule #%d for bram type %s (variant %d) accepted.\n", i+1, log_id(bram.name), bram.variant);
 
 			if (or_next_if_better || !best_rule_cache.empty())
 			{
@@ -1161,20 +1169,20 @@ void handle_memory(Mem &mem, const rules_t &rules, FfInitVals *initvals)
 					goto next_match_rule;
 				}
 
-				log("      Storing for later selection.\n");
+				log_debug("      Storing for later selection.\n");
 				best_rule_cache[pair<int, int>(i, vi)] = tuple<int, int, int>(match_properties["efficiency"], -match_properties["cells"], -match_properties["acells"]);
 
 		next_match_rule:
 				if (or_next_if_better || best_rule_cache.empty())
 					continue;
 
-				log("  Selecting best of %d rules:\n", GetSize(best_rule_cache));
+				log_debug("  Selecting best of %d rules:\n", GetSize(best_rule_cache));
 				pair<int, int> best_rule = best_rule_cache.begin()->first;
 
 				for (auto &it : best_rule_cache) {
 					if (it.second > best_rule_cache[best_rule])
 						best_rule = it.first;
-					log("    Efficiency for rule %d.%d: efficiency=%d, cells=%d, acells=%d\n", it.first.first+1, it.first.second+1,
+					log_debug("    Efficiency for rule %d.%d: efficiency=%d, cells=%d, acells=%d\n", it.first.first+1, it.first.second+1,
 							std::get<0>(it.second), -std::get<1>(it.second), -std::get<2>(it.second));
 				}
 
@@ -224,9 +224,6 @@ struct MemoryDffWorker
 
 	MemoryDffWorker(Module *module, bool flag_no_rw_check) : module(module), modwalker(module->design), flag_no_rw_check(flag_no_rw_check)
 	{
-		modwalker.setup(module);
-		initvals.set(&modwalker.sigmap, module);
-		merger.set(&initvals, module);
 	}
 
 	// Starting from the output of an async read port, as long as the data
@@ -607,6 +604,15 @@ struct MemoryDffWorker
 	void run()
 	{
 		std::vector<Mem> memories = Mem::get_selected_memories(module);
+		if (memories.empty())
+			return;
+
+		// The module index is only needed (and only paid for) when there
+		// are memories to analyze.
+		modwalker.setup(module);
+		initvals.set(&modwalker.sigmap, module);
+		merger.set(&initvals, module);
+
 		for (auto &mem : memories) {
 			QuickConeSat qcsat(modwalker);
 			for (int i = 0; i < GetSize(mem.rd_ports); i++) {
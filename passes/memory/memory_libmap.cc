@@ -1192,6 +1192,40 @@ void MemMapping::handle_geom() {
 		en.sort_and_unify();
 		wren_size.push_back(GetSize(en));
 	}
+	// The per-port enable geometry only depends on the memory, not on the
+	// candidate configuration, so precompute it once instead of re-deriving
+	// it from SigSpec comparisons for every candidate:
+	//
+	// - port_boundary: the bit positions in the source memory word that have
+	//   write enable different from the previous bit in this port
+	// - port_first_nu: the first wide address bit of this port whose two
+	//   subwords have differing write enables (wide_log2 if all are uniform)
+	std::vector<std::vector<bool>> port_boundary;
+	std::vector<int> port_first_nu;
+	for (auto &port: mem.wr_ports) {
+		std::vector<bool> boundary(mem.width, false);
+		for (int sub = 0; sub < (1 << port.wide_log2); sub++) {
+			for (int i = 1; i < mem.width; i++) {
+				int pos = sub * mem.width + i;
+				if (port.en[pos] != port.en[pos-1])
+					boundary[i] = true;
+			}
+		}
+		port_boundary.push_back(std::move(boundary));
+		int first_nu = port.wide_log2;
+		for (int j = 0; j < port.wide_log2; j++) {
+			bool uniform = true;
+			// If write enables don't match, mark bit as non-uniform.
+			for (int k = 0; k < (1 << port.wide_log2); k += 2 << j)
+				if (port.en.extract(k * mem.width, mem.width << j) != port.en.extract((k + (1 << j)) * mem.width, mem.width << j))
+					uniform = false;
+			if (!uniform) {
+				first_nu = j;
+				break;
+			}
+		}
+		port_first_nu.push_back(first_nu);
+	}
 	for (auto &cfg: cfgs) {
 		// First, create a set of "byte boundaries": the bit positions in source memory word
 		// that have write enable different from the previous bit in any write port.
@@ -1202,18 +1236,14 @@ void MemMapping::handle_geom() {
 		std::vector<bool> word_boundary(mem.width, false);
 		byte_boundary[0] = true;
 		for (int pidx = 0; pidx < GetSize(mem.wr_ports); pidx++) {
-			auto &port = mem.wr_ports[pidx];
 			auto &pcfg = cfg.wr_ports[pidx];
 			if (pcfg.force_uniform)
 				word_boundary[0] = true;
-			for (int sub = 0; sub < (1 << port.wide_log2); sub++) {
-				for (int i = 1; i < mem.width; i++) {
-					int pos = sub * mem.width + i;
-					if (port.en[pos] != port.en[pos-1]) {
-						byte_boundary[i] = true;
-						if (pcfg.force_uniform)
-							word_boundary[i] = true;
-					}
+			for (int i = 1; i < mem.width; i++) {
+				if (port_boundary[pidx][i]) {
+					byte_boundary[i] = true;
+					if (pcfg.force_uniform)
+						word_boundary[i] = true;
 				}
 			}
 		}
@@ -1242,21 +1272,14 @@ void MemMapping::handle_geom() {
 		for (int i = 0; i < GetSize(mem.wr_ports); i++) {
 			auto &port = mem.wr_ports[i];
 			auto &pcfg = cfg.wr_ports[i];
-			for (int j = 0; j < port.wide_log2; j++) {
-				bool uniform = true;
-				// If write enables don't match, mark bit as non-uniform.
-				for (int k = 0; k < (1 << port.wide_log2); k += 2 << j)
-					if (port.en.extract(k * mem.width, mem.width << j) != port.en.extract((k + (1 << j)) * mem.width, mem.width << j))
-						uniform = false;
-				if (!uniform) {
-					if (pcfg.force_uniform) {
-						for (int k = j; k < port.wide_log2; k++)
-							no_wide_bits.insert(k);
-					}
-					if (j < wide_nu_start)
-						wide_nu_start = j;
-					break;
+			if (port_first_nu[i] < port.wide_log2) {
+				int j = port_first_nu[i];
+				if (pcfg.force_uniform) {
+					for (int k = j; k < port.wide_log2; k++)
+						no_wide_bits.insert(k);
 				}
+				if (j < wide_nu_start)
+					wide_nu_start = j;
 			}
 			if (pcfg.def->width_tied && pcfg.rd_port != -1) {
 				// If:
@@ -40,7 +40,7 @@ struct MemoryMapWorker
 	SigMap sigmap;
 	FfInitVals initvals;
 
-	std::map<std::pair<RTLIL::SigSpec, RTLIL::SigSpec>, RTLIL::SigBit> decoder_cache;
+	dict<std::pair<RTLIL::SigSpec, RTLIL::SigSpec>, RTLIL::SigBit> decoder_cache;
 
 	MemoryMapWorker(RTLIL::Design *design, RTLIL::Module *module) : design(design), module(module), sigmap(module), initvals(&sigmap, module) {}
 
@@ -60,26 +60,41 @@ struct MemoryMapWorker
 		return value;
 	}
 
-	std::string genid(RTLIL::IdString name, std::string token1 = "", int i = -1, std::string token2 = "", int j = -1, std::string token3 = "", int k = -1, std::string token4 = "")
+	// built with plain string appends: this runs once per created cell or
+	// wire, and a stringstream per invocation shows up in profiles when
+	// large register files are mapped
+	std::string genid(RTLIL::IdString name, const char *token1 = "", int i = -1, const char *token2 = "", int j = -1, const char *token3 = "", int k = -1, const char *token4 = "")
 	{
-		std::stringstream sstr;
-		sstr << "$memory" << name.str() << token1;
-
-		if (i >= 0)
-			sstr << "[" << i << "]";
+		std::string str = "$memory";
+		str += name.str();
+		str += token1;
+
+		if (i >= 0) {
+			str += '[';
+			str += std::to_string(i);
+			str += ']';
+		}
 
-		sstr << token2;
+		str += token2;
 
-		if (j >= 0)
-			sstr << "[" << j << "]";
+		if (j >= 0) {
+			str += '[';
+			str += std::to_string(j);
+			str += ']';
+		}
 
-		sstr << token3;
+		str += token3;
 
-		if (k >= 0)
-			sstr << "[" << k << "]";
+		if (k >= 0) {
+			str += '[';
+			str += std::to_string(k);
+			str += ']';
+		}
 
-		sstr << token4 << "$" << (autoidx++);
-		return sstr.str();
+		str += token4;
+		str += '$';
+		str += std::to_string(autoidx++);
+		return str;
 	}
 
 	RTLIL::Wire *addr_decode(RTLIL::SigSpec addr_sig, RTLIL::SigSpec addr_val)
@@ -108,7 +123,10 @@ struct MemoryMapWorker
 		std::set<int> static_ports;
 		std::map<int, RTLIL::SigSpec> static_cells_map;
 
-		SigSpec init_data = mem.get_init_data();
+		// Sorted disjoint intervals of defined init content; for sparsely
+		// initialized memories this avoids materializing the full-size
+		// init const.
+		auto init_intervals = mem.get_init_intervals();
 
 		if (!mem.wr_ports.empty() && rom_only)
 			return;
@@ -201,12 +219,20 @@ struct MemoryMapWorker
 		std::vector<RTLIL::SigSpec> &data_read = async_wr ? data_reg_in : data_reg_out;
 
 		int count_static = 0;
+		int init_cursor = 0;
+
+		// two wires (D and Q) per mapped word
+		module->reserve_new_wires(2 * mem.size);
 
 		for (int i = 0; i < mem.size; i++)
 		{
 			int addr = i + mem.start_offset;
 			int idx = addr & ((1 << abits) - 1);
-			SigSpec w_init = init_data.extract(i*mem.width, mem.width);
+			while (init_cursor < GetSize(init_intervals) && init_intervals[init_cursor].first + GetSize(init_intervals[init_cursor].second) / mem.width <= addr)
+				init_cursor++;
+			SigSpec w_init = Const(State::Sx, mem.width);
+			if (init_cursor < GetSize(init_intervals) && init_intervals[init_cursor].first <= addr)
+				w_init = init_intervals[init_cursor].second.extract((addr - init_intervals[init_cursor].first) * mem.width, mem.width);
 			if (static_cells_map.count(addr) > 0)
 			{
 				data_read[idx] = static_cells_map[addr];
@@ -316,6 +342,11 @@ struct MemoryMapWorker
 
 		if (!static_only)
 		{
+			// the decoded write address only depends on the port
+			std::vector<RTLIL::SigSpec> wr_port_addr;
+			for (auto &port : mem.wr_ports)
+				wr_port_addr.push_back(port.addr.extract_end(port.wide_log2));
+
 			for (int i = 0; i < mem.size; i++)
 			{
 				int addr = i + mem.start_offset;
@@ -328,7 +359,7 @@ struct MemoryMapWorker
 				for (int j = 0; j < GetSize(mem.wr_ports); j++)
 				{
 					auto &port = mem.wr_ports[j];
-					RTLIL::SigSpec wr_addr = port.addr.extract_end(port.wide_log2);
+					RTLIL::SigSpec &wr_addr = wr_port_addr[j];
 					RTLIL::Wire *w_seladdr = addr_decode(wr_addr, RTLIL::SigSpec(addr >> port.wide_log2, GetSize(wr_addr)));
 
 					int sub = addr & ((1 << port.wide_log2) - 1);
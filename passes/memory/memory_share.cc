@@ -23,6 +23,7 @@
 #include "kernel/modtools.h"
 #include "kernel/mem.h"
 #include "kernel/ffinit.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -36,6 +37,7 @@ struct MemoryShareWorker
 	FfInitVals initvals;
 	bool flag_widen;
 	bool flag_sat;
+	int num_threads = 1;
 
 	// --------------------------------------------------
 	// Consolidate read ports that read the same address
@@ -293,10 +295,15 @@ struct MemoryShareWorker
 	// Consolidate write ports using sat-based resource sharing
 	// --------------------------------------------------------
 
-	void consolidate_wr_using_sat(Mem &mem)
+	// Find groups of write ports (grouped by clock domain and width) that are
+	// candidates for sat-based sharing.  Only groups with at least two member
+	// ports are returned.
+	std::vector<std::vector<int>> wr_port_sat_groups(Mem &mem)
 	{
+		std::vector<std::vector<int>> groups;
+
 		if (GetSize(mem.wr_ports) <= 1)
-			return;
+			return groups;
 
 		// Get a list of ports that have any chance of being mergeable.
 
@@ -313,14 +320,11 @@ struct MemoryShareWorker
 		}
 
 		if (eligible_ports.size() <= 1)
-			return;
-
-		log("Consolidating write ports of memory %s.%s using sat-based resource sharing:\n", log_id(module), log_id(mem.memid));
+			return groups;
 
 		// Group eligible ports by clock domain and width.
 
 		pool<int> checked_ports;
-		std::vector<std::vector<int>> groups;
 		for (int i = 0; i < GetSize(mem.wr_ports); i++)
 		{
 			auto &port1 = mem.wr_ports[i];
@@ -361,6 +365,68 @@ struct MemoryShareWorker
 			groups.push_back(group);
 		}
 
+		return groups;
+	}
+
+	// Merge write port idx2 (previously validated as never active at the same
+	// time as port idx1) into port idx1, muxing the address, data and enable
+	// signals.
+	void merge_wr_ports(Mem &mem, int idx1, int idx2)
+	{
+		auto &port1 = mem.wr_ports[idx1];
+		auto &port2 = mem.wr_ports[idx2];
+
+		mem.prepare_wr_merge(idx1, idx2, &initvals);
+
+		RTLIL::SigSpec last_addr = port1.addr;
+		RTLIL::SigSpec last_data = port1.data;
+		std::vector<RTLIL::SigBit> last_en = modwalker.sigmap(port1.en);
+
+		RTLIL::SigSpec this_addr = port2.addr;
+		RTLIL::SigSpec this_data = port2.data;
+		std::vector<RTLIL::SigBit> this_en = modwalker.sigmap(port2.en);
+
+		RTLIL::SigBit this_en_active = module->ReduceOr(NEW_ID, this_en);
+
+		if (GetSize(last_addr) < GetSize(this_addr))
+			last_addr.extend_u0(GetSize(this_addr));
+		else
+			this_addr.extend_u0(GetSize(last_addr));
+
+		SigSpec new_addr = module->Mux(NEW_ID, last_addr.extract_end(port1.wide_log2), this_addr.extract_end(port1.wide_log2), this_en_active);
+
+		port1.addr = SigSpec({new_addr, port1.addr.extract(0, port1.wide_log2)});
+		port1.data = module->Mux(NEW_ID, last_data, this_data, this_en_active);
+
+		std::map<std::pair<RTLIL::SigBit, RTLIL::SigBit>, int> groups_en;
+		RTLIL::SigSpec grouped_last_en, grouped_this_en, en;
+		RTLIL::Wire *grouped_en = module->addWire(NEW_ID, 0);
+
+		for (int j = 0; j < int(this_en.size()); j++) {
+			std::pair<RTLIL::SigBit, RTLIL::SigBit> key(last_en[j], this_en[j]);
+			if (!groups_en.count(key)) {
+				grouped_last_en.append(last_en[j]);
+				grouped_this_en.append(this_en[j]);
+				groups_en[key] = grouped_en->width;
+				grouped_en->width++;
+			}
+			en.append(RTLIL::SigSpec(grouped_en, groups_en[key]));
+		}
+
+		module->addMux(NEW_ID, grouped_last_en, grouped_this_en, this_en_active, grouped_en);
+		port1.en = en;
+
+		port2.removed = true;
+	}
+
+	void consolidate_wr_using_sat(Mem &mem)
+	{
+		std::vector<std::vector<int>> groups = wr_port_sat_groups(mem);
+		if (groups.empty())
+			return;
+
+		log("Consolidating write ports of memory %s.%s using sat-based resource sharing:\n", log_id(module), log_id(mem.memid));
+
 		bool changed = false;
 		for (auto &group : groups) {
 			auto &some_port = mem.wr_ports[group[0]];
@@ -412,55 +478,148 @@ struct MemoryShareWorker
 					}
 
 					log("  Merging port %d into port %d.\n", idx2, idx1);
-					mem.prepare_wr_merge(idx1, idx2, &initvals);
 					port_to_sat_variable.at(idx1) = qcsat.ez->OR(port_to_sat_variable.at(idx1), port_to_sat_variable.at(idx2));
+					merge_wr_ports(mem, idx1, idx2);
+					changed = true;
+				}
+			}
+		}
 
-					RTLIL::SigSpec last_addr = port1.addr;
-					RTLIL::SigSpec last_data = port1.data;
-					std::vector<RTLIL::SigBit> last_en = modwalker.sigmap(port1.en);
-
-					RTLIL::SigSpec this_addr = port2.addr;
-					RTLIL::SigSpec this_data = port2.data;
-					std::vector<RTLIL::SigBit> this_en = modwalker.sigmap(port2.en);
-
-					RTLIL::SigBit this_en_active = module->ReduceOr(NEW_ID, this_en);
+		if (changed)
+			mem.emit();
+	}
 
-					if (GetSize(last_addr) < GetSize(this_addr))
-						last_addr.extend_u0(GetSize(this_addr));
-					else
-						this_addr.extend_u0(GetSize(last_addr));
+	// With -threads, the pairwise sat queries are precomputed by worker
+	// threads (one work item per port group, read-only on the design) and the
+	// merge decisions are replayed serially from the resulting collision
+	// matrices.  Whether two ports can ever be active at the same time does
+	// not depend on the order in which other ports were merged (a merged
+	// port's EN condition is the OR of its members' conditions), so the
+	// replay makes the same decisions as the serial loop.
+	void consolidate_wr_using_sat_threaded(std::vector<Mem> &memories)
+	{
+		struct sat_task_t {
+			int mem_idx;
+			std::vector<int> ports;
+			std::vector<SigSpec> port_en;
+			int imported_cells = 0, num_vars = 0, num_clauses = 0;
+			std::vector<bool> collide;
+		};
+
+		std::vector<sat_task_t> tasks;
+		for (int i = 0; i < GetSize(memories); i++)
+			for (auto &group : wr_port_sat_groups(memories[i])) {
+				sat_task_t task;
+				task.mem_idx = i;
+				task.ports = group;
+				// private copies of the enable signals: reading a SigSpec
+				// is not thread-safe across tasks sharing a memory
+				for (auto idx : group)
+					task.port_en.push_back(memories[i].wr_ports[idx].en);
+				tasks.push_back(std::move(task));
+			}
 
-					SigSpec new_addr = module->Mux(NEW_ID, last_addr.extract_end(port1.wide_log2), this_addr.extract_end(port1.wide_log2), this_en_active);
+		if (tasks.empty())
+			return;
 
-					port1.addr = SigSpec({new_addr, port1.addr.extract(0, port1.wide_log2)});
-					port1.data = module->Mux(NEW_ID, last_data, this_data, this_en_active);
+		int chunks = min(num_threads, GetSize(tasks));
+
+		// Per-worker private copies of the module index, made on the main
+		// thread: SigMap lookups do path compression and the driver index
+		// holds IdStrings (copying an IdString bumps a global refcount).
+		std::vector<ModWalker> walkers;
+		walkers.reserve(chunks);
+		for (int i = 0; i < chunks; i++)
+			walkers.push_back(modwalker);
+
+		std::mutex import_mutex;
+		ThreadPool::run(chunks, chunks, [&](int t) {
+			for (int i = t; i < GetSize(tasks); i += chunks) {
+				auto &task = tasks[i];
+				QuickConeSat qcsat(walkers[t]);
+				std::vector<int> port_sat;
+				{
+					// Importing the input cone copies IdStrings and names
+					// sat literals through log_id()'s shared ring buffer,
+					// so it is serialized; the solver queries below are
+					// the expensive part and run concurrently.
+					std::lock_guard<std::mutex> lock(import_mutex);
+					for (auto &en : task.port_en)
+						port_sat.push_back(qcsat.ez->expression(qcsat.ez->OpOr, qcsat.importSig(en)));
+					qcsat.prepare();
+					task.imported_cells = GetSize(qcsat.imported_cells);
+					task.num_vars = qcsat.ez->numCnfVariables();
+					task.num_clauses = qcsat.ez->numCnfClauses();
+				}
+				int n = GetSize(task.ports);
+				task.collide.resize(n * n, false);
+				for (int a = 0; a < n; a++)
+				for (int b = a + 1; b < n; b++)
+					task.collide[a * n + b] = qcsat.ez->solve(port_sat[a], port_sat[b]);
+			}
+		});
 
-					std::map<std::pair<RTLIL::SigBit, RTLIL::SigBit>, int> groups_en;
-					RTLIL::SigSpec grouped_last_en, grouped_this_en, en;
-					RTLIL::Wire *grouped_en = module->addWire(NEW_ID, 0);
+		int last_mem_idx = -1;
+		bool changed = false;
+		for (auto &task : tasks)
+		{
+			Mem &mem = memories[task.mem_idx];
+			if (task.mem_idx != last_mem_idx) {
+				if (changed)
+					memories[last_mem_idx].emit();
+				changed = false;
+				last_mem_idx = task.mem_idx;
+				log("Consolidating write ports of memory %s.%s using sat-based resource sharing:\n", log_id(module), log_id(mem.memid));
+			}
 
-					for (int j = 0; j < int(this_en.size()); j++) {
-						std::pair<RTLIL::SigBit, RTLIL::SigBit> key(last_en[j], this_en[j]);
-						if (!groups_en.count(key)) {
-							grouped_last_en.append(last_en[j]);
-							grouped_this_en.append(this_en[j]);
-							groups_en[key] = grouped_en->width;
-							grouped_en->width++;
-						}
-						en.append(RTLIL::SigSpec(grouped_en, groups_en[key]));
+			auto &some_port = mem.wr_ports[task.ports[0]];
+			string ports;
+			for (auto idx : task.ports) {
+				if (idx != task.ports[0])
+					ports += ", ";
+				ports += std::to_string(idx);
+			}
+			if (!some_port.clk_enable) {
+				log("  Checking unclocked group, width %d: ports %s.\n", mem.width << some_port.wide_log2, ports.c_str());
+			} else {
+				log("  Checking group clocked with %sedge %s, width %d: ports %s.\n", some_port.clk_polarity ? "pos" : "neg", log_signal(some_port.clk), mem.width << some_port.wide_log2, ports.c_str());
+			}
+			log("  Common input cone for all EN signals: %d cells.\n", task.imported_cells);
+			log("  Size of unconstrained SAT problem: %d variables, %d clauses\n", task.num_vars, task.num_clauses);
+
+			// Replay the greedy merge loop.  A merged port stands for the
+			// set of original ports that went into it; it can collide with
+			// another port iff any of its members can.
+			int n = GetSize(task.ports);
+			std::vector<std::vector<int>> members(n);
+			std::vector<bool> merged(n, false);
+			for (int ii = 0; ii < n; ii++)
+				members[ii].push_back(ii);
+			for (int ii = 0; ii < n; ii++) {
+				if (merged[ii])
+					continue;
+				for (int jj = ii + 1; jj < n; jj++) {
+					if (merged[jj])
+						continue;
+					bool collide = false;
+					for (int a : members[ii])
+					for (int b : members[jj])
+						if (task.collide[min(a, b) * n + max(a, b)])
+							collide = true;
+					if (collide) {
+						log("  According to SAT solver sharing of port %d with port %d is not possible.\n", task.ports[ii], task.ports[jj]);
+						continue;
 					}
-
-					module->addMux(NEW_ID, grouped_last_en, grouped_this_en, this_en_active, grouped_en);
-					port1.en = en;
-
-					port2.removed = true;
+					log("  Merging port %d into port %d.\n", task.ports[jj], task.ports[ii]);
+					merge_wr_ports(mem, task.ports[ii], task.ports[jj]);
+					members[ii].insert(members[ii].end(), members[jj].begin(), members[jj].end());
+					merged[jj] = true;
 					changed = true;
 				}
 			}
 		}
-
 		if (changed)
-			mem.emit();
+			memories[last_mem_idx].emit();
 	}
 
 
@@ -503,8 +662,11 @@ struct MemoryShareWorker
 
 		modwalker.setup(module);
 
-		for (auto &mem : memories)
-			consolidate_wr_using_sat(mem);
+		if (num_threads > 1)
+			consolidate_wr_using_sat_threaded(memories);
+		else
+			for (auto &mem : memories)
+				consolidate_wr_using_sat(mem);
 	}
 };
 
@@ -514,7 +676,7 @@ struct MemorySharePass : public Pass {
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    memory_share [-nosat] [-nowiden] [selection]\n");
+		log("    memory_share [-nosat] [-nowiden] [-threads <n>] [selection]\n");
 		log("\n");
 		log("This pass merges share-able memory ports into single memory ports.\n");
 		log("\n");
@@ -531,6 +693,11 @@ struct MemorySharePass : public Pass {
 		log("    solver is used to determine this), then the ports are merged into a single\n");
 		log("    write port.  This transformation can be disabled with the \"-nosat\" option.\n");
 		log("\n");
+		log("With the \"-threads\" option, the SAT queries of the last transformation are\n");
+		log("run on the given number of worker threads, one work item per group of\n");
+		log("compatible write ports. The resulting netlist is identical to a\n");
+		log("single-threaded run.\n");
+		log("\n");
 		log("Note that in addition to the algorithms implemented in this pass, the $memrd\n");
 		log("and $memwr cells are also subject to generic resource sharing passes (and other\n");
 		log("optimizations) such as \"share\" and \"opt_merge\".\n");
@@ -539,6 +706,7 @@ struct MemorySharePass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override {
 		bool flag_widen = true;
 		bool flag_sat = true;
+		int num_threads = 1;
 		log_header(design, "Executing MEMORY_SHARE pass (consolidating $memrd/$memwr cells).\n");
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++)
@@ -553,10 +721,16 @@ struct MemorySharePass : public Pass {
 				flag_widen = false;
 				continue;
 			}
+			if (args[argidx] == "-threads" && argidx+1 < args.size())
+			{
+				num_threads = max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 		MemoryShareWorker msw(design, flag_widen, flag_sat);
+		msw.num_threads = num_threads;
 
 		for (auto module : design->selected_modules()) {
 			if (module->has_processes_warn())
@@ -20,6 +20,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -309,10 +310,18 @@ struct MuxpackWorker
 		candidate_cells.clear();
 	}
 
+	// the constructor only reads the module (sigmap, exclusive-selector
+	// database, chain next/prev index), so workers can build it for several
+	// modules in parallel; run() does the logging and rewriting and must
+	// stay on the main thread
 	MuxpackWorker(Module *module) :
 			module(module), sigmap(module), mux_count(0), pmux_count(0), excl_db(module, sigmap)
 	{
 		make_sig_chain_next_prev();
+	}
+
+	void run()
+	{
 		find_chain_start_cells();
 
 		for (auto c : chain_start_cells) {
@@ -355,10 +364,18 @@ struct MuxpackPass : public Pass {
 		int mux_count = 0;
 		int pmux_count = 0;
 
-		for (auto module : design->selected_modules()) {
-			MuxpackWorker worker(module);
-			mux_count += worker.mux_count;
-			pmux_count += worker.pmux_count;
+		std::vector<Module*> modules = design->selected_modules();
+		std::vector<std::unique_ptr<MuxpackWorker>> workers(GetSize(modules));
+
+		int num_threads = ThreadPool::thread_count(design);
+		ThreadPool::run(num_threads, GetSize(modules), [&](int idx) {
+			workers[idx].reset(new MuxpackWorker(modules[idx]));
+		});
+
+		for (auto &worker : workers) {
+			worker->run();
+			mux_count += worker->mux_count;
+			pmux_count += worker->pmux_count;
 		}
 
 		log("Converted %d (p)mux cells into %d pmux cells.\n", mux_count, pmux_count);
@@ -62,7 +62,24 @@ struct OptPass : public Pass {
 		log("Note: Options in square brackets (such as [-keepdc]) are passed through to\n");
 		log("the opt_* commands when given to 'opt'.\n");
 		log("\n");
+		log("Within one run of the loop, sub-passes that found nothing to do are skipped\n");
+		log("in later runs until some other sub-pass changes the design again, so the\n");
+		log("final confirmation runs only re-execute the sub-passes that still need to\n");
+		log("prove convergence.\n");
 		log("\n");
+		log("    -minyield <n>\n");
+		log("        stop iterating early when the previous run of the loop changed fewer\n");
+		log("        than <n> wires and cells per second of CPU time, instead of going to\n");
+		log("        the exact fixpoint (default: 0, always run to fixpoint)\n");
+		log("\n");
+	}
+
+	static int64_t design_object_count(RTLIL::Design *design)
+	{
+		int64_t count = 0;
+		for (auto module : design->modules())
+			count += GetSize(module->wires_) + GetSize(module->cells_);
+		return count;
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -74,6 +91,7 @@ struct OptPass : public Pass {
 		bool opt_share = false;
 		bool fast_mode = false;
 		bool noff_mode = false;
+		int min_yield = 0;
 
 		log_header(design, "Executing OPT pass (performing simple optimizations).\n");
 		log_push();
@@ -141,6 +159,12 @@ struct OptPass : public Pass {
 				noff_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-minyield" && argidx+1 < args.size()) {
+				min_yield = atoi(args[++argidx].c_str());
+				if (min_yield < 0)
+					log_cmd_error("Invalid -minyield value '%s'.\n", args[argidx].c_str());
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -164,19 +188,52 @@ struct OptPass : public Pass {
 		{
 			Pass::call(design, "opt_expr" + opt_expr_args);
 			Pass::call(design, "opt_merge -nomux" + opt_merge_args);
+
+			std::vector<std::string> loop_passes;
+			loop_passes.push_back("opt_muxtree");
+			loop_passes.push_back("opt_reduce" + opt_reduce_args);
+			loop_passes.push_back("opt_merge" + opt_merge_args);
+			if (opt_share)
+				loop_passes.push_back("opt_share");
+			if (!noff_mode)
+				loop_passes.push_back("opt_dff" + opt_dff_args);
+			loop_passes.push_back("opt_clean" + opt_clean_args);
+			loop_passes.push_back("opt_expr" + opt_expr_args);
+
+			// change_serial counts design changes made by the loop. clean_at_serial
+			// remembers the serial at which a sub-pass last ran without finding
+			// anything to do, so it can be skipped until the design changes again.
+			int64_t change_serial = 0;
+			std::vector<int64_t> clean_at_serial(loop_passes.size(), -1);
+
 			while (1) {
-				design->scratchpad_unset("opt.did_something");
-				Pass::call(design, "opt_muxtree");
-				Pass::call(design, "opt_reduce" + opt_reduce_args);
-				Pass::call(design, "opt_merge" + opt_merge_args);
-				if (opt_share)
-					Pass::call(design, "opt_share");
-				if (!noff_mode)
-					Pass::call(design, "opt_dff" + opt_dff_args);
-				Pass::call(design, "opt_clean" + opt_clean_args);
-				Pass::call(design, "opt_expr" + opt_expr_args);
-				if (design->scratchpad_get_bool("opt.did_something") == false)
+				int64_t size_before = min_yield > 0 ? design_object_count(design) : 0;
+				int64_t time_before = min_yield > 0 ? PerformanceTimer::query() : 0;
+				bool did_something = false;
+				for (size_t i = 0; i < loop_passes.size(); i++) {
+					if (clean_at_serial[i] == change_serial) {
+						log("Skipping %s (nothing changed since it last converged).\n", loop_passes[i].c_str());
+						continue;
+					}
+					design->scratchpad_unset("opt.did_something");
+					Pass::call(design, loop_passes[i]);
+					if (design->scratchpad_get_bool("opt.did_something")) {
+						change_serial++;
+						did_something = true;
+					} else
+						clean_at_serial[i] = change_serial;
+				}
+				if (!did_something)
 					break;
+				if (min_yield > 0) {
+					int64_t delta = design_object_count(design) - size_before;
+					int64_t yield_ns = PerformanceTimer::query() - time_before;
+					double yield = (delta < 0 ? -delta : delta) / std::max(yield_ns * 1e-9, 1e-9);
+					if (yield < min_yield) {
+						log_header(design, "Stopping OPT loop early. (Yield %.1f below -minyield %d.)\n", yield, min_yield);
+						break;
+					}
+				}
 				log_header(design, "Rerunning OPT passes. (Maybe there is more to do..)\n");
 			}
 		}
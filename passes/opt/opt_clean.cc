@@ -100,7 +100,85 @@ struct keep_cache_t
 	}
 };
 
+// Tracks which modules have been mutated since they were last cleaned, so
+// that repeated clean calls only have to traverse the changed modules. The
+// kernel only reports connection rewrites and module add/delete through
+// RTLIL::Monitor -- wires and cells come and go without notification -- so
+// cleanliness is additionally revalidated against the wire/cell/connection
+// counts recorded when the module was last cleaned. Any unreported mutation
+// that keeps all three counts unchanged would go unnoticed, but passes that
+// strand objects always rewrite at least one connection on the way.
+struct clean_state_t : RTLIL::Monitor
+{
+	struct module_state_t {
+		int num_wires, num_cells, num_conns;
+		bool purge_mode, dirty;
+	};
+
+	RTLIL::Design *design = nullptr;
+	Hasher::hash_t design_hashidx = 0;
+	dict<RTLIL::Module*, module_state_t> entries;
+
+	void attach(RTLIL::Design *current_design)
+	{
+		if (design != current_design || design_hashidx != current_design->hashidx_) {
+			// the previously monitored design may already be deleted, so
+			// just forget about it instead of detaching from it
+			entries.clear();
+			design = current_design;
+			design_hashidx = current_design->hashidx_;
+			design->monitors.insert(this);
+		}
+	}
+
+	void dirty(RTLIL::Module *mod)
+	{
+		auto it = entries.find(mod);
+		if (it != entries.end())
+			it->second.dirty = true;
+	}
+
+	void dirty_all()
+	{
+		// adding or removing a module can change the keep status of all
+		// cells instantiating it, which may unlock further removals
+		for (auto &it : entries)
+			it.second.dirty = true;
+	}
+
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString&, const RTLIL::SigSpec&, const RTLIL::SigSpec&) override { dirty(cell->module); }
+	void notify_connect(RTLIL::Module *mod, const RTLIL::SigSig&) override { dirty(mod); }
+	void notify_connect(RTLIL::Module *mod, const std::vector<RTLIL::SigSig>&) override { dirty(mod); }
+	void notify_blackout(RTLIL::Module *mod) override { dirty(mod); }
+	void notify_module_add(RTLIL::Module*) override { dirty_all(); }
+	void notify_module_del(RTLIL::Module *mod) override { dirty_all(); entries.erase(mod); }
+
+	bool can_skip(RTLIL::Module *mod, bool purge_mode)
+	{
+		auto it = entries.find(mod);
+		if (it == entries.end() || it->second.dirty)
+			return false;
+		// a purge clean removes a superset of what a normal clean removes
+		if (purge_mode && !it->second.purge_mode)
+			return false;
+		return it->second.num_wires == GetSize(mod->wires_) &&
+				it->second.num_cells == GetSize(mod->cells_) &&
+				it->second.num_conns == GetSize(mod->connections_);
+	}
+
+	void mark_clean(RTLIL::Module *mod, bool purge_mode)
+	{
+		module_state_t &state = entries[mod];
+		state.num_wires = GetSize(mod->wires_);
+		state.num_cells = GetSize(mod->cells_);
+		state.num_conns = GetSize(mod->connections_);
+		state.purge_mode = purge_mode;
+		state.dirty = false;
+	}
+};
+
 keep_cache_t keep_cache;
+clean_state_t clean_state;
 CellTypes ct_reg, ct_all;
 int count_rm_cells, count_rm_wires;
 
@@ -139,7 +217,7 @@ void rmunused_module_cells(Module *module, bool verbose)
 		for (auto &it2 : cell->connections()) {
 			if (ct_all.cell_known(cell->type) && !ct_all.cell_output(cell->type, it2.first))
 				continue;
-			for (auto raw_bit : it2.second) {
+			for (auto raw_bit : it2.second.bits_view()) {
 				if (raw_bit.wire == nullptr)
 					continue;
 				auto bit = sigmap(raw_bit);
@@ -160,10 +238,12 @@ void rmunused_module_cells(Module *module, bool verbose)
 	for (auto &it : module->wires_) {
 		Wire *wire = it.second;
 		if (wire->port_output || wire->get_bool_attribute(ID::keep)) {
-			for (auto bit : sigmap(wire))
+			SigSpec mapped_sig = sigmap(wire);
+			for (auto bit : mapped_sig.bits_view())
 			for (auto c : wire2driver[bit])
 				queue.insert(c), unused.erase(c);
-			for (auto raw_bit : SigSpec(wire))
+			SigSpec raw_sig(wire);
+			for (auto raw_bit : raw_sig.bits_view())
 				used_raw_bits.insert(raw_sigmap(raw_bit));
 		}
 	}
@@ -174,9 +254,11 @@ void rmunused_module_cells(Module *module, bool verbose)
 		pool<IdString> mems;
 		for (auto cell : queue) {
 			for (auto &it : cell->connections())
-				if (!ct_all.cell_known(cell->type) || ct_all.cell_input(cell->type, it.first))
-					for (auto bit : sigmap(it.second))
+				if (!ct_all.cell_known(cell->type) || ct_all.cell_input(cell->type, it.first)) {
+					SigSpec mapped_sig = sigmap(it.second);
+					for (auto bit : mapped_sig.bits_view())
 						bits.insert(bit);
+				}
 
 			if (cell->type.in(ID($memrd), ID($memrd_v2))) {
 				IdString mem_id = cell->getParam(ID::MEMID).decode_string();
@@ -208,9 +290,9 @@ void rmunused_module_cells(Module *module, bool verbose)
 		module->design->scratchpad_set_bool("opt.did_something", true);
 		if (RTLIL::builtin_ff_cell_types().count(cell->type))
 			ffinit.remove_init(cell->getPort(ID::Q));
-		module->remove(cell);
 		count_rm_cells++;
 	}
+	module->remove(unused);
 
 	for (auto it : mem_unused)
 	{
@@ -225,7 +307,8 @@ void rmunused_module_cells(Module *module, bool verbose)
 		for (auto &it2 : cell->connections()) {
 			if (ct_all.cell_known(cell->type) && !ct_all.cell_input(cell->type, it2.first))
 				continue;
-			for (auto raw_bit : raw_sigmap(it2.second))
+			SigSpec raw_sig = raw_sigmap(it2.second);
+			for (auto raw_bit : raw_sig.bits_view())
 				used_raw_bits.insert(raw_bit);
 		}
 	}
@@ -351,12 +434,13 @@ bool rmunused_module_signals(RTLIL::Module *module, bool purge_mode, bool verbos
 	// we are removing all connections
 	module->connections_.clear();
 
+	SigBitIndex bit_index;
 	// used signals sigmapped
-	SigPool used_signals;
+	SigBitFlatSet used_signals(bit_index);
 	// used signals pre-sigmapped
-	SigPool raw_used_signals;
+	SigBitFlatSet raw_used_signals(bit_index);
 	// used signals sigmapped, ignoring drivers (we keep track of this to set `unused_bits`)
-	SigPool used_signals_nodrivers;
+	SigBitFlatSet used_signals_nodrivers(bit_index);
 
 	// gather the usage information for cells
 	for (auto &it : module->cells_) {
@@ -599,7 +683,7 @@ void rmunused_module(RTLIL::Module *module, bool purge_mode, bool verbose, bool
 	if (verbose)
 		log("Finding unused cells or wires in module %s..\n", module->name.c_str());
 
-	std::vector<RTLIL::Cell*> delcells;
+	pool<RTLIL::Cell*> delcells;
 	for (auto cell : module->cells())
 		if (cell->type.in(ID($pos), ID($_BUF_)) && !cell->has_keep_attr()) {
 			bool is_signed = cell->type == ID($pos) && cell->getParam(ID::A_SIGNED).as_bool();
@@ -607,14 +691,13 @@ void rmunused_module(RTLIL::Module *module, bool purge_mode, bool verbose, bool
 			RTLIL::SigSpec y = cell->getPort(ID::Y);
 			a.extend_u0(GetSize(y), is_signed);
 			module->connect(y, a);
-			delcells.push_back(cell);
+			delcells.insert(cell);
 		}
-	for (auto cell : delcells) {
-		if (verbose)
+	if (verbose)
+		for (auto cell : delcells)
 			log_debug("  removing buffer cell `%s': %s = %s\n", cell->name.c_str(),
 					log_signal(cell->getPort(ID::Y)), log_signal(cell->getPort(ID::A)));
-		module->remove(cell);
-	}
+	module->remove(delcells);
 	if (!delcells.empty())
 		module->design->scratchpad_set_bool("opt.did_something", true);
 
@@ -643,10 +726,23 @@ struct OptCleanPass : public Pass {
 		log("    -purge\n");
 		log("        also remove internal nets if they have a public name\n");
 		log("\n");
+		log("    -incremental\n");
+		log("        skip modules that have not been modified since they were last\n");
+		log("        cleaned with this option. Modifications are tracked through design\n");
+		log("        monitor notifications and object counts, making repeated clean\n");
+		log("        calls proportional to the set of changed modules.\n");
+		log("\n");
+		log("    -compact\n");
+		log("        after cleaning, rebuild the internal wire and cell dictionaries in\n");
+		log("        topological order, so that subsequent passes iterating over the\n");
+		log("        module walk memory more sequentially\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool purge_mode = false;
+		bool incremental_mode = false;
+		bool compact_mode = false;
 
 		log_header(design, "Executing OPT_CLEAN pass (remove unused cells and wires).\n");
 		log_push();
@@ -657,12 +753,23 @@ struct OptCleanPass : public Pass {
 				purge_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-incremental") {
+				incremental_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-compact") {
+				compact_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
 		keep_cache.reset(design, purge_mode);
 
+		if (incremental_mode)
+			clean_state.attach(design);
+
 		ct_reg.setup_internals_mem();
 		ct_reg.setup_internals_anyinit();
 		ct_reg.setup_stdcells_mem();
@@ -672,12 +779,22 @@ struct OptCleanPass : public Pass {
 		count_rm_cells = 0;
 		count_rm_wires = 0;
 
+		int count_skipped_modules = 0;
+
 		for (auto module : design->selected_whole_modules_warn()) {
 			if (module->has_processes_warn())
 				continue;
+			if (incremental_mode && clean_state.can_skip(module, purge_mode)) {
+				count_skipped_modules++;
+				continue;
+			}
 			rmunused_module(module, purge_mode, true, true);
+			if (incremental_mode)
+				clean_state.mark_clean(module, purge_mode);
 		}
 
+		if (count_skipped_modules > 0)
+			log("Skipped %d unmodified modules.\n", count_skipped_modules);
 		if (count_rm_cells > 0 || count_rm_wires > 0)
 			log("Removed %d unused cells and %d unused wires.\n", count_rm_cells, count_rm_wires);
 
@@ -685,6 +802,12 @@ struct OptCleanPass : public Pass {
 		design->sort();
 		design->check();
 
+		// after design->sort(), so the name order does not clobber it again
+		if (compact_mode)
+			for (auto module : design->selected_whole_modules())
+				if (!module->has_processes())
+					module->compact();
+
 		keep_cache.reset();
 		ct_reg.clear();
 		ct_all.clear();
@@ -712,6 +835,8 @@ struct CleanPass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool purge_mode = false;
+		bool incremental_mode = false;
+		bool compact_mode = false;
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
@@ -719,12 +844,23 @@ struct CleanPass : public Pass {
 				purge_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-incremental") {
+				incremental_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-compact") {
+				compact_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
 		keep_cache.reset(design);
 
+		if (incremental_mode)
+			clean_state.attach(design);
+
 		ct_reg.setup_internals_mem();
 		ct_reg.setup_internals_anyinit();
 		ct_reg.setup_stdcells_mem();
@@ -737,7 +873,11 @@ struct CleanPass : public Pass {
 		for (auto module : design->selected_whole_modules()) {
 			if (module->has_processes())
 				continue;
+			if (incremental_mode && clean_state.can_skip(module, purge_mode))
+				continue;
 			rmunused_module(module, purge_mode, ys_debug(), true);
+			if (incremental_mode)
+				clean_state.mark_clean(module, purge_mode);
 		}
 
 		log_suppressed();
@@ -748,6 +888,11 @@ struct CleanPass : public Pass {
 		design->sort();
 		design->check();
 
+		if (compact_mode)
+			for (auto module : design->selected_whole_modules())
+				if (!module->has_processes())
+					module->compact();
+
 		keep_cache.reset();
 		ct_reg.clear();
 		ct_all.clear();
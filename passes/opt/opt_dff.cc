@@ -735,8 +735,19 @@ struct OptDffWorker
 	}
 
 	bool run_constbits() {
-		ModWalker modwalker(module->design, module);
-		QuickConeSat qcsat(modwalker);
+		// The ModWalker index and the solver are only needed for -sat queries
+		// on driven non-constant data bits; construct them on first use so the
+		// common run (-sat is off by default) doesn't pay for indexing the
+		// whole module.
+		std::unique_ptr<ModWalker> modwalker;
+		std::unique_ptr<QuickConeSat> qcsat;
+
+		auto ensure_qcsat = [&]() {
+			if (!modwalker) {
+				modwalker.reset(new ModWalker(module->design, module));
+				qcsat.reset(new QuickConeSat(*modwalker));
+			}
+		};
 
 		// Run as a separate sub-pass, so that we don't mutate (non-FF) cells under ModWalker.
 		bool did_something = false;
@@ -770,19 +781,20 @@ struct OptDffWorker
 						if (!opt.sat)
 							continue;
 						// For each register bit, try to prove that it cannot change from the initial value. If so, remove it
-						if (!modwalker.has_drivers(ff.sig_d.extract(i)))
+						ensure_qcsat();
+						if (!modwalker->has_drivers(ff.sig_d.extract(i)))
 							continue;
 						if (val != State::S0 && val != State::S1)
 							continue;
 
-						int init_sat_pi = qcsat.importSigBit(val);
-						int q_sat_pi = qcsat.importSigBit(ff.sig_q[i]);
-						int d_sat_pi = qcsat.importSigBit(ff.sig_d[i]);
+						int init_sat_pi = qcsat->importSigBit(val);
+						int q_sat_pi = qcsat->importSigBit(ff.sig_q[i]);
+						int d_sat_pi = qcsat->importSigBit(ff.sig_d[i]);
 
-						qcsat.prepare();
+						qcsat->prepare();
 
 						// Try to find out whether the register bit can change under some circumstances
-						bool counter_example_found = qcsat.ez->solve(qcsat.ez->IFF(q_sat_pi, init_sat_pi), qcsat.ez->NOT(qcsat.ez->IFF(d_sat_pi, init_sat_pi)));
+						bool counter_example_found = qcsat->ez->solve(qcsat->ez->IFF(q_sat_pi, init_sat_pi), qcsat->ez->NOT(qcsat->ez->IFF(d_sat_pi, init_sat_pi)));
 
 						// If the register bit cannot change, we can replace it with a constant
 						if (counter_example_found)
@@ -798,19 +810,20 @@ struct OptDffWorker
 						if (!opt.sat)
 							continue;
 						// For each register bit, try to prove that it cannot change from the initial value. If so, remove it
-						if (!modwalker.has_drivers(ff.sig_ad.extract(i)))
+						ensure_qcsat();
+						if (!modwalker->has_drivers(ff.sig_ad.extract(i)))
 							continue;
 						if (val != State::S0 && val != State::S1)
 							continue;
 
-						int init_sat_pi = qcsat.importSigBit(val);
-						int q_sat_pi = qcsat.importSigBit(ff.sig_q[i]);
-						int d_sat_pi = qcsat.importSigBit(ff.sig_ad[i]);
+						int init_sat_pi = qcsat->importSigBit(val);
+						int q_sat_pi = qcsat->importSigBit(ff.sig_q[i]);
+						int d_sat_pi = qcsat->importSigBit(ff.sig_ad[i]);
 
-						qcsat.prepare();
+						qcsat->prepare();
 
 						// Try to find out whether the register bit can change under some circumstances
-						bool counter_example_found = qcsat.ez->solve(qcsat.ez->IFF(q_sat_pi, init_sat_pi), qcsat.ez->NOT(qcsat.ez->IFF(d_sat_pi, init_sat_pi)));
+						bool counter_example_found = qcsat->ez->solve(qcsat->ez->IFF(q_sat_pi, init_sat_pi), qcsat->ez->NOT(qcsat->ez->IFF(d_sat_pi, init_sat_pi)));
 
 						// If the register bit cannot change, we can replace it with a constant
 						if (counter_example_found)
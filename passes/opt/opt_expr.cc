@@ -31,6 +31,86 @@ PRIVATE_NAMESPACE_BEGIN
 
 bool did_something;
 
+// Worklist bookkeeping for replace_const_cells(). The first round visits
+// every selected cell; a design monitor records which cells were rewritten
+// and which bits were given a new driver, and the following rounds only
+// revisit those cells plus the readers of the rewritten bits, so the cost
+// of reaching the fixpoint tracks the number of rewrites instead of the
+// module size. Cells are tracked by name so that entries for removed cells
+// simply resolve to nothing in the next round. All bits are normalized
+// through a SigMap snapshot taken at the start of the round, so the
+// recorded bits and the reader index always use the same representatives.
+struct OptExprWorklist : RTLIL::Monitor
+{
+	SigMap index_map;
+	dict<RTLIL::SigBit, pool<RTLIL::IdString>> readers;
+	pool<RTLIL::IdString> dirty_cells;
+	pool<RTLIL::SigBit> dirty_bits;
+	bool recording = false;
+
+	void record_dirty_sig(const RTLIL::SigSpec &sig)
+	{
+		for (auto bit : index_map(sig))
+			if (bit.wire != nullptr)
+				dirty_bits.insert(bit);
+	}
+
+	// Marks a cell and its outputs dirty. Used for rewrites that only change
+	// the cell type or parameters and thus produce no connect notification.
+	void record_dirty_cell(RTLIL::Cell *cell)
+	{
+		dirty_cells.insert(cell->name);
+		bool known = yosys_celltypes.cell_known(cell->type);
+		for (auto &conn : cell->connections())
+			if (!known || yosys_celltypes.cell_output(cell->type, conn.first))
+				record_dirty_sig(conn.second);
+	}
+
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec &old_sig, const RTLIL::SigSpec &sig) override
+	{
+		if (!recording)
+			return;
+		dirty_cells.insert(cell->name);
+		bool known = yosys_celltypes.cell_known(cell->type);
+		if (!known || yosys_celltypes.cell_input(cell->type, port))
+			for (auto bit : index_map(sig))
+				if (bit.wire != nullptr)
+					readers[bit].insert(cell->name);
+		if (!known || yosys_celltypes.cell_output(cell->type, port)) {
+			record_dirty_sig(old_sig);
+			record_dirty_sig(sig);
+		}
+	}
+
+	void notify_connect(RTLIL::Module*, const RTLIL::SigSig &sigsig) override
+	{
+		if (recording)
+			record_dirty_sig(sigsig.first);
+	}
+
+	void notify_connect(RTLIL::Module *module, const std::vector<RTLIL::SigSig> &sigsig_vec) override
+	{
+		for (auto &sigsig : sigsig_vec)
+			notify_connect(module, sigsig);
+	}
+
+	pool<RTLIL::IdString> take_worklist()
+	{
+		pool<RTLIL::IdString> result;
+		for (auto &bit : dirty_bits) {
+			auto it = readers.find(bit);
+			if (it != readers.end())
+				for (auto &name : it->second)
+					result.insert(name);
+		}
+		for (auto &name : dirty_cells)
+			result.insert(name);
+		dirty_bits.clear();
+		dirty_cells.clear();
+		return result;
+	}
+};
+
 void replace_undriven(RTLIL::Module *module, const CellTypes &ct)
 {
 	SigMap sigmap(module);
@@ -393,9 +473,12 @@ int get_highest_hot_index(RTLIL::SigSpec signal)
 	return -1;
 }
 
-void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool consume_x, bool mux_undef, bool mux_bool, bool do_fine, bool keepdc, bool noclkinv)
+void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool consume_x, bool mux_undef, bool mux_bool, bool do_fine, bool keepdc, bool noclkinv,
+		OptExprWorklist *worklist, const pool<RTLIL::IdString> *revisit, IncrementalSigMap &assign_map_inc)
 {
-	SigMap assign_map(module);
+	// the incremental map persists across rounds, so repeated calls merge
+	// new connections instead of rebuilding the map from scratch each time
+	SigMap &assign_map = assign_map_inc.get();
 	dict<RTLIL::SigSpec, RTLIL::SigSpec> invert_map;
 
 	for (auto cell : module->cells()) {
@@ -409,12 +492,27 @@ void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool cons
 		}
 	}
 
+	if (worklist != nullptr) {
+		worklist->index_map = assign_map;
+		worklist->readers.clear();
+		for (auto cell : module->cells())
+			if (design->selected(module, cell) && yosys_celltypes.cell_known(cell->type))
+				for (auto &conn : cell->connections())
+					if (yosys_celltypes.cell_input(cell->type, conn.first))
+						for (auto bit : assign_map(conn.second))
+							if (bit.wire != nullptr)
+								worklist->readers[bit].insert(cell->name);
+		worklist->recording = true;
+	}
+
 	CellTypes ct_memcells;
 	ct_memcells.setup_stdcells_mem();
 
 	if (!noclkinv)
 	for (auto cell : module->cells())
 	if (design->selected(module, cell)) {
+		if (revisit != nullptr && !revisit->count(cell->name))
+			continue;
 		if (cell->type.in(ID($dff), ID($dffe), ID($dffsr), ID($dffsre), ID($adff), ID($adffe), ID($aldff), ID($aldffe), ID($sdff), ID($sdffe), ID($sdffce), ID($fsm), ID($memrd), ID($memrd_v2), ID($memwr), ID($memwr_v2)))
 			handle_polarity_inv(cell, ID::CLK, ID::CLK_POLARITY, assign_map, invert_map);
 
@@ -495,6 +593,8 @@ void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool cons
 
 	for (auto cell : module->cells())
 	if (design->selected(module, cell) && yosys_celltypes.cell_evaluable(cell->type)) {
+		if (revisit != nullptr && !revisit->count(cell->name))
+			continue;
 		for (auto &conn : cell->connections())
 		if (yosys_celltypes.cell_output(cell->type, conn.first))
 		for (auto bit : assign_map(conn.second))
@@ -504,6 +604,8 @@ void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool cons
 
 	for (auto cell : module->cells())
 	if (design->selected(module, cell) && yosys_celltypes.cell_evaluable(cell->type)) {
+		if (revisit != nullptr && !revisit->count(cell->name))
+			continue;
 		const int r_index = cells.node(cell);
 		for (auto &conn : cell->connections())
 		if (yosys_celltypes.cell_input(cell->type, conn.first))
@@ -520,9 +622,35 @@ void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool cons
 
 	for (auto cell : cells.sorted)
 	{
+		// Bracket each cell with a private did_something so that rewrites
+		// that only change the cell type or parameters (and thus produce no
+		// connect notification) still mark the cell dirty for the next round.
+		IdString cell_name;
+		bool outer_did_something = did_something;
+		if (worklist != nullptr) {
+			cell_name = cell->name;
+			did_something = false;
+		}
 #define ACTION_DO(_p_, _s_) do { cover("opt.opt_expr.action_" S__LINE__); replace_cell(assign_map, module, cell, input.as_string(), _p_, _s_); goto next_cell; } while (0)
 #define ACTION_DO_Y(_v_) ACTION_DO(ID::Y, RTLIL::SigSpec(RTLIL::State::S ## _v_))
 
+		// normalize commutative cells so that a fully constant operand is
+		// always on port B; the constant and identity cases below then hit
+		// in one probe instead of being tested for both operand orders
+		if (cell->type.in(ID($add), ID($mul), ID($and), ID($or), ID($xor), ID($xnor),
+				ID($eq), ID($ne), ID($eqx), ID($nex), ID($logic_and), ID($logic_or)))
+		{
+			if (assign_map(cell->getPort(ID::A)).is_fully_const() && !assign_map(cell->getPort(ID::B)).is_fully_const()) {
+				cover("opt.opt_expr.commutative_swap");
+				RTLIL::SigSpec sig_b = cell->getPort(ID::B);
+				cell->setPort(ID::B, cell->getPort(ID::A));
+				cell->setPort(ID::A, sig_b);
+				std::swap(cell->parameters.at(ID::A_WIDTH), cell->parameters.at(ID::B_WIDTH));
+				std::swap(cell->parameters.at(ID::A_SIGNED), cell->parameters.at(ID::B_SIGNED));
+				did_something = true;
+			}
+		}
+
 		bool detect_const_and = false;
 		bool detect_const_or = false;
 
@@ -1304,38 +1432,44 @@ skip_fine_alu:
 			goto next_cell;
 		}
 
-		if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr), ID($shift), ID($shiftx)) && (keepdc ? assign_map(cell->getPort(ID::B)).is_fully_def() : assign_map(cell->getPort(ID::B)).is_fully_const()))
+		if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr), ID($shift), ID($shiftx)))
 		{
-			bool sign_ext = cell->type == ID($sshr) && cell->getParam(ID::A_SIGNED).as_bool();
-			int shift_bits = assign_map(cell->getPort(ID::B)).as_int(cell->type.in(ID($shift), ID($shiftx)) && cell->getParam(ID::B_SIGNED).as_bool());
+			// map the shift amount only once for the check, the shift and the log message
+			RTLIL::SigSpec sig_b = assign_map(cell->getPort(ID::B));
 
-			if (cell->type.in(ID($shl), ID($sshl)))
-				shift_bits *= -1;
+			if (keepdc ? sig_b.is_fully_def() : sig_b.is_fully_const())
+			{
+				bool sign_ext = cell->type == ID($sshr) && cell->getParam(ID::A_SIGNED).as_bool();
+				int shift_bits = sig_b.as_int(cell->type.in(ID($shift), ID($shiftx)) && cell->getParam(ID::B_SIGNED).as_bool());
 
-			RTLIL::SigSpec sig_a = assign_map(cell->getPort(ID::A));
-			RTLIL::SigSpec sig_y(cell->type == ID($shiftx) ? RTLIL::State::Sx : RTLIL::State::S0, cell->getParam(ID::Y_WIDTH).as_int());
+				if (cell->type.in(ID($shl), ID($sshl)))
+					shift_bits *= -1;
 
-			if (cell->type != ID($shiftx) && GetSize(sig_a) < GetSize(sig_y))
-				sig_a.extend_u0(GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
+				RTLIL::SigSpec sig_a = assign_map(cell->getPort(ID::A));
+				RTLIL::SigSpec sig_y(cell->type == ID($shiftx) ? RTLIL::State::Sx : RTLIL::State::S0, cell->getParam(ID::Y_WIDTH).as_int());
 
-			for (int i = 0; i < GetSize(sig_y); i++) {
-				int idx = i + shift_bits;
-				if (0 <= idx && idx < GetSize(sig_a))
-					sig_y[i] = sig_a[idx];
-				else if (GetSize(sig_a) <= idx && sign_ext)
-					sig_y[i] = sig_a[GetSize(sig_a)-1];
-			}
+				if (cell->type != ID($shiftx) && GetSize(sig_a) < GetSize(sig_y))
+					sig_a.extend_u0(GetSize(sig_y), cell->getParam(ID::A_SIGNED).as_bool());
 
-			cover_list("opt.opt_expr.constshift", "$shl", "$shr", "$sshl", "$sshr", "$shift", "$shiftx", cell->type.str());
+				for (int i = 0; i < GetSize(sig_y); i++) {
+					int idx = i + shift_bits;
+					if (0 <= idx && idx < GetSize(sig_a))
+						sig_y[i] = sig_a[idx];
+					else if (GetSize(sig_a) <= idx && sign_ext)
+						sig_y[i] = sig_a[GetSize(sig_a)-1];
+				}
 
-			log_debug("Replacing %s cell `%s' (B=%s, SHR=%d) in module `%s' with fixed wiring: %s\n",
-					log_id(cell->type), log_id(cell), log_signal(assign_map(cell->getPort(ID::B))), shift_bits, log_id(module), log_signal(sig_y));
+				cover_list("opt.opt_expr.constshift", "$shl", "$shr", "$sshl", "$sshr", "$shift", "$shiftx", cell->type.str());
 
-			module->connect(cell->getPort(ID::Y), sig_y);
-			module->remove(cell);
+				log_debug("Replacing %s cell `%s' (B=%s, SHR=%d) in module `%s' with fixed wiring: %s\n",
+						log_id(cell->type), log_id(cell), log_signal(sig_b), shift_bits, log_id(module), log_signal(sig_y));
 
-			did_something = true;
-			goto next_cell;
+				module->connect(cell->getPort(ID::Y), sig_y);
+				module->remove(cell);
+
+				did_something = true;
+				goto next_cell;
+			}
 		}
 
 		if (consume_x)
@@ -2198,7 +2332,15 @@ skip_alu_split:
 #undef ACTION_DO_Y
 #undef FOLD_1ARG_CELL
 #undef FOLD_2ARG_CELL
+		if (worklist != nullptr) {
+			if (did_something && module->cells_.count(cell_name))
+				worklist->record_dirty_cell(module->cells_.at(cell_name));
+			did_something |= outer_did_something;
+		}
 	}
+
+	if (worklist != nullptr)
+		worklist->recording = false;
 }
 
 void replace_const_connections(RTLIL::Module *module) {
@@ -2315,19 +2457,33 @@ struct OptExprPass : public Pass {
 					design->scratchpad_set_bool("opt.did_something", true);
 			}
 
+			OptExprWorklist worklist;
+			design->monitors.insert(&worklist);
+			IncrementalSigMap assign_map(module);
+
+			pool<RTLIL::IdString> revisit;
+			bool full_scan = true;
 			do {
 				do {
 					did_something = false;
-					replace_const_cells(design, module, false /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv);
+					replace_const_cells(design, module, false /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv,
+							&worklist, full_scan ? nullptr : &revisit, assign_map);
+					revisit = worklist.take_worklist();
+					full_scan = false;
 					if (did_something)
 						design->scratchpad_set_bool("opt.did_something", true);
 				} while (did_something);
-				if (!keepdc)
-					replace_const_cells(design, module, true /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv);
+				if (!keepdc) {
+					replace_const_cells(design, module, true /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv,
+							&worklist, nullptr, assign_map);
+					revisit = worklist.take_worklist();
+				}
 				if (did_something)
 					design->scratchpad_set_bool("opt.did_something", true);
 			} while (did_something);
 
+			design->monitors.erase(&worklist);
+
 			did_something = false;
 			replace_const_connections(module);
 			if (did_something)
@@ -0,0 +1,437 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/sigtools.h"
+#include "kernel/log.h"
+#include "kernel/celltypes.h"
+#include "kernel/ffinit.h"
+#include "kernel/threadpool.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+CellTypes ct_all;
+
+// Per-module reachability state. The constructor and the propagate/prune
+// steps run on the main thread; only mark() runs on worker threads. mark()
+// is restricted to operations that are safe while an RTLIL parallel section
+// is active: it looks up IdStrings (cell types, port names, attributes) but
+// never copies one, and it only writes to this worker's own containers keyed
+// by Cell* and SigBit.
+struct OptHierWorker
+{
+	Module *module;
+	bool analyze;
+
+	// cells with keep semantics, computed on the main thread before the
+	// mark phase (requires cross-module queries)
+	pool<Cell*> seed_cells;
+
+	// externally used bits of output port wires, seeded by the roots and
+	// filled in by the parents' propagate steps (wave by wave)
+	dict<Wire*, std::vector<bool>> ext_used;
+
+	SigMap sigmap;
+	pool<Cell*> live_cells;
+	pool<SigBit> live_bits;
+
+	OptHierWorker(Module *module, bool analyze) : module(module), analyze(analyze)
+	{
+		if (!analyze)
+			return;
+		for (auto wire : module->wires())
+			if (wire->port_output)
+				ext_used[wire] = std::vector<bool>(wire->width, false);
+	}
+
+	void set_all_outputs_used()
+	{
+		for (auto &it : ext_used)
+			it.second.assign(it.first->width, true);
+	}
+
+	// backward reachability from the externally used output bits and the
+	// keep seeds, following the same rules as opt_clean: a live cell makes
+	// its input bits (or all bits, for unknown cell types) live, a live
+	// bit makes its drivers live
+	void mark()
+	{
+		if (!analyze)
+			return;
+
+		sigmap.set(module);
+
+		dict<SigBit, pool<Cell*>> wire2driver;
+		pool<Cell*> queue;
+		pool<SigBit> bits;
+
+		for (auto &it : module->cells_) {
+			Cell *cell = it.second;
+			for (auto &conn : cell->connections()) {
+				if (ct_all.cell_known(cell->type) && !ct_all.cell_output(cell->type, conn.first))
+					continue;
+				for (auto raw_bit : conn.second) {
+					SigBit bit = sigmap(raw_bit);
+					if (bit.wire != nullptr)
+						wire2driver[bit].insert(cell);
+				}
+			}
+			if (seed_cells.count(cell))
+				queue.insert(cell);
+		}
+
+		for (auto &it : ext_used) {
+			for (int i = 0; i < it.first->width; i++)
+				if (it.second[i])
+					bits.insert(sigmap(SigBit(it.first, i)));
+		}
+
+		for (auto &it : module->wires_) {
+			Wire *wire = it.second;
+			if (wire->get_bool_attribute(ID::keep))
+				for (auto bit : sigmap(SigSpec(wire)))
+					if (bit.wire != nullptr)
+						bits.insert(bit);
+		}
+
+		while (true)
+		{
+			for (auto bit : bits) {
+				live_bits.insert(bit);
+				auto it = wire2driver.find(bit);
+				if (it != wire2driver.end())
+					for (auto cell : it->second)
+						if (!live_cells.count(cell))
+							queue.insert(cell);
+			}
+			bits.clear();
+
+			if (queue.empty())
+				break;
+
+			for (auto cell : queue) {
+				live_cells.insert(cell);
+				for (auto &conn : cell->connections())
+					if (!ct_all.cell_known(cell->type) || ct_all.cell_input(cell->type, conn.first))
+						for (auto bit : sigmap(conn.second))
+							if (bit.wire != nullptr && !live_bits.count(bit))
+								bits.insert(bit);
+			}
+			queue.clear();
+		}
+	}
+};
+
+// transitive version of the keep test in opt_clean: a module with keep
+// contents anywhere below it pins down all its instances
+struct module_keep_cache_t
+{
+	Design *design;
+	dict<Module*, bool> cache;
+
+	void reset(Design *design = nullptr)
+	{
+		this->design = design;
+		cache.clear();
+	}
+
+	bool query(Module *module)
+	{
+		if (module == nullptr)
+			return false;
+
+		if (cache.count(module))
+			return cache.at(module);
+
+		cache[module] = true;
+		if (!module->get_bool_attribute(ID::keep)) {
+			bool found_keep = false;
+			for (auto cell : module->cells())
+				if (query(cell)) {
+					found_keep = true;
+					break;
+				}
+			if (!found_keep)
+				for (auto wire : module->wires())
+					if (wire->get_bool_attribute(ID::keep)) {
+						found_keep = true;
+						break;
+					}
+			cache[module] = found_keep;
+		}
+
+		return cache[module];
+	}
+
+	bool query(Cell *cell)
+	{
+		if (cell->type.in(ID($assert), ID($assume), ID($live), ID($fair), ID($cover)))
+			return true;
+
+		if (cell->type.in(ID($overwrite_tag), ID($specify2), ID($specify3), ID($specrule)))
+			return true;
+
+		if (cell->type.in(ID($print), ID($check), ID($scopeinfo)))
+			return true;
+
+		// memory writes have no output bits and would otherwise always
+		// look dead; keeping them unconditionally is conservative, the
+		// memory bookkeeping in opt_clean removes write-only memories
+		if (cell->type.in(ID($memwr), ID($memwr_v2), ID($meminit), ID($meminit_v2)))
+			return true;
+
+		if (cell->has_keep_attr())
+			return true;
+
+		if (cell->module && cell->module->design)
+			return query(cell->module->design->module(cell->type));
+
+		return false;
+	}
+};
+
+module_keep_cache_t module_keep_cache;
+
+struct OptHierPass : public Pass {
+	OptHierPass() : Pass("opt_hier", "remove unused logic across the module hierarchy") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    opt_hier [selection]\n");
+		log("\n");
+		log("This pass computes which output port bits of each module are actually used by\n");
+		log("any of its instantiations and removes the cells that only feed unused outputs,\n");
+		log("together with the output ports that are used nowhere. Unlike 'opt_clean', which\n");
+		log("works module-locally and must treat every output port as used, this pass walks\n");
+		log("the hierarchy top-down, so unused branches of a configurable IP tree are pruned\n");
+		log("before 'flatten' replicates them per instance.\n");
+		log("\n");
+		log("The mark phase runs the modules of each hierarchy level in parallel when the\n");
+		log("'threads' scratchpad variable or the YOSYS_THREADS environment variable is set\n");
+		log("to a value greater than one.\n");
+		log("\n");
+		log("Modules with the 'top' attribute and modules that are not instantiated anywhere\n");
+		log("keep all their outputs. Modules that are only partially selected, contain\n");
+		log("processes, or are instantiated with unresolved parameters are left unchanged\n");
+		log("and all their instances' outputs count as used. Unused input ports are not\n");
+		log("removed. Run 'clean' afterwards to remove the wires of the pruned logic.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		log_header(design, "Executing OPT_HIER pass (remove unused logic across the module hierarchy).\n");
+
+		size_t argidx = 1;
+		extra_args(args, argidx, design);
+
+		ct_all.setup(design);
+		module_keep_cache.reset(design);
+
+		pool<Module*> analyzed;
+		for (auto module : design->selected_whole_modules_warn()) {
+			if (module->has_processes_warn())
+				continue;
+			if (module->get_blackbox_attribute())
+				continue;
+			analyzed.insert(module);
+		}
+
+		dict<Module*, OptHierWorker*> workers;
+		for (auto module : design->modules())
+			workers[module] = new OptHierWorker(module, analyzed.count(module) != 0);
+
+		// child modules per module, instantiation counts, and the keep seeds
+		dict<Module*, pool<Module*>> children;
+		dict<Module*, int> num_insts;
+		for (auto module : design->modules()) {
+			OptHierWorker *worker = workers.at(module);
+			for (auto cell : module->cells()) {
+				Module *child = design->module(cell->type);
+				if (child != nullptr) {
+					children[module].insert(child);
+					num_insts[child]++;
+				}
+				if (worker->analyze && module_keep_cache.query(cell))
+					worker->seed_cells.insert(cell);
+			}
+		}
+
+		// roots keep all their outputs; so do modules instantiated from
+		// modules we do not analyze, and parameterized instantiations that
+		// 'hierarchy' has not resolved to a derived module
+		for (auto module : design->modules()) {
+			OptHierWorker *worker = workers.at(module);
+			if (module->get_bool_attribute(ID::top) || num_insts[module] == 0)
+				worker->set_all_outputs_used();
+			for (auto cell : module->cells()) {
+				Module *child = design->module(cell->type);
+				if (child == nullptr)
+					continue;
+				if (!analyzed.count(module) || !cell->parameters.empty())
+					workers.at(child)->set_all_outputs_used();
+			}
+		}
+
+		// group the analyzed modules into hierarchy levels, parents before
+		// children, considering only edges between analyzed modules
+		dict<Module*, int> num_parents;
+		for (auto module : analyzed)
+			num_parents[module] = 0;
+		for (auto module : analyzed)
+			for (auto child : children[module])
+				if (analyzed.count(child))
+					num_parents[child]++;
+
+		dict<Module*, int> depth;
+		std::vector<Module*> topo_order;
+		for (auto module : analyzed)
+			if (num_parents.at(module) == 0) {
+				depth[module] = 0;
+				topo_order.push_back(module);
+			}
+		for (size_t i = 0; i < topo_order.size(); i++) {
+			Module *module = topo_order[i];
+			for (auto child : children[module])
+				if (analyzed.count(child)) {
+					depth[child] = max(depth[child], depth.at(module) + 1);
+					if (--num_parents.at(child) == 0)
+						topo_order.push_back(child);
+				}
+		}
+		for (auto module : analyzed)
+			if (num_parents.at(module) != 0)
+				log_error("Recursive instantiation of module %s.\n", log_id(module));
+
+		std::vector<std::vector<OptHierWorker*>> levels;
+		for (auto module : topo_order) {
+			int d = depth.at(module);
+			if (d >= GetSize(levels))
+				levels.resize(d+1);
+			levels[d].push_back(workers.at(module));
+		}
+
+		// mark phase: the modules of a level have all their parents in
+		// earlier levels, so their external usage is complete and they can
+		// be marked in parallel. Propagating the usage of the live
+		// instances into the children copies port names, so it stays on
+		// the main thread.
+		int num_threads = ThreadPool::thread_count(design);
+		for (auto &level : levels) {
+			ThreadPool::run(num_threads, GetSize(level), [&](int idx) {
+				level[idx]->mark();
+			});
+			for (auto worker : level)
+				for (auto cell : worker->live_cells) {
+					Module *child = design->module(cell->type);
+					if (child == nullptr || !cell->parameters.empty())
+						continue;
+					OptHierWorker *child_worker = workers.at(child);
+					for (auto &conn : cell->connections()) {
+						Wire *port_wire = child->wire(conn.first);
+						if (port_wire == nullptr || !port_wire->port_output)
+							continue;
+						auto it = child_worker->ext_used.find(port_wire);
+						if (it == child_worker->ext_used.end())
+							continue;
+						for (int i = 0; i < GetSize(conn.second) && i < port_wire->width; i++) {
+							SigBit bit = worker->sigmap(conn.second[i]);
+							if (bit.wire != nullptr && worker->live_bits.count(bit))
+								it->second[i] = true;
+						}
+					}
+				}
+		}
+
+		// prune phase: drop the dead cells, then turn the completely
+		// unused output ports into plain wires and remove the matching
+		// connections from all instances (all of which are in analyzed
+		// modules, since other instantiations pin the outputs as used)
+		int count_rm_cells = 0, count_rm_ports = 0;
+		dict<IdString, pool<IdString>> removed_ports;
+
+		for (auto module : topo_order)
+		{
+			OptHierWorker *worker = workers.at(module);
+
+			pool<Cell*> unused;
+			for (auto cell : module->cells())
+				if (!worker->live_cells.count(cell))
+					unused.insert(cell);
+
+			if (!unused.empty()) {
+				FfInitVals ffinit(&worker->sigmap, module);
+				unused.sort(RTLIL::sort_by_name_id<RTLIL::Cell>());
+				for (auto cell : unused) {
+					log_debug("  removing unused `%s' cell `%s' in module %s.\n",
+							cell->type.c_str(), cell->name.c_str(), log_id(module));
+					if (RTLIL::builtin_ff_cell_types().count(cell->type))
+						ffinit.remove_init(cell->getPort(ID::Q));
+					count_rm_cells++;
+				}
+				module->remove(unused);
+			}
+
+			bool removed_port = false;
+			for (auto &it : worker->ext_used) {
+				Wire *wire = it.first;
+				if (wire->width == 0 || wire->port_input || wire->get_bool_attribute(ID::keep))
+					continue;
+				if (std::find(it.second.begin(), it.second.end(), true) != it.second.end())
+					continue;
+				log_debug("  removing unused output port %s of module %s.\n", log_id(wire), log_id(module));
+				removed_ports[module->name].insert(wire->name);
+				wire->port_output = false;
+				wire->port_id = 0;
+				removed_port = true;
+				count_rm_ports++;
+			}
+			if (removed_port)
+				module->fixup_ports();
+
+			if (!unused.empty() || removed_port)
+				design->scratchpad_set_bool("opt.did_something", true);
+		}
+
+		for (auto module : topo_order)
+			for (auto cell : module->cells()) {
+				auto it = removed_ports.find(cell->type);
+				if (it == removed_ports.end())
+					continue;
+				for (auto port : it->second)
+					if (cell->hasPort(port))
+						cell->unsetPort(port);
+			}
+
+		if (count_rm_cells > 0 || count_rm_ports > 0)
+			log("Removed %d unused cells and %d unused output ports.\n", count_rm_cells, count_rm_ports);
+
+		for (auto &it : workers)
+			delete it.second;
+
+		design->sort();
+		design->check();
+
+		module_keep_cache.reset();
+		ct_all.clear();
+	}
+} OptHierPass;
+
+PRIVATE_NAMESPACE_END
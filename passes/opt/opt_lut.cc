@@ -48,27 +48,45 @@ struct OptLutWorker
 
 	int eliminated_count = 0, combined_count = 0;
 
-	bool evaluate_lut(RTLIL::Cell *lut, dict<SigBit, bool> inputs)
+	// Precomputed evaluation plan for one LUT: the table index is assembled
+	// from a constant base (covering inputs outside the evaluation space) and
+	// scattered bits of the evaluation word, so evaluating one table row is
+	// pure integer work instead of a dict lookup per input.
+	struct lut_eval_plan_t
+	{
+		Const table;
+		int base_index = 0;
+		// (bit of the evaluation word, bit of the table index)
+		std::vector<std::pair<int, int>> index_map;
+
+		bool evaluate(int eval) const
+		{
+			int index = base_index;
+			for (auto &m : index_map)
+				index |= ((eval >> m.first) & 1) << m.second;
+			return table.at(index) == State::S1;
+		}
+	};
+
+	lut_eval_plan_t plan_lut(RTLIL::Cell *lut, const dict<SigBit, int> &eval_positions)
 	{
 		SigSpec lut_input = sigmap(lut->getPort(ID::A));
 		int lut_width = lut->getParam(ID::WIDTH).as_int();
-		Const lut_table = lut->getParam(ID::LUT);
-		int lut_index = 0;
+
+		lut_eval_plan_t plan;
+		plan.table = lut->getParam(ID::LUT);
 
 		for (int i = 0; i < lut_width; i++)
 		{
 			SigBit input = sigmap(lut_input[i]);
-			if (inputs.count(input))
-			{
-				lut_index |= inputs[input] << i;
-			}
+			auto it = eval_positions.find(input);
+			if (it != eval_positions.end())
+				plan.index_map.push_back({it->second, i});
 			else
-			{
-				lut_index |= SigSpec(lut_input[i]).as_bool() << i;
-			}
+				plan.base_index |= SigSpec(lut_input[i]).as_bool() << i;
 		}
 
-		return lut_table.extract(lut_index).as_bool();
+		return plan;
 	}
 
 	void show_stats_by_arity()
@@ -228,6 +246,11 @@ struct OptLutWorker
 					lut_inputs.push_back(sigmap(bit));
 			}
 
+			dict<SigBit, int> eval_positions;
+			for (size_t i = 0; i < lut_inputs.size(); i++)
+				eval_positions[lut_inputs[i]] = i;
+			lut_eval_plan_t lut_plan = plan_lut(lut, eval_positions);
+
 			bool const0_match = true;
 			bool const1_match = true;
 			vector<bool> input_matches;
@@ -236,17 +259,14 @@ struct OptLutWorker
 
 			for (int eval = 0; eval < 1 << lut_inputs.size(); eval++)
 			{
-				dict<SigBit, bool> eval_inputs;
-				for (size_t i = 0; i < lut_inputs.size(); i++)
-					eval_inputs[lut_inputs[i]] = (eval >> i) & 1;
-				bool value = evaluate_lut(lut, eval_inputs);
+				bool value = lut_plan.evaluate(eval);
 				if (value != 0)
 					const0_match = false;
 				if (value != 1)
 					const1_match = false;
 				for (size_t i = 0; i < lut_inputs.size(); i++)
 				{
-					if (value != eval_inputs[lut_inputs[i]])
+					if (value != (bool)((eval >> eval_positions.at(lut_inputs[i])) & 1))
 						input_matches[i] = false;
 				}
 			}
@@ -484,16 +504,20 @@ struct OptLutWorker
 					}
 					log_assert(lutR_unique.size() == 0);
 
+					dict<SigBit, int> eval_positions;
+					for (size_t i = 0; i < lutM_new_inputs.size(); i++)
+						eval_positions[lutM_new_inputs[i]] = i;
+					lut_eval_plan_t lutA_plan = plan_lut(lutA, eval_positions);
+					// the cascade input is fed from cell A's output, which is
+					// evaluated first and passed in as an extra evaluation bit
+					eval_positions[lutA_output] = lutM_width;
+					lut_eval_plan_t lutB_plan = plan_lut(lutB, eval_positions);
+
 					RTLIL::Const lutM_new_table(State::Sx, 1 << lutM_width);
 					for (int eval = 0; eval < 1 << lutM_width; eval++)
 					{
-						dict<SigBit, bool> eval_inputs;
-						for (size_t i = 0; i < lutM_new_inputs.size(); i++)
-						{
-							eval_inputs[lutM_new_inputs[i]] = (eval >> i) & 1;
-						}
-						eval_inputs[lutA_output] = evaluate_lut(lutA, eval_inputs);
-						lutM_new_table.bits()[eval] = (RTLIL::State) evaluate_lut(lutB, eval_inputs);
+						int evalB = eval | (lutA_plan.evaluate(eval) << lutM_width);
+						lutM_new_table.bits()[eval] = (RTLIL::State) lutB_plan.evaluate(evalB);
 					}
 
 					log_debug("  Cell A truth table: %s.\n", lutA->getParam(ID::LUT).as_string().c_str());
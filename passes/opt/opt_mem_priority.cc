@@ -49,9 +49,13 @@ struct OptMemPriorityPass : public Pass {
 		int total_count = 0;
 		for (auto module : design->selected_modules()) {
 			modwalker.setup(module);
+			// One shared solver per module: memories commonly share address
+			// and enable logic, so their cones are imported only once. Only
+			// priority masks are changed here, never the imported logic.
+			QuickConeSatPool qcsat_pool(modwalker);
 			for (auto &mem : Mem::get_selected_memories(module)) {
 				bool mem_changed = false;
-				QuickConeSat qcsat(modwalker);
+				QuickConeSat &qcsat = qcsat_pool.get();
 				for (int i = 0; i < GetSize(mem.wr_ports); i++) {
 					auto &wport1 = mem.wr_ports[i];
 					for (int j = 0; j < GetSize(mem.wr_ports); j++) {
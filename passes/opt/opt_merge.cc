@@ -22,7 +22,6 @@
 #include "kernel/sigtools.h"
 #include "kernel/log.h"
 #include "kernel/celltypes.h"
-#include "libs/sha1/sha1.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <set>
@@ -42,6 +41,65 @@ struct OptMergeWorker
 	CellTypes ct;
 	int total_count;
 
+	// 128-bit structural cell signature, see
+	// hash_cell_parameters_and_connections()
+	struct CellSignature {
+		uint64_t h1, h2;
+		bool operator==(const CellSignature &other) const {
+			return h1 == other.h1 && h2 == other.h2;
+		}
+		Hasher hash_into(Hasher h) const {
+			h.hash64(h1);
+			h.hash64(h2);
+			return h;
+		}
+	};
+
+	// The cell signature index is kept across iterations of the fixpoint
+	// loop: hashes are cached per cell and only invalidated for cells whose
+	// (mapped) connections were touched by the previous iteration, so each
+	// round costs time proportional to the churn, not the design size.
+	dict<const RTLIL::Cell*, CellSignature> hash_cache;
+	dict<RTLIL::SigBit, pool<const RTLIL::Cell*>> hash_cache_bit_users;
+
+	struct ConnChangeMonitor : RTLIL::Monitor
+	{
+		OptMergeWorker *worker;
+		ConnChangeMonitor(OptMergeWorker *worker) : worker(worker) { }
+
+		void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString&, const RTLIL::SigSpec&, const RTLIL::SigSpec&) override {
+			worker->hash_cache.erase(cell);
+		}
+		void notify_connect(RTLIL::Module*, const RTLIL::SigSig &sigsig) override {
+			worker->invalidate_hashes(sigsig.first);
+		}
+		void notify_connect(RTLIL::Module*, const std::vector<RTLIL::SigSig> &sigsig_vec) override {
+			for (auto &sigsig : sigsig_vec)
+				worker->invalidate_hashes(sigsig.first);
+		}
+		void notify_blackout(RTLIL::Module*) override {
+			worker->hash_cache.clear();
+			worker->hash_cache_bit_users.clear();
+		}
+	};
+
+	ConnChangeMonitor monitor;
+
+	void invalidate_hashes(const RTLIL::SigSpec &sig)
+	{
+		// called from within Module::connect(), i.e. before the new alias
+		// is added to assign_map, so mapping still yields the bits the
+		// affected cells were registered under when they were hashed
+		for (auto &bit : assign_map(sig)) {
+			auto it = hash_cache_bit_users.find(bit);
+			if (it == hash_cache_bit_users.end())
+				continue;
+			for (auto cell : it->second)
+				hash_cache.erase(cell);
+			hash_cache_bit_users.erase(it);
+		}
+	}
+
 	static void sort_pmux_conn(dict<RTLIL::IdString, RTLIL::SigSpec> &conn)
 	{
 		SigSpec sig_s = conn.at(ID::S);
@@ -65,23 +123,26 @@ struct OptMergeWorker
 		}
 	}
 
-	std::string int_to_hash_string(unsigned int v)
+	// splitmix64 finalizer, used to derive the two independent lanes of a
+	// cell signature from one 64-bit item hash
+	static uint64_t mix64(uint64_t x)
 	{
-		if (v == 0)
-			return "0";
-		std::string str = "";
-		while (v > 0) {
-			str += 'a' + (v & 15);
-			v = v >> 4;
-		}
-		return str;
+		x += 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return x;
 	}
 
-        uint64_t hash_cell_parameters_and_connections(const RTLIL::Cell *cell)
+	// Canonical binary structural signature of a cell (128 bits): type,
+	// parameters and (mapped) connections are hashed directly instead of
+	// through an intermediate canonical string. The per-connection and
+	// per-parameter item hashes are combined by addition into two
+	// independently finalized lanes, so the signature does not depend on
+	// dict iteration order. Collisions are benign: sharemap candidates are
+	// always verified with compare_cell_parameters_and_connections().
+	CellSignature hash_cell_parameters_and_connections(const RTLIL::Cell *cell)
 	{
-		vector<string> hash_conn_strings;
-		std::string hash_string = cell->type.str() + "\n";
-
 		const dict<RTLIL::IdString, RTLIL::SigSpec> *conn = &cell->connections();
 		dict<RTLIL::IdString, RTLIL::SigSpec> alt_conn;
 
@@ -115,6 +176,19 @@ struct OptMergeWorker
 			conn = &alt_conn;
 		}
 
+		uint64_t acc1 = mix64(cell->type.index_);
+		uint64_t acc2 = mix64(acc1);
+
+		uint64_t item = 0;
+		auto feed = [&item](uint64_t v) {
+			item = (item ^ v) * 0x100000001b3ULL;
+		};
+		auto commit = [&]() {
+			acc1 += mix64(item);
+			acc2 += mix64(item ^ 0x9e3779b97f4a7c15ULL);
+			item = 0xcbf29ce484222325ULL;
+		};
+
 		for (auto &it : *conn) {
 			RTLIL::SigSpec sig;
 			if (cell->output(it.first)) {
@@ -128,27 +202,46 @@ struct OptMergeWorker
 			}
 			else
 				sig = assign_map(it.second);
-			string s = "C " + it.first.str() + "=";
+			for (auto &bit : sig)
+				if (bit.wire != nullptr)
+					hash_cache_bit_users[bit].insert(cell);
+			item = 0xcbf29ce484222325ULL;
+			feed(1);
+			feed(it.first.index_);
 			for (auto &chunk : sig.chunks()) {
-				if (chunk.wire)
-					s += "{" + chunk.wire->name.str() + " " +
-							int_to_hash_string(chunk.offset) + " " +
-							int_to_hash_string(chunk.width) + "}";
-				else
-					s += RTLIL::Const(chunk.data).as_string();
+				if (chunk.wire) {
+					feed(2);
+					feed(chunk.wire->name.index_);
+					feed(chunk.offset);
+					feed(chunk.width);
+				} else {
+					feed(3);
+					uint64_t word = 0;
+					int n = 0;
+					for (auto state : chunk.data) {
+						word = (word << 3) | (uint64_t)state;
+						if (++n == 21) {
+							feed(word);
+							word = 0, n = 0;
+						}
+					}
+					feed(word);
+					feed(GetSize(chunk.data));
+				}
 			}
-			hash_conn_strings.push_back(s + "\n");
+			commit();
 		}
 
-		for (auto &it : cell->parameters)
-			hash_conn_strings.push_back("P " + it.first.str() + "=" + it.second.as_string() + "\n");
-
-		std::sort(hash_conn_strings.begin(), hash_conn_strings.end());
-
-		for (auto it : hash_conn_strings)
-			hash_string += it;
+		for (auto &it : cell->parameters) {
+			item = 0xcbf29ce484222325ULL;
+			feed(4);
+			feed(it.first.index_);
+			feed(run_hash(it.second));
+			feed(GetSize(it.second));
+			commit();
+		}
 
-		return std::hash<std::string>{}(hash_string);
+		return CellSignature{acc1, acc2};
 	}
 
 	bool compare_cell_parameters_and_connections(const RTLIL::Cell *cell1, const RTLIL::Cell *cell2)
@@ -226,7 +319,7 @@ struct OptMergeWorker
 	}
 
 	OptMergeWorker(RTLIL::Design *design, RTLIL::Module *module, bool mode_nomux, bool mode_share_all, bool mode_keepdc) :
-		design(design), module(module), assign_map(module), mode_share_all(mode_share_all)
+		design(design), module(module), assign_map(module), mode_share_all(mode_share_all), monitor(this)
 	{
 		total_count = 0;
 		ct.setup_internals();
@@ -248,9 +341,12 @@ struct OptMergeWorker
 
 		log("Finding identical cells in module `%s'.\n", module->name.c_str());
 		assign_map.set(module);
+		hash_cache.reserve(module->cells_.size());
 
 		initvals.set(&assign_map, module);
 
+		module->monitors.insert(&monitor);
+
 		bool did_something = true;
 		while (did_something)
 		{
@@ -266,7 +362,8 @@ struct OptMergeWorker
 			}
 
 			did_something = false;
-                        dict<uint64_t, RTLIL::Cell*> sharemap;
+			dict<CellSignature, RTLIL::Cell*> sharemap;
+			sharemap.reserve(cells.size());
 			for (auto cell : cells)
 			{
 				if ((!mode_share_all && !ct.cell_known(cell->type)) || !cell->known())
@@ -275,7 +372,14 @@ struct OptMergeWorker
 				if (cell->type == ID($scopeinfo))
 					continue;
 
-				uint64_t hash = hash_cell_parameters_and_connections(cell);
+				CellSignature hash;
+				auto cached = hash_cache.find(cell);
+				if (cached != hash_cache.end()) {
+					hash = cached->second;
+				} else {
+					hash = hash_cell_parameters_and_connections(cell);
+					hash_cache[cell] = hash;
+				}
 				auto r = sharemap.insert(std::make_pair(hash, cell));
 				if (!r.second) {
 					if (compare_cell_parameters_and_connections(cell, r.first->second)) {
@@ -302,6 +406,7 @@ struct OptMergeWorker
 							}
 						}
 						log_debug("    Removing %s cell `%s' from module `%s'.\n", cell->type.c_str(), cell->name.c_str(), module->name.c_str());
+						hash_cache.erase(cell);
 						module->remove(cell);
 						total_count++;
 					}
@@ -309,6 +414,8 @@ struct OptMergeWorker
 			}
 		}
 
+		module->monitors.erase(&monitor);
+
 		log_suppressed();
 	}
 };
@@ -21,6 +21,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/log.h"
 #include "kernel/celltypes.h"
+#include "kernel/threadpool.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <set>
@@ -149,13 +150,14 @@ struct OptMuxtreeWorker
 
 		// Populate mux2info[].ports[]:
 		//	.input_muxes
-		for (int i = 0; i < GetSize(bit2info); i++)
-		for (int j : bit2info[i].mux_users)
-		for (auto &p : mux2info[j].ports) {
-			if (p.input_sigs.count(i))
-				for (int k : bit2info[i].mux_drivers)
-					p.input_muxes.insert(k);
-		}
+		// Each mux only reads the frozen bit database and writes its own
+		// entry, so this can be partitioned across worker threads.
+		ThreadPool::run(ThreadPool::thread_count(design), GetSize(mux2info), [&](int j) {
+			for (auto &p : mux2info[j].ports)
+				for (int i : p.input_sigs)
+					for (int k : bit2info[i].mux_drivers)
+						p.input_muxes.insert(k);
+		});
 
 		log("  Evaluating internal representation of mux trees.\n");
 
@@ -458,15 +460,24 @@ struct OptMuxtreeWorker
 		}
 	}
 
+	// The knowledge database is shared between the root mux evaluations:
+	// eval_mux_port() increments and decrements the counters symmetrically
+	// and resets the visited flags on the way out, so after a completed
+	// evaluation all entries are back to zero and the buffers can be reused
+	// without reallocating and clearing them for every tree. The only time
+	// they are left dirty is when the global abort counter hits zero, and
+	// then the whole pass gives up anyway.
+	knowledge_t knowledge;
+
 	void eval_root_mux(int mux_idx)
 	{
 		log_assert(glob_abort_cnt > 0);
-		knowledge_t knowledge;
 		knowledge.known_inactive.resize(GetSize(bit2info));
 		knowledge.known_active.resize(GetSize(bit2info));
 		knowledge.visited_muxes.resize(GetSize(mux2info));
 		knowledge.visited_muxes[mux_idx] = true;
 		eval_mux(knowledge, mux_idx, true, root_enable_muxes.at(mux_idx), 3);
+		knowledge.visited_muxes[mux_idx] = false;
 	}
 };
 
@@ -37,6 +37,14 @@ struct OptReduceWorker
 	int total_count;
 	bool did_something;
 
+	// The rebuilt input vectors are collected as 32-bit indices into this
+	// interned SigBit table, so the dedup steps below run on flat integer
+	// arrays instead of allocating a pool node per bit.  The arena is shared
+	// by all (possibly recursive) opt_reduce() calls with stack discipline:
+	// each call appends to it and truncates it back before returning.
+	idict<RTLIL::SigBit> bit_table;
+	std::vector<int> bit_arena;
+
 	void opt_reduce(pool<RTLIL::Cell*> &cells, SigSet<RTLIL::Cell*> &drivers, RTLIL::Cell *cell)
 	{
 		if (cells.count(cell) == 0)
@@ -45,28 +53,29 @@ struct OptReduceWorker
 
 		RTLIL::SigSpec sig_a = assign_map(cell->getPort(ID::A));
 		sig_a.sort_and_unify();
-		pool<RTLIL::SigBit> new_sig_a_bits;
+
+		size_t arena_base = bit_arena.size();
 
 		for (auto &bit : sig_a)
 		{
 			if (bit == RTLIL::State::S0) {
 				if (cell->type == ID($reduce_and)) {
-					new_sig_a_bits.clear();
-					new_sig_a_bits.insert(RTLIL::State::S0);
+					bit_arena.resize(arena_base);
+					bit_arena.push_back(bit_table(RTLIL::State::S0));
 					break;
 				}
 				continue;
 			}
 			if (bit == RTLIL::State::S1) {
 				if (cell->type == ID($reduce_or)) {
-					new_sig_a_bits.clear();
-					new_sig_a_bits.insert(RTLIL::State::S1);
+					bit_arena.resize(arena_base);
+					bit_arena.push_back(bit_table(RTLIL::State::S1));
 					break;
 				}
 				continue;
 			}
 			if (bit.wire == NULL) {
-				new_sig_a_bits.insert(bit);
+				bit_arena.push_back(bit_table(bit));
 				continue;
 			}
 
@@ -75,19 +84,25 @@ struct OptReduceWorker
 				if (child_cell->type == cell->type) {
 					opt_reduce(cells, drivers, child_cell);
 					if (child_cell->getPort(ID::Y)[0] == bit) {
-						pool<RTLIL::SigBit> child_sig_a_bits = assign_map(child_cell->getPort(ID::A)).to_sigbit_pool();
-						new_sig_a_bits.insert(child_sig_a_bits.begin(), child_sig_a_bits.end());
+						for (auto &child_bit : assign_map(child_cell->getPort(ID::A)))
+							bit_arena.push_back(bit_table(child_bit));
 					} else
-						new_sig_a_bits.insert(RTLIL::State::S0);
+						bit_arena.push_back(bit_table(RTLIL::State::S0));
 					imported_children = true;
 				}
 			}
 			if (!imported_children)
-				new_sig_a_bits.insert(bit);
+				bit_arena.push_back(bit_table(bit));
 		}
 
-		RTLIL::SigSpec new_sig_a(new_sig_a_bits);
+		std::sort(bit_arena.begin() + arena_base, bit_arena.end());
+		bit_arena.erase(std::unique(bit_arena.begin() + arena_base, bit_arena.end()), bit_arena.end());
+
+		RTLIL::SigSpec new_sig_a;
+		for (size_t i = arena_base; i < bit_arena.size(); i++)
+			new_sig_a.append(bit_table[bit_arena[i]]);
 		new_sig_a.sort_and_unify();
+		bit_arena.resize(arena_base);
 
 		if (GetSize(new_sig_a) == 0)
 			new_sig_a = (cell->type == ID($reduce_or)) ? State::S0 : State::S1;
@@ -110,20 +125,50 @@ struct OptReduceWorker
 		RTLIL::SigSpec sig_s = assign_map(cell->getPort(ID::S));
 
 		RTLIL::SigSpec new_sig_b, new_sig_s;
-		pool<RTLIL::SigSpec> handled_sig;
 
-		handled_sig.insert(sig_a);
+		// Pack the A signal and all B slices into interned bit indices once,
+		// so the quadratic duplicate scan below compares flat integer spans
+		// instead of extracting and comparing SigSpecs.
+		int width = sig_a.size();
+		std::vector<int> a_idx, b_idx;
+		a_idx.reserve(width);
+		for (auto &bit : sig_a)
+			a_idx.push_back(bit_table(bit));
+		b_idx.reserve(sig_b.size());
+		for (auto &bit : sig_b)
+			b_idx.push_back(bit_table(bit));
+
+		std::vector<bool> handled(sig_s.size(), false);
+
+		// Bucket the B slices by a signature hashed word-wise over their bit
+		// indices, so duplicates are merged near-linearly instead of by a
+		// pairwise scan that goes quadratic on wide pmuxes.
+		std::vector<Hasher::hash_t> slice_sig(sig_s.size());
+		dict<Hasher::hash_t, std::vector<int>> slice_buckets;
+		for (int i = 0; i < sig_s.size(); i++) {
+			Hasher h;
+			for (int k = i*width; k < (i+1)*width; k++)
+				h.eat(b_idx[k]);
+			slice_sig[i] = h.yield();
+			slice_buckets[slice_sig[i]].push_back(i);
+		}
+
 		for (int i = 0; i < sig_s.size(); i++)
 		{
-			RTLIL::SigSpec this_b = sig_b.extract(i*sig_a.size(), sig_a.size());
-			if (handled_sig.count(this_b) > 0)
+			if (handled[i])
+				continue;
+			if (std::equal(a_idx.begin(), a_idx.end(), b_idx.begin() + i*width))
 				continue;
 
+			RTLIL::SigSpec this_b = sig_b.extract(i*width, width);
 			RTLIL::SigSpec this_s = sig_s.extract(i, 1);
-			for (int j = i+1; j < sig_s.size(); j++) {
-				RTLIL::SigSpec that_b = sig_b.extract(j*sig_a.size(), sig_a.size());
-				if (this_b == that_b)
+			for (int j : slice_buckets.at(slice_sig[i])) {
+				if (j <= i || handled[j])
+					continue;
+				if (std::equal(b_idx.begin() + i*width, b_idx.begin() + (i+1)*width, b_idx.begin() + j*width)) {
 					this_s.append(sig_s.extract(j, 1));
+					handled[j] = true;
+				}
 			}
 
 			if (this_s.size() > 1)
@@ -141,7 +186,6 @@ struct OptReduceWorker
 
 			new_sig_b.append(this_b);
 			new_sig_s.append(this_s);
-			handled_sig.insert(this_b);
 		}
 
 		if (new_sig_s.size() == 0)
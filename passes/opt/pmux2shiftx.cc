@@ -20,6 +20,7 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/ffinit.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -187,6 +188,96 @@ struct OnehotDatabase
 	}
 };
 
+// Per-module read-only index consumed by the rewrite loop in pmux2shiftx:
+// sigmap, the one-hot source database and the selector comparison database
+// built from $eq/$logic_not cells. Building it never mutates the design, so
+// the pass constructs it for all selected modules in parallel.
+struct Pmux2ShiftxIndex
+{
+	Module *module;
+	SigMap sigmap;
+	OnehotDatabase onehot_db;
+
+	dict<SigBit, pair<SigSpec, Const>> eqdb;
+
+	Pmux2ShiftxIndex(Module *module) : module(module), sigmap(module), onehot_db(module, sigmap)
+	{
+		onehot_db.initialize();
+
+		for (auto cell : module->cells())
+		{
+			if (cell->type == ID($eq))
+			{
+				dict<SigBit, State> bits;
+
+				SigSpec A = sigmap(cell->getPort(ID::A));
+				SigSpec B = sigmap(cell->getPort(ID::B));
+
+				int a_width = cell->getParam(ID::A_WIDTH).as_int();
+				int b_width = cell->getParam(ID::B_WIDTH).as_int();
+
+				if (a_width < b_width) {
+					bool a_signed = cell->getParam(ID::A_SIGNED).as_int();
+					A.extend_u0(b_width, a_signed);
+				}
+
+				if (b_width < a_width) {
+					bool b_signed = cell->getParam(ID::B_SIGNED).as_int();
+					B.extend_u0(a_width, b_signed);
+				}
+
+				for (int i = 0; i < GetSize(A); i++) {
+					SigBit a_bit = A[i], b_bit = B[i];
+					if (b_bit.wire && !a_bit.wire) {
+						std::swap(a_bit, b_bit);
+					}
+					if (!a_bit.wire || b_bit.wire)
+						goto next_cell;
+					if (bits.count(a_bit))
+						goto next_cell;
+					bits[a_bit] = b_bit.data;
+				}
+
+				if (GetSize(bits) > 20)
+					goto next_cell;
+
+				bits.sort();
+				pair<SigSpec, Const> entry;
+
+				for (auto it : bits) {
+					entry.first.append(it.first);
+					entry.second.bits().push_back(it.second);
+				}
+
+				eqdb[sigmap(cell->getPort(ID::Y)[0])] = entry;
+				goto next_cell;
+			}
+
+			if (cell->type == ID($logic_not))
+			{
+				dict<SigBit, State> bits;
+
+				SigSpec A = sigmap(cell->getPort(ID::A));
+
+				for (int i = 0; i < GetSize(A); i++)
+					bits[A[i]] = State::S0;
+
+				bits.sort();
+				pair<SigSpec, Const> entry;
+
+				for (auto it : bits) {
+					entry.first.append(it.first);
+					entry.second.bits().push_back(it.second);
+				}
+
+				eqdb[sigmap(cell->getPort(ID::Y)[0])] = entry;
+				goto next_cell;
+			}
+	next_cell:;
+		}
+	}
+};
+
 struct Pmux2ShiftxPass : public Pass {
 	Pmux2ShiftxPass() : Pass("pmux2shiftx", "transform $pmux cells to $shiftx cells") { }
 	void help() override
@@ -273,85 +364,22 @@ struct Pmux2ShiftxPass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
-		for (auto module : design->selected_modules())
-		{
-			SigMap sigmap(module);
-			OnehotDatabase onehot_db(module, sigmap);
-			onehot_db.verbose = verbose_onehot;
-
-			dict<SigBit, pair<SigSpec, Const>> eqdb;
-
-			for (auto cell : module->cells())
-			{
-				if (cell->type == ID($eq))
-				{
-					dict<SigBit, State> bits;
-
-					SigSpec A = sigmap(cell->getPort(ID::A));
-					SigSpec B = sigmap(cell->getPort(ID::B));
+		std::vector<Module*> modules = design->selected_modules();
+		std::vector<std::unique_ptr<Pmux2ShiftxIndex>> indexes(GetSize(modules));
 
-					int a_width = cell->getParam(ID::A_WIDTH).as_int();
-					int b_width = cell->getParam(ID::B_WIDTH).as_int();
+		int num_threads = ThreadPool::thread_count(design);
+		ThreadPool::run(num_threads, GetSize(modules), [&](int idx) {
+			indexes[idx].reset(new Pmux2ShiftxIndex(modules[idx]));
+		});
 
-					if (a_width < b_width) {
-						bool a_signed = cell->getParam(ID::A_SIGNED).as_int();
-						A.extend_u0(b_width, a_signed);
-					}
-
-					if (b_width < a_width) {
-						bool b_signed = cell->getParam(ID::B_SIGNED).as_int();
-						B.extend_u0(a_width, b_signed);
-					}
-
-					for (int i = 0; i < GetSize(A); i++) {
-						SigBit a_bit = A[i], b_bit = B[i];
-						if (b_bit.wire && !a_bit.wire) {
-							std::swap(a_bit, b_bit);
-						}
-						if (!a_bit.wire || b_bit.wire)
-							goto next_cell;
-						if (bits.count(a_bit))
-							goto next_cell;
-						bits[a_bit] = b_bit.data;
-					}
-
-					if (GetSize(bits) > 20)
-						goto next_cell;
-
-					bits.sort();
-					pair<SigSpec, Const> entry;
-
-					for (auto it : bits) {
-						entry.first.append(it.first);
-						entry.second.bits().push_back(it.second);
-					}
-
-					eqdb[sigmap(cell->getPort(ID::Y)[0])] = entry;
-					goto next_cell;
-				}
-
-				if (cell->type == ID($logic_not))
-				{
-					dict<SigBit, State> bits;
-
-					SigSpec A = sigmap(cell->getPort(ID::A));
-
-					for (int i = 0; i < GetSize(A); i++)
-						bits[A[i]] = State::S0;
-
-					bits.sort();
-					pair<SigSpec, Const> entry;
-
-					for (auto it : bits) {
-						entry.first.append(it.first);
-						entry.second.bits().push_back(it.second);
-					}
+		for (auto &index : indexes)
+		{
+			Module *module = index->module;
+			SigMap &sigmap = index->sigmap;
+			OnehotDatabase &onehot_db = index->onehot_db;
+			onehot_db.verbose = verbose_onehot;
 
-					eqdb[sigmap(cell->getPort(ID::Y)[0])] = entry;
-					goto next_cell;
-				}
-		next_cell:;
-			}
+			dict<SigBit, pair<SigSpec, Const>> &eqdb = index->eqdb;
 
 			for (auto cell : module->selected_cells())
 			{
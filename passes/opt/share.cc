@@ -345,6 +345,7 @@ struct ShareWorker
 	// ---------------------------------------------------
 
 	pool<RTLIL::Cell*> shareable_cells;
+	dict<Hasher::hash_t, pool<RTLIL::Cell*>> shareable_cells_by_signature;
 
 	void find_shareable_cells()
 	{
@@ -492,11 +493,42 @@ struct ShareWorker
 		return true;
 	}
 
+	// Signature of the operand/parameter class a cell can possibly be shared
+	// within. Cells of different signatures never pass is_shareable_pair(),
+	// so partner search only has to scan the matching bucket instead of all
+	// shareable cells. Signature collisions are harmless: is_shareable_pair()
+	// is still checked for every candidate.
+	Hasher::hash_t shareable_cell_signature(RTLIL::Cell *cell)
+	{
+		Hasher h;
+		h.eat(cell->type);
+
+		if (cell->type.in(ID($memrd), ID($memrd_v2))) {
+			h.eat(cell->parameters.at(ID::MEMID).decode_string());
+			h.eat(cell->parameters.at(ID::WIDTH));
+		} else
+		if (!generic_ops.count(cell->type) && !cell->type.in(ID($alu), ID($macc))) {
+			// this class requires exact parameter equality
+			std::vector<std::pair<RTLIL::IdString, RTLIL::Const>> params(cell->parameters.begin(), cell->parameters.end());
+			std::sort(params.begin(), params.end(), [](const std::pair<RTLIL::IdString, RTLIL::Const> &a,
+					const std::pair<RTLIL::IdString, RTLIL::Const> &b) { return a.first < b.first; });
+			for (auto &p : params) {
+				h.eat(p.first);
+				h.eat(p.second);
+			}
+		}
+
+		return h.yield();
+	}
+
 	void find_shareable_partners(std::vector<RTLIL::Cell*> &results, RTLIL::Cell *cell)
 	{
 		results.clear();
-		for (auto c : shareable_cells)
-			if (c != cell && is_shareable_pair(c, cell))
+		auto it = shareable_cells_by_signature.find(shareable_cell_signature(cell));
+		if (it == shareable_cells_by_signature.end())
+			return;
+		for (auto c : it->second)
+			if (c != cell && shareable_cells.count(c) && is_shareable_pair(c, cell))
 				results.push_back(c);
 	}
 
@@ -767,6 +799,44 @@ struct ShareWorker
 		return forbidden_controls_cache[cell];
 	}
 
+	// Compute the forbidden controls for all shareable cells in one
+	// batched fanout-cone query instead of one recursive walk per cell.
+	// Cells created later (supercells) still go through the recursive
+	// find_forbidden_controls() above, which finds the precomputed
+	// results in the cache.
+	void precompute_forbidden_controls()
+	{
+		std::vector<RTLIL::Cell*> seeds(shareable_cells.begin(), shareable_cells.end());
+		std::vector<std::vector<int>> cones;
+		modwalker.get_fanout_cones(seeds, cones, -1, &fwd_ct, ThreadPool::thread_count(design));
+
+		std::vector<pool<RTLIL::SigBit>> direct_controls(GetSize(modwalker.index_to_cell));
+		std::vector<bool> direct_controls_valid(GetSize(modwalker.index_to_cell));
+
+		for (int i = 0; i < GetSize(seeds); i++)
+		{
+			pool<RTLIL::SigBit> &controls = forbidden_controls_cache[seeds[i]];
+
+			for (int idx : cones[i])
+			{
+				if (!direct_controls_valid[idx]) {
+					auto it = modwalker.cell_outputs.find(modwalker.index_to_cell[idx]);
+					if (it != modwalker.cell_outputs.end())
+						for (auto &bit : it->second) {
+							auto jt = modwalker.signal_consumers.find(bit);
+							if (jt == modwalker.signal_consumers.end())
+								continue;
+							for (auto &pbit : jt->second)
+								if ((pbit.cell->type == ID($mux) || pbit.cell->type == ID($pmux)) && pbit.port == ID::S)
+									direct_controls[idx].insert(pbit.cell->getPort(ID::S).extract(pbit.offset, 1));
+						}
+					direct_controls_valid[idx] = true;
+				}
+				controls.insert(direct_controls[idx].begin(), direct_controls[idx].end());
+			}
+		}
+	}
+
 
 	// --------------------------------------------------------
 	// Finding control inputs and activation pattern for a cell
@@ -939,6 +1009,36 @@ struct ShareWorker
 		return activation_patterns_cache[cell];
 	}
 
+	// Returns true if every pair of activation patterns from the two sets
+	// assigns opposite values to at least one common control bit. In that
+	// case the two cells are provably never active at the same time, whatever
+	// drives the control bits, and the SAT check can be skipped. This is the
+	// typical situation for cells reached through sibling mux branches.
+	bool activation_patterns_exclusive(const pool<ssc_pair_t> &patterns1, const pool<ssc_pair_t> &patterns2)
+	{
+		for (auto &p1 : patterns1)
+		{
+			dict<RTLIL::SigBit, RTLIL::State> values;
+			for (int i = 0; i < GetSize(p1.first); i++)
+				values.emplace(p1.first[i], p1.second[i]);
+
+			for (auto &p2 : patterns2)
+			{
+				bool conflict = false;
+				for (int i = 0; i < GetSize(p2.first); i++) {
+					auto it = values.find(p2.first[i]);
+					if (it != values.end() && it->second != p2.second[i]) {
+						conflict = true;
+						break;
+					}
+				}
+				if (!conflict)
+					return false;
+			}
+		}
+		return true;
+	}
+
 	RTLIL::SigSpec bits_from_activation_patterns(const pool<ssc_pair_t> &activation_patterns)
 	{
 		std::set<RTLIL::SigBit> all_bits;
@@ -1171,6 +1271,12 @@ struct ShareWorker
 		log("Found %d cells in module %s that may be considered for resource sharing.\n",
 				GetSize(shareable_cells), log_id(module));
 
+		shareable_cells_by_signature.clear();
+		for (auto c : shareable_cells)
+			shareable_cells_by_signature[shareable_cell_signature(c)].insert(c);
+
+		precompute_forbidden_controls();
+
 		while (!shareable_cells.empty() && config.limit != 0)
 		{
 			RTLIL::Cell *cell = *shareable_cells.begin();
@@ -1249,68 +1355,80 @@ struct ShareWorker
 				optimize_activation_patterns(filtered_cell_activation_patterns);
 				optimize_activation_patterns(filtered_other_cell_activation_patterns);
 
-				QuickConeSat qcsat(modwalker);
-				if (config.opt_fast) {
-					qcsat.max_cell_outs = 3;
-					qcsat.max_cell_count = 100;
-				}
-
-				pool<RTLIL::Cell*> sat_cells;
-				std::set<RTLIL::SigBit> bits_queue;
-
-				std::vector<int> cell_active, other_cell_active;
 				RTLIL::SigSpec all_ctrl_signals;
 
 				for (auto &p : filtered_cell_activation_patterns) {
 					log("      Activation pattern for cell %s: %s = %s\n", log_id(cell), log_signal(p.first), log_signal(p.second));
-					cell_active.push_back(qcsat.ez->vec_eq(qcsat.importSig(p.first), qcsat.importSig(p.second)));
 					all_ctrl_signals.append(p.first);
 				}
 
 				for (auto &p : filtered_other_cell_activation_patterns) {
 					log("      Activation pattern for cell %s: %s = %s\n", log_id(other_cell), log_signal(p.first), log_signal(p.second));
-					other_cell_active.push_back(qcsat.ez->vec_eq(qcsat.importSig(p.first), qcsat.importSig(p.second)));
 					all_ctrl_signals.append(p.first);
 				}
 
-				qcsat.prepare();
+				all_ctrl_signals.sort_and_unify();
 
-				int sub1 = qcsat.ez->expression(qcsat.ez->OpOr, cell_active);
-				if (!qcsat.ez->solve(sub1)) {
-					log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(cell));
-					cells_to_remove.insert(cell);
-					break;
+				if (activation_patterns_exclusive(filtered_cell_activation_patterns, filtered_other_cell_activation_patterns))
+				{
+					log("      All activation pattern pairs conflict on a control bit. Skipping SAT check.\n");
 				}
+				else
+				{
+					QuickConeSat qcsat(modwalker);
+					if (config.opt_fast) {
+						qcsat.max_cell_outs = 3;
+						qcsat.max_cell_count = 100;
+					}
 
-				int sub2 = qcsat.ez->expression(qcsat.ez->OpOr, other_cell_active);
-				if (!qcsat.ez->solve(sub2)) {
-					log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(other_cell));
-					cells_to_remove.insert(other_cell);
-					shareable_cells.erase(other_cell);
-					continue;
-				}
+					pool<RTLIL::Cell*> sat_cells;
 
-				qcsat.ez->non_incremental();
+					std::vector<int> cell_active, other_cell_active;
 
-				all_ctrl_signals.sort_and_unify();
-				std::vector<int> sat_model = qcsat.importSig(all_ctrl_signals);
-				std::vector<bool> sat_model_values;
+					for (auto &p : filtered_cell_activation_patterns)
+						cell_active.push_back(qcsat.ez->vec_eq(qcsat.importSig(p.first), qcsat.importSig(p.second)));
 
-				qcsat.ez->assume(qcsat.ez->AND(sub1, sub2));
+					for (auto &p : filtered_other_cell_activation_patterns)
+						other_cell_active.push_back(qcsat.ez->vec_eq(qcsat.importSig(p.first), qcsat.importSig(p.second)));
 
-				log("      Size of SAT problem: %d cells, %d variables, %d clauses\n",
-						GetSize(sat_cells), qcsat.ez->numCnfVariables(), qcsat.ez->numCnfClauses());
+					qcsat.prepare();
 
-				if (qcsat.ez->solve(sat_model, sat_model_values)) {
-					log("      According to the SAT solver this pair of cells can not be shared.\n");
-					log("      Model from SAT solver: %s = %d'", log_signal(all_ctrl_signals), GetSize(sat_model_values));
-					for (int i = GetSize(sat_model_values)-1; i >= 0; i--)
-						log("%c", sat_model_values[i] ? '1' : '0');
-					log("\n");
-					continue;
-				}
+					int sub1 = qcsat.ez->expression(qcsat.ez->OpOr, cell_active);
+					if (!qcsat.ez->solve(sub1)) {
+						log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(cell));
+						cells_to_remove.insert(cell);
+						break;
+					}
+
+					int sub2 = qcsat.ez->expression(qcsat.ez->OpOr, other_cell_active);
+					if (!qcsat.ez->solve(sub2)) {
+						log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(other_cell));
+						cells_to_remove.insert(other_cell);
+						shareable_cells.erase(other_cell);
+						continue;
+					}
 
-				log("      According to the SAT solver this pair of cells can be shared.\n");
+					qcsat.ez->non_incremental();
+
+					std::vector<int> sat_model = qcsat.importSig(all_ctrl_signals);
+					std::vector<bool> sat_model_values;
+
+					qcsat.ez->assume(qcsat.ez->AND(sub1, sub2));
+
+					log("      Size of SAT problem: %d cells, %d variables, %d clauses\n",
+							GetSize(sat_cells), qcsat.ez->numCnfVariables(), qcsat.ez->numCnfClauses());
+
+					if (qcsat.ez->solve(sat_model, sat_model_values)) {
+						log("      According to the SAT solver this pair of cells can not be shared.\n");
+						log("      Model from SAT solver: %s = %d'", log_signal(all_ctrl_signals), GetSize(sat_model_values));
+						for (int i = GetSize(sat_model_values)-1; i >= 0; i--)
+							log("%c", sat_model_values[i] ? '1' : '0');
+						log("\n");
+						continue;
+					}
+
+					log("      According to the SAT solver this pair of cells can be shared.\n");
+				}
 
 				if (find_in_input_cone(cell, other_cell)) {
 					log("      Sharing not possible: %s is in input cone of %s.\n", log_id(other_cell), log_id(cell));
@@ -1371,6 +1489,7 @@ struct ShareWorker
 				optimize_activation_patterns(supercell_activation_patterns);
 				activation_patterns_cache[supercell] = supercell_activation_patterns;
 				shareable_cells.insert(supercell);
+				shareable_cells_by_signature[shareable_cell_signature(supercell)].insert(supercell);
 
 				for (auto bit : topo_sigmap(all_ctrl_signals))
 					for (auto c : topo_bit_drivers[bit])
@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 #include "kernel/modtools.h"
 #include "kernel/ffinit.h"
 
@@ -396,6 +397,141 @@ struct WreduceWorker
 		}
 	}
 
+	// True if a (mapped) bit may be dropped from an output port of a cell:
+	// not a module output, not kept, and used by at most max_ports ports.
+	// Worker-thread safe: const lookups only.
+	bool bit_unused(SigBit bit, int max_ports) const
+	{
+		if (keep_bits.count(bit))
+			return false;
+		auto it = mi.database.find(bit);
+		if (it == mi.database.end())
+			return true;
+		return !it->second.is_output && GetSize(it->second.ports) <= max_ports;
+	}
+
+	bool prefilter_inport(SigMap &sigmap, Cell *cell, IdString port, IdString signed_param, int max_port_size) const
+	{
+		bool port_signed = cell->getParam(signed_param).as_bool();
+		SigSpec sig = sigmap(cell->getPort(port));
+
+		if (port == ID::B && cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr)))
+			port_signed = false;
+
+		if (GetSize(sig) > max_port_size)
+			return true;
+
+		if (port_signed) {
+			if (GetSize(sig) > 1 && sig[GetSize(sig)-1] == sig[GetSize(sig)-2])
+				return true;
+			// might allow a signed-to-unsigned conversion
+			if (GetSize(sig) > 0 && sig[GetSize(sig)-1] == State::S0)
+				return true;
+		} else {
+			if (GetSize(sig) > 1 && sig[GetSize(sig)-1] == State::S0)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Read-only mirror of the conditions under which run_cell() would
+	// modify a cell. Conservative: may return true for a cell the serial
+	// sweep then leaves untouched, but never false for one it would
+	// change. Runs on worker threads, so only the caller's sigmap copy and
+	// const lookups into mi.database and keep_bits are allowed here; see
+	// the contract in kernel/threadpool.h.
+	bool prefilter_cell(SigMap &sigmap, Cell *cell) const
+	{
+		if (!config->supported_cell_types.count(cell->type))
+			return false;
+
+		if (cell->type.in(ID($mux), ID($pmux))) {
+			SigSpec sig_y = sigmap(cell->getPort(ID::Y));
+			if (sig_y.has_const() || GetSize(sig_y) == 0)
+				return false;
+			int i = GetSize(sig_y)-1;
+			if (bit_unused(sig_y[i], 1))
+				return true;
+			// the inputs might agree on the top bit
+			SigSpec sig_a = sigmap(cell->getPort(ID::A));
+			SigSpec sig_b = sigmap(cell->getPort(ID::B));
+			int n_s = GetSize(cell->getPort(ID::S));
+			SigBit ref = sig_a[i];
+			for (int k = 0; k < n_s; k++) {
+				SigBit b = sig_b[k*GetSize(sig_a) + i];
+				if ((config->keepdc || !config->mux_undef || (ref != State::Sx && b != State::Sx)) && ref != b)
+					return false;
+				if (b != State::Sx)
+					ref = b;
+			}
+			return true;
+		}
+
+		if (cell->type.in(ID($dff), ID($dffe), ID($adff), ID($adffe), ID($sdff), ID($sdffe), ID($sdffce), ID($dlatch), ID($adlatch))) {
+			SigSpec sig_d = sigmap(cell->getPort(ID::D));
+			SigSpec sig_q = sigmap(cell->getPort(ID::Q));
+			if (GetSize(sig_q) == 0)
+				return false;
+			int i = GetSize(sig_q)-1;
+			// zero/sign extension candidates (the initval and reset value
+			// conditions are left to the serial re-analysis)
+			if (sig_d[i] == State::S0)
+				return true;
+			if (i > 0 && sig_d[i] == sig_d[i-1])
+				return true;
+			return bit_unused(sig_q[i], 1);
+		}
+
+		SigSpec sig = sigmap(cell->getPort(ID::Y));
+
+		if (sig.has_const())
+			return false;
+		if (GetSize(sig) == 0)
+			return true;
+
+		int max_port_a_size = cell->hasPort(ID::A) ? GetSize(cell->getPort(ID::A)) : -1;
+		int max_port_b_size = cell->hasPort(ID::B) ? GetSize(cell->getPort(ID::B)) : -1;
+
+		if (cell->type.in(ID($not), ID($pos), ID($neg), ID($and), ID($or), ID($xor), ID($add), ID($sub))) {
+			max_port_a_size = min(max_port_a_size, GetSize(sig));
+			max_port_b_size = min(max_port_b_size, GetSize(sig));
+		}
+
+		if (max_port_a_size >= 0 && cell->type != ID($shiftx) &&
+				prefilter_inport(sigmap, cell, ID::A, ID::A_SIGNED, max_port_a_size))
+			return true;
+
+		if (max_port_b_size >= 0 && prefilter_inport(sigmap, cell, ID::B, ID::B_SIGNED, max_port_b_size))
+			return true;
+
+		bool port_a_signed = cell->hasPort(ID::A) && cell->getParam(ID::A_SIGNED).as_bool();
+
+		if (!(port_a_signed && cell->type == ID($shr)) && bit_unused(sig[GetSize(sig)-1], 1))
+			return true;
+
+		if (cell->type.in(ID($pos), ID($add), ID($mul), ID($and), ID($or), ID($xor), ID($sub))) {
+			int a_size = 0, b_size = 0;
+			if (cell->hasPort(ID::A)) a_size = GetSize(cell->getPort(ID::A));
+			if (cell->hasPort(ID::B)) b_size = GetSize(cell->getPort(ID::B));
+
+			int max_y_size = max(a_size, b_size);
+
+			if (cell->type.in(ID($add), ID($sub)))
+				max_y_size++;
+
+			if (cell->type == ID($mul))
+				max_y_size = a_size + b_size;
+
+			max_y_size = std::max(max_y_size, 1);
+
+			if (GetSize(sig) > max_y_size)
+				return true;
+		}
+
+		return false;
+	}
+
 	static int count_nontrivial_wire_attrs(RTLIL::Wire *w)
 	{
 		int count = w->attributes.size();
@@ -419,6 +555,26 @@ struct WreduceWorker
 		for (auto c : module->selected_cells())
 			work_queue_cells.insert(c);
 
+		// Parallel prefilter for the first sweep: analyze all cells
+		// read-only on worker threads and drop the ones run_cell() provably
+		// would not touch, so only the candidates pay for the serial
+		// analysis. Each worker maps through its own SigMap copy (lookups
+		// path-compress the shared one) and the shrinking itself stays
+		// serial. Later sweeps only see the churn via work_queue_bits.
+		int num_threads = ThreadPool::thread_count(module->design);
+		if (num_threads > 1 && !work_queue_cells.empty()) {
+			std::vector<Cell*> cells(work_queue_cells.begin(), work_queue_cells.end());
+			std::vector<uint8_t> candidate(GetSize(cells), 0);
+			ThreadPool::run(num_threads, num_threads, [&](int t) {
+				SigMap sigmap_copy(mi.sigmap);
+				for (int i = t; i < GetSize(cells); i += num_threads)
+					candidate[i] = prefilter_cell(sigmap_copy, cells[i]) ? 1 : 0;
+			});
+			for (int i = 0; i < GetSize(cells); i++)
+				if (!candidate[i])
+					work_queue_cells.erase(cells[i]);
+		}
+
 		while (!work_queue_cells.empty())
 		{
 			work_queue_bits.clear();
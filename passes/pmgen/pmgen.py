@@ -334,6 +334,16 @@ for fn in pmgfiles:
     with open(fn, "r") as f:
         process_pmgfile(f, fn)
 
+# Patterns that never call nusers() do not need the sigusers index. Skipping
+# it makes setup() proportional to the given cell list instead of a walk over
+# every connection of every cell in the module, which matters for matchers
+# like peepopt that re-run setup after every round of rewrites.
+uses_nusers = False
+for fn in pmgfiles:
+    with open(fn, "r") as fh:
+        if re.search(r"\bnusers\b", fh.read()):
+            uses_nusers = True
+
 if current_pattern is not None:
     block = dict()
     block["type"] = "final"
@@ -393,7 +403,8 @@ with open(outfile, "w") as f:
             print("  typedef std::tuple<{}> index_{}_key_type;".format(", ".join(index_types), index), file=f)
             print("  typedef std::tuple<{}> index_{}_value_type;".format(", ".join(value_types), index), file=f)
             print("  dict<index_{}_key_type, vector<index_{}_value_type>> index_{};".format(index, index, index), file=f)
-    print("  dict<SigBit, pool<Cell*>> sigusers;", file=f)
+    if uses_nusers:
+        print("  dict<SigBit, pool<Cell*>> sigusers;", file=f)
     print("  pool<Cell*> blacklist_cells;", file=f)
     print("  pool<Cell*> autoremove_cells;", file=f)
     print("  dict<Cell*,int> rollback_cache;", file=f)
@@ -421,13 +432,14 @@ with open(outfile, "w") as f:
             print("  IdString {}{{\"{}\"}};".format(v, n), file=f)
     print("", file=f)
 
-    print("  void add_siguser(const SigSpec &sig, Cell *cell) {", file=f)
-    print("    for (auto bit : sigmap(sig)) {", file=f)
-    print("      if (bit.wire == nullptr) continue;", file=f)
-    print("      sigusers[bit].insert(cell);", file=f)
-    print("    }", file=f)
-    print("  }", file=f)
-    print("", file=f)
+    if uses_nusers:
+        print("  void add_siguser(const SigSpec &sig, Cell *cell) {", file=f)
+        print("    for (auto bit : sigmap(sig)) {", file=f)
+        print("      if (bit.wire == nullptr) continue;", file=f)
+        print("      sigusers[bit].insert(cell);", file=f)
+        print("    }", file=f)
+        print("  }", file=f)
+        print("", file=f)
 
     print("  void blacklist(Cell *cell) {", file=f)
     print("    if (cell != nullptr && blacklist_cells.insert(cell).second) {", file=f)
@@ -472,14 +484,15 @@ with open(outfile, "w") as f:
     print("  }", file=f)
     print("", file=f)
 
-    print("  int nusers(const SigSpec &sig) {", file=f)
-    print("    pool<Cell*> users;", file=f)
-    print("    for (auto bit : sigmap(sig))", file=f)
-    print("      for (auto user : sigusers[bit])", file=f)
-    print("        users.insert(user);", file=f)
-    print("    return GetSize(users);", file=f)
-    print("  }", file=f)
-    print("", file=f)
+    if uses_nusers:
+        print("  int nusers(const SigSpec &sig) {", file=f)
+        print("    pool<Cell*> users;", file=f)
+        print("    for (auto bit : sigmap(sig))", file=f)
+        print("      for (auto user : sigusers[bit])", file=f)
+        print("        users.insert(user);", file=f)
+        print("    return GetSize(users);", file=f)
+        print("  }", file=f)
+        print("", file=f)
 
     print("  {}_pm(Module *module, const vector<Cell*> &cells) :".format(prefix), file=f)
     print("      module(module), sigmap(module), setup_done(false), generate_mode(false), rngseed(12345678) {", file=f)
@@ -502,11 +515,12 @@ with open(outfile, "w") as f:
     current_pattern = None
     print("    log_assert(!setup_done);", file=f)
     print("    setup_done = true;", file=f)
-    print("    for (auto port : module->ports)", file=f)
-    print("      add_siguser(module->wire(port), nullptr);", file=f)
-    print("    for (auto cell : module->cells())", file=f)
-    print("      for (auto &conn : cell->connections())", file=f)
-    print("        add_siguser(conn.second, cell);", file=f)
+    if uses_nusers:
+        print("    for (auto port : module->ports)", file=f)
+        print("      add_siguser(module->wire(port), nullptr);", file=f)
+        print("    for (auto cell : module->cells())", file=f)
+        print("      for (auto &conn : cell->connections())", file=f)
+        print("        add_siguser(conn.second, cell);", file=f)
     print("    for (auto cell : cells) {", file=f)
 
     for index in range(len(blocks)):
@@ -53,8 +53,30 @@ RTLIL::SigSpec find_any_lvalue(const RTLIL::Process *proc)
 	return lvalue;
 }
 
-void gen_dffsr_complex(RTLIL::Module *mod, RTLIL::SigSpec sig_d, RTLIL::SigSpec sig_q, RTLIL::SigSpec clk, bool clk_polarity,
-		std::vector<std::pair<RTLIL::SigSpec, RTLIL::SyncRule*>> &async_rules, RTLIL::Process *proc)
+// One planned register cell. proc_dff first collects a plan per register
+// while walking the processes, then materialize_ff_plans() creates all cells
+// of the module in one batch, so the cell index grows once instead of
+// rehashing on the way to millions of FFs.
+struct ff_plan_t
+{
+	enum { PLAN_DFFSR, PLAN_ALDFF, PLAN_DFF } kind;
+	RTLIL::Process *proc;
+	RTLIL::SigSpec sig_d, sig_q, clk;
+	bool clk_polarity = false;
+	// PLAN_DFFSR
+	RTLIL::SigSpec sr_set, sr_clr;
+	// PLAN_ALDFF and PLAN_DFF: async level trigger (aload resp. arst)
+	RTLIL::SigSpec set;
+	bool set_polarity = false;
+	// PLAN_ALDFF: non-constant async load value
+	RTLIL::SigSpec sig_ad;
+	// PLAN_DFF
+	RTLIL::Const val_rst;
+	bool has_arst = false;
+};
+
+void plan_dffsr_complex(RTLIL::Module *mod, RTLIL::SigSpec sig_d, RTLIL::SigSpec sig_q, RTLIL::SigSpec clk, bool clk_polarity,
+		std::vector<std::pair<RTLIL::SigSpec, RTLIL::SyncRule*>> &async_rules, RTLIL::Process *proc, std::vector<ff_plan_t> &plans)
 {
 	// A signal should be set/cleared if there is a load trigger that is enabled
 	// such that the load value is 1/0 and it is the highest priority trigger
@@ -78,73 +100,115 @@ void gen_dffsr_complex(RTLIL::Module *mod, RTLIL::SigSpec sig_d, RTLIL::SigSpec
 		sig_sr_clr = mod->Mux(NEW_ID, sig_sr_clr, sync_value_inv, pos_trig);
 	}
 
-	std::stringstream sstr;
-	sstr << "$procdff$" << (autoidx++);
-
-	RTLIL::Cell *cell = mod->addDffsr(sstr.str(), clk, sig_sr_set, sig_sr_clr, sig_d, sig_q, clk_polarity);
-	cell->attributes = proc->attributes;
+	ff_plan_t plan;
+	plan.kind = ff_plan_t::PLAN_DFFSR;
+	plan.proc = proc;
+	plan.sig_d = sig_d;
+	plan.sig_q = sig_q;
+	plan.clk = clk;
+	plan.clk_polarity = clk_polarity;
+	plan.sr_set = sig_sr_set;
+	plan.sr_clr = sig_sr_clr;
+	plans.push_back(plan);
+}
 
-	log("  created %s cell `%s' with %s edge clock and multiple level-sensitive resets.\n",
-			cell->type.c_str(), cell->name.c_str(), clk_polarity ? "positive" : "negative");
+void plan_aldff(RTLIL::SigSpec sig_in, RTLIL::SigSpec sig_set, RTLIL::SigSpec sig_out,
+		bool clk_polarity, bool set_polarity, RTLIL::SigSpec clk, RTLIL::SigSpec set, RTLIL::Process *proc, std::vector<ff_plan_t> &plans)
+{
+	ff_plan_t plan;
+	plan.kind = ff_plan_t::PLAN_ALDFF;
+	plan.proc = proc;
+	plan.sig_d = sig_in;
+	plan.sig_q = sig_out;
+	plan.clk = clk;
+	plan.clk_polarity = clk_polarity;
+	plan.set = set;
+	plan.set_polarity = set_polarity;
+	plan.sig_ad = sig_set;
+	plans.push_back(plan);
 }
 
-void gen_aldff(RTLIL::Module *mod, RTLIL::SigSpec sig_in, RTLIL::SigSpec sig_set, RTLIL::SigSpec sig_out,
-		bool clk_polarity, bool set_polarity, RTLIL::SigSpec clk, RTLIL::SigSpec set, RTLIL::Process *proc)
+void plan_dff(RTLIL::SigSpec sig_in, RTLIL::Const val_rst, RTLIL::SigSpec sig_out,
+		bool clk_polarity, bool arst_polarity, RTLIL::SigSpec clk, RTLIL::SigSpec *arst, RTLIL::Process *proc, std::vector<ff_plan_t> &plans)
 {
-	std::stringstream sstr;
-	sstr << "$procdff$" << (autoidx++);
-
-	RTLIL::Cell *cell = mod->addCell(sstr.str(), ID($aldff));
-	cell->attributes = proc->attributes;
-
-	cell->parameters[ID::WIDTH] = RTLIL::Const(sig_in.size());
-	cell->parameters[ID::ALOAD_POLARITY] = RTLIL::Const(set_polarity, 1);
-	cell->parameters[ID::CLK_POLARITY] = RTLIL::Const(clk_polarity, 1);
-	cell->setPort(ID::D, sig_in);
-	cell->setPort(ID::Q, sig_out);
-	cell->setPort(ID::AD, sig_set);
-	cell->setPort(ID::CLK, clk);
-	cell->setPort(ID::ALOAD, set);
-
-	log("  created %s cell `%s' with %s edge clock and %s level non-const reset.\n", cell->type.c_str(), cell->name.c_str(),
-			clk_polarity ? "positive" : "negative", set_polarity ? "positive" : "negative");
+	ff_plan_t plan;
+	plan.kind = ff_plan_t::PLAN_DFF;
+	plan.proc = proc;
+	plan.sig_d = sig_in;
+	plan.sig_q = sig_out;
+	plan.clk = clk;
+	plan.clk_polarity = clk_polarity;
+	plan.val_rst = val_rst;
+	plan.has_arst = arst != nullptr;
+	plan.set_polarity = arst_polarity;
+	if (arst)
+		plan.set = *arst;
+	plans.push_back(plan);
 }
 
-void gen_dff(RTLIL::Module *mod, RTLIL::SigSpec sig_in, RTLIL::Const val_rst, RTLIL::SigSpec sig_out,
-		bool clk_polarity, bool arst_polarity, RTLIL::SigSpec clk, RTLIL::SigSpec *arst, RTLIL::Process *proc)
+void materialize_ff_plans(RTLIL::Module *mod, const std::vector<ff_plan_t> &plans)
 {
-	std::stringstream sstr;
-	sstr << "$procdff$" << (autoidx++);
+	mod->reserve_new_cells(GetSize(plans));
 
-	RTLIL::Cell *cell = mod->addCell(sstr.str(), clk.empty() ? ID($ff) : arst ? ID($adff) : ID($dff));
-	cell->attributes = proc->attributes;
+	for (auto &plan : plans)
+	{
+		std::string name = stringf("$procdff$%d", autoidx++);
+		RTLIL::Cell *cell;
 
-	cell->parameters[ID::WIDTH] = RTLIL::Const(sig_in.size());
-	if (arst) {
-		cell->parameters[ID::ARST_POLARITY] = RTLIL::Const(arst_polarity, 1);
-		cell->parameters[ID::ARST_VALUE] = val_rst;
-	}
-	if (!clk.empty()) {
-		cell->parameters[ID::CLK_POLARITY] = RTLIL::Const(clk_polarity, 1);
-	}
+		switch (plan.kind)
+		{
+		case ff_plan_t::PLAN_DFFSR:
+			cell = mod->addDffsr(name, plan.clk, plan.sr_set, plan.sr_clr, plan.sig_d, plan.sig_q, plan.clk_polarity);
+			cell->attributes = plan.proc->attributes;
+			log("  created %s cell `%s' with %s edge clock and multiple level-sensitive resets.\n",
+					cell->type.c_str(), cell->name.c_str(), plan.clk_polarity ? "positive" : "negative");
+			break;
 
-	cell->setPort(ID::D, sig_in);
-	cell->setPort(ID::Q, sig_out);
-	if (arst)
-		cell->setPort(ID::ARST, *arst);
-	if (!clk.empty())
-		cell->setPort(ID::CLK, clk);
-
-	if (!clk.empty())
-		log("  created %s cell `%s' with %s edge clock", cell->type.c_str(), cell->name.c_str(), clk_polarity ? "positive" : "negative");
-	else
-		log("  created %s cell `%s' with global clock", cell->type.c_str(), cell->name.c_str());
-	if (arst)
-		log(" and %s level reset", arst_polarity ? "positive" : "negative");
-	log(".\n");
+		case ff_plan_t::PLAN_ALDFF:
+			cell = mod->addCell(name, ID($aldff));
+			cell->attributes = plan.proc->attributes;
+			cell->parameters[ID::WIDTH] = RTLIL::Const(plan.sig_d.size());
+			cell->parameters[ID::ALOAD_POLARITY] = RTLIL::Const(plan.set_polarity, 1);
+			cell->parameters[ID::CLK_POLARITY] = RTLIL::Const(plan.clk_polarity, 1);
+			cell->setPort(ID::D, plan.sig_d);
+			cell->setPort(ID::Q, plan.sig_q);
+			cell->setPort(ID::AD, plan.sig_ad);
+			cell->setPort(ID::CLK, plan.clk);
+			cell->setPort(ID::ALOAD, plan.set);
+			log("  created %s cell `%s' with %s edge clock and %s level non-const reset.\n", cell->type.c_str(), cell->name.c_str(),
+					plan.clk_polarity ? "positive" : "negative", plan.set_polarity ? "positive" : "negative");
+			break;
+
+		case ff_plan_t::PLAN_DFF:
+			cell = mod->addCell(name, plan.clk.empty() ? ID($ff) : plan.has_arst ? ID($adff) : ID($dff));
+			cell->attributes = plan.proc->attributes;
+			cell->parameters[ID::WIDTH] = RTLIL::Const(plan.sig_d.size());
+			if (plan.has_arst) {
+				cell->parameters[ID::ARST_POLARITY] = RTLIL::Const(plan.set_polarity, 1);
+				cell->parameters[ID::ARST_VALUE] = plan.val_rst;
+			}
+			if (!plan.clk.empty()) {
+				cell->parameters[ID::CLK_POLARITY] = RTLIL::Const(plan.clk_polarity, 1);
+			}
+			cell->setPort(ID::D, plan.sig_d);
+			cell->setPort(ID::Q, plan.sig_q);
+			if (plan.has_arst)
+				cell->setPort(ID::ARST, plan.set);
+			if (!plan.clk.empty())
+				cell->setPort(ID::CLK, plan.clk);
+			if (!plan.clk.empty())
+				log("  created %s cell `%s' with %s edge clock", cell->type.c_str(), cell->name.c_str(), plan.clk_polarity ? "positive" : "negative");
+			else
+				log("  created %s cell `%s' with global clock", cell->type.c_str(), cell->name.c_str());
+			if (plan.has_arst)
+				log(" and %s level reset", plan.set_polarity ? "positive" : "negative");
+			log(".\n");
+			break;
+		}
+	}
 }
 
-void proc_dff(RTLIL::Module *mod, RTLIL::Process *proc, ConstEval &ce)
+void proc_dff(RTLIL::Module *mod, RTLIL::Process *proc, ConstEval &ce, std::vector<ff_plan_t> &plans)
 {
 	while (1)
 	{
@@ -261,7 +325,7 @@ void proc_dff(RTLIL::Module *mod, RTLIL::Process *proc, ConstEval &ce)
 		if (async_rules.size() > 1)
 		{
 			log_warning("Complex async reset for dff `%s'.\n", log_signal(sig));
-			gen_dffsr_complex(mod, insig, sig, sync_edge->signal, sync_edge->type == RTLIL::SyncType::STp, async_rules, proc);
+			plan_dffsr_complex(mod, insig, sig, sync_edge->signal, sync_edge->type == RTLIL::SyncType::STp, async_rules, proc, plans);
 			continue;
 		}
 
@@ -273,18 +337,18 @@ void proc_dff(RTLIL::Module *mod, RTLIL::Process *proc, ConstEval &ce)
 		if (!rstval.is_fully_const() && !ce.eval(rstval))
 		{
 			log_warning("Async reset value `%s' is not constant!\n", log_signal(rstval));
-			gen_aldff(mod, insig, rstval, sig_q,
+			plan_aldff(insig, rstval, sig_q,
 					sync_edge->type == RTLIL::SyncType::STp,
 					sync_level && sync_level->type == RTLIL::SyncType::ST1,
-					sync_edge->signal, sync_level->signal, proc);
+					sync_edge->signal, sync_level->signal, proc, plans);
 			continue;
 		}
 
-		gen_dff(mod, insig, rstval.as_const(), sig_q,
+		plan_dff(insig, rstval.as_const(), sig_q,
 				sync_edge && sync_edge->type == RTLIL::SyncType::STp,
 				sync_level && sync_level->type == RTLIL::SyncType::ST1,
 				sync_edge ? sync_edge->signal : SigSpec(),
-				sync_level ? &sync_level->signal : NULL, proc);
+				sync_level ? &sync_level->signal : NULL, proc, plans);
 	}
 }
 
@@ -309,9 +373,11 @@ struct ProcDffPass : public Pass {
 		for (auto mod : design->modules())
 			if (design->selected(mod)) {
 				ConstEval ce(mod);
+				std::vector<ff_plan_t> plans;
 				for (auto &proc_it : mod->processes)
 					if (design->selected(mod, proc_it.second))
-						proc_dff(mod, proc_it.second, ce);
+						proc_dff(mod, proc_it.second, ce, plans);
+				materialize_ff_plans(mod, plans);
 			}
 	}
 } ProcDffPass;
@@ -20,6 +20,7 @@
 #include "kernel/register.h"
 #include "kernel/bitpattern.h"
 #include "kernel/log.h"
+#include "kernel/threadpool.h"
 #include <sstream>
 #include <stdlib.h>
 #include <stdio.h>
@@ -318,46 +319,41 @@ const pool<SigBit> &get_full_case_bits(SnippetSwCache &swcache, RTLIL::SwitchRul
 	return swcache.full_case_bits_cache.at(sw);
 }
 
-RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, SnippetSwCache &swcache, dict<RTLIL::SwitchRule*, bool> &swpara,
-		RTLIL::CaseRule *cs, const RTLIL::SigSpec &sig, const RTLIL::SigSpec &defval, bool ifxmode)
+// Per-process analysis results for proc_mux. Everything in here is derived
+// from the process tree alone (the compare patterns and attributes are never
+// modified during lowering and the action bits of distinct snippets are
+// disjoint), so ProcMuxPass can prepare all selected processes on a thread
+// pool and keep only the wire- and cell-creating commit phase serial.
+struct ProcMuxPrep
 {
-	RTLIL::SigSpec result = defval;
-
-	for (auto &action : cs->actions) {
-		sig.replace(action.first, action.second, &result);
-		action.first.remove2(sig, &action.second);
-	}
+	SigSnippets sigsnip;
+	SnippetSwCache swcache;
+	dict<RTLIL::SwitchRule*, std::vector<int>> pgroups;
 
-	for (auto sw : cs->switches)
+	// detect groups of parallel cases
+	void prepare_switch(RTLIL::SwitchRule *sw, bool ifxmode)
 	{
-		if (!swcache.check(sw))
-			continue;
+		std::vector<int> &groups = pgroups[sw];
+		groups.assign(sw->cases.size(), 0);
 
-		// detect groups of parallel cases
-		std::vector<int> pgroups(sw->cases.size());
 		bool is_simple_parallel_case = true;
 
 		if (!sw->get_bool_attribute(ID::parallel_case)) {
-			if (!swpara.count(sw)) {
-				pool<Const> case_values;
-				for (size_t i = 0; i < sw->cases.size(); i++) {
-					RTLIL::CaseRule *cs2 = sw->cases[i];
-					for (auto pat : cs2->compare) {
-						if (!pat.is_fully_def())
-							goto not_simple_parallel_case;
-						Const cpat = pat.as_const();
-						if (case_values.count(cpat))
-							goto not_simple_parallel_case;
-						case_values.insert(cpat);
-					}
+			pool<Const> case_values;
+			for (size_t i = 0; i < sw->cases.size(); i++) {
+				RTLIL::CaseRule *cs2 = sw->cases[i];
+				for (auto pat : cs2->compare) {
+					if (!pat.is_fully_def())
+						goto not_simple_parallel_case;
+					Const cpat = pat.as_const();
+					if (case_values.count(cpat))
+						goto not_simple_parallel_case;
+					case_values.insert(cpat);
 				}
-				if (0)
-			not_simple_parallel_case:
-					is_simple_parallel_case = false;
-				swpara[sw] = is_simple_parallel_case;
-			} else {
-				is_simple_parallel_case = swpara.at(sw);
 			}
+			if (0)
+		not_simple_parallel_case:
+				is_simple_parallel_case = false;
 		}
 
 		if (!is_simple_parallel_case) {
@@ -366,17 +362,17 @@ RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, SnippetSwCache &swcache, d
 			for (size_t i = 0; i < sw->cases.size(); i++) {
 				RTLIL::CaseRule *cs2 = sw->cases[i];
 				if (i != 0) {
-					pgroups[i] = pgroups[i-1];
+					groups[i] = groups[i-1];
 					if (extra_group_for_next_case) {
-						pgroups[i] = pgroups[i-1]+1;
+						groups[i] = groups[i-1]+1;
 						extra_group_for_next_case = false;
 					}
 					for (auto pat : cs2->compare)
 						if (!pat.is_fully_const() || !pool.has_all(pat))
-							pgroups[i] = pgroups[i-1]+1;
+							groups[i] = groups[i-1]+1;
 					if (cs2->compare.empty())
-						pgroups[i] = pgroups[i-1]+1;
-					if (pgroups[i] != pgroups[i-1])
+						groups[i] = groups[i-1]+1;
+					if (groups[i] != groups[i-1])
 						pool = BitPatternPool(sw->signal.size());
 				}
 				for (auto pat : cs2->compare)
@@ -387,8 +383,46 @@ RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, SnippetSwCache &swcache, d
 			}
 		}
 
+		get_full_case_bits(swcache, sw);
+	}
+
+	void prepare_case(RTLIL::CaseRule *cs, bool ifxmode)
+	{
+		for (auto sw : cs->switches) {
+			prepare_switch(sw, ifxmode);
+			for (auto cs2 : sw->cases)
+				prepare_case(cs2, ifxmode);
+		}
+	}
+
+	void prepare(RTLIL::Process *proc, bool ifxmode)
+	{
+		sigsnip.insert(&proc->root_case);
+		swcache.snippets = &sigsnip;
+		swcache.insert(&proc->root_case);
+		prepare_case(&proc->root_case, ifxmode);
+	}
+};
+
+RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, ProcMuxPrep &prep,
+		RTLIL::CaseRule *cs, const RTLIL::SigSpec &sig, const RTLIL::SigSpec &defval, bool ifxmode)
+{
+	RTLIL::SigSpec result = defval;
+
+	for (auto &action : cs->actions) {
+		sig.replace(action.first, action.second, &result);
+		action.first.remove2(sig, &action.second);
+	}
+
+	for (auto sw : cs->switches)
+	{
+		if (!prep.swcache.check(sw))
+			continue;
+
+		const std::vector<int> &pgroups = prep.pgroups.at(sw);
+
 		// mask default bits that are irrelevant because the output is driven by a full case
-		const pool<SigBit> &full_case_bits = get_full_case_bits(swcache, sw);
+		const pool<SigBit> &full_case_bits = get_full_case_bits(prep.swcache, sw);
 		for (int i = 0; i < GetSize(sig); i++)
 			if (full_case_bits.count(sig[i]))
 				result[i] = State::Sx;
@@ -399,7 +433,7 @@ RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, SnippetSwCache &swcache, d
 		for (size_t i = 0; i < sw->cases.size(); i++) {
 			int case_idx = sw->cases.size() - i - 1;
 			RTLIL::CaseRule *cs2 = sw->cases[case_idx];
-			RTLIL::SigSpec value = signal_to_mux_tree(mod, swcache, swpara, cs2, sig, initial_val, ifxmode);
+			RTLIL::SigSpec value = signal_to_mux_tree(mod, prep, cs2, sig, initial_val, ifxmode);
 			if (last_mux_cell && pgroups[case_idx] == pgroups[case_idx+1])
 				append_pmux(mod, sw->signal, cs2->compare, value, last_mux_cell, sw, cs2, ifxmode);
 			else
@@ -410,28 +444,19 @@ RTLIL::SigSpec signal_to_mux_tree(RTLIL::Module *mod, SnippetSwCache &swcache, d
 	return result;
 }
 
-void proc_mux(RTLIL::Module *mod, RTLIL::Process *proc, bool ifxmode)
+void proc_mux(RTLIL::Module *mod, RTLIL::Process *proc, ProcMuxPrep &prep, bool ifxmode)
 {
 	log("Creating decoders for process `%s.%s'.\n", mod->name.c_str(), proc->name.c_str());
 
-	SigSnippets sigsnip;
-	sigsnip.insert(&proc->root_case);
-
-	SnippetSwCache swcache;
-	swcache.snippets = &sigsnip;
-	swcache.insert(&proc->root_case);
-
-	dict<RTLIL::SwitchRule*, bool> swpara;
-
 	int cnt = 0;
-	for (int idx : sigsnip.snippets)
+	for (int idx : prep.sigsnip.snippets)
 	{
-		swcache.current_snippet = idx;
-		RTLIL::SigSpec sig = sigsnip.sigidx[idx];
+		prep.swcache.current_snippet = idx;
+		RTLIL::SigSpec sig = prep.sigsnip.sigidx[idx];
 
-		log("%6d/%d: %s\n", ++cnt, GetSize(sigsnip.snippets), log_signal(sig));
+		log("%6d/%d: %s\n", ++cnt, GetSize(prep.sigsnip.snippets), log_signal(sig));
 
-		RTLIL::SigSpec value = signal_to_mux_tree(mod, swcache, swpara, &proc->root_case, sig, RTLIL::SigSpec(RTLIL::State::Sx, sig.size()), ifxmode);
+		RTLIL::SigSpec value = signal_to_mux_tree(mod, prep, &proc->root_case, sig, RTLIL::SigSpec(RTLIL::State::Sx, sig.size()), ifxmode);
 		mod->connect(RTLIL::SigSig(sig, value));
 	}
 }
@@ -468,11 +493,32 @@ struct ProcMuxPass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
+		int num_threads = ThreadPool::thread_count(design);
+
 		for (auto mod : design->modules())
-			if (design->selected(mod))
-				for (auto &proc_it : mod->processes)
-					if (design->selected(mod, proc_it.second))
-						proc_mux(mod, proc_it.second, ifxmode);
+		{
+			if (!design->selected(mod))
+				continue;
+
+			std::vector<RTLIL::Process*> procs;
+			for (auto &proc_it : mod->processes)
+				if (design->selected(mod, proc_it.second))
+					procs.push_back(proc_it.second);
+
+			if (procs.empty())
+				continue;
+
+			// The analysis phase only reads the process trees, so it can run
+			// for all processes in parallel. Creating the decoder wires and
+			// cells stays on the main thread.
+			std::vector<ProcMuxPrep> preps(GetSize(procs));
+			ThreadPool::run(num_threads, GetSize(procs), [&](int i) {
+				preps[i].prepare(procs[i], ifxmode);
+			});
+
+			for (int i = 0; i < GetSize(procs); i++)
+				proc_mux(mod, procs[i], preps[i], ifxmode);
+		}
 	}
 } ProcMuxPass;
 
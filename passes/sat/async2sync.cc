@@ -66,12 +66,26 @@ struct Async2syncPass : public Pass {
 
 		for (auto module : design->selected_modules())
 		{
+			// Take the cell snapshot first and use it for a cheap pre-scan, so
+			// modules without anything to convert don't pay for the SigMap and
+			// FfInitVals construction.
+			vector<Cell*> cells = module->selected_cells();
+
+			bool has_work = false;
+			for (auto cell : cells)
+				if (cell->type.in(ID($print), ID($check)) || RTLIL::builtin_ff_cell_types().count(cell->type)) {
+					has_work = true;
+					break;
+				}
+			if (!has_work)
+				continue;
+
 			SigMap sigmap(module);
 			FfInitVals initvals(&sigmap, module);
 
 			SigBit initstate;
 
-			for (auto cell : vector<Cell*>(module->selected_cells()))
+			for (auto cell : cells)
 			{
 				if (cell->type.in(ID($print), ID($check)))
 				{
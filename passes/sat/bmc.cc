@@ -0,0 +1,237 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/sigtools.h"
+#include "kernel/satgen.h"
+#include "kernel/threadpool.h"
+#include "kernel/log.h"
+
+#include <atomic>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct BmcDepthResult
+{
+	bool checked = false;
+	bool violated = false;
+	std::string unsupported_cell_type;
+};
+
+// One worker thread with its own solver. Depths are claimed from a shared
+// counter, so each worker sees a monotonically increasing sequence of depths
+// and only ever extends its incremental SAT problem; asserts of timesteps
+// that have been passed are assumed permanently, the violation at the depth
+// under test is a per-solve assumption.
+//
+// Workers only read the design and report through the results vector; all
+// logging happens on the main thread after the pool has joined.
+struct BmcWorker
+{
+	RTLIL::Module *module;
+	int maxdepth;
+	std::atomic<int> &next_depth;
+	std::atomic<int> &min_failed_depth;
+	std::vector<BmcDepthResult> &results;
+
+	void run()
+	{
+		ezSatPtr ez;
+		SigMap sigmap(module);
+		SatGen satgen(ez.get(), &sigmap);
+
+		int imported_depth = 0;
+		int asserts_assumed_upto = 0;
+
+		while (1)
+		{
+			int depth = next_depth.fetch_add(1, std::memory_order_relaxed);
+			if (depth > maxdepth || depth > min_failed_depth.load(std::memory_order_relaxed))
+				return;
+
+			while (imported_depth < depth)
+			{
+				int timestep = ++imported_depth;
+
+				for (auto cell : module->cells())
+					if (!satgen.importCell(cell, timestep)) {
+						results[depth-1].unsupported_cell_type = cell->type.str();
+						min_failed_depth.store(0, std::memory_order_relaxed);
+						return;
+					}
+
+				if (timestep == 1) {
+					satgen.setInitState(1);
+
+					RTLIL::SigSpec big_lhs, big_rhs;
+					for (auto wire : module->wires())
+					{
+						if (wire->attributes.count(ID::init) == 0)
+							continue;
+						RTLIL::SigSpec lhs = sigmap(wire);
+						RTLIL::Const rhs = wire->attributes.at(ID::init);
+						for (int i = 0; i < GetSize(lhs) && i < GetSize(rhs); i++)
+							if (rhs[i] == RTLIL::State::S0 || rhs[i] == RTLIL::State::S1) {
+								big_lhs.append(lhs[i]);
+								big_rhs.append(rhs[i]);
+							}
+					}
+					if (GetSize(big_lhs) != 0)
+						ez->assume(satgen.signals_eq(big_lhs, big_rhs, 1));
+				}
+
+				ez->assume(satgen.importAssumes(timestep));
+			}
+
+			while (asserts_assumed_upto < depth-1)
+				ez->assume(satgen.importAsserts(++asserts_assumed_upto));
+
+			std::vector<int> modelExpressions;
+			std::vector<bool> modelValues;
+			bool violated = ez->solve(modelExpressions, modelValues, ez->NOT(satgen.importAsserts(depth)));
+
+			results[depth-1].checked = true;
+			results[depth-1].violated = violated;
+
+			if (violated) {
+				int current = min_failed_depth.load(std::memory_order_relaxed);
+				while (depth < current && !min_failed_depth.compare_exchange_weak(current, depth)) { }
+			}
+		}
+	}
+};
+
+struct BmcPass : public Pass {
+	BmcPass() : Pass("bmc", "bounded model check using multiple solver threads") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    bmc [options] [selection]\n");
+		log("\n");
+		log("Perform a bounded model check on the selected module: prove that no $assert\n");
+		log("cell can be violated within the given number of timesteps, assuming all\n");
+		log("$assume cells hold and asserts hold in all earlier timesteps.\n");
+		log("\n");
+		log("The timesteps are distributed over worker threads (see the \"threads\"\n");
+		log("scratchpad variable and the YOSYS_THREADS environment variable); each worker\n");
+		log("keeps one incremental SAT problem and only ever extends it, so claiming the\n");
+		log("next depth reuses all clauses learned for the shallower ones.\n");
+		log("\n");
+		log("This pass reports the shallowest failing depth; use \"sat -seq <depth>\n");
+		log("-prove-asserts -show-all\" to obtain a counterexample trace for it.\n");
+		log("\n");
+		log("    -depth <N>\n");
+		log("        check up to <N> timesteps (default: 20)\n");
+		log("\n");
+		log("    -verify\n");
+		log("        return an error if an assert can be violated\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		int maxdepth = 20;
+		bool verify = false;
+
+		log_header(design, "Executing BMC pass (parallel bounded model check).\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-depth" && argidx+1 < args.size()) {
+				maxdepth = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-verify") {
+				verify = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		RTLIL::Module *module = nullptr;
+		for (auto mod : design->selected_modules()) {
+			if (module)
+				log_cmd_error("Only one module must be selected for the BMC pass! (selected: %s and %s)\n", log_id(module), log_id(mod));
+			module = mod;
+		}
+		if (module == nullptr)
+			log_cmd_error("Can't perform BMC on an empty selection!\n");
+
+		if (!module->processes.empty())
+			log_cmd_error("BMC currently can't handle processes. Run 'proc' first.\n");
+
+		if (maxdepth < 1)
+			log_cmd_error("Invalid -depth value.\n");
+
+		int num_asserts = 0;
+		for (auto cell : module->cells())
+			if (cell->type == ID($assert))
+				num_asserts++;
+		if (num_asserts == 0) {
+			log_warning("No $assert cells found in module %s, nothing to prove.\n", log_id(module));
+			return;
+		}
+
+		log("Checking %d assert statement(s) in module %s up to depth %d.\n",
+				num_asserts, log_id(module), maxdepth);
+
+		std::atomic<int> next_depth(1);
+		std::atomic<int> min_failed_depth(maxdepth+1);
+		std::vector<BmcDepthResult> results(maxdepth);
+
+		int num_threads = min(ThreadPool::thread_count(design), maxdepth);
+		ThreadPool::run(num_threads, num_threads, [&](int) {
+			BmcWorker worker{module, maxdepth, next_depth, min_failed_depth, results};
+			worker.run();
+		});
+
+		int failed_depth = 0;
+		for (int depth = 1; depth <= maxdepth; depth++)
+		{
+			BmcDepthResult &result = results[depth-1];
+
+			if (!result.unsupported_cell_type.empty())
+				log_error("Failed to import cell of type %s to SAT database.\n", result.unsupported_cell_type.c_str());
+
+			if (!result.checked)
+				continue;
+
+			if (result.violated) {
+				failed_depth = depth;
+				break;
+			}
+
+			log("Depth %d: proven.\n", depth);
+		}
+
+		design->scratchpad_set_int("bmc.failed_depth", failed_depth);
+
+		if (failed_depth > 0) {
+			log("Assert violated at depth %d!\n", failed_depth);
+			if (verify)
+				log_error("Called with -verify and proof did fail!\n");
+		} else
+			log("No assert violation found up to depth %d.\n", maxdepth);
+	}
+} BmcPass;
+
+PRIVATE_NAMESPACE_END
@@ -154,6 +154,21 @@ struct Clk2fflogicPass : public Pass {
 
 		for (auto module : design->selected_modules())
 		{
+			// Take the cell snapshot first and use it for a cheap pre-scan, so
+			// modules without anything to convert don't pay for the SigMap and
+			// FfInitVals construction.
+			vector<Cell*> cells = module->selected_cells();
+
+			bool has_work = !module->memories.empty();
+			for (auto cell : cells) {
+				if (has_work)
+					break;
+				if (cell->type.in(ID($print), ID($check), ID($mem), ID($mem_v2)) || RTLIL::builtin_ff_cell_types().count(cell->type))
+					has_work = true;
+			}
+			if (!has_work)
+				continue;
+
 			SigMap sigmap(module);
 			FfInitVals initvals(&sigmap, module);
 
@@ -216,7 +231,7 @@ struct Clk2fflogicPass : public Pass {
 
 			SigBit initstate;
 
-			for (auto cell : vector<Cell*>(module->selected_cells()))
+			for (auto cell : cells)
 			{
 				if (cell->type.in(ID($print), ID($check)))
 				{
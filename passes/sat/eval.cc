@@ -357,6 +357,396 @@ struct VlogHammerReporter
 	}
 };
 
+
+// Evaluates 64 table rows at once, one uint64_t lane per signal bit
+// ("bit-parallel" simulation over the cell graph). Only the common
+// combinational cell types are handled; prepare() returns false when the
+// cone contains anything else and the caller falls back to the
+// one-row-at-a-time ConstEval path.
+struct BitParallelEvaluator
+{
+	RTLIL::Module *module;
+	SigMap sigmap;
+	dict<RTLIL::SigBit, RTLIL::Cell*> bit_driver;
+	std::vector<RTLIL::Cell*> eval_order;
+	dict<RTLIL::SigBit, uint64_t> lanes;
+	pool<RTLIL::SigBit> input_bits;
+
+	BitParallelEvaluator(RTLIL::Module *module) : module(module), sigmap(module)
+	{
+		for (auto cell : module->cells())
+		for (auto &conn : cell->connections())
+			if (yosys_celltypes.cell_output(cell->type, conn.first))
+				for (auto bit : sigmap(conn.second))
+					if (bit.wire != nullptr)
+						bit_driver[bit] = cell;
+	}
+
+	bool supported(RTLIL::Cell *cell)
+	{
+		return cell->type.in(ID($not), ID($pos), ID($neg), ID($and), ID($or), ID($xor), ID($xnor),
+				ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor), ID($reduce_bool),
+				ID($logic_not), ID($logic_and), ID($logic_or),
+				ID($eq), ID($ne), ID($eqx), ID($nex), ID($lt), ID($le), ID($ge), ID($gt),
+				ID($add), ID($sub), ID($mux), ID($pmux), ID($lut),
+				ID($shl), ID($shr), ID($sshl), ID($sshr),
+				ID($_BUF_), ID($_NOT_), ID($_AND_), ID($_NAND_), ID($_OR_), ID($_NOR_),
+				ID($_XOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_), ID($_MUX_), ID($_NMUX_),
+				ID($_AOI3_), ID($_OAI3_), ID($_AOI4_), ID($_OAI4_));
+	}
+
+	bool visit(RTLIL::Cell *cell, pool<RTLIL::Cell*> &done, pool<RTLIL::Cell*> &path)
+	{
+		if (done.count(cell))
+			return true;
+		if (path.count(cell) || !supported(cell))
+			return false;
+		path.insert(cell);
+		for (auto &conn : cell->connections())
+			if (yosys_celltypes.cell_input(cell->type, conn.first))
+				for (auto bit : sigmap(conn.second)) {
+					if (bit.wire == nullptr) {
+						if (bit.data != RTLIL::State::S0 && bit.data != RTLIL::State::S1)
+							return false;
+						continue;
+					}
+					if (input_bits.count(bit))
+						continue;
+					auto it = bit_driver.find(bit);
+					if (it == bit_driver.end() || !visit(it->second, done, path))
+						return false;
+				}
+		path.erase(cell);
+		done.insert(cell);
+		eval_order.push_back(cell);
+		return true;
+	}
+
+	bool prepare(RTLIL::SigSpec targets, RTLIL::SigSpec inputs, const std::vector<std::pair<RTLIL::SigSpec, RTLIL::Const>> &fixed)
+	{
+		for (auto bit : sigmap(inputs))
+			if (bit.wire != nullptr)
+				input_bits.insert(bit);
+
+		for (auto &it : fixed) {
+			RTLIL::SigSpec lhs = sigmap(it.first);
+			for (int i = 0; i < GetSize(lhs); i++) {
+				if (lhs[i].wire == nullptr)
+					continue;
+				if (it.second[i] != RTLIL::State::S0 && it.second[i] != RTLIL::State::S1)
+					return false;
+				input_bits.insert(lhs[i]);
+				lanes[lhs[i]] = it.second[i] == RTLIL::State::S1 ? ~uint64_t(0) : 0;
+			}
+		}
+
+		pool<RTLIL::Cell*> done, path;
+		for (auto bit : sigmap(targets)) {
+			if (bit.wire == nullptr) {
+				if (bit.data != RTLIL::State::S0 && bit.data != RTLIL::State::S1)
+					return false;
+				continue;
+			}
+			if (input_bits.count(bit))
+				continue;
+			auto it = bit_driver.find(bit);
+			if (it == bit_driver.end() || !visit(it->second, done, path))
+				return false;
+		}
+		return true;
+	}
+
+	void set_input_lanes(RTLIL::SigSpec inputs, uint64_t base_row)
+	{
+		static const uint64_t patterns[6] = {
+			0xaaaaaaaaaaaaaaaaull, 0xccccccccccccccccull, 0xf0f0f0f0f0f0f0f0ull,
+			0xff00ff00ff00ff00ull, 0xffff0000ffff0000ull, 0xffffffff00000000ull
+		};
+		RTLIL::SigSpec sig = sigmap(inputs);
+		for (int i = 0; i < GetSize(sig); i++) {
+			if (sig[i].wire == nullptr)
+				continue;
+			if (i < 6)
+				lanes[sig[i]] = patterns[i];
+			else
+				lanes[sig[i]] = ((base_row >> i) & 1) ? ~uint64_t(0) : 0;
+		}
+	}
+
+	uint64_t get(RTLIL::SigBit bit)
+	{
+		bit = sigmap(bit);
+		if (bit.wire == nullptr)
+			return bit.data == RTLIL::State::S1 ? ~uint64_t(0) : 0;
+		return lanes.at(bit);
+	}
+
+	std::vector<uint64_t> get_vec(const RTLIL::SigSpec &sig)
+	{
+		std::vector<uint64_t> vec;
+		for (auto bit : sig)
+			vec.push_back(get(bit));
+		return vec;
+	}
+
+	static void extend(std::vector<uint64_t> &vec, int width, bool is_signed)
+	{
+		uint64_t fill = (is_signed && !vec.empty()) ? vec.back() : 0;
+		vec.resize(width, fill);
+	}
+
+	static uint64_t reduce_or(const std::vector<uint64_t> &vec)
+	{
+		uint64_t r = 0;
+		for (uint64_t v : vec)
+			r |= v;
+		return r;
+	}
+
+	// lanewise full adder over extended operands, with optional inverted b
+	// and carry-in for subtraction; returns width+1 lanes (carry chain)
+	static std::vector<uint64_t> ripple(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b, bool subtract)
+	{
+		std::vector<uint64_t> y(a.size() + 1);
+		uint64_t carry = subtract ? ~uint64_t(0) : 0;
+		for (size_t i = 0; i < a.size(); i++) {
+			uint64_t bi = subtract ? ~b[i] : b[i];
+			y[i] = a[i] ^ bi ^ carry;
+			carry = (a[i] & bi) | (carry & (a[i] ^ bi));
+		}
+		y[a.size()] = carry;
+		return y;
+	}
+
+	void run()
+	{
+		for (auto cell : eval_order)
+			eval_cell(cell);
+	}
+
+	void set_result(RTLIL::Cell *cell, const std::vector<uint64_t> &vec)
+	{
+		RTLIL::SigSpec sig = sigmap(cell->getPort(ID::Y));
+		for (int i = 0; i < GetSize(sig); i++)
+			if (sig[i].wire != nullptr)
+				lanes[sig[i]] = i < GetSize(vec) ? vec[i] : 0;
+	}
+
+	void eval_cell(RTLIL::Cell *cell)
+	{
+		if (cell->type.in(ID($not), ID($pos), ID($neg), ID($and), ID($or), ID($xor), ID($xnor),
+				ID($add), ID($sub)))
+		{
+			int width = GetSize(cell->getPort(ID::Y));
+			bool a_signed = cell->getParam(ID::A_SIGNED).as_bool();
+			auto a = get_vec(cell->getPort(ID::A));
+			extend(a, width, a_signed);
+			std::vector<uint64_t> y(width);
+
+			if (cell->type == ID($not)) {
+				for (int i = 0; i < width; i++)
+					y[i] = ~a[i];
+			} else if (cell->type == ID($pos)) {
+				y = a;
+			} else if (cell->type == ID($neg)) {
+				auto sum = ripple(std::vector<uint64_t>(width, 0), a, true);
+				sum.resize(width);
+				y = sum;
+			} else {
+				auto b = get_vec(cell->getPort(ID::B));
+				extend(b, width, cell->getParam(ID::B_SIGNED).as_bool());
+				if (cell->type == ID($and))
+					for (int i = 0; i < width; i++) y[i] = a[i] & b[i];
+				else if (cell->type == ID($or))
+					for (int i = 0; i < width; i++) y[i] = a[i] | b[i];
+				else if (cell->type == ID($xor))
+					for (int i = 0; i < width; i++) y[i] = a[i] ^ b[i];
+				else if (cell->type == ID($xnor))
+					for (int i = 0; i < width; i++) y[i] = ~(a[i] ^ b[i]);
+				else {
+					auto sum = ripple(a, b, cell->type == ID($sub));
+					sum.resize(width);
+					y = sum;
+				}
+			}
+			set_result(cell, y);
+			return;
+		}
+
+		if (cell->type.in(ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor), ID($reduce_bool),
+				ID($logic_not)))
+		{
+			auto a = get_vec(cell->getPort(ID::A));
+			uint64_t r;
+			if (cell->type == ID($reduce_and)) {
+				r = ~uint64_t(0);
+				for (uint64_t v : a)
+					r &= v;
+			} else if (cell->type.in(ID($reduce_xor), ID($reduce_xnor))) {
+				r = 0;
+				for (uint64_t v : a)
+					r ^= v;
+				if (cell->type == ID($reduce_xnor))
+					r = ~r;
+			} else {
+				r = reduce_or(a);
+				if (cell->type == ID($logic_not))
+					r = ~r;
+			}
+			set_result(cell, {r});
+			return;
+		}
+
+		if (cell->type.in(ID($logic_and), ID($logic_or)))
+		{
+			uint64_t a = reduce_or(get_vec(cell->getPort(ID::A)));
+			uint64_t b = reduce_or(get_vec(cell->getPort(ID::B)));
+			set_result(cell, {cell->type == ID($logic_and) ? (a & b) : (a | b)});
+			return;
+		}
+
+		if (cell->type.in(ID($eq), ID($ne), ID($eqx), ID($nex), ID($lt), ID($le), ID($ge), ID($gt)))
+		{
+			bool is_signed = cell->getParam(ID::A_SIGNED).as_bool() && cell->getParam(ID::B_SIGNED).as_bool();
+			auto a = get_vec(cell->getPort(ID::A));
+			auto b = get_vec(cell->getPort(ID::B));
+			int width = max(GetSize(a), GetSize(b));
+			extend(a, width, is_signed);
+			extend(b, width, is_signed);
+
+			uint64_t ne = 0;
+			for (int i = 0; i < width; i++)
+				ne |= a[i] ^ b[i];
+
+			uint64_t r;
+			if (cell->type.in(ID($eq), ID($eqx)))
+				r = ~ne;
+			else if (cell->type.in(ID($ne), ID($nex)))
+				r = ne;
+			else {
+				extend(a, width+1, is_signed);
+				extend(b, width+1, is_signed);
+				uint64_t lt = ripple(a, b, true).at(width);
+				if (cell->type == ID($lt))
+					r = lt;
+				else if (cell->type == ID($le))
+					r = lt | ~ne;
+				else if (cell->type == ID($ge))
+					r = ~lt;
+				else
+					r = ~lt & ne;
+			}
+			set_result(cell, {r});
+			return;
+		}
+
+		if (cell->type.in(ID($mux), ID($pmux)))
+		{
+			int width = GetSize(cell->getPort(ID::Y));
+			auto y = get_vec(cell->getPort(ID::A));
+			auto b = get_vec(cell->getPort(ID::B));
+			auto s = get_vec(cell->getPort(ID::S));
+			for (int k = 0; k < GetSize(s); k++)
+				for (int i = 0; i < width; i++)
+					y[i] = (y[i] & ~s[k]) | (b[k*width + i] & s[k]);
+			set_result(cell, y);
+			return;
+		}
+
+		if (cell->type == ID($lut))
+		{
+			auto a = get_vec(cell->getPort(ID::A));
+			RTLIL::Const lut = cell->getParam(ID::LUT);
+			std::function<uint64_t(int, int)> eval_lut = [&](int offset, int level) -> uint64_t {
+				if (level == 0)
+					return offset < GetSize(lut) && lut[offset] == RTLIL::State::S1 ? ~uint64_t(0) : 0;
+				uint64_t s = a[level-1];
+				uint64_t lo = eval_lut(offset, level-1);
+				uint64_t hi = eval_lut(offset + (1 << (level-1)), level-1);
+				return (lo & ~s) | (hi & s);
+			};
+			set_result(cell, {eval_lut(0, GetSize(a))});
+			return;
+		}
+
+		if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr)))
+		{
+			int width = GetSize(cell->getPort(ID::Y));
+			bool a_signed = cell->getParam(ID::A_SIGNED).as_bool();
+			bool left = cell->type.in(ID($shl), ID($sshl));
+			auto a = get_vec(cell->getPort(ID::A));
+			extend(a, width, a_signed);
+			auto b = get_vec(cell->getPort(ID::B));
+
+			uint64_t fill = (cell->type == ID($sshr) && a_signed) ? a.back() : 0;
+			std::vector<uint64_t> cur = a;
+			uint64_t overshoot = 0;
+			for (int k = 0; k < GetSize(b); k++) {
+				if (k >= 30 || (1 << k) >= width) {
+					overshoot |= b[k];
+					continue;
+				}
+				int amount = 1 << k;
+				uint64_t s = b[k];
+				std::vector<uint64_t> shifted(width);
+				for (int i = 0; i < width; i++) {
+					int src = left ? i - amount : i + amount;
+					shifted[i] = (src >= 0 && src < width) ? cur[src] : (left ? 0 : fill);
+				}
+				for (int i = 0; i < width; i++)
+					cur[i] = (cur[i] & ~s) | (shifted[i] & s);
+			}
+			for (int i = 0; i < width; i++)
+				cur[i] = (cur[i] & ~overshoot) | ((left ? 0 : fill) & overshoot);
+			set_result(cell, cur);
+			return;
+		}
+
+		// single-bit gate-level cells
+		uint64_t a = 0, b = 0, c = 0, d = 0;
+		if (cell->hasPort(ID::A)) a = get(cell->getPort(ID::A)[0]);
+		if (cell->hasPort(ID::B)) b = get(cell->getPort(ID::B)[0]);
+		if (cell->hasPort(ID::C)) c = get(cell->getPort(ID::C)[0]);
+		if (cell->hasPort(ID::D)) d = get(cell->getPort(ID::D)[0]);
+
+		uint64_t r;
+		if (cell->type == ID($_BUF_)) r = a;
+		else if (cell->type == ID($_NOT_)) r = ~a;
+		else if (cell->type == ID($_AND_)) r = a & b;
+		else if (cell->type == ID($_NAND_)) r = ~(a & b);
+		else if (cell->type == ID($_OR_)) r = a | b;
+		else if (cell->type == ID($_NOR_)) r = ~(a | b);
+		else if (cell->type == ID($_XOR_)) r = a ^ b;
+		else if (cell->type == ID($_XNOR_)) r = ~(a ^ b);
+		else if (cell->type == ID($_ANDNOT_)) r = a & ~b;
+		else if (cell->type == ID($_ORNOT_)) r = a | ~b;
+		else if (cell->type == ID($_MUX_)) {
+			uint64_t s = get(cell->getPort(ID::S)[0]);
+			r = (a & ~s) | (b & s);
+		} else if (cell->type == ID($_NMUX_)) {
+			uint64_t s = get(cell->getPort(ID::S)[0]);
+			r = ~((a & ~s) | (b & s));
+		}
+		else if (cell->type == ID($_AOI3_)) r = ~((a & b) | c);
+		else if (cell->type == ID($_OAI3_)) r = ~((a | b) & c);
+		else if (cell->type == ID($_AOI4_)) r = ~((a & b) | (c & d));
+		else if (cell->type == ID($_OAI4_)) r = ~((a | b) & (c | d));
+		else log_abort();
+
+		set_result(cell, {r});
+	}
+
+	RTLIL::Const get_row(RTLIL::SigSpec sig, int row)
+	{
+		RTLIL::Const value(0, GetSize(sig));
+		sig = sigmap(sig);
+		for (int i = 0; i < GetSize(sig); i++)
+			if ((get(sig[i]) >> row) & 1)
+				value.bits()[i] = RTLIL::State::S1;
+		return value;
+	}
+};
+
 struct EvalPass : public Pass {
 	EvalPass() : Pass("eval", "evaluate the circuit given an input") { }
 	void help() override
@@ -450,6 +840,7 @@ struct EvalPass : public Pass {
 			log_cmd_error("Can't perform EVAL on an empty selection!\n");
 
 		ConstEval ce(module);
+		std::vector<std::pair<RTLIL::SigSpec, RTLIL::Const>> set_list;
 
 		for (auto &it : sets) {
 			RTLIL::SigSpec lhs, rhs;
@@ -463,6 +854,7 @@ struct EvalPass : public Pass {
 				log_cmd_error("Set expression with different lhs and rhs sizes: %s (%s, %d bits) vs. %s (%s, %d bits)\n",
 						it.first.c_str(), log_signal(lhs), lhs.size(), it.second.c_str(), log_signal(rhs), rhs.size());
 			ce.set(lhs, rhs.as_const());
+			set_list.push_back(std::make_pair(lhs, rhs.as_const()));
 		}
 
 		if (shows.size() == 0) {
@@ -523,7 +915,48 @@ struct EvalPass : public Pass {
 			tab_line.clear();
 
 			RTLIL::Const tabvals(0, tabsigs.size());
-			do
+
+			// Try the bit-parallel batch engine first: it evaluates 64 table
+			// rows per pass over the cone. When the cone contains cell types
+			// it does not handle (or undef values are involved) the one-row-
+			// at-a-time ConstEval loop below takes over.
+			BitParallelEvaluator bpe(module);
+			bool batched = !set_undef && GetSize(tabsigs) > 0 && GetSize(tabsigs) < 63 &&
+					bpe.prepare(signal, tabsigs, set_list);
+
+			if (batched)
+			{
+				uint64_t num_rows = uint64_t(1) << GetSize(tabsigs);
+				for (uint64_t base = 0; base < num_rows; base += 64)
+				{
+					bpe.set_input_lanes(tabsigs, base);
+					bpe.run();
+
+					int rows = int(min(num_rows - base, uint64_t(64)));
+					for (int row = 0; row < rows; row++)
+					{
+						RTLIL::Const rowvals(0, GetSize(tabsigs));
+						for (int i = 0; i < GetSize(tabsigs); i++)
+							if (((base + row) >> i) & 1)
+								rowvals.bits()[i] = RTLIL::State::S1;
+						RTLIL::Const rowout = bpe.get_row(signal, row);
+
+						int pos = 0;
+						for (auto &c : tabsigs.chunks()) {
+							tab_line.push_back(log_signal(RTLIL::SigSpec(rowvals).extract(pos, c.width), false));
+							pos += c.width;
+						}
+						pos = 0;
+						for (auto &c : signal.chunks()) {
+							tab_line.push_back(log_signal(RTLIL::SigSpec(rowout).extract(pos, c.width), false));
+							pos += c.width;
+						}
+						tab.push_back(tab_line);
+						tab_line.clear();
+					}
+				}
+			}
+			else do
 			{
 				ce.push();
 				ce.set(tabsigs, tabvals);
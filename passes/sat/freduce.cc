@@ -33,7 +33,7 @@ USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 bool inv_mode;
-int verbose_level, reduce_counter, reduce_stop_at;
+int verbose_level, reduce_counter, reduce_stop_at, sim_count;
 typedef std::map<RTLIL::SigBit, std::pair<RTLIL::Cell*, std::set<RTLIL::SigBit>>> drivers_t;
 std::string dump_prefix;
 
@@ -598,6 +598,90 @@ struct FreduceWorker
 		return find_bit_in_cone(celldone, needle, haystack);
 	}
 
+	// Random-simulation prefilter: evaluate all candidate bits under sim_count
+	// random input patterns and split each bucket into classes with matching
+	// simulation signatures before handing them to the SAT engine. Two bits
+	// that differ in defined values under some pattern can never end up in the
+	// same equivalence group, so this only removes work from the SAT phase.
+	void simulation_prefilter(std::vector<std::pair<int, std::vector<RTLIL::SigBit>>> &groups)
+	{
+		pool<RTLIL::SigBit> pi_bits;
+		for (auto &it : drivers)
+			for (auto &bit : it.second.second)
+				if (bit.wire != NULL && drivers.count(bit) == 0)
+					pi_bits.insert(bit);
+		for (auto &grp : groups)
+			for (auto &bit : grp.second)
+				if (drivers.count(bit) == 0)
+					pi_bits.insert(bit);
+
+		dict<RTLIL::SigBit, std::string> signatures;
+		uint32_t rng = 123456789;
+
+		ConstEval ce(module);
+		for (int i = 0; i < sim_count; i++)
+		{
+			ce.push();
+			for (auto &bit : pi_bits) {
+				rng ^= rng << 13, rng ^= rng >> 17, rng ^= rng << 5;
+				ce.set(bit, (rng & 1) ? RTLIL::State::S1 : RTLIL::State::S0);
+			}
+			for (auto &grp : groups) {
+				if (grp.first == 0)
+					continue;
+				for (auto &bit : grp.second) {
+					RTLIL::SigSpec sig = bit, undef;
+					char value = 'x';
+					if (ce.eval(sig, undef) && sig.is_fully_def())
+						value = sig.as_bool() ? '1' : '0';
+					signatures[bit] += value;
+				}
+			}
+			ce.pop();
+		}
+
+		std::vector<std::pair<int, std::vector<RTLIL::SigBit>>> new_groups;
+		int undef_groups = 0;
+
+		for (auto &grp : groups)
+		{
+			if (grp.first == 0) {
+				new_groups.push_back(grp);
+				continue;
+			}
+
+			bool found_undef = false;
+			for (auto &bit : grp.second)
+				if (signatures.at(bit).find('x') != std::string::npos)
+					found_undef = true;
+
+			// a sometimes-undef signal may still be covered by any of the
+			// other signals, so such buckets are left for SAT to shatter
+			if (found_undef) {
+				new_groups.push_back(grp);
+				undef_groups++;
+				continue;
+			}
+
+			dict<std::string, std::vector<RTLIL::SigBit>> classes;
+			for (auto &bit : grp.second) {
+				std::string signature = signatures.at(bit);
+				if (inv_mode && signature[0] == '1')
+					for (auto &c : signature)
+						c = c == '1' ? '0' : '1';
+				classes[signature].push_back(bit);
+			}
+
+			for (auto &cls : classes)
+				if (cls.second.size() > 1)
+					new_groups.push_back(std::pair<int, std::vector<RTLIL::SigBit>>(grp.first, cls.second));
+		}
+
+		log("  Simulated %d random patterns: split %d buckets into %d classes%s.\n", sim_count, int(groups.size()),
+				int(new_groups.size()), undef_groups ? stringf(" (%d kept due to undef values)", undef_groups).c_str() : "");
+		groups.swap(new_groups);
+	}
+
 	void dump()
 	{
 		std::string filename = stringf("%s_%s_%05d.il", dump_prefix.c_str(), RTLIL::id2cstr(module->name), reduce_counter);
@@ -666,24 +750,29 @@ struct FreduceWorker
 		}
 		log("  Sorted %d signal bits into %d buckets.\n", bits_count, int(buckets.size()));
 
-		int bucket_count = 0;
-		std::vector<std::vector<equiv_bit_t>> equiv;
+		std::vector<std::pair<int, std::vector<RTLIL::SigBit>>> groups;
 		for (auto &bucket : buckets)
-		{
-			bucket_count++;
+			if (bucket.second.size() > 1)
+				groups.push_back(std::pair<int, std::vector<RTLIL::SigBit>>(bucket.first.size(), bucket.second));
 
-			if (bucket.second.size() == 1)
-				continue;
+		if (sim_count > 0)
+			simulation_prefilter(groups);
+
+		int group_count = 0;
+		std::vector<std::vector<equiv_bit_t>> equiv;
+		for (auto &grp : groups)
+		{
+			group_count++;
 
-			if (bucket.first.size() == 0) {
-				log("  Finding const values for bucket %s%c\n", log_signal(bucket.second), verbose_level ? ':' : '.');
-				PerformReduction worker(sigmap, drivers, inv_pairs, bucket.second, bucket.first.size());
-				for (size_t idx = 0; idx < bucket.second.size(); idx++)
+			if (grp.first == 0) {
+				log("  Finding const values for bucket %s%c\n", log_signal(grp.second), verbose_level ? ':' : '.');
+				PerformReduction worker(sigmap, drivers, inv_pairs, grp.second, grp.first);
+				for (size_t idx = 0; idx < grp.second.size(); idx++)
 					worker.analyze_const(equiv, idx);
 			} else {
-				log("  Trying to shatter bucket %s%c\n", log_signal(bucket.second), verbose_level ? ':' : '.');
-				PerformReduction worker(sigmap, drivers, inv_pairs, bucket.second, bucket.first.size());
-				worker.analyze(equiv, 100 * bucket_count / (buckets.size() + 1));
+				log("  Trying to shatter bucket %s%c\n", log_signal(grp.second), verbose_level ? ':' : '.');
+				PerformReduction worker(sigmap, drivers, inv_pairs, grp.second, grp.first);
+				worker.analyze(equiv, 100 * group_count / (groups.size() + 1));
 			}
 		}
 
@@ -777,6 +866,11 @@ struct FreducePass : public Pass {
 		log("    -inv\n");
 		log("        enable explicit handling of inverted signals\n");
 		log("\n");
+		log("    -simcount <n>\n");
+		log("        number of random simulation patterns used to split the equivalence\n");
+		log("        buckets before SAT-proving them (default: 64). Use 0 to disable the\n");
+		log("        simulation prefilter.\n");
+		log("\n");
 		log("    -stop <n>\n");
 		log("        stop after <n> reduction operations. this is mostly used for\n");
 		log("        debugging the freduce command itself.\n");
@@ -798,6 +892,7 @@ struct FreducePass : public Pass {
 		reduce_stop_at = 0;
 		verbose_level = 0;
 		inv_mode = false;
+		sim_count = 64;
 		dump_prefix = std::string();
 
 		log_header(design, "Executing FREDUCE pass (perform functional reduction).\n");
@@ -816,6 +911,10 @@ struct FreducePass : public Pass {
 				inv_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-simcount" && argidx+1 < args.size()) {
+				sim_count = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-stop" && argidx+1 < args.size()) {
 				reduce_stop_at = atoi(args[++argidx].c_str());
 				continue;
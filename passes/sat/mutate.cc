@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -430,10 +431,34 @@ void mutate_list(Design *design, const mutate_opts_t &opts, const string &filena
 	std::vector<mutate_t> database;
 	xs128_t rng(opts.seed);
 
-	for (auto module : design->selected_modules())
-	{
+	std::vector<Module*> scan_modules;
+	for (auto module : design->selected_modules()) {
 		if (!opts.module.empty() && module->name != opts.module)
 			continue;
+		scan_modules.push_back(module);
+	}
+
+	struct module_scan_t {
+		std::vector<mutate_t> database;
+		pool<string> sources;
+	};
+	std::vector<module_scan_t> scans(scan_modules.size());
+
+	// Enumerate candidates one module per work item; workers only read the
+	// design and fill their own scan slot, merging happens below in module
+	// order. Each module draws its ctrl bits from an rng seeded with -seed
+	// and the module name, so the output is deterministic and independent of
+	// the thread count.
+	int num_threads = ThreadPool::thread_count(design);
+	ThreadPool::run(num_threads, GetSize(scan_modules), [&](int idx)
+	{
+		Module *module = scan_modules[idx];
+		module_scan_t &scan = scans[idx];
+
+		uint32_t module_seed = opts.seed;
+		for (char c : module->name.str())
+			module_seed = module_seed * 33 + (unsigned char) c;
+		xs128_t rng(module_seed);
 
 		SigMap sigmap(module);
 		dict<SigBit, int> bit_user_cnt;
@@ -501,29 +526,34 @@ void mutate_list(Design *design, const mutate_opts_t &opts, const string &filena
 					}
 
 					if (!srcsfile.empty())
-						sources.insert(entry.src.begin(), entry.src.end());
+						scan.sources.insert(entry.src.begin(), entry.src.end());
 
 					entry.mode = "inv";
-					database_add(database, opts, entry);
+					database_add(scan.database, opts, entry);
 
 					entry.mode = "const0";
-					database_add(database, opts, entry);
+					database_add(scan.database, opts, entry);
 
 					entry.mode = "const1";
-					database_add(database, opts, entry);
+					database_add(scan.database, opts, entry);
 
 					entry.mode = "cnot0";
 					entry.ctrlbit = rng(GetSize(conn.second));
 					if (entry.ctrlbit != entry.portbit && conn.second[entry.ctrlbit].wire)
-						database_add(database, opts, entry);
+						database_add(scan.database, opts, entry);
 
 					entry.mode = "cnot1";
 					entry.ctrlbit = rng(GetSize(conn.second));
 					if (entry.ctrlbit != entry.portbit && conn.second[entry.ctrlbit].wire)
-						database_add(database, opts, entry);
+						database_add(scan.database, opts, entry);
 				}
 			}
 		}
+	});
+
+	for (auto &scan : scans) {
+		database.insert(database.end(), scan.database.begin(), scan.database.end());
+		sources.insert(scan.sources.begin(), scan.sources.end());
 	}
 
 	log("Raw database size: %d\n", GetSize(database));
@@ -83,7 +83,6 @@ struct RecoverModuleWorker {
     Module *mod, *flat = nullptr;
     RecoverModuleWorker(Module *mod) : design(mod->design), mod(mod) {};
 
-    ConstEval *ce = nullptr;
     SigMap *sigmap = nullptr;
 
     dict<IdBit, SigBit> flat2orig;
@@ -97,7 +96,6 @@ struct RecoverModuleWorker {
         flat = design->addModule(NEW_ID);
         mod->cloneInto(flat);
         Pass::call_on_module(design, flat, "flatten -wb");
-        ce = new ConstEval(flat);
         sigmap = new SigMap(flat);
         // Create a mapping from primary name-bit in the box-flattened module to original sigbit
         SigMap orig_sigmap(mod);
@@ -154,30 +152,180 @@ struct RecoverModuleWorker {
 
     // Mapping from bit to (candidate) equivalence classes
     dict<IdBit, equiv_cls_t> bit2cls;
-    void sim_cycle(int t, const dict<IdBit, RTLIL::State> &anchors)
+
+    bool sig_of_bit(const dict<SigBit, equiv_cls_t> &sig, SigBit bit, equiv_cls_t &word)
     {
-        ce->clear();
-        for (auto anchor : anchors) {
-            SigBit bit = (*sigmap)(SigBit(flat->wire(anchor.first.name), anchor.first.bit));
-            // Ignore in the rare case that it's already determined
-            SigSpec res(bit);
-            if (ce->eval(res))
-                continue;
-            ce->set(bit, anchor.second);
+        if (!bit.wire) {
+            if (bit.data == State::S0) { word = 0; return true; }
+            if (bit.data == State::S1) { word = ~equiv_cls_t(0); return true; }
+            return false;
         }
-        // Only evaluate IdBits that exist in the non-flat design; as they are all we care about
-        for (auto idbit : flat2orig) {
-            if (anchors.count(idbit.first))
+        auto it = sig.find(bit);
+        if (it == sig.end())
+            return false;
+        word = it->second;
+        return true;
+    }
+
+    // Bit-parallel evaluation of one cell: all sim_length patterns of an
+    // output bit are computed at once as one signature word. Single-bit gate
+    // primitives evaluate as a couple of word operations; everything else
+    // evaluable falls back to one CellTypes::eval() call per pattern lane.
+    // Bits with any unknown pattern are left without a signature, which only
+    // costs candidates - the SAT proof stage decides what is really equal.
+    void simulate_cell(Cell *cell, dict<SigBit, equiv_cls_t> &sig, const pool<SigBit> &anchored)
+    {
+        if (!yosys_celltypes.cell_evaluable(cell->type))
+            return;
+
+        auto fetch = [&](IdString port, std::vector<equiv_cls_t> &words) -> bool {
+            words.clear();
+            if (!cell->hasPort(port))
+                return true;
+            for (auto bit : (*sigmap)(cell->getPort(port))) {
+                equiv_cls_t word;
+                if (!sig_of_bit(sig, bit, word))
+                    return false;
+                words.push_back(word);
+            }
+            return true;
+        };
+
+        std::vector<equiv_cls_t> a, b, c, d, s;
+        if (!fetch(ID::A, a) || !fetch(ID::B, b) || !fetch(ID::S, s))
+            return;
+        if (cell->type.in(ID($_AOI3_), ID($_OAI3_), ID($_AOI4_), ID($_OAI4_)) && !fetch(ID::C, c))
+            return;
+        if (cell->type.in(ID($_AOI4_), ID($_OAI4_)) && !fetch(ID::D, d))
+            return;
+
+        if (!cell->hasPort(ID::Y))
+            return;
+        SigSpec outsig = (*sigmap)(cell->getPort(ID::Y));
+
+        auto commit = [&](int i, equiv_cls_t word) {
+            SigBit bit = outsig[i];
+            if (bit.wire && !anchored.count(bit))
+                sig[bit] = word;
+        };
+
+        // word-parallel fast path for the single-bit gate library
+        bool have_word = true;
+        equiv_cls_t yw = 0;
+        if (cell->type == ID($_BUF_)) yw = a[0];
+        else if (cell->type == ID($_NOT_)) yw = ~a[0];
+        else if (cell->type == ID($_AND_)) yw = a[0] & b[0];
+        else if (cell->type == ID($_NAND_)) yw = ~(a[0] & b[0]);
+        else if (cell->type == ID($_OR_)) yw = a[0] | b[0];
+        else if (cell->type == ID($_NOR_)) yw = ~(a[0] | b[0]);
+        else if (cell->type == ID($_XOR_)) yw = a[0] ^ b[0];
+        else if (cell->type == ID($_XNOR_)) yw = ~(a[0] ^ b[0]);
+        else if (cell->type == ID($_ANDNOT_)) yw = a[0] & ~b[0];
+        else if (cell->type == ID($_ORNOT_)) yw = a[0] | ~b[0];
+        else if (cell->type == ID($_MUX_)) yw = (a[0] & ~s[0]) | (b[0] & s[0]);
+        else if (cell->type == ID($_NMUX_)) yw = ~((a[0] & ~s[0]) | (b[0] & s[0]));
+        else if (cell->type == ID($_AOI3_)) yw = ~((a[0] & b[0]) | c[0]);
+        else if (cell->type == ID($_OAI3_)) yw = ~((a[0] | b[0]) & c[0]);
+        else if (cell->type == ID($_AOI4_)) yw = ~((a[0] & b[0]) | (c[0] & d[0]));
+        else if (cell->type == ID($_OAI4_)) yw = ~((a[0] | b[0]) & (c[0] | d[0]));
+        else have_word = false;
+
+        if (have_word) {
+            commit(0, yw);
+            return;
+        }
+
+        auto lane_const = [](const std::vector<equiv_cls_t> &words, int lane) {
+            Const val(State::S0, GetSize(words));
+            for (int i = 0; i < GetSize(words); i++)
+                if ((words[i] >> lane) & 1)
+                    val.bits()[i] = State::S1;
+            return val;
+        };
+
+        std::vector<equiv_cls_t> y_words(GetSize(outsig), 0), y_known(GetSize(outsig), 0);
+        for (int lane = 0; lane < sim_length; lane++) {
+            bool err = false;
+            Const y_val;
+            if (cell->type.in(ID($bmux), ID($demux)))
+                y_val = CellTypes::eval(cell, lane_const(a, lane), lane_const(s, lane), &err);
+            else if (!s.empty())
+                y_val = CellTypes::eval(cell, lane_const(a, lane), lane_const(b, lane), lane_const(s, lane), &err);
+            else if (!d.empty())
+                y_val = CellTypes::eval(cell, lane_const(a, lane), lane_const(b, lane), lane_const(c, lane), lane_const(d, lane), &err);
+            else if (!c.empty())
+                y_val = CellTypes::eval(cell, lane_const(a, lane), lane_const(b, lane), lane_const(c, lane), &err);
+            else
+                y_val = CellTypes::eval(cell, lane_const(a, lane), lane_const(b, lane), &err);
+            if (err)
+                return;
+            for (int i = 0; i < min(GetSize(outsig), GetSize(y_val)); i++) {
+                if (y_val[i] == State::S0)
+                    y_known[i] |= equiv_cls_t(1) << lane;
+                else if (y_val[i] == State::S1) {
+                    y_known[i] |= equiv_cls_t(1) << lane;
+                    y_words[i] |= equiv_cls_t(1) << lane;
+                }
+            }
+        }
+        for (int i = 0; i < GetSize(outsig); i++)
+            if (y_known[i] == ~equiv_cls_t(0))
+                commit(i, y_words[i]);
+    }
+
+    // Run all sim_length random patterns at once in a single topological
+    // sweep over the cells, instead of one full ConstEval pass per pattern
+    void compute_signatures(const dict<IdBit, equiv_cls_t> &anchor_sigs)
+    {
+        dict<SigBit, equiv_cls_t> sig;
+        pool<SigBit> anchored;
+
+        for (auto &it : anchor_sigs) {
+            SigBit bit = (*sigmap)(SigBit(flat->wire(it.first.name), it.first.bit));
+            if (!bit.wire)
                 continue;
-            SigBit bit = (*sigmap)(SigBit(flat->wire(idbit.first.name), idbit.first.bit));
-            SigSpec res(bit);
-            if (!ce->eval(res))
+            sig[bit] = it.second;
+            anchored.insert(bit);
+        }
+
+        // topological cell order, breaking edges at anchors as in compute_depths()
+        dict<SigBit, pool<IdString>> bit_drivers, bit_users;
+        TopoSort<IdString, RTLIL::sort_by_id_str> toposort;
+
+        for (auto cell : flat->cells())
+        {
+            for (auto conn : cell->connections())
+                for (auto bit : (*sigmap)(conn.second)) {
+                    if (!bit.wire || anchored.count(bit))
+                        continue;
+                    if (cell->input(conn.first))
+                        bit_users[bit].insert(cell->name);
+                    if (cell->output(conn.first))
+                        bit_drivers[bit].insert(cell->name);
+                }
+            toposort.node(cell->name);
+        }
+
+        for (auto &it : bit_users)
+            if (bit_drivers.count(it.first))
+                for (auto driver_cell : bit_drivers.at(it.first))
+                for (auto user_cell : it.second)
+                    toposort.edge(driver_cell, user_cell);
+
+        toposort.sort();
+        for (auto cell_name : toposort.sorted)
+            simulate_cell(flat->cell(cell_name), sig, anchored);
+
+        // Only signatures of IdBits that exist in the non-flat design matter
+        for (auto &it : flat2orig) {
+            if (anchor_sigs.count(it.first))
                 continue;
-            if (res != State::S0 && res != State::S1)
+            SigBit bit = (*sigmap)(SigBit(flat->wire(it.first.name), it.first.bit));
+            equiv_cls_t word;
+            if (!sig_of_bit(sig, bit, word))
                 continue;
-            // Update equivalence classes
-            if (res == State::S1)
-                bit2cls[idbit.first] = bit2cls[idbit.first] | (equiv_cls_t(1) << t);
+            if (word != 0)
+                bit2cls[it.first] = word;
         }
     }
 
@@ -436,7 +584,6 @@ struct RecoverModuleWorker {
 
     ~RecoverModuleWorker()
     {
-        delete ce;
         delete sigmap;
         if (flat)
             design->remove(flat);
@@ -585,17 +732,24 @@ struct RecoverNamesWorker {
                 gate_anchors[gate_bit] = gold_bit.first;
             }
         }
-        // Run a random-value combinational simulation to find candidate equivalence classes
-        dict<IdBit, RTLIL::State> gold_anchor_vals, gate_anchor_vals;
+        // Run a random-value combinational simulation to find candidate equivalence
+        // classes; all patterns are packed into one signature word per bit
+        dict<IdBit, equiv_cls_t> gold_anchor_sigs, gate_anchor_sigs;
         rng_init();
+        for (auto anchor : gold_anchors) {
+            gold_anchor_sigs[anchor.first] = 0;
+            gate_anchor_sigs[anchor.second] = 0;
+        }
         for (int t = 0; t < sim_length; t++) {
             for (auto anchor : gold_anchors) {
-                gold_anchor_vals[anchor.first] = next_randbit();
-                gate_anchor_vals[anchor.second] = gold_anchor_vals[anchor.first];
+                if (next_randbit() == RTLIL::State::S1) {
+                    gold_anchor_sigs[anchor.first] |= equiv_cls_t(1) << t;
+                    gate_anchor_sigs[anchor.second] |= equiv_cls_t(1) << t;
+                }
             }
-            gold_worker.sim_cycle(t, gold_anchor_vals);
-            gate_worker.sim_cycle(t, gate_anchor_vals);
         }
+        gold_worker.compute_signatures(gold_anchor_sigs);
+        gate_worker.compute_signatures(gate_anchor_sigs);
         log_debug("%d candidate equiv classes in gold; %d in gate\n", GetSize(gold_worker.bit2cls), GetSize(gate_worker.bit2cls));
         // Group bits by equivalence classes together
         dict<equiv_cls_t, std::pair<pool<IdBit>, pool<InvBit>>> cls2bits;
@@ -62,7 +62,7 @@ struct SatHelper
 	std::vector<std::string> shows;
 	SigPool show_signal_pool;
 	SigSet<RTLIL::Cell*> show_drivers;
-	int max_timestep, timeout;
+	int max_timestep, timeout, threads;
 	bool gotTimeout;
 
 	SatHelper(RTLIL::Design *design, RTLIL::Module *module, bool enable_undef, bool set_def_formal) :
@@ -77,6 +77,7 @@ struct SatHelper
 		ignore_unknown_cells = false;
 		max_timestep = -1;
 		timeout = 0;
+		threads = 1;
 		gotTimeout = false;
 	}
 
@@ -445,6 +446,7 @@ struct SatHelper
 	{
 		log_assert(gotTimeout == false);
 		ez->setSolverTimeout(timeout);
+		ez->solverThreads = threads;
 		bool success = ez->solve(modelExpressions, modelValues, assumptions);
 		if (ez->getSolverTimoutStatus())
 			gotTimeout = true;
@@ -455,6 +457,7 @@ struct SatHelper
 	{
 		log_assert(gotTimeout == false);
 		ez->setSolverTimeout(timeout);
+		ez->solverThreads = threads;
 		bool success = ez->solve(modelExpressions, modelValues, a, b, c, d, e, f);
 		if (ez->getSolverTimoutStatus())
 			gotTimeout = true;
@@ -1059,6 +1062,11 @@ struct SatPass : public Pass {
 		log("    -timeout <N>\n");
 		log("        Maximum number of seconds a single SAT instance may take.\n");
 		log("\n");
+		log("    -threads <N>\n");
+		log("        Run <N> diversified solver instances in parallel for each SAT query\n");
+		log("        and use the result of whichever instance finishes first. This also\n");
+		log("        applies to the per-timestep queries in -tempinduct mode.\n");
+		log("\n");
 		log("    -verify\n");
 		log("        Return an error and stop the synthesis script if the proof fails.\n");
 		log("\n");
@@ -1078,7 +1086,7 @@ struct SatPass : public Pass {
 		std::map<int, std::vector<std::pair<std::string, std::string>>> sets_at;
 		std::map<int, std::vector<std::string>> unsets_at, sets_def_at, sets_any_undef_at, sets_all_undef_at;
 		std::vector<std::string> shows, sets_def, sets_any_undef, sets_all_undef;
-		int loopcount = 0, seq_len = 0, maxsteps = 0, initsteps = 0, timeout = 0, prove_skip = 0;
+		int loopcount = 0, seq_len = 0, maxsteps = 0, initsteps = 0, timeout = 0, threads = 1, prove_skip = 0;
 		bool verify = false, fail_on_timeout = false, enable_undef = false, set_def_inputs = false, set_def_formal = false;
 		bool ignore_div_by_zero = false, set_init_undef = false, set_init_zero = false, max_undef = false;
 		bool tempinduct = false, prove_asserts = false, show_inputs = false, show_outputs = false;
@@ -1118,6 +1126,10 @@ struct SatPass : public Pass {
 				timeout = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-threads" && argidx+1 < args.size()) {
+				threads = max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
 			if (args[argidx] == "-max" && argidx+1 < args.size()) {
 				loopcount = atoi(args[++argidx].c_str());
 				continue;
@@ -1408,6 +1420,7 @@ struct SatPass : public Pass {
 			basecase.unsets_at = unsets_at;
 			basecase.shows = shows;
 			basecase.timeout = timeout;
+			basecase.threads = threads;
 			basecase.sets_def = sets_def;
 			basecase.sets_any_undef = sets_any_undef;
 			basecase.sets_all_undef = sets_all_undef;
@@ -1432,6 +1445,7 @@ struct SatPass : public Pass {
 			inductstep.prove_asserts = prove_asserts;
 			inductstep.shows = shows;
 			inductstep.timeout = timeout;
+			inductstep.threads = threads;
 			inductstep.sets_def = sets_def;
 			inductstep.sets_any_undef = sets_any_undef;
 			inductstep.sets_all_undef = sets_all_undef;
@@ -1597,6 +1611,7 @@ struct SatPass : public Pass {
 			sathelper.unsets_at = unsets_at;
 			sathelper.shows = shows;
 			sathelper.timeout = timeout;
+			sathelper.threads = threads;
 			sathelper.sets_def = sets_def;
 			sathelper.sets_any_undef = sets_any_undef;
 			sathelper.sets_all_undef = sets_all_undef;
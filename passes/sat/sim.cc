@@ -26,6 +26,10 @@
 #include "kernel/yw.h"
 #include "kernel/json.h"
 #include "kernel/fmt.h"
+#include "kernel/utils.h"
+#include "kernel/threadpool.h"
+#include "kernel/toporder.h"
+#include "kernel/threadpool.h"
 
 #include <ctime>
 
@@ -125,6 +129,7 @@ struct SimShared
 	bool serious_asserts = false;
 	bool fst_noinit = false;
 	bool initstate = true;
+	int threads = 1;
 };
 
 void zinit(State &v)
@@ -151,7 +156,11 @@ struct SimInstance
 	dict<Cell*, SimInstance*> children;
 
 	SigMap sigmap;
-	dict<SigBit, State> state_nets;
+	// Net state lives in a flat array indexed by dense bit ids, so the
+	// get_state()/set_state() inner loops are array accesses instead of a
+	// hash probe per bit. Bits without an id read as Sz.
+	SigBitIndex bit_index;
+	std::vector<State> state_nets;
 	dict<SigBit, pool<Cell*>> upd_cells;
 	dict<SigBit, pool<Wire*>> upd_outports;
 
@@ -163,6 +172,10 @@ struct SimInstance
 	pool<IdString> dirty_memories;
 	pool<SimInstance*> dirty_children;
 
+	// topological rank of each combinational cell, used by
+	// update_queued_cells() to evaluate dirty cells in levelized order
+	dict<Cell*, int> cell_rank;
+
 	struct ff_state_t
 	{
 		Const past_d;
@@ -250,8 +263,9 @@ struct SimInstance
 			SigSpec sig = sigmap(wire);
 
 			for (int i = 0; i < GetSize(sig); i++) {
-				if (state_nets.count(sig[i]) == 0)
-					state_nets[sig[i]] = State::Sx;
+				bit_index(sig[i]);
+				if (bit_index.size() > GetSize(state_nets))
+					state_nets.resize(bit_index.size(), State::Sx);
 				if (wire->port_output) {
 					upd_outports[sig[i]].insert(wire);
 					dirty_bits.insert(sig[i]);
@@ -269,7 +283,7 @@ struct SimInstance
 				Const initval = wire->attributes.at(ID::init);
 				for (int i = 0; i < GetSize(sig) && i < GetSize(initval); i++)
 					if (initval[i] == State::S0 || initval[i] == State::S1) {
-						state_nets[sig[i]] = initval[i];
+						state_nets[bit_index(sig[i])] = initval[i];
 						dirty_bits.insert(sig[i]);
 					}
 			}
@@ -358,6 +372,8 @@ struct SimInstance
 
 		std::sort(print_database.begin(), print_database.end());
 
+		levelize();
+
 		if (shared->zinit)
 		{
 			for (auto &it : ff_database)
@@ -422,12 +438,15 @@ struct SimInstance
 		Const value;
 
 		for (auto bit : sigmap(sig))
-			if (bit.wire == nullptr)
+			if (bit.wire == nullptr) {
 				value.bits().push_back(bit.data);
-			else if (state_nets.count(bit))
-				value.bits().push_back(state_nets.at(bit));
-			else
-				value.bits().push_back(State::Sz);
+			} else {
+				int id = bit_index.lookup(bit);
+				if (id >= 0 && id < GetSize(state_nets))
+					value.bits().push_back(state_nets[id]);
+				else
+					value.bits().push_back(State::Sz);
+			}
 
 		if (shared->debug)
 			log("[%s] get %s: %s\n", hiername().c_str(), log_signal(sig), log_signal(value));
@@ -441,12 +460,17 @@ struct SimInstance
 		sig = sigmap(sig);
 		log_assert(GetSize(sig) <= GetSize(value));
 
-		for (int i = 0; i < GetSize(sig); i++)
-			if (value[i] != State::Sa && state_nets.at(sig[i]) != value[i]) {
-				state_nets.at(sig[i]) = value[i];
+		for (int i = 0; i < GetSize(sig); i++) {
+			if (value[i] == State::Sa)
+				continue;
+			int id = bit_index.lookup(sig[i]);
+			log_assert(id >= 0 && id < GetSize(state_nets));
+			if (state_nets[id] != value[i]) {
+				state_nets[id] = value[i];
 				dirty_bits.insert(sig[i]);
 				did_something = true;
 			}
+		}
 
 		if (shared->debug)
 			log("[%s] set %s: %s\n", hiername().c_str(), log_signal(sig), log_signal(value));
@@ -505,6 +529,121 @@ struct SimInstance
 		}
 	}
 
+	bool is_comb_cell(Cell *cell) const
+	{
+		return ff_database.count(cell) == 0 && formal_database.count(cell) == 0 &&
+				mem_cells.count(cell) == 0 && children.count(cell) == 0 &&
+				yosys_celltypes.cell_evaluable(cell->type);
+	}
+
+	void levelize()
+	{
+		// Repeated sim invocations on an unchanged module reuse the cached
+		// ranks instead of re-running the toposort.
+		if (auto cached = TopoOrderCache::lookup(module, "sim")) {
+			for (auto &it : cached->ranks)
+				if (Cell *cell = module->cell(it.first))
+					cell_rank[cell] = it.second;
+			return;
+		}
+
+		TopoSort<Cell*, IdString::compare_ptr_by_name<Cell>> toposort;
+		toposort.analyze_loops = false;
+
+		for (auto cell : module->cells())
+			if (is_comb_cell(cell))
+				toposort.node(cell);
+
+		for (auto cell : module->cells()) {
+			if (!is_comb_cell(cell))
+				continue;
+			for (auto &conn : cell->connections()) {
+				if (!cell->output(conn.first))
+					continue;
+				for (auto bit : sigmap(conn.second)) {
+					auto it = upd_cells.find(bit);
+					if (it == upd_cells.end())
+						continue;
+					for (auto reader : it->second)
+						if (reader != cell && toposort.has_node(reader))
+							toposort.edge(cell, reader);
+				}
+			}
+		}
+
+		toposort.sort();
+
+		// cells on combinational loops get the rank they are first reached
+		// with; the fixed point iteration in update_ph1() still converges on
+		// them as before
+		auto database = toposort.get_database();
+		for (auto cell : toposort.sorted) {
+			int rank = 0;
+			for (auto dep : database.at(cell)) {
+				auto it = cell_rank.find(dep);
+				if (it != cell_rank.end())
+					rank = max(rank, it->second + 1);
+			}
+			cell_rank[cell] = rank;
+		}
+
+		TopoOrderInfo info;
+		for (auto cell : toposort.sorted)
+			info.order.push_back(cell->name);
+		for (auto &it : cell_rank)
+			info.ranks.emplace(it.first->name, it.second);
+		TopoOrderCache::store(module, "sim", std::move(info));
+	}
+
+	// Compute the new output value of a simple evaluable cell without
+	// touching any simulation state, so that cells of the same rank can be
+	// evaluated on worker threads. Returns false for cells that need the
+	// generic update_cell() path.
+	bool eval_cell_value(Cell *cell, SigSpec &sig_y, Const &value)
+	{
+		RTLIL::SigSpec sig_a, sig_b, sig_c, sig_s;
+		bool has_a, has_b, has_c, has_d, has_s, has_y;
+
+		has_a = cell->hasPort(ID::A);
+		has_b = cell->hasPort(ID::B);
+		has_c = cell->hasPort(ID::C);
+		has_d = cell->hasPort(ID::D);
+		has_s = cell->hasPort(ID::S);
+		has_y = cell->hasPort(ID::Y);
+
+		if (has_a) sig_a = cell->getPort(ID::A);
+		if (has_b) sig_b = cell->getPort(ID::B);
+		if (has_c) sig_c = cell->getPort(ID::C);
+		if (has_s) sig_s = cell->getPort(ID::S);
+		if (has_y) sig_y = cell->getPort(ID::Y);
+
+		// Simple (A -> Y) and (A,B -> Y) cells
+		if (has_a && !has_c && !has_d && !has_s && has_y) {
+			value = CellTypes::eval(cell, get_state(sig_a), get_state(sig_b));
+			return true;
+		}
+
+		// (A,B,C -> Y) cells
+		if (has_a && has_b && has_c && !has_d && !has_s && has_y) {
+			value = CellTypes::eval(cell, get_state(sig_a), get_state(sig_b), get_state(sig_c));
+			return true;
+		}
+
+		// (A,S -> Y) cells
+		if (has_a && !has_b && !has_c && !has_d && has_s && has_y) {
+			value = CellTypes::eval(cell, get_state(sig_a), get_state(sig_s));
+			return true;
+		}
+
+		// (A,B,S -> Y) cells
+		if (has_a && has_b && !has_c && !has_d && has_s && has_y) {
+			value = CellTypes::eval(cell, get_state(sig_a), get_state(sig_b), get_state(sig_s));
+			return true;
+		}
+
+		return false;
+	}
+
 	void update_cell(Cell *cell)
 	{
 		if (ff_database.count(cell))
@@ -533,47 +672,14 @@ struct SimInstance
 
 		if (yosys_celltypes.cell_evaluable(cell->type))
 		{
-			RTLIL::SigSpec sig_a, sig_b, sig_c, sig_d, sig_s, sig_y;
-			bool has_a, has_b, has_c, has_d, has_s, has_y;
-
-			has_a = cell->hasPort(ID::A);
-			has_b = cell->hasPort(ID::B);
-			has_c = cell->hasPort(ID::C);
-			has_d = cell->hasPort(ID::D);
-			has_s = cell->hasPort(ID::S);
-			has_y = cell->hasPort(ID::Y);
-
-			if (has_a) sig_a = cell->getPort(ID::A);
-			if (has_b) sig_b = cell->getPort(ID::B);
-			if (has_c) sig_c = cell->getPort(ID::C);
-			if (has_d) sig_d = cell->getPort(ID::D);
-			if (has_s) sig_s = cell->getPort(ID::S);
-			if (has_y) sig_y = cell->getPort(ID::Y);
+			SigSpec sig_y;
+			Const value;
 
 			if (shared->debug)
 				log("[%s] eval %s (%s)\n", hiername().c_str(), log_id(cell), log_id(cell->type));
 
-			// Simple (A -> Y) and (A,B -> Y) cells
-			if (has_a && !has_c && !has_d && !has_s && has_y) {
-				set_state(sig_y, CellTypes::eval(cell, get_state(sig_a), get_state(sig_b)));
-				return;
-			}
-
-			// (A,B,C -> Y) cells
-			if (has_a && has_b && has_c && !has_d && !has_s && has_y) {
-				set_state(sig_y, CellTypes::eval(cell, get_state(sig_a), get_state(sig_b), get_state(sig_c)));
-				return;
-			}
-
-			// (A,S -> Y) cells
-			if (has_a && !has_b && !has_c && !has_d && has_s && has_y) {
-				set_state(sig_y, CellTypes::eval(cell, get_state(sig_a), get_state(sig_s)));
-				return;
-			}
-
-			// (A,B,S -> Y) cells
-			if (has_a && has_b && !has_c && !has_d && has_s && has_y) {
-				set_state(sig_y, CellTypes::eval(cell, get_state(sig_a), get_state(sig_b), get_state(sig_s)));
+			if (eval_cell_value(cell, sig_y, value)) {
+				set_state(sig_y, value);
 				return;
 			}
 
@@ -615,6 +721,71 @@ struct SimInstance
 		}
 	}
 
+	// Evaluate the queued cells in levelized order. All cells of one
+	// topological rank are independent of each other, so with -threads the
+	// new output values of a rank are computed on worker threads; all state
+	// updates stay on the main thread.
+	void update_queued_cells(pool<Cell*> &queue_cells)
+	{
+		std::vector<std::pair<int, Cell*>> ranked;
+		ranked.reserve(queue_cells.size());
+
+		for (auto cell : queue_cells) {
+			auto it = cell_rank.find(cell);
+			if (it == cell_rank.end())
+				update_cell(cell);
+			else
+				ranked.push_back(std::pair<int, Cell*>(it->second, cell));
+		}
+
+		std::sort(ranked.begin(), ranked.end(), [](const std::pair<int, Cell*> &a, const std::pair<int, Cell*> &b) {
+			if (a.first != b.first)
+				return a.first < b.first;
+			return a.second->name < b.second->name;
+		});
+
+		if (shared->threads <= 1 || shared->debug) {
+			for (auto &it : ranked)
+				update_cell(it.second);
+			return;
+		}
+
+		std::vector<SigSpec> sigs;
+		std::vector<Const> values;
+		std::vector<char> valid;
+
+		for (int begin = 0; begin < GetSize(ranked);) {
+			int end = begin;
+			while (end < GetSize(ranked) && ranked[end].first == ranked[begin].first)
+				end++;
+
+			int num = end - begin;
+			if (num < 32) {
+				for (int i = 0; i < num; i++)
+					update_cell(ranked[begin+i].second);
+				begin = end;
+				continue;
+			}
+
+			sigs.assign(num, SigSpec());
+			values.assign(num, Const());
+			valid.assign(num, 0);
+
+			ThreadPool::run(min(shared->threads, num), num, [&](int i) {
+				valid[i] = eval_cell_value(ranked[begin+i].second, sigs[i], values[i]) ? 1 : 0;
+			});
+
+			for (int i = 0; i < num; i++) {
+				if (valid[i])
+					set_state(sigs[i], values[i]);
+				else
+					update_cell(ranked[begin+i].second);
+			}
+
+			begin = end;
+		}
+	}
+
 	void update_ph1()
 	{
 		pool<Cell*> queue_cells;
@@ -639,9 +810,7 @@ struct SimInstance
 
 			if (!queue_cells.empty())
 			{
-				for (auto cell : queue_cells)
-					update_cell(cell);
-
+				update_queued_cells(queue_cells);
 				queue_cells.clear();
 				continue;
 			}
@@ -1200,6 +1369,24 @@ struct SimInstance
 			child.second->addAdditionalInputs();
 	}
 
+	// gather all FST handles this instance (and its children) will query, so
+	// that FstData only has to decode those signals
+	void collectFstHandles(std::vector<fstHandle> &handles)
+	{
+		for (auto &item : fst_handles)
+			if (item.second != 0)
+				handles.push_back(item.second);
+		for (auto &item : fst_inputs)
+			if (item.second != 0)
+				handles.push_back(item.second);
+		for (auto &mem : fst_memories)
+			for (auto &item : mem.second)
+				if (item.second != 0)
+					handles.push_back(item.second);
+		for (auto child : children)
+			child.second->collectFstHandles(handles);
+	}
+
 	bool setInputs()
 	{
 		bool did_something = false;
@@ -1292,16 +1479,214 @@ struct SimWorker : SimShared
 	std::string summary_filename;
 	std::string scope;
 
+	// watch expression compiled against the flat net state of the top
+	// instance: per watched bit either a dense state id (>= 0) or a
+	// constant bit taken from const_bits, so the per-sample check is a
+	// plain array scan without sigmap or hash lookups
+	struct watch_t
+	{
+		std::string expr;
+		enum { WATCH_CHANGE, WATCH_EQ, WATCH_NE } mode;
+		Const value;
+		std::vector<int> state_ids;
+		Const const_bits;
+		Const current, last;
+		bool last_valid = false;
+		bool prev_cond = false;
+		int hits = 0;
+		int first_step = -1;
+	};
+
+	std::vector<std::string> watch_exprs;
+	std::vector<watch_t> watches;
+	bool stop_on_watch = false;
+	bool watch_stopped = false;
+
 	~SimWorker()
 	{
 		outputfiles.clear();
 		delete top;
 	}
 
+	static Const parse_watch_value(const std::string &str, int width)
+	{
+		size_t tick = str.find('\'');
+		std::string digits = tick != std::string::npos ? str.substr(tick+1) : str;
+		char base = 'd';
+
+		if (tick != std::string::npos) {
+			if (digits.empty())
+				log_cmd_error("Invalid watch value `%s'.\n", str.c_str());
+			base = tolower(digits[0]);
+			digits = digits.substr(1);
+		}
+
+		Const value;
+		switch (base)
+		{
+		case 'b':
+			value = Const::from_string(digits);
+			break;
+		case 'h':
+			for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+				char ch = tolower(*it);
+				int nibble;
+				if (ch >= '0' && ch <= '9')
+					nibble = ch - '0';
+				else if (ch >= 'a' && ch <= 'f')
+					nibble = ch - 'a' + 10;
+				else if (ch == 'x' || ch == 'z') {
+					for (int i = 0; i < 4; i++)
+						value.bits().push_back(ch == 'x' ? State::Sx : State::Sz);
+					continue;
+				} else
+					log_cmd_error("Invalid watch value `%s'.\n", str.c_str());
+				for (int i = 0; i < 4; i++)
+					value.bits().push_back(State(nibble >> i & 1));
+			}
+			break;
+		case 'd': {
+			char *endptr;
+			long long v = strtoll(digits.c_str(), &endptr, 10);
+			if (digits.empty() || *endptr != 0 || v < 0)
+				log_cmd_error("Invalid watch value `%s'.\n", str.c_str());
+			for (int i = 0; i < width; i++)
+				value.bits().push_back(State(v >> i & 1));
+			break;
+		}
+		default:
+			log_cmd_error("Invalid watch value `%s'.\n", str.c_str());
+		}
+
+		if (GetSize(value) > width) {
+			for (int i = width; i < GetSize(value); i++)
+				if (value[i] == State::S1)
+					log_cmd_error("Watch value `%s' does not fit in %d bits.\n", str.c_str(), width);
+			value.bits().resize(width);
+		}
+		while (GetSize(value) < width)
+			value.bits().push_back(State::S0);
+		return value;
+	}
+
+	SigSpec parse_watch_signal(const std::string &str)
+	{
+		std::string name = str;
+		int sel_left = -1, sel_right = -1;
+
+		size_t pos = str.find('[');
+		if (pos != std::string::npos) {
+			if (str.back() != ']')
+				log_cmd_error("Invalid watch signal `%s'.\n", str.c_str());
+			std::string sel = str.substr(pos+1, str.size()-pos-2);
+			name = str.substr(0, pos);
+			size_t colon = sel.find(':');
+			sel_left = atoi(sel.c_str());
+			sel_right = colon != std::string::npos ? atoi(sel.c_str()+colon+1) : sel_left;
+		}
+
+		Wire *w = top->module->wire(RTLIL::escape_id(name));
+		if (w == nullptr)
+			log_cmd_error("Can't find watch signal %s on module %s.\n", name.c_str(), log_id(top->module));
+
+		if (sel_left < 0)
+			return w;
+
+		if (sel_left < sel_right)
+			std::swap(sel_left, sel_right);
+
+		SigSpec sig;
+		for (int i = sel_right; i <= sel_left; i++) {
+			int offset = w->upto ? w->start_offset + w->width - 1 - i : i - w->start_offset;
+			if (offset < 0 || offset >= w->width)
+				log_cmd_error("Bit select [%d] is out of range for watch signal %s.\n", i, log_id(w));
+			sig.append(SigBit(w, offset));
+		}
+		return sig;
+	}
+
+	void setup_watches()
+	{
+		watches.clear();
+
+		for (auto &expr : watch_exprs)
+		{
+			watch_t watch;
+			watch.expr = expr;
+
+			std::string sig_str = expr, val_str;
+			size_t pos;
+			if ((pos = expr.find("==")) != std::string::npos) {
+				watch.mode = watch_t::WATCH_EQ;
+				sig_str = expr.substr(0, pos), val_str = expr.substr(pos+2);
+			} else if ((pos = expr.find("!=")) != std::string::npos) {
+				watch.mode = watch_t::WATCH_NE;
+				sig_str = expr.substr(0, pos), val_str = expr.substr(pos+2);
+			} else
+				watch.mode = watch_t::WATCH_CHANGE;
+
+			auto trim = [](std::string &s) {
+				size_t first = s.find_first_not_of(" \t");
+				size_t last = s.find_last_not_of(" \t");
+				s = first == std::string::npos ? "" : s.substr(first, last-first+1);
+			};
+			trim(sig_str), trim(val_str);
+
+			SigSpec sig = parse_watch_signal(sig_str);
+
+			if (watch.mode != watch_t::WATCH_CHANGE)
+				watch.value = parse_watch_value(val_str, GetSize(sig));
+
+			for (auto bit : top->sigmap(sig)) {
+				int id = bit.wire != nullptr ? top->bit_index.lookup(bit) : -1;
+				watch.state_ids.push_back(id >= 0 && id < GetSize(top->state_nets) ? id : -1);
+				watch.const_bits.bits().push_back(bit.wire == nullptr ? bit.data : State::Sz);
+			}
+			watch.current.bits().resize(GetSize(sig));
+
+			watches.push_back(std::move(watch));
+		}
+	}
+
+	void check_watches(int t)
+	{
+		for (auto &watch : watches)
+		{
+			for (int i = 0; i < GetSize(watch.state_ids); i++) {
+				int id = watch.state_ids[i];
+				watch.current.bits()[i] = id >= 0 ? top->state_nets[id] : watch.const_bits[i];
+			}
+
+			bool hit;
+			if (watch.mode == watch_t::WATCH_CHANGE) {
+				hit = watch.last_valid && !(watch.current == watch.last);
+				watch.last = watch.current;
+				watch.last_valid = true;
+			} else {
+				// trigger on the sample where the condition becomes true,
+				// not on every sample while it holds
+				bool cond = (watch.current == watch.value) == (watch.mode == watch_t::WATCH_EQ);
+				hit = cond && !watch.prev_cond;
+				watch.prev_cond = cond;
+			}
+
+			if (!hit)
+				continue;
+
+			watch.hits++;
+			if (watch.first_step < 0)
+				watch.first_step = step;
+			log("Watch `%s' triggered at time %d (%s).\n", watch.expr.c_str(), t, log_signal(watch.current));
+			if (stop_on_watch)
+				watch_stopped = true;
+		}
+	}
+
 	void register_signals()
 	{
 		next_output_id = 1;
 		top->register_signals(top->shared->next_output_id);
+		setup_watches();
 	}
 
 	void register_output_step(int t)
@@ -1309,6 +1694,8 @@ struct SimWorker : SimShared
 		std::map<int,Const> data;
 		top->register_output_step_values(&data);
 		output_data.emplace_back(t, data);
+		if (!watches.empty())
+			check_watches(t);
 	}
 
 	void write_output_files()
@@ -1431,6 +1818,9 @@ struct SimWorker : SimShared
 			update(true);
 			register_output_step(10*cycle + 5);
 
+			if (watch_stopped)
+				break;
+
 			if (cycle == 0)
 				top->set_initstate_outputs(State::S0);
 
@@ -1449,9 +1839,15 @@ struct SimWorker : SimShared
 
 			update(true);
 			register_output_step(10*cycle + 10);
+
+			if (watch_stopped)
+				break;
 		}
 
-		register_output_step(10*numcycles + 2);
+		if (watch_stopped)
+			log("Stopped simulation: watch expression triggered.\n");
+		else
+			register_output_step(10*numcycles + 2);
 
 		write_output_files();
 	}
@@ -1507,6 +1903,10 @@ struct SimWorker : SimShared
 
 		top->addAdditionalInputs();
 
+		std::vector<fstHandle> watched_signals = fst_clock;
+		top->collectFstHandles(watched_signals);
+		fst->activateSignals(watched_signals);
+
 		uint64_t startCount = 0;
 		uint64_t stopCount = 0;
 		if (start_time==0) {
@@ -1562,6 +1962,11 @@ struct SimWorker : SimShared
 					update(true);
 				register_output_step(time);
 
+				if (watch_stopped) {
+					log("Stopped co-simulation: watch expression triggered.\n");
+					throw fst_end_of_data_exception();
+				}
+
 				bool status = top->checkSignals();
 				if (status)
 					log_error("Signal difference\n");
@@ -2096,6 +2501,17 @@ struct SimWorker : SimShared
 			json.end_object();
 		}
 		json.end_array();
+		json.name("watches");
+		json.begin_array();
+		for (auto &watch : watches) {
+			json.begin_object();
+			json.entry("expr", watch.expr);
+			json.entry("hits", watch.hits);
+			if (watch.first_step >= 0)
+				json.entry("first_step", watch.first_step);
+			json.end_object();
+		}
+		json.end_array();
 		json.end_object();
 	}
 
@@ -2422,6 +2838,14 @@ struct FSTWriter : public OutputWriter
 
 		fstWriterSetPackType(fstfile, FST_WR_PT_FASTLZ);
 		fstWriterSetRepackOnClose(fstfile, 1);
+
+#if defined(__linux__) || defined(__FreeBSD__)
+		// hand value-change block compression to a writer thread; the
+		// condition must match FST_WRITER_PARALLEL in libs/fst/config.h, as
+		// enabling parallel mode on other builds terminates the process
+		if (ThreadPool::thread_count(worker->top->module->design) > 1)
+			fstWriterSetParallelMode(fstfile, 1);
+#endif
 	   
 	   	worker->top->write_output_header(
 			[this](IdString name) { fstWriterSetScope(fstfile, FST_ST_VCD_MODULE, stringf("%s",log_id(name)).c_str(), nullptr); },
@@ -2629,6 +3053,10 @@ struct SimPass : public Pass {
 		log("    -rstlen <integer>\n");
 		log("        number of cycles reset should stay active (default: 1)\n");
 		log("\n");
+		log("    -threads <integer>\n");
+		log("        evaluate combinational cells of the same topological rank on the\n");
+		log("        given number of threads (default: 1)\n");
+		log("\n");
 		log("    -zinit\n");
 		log("        zero-initialize all uninitialized regs and memories\n");
 		log("\n");
@@ -2689,6 +3117,20 @@ struct SimPass : public Pass {
 		log("        fail the simulation command if, in the course of simulating,\n");
 		log("        any of the asserts in the design fail\n");
 		log("\n");
+		log("    -watch <expr>\n");
+		log("        watch expression: <signal>, <signal> == <value> or <signal> != <value>.\n");
+		log("        <signal> is a wire of the top module with an optional bit- or part-\n");
+		log("        select, <value> is a decimal or Verilog-style 'b/'h/'d constant (x and\n");
+		log("        z bits match literally). a log message with the simulation time is\n");
+		log("        printed whenever the value changes resp. the condition becomes true.\n");
+		log("        this option can be used multiple times. triggered watches are also\n");
+		log("        listed in the -summary file.\n");
+		log("\n");
+		log("    -watchstop\n");
+		log("        stop the simulation at the first sample where a watch expression\n");
+		log("        triggers, so the waveform output ends at the point of interest\n");
+		log("        (and with -w the trigger state becomes the new init state)\n");
+		log("\n");
 		log("    -fst-noinit\n");
 		log("        do not initialize latches and memories from an input FST or VCD file\n");
 		log("        (use the initial defined by the design instead)\n");
@@ -2753,6 +3195,10 @@ struct SimPass : public Pass {
 				worker.rstlen = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-threads" && argidx+1 < args.size()) {
+				worker.threads = max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
 			if (args[argidx] == "-clock" && argidx+1 < args.size()) {
 				worker.clock.insert(RTLIL::escape_id(args[++argidx]));
 				continue;
@@ -2855,6 +3301,14 @@ struct SimPass : public Pass {
 				worker.serious_asserts = true;
 				continue;
 			}
+			if (args[argidx] == "-watch" && argidx+1 < args.size()) {
+				worker.watch_exprs.push_back(args[++argidx]);
+				continue;
+			}
+			if (args[argidx] == "-watchstop") {
+				worker.stop_on_watch = true;
+				continue;
+			}
 			if (args[argidx] == "-fst-noinit") {
 				worker.fst_noinit = true;
 				continue;
@@ -27,6 +27,11 @@
 #include "kernel/rtlil.h"
 #include "kernel/log.h"
 
+#if defined(__linux__)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
 // abc9_exe.cc
 std::string fold_abc9_cmd(std::string str);
 
@@ -413,11 +418,36 @@ struct Abc9Pass : public ScriptPass
 					tempdir_name += proc_program_prefix() + "yosys-abc-XXXXXX";
 					tempdir_name = make_temp_dir(tempdir_name);
 
+					// keep the XAIGER round trip in memory where possible: back
+					// input.xaig and output.aig by anonymous in-memory files that
+					// write_xaiger/read_aiger and the ABC process access through
+					// /dev/fd paths, so the netlist data never touches the disk
+					// (set the scratchpad bool 'abc9.nomemfd' to force temp files)
+					std::string in_xaig_file = stringf("%s/input.xaig", tempdir_name.c_str());
+					std::string out_aig_file = stringf("%s/output.aig", tempdir_name.c_str());
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+					int in_xaig_fd = -1, out_aig_fd = -1;
+					if (!active_design->scratchpad_get_bool("abc9.nomemfd")) {
+						// the fds must stay inheritable (no MFD_CLOEXEC) so the
+						// spawned ABC process can open its /dev/fd paths
+						in_xaig_fd = memfd_create("yosys-abc9-input.xaig", 0);
+						out_aig_fd = memfd_create("yosys-abc9-output.aig", 0);
+						if (in_xaig_fd >= 0 && out_aig_fd >= 0) {
+							in_xaig_file = stringf("/dev/fd/%d", in_xaig_fd);
+							out_aig_file = stringf("/dev/fd/%d", out_aig_fd);
+						} else {
+							if (in_xaig_fd >= 0) close(in_xaig_fd);
+							if (out_aig_fd >= 0) close(out_aig_fd);
+							in_xaig_fd = out_aig_fd = -1;
+						}
+					}
+#endif
+
 					if (!lut_mode)
 						run_nocheck(stringf("abc9_ops -write_lut %s/input.lut", tempdir_name.c_str()));
 					if (box_file.empty())
 						run_nocheck(stringf("abc9_ops -write_box %s/input.box", tempdir_name.c_str()));
-					run_nocheck(stringf("write_xaiger -map %s/input.sym %s %s/input.xaig", tempdir_name.c_str(), dff_mode ? "-dff" : "", tempdir_name.c_str()));
+					run_nocheck(stringf("write_xaiger -map %s/input.sym %s %s", tempdir_name.c_str(), dff_mode ? "-dff" : "", in_xaig_file.c_str()));
 
 					int num_outputs = active_design->scratchpad_get_int("write_xaiger.num_outputs");
 
@@ -430,6 +460,7 @@ struct Abc9Pass : public ScriptPass
 					if (num_outputs) {
 						std::string abc9_exe_cmd;
 						abc9_exe_cmd += stringf("%s -cwd %s", exe_cmd.str().c_str(), tempdir_name.c_str());
+						abc9_exe_cmd += stringf(" -in %s -out %s", in_xaig_file.c_str(), out_aig_file.c_str());
 						if (!lut_mode)
 							abc9_exe_cmd += stringf(" -lut %s/input.lut", tempdir_name.c_str());
 						if (box_file.empty())
@@ -437,12 +468,17 @@ struct Abc9Pass : public ScriptPass
 						else
 							abc9_exe_cmd += stringf(" -box %s", box_file.c_str());
 						run_nocheck(abc9_exe_cmd);
-						run_nocheck(stringf("read_aiger -xaiger -wideports -module_name %s$abc9 -map %s/input.sym %s/output.aig", log_id(mod), tempdir_name.c_str(), tempdir_name.c_str()));
+						run_nocheck(stringf("read_aiger -xaiger -wideports -module_name %s$abc9 -map %s/input.sym %s", log_id(mod), tempdir_name.c_str(), out_aig_file.c_str()));
 						run_nocheck(stringf("abc9_ops -reintegrate %s", dff_mode ? "-dff" : ""));
 					}
 					else
 						log("Don't call ABC as there is nothing to map.\n");
 
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+					if (in_xaig_fd >= 0) close(in_xaig_fd);
+					if (out_aig_fd >= 0) close(out_aig_fd);
+#endif
+
 					if (cleanup) {
 						log("Removing temp directory.\n");
 						remove_directory(tempdir_name);
@@ -24,6 +24,8 @@
 
 #include "kernel/register.h"
 #include "kernel/log.h"
+#include <sstream>
+#include <thread>
 
 #ifndef _WIN32
 #  include <unistd.h>
@@ -168,10 +170,16 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 		vector<int> lut_costs, bool dff_mode, std::string delay_target, std::string /*lutin_shared*/, bool fast_mode,
 		bool show_tempdir, std::string box_file, std::string lut_file,
 		std::vector<std::string> liberty_files, std::string wire_delay, std::string tempdir_name,
-		std::string constr_file, std::vector<std::string> dont_use_cells)
+		std::string constr_file, std::vector<std::string> dont_use_cells,
+		std::string in_xaig_file, std::string out_aig_file)
 {
 	std::string abc9_script;
 
+	if (in_xaig_file.empty())
+		in_xaig_file = stringf("%s/input.xaig", tempdir_name.c_str());
+	if (out_aig_file.empty())
+		out_aig_file = stringf("%s/output.aig", tempdir_name.c_str());
+
 	if (!lut_costs.empty())
 		abc9_script += stringf("read_lut %s/lutdefs.txt; ", tempdir_name.c_str());
 	else if (!lut_file.empty())
@@ -190,7 +198,7 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 
 	log_assert(!box_file.empty());
 	abc9_script += stringf("read_box \"%s\"; ", box_file.c_str());
-	abc9_script += stringf("&read %s/input.xaig; &ps; ", tempdir_name.c_str());
+	abc9_script += stringf("&read %s; &ps; ", in_xaig_file.c_str());
 
 	if (!script_file.empty()) {
 		if (script_file[0] == '+') {
@@ -234,14 +242,14 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 		for (size_t pos = abc9_script.find("&mfs"); pos != std::string::npos; pos = abc9_script.find("&mfs", pos))
 			abc9_script = abc9_script.erase(pos, strlen("&mfs"));
 	else {
-		auto s = stringf("&write -n %s/output.aig; ", tempdir_name.c_str());
+		auto s = stringf("&write -n %s; ", out_aig_file.c_str());
 		for (size_t pos = abc9_script.find("&mfs"); pos != std::string::npos; pos = abc9_script.find("&mfs", pos)) {
 			abc9_script = abc9_script.insert(pos, s);
 			pos += GetSize(s) + strlen("&mfs");
 		}
 	}
 
-	abc9_script += stringf("; &ps -l; &write -n %s/output.aig", tempdir_name.c_str());
+	abc9_script += stringf("; &ps -l; &write -n %s", out_aig_file.c_str());
 	if (design->scratchpad_get_bool("abc9.verify")) {
 		if (dff_mode)
 			abc9_script += "; &verify -s";
@@ -279,6 +287,52 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 #ifndef YOSYS_LINK_ABC
 	abc9_output_filter filt(tempdir_name, show_tempdir);
 	int ret = run_command(buffer, std::bind(&abc9_output_filter::next_line, filt, std::placeholders::_1));
+#elif !defined(_WIN32) && !defined(__wasm)
+	// capture the linked ABC's output through a pipe instead of a temp
+	// file round trip; a reader thread drains the pipe so ABC can not
+	// block on a full pipe buffer
+	fflush(stdout);
+	fflush(stderr);
+	int pipe_fds[2];
+	if (pipe(pipe_fds) != 0)
+		log_error("ABC: cannot create a pipe for output redirection\n");
+	int old_stdout = dup(fileno(stdout));
+	int old_stderr = dup(fileno(stderr));
+	dup2(pipe_fds[1], fileno(stdout));
+	dup2(pipe_fds[1], fileno(stderr));
+	close(pipe_fds[1]);
+	std::string abc_output;
+	std::thread abc_output_reader([&abc_output, &pipe_fds]() {
+		char chunk[4096];
+		ssize_t n;
+		while ((n = read(pipe_fds[0], chunk, sizeof(chunk))) > 0)
+			abc_output.append(chunk, n);
+	});
+	// These needs to be mutable, supposedly due to getopt
+	char *abc9_argv[5];
+	string tmp_script_name = stringf("%s/abc.script", tempdir_name.c_str());
+	abc9_argv[0] = strdup(exe_file.c_str());
+	abc9_argv[1] = strdup("-s");
+	abc9_argv[2] = strdup("-f");
+	abc9_argv[3] = strdup(tmp_script_name.c_str());
+	abc9_argv[4] = 0;
+	int ret = abc::Abc_RealMain(4, abc9_argv);
+	free(abc9_argv[0]);
+	free(abc9_argv[1]);
+	free(abc9_argv[2]);
+	free(abc9_argv[3]);
+	fflush(stdout);
+	fflush(stderr);
+	dup2(old_stdout, fileno(stdout));
+	dup2(old_stderr, fileno(stderr));
+	close(old_stdout);
+	close(old_stderr);
+	abc_output_reader.join();
+	close(pipe_fds[0]);
+	abc9_output_filter filt(tempdir_name, show_tempdir);
+	std::istringstream abc_output_stream(abc_output);
+	for (std::string line; std::getline(abc_output_stream, line); )
+		filt.next_line(line + "\n");
 #else
 	string temp_stdouterr_name = stringf("%s/stdouterr.txt", tempdir_name.c_str());
 	FILE *temp_stdouterr_w = fopen(temp_stdouterr_name.c_str(), "w");
@@ -324,7 +378,7 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 	temp_stdouterr_r.close();
 #endif
 	if (ret != 0) {
-		if (check_file_exists(stringf("%s/output.aig", tempdir_name.c_str())))
+		if (check_file_exists(out_aig_file))
 			log_warning("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
 		else
 			log_error("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
@@ -425,6 +479,13 @@ struct Abc9ExePass : public Pass {
 		log("        file is expected. temporary files will be created in this directory, and\n");
 		log("        the mapped result will be written to 'output.aig'.\n");
 		log("\n");
+		log("    -in <file>\n");
+		log("        read the XAIGER input from this file instead of '<cwd>/input.xaig'. this\n");
+		log("        may be a '/dev/fd/N' path so that the netlist never touches the disk.\n");
+		log("\n");
+		log("    -out <file>\n");
+		log("        write the mapped result to this file instead of '<cwd>/output.aig'.\n");
+		log("\n");
 		log("Note that this is a logic optimization pass within Yosys that is calling ABC\n");
 		log("internally. This is not going to \"run ABC on your design\". It will instead run\n");
 		log("ABC on logic snippets extracted from your design. You will not get any useful\n");
@@ -443,7 +504,7 @@ struct Abc9ExePass : public Pass {
 		std::string script_file, clk_str, box_file, lut_file, constr_file;
 		std::vector<std::string> liberty_files, dont_use_cells;
 		std::string delay_target, lutin_shared = "-S 1", wire_delay;
-		std::string tempdir_name;
+		std::string tempdir_name, in_xaig_file, out_aig_file;
 		bool fast_mode = false, dff_mode = false;
 		bool show_tempdir = false;
 		vector<int> lut_costs;
@@ -529,6 +590,14 @@ struct Abc9ExePass : public Pass {
 				tempdir_name = args[++argidx];
 				continue;
 			}
+			if (arg == "-in" && argidx+1 < args.size()) {
+				in_xaig_file = args[++argidx];
+				continue;
+			}
+			if (arg == "-out" && argidx+1 < args.size()) {
+				out_aig_file = args[++argidx];
+				continue;
+			}
 			if (arg == "-liberty" && argidx+1 < args.size()) {
 				liberty_files.push_back(args[++argidx]);
 				continue;
@@ -605,7 +674,7 @@ struct Abc9ExePass : public Pass {
 		abc9_module(design, script_file, exe_file, lut_costs, dff_mode,
 				delay_target, lutin_shared, fast_mode, show_tempdir,
 				box_file, lut_file, liberty_files, wire_delay, tempdir_name,
-				constr_file, dont_use_cells);
+				constr_file, dont_use_cells, in_xaig_file, out_aig_file);
 	}
 } Abc9ExePass;
 
@@ -20,6 +20,7 @@
 
 #include "kernel/register.h"
 #include "kernel/sigtools.h"
+#include "kernel/threadpool.h"
 #include "kernel/utils.h"
 #include "kernel/celltypes.h"
 #include "kernel/timinginfo.h"
@@ -713,6 +714,7 @@ void prep_xaiger(RTLIL::Module *module, bool dff)
 	dict<SigBit, pool<IdString>> bit_drivers, bit_users;
 	TopoSort<IdString, RTLIL::sort_by_id_str> toposort;
 	dict<IdString, std::vector<IdString>> box_ports;
+	std::vector<std::pair<Cell*, bool>> toposort_cells;
 
 	for (auto cell : module->cells()) {
 		if (cell->type.in(ID($_DFF_N_), ID($_DFF_P_)))
@@ -754,21 +756,50 @@ void prep_xaiger(RTLIL::Module *module, bool dff)
 			continue;
 
 		// TODO: Speed up toposort -- we care about box ordering only
-		for (auto conn : cell->connections()) {
-			if (cell->input(conn.first))
-				for (auto bit : sigmap(conn.second))
-					bit_users[bit].insert(cell->name);
-
-			if (cell->output(conn.first) && !abc9_flop)
-				for (auto bit : sigmap(conn.second))
-					bit_drivers[bit].insert(cell->name);
-		}
+		toposort_cells.emplace_back(cell, abc9_flop);
 		toposort.node(cell->name);
 	}
 
 	if (box_ports.empty())
 		return;
 
+	// Building the bit-level dependency graph for the toposort touches every
+	// connection bit of every known cell and dominates this prep phase on
+	// large macro-heavy modules. Shard the graph construction across worker
+	// threads (workers only read the design and fill their own shard) and
+	// merge the shards here.
+	{
+		struct GraphShard {
+			dict<SigBit, pool<IdString>> bit_drivers, bit_users;
+		};
+		int num_threads = ThreadPool::thread_count(design);
+		std::vector<GraphShard> shards(num_threads);
+		ThreadPool::run(num_threads, GetSize(shards), [&](int t) {
+			GraphShard &shard = shards[t];
+			for (int i = t; i < GetSize(toposort_cells); i += GetSize(shards)) {
+				Cell *cell = toposort_cells[i].first;
+				bool abc9_flop = toposort_cells[i].second;
+				for (auto conn : cell->connections()) {
+					if (cell->input(conn.first))
+						for (auto bit : sigmap(conn.second))
+							shard.bit_users[bit].insert(cell->name);
+
+					if (cell->output(conn.first) && !abc9_flop)
+						for (auto bit : sigmap(conn.second))
+							shard.bit_drivers[bit].insert(cell->name);
+				}
+			}
+		});
+		for (auto &shard : shards) {
+			for (auto &it : shard.bit_users)
+				for (auto name : it.second)
+					bit_users[it.first].insert(name);
+			for (auto &it : shard.bit_drivers)
+				for (auto name : it.second)
+					bit_drivers[it.first].insert(name);
+		}
+	}
+
 	for (auto &it : bit_users)
 		if (bit_drivers.count(it.first))
 			for (auto driver_cell : bit_drivers.at(it.first))
@@ -802,7 +833,14 @@ void prep_xaiger(RTLIL::Module *module, bool dff)
 	RTLIL::Module *holes_module = holes_design->addModule(module->name);
 	log_assert(holes_module);
 
-	dict<IdString, Cell*> cell_cache;
+	// Per-box-type cache: identical box types repeat thousands of times on
+	// macro-heavy designs, so the hole circuit (for whiteboxes) and the
+	// output port list are derived once per type and reused per instance.
+	struct HolesBoxType {
+		Cell *holes_cell = nullptr;
+		std::vector<std::pair<IdString, int>> outputs; // port name and width
+	};
+	dict<IdString, HolesBoxType> cell_cache;
 	TimingInfo timing;
 
 	int port_id = 1, box_count = 0;
@@ -828,60 +866,131 @@ void prep_xaiger(RTLIL::Module *module, bool dff)
 		cell->attributes[ID::abc9_box_seq] = box_count++;
 
 		auto r = cell_cache.insert(cell->type);
-		auto &holes_cell = r.first->second;
+		auto &box_type = r.first->second;
 		if (r.second) {
-			if (box_module->get_bool_attribute(ID::whitebox)) {
-				holes_cell = holes_module->addCell(NEW_ID, cell->type);
+			bool whitebox = box_module->get_bool_attribute(ID::whitebox);
+			if (whitebox) {
+				box_type.holes_cell = holes_module->addCell(NEW_ID, cell->type);
 
 				if (box_module->has_processes())
 					Pass::call_on_module(design, box_module, "proc");
+			}
 
-				int box_inputs = 0;
-				for (auto port_name : box_ports.at(cell->type)) {
-					RTLIL::Wire *w = box_module->wire(port_name);
-					log_assert(w);
-					log_assert(!w->port_input || !w->port_output);
-					auto &conn = holes_cell->connections_[port_name];
-					if (w->port_input) {
-						for (int i = 0; i < GetSize(w); i++) {
-							box_inputs++;
-							RTLIL::Wire *holes_wire = holes_module->wire(stringf("\\i%d", box_inputs));
-							if (!holes_wire) {
-								holes_wire = holes_module->addWire(stringf("\\i%d", box_inputs));
-								holes_wire->port_input = true;
-								holes_wire->port_id = port_id++;
-								holes_module->ports.push_back(holes_wire->name);
-							}
-							conn.append(holes_wire);
+			int box_inputs = 0;
+			for (auto port_name : box_ports.at(cell->type)) {
+				RTLIL::Wire *w = box_module->wire(port_name);
+				log_assert(w);
+				log_assert(!w->port_input || !w->port_output);
+				if (w->port_output)
+					box_type.outputs.emplace_back(port_name, GetSize(w));
+				if (!whitebox)
+					continue;
+				auto &conn = box_type.holes_cell->connections_[port_name];
+				if (w->port_input) {
+					for (int i = 0; i < GetSize(w); i++) {
+						box_inputs++;
+						RTLIL::Wire *holes_wire = holes_module->wire(stringf("\\i%d", box_inputs));
+						if (!holes_wire) {
+							holes_wire = holes_module->addWire(stringf("\\i%d", box_inputs));
+							holes_wire->port_input = true;
+							holes_wire->port_id = port_id++;
+							holes_module->ports.push_back(holes_wire->name);
 						}
+						conn.append(holes_wire);
 					}
-					else if (w->port_output)
-						conn = holes_module->addWire(stringf("%s.%s", cell->type.c_str(), log_id(port_name)), GetSize(w));
 				}
+				else if (w->port_output)
+					conn = holes_module->addWire(stringf("%s.%s", cell->type.c_str(), log_id(port_name)), GetSize(w));
 			}
-			else // box_module is a blackbox
-				log_assert(holes_cell == nullptr);
 		}
 
-		for (auto port_name : box_ports.at(cell->type)) {
-			RTLIL::Wire *w = box_module->wire(port_name);
-			log_assert(w);
-			if (!w->port_output)
-				continue;
-			Wire *holes_wire = holes_module->addWire(stringf("$abc%s.%s", cell->name.c_str(), log_id(port_name)), GetSize(w));
+		for (auto &output : box_type.outputs) {
+			IdString port_name = output.first;
+			Wire *holes_wire = holes_module->addWire(stringf("$abc%s.%s", cell->name.c_str(), log_id(port_name)), output.second);
 			holes_wire->port_output = true;
 			holes_wire->port_id = port_id++;
 			holes_module->ports.push_back(holes_wire->name);
-			if (holes_cell) // whitebox
-				holes_module->connect(holes_wire, holes_cell->getPort(port_name));
+			if (box_type.holes_cell) // whitebox
+				holes_module->connect(holes_wire, box_type.holes_cell->getPort(port_name));
 			else // blackbox
-				holes_module->connect(holes_wire, Const(State::S0, GetSize(w)));
+				holes_module->connect(holes_wire, Const(State::S0, output.second));
 		}
 	}
 }
 
+// The LUT and box libraries are derived only from the techlib modules
+// carrying abc9 attributes, which stay unchanged across the abc9 runs of an
+// iterative flow. Fingerprint those modules so prep_lut/prep_box can reuse
+// the previously derived artifacts instead of re-parsing all the timing
+// information every invocation.
+struct Abc9LutCacheEntry {
+	Hasher::hash_t fingerprint;
+	int maxlut;
+	std::string lut_library;
+};
+static std::vector<Abc9LutCacheEntry> abc9_lut_cache;
+
+struct Abc9BoxCacheEntry {
+	Hasher::hash_t fingerprint;
+	std::string box_library;
+	// (module name, abc9_box_id) assignments to replay on a cache hit
+	std::vector<std::pair<std::string, int>> box_ids;
+};
+static std::vector<Abc9BoxCacheEntry> abc9_box_cache;
+
+static Hasher::hash_t abc9_techlib_fingerprint(RTLIL::Design *design)
+{
+	Hasher h;
+	for (auto module : design->modules()) {
+		if (!module->has_attribute(ID::abc9_lut) && !module->has_attribute(ID::abc9_box) &&
+				!module->get_bool_attribute(ID::abc9_flop))
+			continue;
+		h.eat(module->name);
+		for (auto &attr : module->attributes) {
+			// assigned by prep_box itself; including it would invalidate
+			// the fingerprint after the first run
+			if (attr.first == ID::abc9_box_id)
+				continue;
+			h.eat(attr.first);
+			h.eat(attr.second);
+		}
+		h.eat(GetSize(module->wires_));
+		for (auto wire : module->wires()) {
+			h.eat(wire->name);
+			h.hash32(wire->width);
+			h.hash32(wire->port_id);
+			h.hash32((wire->port_input ? 1 : 0) | (wire->port_output ? 2 : 0));
+			for (auto &attr : wire->attributes) {
+				h.eat(attr.first);
+				h.eat(attr.second);
+			}
+		}
+		h.eat(GetSize(module->cells_));
+		for (auto cell : module->cells()) {
+			h.eat(cell->type);
+			for (auto &param : cell->parameters) {
+				h.eat(param.first);
+				h.eat(param.second);
+			}
+			for (auto &conn : cell->connections()) {
+				h.eat(conn.first);
+				h.eat(conn.second);
+			}
+		}
+	}
+	return h.yield();
+}
+
 void prep_lut(RTLIL::Design *design, int maxlut)
 {
+	Hasher::hash_t fingerprint = abc9_techlib_fingerprint(design);
+	for (auto &entry : abc9_lut_cache)
+		if (entry.fingerprint == fingerprint && entry.maxlut == maxlut) {
+			log_debug("Reusing cached abc9 LUT library.\n");
+			design->scratchpad_set_string("abc9_ops.lut_library", entry.lut_library);
+			return;
+		}
+
 	TimingInfo timing;
 
 	struct t_lut {
@@ -948,6 +1057,7 @@ void prep_lut(RTLIL::Design *design, int maxlut)
 		ss << std::endl;
 	}
 	design->scratchpad_set_string("abc9_ops.lut_library", ss.str());
+	abc9_lut_cache.push_back(Abc9LutCacheEntry{fingerprint, maxlut, ss.str()});
 }
 
 void write_lut(RTLIL::Module *module, const std::string &dst) {
@@ -959,8 +1069,24 @@ void write_lut(RTLIL::Module *module, const std::string &dst) {
 
 void prep_box(RTLIL::Design *design)
 {
+	Hasher::hash_t fingerprint = abc9_techlib_fingerprint(design);
+	for (auto &entry : abc9_box_cache)
+		if (entry.fingerprint == fingerprint) {
+			log_debug("Reusing cached abc9 box library.\n");
+			for (auto &it : entry.box_ids) {
+				auto module = design->module(RTLIL::IdString(it.first));
+				log_assert(module != nullptr);
+				module->attributes[ID::abc9_box_id] = it.second;
+			}
+			design->scratchpad_set_string("abc9_ops.box_library", entry.box_library);
+			return;
+		}
+
 	TimingInfo timing;
 
+	Abc9BoxCacheEntry cache_entry;
+	cache_entry.fingerprint = fingerprint;
+
 	int abc9_box_id = 1;
 	std::stringstream ss;
 	dict<IdString,std::vector<IdString>> box_ports;
@@ -974,6 +1100,7 @@ void prep_box(RTLIL::Design *design)
 
 		auto r = module->attributes.insert(ID::abc9_box_id);
 		r.first->second = abc9_box_id++;
+		cache_entry.box_ids.emplace_back(module->name.str(), r.first->second.as_int());
 
 		if (module->get_bool_attribute(ID::abc9_flop)) {
 			int num_inputs = 0, num_outputs = 0;
@@ -1127,6 +1254,8 @@ void prep_box(RTLIL::Design *design)
 		ss << "(dummy) 1 0 0 0";
 
 	design->scratchpad_set_string("abc9_ops.box_library", ss.str());
+	cache_entry.box_library = ss.str();
+	abc9_box_cache.push_back(std::move(cache_entry));
 }
 
 void write_box(RTLIL::Module *module, const std::string &dst) {
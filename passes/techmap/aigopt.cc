@@ -0,0 +1,391 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/cellaigs.h"
+#include "kernel/sigtools.h"
+#include "kernel/utils.h"
+
+#include <queue>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+// A module-wide structurally hashed AIG. Literals are 2*node+polarity, node 0
+// is the constant false, so literal 0 is false and literal 1 is true.
+struct AigOptWorker
+{
+	Module *module;
+	SigMap sigmap;
+	bool rewrite_mode, balance_mode;
+
+	struct ANode {
+		int a, b; // child literals, -1/-1 for primary inputs and the constant
+		int level;
+	};
+
+	std::vector<ANode> nodes;
+	dict<pair<int, int>, int> strash;
+	dict<SigBit, int> pi_map;
+	std::vector<SigBit> pi_bits;
+	dict<SigBit, int> driven;
+	dict<int, SigBit> emit_cache;
+
+	int rewrite_hits = 0;
+	int emitted_gates = 0;
+
+	AigOptWorker(Module *module, bool rewrite_mode, bool balance_mode) :
+			module(module), sigmap(module), rewrite_mode(rewrite_mode), balance_mode(balance_mode)
+	{
+		nodes.push_back(ANode{-1, -1, 0});
+		pi_bits.push_back(State::S0);
+	}
+
+	bool is_and(int node) const { return nodes[node].a >= 0; }
+	int lit_level(int lit) const { return nodes[lit >> 1].level; }
+
+	int pi_lit(SigBit bit)
+	{
+		if (bit == State::S0)
+			return 0;
+		if (bit == State::S1)
+			return 1;
+		auto it = pi_map.find(bit);
+		if (it != pi_map.end())
+			return it->second << 1;
+		int node = GetSize(nodes);
+		nodes.push_back(ANode{-1, -1, 0});
+		pi_bits.push_back(bit);
+		pi_map[bit] = node;
+		return node << 1;
+	}
+
+	int and_lit(int a, int b)
+	{
+		if (a > b)
+			std::swap(a, b);
+
+		if (a == 0 || a == (b ^ 1))
+			return 0;
+		if (a == 1)
+			return b;
+		if (a == b)
+			return a;
+
+		if (rewrite_mode) {
+			// one-sided two-level rewrite rules, applied in both directions
+			for (int i = 0; i < 2; i++) {
+				int x = i ? b : a, y = i ? a : b;
+				if (!is_and(x >> 1))
+					continue;
+				int x0 = nodes[x >> 1].a, x1 = nodes[x >> 1].b;
+				if ((x & 1) == 0) {
+					// containment: y & (y & z) == y & z
+					if (y == x0 || y == x1) {
+						rewrite_hits++;
+						return x;
+					}
+					// contradiction: !y & (y & z) == 0
+					if (y == (x0 ^ 1) || y == (x1 ^ 1)) {
+						rewrite_hits++;
+						return 0;
+					}
+				} else {
+					// subsumption: !y & !(y & z) == !y
+					if (y == (x0 ^ 1) || y == (x1 ^ 1)) {
+						rewrite_hits++;
+						return y;
+					}
+					// substitution: y & !(y & z) == y & !z
+					if (y == x0) {
+						rewrite_hits++;
+						return and_lit(y, x1 ^ 1);
+					}
+					if (y == x1) {
+						rewrite_hits++;
+						return and_lit(y, x0 ^ 1);
+					}
+				}
+			}
+		}
+
+		auto it = strash.find(pair<int, int>(a, b));
+		if (it != strash.end())
+			return it->second << 1;
+
+		int node = GetSize(nodes);
+		nodes.push_back(ANode{a, b, max(lit_level(a), lit_level(b)) + 1});
+		pi_bits.push_back(SigBit());
+		strash[pair<int, int>(a, b)] = node;
+		return node << 1;
+	}
+
+	// Rebuild the AND tree rooted at this literal as a depth-balanced tree,
+	// combining the lowest-level conjuncts first.
+	int balance_lit(int lit, dict<int, int> &memo)
+	{
+		int node = lit >> 1;
+		if (!is_and(node))
+			return lit;
+
+		auto it = memo.find(node);
+		if (it != memo.end())
+			return it->second ^ (lit & 1);
+
+		pool<int> conjuncts;
+		std::vector<int> stack = {node << 1};
+		while (!stack.empty()) {
+			int l = stack.back();
+			stack.pop_back();
+			if ((l & 1) == 0 && is_and(l >> 1)) {
+				stack.push_back(nodes[l >> 1].a);
+				stack.push_back(nodes[l >> 1].b);
+			} else
+				conjuncts.insert(balance_lit(l, memo));
+		}
+
+		int result = 1;
+		std::priority_queue<pair<int, int>, std::vector<pair<int, int>>, std::greater<pair<int, int>>> queue;
+		for (int l : conjuncts) {
+			if (conjuncts.count(l ^ 1)) {
+				result = 0;
+				break;
+			}
+			queue.push(pair<int, int>(lit_level(l), l));
+		}
+
+		if (result != 0) {
+			while (GetSize(queue) > 1) {
+				int x = queue.top().second; queue.pop();
+				int y = queue.top().second; queue.pop();
+				int z = and_lit(x, y);
+				queue.push(pair<int, int>(lit_level(z), z));
+			}
+			if (!queue.empty())
+				result = queue.top().second;
+		}
+
+		memo[node] = result;
+		return result ^ (lit & 1);
+	}
+
+	// Elaborate the cell's AIG into the module-wide graph. Must be called in
+	// topological order so that inputs driven by other absorbed cells are
+	// already available in 'driven'.
+	void add_cell(Cell *cell, const Aig &aig)
+	{
+		std::vector<int> lits;
+		for (auto &node : aig.nodes) {
+			int lit;
+			if (node.portbit >= 0) {
+				SigBit bit = sigmap(cell->getPort(node.portname)[node.portbit]);
+				lit = (driven.count(bit) ? driven.at(bit) : pi_lit(bit)) ^ node.inverter;
+			} else if (node.left_parent < 0 && node.right_parent < 0) {
+				lit = node.inverter ? 1 : 0;
+			} else {
+				lit = and_lit(lits.at(node.left_parent), lits.at(node.right_parent)) ^ node.inverter;
+			}
+			for (auto &op : node.outports) {
+				SigBit bit = sigmap(cell->getPort(op.first)[op.second]);
+				if (bit.wire != nullptr)
+					driven[bit] = lit;
+			}
+			lits.push_back(lit);
+		}
+	}
+
+	SigBit emit_lit(int lit)
+	{
+		if (lit == 0)
+			return State::S0;
+		if (lit == 1)
+			return State::S1;
+
+		auto it = emit_cache.find(lit);
+		if (it != emit_cache.end())
+			return it->second;
+
+		SigBit bit;
+		int node = lit >> 1;
+		if (!is_and(node)) {
+			bit = pi_bits.at(node);
+			if (lit & 1) {
+				SigBit new_bit = module->addWire(NEW_ID);
+				module->addNotGate(NEW_ID, bit, new_bit);
+				emitted_gates++;
+				bit = new_bit;
+			}
+		} else if (lit & 1) {
+			bit = module->addWire(NEW_ID);
+			module->addNotGate(NEW_ID, emit_lit(lit ^ 1), bit);
+			emitted_gates++;
+		} else {
+			bit = module->addWire(NEW_ID);
+			module->addAndGate(NEW_ID, emit_lit(nodes[node].a), emit_lit(nodes[node].b), bit);
+			emitted_gates++;
+		}
+
+		emit_cache[lit] = bit;
+		return bit;
+	}
+};
+
+struct AigoptPass : public Pass {
+	AigoptPass() : Pass("aigopt", "optimize logic with the built-in AIG engine") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    aigopt [options] [selection]\n");
+		log("\n");
+		log("Convert the selected combinational logic into one structurally hashed\n");
+		log("and-inverter-graph, optimize it, and write it back as $_AND_ and $_NOT_\n");
+		log("cells. Unlike the 'abc' pass this runs in-process without serializing the\n");
+		log("design, which makes it cheap enough for small cones in incremental flows.\n");
+		log("\n");
+		log("Cells in combinational loops and cell types without an AIG model are left\n");
+		log("untouched. Like 'aigmap' this decomposes word-level cells, so run it on\n");
+		log("gate-level netlists (e.g. after 'aigmap') when that is not desired.\n");
+		log("\n");
+		log("    -norewrite\n");
+		log("        only perform structural hashing and constant folding, skip the\n");
+		log("        local two-level rewrite rules\n");
+		log("\n");
+		log("    -nobalance\n");
+		log("        do not rebalance AND trees for depth\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool rewrite_mode = true, balance_mode = true;
+
+		log_header(design, "Executing AIGOPT pass (optimize logic with the built-in AIG engine).\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-norewrite") {
+				rewrite_mode = false;
+				continue;
+			}
+			if (args[argidx] == "-nobalance") {
+				balance_mode = false;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		for (auto module : design->selected_modules())
+		{
+			if (module->has_processes_warn())
+				continue;
+
+			dict<Cell*, Aig> candidates;
+			for (auto cell : module->selected_cells()) {
+				Aig aig(cell);
+				if (!aig.name.empty())
+					candidates.emplace(cell, std::move(aig));
+			}
+
+			if (candidates.empty())
+				continue;
+
+			AigOptWorker worker(module, rewrite_mode, balance_mode);
+
+			// order the absorbed cells topologically and keep cells in
+			// combinational loops out of the AIG
+			dict<SigBit, Cell*> driver_cell;
+			for (auto &it : candidates)
+				for (auto &conn : it.first->connections())
+					if (it.first->output(conn.first))
+						for (auto bit : worker.sigmap(conn.second))
+							if (bit.wire != nullptr)
+								driver_cell[bit] = it.first;
+
+			TopoSort<Cell*, IdString::compare_ptr_by_name<Cell>> toposort;
+			for (auto &it : candidates) {
+				toposort.node(it.first);
+				for (auto &conn : it.first->connections())
+					if (it.first->input(conn.first))
+						for (auto bit : worker.sigmap(conn.second))
+							if (driver_cell.count(bit) && driver_cell.at(bit) != it.first)
+								toposort.edge(driver_cell.at(bit), it.first);
+			}
+			toposort.sort();
+
+			pool<Cell*> loop_cells;
+			for (auto &loop : toposort.loops)
+				for (auto cell : loop)
+					loop_cells.insert(cell);
+
+			std::vector<Cell*> replaced_cells;
+			for (auto cell : toposort.sorted) {
+				if (loop_cells.count(cell))
+					continue;
+				worker.add_cell(cell, candidates.at(cell));
+				replaced_cells.push_back(cell);
+			}
+
+			if (replaced_cells.empty())
+				continue;
+
+			// outputs that must survive: bits consumed by kept cells, module
+			// ports, and wires marked 'keep'
+			pool<SigBit> required;
+			for (auto cell : module->cells())
+				if (!candidates.count(cell) || loop_cells.count(cell))
+					for (auto &conn : cell->connections())
+						for (auto bit : worker.sigmap(conn.second))
+							if (worker.driven.count(bit))
+								required.insert(bit);
+			for (auto wire : module->wires())
+				if (wire->port_id > 0 || wire->get_bool_attribute(ID::keep))
+					for (auto bit : worker.sigmap(SigSpec(wire)))
+						if (worker.driven.count(bit))
+							required.insert(bit);
+
+			int num_ands = 0;
+			for (int i = 1; i < GetSize(worker.nodes); i++)
+				if (worker.is_and(i))
+					num_ands++;
+
+			if (balance_mode) {
+				dict<int, int> memo;
+				for (auto bit : required)
+					worker.driven[bit] = worker.balance_lit(worker.driven.at(bit), memo);
+			}
+
+			for (auto bit : required)
+				module->connect(bit, worker.emit_lit(worker.driven.at(bit)));
+
+			for (auto cell : replaced_cells)
+				module->remove(cell);
+
+			log("Module %s: absorbed %d cells (%d AND nodes after rewriting, %d rule hits), "
+					"emitted %d gates for %d outputs.\n", log_id(module),
+					GetSize(replaced_cells), num_ands, worker.rewrite_hits,
+					worker.emitted_gates, GetSize(required));
+			if (!loop_cells.empty())
+				log("  skipped %d cells in combinational loops.\n", GetSize(loop_cells));
+		}
+	}
+} AigoptPass;
+
+PRIVATE_NAMESPACE_END
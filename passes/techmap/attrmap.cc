@@ -52,15 +52,15 @@ bool string_compare_nocase(const string &str1, const string &str2)
 	return true;
 }
 
-bool match_name(string &name, IdString &id, bool ignore_case=false)
+// `name' is escaped once when the action is parsed (see
+// parse_attrmap_paramap_options()), not re-escaped for every attribute it
+// is tested against.
+bool match_name(const string &name, IdString &id, bool ignore_case=false)
 {
-	string str1 = RTLIL::escape_id(name);
-	string str2 = id.str();
-
 	if (ignore_case)
-		return string_compare_nocase(str1, str2);
+		return string_compare_nocase(name, id.str());
 
-	return str1 == str2;
+	return id == name;
 }
 
 bool match_value(string &value, Const &val, bool ignore_case=false)
@@ -83,7 +83,7 @@ struct AttrmapTocase : AttrmapAction {
 	string name;
 	bool apply(IdString &id, Const&) override {
 		if (match_name(name, id, true))
-			id = RTLIL::escape_id(name);
+			id = name;
 		return true;
 	}
 };
@@ -92,7 +92,7 @@ struct AttrmapRename : AttrmapAction {
 	string old_name, new_name;
 	bool apply(IdString &id, Const&) override {
 		if (match_name(old_name, id))
-			id = RTLIL::escape_id(new_name);
+			id = new_name;
 		return true;
 	}
 };
@@ -103,7 +103,7 @@ struct AttrmapMap : AttrmapAction {
 	string old_value, new_value;
 	bool apply(IdString &id, Const &val) override {
 		if (match_name(old_name, id) && match_value(old_value, val, true)) {
-			id = RTLIL::escape_id(new_name);
+			id = new_name;
 			val = make_value(new_value);
 		}
 		return true;
@@ -168,14 +168,14 @@ bool parse_attrmap_paramap_options(size_t &argidx, std::vector<std::string> &arg
 	std::string arg = args[argidx];
 	if (arg == "-tocase" && argidx+1 < args.size()) {
 		auto action = new AttrmapTocase;
-		action->name = args[++argidx];
+		action->name = RTLIL::escape_id(args[++argidx]);
 		actions.push_back(std::unique_ptr<AttrmapAction>(action));
 		return true;
 	}
 	if (arg == "-rename" && argidx+2 < args.size()) {
 		auto action = new AttrmapRename;
-		action->old_name = args[++argidx];
-		action->new_name = args[++argidx];
+		action->old_name = RTLIL::escape_id(args[++argidx]);
+		action->new_name = RTLIL::escape_id(args[++argidx]);
 		actions.push_back(std::unique_ptr<AttrmapAction>(action));
 		return true;
 	}
@@ -195,8 +195,8 @@ bool parse_attrmap_paramap_options(size_t &argidx, std::vector<std::string> &arg
 		}
 		auto action = new AttrmapMap;
 		action->imap = (arg == "-map");
-		action->old_name = arg1;
-		action->new_name = arg2;
+		action->old_name = RTLIL::escape_id(arg1);
+		action->new_name = RTLIL::escape_id(arg2);
 		action->old_value = val1;
 		action->new_value = val2;
 		actions.push_back(std::unique_ptr<AttrmapAction>(action));
@@ -210,7 +210,7 @@ bool parse_attrmap_paramap_options(size_t &argidx, std::vector<std::string> &arg
 			arg1 = arg1.substr(0, p);
 		}
 		auto action = new AttrmapRemove;
-		action->name = arg1;
+		action->name = RTLIL::escape_id(arg1);
 		action->has_value = (p != string::npos);
 		action->value = val1;
 		actions.push_back(std::unique_ptr<AttrmapAction>(action));
@@ -3,6 +3,8 @@
 #include "kernel/rtlil.h"
 #include "kernel/sigtools.h"
 #include "kernel/consteval.h"
+#include "kernel/cellaigs.h"
+#include "kernel/threadpool.h"
 #include "kernel/utils.h"
 
 #include <algorithm>
@@ -87,29 +89,167 @@ uint64_t p_class(int k, uint64_t lut)
 	return repr;
 }
 
-// Represent module m as N single-output k-LUTs
-// where k is the number of module inputs,
-//   and N is the number of module outputs.
-bool derive_module_luts(Module *m, std::vector<uint64_t> &luts)
+// Evaluate all (up to 64) input vectors of module m at once, one vector per
+// bit position of a uint64_t word, walking the AIG models of the module's
+// cells (see kernel/cellaigs.cc). Returns false if some cell has no AIG model
+// or the cells can't be ordered topologically, in which case the caller falls
+// back to per-vector constant evaluation. Does not log, so it can run on a
+// worker thread.
+bool derive_module_luts_bitsliced(Module *m, std::vector<uint64_t> &luts)
 {
-	CellTypes ff_types;
-	ff_types.setup_stdcells_mem();
+	SigSpec inputs = module_inputs(m);
+	SigSpec outputs = module_outputs(m);
+	int ninputs = inputs.size(), noutputs = outputs.size();
+
+	SigMap sigmap(m);
+	dict<SigBit, uint64_t> values;
+	values[State::S0] = 0;
+	values[State::S1] = ~(uint64_t) 0;
+
+	// the word for input var j has bit i set iff vector i sets var j
+	for (int j = 0; j < ninputs; j++) {
+		uint64_t w = 0;
+		for (int i = 0; i < 64; i++)
+			if (i & (1 << j))
+				w |= (uint64_t) 1 << i;
+		values[sigmap(inputs[j])] = w;
+	}
+
+	struct CellModel {
+		Cell *cell;
+		Aig aig;
+		std::vector<SigBit> inbits;
+	};
+	std::vector<CellModel> models;
 	for (auto cell : m->cells()) {
-		if (ff_types.cell_known(cell->type)) {
-			log("Ignoring module '%s' which isn't purely combinational.\n", log_id(m));
+		models.push_back(CellModel{cell, Aig(cell), {}});
+		CellModel &model = models.back();
+		if (model.aig.name.empty())
 			return false;
+		for (auto &node : model.aig.nodes)
+			if (node.portbit >= 0)
+				model.inbits.push_back(sigmap(cell->getPort(node.portname)[node.portbit]));
+	}
+
+	// evaluate the cells in topological order using a worklist, so we don't
+	// need to build an explicit cell dependency graph
+	std::vector<bool> done(models.size(), false);
+	int ndone = 0;
+	while (ndone < GetSize(models)) {
+		bool progress = false;
+		for (int idx = 0; idx < GetSize(models); idx++) {
+			if (done[idx])
+				continue;
+			CellModel &model = models[idx];
+
+			bool ready = true;
+			for (auto bit : model.inbits)
+				if (!values.count(bit)) {
+					ready = false;
+					break;
+				}
+			if (!ready)
+				continue;
+
+			std::vector<uint64_t> nodevals;
+			int in_no = 0;
+			for (auto &node : model.aig.nodes) {
+				uint64_t w;
+				if (node.portbit >= 0) {
+					w = values.at(model.inbits[in_no++]);
+					if (node.inverter)
+						w = ~w;
+				} else if (node.left_parent < 0 && node.right_parent < 0) {
+					w = node.inverter ? ~(uint64_t) 0 : 0;
+				} else {
+					w = nodevals[node.left_parent] & nodevals[node.right_parent];
+					if (node.inverter)
+						w = ~w;
+				}
+				for (auto &op : node.outports)
+					values[sigmap(model.cell->getPort(op.first)[op.second])] = w;
+				nodevals.push_back(w);
+			}
+
+			done[idx] = true;
+			ndone++;
+			progress = true;
 		}
+		// combinational loop or a cell input driven by nothing we model
+		if (!progress)
+			return false;
 	}
 
-	SigSpec inputs = module_inputs(m);
-	SigSpec outputs = module_outputs(m);
-	int ninputs = inputs.size(), noutputs = outputs.size();
+	uint64_t mask = ninputs < 6 ? ((uint64_t) 1 << (1 << ninputs)) - 1 : ~(uint64_t) 0;
+	luts.clear();
+	luts.resize(noutputs);
+	for (int j = 0; j < noutputs; j++) {
+		SigBit bit = sigmap(outputs[j]);
+		if (!values.count(bit))
+			return false;
+		luts[j] = values.at(bit) & mask;
+	}
+
+	return true;
+}
 
-	if (ninputs > 6) {
+enum LutDeriveStatus {
+	LUT_DERIVE_OK,
+	LUT_DERIVE_NOT_COMB,
+	LUT_DERIVE_WIDE_PORT,
+	LUT_DERIVE_TOO_MANY_INPUTS,
+	LUT_DERIVE_NEEDS_CONSTEVAL,
+};
+
+// Logging-free core of derive_module_luts, suitable for running on a worker
+// thread when scanning a library in parallel. On LUT_DERIVE_NEEDS_CONSTEVAL
+// the caller retries with finish_lut_derivation on the main thread.
+LutDeriveStatus derive_module_luts_worker(Module *m, const CellTypes &ff_types, std::vector<uint64_t> &luts)
+{
+	for (auto cell : m->cells())
+		if (ff_types.cell_known(cell->type))
+			return LUT_DERIVE_NOT_COMB;
+
+	for (auto port : m->ports)
+		if (m->wire(port)->width != 1)
+			return LUT_DERIVE_WIDE_PORT;
+
+	if (module_inputs(m).size() > 6)
+		return LUT_DERIVE_TOO_MANY_INPUTS;
+
+	if (!derive_module_luts_bitsliced(m, luts))
+		return LUT_DERIVE_NEEDS_CONSTEVAL;
+
+	return LUT_DERIVE_OK;
+}
+
+// Log the outcome of derive_module_luts_worker and run the per-vector
+// ConstEval fallback if the bit-sliced path couldn't handle the module.
+bool finish_lut_derivation(Module *m, LutDeriveStatus status, std::vector<uint64_t> &luts)
+{
+	switch (status)
+	{
+	case LUT_DERIVE_OK:
+		return true;
+	case LUT_DERIVE_NOT_COMB:
+		log("Ignoring module '%s' which isn't purely combinational.\n", log_id(m));
+		return false;
+	case LUT_DERIVE_WIDE_PORT:
+		// reproduce the log_error of the serial implementation
+		module_inputs(m);
+		module_outputs(m);
+		log_abort();
+	case LUT_DERIVE_TOO_MANY_INPUTS:
 		log_warning("Skipping module %s with more than 6 inputs bits.\n", log_id(m));
 		return false;
+	case LUT_DERIVE_NEEDS_CONSTEVAL:
+		break;
 	}
 
+	SigSpec inputs = module_inputs(m);
+	SigSpec outputs = module_outputs(m);
+	int ninputs = inputs.size(), noutputs = outputs.size();
+
 	luts.clear();
 	luts.resize(noutputs);
 
@@ -127,8 +267,6 @@ bool derive_module_luts(Module *m, std::vector<uint64_t> &luts)
 				return false;
 			}
 
-			log_assert(ceval.eval(bit));
-
 			if (bit[0] == State::S1)
 				luts[j] |= 1 << i;
 		}
@@ -137,6 +275,17 @@ bool derive_module_luts(Module *m, std::vector<uint64_t> &luts)
 	return true;
 }
 
+// Represent module m as N single-output k-LUTs
+// where k is the number of module inputs,
+//   and N is the number of module outputs.
+bool derive_module_luts(Module *m, std::vector<uint64_t> &luts)
+{
+	CellTypes ff_types;
+	ff_types.setup_stdcells_mem();
+
+	return finish_lut_derivation(m, derive_module_luts_worker(m, ff_types, luts), luts);
+}
+
 struct CellmatchPass : Pass {
 	CellmatchPass() : Pass("cellmatch", "match cells to their targets in cell library") {}
 	void help() override
@@ -192,21 +341,54 @@ struct CellmatchPass : Pass {
 		dict<pool<uint64_t>, std::vector<Target>> targets;
 
 		if (lib)
-		for (auto m : lib->modules()) {
-			pool<uint64_t> p_classes;
+		{
+			CellTypes ff_types;
+			ff_types.setup_stdcells_mem();
+
+			std::vector<Module *> lib_modules;
+			for (auto m : lib->modules())
+				lib_modules.push_back(m);
+
+			struct ScanResult {
+				LutDeriveStatus status;
+				std::vector<uint64_t> luts;
+				pool<uint64_t> p_classes;
+			};
+			std::vector<ScanResult> results(lib_modules.size());
+
+			// scan the library in parallel: workers only read the library
+			// design and fill in their ScanResult slot; all logging and the
+			// target registration happen on the main thread below
+			int num_threads = ThreadPool::thread_count(d);
+			ThreadPool::run(num_threads, GetSize(lib_modules), [&](int idx) {
+				Module *m = lib_modules[idx];
+				ScanResult &res = results[idx];
+				res.status = derive_module_luts_worker(m, ff_types, res.luts);
+				if (res.status != LUT_DERIVE_OK)
+					return;
+				int ninputs = module_inputs(m).size();
+				for (auto lut : res.luts)
+					res.p_classes.insert(p_class(ninputs, lut));
+			});
+
+			for (int idx = 0; idx < GetSize(lib_modules); idx++) {
+				Module *m = lib_modules[idx];
+				ScanResult &res = results[idx];
+				if (!finish_lut_derivation(m, res.status, res.luts))
+					continue;
 
-			// produce a fingerprint in p_classes
-			int ninputs = module_inputs(m).size();
-			std::vector<uint64_t> luts;
-			if (!derive_module_luts(m, luts))
-				continue;
-			for (auto lut : luts)
-				p_classes.insert(p_class(ninputs, lut));
+				// produce a fingerprint in p_classes
+				if (res.p_classes.empty()) {
+					int ninputs = module_inputs(m).size();
+					for (auto lut : res.luts)
+						res.p_classes.insert(p_class(ninputs, lut));
+				}
 
-			log_debug("Registered %s\n", log_id(m));
+				log_debug("Registered %s\n", log_id(m));
 
-			// save as a viable target
-			targets[p_classes].push_back(Target{m, luts});
+				// save as a viable target
+				targets[res.p_classes].push_back(Target{m, res.luts});
+			}
 		}
 
 		auto r = saved_designs.emplace("$cellmatch", nullptr);
@@ -21,6 +21,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/ffinit.h"
 #include "kernel/ff.h"
+#include "kernel/threadpool.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -885,6 +886,66 @@ struct DffLegalizePass : public Pass {
 		}
 	}
 
+	// Fast path: a fine FF whose exact type, polarities and init/reset
+	// values are in the supported set needs no legalization work at all.
+	// The answer is fully determined by the (cell type, init value)
+	// signature, so all cells sharing a signature take the same branch.
+	// This replicates the checks of legalize_finish() and fixup_reset_x()
+	// without mutating the FF.
+	bool is_already_legal(FfData &ff) {
+		int ff_type = get_ff_type(ff);
+		int initmask = get_initmask(ff);
+		int ff_neg = 0;
+		if (ff.has_sr) {
+			if (!ff.pol_clr)
+				ff_neg |= NEG_R;
+			if (!ff.pol_set)
+				ff_neg |= NEG_S;
+		}
+		if (ff.has_arst) {
+			if (!ff.pol_arst)
+				ff_neg |= NEG_R;
+		}
+		if (ff.has_srst) {
+			if (!ff.pol_srst)
+				ff_neg |= NEG_R;
+		}
+		if (ff.has_aload) {
+			if (!ff.pol_aload)
+				ff_neg |= NEG_L;
+		}
+		if (ff.has_clk) {
+			if (!ff.pol_clk)
+				ff_neg |= NEG_C;
+		}
+		if (ff.has_ce) {
+			if (!ff.pol_ce)
+				ff_neg |= NEG_CE;
+		}
+		int supported = supported_cells_neg[ff_type][ff_neg];
+		if (!(supported & initmask))
+			return false;
+
+		// fixup_reset_x() would rewrite x reset values the target cell
+		// cannot hold
+		for (int i = 0; i < ff.width; i++) {
+			int mask;
+			if (ff.val_init[i] == State::S0)
+				mask = INIT_0;
+			else if (ff.val_init[i] == State::S1)
+				mask = INIT_1;
+			else
+				mask = INIT_X;
+			if (ff.has_arst && ff.val_arst[i] == State::Sx)
+				if (!(supported & (mask << 8)) || !(supported & (mask << 4)))
+					return false;
+			if (ff.has_srst && ff.val_srst[i] == State::Sx)
+				if (!(supported & (mask << 8)) || !(supported & (mask << 4)))
+					return false;
+		}
+		return true;
+	}
+
 	void legalize_ff(FfData &ff) {
 		if (ff.has_gclk)
 			return;
@@ -1206,11 +1267,35 @@ unrecognized:
 						srst_used[ff.sig_srst[0]] += ff.width;
 				}
 			}
+			std::vector<Cell *> ff_cells;
 			for (auto cell : module->selected_cells())
+				if (RTLIL::builtin_ff_cell_types().count(cell->type))
+					ff_cells.push_back(cell);
+
+			// Analysis phase: decide per cell whether it is already legal
+			// as-is. This only reads the design (FfData construction and
+			// bitmask tests), so it runs on worker threads; on typical
+			// post-synthesis designs it filters out the bulk of the FFs,
+			// and the recursive legalization below only runs for the rest.
+			// With -mince/-minsrst the unmap decisions depend on per-signal
+			// use counts, so every cell takes the full path.
+			std::vector<uint8_t> need_work(ff_cells.size(), 1);
+			if (!mince && !minsrst) {
+				int num_threads = ThreadPool::thread_count(design);
+				ThreadPool::run(num_threads, GetSize(ff_cells), [&](int idx) {
+					FfData ff(&initvals, ff_cells[idx]);
+					if (ff.has_gclk || !ff.is_fine)
+						need_work[idx] = 1; // legalize_ff() returns immediately for these
+					else
+						need_work[idx] = !is_already_legal(ff);
+				});
+			}
+
+			for (int i = 0; i < GetSize(ff_cells); i++)
 			{
-				if (!RTLIL::builtin_ff_cell_types().count(cell->type))
+				if (!need_work[i])
 					continue;
-				FfData ff(&initvals, cell);
+				FfData ff(&initvals, ff_cells[i]);
 				legalize_ff(ff);
 			}
 		}
@@ -229,13 +229,28 @@ static bool parse_pin(const LibertyAst *cell, const LibertyAst *attr, std::strin
 	return false;
 }
 
-static void find_cell(std::vector<const LibertyAst *> cells, IdString cell_type, bool clkpol, bool has_reset, bool rstpol, bool rstval, bool has_enable, bool enapol, std::vector<std::string> &dont_use_cells)
+// Pre-parsed flip-flop description of one Liberty cell. find_cell() and
+// find_cell_sr() used to re-run the string parsing of the clocked_on,
+// next_state, clear and preset attributes and the pin scan for every one of
+// the ~22 queried FF types; the index extracts each library cell once and the
+// queries only compare the precomputed fields.
+struct FfIndexEntry
 {
-	const LibertyAst *best_cell = nullptr;
-	std::map<std::string, char> best_cell_ports;
-	int best_cell_pins = 0;
-	bool best_cell_noninv = false;
-	double best_cell_area = 0;
+	const LibertyAst *cell;
+	std::string clk_pin, next_pin, enable_pin, clear_pin, preset_pin;
+	bool clk_pol, next_pol, enable_pol, clear_pol, preset_pol;
+	bool has_clear, has_preset;
+	double area;
+	int num_pins;
+	std::vector<std::string> input_pins;
+	std::vector<std::string> noninternal_pins;
+	// pin name and whether its function is the inverted FF output (iqn)
+	std::vector<std::pair<std::string, bool>> output_funcs;
+};
+
+static std::vector<FfIndexEntry> build_ff_index(const std::vector<const LibertyAst *> &cells, const std::vector<std::string> &dont_use_cells)
+{
+	std::vector<FfIndexEntry> index;
 
 	for (auto cell : cells)
 	{
@@ -244,7 +259,7 @@ static void find_cell(std::vector<const LibertyAst *> cells, IdString cell_type,
 			continue;
 
 		bool dont_use = false;
-		for (std::string &dont_use_cell : dont_use_cells)
+		for (const std::string &dont_use_cell : dont_use_cells)
 		{
 			if (patmatch(dont_use_cell.c_str(), cell->args[0].c_str()))
 			{
@@ -259,38 +274,22 @@ static void find_cell(std::vector<const LibertyAst *> cells, IdString cell_type,
 		if (ff == nullptr)
 			continue;
 
-		std::string cell_clk_pin, cell_rst_pin, cell_next_pin, cell_enable_pin;
-		bool cell_clk_pol, cell_rst_pol, cell_next_pol, cell_enable_pol;
+		FfIndexEntry e;
+		e.cell = cell;
 
-		if (!parse_pin(cell, ff->find("clocked_on"), cell_clk_pin, cell_clk_pol) || cell_clk_pol != clkpol)
+		if (!parse_pin(cell, ff->find("clocked_on"), e.clk_pin, e.clk_pol))
 			continue;
-		if (!parse_next_state(cell, ff->find("next_state"), cell_next_pin, cell_next_pol, cell_enable_pin, cell_enable_pol) || (has_enable && (cell_enable_pin.empty() || cell_enable_pol != enapol)))
+		if (!parse_next_state(cell, ff->find("next_state"), e.next_pin, e.next_pol, e.enable_pin, e.enable_pol))
 			continue;
-		if (has_reset && rstval == false) {
-			if (!parse_pin(cell, ff->find("clear"), cell_rst_pin, cell_rst_pol) || cell_rst_pol != rstpol)
-				continue;
-		}
-		if (has_reset && rstval == true) {
-			if (!parse_pin(cell, ff->find("preset"), cell_rst_pin, cell_rst_pol) || cell_rst_pol != rstpol)
-				continue;
-		}
+		e.has_clear = parse_pin(cell, ff->find("clear"), e.clear_pin, e.clear_pol);
+		e.has_preset = parse_pin(cell, ff->find("preset"), e.preset_pin, e.preset_pol);
 
-		std::map<std::string, char> this_cell_ports;
-		this_cell_ports[cell_clk_pin] = 'C';
-		if (has_reset)
-			this_cell_ports[cell_rst_pin] = 'R';
-		if (has_enable)
-			this_cell_ports[cell_enable_pin] = 'E';
-		this_cell_ports[cell_next_pin] = 'D';
-
-		double area = 0;
+		e.area = 0;
 		const LibertyAst *ar = cell->find("area");
 		if (ar != nullptr && !ar->value.empty())
-			area = atof(ar->value.c_str());
+			e.area = atof(ar->value.c_str());
 
-		int num_pins = 0;
-		bool found_output = false;
-		bool found_noninv_output = false;
+		e.num_pins = 0;
 		for (auto pin : cell->children)
 		{
 			if (pin->id != "pin" || pin->args.size() != 1)
@@ -299,46 +298,112 @@ static void find_cell(std::vector<const LibertyAst *> cells, IdString cell_type,
 			const LibertyAst *dir = pin->find("direction");
 			if (dir == nullptr || dir->value == "internal")
 				continue;
-			num_pins++;
+			e.num_pins++;
+			e.noninternal_pins.push_back(pin->args[0]);
 
-			if (dir->value == "input" && this_cell_ports.count(pin->args[0]) == 0)
-				goto continue_cell_loop;
+			if (dir->value == "input")
+				e.input_pins.push_back(pin->args[0]);
 
 			const LibertyAst *func = pin->find("function");
 			if (dir->value == "output" && func != nullptr) {
 				std::string value = func->value;
 				for (size_t pos = value.find_first_of("\" \t"); pos != std::string::npos; pos = value.find_first_of("\" \t"))
 					value.erase(pos, 1);
-				if (value == ff->args[0]) {
-					this_cell_ports[pin->args[0]] = cell_next_pol ? 'Q' : 'q';
-					if (cell_next_pol)
-						found_noninv_output = true;
-					found_output = true;
-				} else
-				if (value == ff->args[1]) {
-					this_cell_ports[pin->args[0]] = cell_next_pol ? 'q' : 'Q';
-					if (!cell_next_pol)
-						found_noninv_output = true;
-					found_output = true;
-				}
+				if (value == ff->args[0])
+					e.output_funcs.push_back(std::pair<std::string, bool>(pin->args[0], false));
+				else if (ff->args.size() > 1 && value == ff->args[1])
+					e.output_funcs.push_back(std::pair<std::string, bool>(pin->args[0], true));
 			}
+		}
+
+		index.push_back(std::move(e));
+	}
+
+	return index;
+}
+
+// The index only depends on the parsed libraries and the -dont_use patterns,
+// so it is kept for the rest of the session, keyed by the cached ASTs (which
+// LibertyAstCache revalidates against the files). Repeated dfflibmap runs in
+// a long-lived process then skip the per-cell attribute parsing entirely.
+struct FfIndexCacheEntry
+{
+	std::vector<std::shared_ptr<const LibertyAst>> asts;
+	std::vector<std::string> dont_use_cells;
+	std::vector<FfIndexEntry> index;
+};
+
+static std::vector<FfIndexCacheEntry> ff_index_cache;
+
+static void find_cell(const std::vector<FfIndexEntry> &ff_index, IdString cell_type, bool clkpol, bool has_reset, bool rstpol, bool rstval, bool has_enable, bool enapol)
+{
+	const LibertyAst *best_cell = nullptr;
+	std::map<std::string, char> best_cell_ports;
+	int best_cell_pins = 0;
+	bool best_cell_noninv = false;
+	double best_cell_area = 0;
+
+	for (auto &e : ff_index)
+	{
+		if (e.clk_pol != clkpol)
+			continue;
+		if (has_enable && (e.enable_pin.empty() || e.enable_pol != enapol))
+			continue;
 
-			if (this_cell_ports.count(pin->args[0]) == 0)
-				this_cell_ports[pin->args[0]] = 0;
+		std::string cell_rst_pin;
+		if (has_reset && rstval == false) {
+			if (!e.has_clear || e.clear_pol != rstpol)
+				continue;
+			cell_rst_pin = e.clear_pin;
 		}
+		if (has_reset && rstval == true) {
+			if (!e.has_preset || e.preset_pol != rstpol)
+				continue;
+			cell_rst_pin = e.preset_pin;
+		}
+
+		std::map<std::string, char> this_cell_ports;
+		this_cell_ports[e.clk_pin] = 'C';
+		if (has_reset)
+			this_cell_ports[cell_rst_pin] = 'R';
+		if (has_enable)
+			this_cell_ports[e.enable_pin] = 'E';
+		this_cell_ports[e.next_pin] = 'D';
 
-		if (!found_output || (best_cell != nullptr && (num_pins > best_cell_pins || (best_cell_noninv && !found_noninv_output))))
+		bool reject = false;
+		for (auto &pin_name : e.input_pins)
+			if (this_cell_ports.count(pin_name) == 0) {
+				reject = true;
+				break;
+			}
+		if (reject)
 			continue;
 
-		if (best_cell != nullptr && num_pins == best_cell_pins && area > best_cell_area)
+		bool found_output = false;
+		bool found_noninv_output = false;
+		for (auto &of : e.output_funcs) {
+			bool noninv = of.second ? !e.next_pol : e.next_pol;
+			this_cell_ports[of.first] = noninv ? 'Q' : 'q';
+			if (noninv)
+				found_noninv_output = true;
+			found_output = true;
+		}
+
+		for (auto &pin_name : e.noninternal_pins)
+			if (this_cell_ports.count(pin_name) == 0)
+				this_cell_ports[pin_name] = 0;
+
+		if (!found_output || (best_cell != nullptr && (e.num_pins > best_cell_pins || (best_cell_noninv && !found_noninv_output))))
 			continue;
 
-		best_cell = cell;
-		best_cell_pins = num_pins;
-		best_cell_area = area;
+		if (best_cell != nullptr && e.num_pins == best_cell_pins && e.area > best_cell_area)
+			continue;
+
+		best_cell = e.cell;
+		best_cell_pins = e.num_pins;
+		best_cell_area = e.area;
 		best_cell_noninv = found_noninv_output;
 		best_cell_ports.swap(this_cell_ports);
-	continue_cell_loop:;
 	}
 
 	if (best_cell != nullptr) {
@@ -349,7 +414,7 @@ static void find_cell(std::vector<const LibertyAst *> cells, IdString cell_type,
 	}
 }
 
-static void find_cell_sr(std::vector<const LibertyAst *> cells, IdString cell_type, bool clkpol, bool setpol, bool clrpol, bool has_enable, bool enapol, std::vector<std::string> &dont_use_cells)
+static void find_cell_sr(const std::vector<FfIndexEntry> &ff_index, IdString cell_type, bool clkpol, bool setpol, bool clrpol, bool has_enable, bool enapol)
 {
 	const LibertyAst *best_cell = nullptr;
 	std::map<std::string, char> best_cell_ports;
@@ -359,104 +424,57 @@ static void find_cell_sr(std::vector<const LibertyAst *> cells, IdString cell_ty
 
 	log_assert(!enapol && "set/reset cell with enable is unimplemented due to lack of cells for testing");
 
-	for (auto cell : cells)
+	for (auto &e : ff_index)
 	{
-		const LibertyAst *dn = cell->find("dont_use");
-		if (dn != nullptr && dn->value == "true")
-			continue;
-
-		bool dont_use = false;
-		for (std::string &dont_use_cell : dont_use_cells)
-		{
-			if (patmatch(dont_use_cell.c_str(), cell->args[0].c_str()))
-			{
-				dont_use = true;
-				break;
-			}
-		}
-		if (dont_use)
-			continue;
-
-		const LibertyAst *ff = cell->find("ff");
-		if (ff == nullptr)
+		if (e.clk_pol != clkpol)
 			continue;
-
-		std::string cell_clk_pin, cell_set_pin, cell_clr_pin, cell_next_pin, cell_enable_pin;
-		bool cell_clk_pol, cell_set_pol, cell_clr_pol, cell_next_pol, cell_enable_pol;
-
-		if (!parse_pin(cell, ff->find("clocked_on"), cell_clk_pin, cell_clk_pol) || cell_clk_pol != clkpol)
+		if (!e.has_preset || e.preset_pol != setpol)
 			continue;
-		if (!parse_next_state(cell, ff->find("next_state"), cell_next_pin, cell_next_pol, cell_enable_pin, cell_enable_pol))
-			continue;
-		if (!parse_pin(cell, ff->find("preset"), cell_set_pin, cell_set_pol) || cell_set_pol != setpol)
-			continue;
-		if (!parse_pin(cell, ff->find("clear"), cell_clr_pin, cell_clr_pol) || cell_clr_pol != clrpol)
+		if (!e.has_clear || e.clear_pol != clrpol)
 			continue;
 
 		std::map<std::string, char> this_cell_ports;
-		this_cell_ports[cell_clk_pin] = 'C';
-		this_cell_ports[cell_set_pin] = 'S';
-		this_cell_ports[cell_clr_pin] = 'R';
+		this_cell_ports[e.clk_pin] = 'C';
+		this_cell_ports[e.preset_pin] = 'S';
+		this_cell_ports[e.clear_pin] = 'R';
 		if (has_enable)
-			this_cell_ports[cell_enable_pin] = 'E';
-		this_cell_ports[cell_next_pin] = 'D';
+			this_cell_ports[e.enable_pin] = 'E';
+		this_cell_ports[e.next_pin] = 'D';
 
-		double area = 0;
-		const LibertyAst *ar = cell->find("area");
-		if (ar != nullptr && !ar->value.empty())
-			area = atof(ar->value.c_str());
+		bool reject = false;
+		for (auto &pin_name : e.input_pins)
+			if (this_cell_ports.count(pin_name) == 0) {
+				reject = true;
+				break;
+			}
+		if (reject)
+			continue;
 
-		int num_pins = 0;
 		bool found_output = false;
 		bool found_noninv_output = false;
-		for (auto pin : cell->children)
-		{
-			if (pin->id != "pin" || pin->args.size() != 1)
-				continue;
-
-			const LibertyAst *dir = pin->find("direction");
-			if (dir == nullptr || dir->value == "internal")
-				continue;
-			num_pins++;
-
-			if (dir->value == "input" && this_cell_ports.count(pin->args[0]) == 0)
-				goto continue_cell_loop;
-
-			const LibertyAst *func = pin->find("function");
-			if (dir->value == "output" && func != nullptr) {
-				std::string value = func->value;
-				for (size_t pos = value.find_first_of("\" \t"); pos != std::string::npos; pos = value.find_first_of("\" \t"))
-					value.erase(pos, 1);
-				if (value == ff->args[0]) {
-					this_cell_ports[pin->args[0]] = cell_next_pol ? 'Q' : 'q';
-					if (cell_next_pol)
-						found_noninv_output = true;
-					found_output = true;
-				} else
-				if (value == ff->args[1]) {
-					this_cell_ports[pin->args[0]] = cell_next_pol ? 'q' : 'Q';
-					if (!cell_next_pol)
-						found_noninv_output = true;
-					found_output = true;
-				}
-			}
-
-			if (this_cell_ports.count(pin->args[0]) == 0)
-				this_cell_ports[pin->args[0]] = 0;
+		for (auto &of : e.output_funcs) {
+			bool noninv = of.second ? !e.next_pol : e.next_pol;
+			this_cell_ports[of.first] = noninv ? 'Q' : 'q';
+			if (noninv)
+				found_noninv_output = true;
+			found_output = true;
 		}
 
-		if (!found_output || (best_cell != nullptr && (num_pins > best_cell_pins || (best_cell_noninv && !found_noninv_output))))
+		for (auto &pin_name : e.noninternal_pins)
+			if (this_cell_ports.count(pin_name) == 0)
+				this_cell_ports[pin_name] = 0;
+
+		if (!found_output || (best_cell != nullptr && (e.num_pins > best_cell_pins || (best_cell_noninv && !found_noninv_output))))
 			continue;
 
-		if (best_cell != nullptr && num_pins == best_cell_pins && area > best_cell_area)
+		if (best_cell != nullptr && e.num_pins == best_cell_pins && e.area > best_cell_area)
 			continue;
 
-		best_cell = cell;
-		best_cell_pins = num_pins;
-		best_cell_area = area;
+		best_cell = e.cell;
+		best_cell_pins = e.num_pins;
+		best_cell_area = e.area;
 		best_cell_noninv = found_noninv_output;
 		best_cell_ports.swap(this_cell_ports);
-	continue_cell_loop:;
 	}
 
 	if (best_cell != nullptr) {
@@ -629,41 +647,55 @@ struct DfflibmapPass : public Pass {
 			log_cmd_error("Missing `-liberty liberty_file' option!\n");
 
 		LibertyMergedCells merged;
+		std::vector<std::shared_ptr<const LibertyAst>> asts;
 		for (auto path : liberty_files) {
-			std::ifstream f;
-			f.open(path.c_str());
-			if (f.fail())
+			auto ast = LibertyAstCache::instance.get(path);
+			if (ast == nullptr)
 				log_cmd_error("Can't open liberty file `%s': %s\n", path.c_str(), strerror(errno));
-			LibertyParser p(f);
-			merged.merge(p);
-			f.close();
+			merged.merge(ast);
+			asts.push_back(ast);
+		}
+
+		const std::vector<FfIndexEntry> *ff_index = nullptr;
+		for (auto &entry : ff_index_cache)
+			if (entry.asts == asts && entry.dont_use_cells == dont_use_cells) {
+				ff_index = &entry.index;
+				break;
+			}
+		if (ff_index == nullptr) {
+			ff_index_cache.push_back(FfIndexCacheEntry());
+			FfIndexCacheEntry &entry = ff_index_cache.back();
+			entry.asts = asts;
+			entry.dont_use_cells = dont_use_cells;
+			entry.index = build_ff_index(merged.cells, dont_use_cells);
+			ff_index = &entry.index;
 		}
 
-		find_cell(merged.cells, ID($_DFF_N_), false, false, false, false, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_P_), true, false, false, false, false, false, dont_use_cells);
-
-		find_cell(merged.cells, ID($_DFF_NN0_), false, true, false, false, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_NN1_), false, true, false, true, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_NP0_), false, true, true, false, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_NP1_), false, true, true, true, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_PN0_), true, true, false, false, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_PN1_), true, true, false, true, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_PP0_), true, true, true, false, false, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFF_PP1_), true, true, true, true, false, false, dont_use_cells);
-
-		find_cell(merged.cells, ID($_DFFE_NN_), false, false, false, false, true, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFFE_NP_), false, false, false, false, true, true, dont_use_cells);
-		find_cell(merged.cells, ID($_DFFE_PN_), true, false, false, false, true, false, dont_use_cells);
-		find_cell(merged.cells, ID($_DFFE_PP_), true, false, false, false, true, true, dont_use_cells);
-
-		find_cell_sr(merged.cells, ID($_DFFSR_NNN_), false, false, false, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_NNP_), false, false, true, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_NPN_), false, true, false, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_NPP_), false, true, true, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_PNN_), true, false, false, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_PNP_), true, false, true, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_PPN_), true, true, false, false, false, dont_use_cells);
-		find_cell_sr(merged.cells, ID($_DFFSR_PPP_), true, true, true, false, false, dont_use_cells);
+		find_cell(*ff_index, ID($_DFF_N_), false, false, false, false, false, false);
+		find_cell(*ff_index, ID($_DFF_P_), true, false, false, false, false, false);
+
+		find_cell(*ff_index, ID($_DFF_NN0_), false, true, false, false, false, false);
+		find_cell(*ff_index, ID($_DFF_NN1_), false, true, false, true, false, false);
+		find_cell(*ff_index, ID($_DFF_NP0_), false, true, true, false, false, false);
+		find_cell(*ff_index, ID($_DFF_NP1_), false, true, true, true, false, false);
+		find_cell(*ff_index, ID($_DFF_PN0_), true, true, false, false, false, false);
+		find_cell(*ff_index, ID($_DFF_PN1_), true, true, false, true, false, false);
+		find_cell(*ff_index, ID($_DFF_PP0_), true, true, true, false, false, false);
+		find_cell(*ff_index, ID($_DFF_PP1_), true, true, true, true, false, false);
+
+		find_cell(*ff_index, ID($_DFFE_NN_), false, false, false, false, true, false);
+		find_cell(*ff_index, ID($_DFFE_NP_), false, false, false, false, true, true);
+		find_cell(*ff_index, ID($_DFFE_PN_), true, false, false, false, true, false);
+		find_cell(*ff_index, ID($_DFFE_PP_), true, false, false, false, true, true);
+
+		find_cell_sr(*ff_index, ID($_DFFSR_NNN_), false, false, false, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_NNP_), false, false, true, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_NPN_), false, true, false, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_NPP_), false, true, true, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_PNN_), true, false, false, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_PNP_), true, false, true, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_PPN_), true, true, false, false, false);
+		find_cell_sr(*ff_index, ID($_DFFSR_PPP_), true, true, true, false, false);
 
 		log("  final dff cell mappings:\n");
 		logmap_all();
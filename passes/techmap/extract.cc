@@ -332,6 +332,22 @@ RTLIL::Cell *replace(RTLIL::Module *needle, RTLIL::Module *haystack, SubCircuit:
 	return cell;
 }
 
+// Cache of parsed map designs and compiled needle graphs, keyed by the
+// content hash of the map files. Reading, elaborating and compiling the
+// needle library dominates repeated extract runs with large map files.
+// The cached design owns the modules that the graph userData pointers
+// and the replace() step refer to, so it stays alive for the rest of the
+// session. Maps given as in-session designs (`%name') are not cached, as
+// their content can change without a file hash noticing.
+struct ExtractNeedleCacheEntry {
+	std::string key;
+	RTLIL::Design *map;
+	std::vector<std::pair<std::string, SubCircuit::Graph>> graphs;
+	std::vector<RTLIL::IdString> graph_modules;
+};
+
+static std::vector<ExtractNeedleCacheEntry> extract_needle_cache;
+
 bool compareSortNeedleList(RTLIL::Module *left, RTLIL::Module *right)
 {
 	int left_idx = 0, right_idx = 0;
@@ -583,7 +599,43 @@ struct ExtractPass : public Pass {
 
 		RTLIL::Design *map = nullptr;
 
-		if (!mine_mode)
+		bool cacheable = !mine_mode;
+		std::string cache_key;
+		ExtractNeedleCacheEntry *cache_hit = nullptr;
+
+		if (cacheable)
+		{
+			Hasher h;
+			h.eat(constports ? 1 : 0);
+			for (auto &filename : map_filenames) {
+				if (filename.compare(0, 1, "%") == 0) {
+					cacheable = false;
+					break;
+				}
+				std::string fn = filename;
+				rewrite_filename(fn);
+				std::ifstream f(fn.c_str(), std::ifstream::binary);
+				if (f.fail()) {
+					cacheable = false;
+					break;
+				}
+				std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+				h.eat(filename);
+				h.eat(data);
+			}
+			if (cacheable) {
+				cache_key = stringf("%08x", (unsigned int)h.yield());
+				for (auto &entry : extract_needle_cache)
+					if (entry.key == cache_key)
+						cache_hit = &entry;
+			}
+		}
+
+		if (cache_hit != nullptr)
+		{
+			map = cache_hit->map;
+		}
+		else if (!mine_mode)
 		{
 			map = new RTLIL::Design;
 			for (auto &filename : map_filenames)
@@ -623,7 +675,23 @@ struct ExtractPass : public Pass {
 
 		log_header(design, "Creating graphs for SubCircuit library.\n");
 
-		if (!mine_mode)
+		if (cache_hit != nullptr)
+		{
+			log("Reusing %d cached needle graphs.\n", GetSize(cache_hit->graphs));
+			for (int i = 0; i < GetSize(cache_hit->graphs); i++) {
+				auto &it = cache_hit->graphs[i];
+				solver.addGraph(it.first, it.second);
+				RTLIL::Module *module = map->module(cache_hit->graph_modules[i]);
+				needle_map[it.first] = module;
+				needle_list.push_back(module);
+			}
+		}
+		else if (!mine_mode)
+		{
+			ExtractNeedleCacheEntry cache_entry;
+			cache_entry.key = cache_key;
+			cache_entry.map = map;
+
 			for (auto module : map->modules()) {
 				SubCircuit::Graph mod_graph;
 				std::string graph_name = "needle_" + RTLIL::unescape_id(module->name);
@@ -632,9 +700,17 @@ struct ExtractPass : public Pass {
 					solver.addGraph(graph_name, mod_graph);
 					needle_map[graph_name] = module;
 					needle_list.push_back(module);
+					if (cacheable) {
+						cache_entry.graphs.emplace_back(graph_name, mod_graph);
+						cache_entry.graph_modules.push_back(module->name);
+					}
 				}
 			}
 
+			if (cacheable)
+				extract_needle_cache.push_back(std::move(cache_entry));
+		}
+
 		for (auto module : design->modules()) {
 			SubCircuit::Graph mod_graph;
 			std::string graph_name = "haystack_" + RTLIL::unescape_id(module->name);
@@ -749,7 +825,9 @@ struct ExtractPass : public Pass {
 			f.close();
 		}
 
-		delete map;
+		// a cached map design stays alive for later reuse
+		if (!cacheable)
+			delete map;
 		log_pop();
 	}
 } ExtractPass;
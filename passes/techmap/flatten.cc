@@ -28,23 +28,73 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
-IdString concat_name(RTLIL::Cell *cell, IdString object_name)
+// Data about a flattening template (the module replacing its instances) that
+// is identical for every instance: the positional port map, the set of bits
+// driven inside the template, and the name suffixes handed to HierNameMap.
+// Designs commonly instantiate the same leaf module thousands of times, so
+// computing this once per module instead of once per instance removes most
+// of the per-instance analysis cost.
+struct FlattenTemplate
 {
-	if (object_name[0] == '\\')
-		return stringf("%s.%s", cell->name.c_str(), object_name.c_str() + 1);
-	else {
+	dict<IdString, IdString> positional_ports;
+	pool<SigBit> tpl_driven;
+	// maps an object name to (is public, suffix for HierNameMap)
+	dict<IdString, std::pair<bool, std::string>> name_suffixes;
+
+	void add_suffix(IdString object_name)
+	{
+		if (name_suffixes.count(object_name))
+			return;
+		if (object_name[0] == '\\') {
+			name_suffixes[object_name] = std::make_pair(true, std::string(object_name.c_str() + 1));
+		} else {
+			std::string object_name_str = object_name.str();
+			if (object_name_str.substr(0, 8) == "$flatten")
+				object_name_str.erase(0, 8);
+			name_suffixes[object_name] = std::make_pair(false, std::move(object_name_str));
+		}
+	}
+};
+
+// Builds the hierarchical names for the objects pulled out of a flattened
+// cell. Both name prefixes are set up once per cell, so producing a name
+// costs a suffix append in IdString::Builder instead of a stringf() and a
+// fresh global id lookup per object.
+struct HierNameMap
+{
+	IdString::Builder public_names, private_names;
+	RTLIL::Module *module;
+
+	HierNameMap(RTLIL::Cell *cell) : module(cell->module)
+	{
+		public_names.set_prefix(cell->name.str() + ".");
+		private_names.set_prefix(stringf("$flatten%s.", cell->name.c_str()));
+	}
+
+	IdString concat_name(IdString object_name)
+	{
+		if (object_name[0] == '\\')
+			return public_names(object_name.c_str() + 1);
 		std::string object_name_str = object_name.str();
 		if (object_name_str.substr(0, 8) == "$flatten")
 			object_name_str.erase(0, 8);
-		return stringf("$flatten%s.%s", cell->name.c_str(), object_name_str.c_str());
+		return private_names(object_name_str);
 	}
-}
 
-template<class T>
-IdString map_name(RTLIL::Cell *cell, T *object)
-{
-	return cell->module->uniquify(concat_name(cell, object->name));
-}
+	IdString concat_name(const FlattenTemplate *ft, IdString object_name)
+	{
+		auto it = ft->name_suffixes.find(object_name);
+		if (it == ft->name_suffixes.end())
+			return concat_name(object_name);
+		return it->second.first ? public_names(it->second.second) : private_names(it->second.second);
+	}
+
+	template<class T>
+	IdString map_name(const FlattenTemplate *ft, T *object)
+	{
+		return module->uniquify(concat_name(ft, object->name));
+	}
+};
 
 void map_sigspec(const dict<RTLIL::Wire*, RTLIL::Wire*> &map, RTLIL::SigSpec &sig, RTLIL::Module *into = nullptr)
 {
@@ -61,6 +111,44 @@ struct FlattenWorker
 	bool create_scopeinfo = true;
 	bool create_scopename = false;
 
+	// Template modules are never modified while they are being instantiated
+	// (topological sorting flattens a module before any of its users), so
+	// the per-template data stays valid for the whole pass.
+	dict<RTLIL::Module*, FlattenTemplate> template_cache;
+
+	FlattenTemplate *get_template(RTLIL::Module *tpl)
+	{
+		auto cache_it = template_cache.find(tpl);
+		if (cache_it != template_cache.end())
+			return &cache_it->second;
+
+		FlattenTemplate &ft = template_cache[tpl];
+
+		for (auto tpl_wire : tpl->wires()) {
+			if (tpl_wire->port_id > 0)
+				ft.positional_ports.emplace(stringf("$%d", tpl_wire->port_id), tpl_wire->name);
+			ft.add_suffix(tpl_wire->name);
+		}
+
+		for (auto tpl_cell : tpl->cells()) {
+			for (auto &tpl_conn : tpl_cell->connections())
+				if (tpl_cell->output(tpl_conn.first))
+					for (auto bit : tpl_conn.second)
+						ft.tpl_driven.insert(bit);
+			ft.add_suffix(tpl_cell->name);
+		}
+		for (auto &tpl_conn : tpl->connections())
+			for (auto bit : tpl_conn.first)
+				ft.tpl_driven.insert(bit);
+
+		for (auto &tpl_memory_it : tpl->memories)
+			ft.add_suffix(tpl_memory_it.first);
+		for (auto &tpl_proc_it : tpl->processes)
+			ft.add_suffix(tpl_proc_it.first);
+
+		return &ft;
+	}
+
 	template<class T>
 	void map_attributes(RTLIL::Cell *cell, T *object, IdString orig_object_name)
 	{
@@ -111,23 +199,23 @@ struct FlattenWorker
 	{
 		// Copy the contents of the flattened cell
 
+		const FlattenTemplate *ft = get_template(tpl);
+
+		HierNameMap hier_names(cell);
 		dict<IdString, IdString> memory_map;
 		for (auto &tpl_memory_it : tpl->memories) {
-			RTLIL::Memory *new_memory = module->addMemory(map_name(cell, tpl_memory_it.second), tpl_memory_it.second);
+			RTLIL::Memory *new_memory = module->addMemory(hier_names.map_name(ft, tpl_memory_it.second), tpl_memory_it.second);
 			map_attributes(cell, new_memory, tpl_memory_it.second->name);
 			memory_map[tpl_memory_it.first] = new_memory->name;
 			design->select(module, new_memory);
 		}
 
 		dict<RTLIL::Wire*, RTLIL::Wire*> wire_map;
-		dict<IdString, IdString> positional_ports;
+		module->reserve_new_wires(GetSize(tpl->wires_));
 		for (auto tpl_wire : tpl->wires()) {
-			if (tpl_wire->port_id > 0)
-				positional_ports.emplace(stringf("$%d", tpl_wire->port_id), tpl_wire->name);
-
 			RTLIL::Wire *new_wire = nullptr;
 			if (tpl_wire->name[0] == '\\') {
-				RTLIL::Wire *hier_wire = module->wire(concat_name(cell, tpl_wire->name));
+				RTLIL::Wire *hier_wire = module->wire(hier_names.concat_name(ft, tpl_wire->name));
 				if (hier_wire != nullptr && hier_wire->get_bool_attribute(ID::hierconn)) {
 					hier_wire->attributes.erase(ID::hierconn);
 					if (GetSize(hier_wire) < GetSize(tpl_wire)) {
@@ -139,7 +227,7 @@ struct FlattenWorker
 				}
 			}
 			if (new_wire == nullptr) {
-				new_wire = module->addWire(map_name(cell, tpl_wire), tpl_wire);
+				new_wire = module->addWire(hier_names.map_name(ft, tpl_wire), tpl_wire);
 				new_wire->port_input = new_wire->port_output = false;
 				new_wire->port_id = false;
 			}
@@ -150,7 +238,7 @@ struct FlattenWorker
 		}
 
 		for (auto &tpl_proc_it : tpl->processes) {
-			RTLIL::Process *new_proc = module->addProcess(map_name(cell, tpl_proc_it.second), tpl_proc_it.second);
+			RTLIL::Process *new_proc = module->addProcess(hier_names.map_name(ft, tpl_proc_it.second), tpl_proc_it.second);
 			map_attributes(cell, new_proc, tpl_proc_it.second->name);
 			for (auto new_proc_sync : new_proc->syncs)
 				for (auto &memwr_action : new_proc_sync->mem_write_actions)
@@ -161,14 +249,14 @@ struct FlattenWorker
 		}
 
 		for (auto tpl_cell : tpl->cells()) {
-			RTLIL::Cell *new_cell = module->addCell(map_name(cell, tpl_cell), tpl_cell);
+			RTLIL::Cell *new_cell = module->addCell(hier_names.map_name(ft, tpl_cell), tpl_cell);
 			map_attributes(cell, new_cell, tpl_cell->name);
 			if (new_cell->has_memid()) {
 				IdString memid = new_cell->getParam(ID::MEMID).decode_string();
 				new_cell->setParam(ID::MEMID, Const(memory_map.at(memid).str()));
 			} else if (new_cell->is_mem_cell()) {
 				IdString memid = new_cell->getParam(ID::MEMID).decode_string();
-				new_cell->setParam(ID::MEMID, Const(concat_name(cell, memid).str()));
+				new_cell->setParam(ID::MEMID, Const(hier_names.concat_name(memid).str()));
 			}
 			auto rewriter = [&](RTLIL::SigSpec &sig) { map_sigspec(wire_map, sig); };
 			new_cell->rewrite_sigspecs(rewriter);
@@ -185,21 +273,11 @@ struct FlattenWorker
 
 		// Attach port connections of the flattened cell
 
-		pool<SigBit> tpl_driven;
-		for (auto tpl_cell : tpl->cells())
-			for (auto &tpl_conn : tpl_cell->connections())
-				if (tpl_cell->output(tpl_conn.first))
-					for (auto bit : tpl_conn.second)
-						tpl_driven.insert(bit);
-		for (auto &tpl_conn : tpl->connections())
-			for (auto bit : tpl_conn.first)
-				tpl_driven.insert(bit);
-
 		for (auto &port_it : cell->connections())
 		{
 			IdString port_name = port_it.first;
-			if (positional_ports.count(port_name) > 0)
-				port_name = positional_ports.at(port_name);
+			if (ft->positional_ports.count(port_name) > 0)
+				port_name = ft->positional_ports.at(port_name);
 			if (tpl->wire(port_name) == nullptr || tpl->wire(port_name)->port_id == 0) {
 				if (port_name.begins_with("$"))
 					log_error("Can't map port `%s' of cell `%s' to template `%s'!\n",
@@ -224,7 +302,7 @@ struct FlattenWorker
 			} else {
 				SigSpec sig_tpl = tpl_wire, sig_mod = port_it.second;
 				for (int i = 0; i < GetSize(sig_tpl) && i < GetSize(sig_mod); i++) {
-					if (tpl_driven.count(sig_tpl[i])) {
+					if (ft->tpl_driven.count(sig_tpl[i])) {
 						new_conn.first.append(sig_mod[i]);
 						new_conn.second.append(sig_tpl[i]);
 					} else {
@@ -20,6 +20,7 @@
 #include "libparse.h"
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include <istream>
 #include <fstream>
@@ -332,10 +333,8 @@ int LibertyParser::lexer(std::string &str)
 	return c;
 }
 
-LibertyAst *LibertyParser::parse()
+bool LibertyParser::parse_id(std::string &str)
 {
-	std::string str;
-
 	int tok = lexer(str);
 
 	// there are liberty files in the wild that
@@ -347,7 +346,7 @@ LibertyAst *LibertyParser::parse()
 		tok = lexer(str);
 
 	if (tok == '}' || tok < 0)
-		return NULL;
+		return false;
 
 	if (tok != 'v') {
 		std::string eReport;
@@ -372,17 +371,22 @@ LibertyAst *LibertyParser::parse()
 		}
 	}
 
-	LibertyAst *ast = new LibertyAst;
-	ast->id = str;
+	return true;
+}
+
+bool LibertyParser::parse_head(LibertyAst *ast)
+{
+	std::string str;
+	int tok;
 
 	while (1)
 	{
 		tok = lexer(str);
 
-		// allow both ';' and new lines to 
+		// allow both ';' and new lines to
 		// terminate a statement.
 		if ((tok == ';') || (tok == 'n'))
-			break;
+			return false;
 
 		if (tok == ':' && ast->value.empty()) {
 			tok = lexer(ast->value);
@@ -397,13 +401,13 @@ LibertyAst *LibertyParser::parse()
 				ast->value += str;
 				tok = lexer(str);
 			}
-			
+
 			// In a liberty file, all key : value pairs should end in ';'
 			// However, there are some liberty files in the wild that
 			// just have a newline. We'll be kind and accept a newline
 			// instead of the ';' too..
 			if ((tok == ';') || (tok == 'n'))
-				break;
+				return false;
 			else
 				error();
 			continue;
@@ -485,22 +489,64 @@ LibertyAst *LibertyParser::parse()
 			continue;
 		}
 
-		if (tok == '{') {
-			while (1) {
-				LibertyAst *child = parse();
-				if (child == NULL)
-					break;
-				ast->children.push_back(child);
-			}
-			break;
-		}
+		if (tok == '{')
+			return true;
 
 		error();
 	}
+}
+
+LibertyAst *LibertyParser::parse_rest(const std::string &id)
+{
+	LibertyAst *ast = new LibertyAst;
+	ast->id = id;
+
+	if (parse_head(ast)) {
+		while (1) {
+			LibertyAst *child = parse();
+			if (child == NULL)
+				break;
+			ast->children.push_back(child);
+		}
+	}
 
 	return ast;
 }
 
+LibertyAst *LibertyParser::parse()
+{
+	std::string str;
+
+	if (!parse_id(str))
+		return NULL;
+
+	return parse_rest(str);
+}
+
+LibertyAstCache LibertyAstCache::instance;
+
+std::shared_ptr<const LibertyAst> LibertyAstCache::get(const std::string &path)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return nullptr;
+
+	auto it = entries.find(path);
+	if (it != entries.end() && it->second.size == (int64_t)st.st_size && it->second.mtime == (int64_t)st.st_mtime)
+		return it->second.ast;
+
+	std::ifstream f(path.c_str());
+	if (f.fail())
+		return nullptr;
+
+	LibertyParser parser(f);
+	std::shared_ptr<const LibertyAst> ast(parser.ast);
+	parser.ast = nullptr;
+
+	entries[path] = Entry{ast, (int64_t)st.st_size, (int64_t)st.st_mtime};
+	return ast;
+}
+
 #ifndef FILTERLIB
 
 void LibertyParser::error() const
@@ -518,6 +564,8 @@ void LibertyParser::error(const std::string &str) const
 
 #else
 
+#include <thread>
+
 void LibertyParser::error() const
 {
 	fprintf(stderr, "Syntax error in liberty file on line %d.\n", line);
@@ -808,118 +856,271 @@ void gen_verilogsim(const LibertyAst *ast)
 			gen_verilogsim_cell(child);
 }
 
+// Streaming rewrite mode: copies one liberty file through the blacklist /
+// whitelist filter without ever materializing the full AST. The top-level
+// statement head is parsed normally, then its children (the cells, mostly)
+// are parsed, dumped and freed one at a time; children the filter drops are
+// skipped at token level with a brace counter, so dropped cells never build
+// their subtree at all.
+struct LibertyStreamFilter
+{
+	LibertyParser parser;
+	LibertyAst::sieve &blacklist, &whitelist;
+	FILE *fout;
+
+	LibertyStreamFilter(std::istream &f, LibertyAst::sieve &blacklist, LibertyAst::sieve &whitelist, FILE *fout) :
+			parser(f, LibertyParser::defer_t()), blacklist(blacklist), whitelist(whitelist), fout(fout) { }
+
+	// consume the tokens of a '{ ... }' body whose opening brace was
+	// already read
+	void skip_body()
+	{
+		std::string str;
+		int depth = 1;
+		while (depth > 0) {
+			int tok = parser.lexer(str);
+			if (tok == '{')
+				depth++;
+			else if (tok == '}')
+				depth--;
+			else if (tok < 0)
+				parser.error("Unexpected end of file in skipped group.");
+		}
+	}
+
+	// same filter rule as LibertyAst::dump(), including the automatic
+	// blacklisting of ids the whitelist does not know
+	bool filter_keep(const std::string &id, std::string path, bool path_ok)
+	{
+		path += "/" + id;
+		if (blacklist.count(id) > 0 || blacklist.count(path) > 0)
+			return false;
+		if (whitelist.size() > 0 && whitelist.count(id) == 0 && whitelist.count(path) == 0 && !path_ok) {
+			fprintf(stderr, "Automatically added to blacklist: %s\n", path.c_str());
+			blacklist.insert(id);
+			return false;
+		}
+		return true;
+	}
+
+	void run()
+	{
+		std::string top_id;
+		if (!parser.parse_id(top_id))
+			return;
+
+		LibertyAst header;
+		header.id = top_id;
+		bool has_body = parser.parse_head(&header);
+
+		bool path_ok = whitelist.count("/*") > 0;
+		if (!filter_keep(top_id, "", path_ok)) {
+			if (has_body)
+				skip_body();
+			return;
+		}
+
+		fprintf(fout, "%s", top_id.c_str());
+		if (!header.args.empty() || has_body) {
+			fprintf(fout, "(");
+			for (size_t i = 0; i < header.args.size(); i++)
+				fprintf(fout, "%s%s", i > 0 ? ", " : "", header.args[i].c_str());
+			fprintf(fout, ")");
+		}
+		if (!header.value.empty())
+			fprintf(fout, " : %s", header.value.c_str());
+		if (!has_body) {
+			fprintf(fout, " ;\n");
+			return;
+		}
+		fprintf(fout, " {\n");
+
+		std::string top_path = "/" + top_id;
+		bool child_ok = path_ok || whitelist.count(top_path + "/*") > 0;
+
+		std::string child_id;
+		while (parser.parse_id(child_id)) {
+			if (!filter_keep(child_id, top_path, child_ok)) {
+				LibertyAst dropped;
+				dropped.id = child_id;
+				if (parser.parse_head(&dropped))
+					skip_body();
+				continue;
+			}
+			LibertyAst *child = parser.parse_rest(child_id);
+			child->dump(fout, blacklist, whitelist, "  ", top_path, child_ok);
+			delete child;
+		}
+
+		fprintf(fout, "}\n");
+	}
+};
+
 void usage()
 {
-	fprintf(stderr, "Usage: filterlib [rules-file [liberty-file]]\n");
-	fprintf(stderr, "   or: filterlib -verilogsim [liberty-file]\n");
+	fprintf(stderr, "Usage: filterlib [rules-file [liberty-file..]]\n");
+	fprintf(stderr, "   or: filterlib -verilogsim [liberty-file..]\n");
+	fprintf(stderr, "   or: filterlib -stream [rules-file [liberty-file..]]\n");
 	exit(1);
 }
 
 int main(int argc, char **argv)
 {
 	bool flag_verilogsim = false;
+	bool flag_stream = false;
 	std::set<std::string> whitelist, blacklist;
 
-	if (argc > 3)
-		usage();
+	int argidx = 1;
+	if (argidx < argc && !strcmp(argv[argidx], "-verilogsim")) {
+		flag_verilogsim = true;
+		argidx++;
+	} else if (argidx < argc && !strcmp(argv[argidx], "-stream")) {
+		flag_stream = true;
+		argidx++;
+	}
 
-	if (argc > 1)
+	if (flag_verilogsim || (argidx < argc && !strcmp(argv[argidx], "-")))
 	{
-		if (!strcmp(argv[1], "-verilogsim"))
-			flag_verilogsim = true;
-		if (!strcmp(argv[1], "-") || !strcmp(argv[1], "-verilogsim"))
-		{
-			whitelist.insert("/library");
-			whitelist.insert("/library/cell");
-			whitelist.insert("/library/cell/area");
-			whitelist.insert("/library/cell/cell_footprint");
-			whitelist.insert("/library/cell/dont_touch");
-			whitelist.insert("/library/cell/dont_use");
-			whitelist.insert("/library/cell/ff");
-			whitelist.insert("/library/cell/ff/*");
-			whitelist.insert("/library/cell/latch");
-			whitelist.insert("/library/cell/latch/*");
-			whitelist.insert("/library/cell/pin");
-			whitelist.insert("/library/cell/pin/clock");
-			whitelist.insert("/library/cell/pin/direction");
-			whitelist.insert("/library/cell/pin/driver_type");
-			whitelist.insert("/library/cell/pin/function");
-			whitelist.insert("/library/cell/pin_opposite");
-			whitelist.insert("/library/cell/pin/state_function");
-			whitelist.insert("/library/cell/pin/three_state");
-			whitelist.insert("/library/cell/statetable");
-			whitelist.insert("/library/cell/statetable/*");
+		if (!flag_verilogsim)
+			argidx++;
+		whitelist.insert("/library");
+		whitelist.insert("/library/cell");
+		whitelist.insert("/library/cell/area");
+		whitelist.insert("/library/cell/cell_footprint");
+		whitelist.insert("/library/cell/dont_touch");
+		whitelist.insert("/library/cell/dont_use");
+		whitelist.insert("/library/cell/ff");
+		whitelist.insert("/library/cell/ff/*");
+		whitelist.insert("/library/cell/latch");
+		whitelist.insert("/library/cell/latch/*");
+		whitelist.insert("/library/cell/pin");
+		whitelist.insert("/library/cell/pin/clock");
+		whitelist.insert("/library/cell/pin/direction");
+		whitelist.insert("/library/cell/pin/driver_type");
+		whitelist.insert("/library/cell/pin/function");
+		whitelist.insert("/library/cell/pin_opposite");
+		whitelist.insert("/library/cell/pin/state_function");
+		whitelist.insert("/library/cell/pin/three_state");
+		whitelist.insert("/library/cell/statetable");
+		whitelist.insert("/library/cell/statetable/*");
+	}
+	else if (argidx < argc)
+	{
+		FILE *f = fopen(argv[argidx], "r");
+		if (f == NULL) {
+			fprintf(stderr, "Can't open rules file `%s'.\n", argv[argidx]);
+			usage();
 		}
-		else
-		{
-			FILE *f = fopen(argv[1], "r");
-			if (f == NULL) {
-				fprintf(stderr, "Can't open rules file `%s'.\n", argv[1]);
-				usage();
-			}
+		argidx++;
 
-			char buffer[1024];
-			while (fgets(buffer, 1024, f) != NULL)
+		char buffer[1024];
+		while (fgets(buffer, 1024, f) != NULL)
+		{
+			char mode = 0;
+			std::string id;
+			for (char *p = buffer; *p; p++)
 			{
-				char mode = 0;
-				std::string id;
-				for (char *p = buffer; *p; p++)
-				{
-					if (*p == '-' || *p == '+') {
-						if (mode != 0)
+				if (*p == '-' || *p == '+') {
+					if (mode != 0)
+						goto syntax_error;
+					mode = *p;
+					continue;
+				}
+				if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '#') {
+					if (!id.empty()) {
+						if (mode == '-')
+							blacklist.insert(id);
+						else
+						if (mode == '+')
+							whitelist.insert(id);
+						else
 							goto syntax_error;
-						mode = *p;
-						continue;
-					}
-					if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '#') {
-						if (!id.empty()) {
-							if (mode == '-')
-								blacklist.insert(id);
-							else
-							if (mode == '+')
-								whitelist.insert(id);
-							else
-								goto syntax_error;
-						}
-						id.clear();
-						if (*p == '#')
-							break;
-						continue;
 					}
-					id += *p;
+					id.clear();
+					if (*p == '#')
+						break;
 					continue;
-
-				syntax_error:
-					fprintf(stderr, "Syntax error in rules file:\n%s", buffer);
-					exit(1);
 				}
+				id += *p;
+				continue;
+
+			syntax_error:
+				fprintf(stderr, "Syntax error in rules file:\n%s", buffer);
+				exit(1);
 			}
 		}
+		fclose(f);
 	}
 
-	std::istream *f = &std::cin;
+	// the remaining arguments name the liberty files, default is stdin
+	std::vector<std::string> files(argv + argidx, argv + argc);
 
-	if (argc == 3) {
-		std::ifstream *ff = new std::ifstream;
-		ff->open(argv[2]);
-		if (ff->fail()) {
-			delete ff;
-			fprintf(stderr, "Can't open liberty file `%s'.\n", argv[2]);
-			usage();
+	if (flag_stream && flag_verilogsim)
+		usage();
+
+	if (flag_stream) {
+		if (files.empty()) {
+			LibertyStreamFilter filter(std::cin, blacklist, whitelist, stdout);
+			filter.run();
+			return 0;
+		}
+		for (auto &filename : files) {
+			std::ifstream ff(filename);
+			if (ff.fail()) {
+				fprintf(stderr, "Can't open liberty file `%s'.\n", filename.c_str());
+				usage();
+			}
+			LibertyStreamFilter filter(ff, blacklist, whitelist, stdout);
+			filter.run();
 		}
-		f = ff;
+		return 0;
 	}
 
-	LibertyParser parser(*f);
-	if (parser.ast) {
-		if (flag_verilogsim)
-			gen_verilogsim(parser.ast);
-		else
-			parser.ast->dump(stdout, blacklist, whitelist);
+	if (files.empty()) {
+		LibertyParser parser(std::cin);
+		if (parser.ast) {
+			if (flag_verilogsim)
+				gen_verilogsim(parser.ast);
+			else
+				parser.ast->dump(stdout, blacklist, whitelist);
+		}
+		return 0;
 	}
 
-	if (argc == 3)
-		delete f;
+	// parse all files up front, one thread per file; dumping stays serial
+	// and in command-line order
+	std::vector<std::unique_ptr<std::ifstream>> streams(files.size());
+	std::vector<std::unique_ptr<LibertyParser>> parsers(files.size());
+
+	for (size_t i = 0; i < files.size(); i++) {
+		streams[i].reset(new std::ifstream(files[i]));
+		if (streams[i]->fail()) {
+			fprintf(stderr, "Can't open liberty file `%s'.\n", files[i].c_str());
+			usage();
+		}
+	}
+
+	if (files.size() > 1) {
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < files.size(); i++)
+			threads.emplace_back([&parsers, &streams, i]() {
+				parsers[i].reset(new LibertyParser(*streams[i]));
+			});
+		for (auto &thread : threads)
+			thread.join();
+	} else
+		parsers[0].reset(new LibertyParser(*streams[0]));
+
+	for (size_t i = 0; i < files.size(); i++) {
+		if (parsers[i]->ast) {
+			if (flag_verilogsim)
+				gen_verilogsim(parsers[i]->ast);
+			else
+				parsers[i]->ast->dump(stdout, blacklist, whitelist);
+		}
+		parsers[i].reset();
+		streams[i].reset();
+	}
 
 	return 0;
 }
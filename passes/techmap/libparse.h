@@ -25,6 +25,10 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
+#include <memory>
+
+struct LibertyStreamFilter;
 
 namespace Yosys
 {
@@ -90,6 +94,7 @@ namespace Yosys
 	class LibertyParser
 	{
 		friend class LibertyMergedCells;
+		friend struct ::LibertyStreamFilter;
 	private:
 		std::istream &f;
 		int line;
@@ -101,6 +106,14 @@ namespace Yosys
 		*/
 		int lexer(std::string &str);
 
+		/* parse() is split in three pieces so yosys-filterlib can stream
+		   statements one at a time: parse_id() reads the next statement name
+		   (false at the end of the enclosing group), parse_head() reads the
+		   value/argument part and returns true when a '{ ... }' body follows,
+		   parse_rest() builds the complete statement for a name already read. */
+		bool parse_id(std::string &str);
+		bool parse_head(LibertyAst *ast);
+		LibertyAst *parse_rest(const std::string &id);
 		LibertyAst *parse();
 		void error() const;
 		void error(const std::string &str) const;
@@ -109,37 +122,67 @@ namespace Yosys
 		const LibertyAst *ast;
 
 		LibertyParser(std::istream &f) : f(f), line(1), ast(parse()) {}
+		/* deferred form for streaming consumers: nothing is parsed up front */
+		struct defer_t {};
+		LibertyParser(std::istream &f, defer_t) : f(f), line(1), ast(nullptr) {}
 		~LibertyParser() { if (ast) delete ast; }
 	};
 
 	class LibertyMergedCells
 	{
-		std::vector<const LibertyAst *> asts;
+		std::vector<std::shared_ptr<const LibertyAst>> asts;
+
+		void add(std::shared_ptr<const LibertyAst> ast)
+		{
+			asts.push_back(ast);
+			if (ast->id != "library")
+				log_error("Top level entity isn't \"library\".\n");
+			for (const LibertyAst *cell : ast->children)
+				if (cell->id == "cell" && cell->args.size() == 1)
+					cells.push_back(cell);
+		}
 
 	public:
 		std::vector<const LibertyAst *> cells;
 		void merge(LibertyParser &parser)
 		{
 			if (parser.ast) {
-				const LibertyAst *ast = parser.ast;
-				asts.push_back(ast);
 				// The parser no longer owns its top level ast, but we do.
 				// sketchy zone
+				std::shared_ptr<const LibertyAst> ast(parser.ast);
 				parser.ast = nullptr;
-				if (ast->id != "library")
-					parser.error("Top level entity isn't \"library\".\n");
-				for (const LibertyAst *cell : ast->children)
-					if (cell->id == "cell" && cell->args.size() == 1)
-						cells.push_back(cell);
+				add(ast);
 			}
 		}
-		~LibertyMergedCells()
+		void merge(std::shared_ptr<const LibertyAst> ast)
 		{
-			for (auto ast : asts)
-				delete ast;
+			if (ast)
+				add(ast);
 		}
 	};
 
+	// Process-wide cache of parsed Liberty files, shared by the passes that
+	// query Liberty data (dfflibmap, clockgate, ...). Entries are keyed by
+	// filename and revalidated against the file's size and mtime, so a
+	// library is parsed once per version instead of once per pass per run.
+	class LibertyAstCache
+	{
+		struct Entry {
+			std::shared_ptr<const LibertyAst> ast;
+			int64_t size;
+			int64_t mtime;
+		};
+		std::map<std::string, Entry> entries;
+
+	public:
+		// Returns the parsed library for `path', reusing the cached AST if
+		// the file is unchanged. Returns nullptr if the file can't be opened.
+		std::shared_ptr<const LibertyAst> get(const std::string &path);
+		void clear() { entries.clear(); }
+
+		static LibertyAstCache instance;
+	};
+
 }
 
 #endif
@@ -183,14 +183,14 @@ struct MuxcoverWorker
 			return 0;
 
 		tuple<SigBit, SigBit, SigBit> key(A, B, sel);
-		if (decode_mux_cache.count(key) == 0) {
-			auto &entry = decode_mux_cache[key];
+		auto insertion = decode_mux_cache.emplace(key, tuple<SigBit, pool<SigBit>, bool>());
+		auto &entry = insertion.first->second;
+		if (insertion.second) {
 			std::get<0>(entry) = module->addWire(NEW_ID);
 			std::get<2>(entry) = false;
 			decode_mux_reverse_cache[std::get<0>(entry)] = key;
 		}
 
-		auto &entry = decode_mux_cache[key];
 		A = std::get<0>(entry);
 		std::get<1>(entry).insert(bit);
 
@@ -202,11 +202,12 @@ struct MuxcoverWorker
 
 	void implement_decode_mux(SigBit ctrl_bit)
 	{
-		if (decode_mux_reverse_cache.count(ctrl_bit) == 0)
+		auto found = decode_mux_reverse_cache.find(ctrl_bit);
+		if (found == decode_mux_reverse_cache.end())
 			return;
 
-		auto &key = decode_mux_reverse_cache.at(ctrl_bit);
-		auto &entry = decode_mux_cache[key];
+		auto &key = found->second;
+		auto &entry = decode_mux_cache.at(key);
 
 		if (std::get<2>(entry))
 			return;
@@ -234,7 +235,15 @@ struct MuxcoverWorker
 	int sum_best_covers(tree_t &tree, const vector<SigBit> &bits)
 	{
 		int sum = 0;
-		for (auto bit : pool<SigBit>(bits.begin(), bits.end())) {
+		for (int i = 0; i < GetSize(bits); i++) {
+			// count each distinct input once; the list has at most 16 entries,
+			// so a linear duplicate scan beats building a pool per candidate
+			SigBit bit = bits[i];
+			bool duplicate = false;
+			for (int j = 0; j < i && !duplicate; j++)
+				duplicate = bits[j] == bit;
+			if (duplicate)
+				continue;
 			int cost = tree.newmuxes.at(bit).cost;
 			log_debug("        Best cost for %s: %d\n", log_signal(bit), cost);
 			sum += cost;
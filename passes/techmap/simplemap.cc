@@ -37,8 +37,8 @@ void simplemap_not(RTLIL::Module *module, RTLIL::Cell *cell)
 	for (int i = 0; i < GetSize(sig_y); i++) {
 		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_NOT_));
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a[i]);
-		gate->setPort(ID::Y, sig_y[i]);
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::Y, sig_y[i]}});
+		module->strashCell(gate);
 	}
 }
 
@@ -74,9 +74,8 @@ void simplemap_bitop(RTLIL::Module *module, RTLIL::Cell *cell)
 	for (int i = 0; i < GetSize(sig_y); i++) {
 		RTLIL::Cell *gate = module->addCell(NEW_ID, gate_type);
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a[i]);
-		gate->setPort(ID::B, sig_b[i]);
-		gate->setPort(ID::Y, sig_y[i]);
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::B, sig_b[i]}, {ID::Y, sig_y[i]}});
+		module->strashCell(gate);
 	}
 }
 
@@ -111,6 +110,7 @@ void simplemap_reduce(RTLIL::Module *module, RTLIL::Cell *cell)
 	log_assert(!gate_type.empty());
 
 	RTLIL::Cell *last_output_cell = NULL;
+	bool last_output_merged = false;
 
 	while (sig_a.size() > 1)
 	{
@@ -125,10 +125,9 @@ void simplemap_reduce(RTLIL::Module *module, RTLIL::Cell *cell)
 
 			RTLIL::Cell *gate = module->addCell(NEW_ID, gate_type);
 			gate->attributes[ID::src] = cell->attributes[ID::src];
-			gate->setPort(ID::A, sig_a[i]);
-			gate->setPort(ID::B, sig_a[i+1]);
-			gate->setPort(ID::Y, sig_t[i/2]);
-			last_output_cell = gate;
+			gate->setPorts({{ID::A, sig_a[i]}, {ID::B, sig_a[i+1]}, {ID::Y, sig_t[i/2]}});
+			last_output_cell = module->strashCell(gate);
+			last_output_merged = last_output_cell != gate;
 		}
 
 		sig_a = sig_t;
@@ -138,14 +137,18 @@ void simplemap_reduce(RTLIL::Module *module, RTLIL::Cell *cell)
 		RTLIL::SigSpec sig_t = module->addWire(NEW_ID);
 		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_NOT_));
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a);
-		gate->setPort(ID::Y, sig_t);
-		last_output_cell = gate;
+		gate->setPorts({{ID::A, sig_a}, {ID::Y, sig_t}});
+		last_output_cell = module->strashCell(gate);
+		last_output_merged = last_output_cell != gate;
 		sig_a = sig_t;
 	}
 
 	if (last_output_cell == NULL) {
 		module->connect(RTLIL::SigSig(sig_y, sig_a));
+	} else if (last_output_merged) {
+		// the output gate is shared with a previous mapping and cannot be
+		// rewired to drive sig_y directly
+		module->connect(RTLIL::SigSig(sig_y, sig_a));
 	} else {
 		last_output_cell->setPort(ID::Y, sig_y);
 	}
@@ -166,9 +169,8 @@ static void logic_reduce(RTLIL::Module *module, RTLIL::SigSpec &sig, RTLIL::Cell
 
 			RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_OR_));
 			gate->attributes[ID::src] = cell->attributes[ID::src];
-			gate->setPort(ID::A, sig[i]);
-			gate->setPort(ID::B, sig[i+1]);
-			gate->setPort(ID::Y, sig_t[i/2]);
+			gate->setPorts({{ID::A, sig[i]}, {ID::B, sig[i+1]}, {ID::Y, sig_t[i/2]}});
+			module->strashCell(gate);
 		}
 
 		sig = sig_t;
@@ -195,8 +197,8 @@ void simplemap_lognot(RTLIL::Module *module, RTLIL::Cell *cell)
 
 	RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_NOT_));
 	gate->attributes[ID::src] = cell->attributes[ID::src];
-	gate->setPort(ID::A, sig_a);
-	gate->setPort(ID::Y, sig_y);
+	gate->setPorts({{ID::A, sig_a}, {ID::Y, sig_y}});
+	module->strashCell(gate);
 }
 
 void simplemap_logbin(RTLIL::Module *module, RTLIL::Cell *cell)
@@ -224,9 +226,8 @@ void simplemap_logbin(RTLIL::Module *module, RTLIL::Cell *cell)
 
 	RTLIL::Cell *gate = module->addCell(NEW_ID, gate_type);
 	gate->attributes[ID::src] = cell->attributes[ID::src];
-	gate->setPort(ID::A, sig_a);
-	gate->setPort(ID::B, sig_b);
-	gate->setPort(ID::Y, sig_y);
+	gate->setPorts({{ID::A, sig_a}, {ID::B, sig_b}, {ID::Y, sig_y}});
+	module->strashCell(gate);
 }
 
 void simplemap_eqne(RTLIL::Module *module, RTLIL::Cell *cell)
@@ -237,23 +238,38 @@ void simplemap_eqne(RTLIL::Module *module, RTLIL::Cell *cell)
 	bool is_signed = cell->parameters.at(ID::A_SIGNED).as_bool();
 	bool is_ne = cell->type.in(ID($ne), ID($nex));
 
-	RTLIL::SigSpec xor_out = module->addWire(NEW_ID, max(GetSize(sig_a), GetSize(sig_b)));
-	RTLIL::Cell *xor_cell = module->addXor(NEW_ID, sig_a, sig_b, xor_out, is_signed);
-	xor_cell->attributes[ID::src] = cell->attributes[ID::src];
-	simplemap_bitop(module, xor_cell);
-	module->remove(xor_cell);
-
-	RTLIL::SigSpec reduce_out = is_ne ? sig_y : module->addWire(NEW_ID);
-	RTLIL::Cell *reduce_cell = module->addReduceOr(NEW_ID, xor_out, reduce_out);
-	reduce_cell->attributes[ID::src] = cell->attributes[ID::src];
-	simplemap_reduce(module, reduce_cell);
-	module->remove(reduce_cell);
-
-	if (!is_ne) {
-		RTLIL::Cell *not_cell = module->addLogicNot(NEW_ID, reduce_out, sig_y);
-		not_cell->attributes[ID::src] = cell->attributes[ID::src];
-                simplemap_lognot(module, not_cell);
-		module->remove(not_cell);
+	if (GetSize(sig_y) == 0)
+		return;
+
+	// fused lowering: emit the per-bit XOR stage, the OR reduction tree and
+	// the final inverter directly, instead of building temporary $xor,
+	// $reduce_or and $logic_not cells only to map and remove them again
+	int width = max(GetSize(sig_a), GetSize(sig_b));
+	sig_a.extend_u0(width, is_signed);
+	sig_b.extend_u0(width, is_signed);
+
+	RTLIL::SigSpec sig_t = width > 0 ? RTLIL::SigSpec(module->addWire(NEW_ID, width)) : RTLIL::SigSpec();
+	for (int i = 0; i < width; i++) {
+		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_XOR_));
+		gate->attributes[ID::src] = cell->attributes[ID::src];
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::B, sig_b[i]}, {ID::Y, sig_t[i]}});
+		module->strashCell(gate);
+	}
+
+	logic_reduce(module, sig_t, cell);
+
+	if (GetSize(sig_y) > 1) {
+		module->connect(RTLIL::SigSig(sig_y.extract(1, GetSize(sig_y)-1), RTLIL::SigSpec(0, GetSize(sig_y)-1)));
+		sig_y = sig_y.extract(0, 1);
+	}
+
+	if (is_ne) {
+		module->connect(RTLIL::SigSig(sig_y, sig_t));
+	} else {
+		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_NOT_));
+		gate->attributes[ID::src] = cell->attributes[ID::src];
+		gate->setPorts({{ID::A, sig_t}, {ID::Y, sig_y}});
+		module->strashCell(gate);
 	}
 }
 
@@ -261,15 +277,14 @@ void simplemap_mux(RTLIL::Module *module, RTLIL::Cell *cell)
 {
 	RTLIL::SigSpec sig_a = cell->getPort(ID::A);
 	RTLIL::SigSpec sig_b = cell->getPort(ID::B);
+	RTLIL::SigSpec sig_s = cell->getPort(ID::S);
 	RTLIL::SigSpec sig_y = cell->getPort(ID::Y);
 
 	for (int i = 0; i < GetSize(sig_y); i++) {
 		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_MUX_));
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a[i]);
-		gate->setPort(ID::B, sig_b[i]);
-		gate->setPort(ID::S, cell->getPort(ID::S));
-		gate->setPort(ID::Y, sig_y[i]);
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::B, sig_b[i]}, {ID::S, sig_s}, {ID::Y, sig_y[i]}});
+		module->strashCell(gate);
 	}
 }
 
@@ -283,10 +298,8 @@ void simplemap_bwmux(RTLIL::Module *module, RTLIL::Cell *cell)
 	for (int i = 0; i < GetSize(sig_y); i++) {
 		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_MUX_));
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a[i]);
-		gate->setPort(ID::B, sig_b[i]);
-		gate->setPort(ID::S, sig_s[i]);
-		gate->setPort(ID::Y, sig_y[i]);
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::B, sig_b[i]}, {ID::S, sig_s[i]}, {ID::Y, sig_y[i]}});
+		module->strashCell(gate);
 	}
 }
 
@@ -299,9 +312,7 @@ void simplemap_tribuf(RTLIL::Module *module, RTLIL::Cell *cell)
 	for (int i = 0; i < GetSize(sig_y); i++) {
 		RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_TBUF_));
 		gate->attributes[ID::src] = cell->attributes[ID::src];
-		gate->setPort(ID::A, sig_a[i]);
-		gate->setPort(ID::E, sig_e);
-		gate->setPort(ID::Y, sig_y[i]);
+		gate->setPorts({{ID::A, sig_a[i]}, {ID::E, sig_e}, {ID::Y, sig_y[i]}});
 	}
 }
 
@@ -317,10 +328,8 @@ void simplemap_bmux(RTLIL::Module *module, RTLIL::Cell *cell)
 			for (int k = 0; k < width; k++) {
 				RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_MUX_));
 				gate->attributes[ID::src] = cell->attributes[ID::src];
-				gate->setPort(ID::A, data[i*2+k]);
-				gate->setPort(ID::B, data[i*2+width+k]);
-				gate->setPort(ID::S, sel[idx]);
-				gate->setPort(ID::Y, new_data[i+k]);
+				gate->setPorts({{ID::A, data[i*2+k]}, {ID::B, data[i*2+width+k]}, {ID::S, sel[idx]}, {ID::Y, new_data[i+k]}});
+				module->strashCell(gate);
 			}
 		}
 		data = new_data;
@@ -340,10 +349,8 @@ void simplemap_lut(RTLIL::Module *module, RTLIL::Cell *cell)
 		for (int i = 0; i < GetSize(lut_data); i += 2) {
 			RTLIL::Cell *gate = module->addCell(NEW_ID, ID($_MUX_));
 			gate->attributes[ID::src] = cell->attributes[ID::src];
-			gate->setPort(ID::A, lut_data[i]);
-			gate->setPort(ID::B, lut_data[i+1]);
-			gate->setPort(ID::S, lut_ctrl[idx]);
-			gate->setPort(ID::Y, new_lut_data[i/2]);
+			gate->setPorts({{ID::A, lut_data[i]}, {ID::B, lut_data[i+1]}, {ID::S, lut_ctrl[idx]}, {ID::Y, new_lut_data[i/2]}});
+			module->strashCell(gate);
 		}
 		lut_data = new_lut_data;
 	}
@@ -476,7 +483,7 @@ struct SimplemapPass : public Pass {
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    simplemap [selection]\n");
+		log("    simplemap [options] [selection]\n");
 		log("\n");
 		log("This pass maps a small selection of simple coarse-grain cells to yosys gate\n");
 		log("primitives. The following internal cell types are mapped by this pass:\n");
@@ -487,11 +494,29 @@ struct SimplemapPass : public Pass {
 		log("  $sr, $ff, $dff, $dffe, $dffsr, $dffsre, $adff, $adffe, $aldff, $aldffe, $sdff,\n");
 		log("  $sdffe, $sdffce, $dlatch, $adlatch, $dlatchsr\n");
 		log("\n");
+		log("    -strash\n");
+		log("        structurally hash the created gates: a gate with the same type and\n");
+		log("        input connections as an already created gate is not instantiated\n");
+		log("        again, its output is connected to the existing gate instead. This\n");
+		log("        avoids creating duplicate cells that 'opt_merge' would otherwise\n");
+		log("        have to find and remove later.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
+		bool strash_mode = false;
+
 		log_header(design, "Executing SIMPLEMAP pass (map simple cells to gate primitives).\n");
-		extra_args(args, 1, design);
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-strash") {
+				strash_mode = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
 
 		dict<IdString, void(*)(RTLIL::Module*, RTLIL::Cell*)> mappers;
 		simplemap_get_mappers(mappers);
@@ -499,6 +524,8 @@ struct SimplemapPass : public Pass {
 		for (auto mod : design->modules()) {
 			if (!design->selected(mod) || mod->get_blackbox_attribute())
 				continue;
+			if (strash_mode)
+				mod->strash_begin();
 			std::vector<RTLIL::Cell*> cells = mod->cells();
 			for (auto cell : cells) {
 				if (mappers.count(cell->type) == 0)
@@ -509,6 +536,8 @@ struct SimplemapPass : public Pass {
 				mappers.at(cell->type)(mod, cell);
 				mod->remove(cell);
 			}
+			if (strash_mode)
+				mod->strash_end();
 		}
 	}
 } SimplemapPass;
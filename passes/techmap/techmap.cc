@@ -21,6 +21,7 @@
 #include "kernel/utils.h"
 #include "kernel/sigtools.h"
 #include "kernel/ffinit.h"
+#include "kernel/threadpool.h"
 #include "libs/sha1/sha1.h"
 
 #include <stdlib.h>
@@ -82,6 +83,185 @@ struct TechmapWorker
 	bool recursive_mode = false;
 	bool autoproc_mode = false;
 	bool ignore_wb = false;
+	int num_threads = 1;
+
+	// result of the read-only part of template matching for one cell: which
+	// template of the cell type's candidate list matched, plus the assembled
+	// parameters beyond cell->parameters. Parameter names are stored as
+	// pointers to IdStrings that outlive the parallel phase, because copying
+	// an IdString mutates the global refcount table and the IdString table is
+	// not thread-safe.
+	struct CellPrecompute {
+		int tpl_choice = -1;
+		std::vector<std::pair<const IdString*, RTLIL::Const>> extra_params;
+	};
+
+	// per-template lookup tables for the special _TECHMAP_*_ parameters,
+	// keyed by the unescaped port name, plus attribute flags, so the
+	// parallel matching phase needs neither new IdStrings nor the
+	// by-value-IdString attribute getters
+	struct TplParamInfo {
+		bool blackbox = false, usable = false;
+		bool has_celltype = false, has_cellname = false, has_bits_connmap = false;
+		dict<std::string, IdString> constmsk, constval, wireinit, connmap;
+	};
+	dict<RTLIL::Module*, TplParamInfo> tpl_param_info;
+
+	const TplParamInfo &get_tpl_param_info(RTLIL::Module *tpl)
+	{
+		auto it = tpl_param_info.find(tpl);
+		if (it != tpl_param_info.end())
+			return it->second;
+
+		TplParamInfo &info = tpl_param_info[tpl];
+		info.blackbox = tpl->get_blackbox_attribute(ignore_wb);
+		info.usable = !info.blackbox &&
+				!tpl->get_bool_attribute(ID::techmap_simplemap) &&
+				!tpl->get_bool_attribute(ID::techmap_maccmap) &&
+				!tpl->attributes.count(ID::techmap_wrap);
+		info.has_celltype = tpl->avail_parameters.count(ID::_TECHMAP_CELLTYPE_) != 0;
+		info.has_cellname = tpl->avail_parameters.count(ID::_TECHMAP_CELLNAME_) != 0;
+		info.has_bits_connmap = tpl->avail_parameters.count(ID::_TECHMAP_BITS_CONNMAP_) != 0;
+
+		for (auto par : tpl->avail_parameters) {
+			const std::string &name = par.str();
+			for (auto &entry : {std::make_pair("\\_TECHMAP_CONSTMSK_", &info.constmsk),
+					std::make_pair("\\_TECHMAP_CONSTVAL_", &info.constval),
+					std::make_pair("\\_TECHMAP_WIREINIT_", &info.wireinit),
+					std::make_pair("\\_TECHMAP_CONNMAP_", &info.connmap)}) {
+				size_t plen = strlen(entry.first);
+				if (name.compare(0, plen, entry.first) == 0 && name.size() > plen + 1 && name.back() == '_')
+					(*entry.second)[name.substr(plen, name.size() - plen - 1)] = par;
+			}
+		}
+		return info;
+	}
+
+	// Read-only replica of the template matching and parameter assembly done
+	// in techmap_module() below: find the first matching template for the
+	// cell and build the parameter set used to specialize it. Returns false
+	// for cells that need the serial path (extmapper templates, no match).
+	// Requires tpl_param_info to be filled in for all candidate templates,
+	// then safe to run from worker threads: it neither mutates the design
+	// nor copies or creates IdStrings.
+	bool precompute_cell(SigMap &sigmap, FfInitVals &initvals, const std::vector<RTLIL::Module*> &tpls,
+			RTLIL::Cell *cell, CellPrecompute &result)
+	{
+		auto unescaped = [](const IdString &id) -> const char* {
+			const char *p = id.c_str();
+			return *p == '\\' ? p+1 : p;
+		};
+
+		for (int tpl_choice = 0; tpl_choice < GetSize(tpls); tpl_choice++)
+		{
+			RTLIL::Module *tpl = tpls[tpl_choice];
+			const TplParamInfo &info = tpl_param_info.at(tpl);
+
+			if (info.blackbox)
+				continue;
+			if (!info.usable)
+				return false;
+
+			pool<int> param_keys;
+			for (const auto &p : cell->parameters)
+				param_keys.insert(p.first.index_);
+
+			std::vector<std::pair<const IdString*, RTLIL::Const>> extra_params;
+			auto add_param = [&](const IdString &name, RTLIL::Const value) {
+				if (param_keys.insert(name.index_).second)
+					extra_params.push_back(std::make_pair(&name, std::move(value)));
+			};
+
+			bool matched = true;
+			for (auto &conn : cell->connections()) {
+				if (conn.first.begins_with("$"))
+					continue;
+				RTLIL::Wire *port = tpl->wires_.at(conn.first, nullptr);
+				if (port != nullptr && port->port_id > 0)
+					continue;
+				if (!conn.second.is_fully_const() || param_keys.count(conn.first.index_) > 0 || tpl->avail_parameters.count(conn.first) == 0) {
+					matched = false;
+					break;
+				}
+				add_param(conn.first, conn.second.as_const());
+			}
+			if (!matched)
+				continue;
+
+			if (info.has_celltype)
+				add_param(ID::_TECHMAP_CELLTYPE_, RTLIL::Const(std::string(unescaped(cell->type))));
+			if (info.has_cellname)
+				add_param(ID::_TECHMAP_CELLNAME_, RTLIL::Const(std::string(unescaped(cell->name))));
+
+			for (auto &conn : cell->connections()) {
+				std::string port_name = unescaped(conn.first);
+				auto it = info.constmsk.find(port_name);
+				if (it != info.constmsk.end()) {
+					std::vector<RTLIL::SigBit> v = sigmap(conn.second).to_sigbit_vector();
+					for (auto &bit : v)
+						bit = RTLIL::SigBit(bit.wire == nullptr ? RTLIL::State::S1 : RTLIL::State::S0);
+					add_param(it->second, RTLIL::SigSpec(v).as_const());
+				}
+				it = info.constval.find(port_name);
+				if (it != info.constval.end()) {
+					std::vector<RTLIL::SigBit> v = sigmap(conn.second).to_sigbit_vector();
+					for (auto &bit : v)
+						if (bit.wire != nullptr)
+							bit = RTLIL::SigBit(RTLIL::State::Sx);
+					add_param(it->second, RTLIL::SigSpec(v).as_const());
+				}
+				it = info.wireinit.find(port_name);
+				if (it != info.wireinit.end())
+					add_param(it->second, initvals(conn.second));
+			}
+
+			{
+				int unique_bit_id_counter = 0;
+				dict<RTLIL::SigBit, int> unique_bit_id;
+				unique_bit_id[RTLIL::State::S0] = unique_bit_id_counter++;
+				unique_bit_id[RTLIL::State::S1] = unique_bit_id_counter++;
+				unique_bit_id[RTLIL::State::Sx] = unique_bit_id_counter++;
+				unique_bit_id[RTLIL::State::Sz] = unique_bit_id_counter++;
+
+				for (auto &conn : cell->connections())
+					if (info.connmap.count(unescaped(conn.first)) != 0) {
+						for (auto &bit : sigmap(conn.second))
+							if (unique_bit_id.count(bit) == 0)
+								unique_bit_id[bit] = unique_bit_id_counter++;
+					}
+
+				// Find highest bit set
+				int bits = 0;
+				for (int i = 0; i < 32; i++)
+					if (((unique_bit_id_counter-1) & (1 << i)) != 0)
+						bits = i;
+				// Increment index by one to get number of bits
+				bits++;
+				if (info.has_bits_connmap)
+					add_param(ID::_TECHMAP_BITS_CONNMAP_, RTLIL::Const(bits));
+
+				for (auto &conn : cell->connections()) {
+					auto it = info.connmap.find(unescaped(conn.first));
+					if (it != info.connmap.end()) {
+						RTLIL::Const value;
+						for (auto &bit : sigmap(conn.second)) {
+							int val = unique_bit_id.at(bit);
+							for (int i = 0; i < bits; i++) {
+								value.bits().push_back((val & 1) != 0 ? State::S1 : State::S0);
+								val = val >> 1;
+							}
+						}
+						add_param(it->second, value);
+					}
+				}
+			}
+
+			result.tpl_choice = tpl_choice;
+			result.extra_params = std::move(extra_params);
+			return true;
+		}
+		return false;
+	}
 
 	std::string constmap_tpl_name(SigMap &sigmap, RTLIL::Module *tpl, RTLIL::Cell *cell, bool verbose)
 	{
@@ -181,6 +361,7 @@ struct TechmapWorker
 		dict<Wire*, IdString> temp_renamed_wires;
 		pool<SigBit> autopurge_tpl_bits;
 
+		module->reserve_new_wires(GetSize(tpl->wires_));
 		for (auto tpl_w : tpl->wires())
 		{
 			if (tpl_w->port_id > 0)
@@ -475,6 +656,47 @@ struct TechmapWorker
 
 		cells.sort();
 
+		// Partition the candidate cells across worker threads for the
+		// read-only matching and parameter assembly. Module mutations (and
+		// template derivation) stay in the serialized loop below, which just
+		// picks up the precomputed results.
+		dict<RTLIL::Cell*, CellPrecompute> precomputed;
+		if (num_threads > 1 && !in_recursion && GetSize(cells.sorted) > 1)
+		{
+			// create all template info (and thereby all special parameter
+			// IdStrings) up front; the workers only read these tables
+			dict<IdString, std::vector<RTLIL::Module*>> type_to_tpls;
+			for (auto cell : cells.sorted)
+				if (type_to_tpls.count(cell->type) == 0) {
+					auto &tpls = type_to_tpls[cell->type];
+					for (auto &tpl_name : celltypeMap.at(cell->type.str())) {
+						RTLIL::Module *tpl = map->module(tpl_name);
+						get_tpl_param_info(tpl);
+						tpls.push_back(tpl);
+					}
+				}
+
+			int num_cells = GetSize(cells.sorted);
+			int chunks = min(num_threads, num_cells);
+			std::vector<CellPrecompute> results(num_cells);
+			std::vector<char> valid(num_cells, 0);
+			ThreadPool::run(chunks, chunks, [&](int t) {
+				// mfp path compression makes shared SigMap lookups unsafe,
+				// so each worker uses private copies
+				SigMap thread_sigmap = sigmap;
+				FfInitVals thread_initvals = initvals;
+				thread_initvals.sigmap = &thread_sigmap;
+				for (int i = t; i < num_cells; i += chunks) {
+					RTLIL::Cell *cell = cells.sorted[i];
+					valid[i] = precompute_cell(thread_sigmap, thread_initvals,
+							type_to_tpls.at(cell->type), cell, results[i]);
+				}
+			});
+			for (int i = 0; i < num_cells; i++)
+				if (valid[i])
+					precomputed.emplace(cells.sorted[i], std::move(results[i]));
+		}
+
 		for (auto cell : cells.sorted)
 		{
 			log_assert(handled_cells.count(cell) == 0);
@@ -486,12 +708,28 @@ struct TechmapWorker
 			if (in_recursion && cell->type.begins_with("\\$"))
 				cell_type = cell_type.substr(1);
 
+			const CellPrecompute *pre = nullptr;
+			{
+				auto it = precomputed.find(cell);
+				if (it != precomputed.end())
+					pre = &it->second;
+			}
+			int tpl_choice_counter = -1;
+
 			for (auto &tpl_name : celltypeMap.at(cell_type))
 			{
 				IdString derived_name = tpl_name;
 				RTLIL::Module *tpl = map->module(tpl_name);
 				dict<IdString, RTLIL::Const> parameters(cell->parameters);
 
+				tpl_choice_counter++;
+				if (pre != nullptr) {
+					if (tpl_choice_counter != pre->tpl_choice)
+						continue;
+					for (auto &p : pre->extra_params)
+						parameters.emplace(*p.first, p.second);
+				}
+
 				if (tpl->get_blackbox_attribute(ignore_wb))
 					continue;
 
@@ -614,6 +852,9 @@ struct TechmapWorker
 					break;
 				}
 
+				if (pre != nullptr)
+					goto skip_parameter_assembly;
+
 				for (auto &conn : cell->connections()) {
 					if (conn.first.begins_with("$"))
 						continue;
@@ -692,6 +933,7 @@ struct TechmapWorker
 						}
 				}
 
+		skip_parameter_assembly:
 				if (0) {
 			use_wrapper_tpl:;
 					// do not register techmap_wrap modules with techmap_cache
@@ -978,6 +1220,25 @@ struct TechmapWorker
 	}
 };
 
+// In-process cache of elaborated map libraries, keyed by the content hash
+// of the map files and the frontend command. Elaborating the map (most
+// flows re-read +/techmap.v on every techmap call) is pure overhead when
+// the files have not changed, and reusing the design also keeps the
+// $paramod specializations derived from the templates, so repeated
+// invocations skip re-deriving them. The cached design stays alive for
+// the rest of the session. The module list from right after elaboration
+// is recorded separately, so the celltype rules are rebuilt from the
+// original templates and not from specializations added later. Maps
+// given as in-session designs (`%name') are not cached, as their content
+// can change without a file hash noticing.
+struct TechmapMapCacheEntry {
+	std::string key;
+	RTLIL::Design *map;
+	std::vector<RTLIL::IdString> base_modules;
+};
+
+static std::vector<TechmapMapCacheEntry> techmap_map_cache;
+
 struct TechmapPass : public Pass {
 	TechmapPass() : Pass("techmap", "generic technology mapper") { }
 	void help() override
@@ -1003,6 +1264,18 @@ struct TechmapPass : public Pass {
 		log("        load the cell implementations as separate modules into the design\n");
 		log("        instead of inlining them.\n");
 		log("\n");
+		log("    -cache <dirname>\n");
+		log("        cache the elaborated map libraries in the given directory, keyed on\n");
+		log("        the content hash of the map file. Later runs with unchanged map\n");
+		log("        files load the cached binary RTLIL instead of re-running the\n");
+		log("        frontend. The directory is created if it does not exist.\n");
+		log("\n");
+		log("    -threads <integer>\n");
+		log("        partition the template matching and parameter assembly for the\n");
+		log("        candidate cells across the given number of threads. All module\n");
+		log("        mutations are still applied in a single serialized commit phase,\n");
+		log("        so the results are identical to a single-threaded run.\n");
+		log("\n");
 		log("    -max_iter <number>\n");
 		log("        only run the specified number of iterations on each module.\n");
 		log("        default: unlimited\n");
@@ -1164,6 +1437,7 @@ struct TechmapPass : public Pass {
 		std::vector<std::string> map_files;
 		std::vector<RTLIL::IdString> dont_map;
 		std::string verilog_frontend = "verilog -nooverwrite -noblackbox";
+		std::string cache_dir;
 		int max_iter = -1;
 
 		size_t argidx;
@@ -1176,6 +1450,10 @@ struct TechmapPass : public Pass {
 				max_iter = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-threads" && argidx+1 < args.size()) {
+				worker.num_threads = max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
 			if (args[argidx] == "-D" && argidx+1 < args.size()) {
 				verilog_frontend += " -D " + args[++argidx];
 				continue;
@@ -1208,12 +1486,52 @@ struct TechmapPass : public Pass {
 				dont_map.push_back(RTLIL::escape_id(args[++argidx]));
 				continue;
 			}
+			if (args[argidx] == "-cache" && argidx+1 < args.size()) {
+				cache_dir = args[++argidx];
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
-		RTLIL::Design *map = new RTLIL::Design;
-		if (map_files.empty()) {
+		bool cacheable = true;
+		std::string cache_key;
+		TechmapMapCacheEntry *cache_hit = nullptr;
+
+		{
+			Hasher h;
+			h.eat(verilog_frontend);
+			std::vector<std::string> hash_files = map_files;
+			if (hash_files.empty())
+				hash_files.push_back("+/techmap.v");
+			for (auto &filename : hash_files) {
+				if (filename.compare(0, 1, "%") == 0) {
+					cacheable = false;
+					break;
+				}
+				std::string fn = filename;
+				rewrite_filename(fn);
+				std::ifstream f(fn.c_str(), std::ifstream::binary);
+				if (f.fail()) {
+					cacheable = false;
+					break;
+				}
+				std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+				h.eat(filename);
+				h.eat(data);
+			}
+			if (cacheable) {
+				cache_key = stringf("%08x", (unsigned int)h.yield());
+				for (auto &entry : techmap_map_cache)
+					if (entry.key == cache_key)
+						cache_hit = &entry;
+			}
+		}
+
+		RTLIL::Design *map = cache_hit != nullptr ? cache_hit->map : new RTLIL::Design;
+		if (cache_hit != nullptr) {
+			log("Reusing cached map library (%d modules).\n", GetSize(cache_hit->base_modules));
+		} else if (map_files.empty()) {
 			Frontend::frontend_call(map, nullptr, "+/techmap.v", verilog_frontend);
 		} else {
 			for (auto &fn : map_files)
@@ -1225,6 +1543,25 @@ struct TechmapPass : public Pass {
 					for (auto mod : saved_designs.at(fn.substr(1))->modules())
 						if (!map->module(mod->name))
 							map->add(mod->clone());
+				} else if (!cache_dir.empty()) {
+					// the cache key covers the map file contents, the frontend
+					// command used to elaborate it, and the yosys version
+					std::string hash = sha1(SHA1::from_file(fn) + verilog_frontend + yosys_version_str);
+					std::string cache_file = cache_dir + "/techmap-" + hash + ".il";
+					if (check_file_exists(cache_file)) {
+						log("Using cached map library `%s' for `%s'.\n", cache_file.c_str(), fn.c_str());
+						Frontend::frontend_call(map, nullptr, cache_file, "rtlil -nooverwrite");
+					} else {
+						RTLIL::Design *file_map = new RTLIL::Design;
+						Frontend::frontend_call(file_map, nullptr, fn, (fn.size() > 3 && fn.compare(fn.size()-3, std::string::npos, ".il") == 0 ? "rtlil" : verilog_frontend));
+						if (!create_directory(cache_dir))
+							log_error("Can't create techmap cache directory `%s'.\n", cache_dir.c_str());
+						Backend::backend_call(file_map, nullptr, cache_file, "rtlil -binary");
+						for (auto mod : file_map->modules())
+							if (!map->module(mod->name))
+								map->add(mod->clone());
+						delete file_map;
+					}
 				} else {
 					Frontend::frontend_call(map, nullptr, fn, (fn.size() > 3 && fn.compare(fn.size()-3, std::string::npos, ".il") == 0 ? "rtlil" : verilog_frontend));
 				}
@@ -1232,8 +1569,25 @@ struct TechmapPass : public Pass {
 
 		log_header(design, "Continuing TECHMAP pass.\n");
 
+		std::vector<RTLIL::Module*> map_modules;
+		if (cache_hit != nullptr) {
+			for (auto &name : cache_hit->base_modules)
+				map_modules.push_back(map->module(name));
+		} else {
+			for (auto module : map->modules())
+				map_modules.push_back(module);
+			if (cacheable) {
+				TechmapMapCacheEntry entry;
+				entry.key = cache_key;
+				entry.map = map;
+				for (auto module : map_modules)
+					entry.base_modules.push_back(module->name);
+				techmap_map_cache.push_back(std::move(entry));
+			}
+		}
+
 		dict<IdString, pool<IdString>> celltypeMap;
-		for (auto module : map->modules()) {
+		for (auto module : map_modules) {
 			if (module->attributes.count(ID::techmap_celltype) && !module->attributes.at(ID::techmap_celltype).empty()) {
 				char *p = strdup(module->attributes.at(ID::techmap_celltype).decode_string().c_str());
 				for (char *q = strtok(p, " \t\r\n"); q; q = strtok(nullptr, " \t\r\n")) {
@@ -1302,7 +1656,8 @@ struct TechmapPass : public Pass {
 		}
 
 		log("No more expansions possible.\n");
-		delete map;
+		if (!cacheable)
+			delete map;
 
 		log_pop();
 	}
@@ -15,3 +15,9 @@ run_subtest value_fuzz
 # Compile-only test.
 ../../yosys -p "read_verilog test_unconnected_output.v; proc; clean; write_cxxrtl cxxrtl-test-unconnected_output.cc"
 ${CC:-gcc} -std=c++11 -c -o cxxrtl-test-unconnected_output -I../../backends/cxxrtl/runtime cxxrtl-test-unconnected_output.cc
+
+# Compile-only test for partitioned output.
+../../yosys -p "read_verilog test_unconnected_output.v; hierarchy -auto-top; proc; clean; write_cxxrtl -header -parts 2 cxxrtl-test-parts.cc"
+for part in cxxrtl-test-parts.cc cxxrtl-test-parts_0.cc cxxrtl-test-parts_1.cc; do
+    ${CC:-gcc} -std=c++11 -c -o ${part%.cc}.o -I. -I../../backends/cxxrtl/runtime $part
+done
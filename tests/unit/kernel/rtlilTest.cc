@@ -73,6 +73,53 @@ namespace RTLIL {
 			EXPECT_TRUE(cs1.is_bits());
 		}
 
+		{
+			// A fully defined constant can be compacted to packed words
+			Const cp1(0x2a, 10);
+			cp1.compact();
+			EXPECT_TRUE(cp1.is_packed());
+			EXPECT_EQ(cp1.size(), 10);
+			EXPECT_TRUE(cp1.is_fully_def());
+			EXPECT_TRUE(cp1 == Const(0x2a, 10));
+
+			// It can be iterated and extracted without mutating
+			EXPECT_EQ(cp1.extract(1, 3).as_int(), 5);
+			EXPECT_TRUE(cp1.is_packed());
+
+			// The bits() view materializes the State vector again
+			cp1.bits()[0] = State::Sx;
+			EXPECT_TRUE(cp1.is_bits());
+
+			// Constants with x/z bits stay bitvec backed
+			Const cp2(State::Sx, 4);
+			cp2.compact();
+			EXPECT_TRUE(cp2.is_bits());
+		}
+
+	}
+
+	TEST_F(KernelRtlilTest, CellSetPortsBulk)
+	{
+		Design design;
+		Module *mod = design.addModule(ID(top));
+		Wire *a = mod->addWire(ID(a), 4);
+		Wire *b = mod->addWire(ID(b), 4);
+		Wire *y = mod->addWire(ID(y), 4);
+
+		Cell *cell = mod->addCell(ID(c1), ID($and), {{ID::A, a}, {ID::B, b}, {ID::Y, y}});
+		EXPECT_EQ(GetSize(cell->connections()), 3);
+		EXPECT_TRUE(cell->getPort(ID::A) == SigSpec(a));
+
+		// bulk updates overwrite existing ports and leave the others alone
+		cell->setPorts({{ID::A, b}, {ID::B, a}});
+		EXPECT_EQ(GetSize(cell->connections()), 3);
+		EXPECT_TRUE(cell->getPort(ID::A) == SigSpec(b));
+		EXPECT_TRUE(cell->getPort(ID::Y) == SigSpec(y));
+
+		std::vector<SigSig> conns;
+		conns.emplace_back(SigSpec(y), SigSpec(a));
+		mod->connect(conns);
+		EXPECT_EQ(GetSize(mod->connections()), 1);
 	}
 }
 
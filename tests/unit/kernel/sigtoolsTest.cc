@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+class SigtoolsTest : public testing::Test {};
+
+TEST_F(SigtoolsTest, IncrementalSigMapTracksConnects)
+{
+	Design design;
+	Module *module = design.addModule(ID(top));
+	Wire *a = module->addWire(ID(a));
+	Wire *b = module->addWire(ID(b));
+	Wire *c = module->addWire(ID(c));
+
+	IncrementalSigMap sigmap(module);
+	EXPECT_NE(sigmap(SigBit(a)), sigmap(SigBit(b)));
+
+	// new connections are merged in through the monitor, without a rebuild
+	module->connect(SigBit(b), SigBit(a));
+	EXPECT_FALSE(sigmap.dirty);
+	EXPECT_EQ(sigmap(SigBit(a)), sigmap(SigBit(b)));
+	EXPECT_NE(sigmap(SigBit(a)), sigmap(SigBit(c)));
+
+	// replacing the whole connection list can remove connections, which
+	// marks the map dirty; the next query rebuilds it lazily
+	module->new_connections({SigSig(SigBit(c), SigBit(a))});
+	EXPECT_TRUE(sigmap.dirty);
+	EXPECT_NE(sigmap(SigBit(a)), sigmap(SigBit(b)));
+	EXPECT_FALSE(sigmap.dirty);
+	EXPECT_EQ(sigmap(SigBit(a)), sigmap(SigBit(c)));
+
+	// and the rebuilt map tracks further connects incrementally again
+	module->connect(SigBit(b), SigBit(c));
+	EXPECT_EQ(sigmap(SigBit(a)), sigmap(SigBit(b)));
+
+	sigmap.detach();
+	EXPECT_TRUE(module->monitors.empty());
+}
+
+YOSYS_NAMESPACE_END